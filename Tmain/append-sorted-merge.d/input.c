@@ -0,0 +1,3 @@
+int b;
+int d;
+static void f (void) {}
@@ -0,0 +1,24 @@
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS=$1
+BUILDDIR=$2
+
+O="--quiet --options=NONE --extras=-p --fields=-t --sort-method=internal"
+T=${BUILDDIR}/tags
+
+# Sorted already: the tags added are merged; "b" is there already.
+printf '!_TAG_FILE_SORTED\t1\t/0=unsorted, 1=sorted, 2=foldcase/\na\ta.c\t/^a$/;"\tv\nb\tinput.c\t/^int b;$/;"\tv\ne\ta.c\t/^e$/;"\tv\n' > $T
+${CTAGS} $O -a -f $T input.c
+echo '# merged'
+cat $T
+
+# Claims to be sorted, but is not: the whole file is sorted.
+printf '!_TAG_FILE_SORTED\t1\t/0=unsorted, 1=sorted, 2=foldcase/\ne\ta.c\t/^e$/;"\tv\na\ta.c\t/^a$/;"\tv\n' > $T
+${CTAGS} $O -a -f $T input.c
+echo '# not sorted'
+cat $T
+
+s=$?
+rm -f $T ${T}.tmp
+exit $s
@@ -0,0 +1,20 @@
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS=$1
+BUILDDIR=$2
+
+O="--quiet --options=NONE --sort=no --extras=-p --totals"
+T=${BUILDDIR}/tags
+
+# The last line has no newline; it is counted as a tag.
+printf '!_TAG_FILE_FORMAT\t2\t/extended format/\n!_TAG_FILE_SORTED\t0\t/0=unsorted/\na\ta.c\t/^a$/;"\tv\nb\ta.c\t/^b$/;"\tv' > $T
+${CTAGS} $O -a -f $T input.c 2>&1 | grep 'added'
+
+# Only pseudo tags.
+printf '!_TAG_FILE_FORMAT\t2\t/extended format/\n' > $T
+${CTAGS} $O -a -f $T input.c 2>&1 | grep 'added'
+
+s=$?
+rm -f $T
+exit $s
@@ -0,0 +1,2 @@
+int a;
+static int f (void) { return 0; }
@@ -0,0 +1,4 @@
+def g():
+    pass
+class C:
+    pass
@@ -0,0 +1,38 @@
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS=$1
+BUILDDIR=$2
+
+O="--quiet --options=NONE --pseudo-tags=TAG_KIND_DESCRIPTION"
+D=${BUILDDIR}/cache-dir-option.tmp
+
+run ()
+{
+	local t=$1
+	shift
+	(cd $D && ${CTAGS} $O --verbose --cache-dir=cache -o $t "$@" 2>&1 >/dev/null) | grep '^using cached'
+	(cd $D && ${CTAGS} $O -o ref.tags "$@" && cmp $t ref.tags && cat $t)
+}
+
+rm -rf $D
+mkdir -p $D/cache
+cp input-a.c input-b.py $D
+
+echo '# first'
+run tags input-a.c input-b.py
+echo '# another tag file'
+run other.tags input-a.c input-b.py
+echo '# the pseudo tags of each file'
+run tags input-b.py
+echo '# same contents at another path: not shared'
+cp $D/input-a.c $D/input-c.c
+run tags input-c.c
+echo '# modified'
+echo 'int b;' >> $D/input-a.c
+run tags input-a.c
+echo '# options changed'
+run tags --kinds-C=-f input-c.c
+s=$?
+rm -rf $D
+exit $s
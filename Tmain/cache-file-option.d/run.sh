@@ -0,0 +1,33 @@
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS=$1
+BUILDDIR=$2
+
+O="--quiet --options=NONE --pseudo-tags=TAG_KIND_DESCRIPTION"
+D=${BUILDDIR}/cache-file-option.tmp
+
+run ()
+{
+	(cd $D && ${CTAGS} $O --verbose --cache-file=tags.cache -o tags "$@" 2>&1 >/dev/null) | grep '^using cached'
+	(cd $D && ${CTAGS} $O -o ref.tags "$@" && cmp tags ref.tags && cat tags)
+}
+
+rm -rf $D
+mkdir -p $D
+cp input-a.c input-b.py $D
+
+echo '# first'
+run input-a.c input-b.py
+echo '# second'
+run input-a.c input-b.py
+echo '# modified'
+echo 'int b;' >> $D/input-a.c
+run input-a.c input-b.py
+echo '# removed'
+run input-a.c
+echo '# options changed'
+run --kinds-C=-f input-a.c
+s=$?
+rm -rf $D
+exit $s
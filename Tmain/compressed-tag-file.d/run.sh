@@ -0,0 +1,49 @@
+#!/bin/sh
+
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS=$1
+BUILDDIR=$2
+READTAGS=$3
+
+. ../utils.sh
+
+is_feature_available ${CTAGS} zlib
+
+if ! [ -x "${READTAGS}" ]; then
+	skip "no readtags"
+fi
+
+if ! type gzip > /dev/null 2>&1; then
+	skip "no gzip"
+fi
+
+O=${BUILDDIR}/compressed-tag-file.tmp
+
+rm -f $O $O.gz
+
+echo '# write' &&
+${CTAGS} --quiet --options=NONE -o $O src/input.c &&
+${CTAGS} --quiet --options=NONE -o $O.gz src/input.c &&
+gzip -dc $O.gz | cmp - $O &&
+
+echo '# overwrite' &&
+${CTAGS} --quiet --options=NONE -o $O.gz src/input.c &&
+gzip -dc $O.gz | cmp - $O &&
+
+echo '# read' &&
+${READTAGS} -t $O.gz -l &&
+${READTAGS} -t $O.gz beta &&
+${READTAGS} -t $O.gz -p alpha &&
+
+echo '# gzip' &&
+gzip -c $O > $O.gz &&
+${READTAGS} -t $O.gz -p alpha &&
+
+echo '# append' &&
+${CTAGS} --quiet --options=NONE -o $O.gz -a src/input.c
+
+s=$?
+rm -f $O $O.gz
+exit $s
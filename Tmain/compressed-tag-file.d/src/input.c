@@ -0,0 +1,4 @@
+int alpha;
+int alphabet;
+static void beta (void) {}
+struct gamma { int delta; };
@@ -0,0 +1,3 @@
+template<typename T> struct Box { T value; };
+Box<Box<Box<int> > > nested;
+int main(void) { return nested.value.value.value; }
@@ -0,0 +1,5 @@
+CFLAGS = -O2 \
+	-g
+all: prog
+prog: main.o
+	$(CC) -o $@ $^
@@ -0,0 +1,4 @@
+#define MAX 10
+typedef struct { int x; int y; } point;
+enum { RED, GREEN };
+namespace ns { class C { public: void f (int a); }; }
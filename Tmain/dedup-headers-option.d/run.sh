@@ -0,0 +1,45 @@
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS=$1
+BUILDDIR=$2
+
+O="--quiet --options=NONE --extras=+q --fields=+S --sort=no"
+
+echo '# dedup'
+${CTAGS} $O --verbose --dedup-headers -o - a/input.h b/input.h b/other.h 2>&1 >/dev/null | grep '^using the tags'
+${CTAGS} $O --dedup-headers -o - a/input.h b/input.h b/other.h > ${BUILDDIR}/dedup-headers.tags
+${CTAGS} $O -o - a/input.h b/input.h b/other.h > ${BUILDDIR}/dedup-headers.ref
+cmp ${BUILDDIR}/dedup-headers.tags ${BUILDDIR}/dedup-headers.ref && cat ${BUILDDIR}/dedup-headers.tags
+s=$?
+
+echo '# makefiles'
+${CTAGS} $O --verbose --dedup-headers -o - a/input.mak b/input.mak 2>&1 >/dev/null | grep '^using the tags'
+${CTAGS} $O --dedup-headers -o - a/input.mak b/input.mak > ${BUILDDIR}/dedup-headers.tags
+${CTAGS} $O -o - a/input.mak b/input.mak > ${BUILDDIR}/dedup-headers.ref
+cmp ${BUILDDIR}/dedup-headers.tags ${BUILDDIR}/dedup-headers.ref && cat ${BUILDDIR}/dedup-headers.tags || s=1
+
+echo '# same input file given twice'
+${CTAGS} $O --verbose --dedup-headers -o - a/input.h ./a/input.h 2>&1 >/dev/null | grep '(parsed already)'
+${CTAGS} $O --dedup-headers -o - a/input.h ./a/input.h > ${BUILDDIR}/dedup-headers.tags
+${CTAGS} $O -o - a/input.h > ${BUILDDIR}/dedup-headers.ref
+cmp ${BUILDDIR}/dedup-headers.tags ${BUILDDIR}/dedup-headers.ref || s=1
+
+echo '# headers larger than the ones read into memory (1 MiB)'
+D=${BUILDDIR}/dedup-headers.tmp
+rm -rf $D
+mkdir -p $D/a $D/b
+for i in $(seq 0 29999); do
+	echo "struct s$i { int m; }; /* .......................... */"
+done > $D/a/large.h
+cp $D/a/large.h $D/b/large.h
+(
+	cd $D &&
+	${CTAGS} $O --verbose --dedup-headers -o - a/large.h b/large.h 2>&1 >/dev/null | grep '^using the tags' &&
+	${CTAGS} $O --dedup-headers -o dedup.tags a/large.h b/large.h &&
+	${CTAGS} $O -o ref.tags a/large.h b/large.h &&
+	cmp dedup.tags ref.tags
+) || s=1
+rm -rf $D
+rm -f ${BUILDDIR}/dedup-headers.tags ${BUILDDIR}/dedup-headers.ref
+exit $s
@@ -0,0 +1,17 @@
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS=$1
+
+. ../utils.sh
+
+is_feature_available ${CTAGS} jobs
+
+O="--quiet --options=NONE --fields=+lKZ --dedup-tags"
+F="input.c input.c input.c input.c input.c input.c"
+
+# The parent drops the tags the workers have written for the same file.
+for s in no yes; do
+	echo "# --sort=$s"
+	${CTAGS} $O --sort=$s --jobs=3 -o - $F
+done
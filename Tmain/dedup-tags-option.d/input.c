@@ -0,0 +1,2 @@
+struct a { int x; }; struct b { int x; };
+int main (void) { return 0; }
@@ -0,0 +1,13 @@
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS=$1
+
+O="--quiet --options=NONE --fields=+lKZ --sort=no"
+
+echo '# without --dedup-tags'
+${CTAGS} $O -o - input.c input.c
+echo '# with --dedup-tags'
+${CTAGS} $O --dedup-tags -o - input.c input.c
+echo '# an input file parsed again'
+${CTAGS} $O --dedup-tags -o - input.cpp
@@ -0,0 +1,3 @@
+int x0;
+static int f0 (void) { return x0; }
+struct s0 { int m0; };
@@ -0,0 +1,6 @@
+class C1:
+    def m1(self):
+        pass
+
+def f1():
+    pass
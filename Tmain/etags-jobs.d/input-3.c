@@ -0,0 +1,3 @@
+#define M3 3
+enum e3 { E3a, E3b };
+int f3 (int a) { return a + M3; }
@@ -0,0 +1,20 @@
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS=$1
+BUILDDIR=$2
+
+. ../utils.sh
+
+is_feature_available ${CTAGS} jobs
+
+O="--quiet --options=NONE -e"
+F="input-0.c input-1.py input-2.c input-3.c"
+
+${CTAGS} $O -o - $F > ${BUILDDIR}/serial.tags &&
+${CTAGS} $O --jobs=3 -o - $F > ${BUILDDIR}/parallel.tags &&
+cmp ${BUILDDIR}/serial.tags ${BUILDDIR}/parallel.tags &&
+cat ${BUILDDIR}/parallel.tags
+s=$?
+rm -f ${BUILDDIR}/serial.tags ${BUILDDIR}/parallel.tags
+exit $s
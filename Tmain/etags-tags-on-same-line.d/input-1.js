@@ -0,0 +1 @@
+function i(){};var j=6
@@ -0,0 +1,2 @@
+var a=1,b=function(x){return x},c={d:2,e:3};function f(){}
+var g=4;var h=5
@@ -0,0 +1,9 @@
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS=$1
+
+# Tags on the same line share the line written for the first of them;
+# the line written must still follow the pattern length limit and
+# change with the input file.
+${CTAGS} --quiet --options=NONE --pattern-length-limit=20 -e -o - ./input.js ./input-1.js
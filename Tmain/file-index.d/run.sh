@@ -0,0 +1,54 @@
+#!/bin/sh
+
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS=$1
+BUILDDIR=$2
+READTAGS=$3
+
+. ../utils.sh
+
+if ! [ -x "${READTAGS}" ]; then
+	skip "no readtags"
+fi
+
+O=${BUILDDIR}/file-index.tmp
+
+find_files()
+{
+	${READTAGS} -f -t $O src/b.c &&
+	${READTAGS} -f -t $O src/c.h &&
+	${READTAGS} -f -i -t $O SRC/A.C &&
+	${READTAGS} -f -t $O src/d.c &&
+	${READTAGS} -f -t $O counter
+}
+
+rm -f $O $O.fdx
+echo '# index' &&
+${CTAGS} --quiet --options=NONE --file-index --pseudo-tags=TAG_FILE_INDEX -o $O src/a.c src/b.c src/c.h &&
+grep '^!_TAG_FILE_INDEX' $O &&
+head -n 1 $O.fdx | awk -F'\t' -v OFS='\t' 'NR == 1 { $3 = "SIZE" } { print }' &&
+
+echo '# find' &&
+find_files > $O.indexed &&
+cat $O.indexed &&
+
+echo '# without the index' &&
+mv $O.fdx $O.fdx.saved &&
+find_files | cmp - $O.indexed &&
+
+echo '# broken index' &&
+head -c 30 $O.fdx.saved > $O.fdx &&
+find_files | cmp - $O.indexed &&
+
+echo '# unsorted' &&
+${CTAGS} --quiet --options=NONE --file-index --sort=no -o $O src/a.c src/b.c src/c.h &&
+${READTAGS} -f -t $O src/a.c &&
+
+echo '# stdout' &&
+${CTAGS} --quiet --options=NONE --file-index -o - src/a.c > /dev/null
+
+s=$?
+rm -f $O $O.fdx $O.fdx.saved $O.indexed
+exit $s
@@ -0,0 +1,3 @@
+int counter;
+static int getCounter (void) { return counter; }
+static void setCounter (int n) { counter = n; }
@@ -0,0 +1,2 @@
+struct point { int x; int y; };
+static int norm (struct point *p) { return p->x * p->x + p->y * p->y; }
@@ -0,0 +1,2 @@
+#define C_H
+extern int counter;
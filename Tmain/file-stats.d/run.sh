@@ -0,0 +1,27 @@
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS=$1
+BUILDDIR=$2
+
+O=${BUILDDIR}/file-stats.tmp
+rm -rf $O
+mkdir -p $O
+
+# A large input file is the slowest.
+seq 1 20000 | sed -e 's/.*/int v&;/' > $O/big.c
+
+echo '# slowest'
+${CTAGS} --quiet --options=NONE --pseudo-tags= --slowest-files=1 -o - small.c $O/big.c input.java 2>&1 > /dev/null \
+	| sed -n -e '/^SLOWEST FILES/,$p' \
+	| sed -e 's/  */ /g' -e 's/[0-9][0-9.]* [0-9][0-9.]* /N N /' -e "s|$O/||"
+
+echo '# records'
+${CTAGS} --quiet --options=NONE --pseudo-tags= --file-stats=$O/stats.json -o - small.c input.java > /dev/null
+sed -e 's/"wall": [0-9.]*, "cpu": [0-9.]*/"wall": N, "cpu": N/' $O/stats.json
+
+echo '# workers'
+${CTAGS} --quiet --options=NONE --pseudo-tags= --jobs=2 --file-stats=$O/stats.json -o - small.c input.java > /dev/null
+wc -l < $O/stats.json
+
+rm -rf $O
@@ -0,0 +1,34 @@
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS=$1
+BUILDDIR=$2
+
+O=${BUILDDIR}/input-budget-contents.tmp
+rm -rf $O
+mkdir -p $O
+
+printf 'int blob;\n\000\001\002\n' > $O/blob.c
+{ printf 'int minified;'; seq 1 100 | sed -e 's/.*/int v&;/' | tr -d '\n'; echo; } > $O/minified.c
+
+CTAGS="${CTAGS} --options=NONE --pseudo-tags= --fields=+S"
+
+echo '# no check'
+${CTAGS} --quiet -o - $O/blob.c $O/minified.c small.c 2>&1 | sed -e "s|$O/||" | grep -e '^blob	' -e '^minified	' -e 'small.c'
+
+echo '# binary'
+${CTAGS} --input-budget=binary=yes -o - $O/blob.c small.c 2>&1 | sed -e "s|$O/||"
+
+echo '# binary files are skipped with action=reduce too'
+${CTAGS} --quiet --input-budget=binary=yes,action=reduce --file-stats=$O/stats.json -o - $O/blob.c > /dev/null 2>&1
+sed -e 's/"wall": [0-9.]*, "cpu": [0-9.]*/"wall": N, "cpu": N/' -e "s|$O/||" $O/stats.json
+
+echo '# line length'
+${CTAGS} --input-budget=linelen=200 -o - $O/minified.c small.c 2>&1 | sed -e "s|$O/||" | grep -e Notice -e '^minified	' -e 'small.c'
+${CTAGS} --input-budget=linelen=200,action=skip -o - $O/minified.c small.c 2>&1 | sed -e "s|$O/||"
+
+echo '# errors'
+${CTAGS} --input-budget=binary=maybe -o - small.c 2>&1
+${CTAGS} --input-budget=linelen=x -o - small.c 2>&1
+
+rm -rf $O
@@ -0,0 +1 @@
+function f(a) { return a; }
@@ -0,0 +1,34 @@
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS=$1
+BUILDDIR=$2
+
+O=${BUILDDIR}/input-budget.tmp
+rm -rf $O
+mkdir -p $O
+
+seq 1 200 | sed -e 's/.*/int f&(int a) { return a; }/' > $O/big.c
+
+CTAGS="${CTAGS} --options=NONE --pseudo-tags= --fields=+S"
+
+echo '# reduce'
+${CTAGS} --input-budget=lines=100 -o - $O/big.c small.c 2>&1 | sed -e "s|$O/||" | grep -e Notice -e '^f1	' -e 'small.c'
+
+echo '# skip'
+${CTAGS} --input-budget-C=bytes=1000,action=skip -o - $O/big.c small.c input.js 2>&1 | sed -e "s|$O/||"
+
+echo '# the budget of a language overrides the default'
+${CTAGS} --input-budget=bytes=1,action=skip --input-budget-C= -o - small.c input.js 2>&1
+
+echo '# records'
+${CTAGS} --quiet --input-budget=lines=100 --file-stats=$O/stats.json -o - $O/big.c small.c > /dev/null
+sed -e 's/"wall": [0-9.]*, "cpu": [0-9.]*/"wall": N, "cpu": N/' -e "s|$O/||" $O/stats.json
+
+echo '# errors'
+${CTAGS} --input-budget=words=1 -o - small.c 2>&1
+${CTAGS} --input-budget=lines -o - small.c 2>&1
+${CTAGS} --input-budget=lines=x -o - small.c 2>&1
+${CTAGS} --input-budget=action=drop -o - small.c 2>&1
+
+rm -rf $O
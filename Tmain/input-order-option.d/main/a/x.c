@@ -0,0 +1 @@
+int f_a_x_c;
@@ -0,0 +1 @@
+int f_b_c;
@@ -0,0 +1,23 @@
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS=$1
+
+O="--quiet --options=NONE --sort=no --fields=+l -o -"
+
+for order in given unique directory; do
+	echo "# $order"
+	${CTAGS} $O --input-order=$order -L list || exit 1
+	echo "# $order (stdin)"
+	${CTAGS} $O --input-order=$order -L - < list || exit 1
+	echo "# $order (command line)"
+	${CTAGS} $O --input-order=$order $(cat list) || exit 1
+done
+
+# The order in a directory depends on the file system.
+echo "# inode"
+${CTAGS} $O --input-order=inode -L list | sort || exit 1
+echo "# inode (command line)"
+${CTAGS} $O --input-order=inode $(cat list) | sort || exit 1
+
+${CTAGS} $O --input-order=random -L list
@@ -0,0 +1,2 @@
+class E1:
+    pass
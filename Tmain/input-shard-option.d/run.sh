@@ -0,0 +1,32 @@
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS=$1
+BUILDDIR=$2
+
+O="--quiet --options=NONE --pseudo-tags=TAG_FILE_SORTED --pseudo-tags=+TAG_KIND_DESCRIPTION --kinds-C=fv --kinds-Python=cf"
+I="input-a.c input-b.c input-c.py input-d.c input-e.py"
+
+${CTAGS} $O -o ${BUILDDIR}/all.tags $I
+${CTAGS} $O --input-shard=1/2 -o ${BUILDDIR}/shard1.tags $I
+${CTAGS} $O --input-shard=2/2 -o ${BUILDDIR}/shard2.tags $I
+for i in 1 2; do
+	echo "# shard $i"
+	grep -v '^!_' ${BUILDDIR}/shard$i.tags | cut -f2 | sort -u
+done
+
+for m in internal external; do
+	echo "# merged ($m)"
+	${CTAGS} $O --sort-method=$m --merge-tags -o ${BUILDDIR}/merged.tags \
+			 ${BUILDDIR}/shard1.tags ${BUILDDIR}/shard2.tags
+	cmp ${BUILDDIR}/all.tags ${BUILDDIR}/merged.tags && echo same
+done
+
+echo '# merged twice'
+${CTAGS} $O --merge-tags -o ${BUILDDIR}/merged.tags \
+		 ${BUILDDIR}/shard1.tags ${BUILDDIR}/shard2.tags ${BUILDDIR}/shard1.tags
+cat ${BUILDDIR}/merged.tags
+
+s=$?
+rm -f ${BUILDDIR}/all.tags ${BUILDDIR}/shard1.tags ${BUILDDIR}/shard2.tags ${BUILDDIR}/merged.tags
+exit $s
@@ -0,0 +1,18 @@
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS=$1
+BUILDDIR=$2
+
+# An input file getting shorter while it is parsed must not kill ctags.
+INPUT=${BUILDDIR}/truncated-input.c
+awk 'BEGIN { for (i = 0; i < 400000; i++) printf "int function%d (int a, int b)\n{\n\treturn a + b;\n}\n", i }' > ${INPUT}
+
+${CTAGS} --quiet --options=NONE -o ${BUILDDIR}/truncated.tags ${INPUT} &
+pid=$!
+sleep 0.3
+: > ${INPUT}
+wait $pid
+echo "rc: $?"
+
+rm -f ${INPUT} ${BUILDDIR}/truncated.tags
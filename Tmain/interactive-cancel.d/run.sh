@@ -0,0 +1,49 @@
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS=$1
+BUILDDIR=$2
+. ../utils.sh
+
+is_feature_available ${CTAGS} interactive
+is_feature_available ${CTAGS} jobs
+
+s()
+{
+	sed -e s/':"'/': "'/g | jdropver
+}
+
+CTAGS="$CTAGS --options=NONE"
+
+D=${BUILDDIR}/interactive-cancel.tmp
+rm -rf $D
+mkdir -p $D
+seq 1 200000 | sed -e 's/.*/int v&;/' > $D/big.c
+echo 'int small (void) { return 0; }' > $D/small.c
+
+echo deadline
+echo =======================================
+(
+  echo '{"command":"generate-tags", "filename":"'$D'/big.c", "deadline":1}'
+  echo '{"command":"generate-tags", "filename":"small.c", "size":'$(filesize $D/small.c)', "deadline":10000}'
+  cat $D/small.c
+) | ${CTAGS} --_interactive |s
+
+echo
+echo cancel without workers
+echo =======================================
+echo '{"command":"cancel", "id":1}' | ${CTAGS} --_interactive |s
+
+echo
+echo cancel running and pending requests
+echo =======================================
+(
+  echo '{"command":"generate-tags", "filename":"'$D'/big.c", "id":1}'
+  echo '{"command":"generate-tags", "filename":"'$D'/big.c", "id":2}'
+  echo '{"command":"generate-tags", "filename":"'$D'/big.c", "id":3}'
+  echo '{"command":"cancel", "id":3}'
+  echo '{"command":"cancel", "id":1}'
+  echo '{"command":"cancel", "id":2}'
+) | ${CTAGS} --jobs=2 --_interactive | s | LC_ALL=C sort
+
+rm -rf $D
@@ -0,0 +1,33 @@
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS=$1
+. ../utils.sh
+
+is_feature_available ${CTAGS} interactive
+
+s()
+{
+	sed -e s/':"'/': "'/g | jdropver
+}
+
+CTAGS="$CTAGS --options=NONE"
+
+echo generate tags from an inherited descriptor
+echo =======================================
+echo '{"command":"generate-tags", "filename":"buffer.c", "fd":5}' | ${CTAGS} --_interactive 5< test.c |s
+
+echo
+echo generate tags from a part of an inherited descriptor
+echo =======================================
+echo '{"command":"generate-tags", "filename":"buffer.c", "fd":5, "size":39}' | ${CTAGS} --_interactive 5< test.c |s
+
+echo
+echo error on a descriptor not readable
+echo =======================================
+echo '{"command":"generate-tags", "filename":"buffer.c", "fd":5}' | ${CTAGS} --_interactive 5< /dev/null |s
+
+echo
+echo error on a descriptor shorter than the size
+echo =======================================
+echo '{"command":"generate-tags", "filename":"buffer.c", "fd":5, "size":100000}' | ${CTAGS} --_interactive 5< test.c |s
@@ -0,0 +1,18 @@
+int a (void)
+{
+	return 0;
+}
+
+int b (void)
+{
+	return 1;
+}
+
+struct s {
+	int m;
+};
+
+int c (void)
+{
+	return 2;
+}
@@ -0,0 +1,18 @@
+int a (void)
+{
+	return 0;
+}
+
+int b2 (int x)
+{
+	int y = x;
+	return y;
+
+struct s {
+	int m;
+};
+
+int c (void)
+{
+	return 2;
+}
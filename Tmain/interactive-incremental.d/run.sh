@@ -0,0 +1,54 @@
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS=$1
+. ../utils.sh
+
+is_feature_available ${CTAGS} interactive
+
+s()
+{
+	sed -e s/':"'/': "'/g | jdropver
+}
+
+CTAGS="$CTAGS --options=NONE --fields=+ne"
+
+# request FILE [EDIT]
+request()
+{
+	if [ -n "$2" ]; then
+		echo '{"command":"generate-tags", "filename":"a.c", "size":'$(filesize $1)', "incremental":true, "edit":'"$2"'}'
+	else
+		echo '{"command":"generate-tags", "filename":"a.c", "size":'$(filesize $1)', "incremental":true}'
+	fi
+	cat $1
+}
+
+echo parse the edited region
+echo =======================================
+(
+	request before.c
+	request after.c '{"line":6, "removed":4, "added":5}'
+) | ${CTAGS} --_interactive |s
+
+echo
+echo parse the whole if the region does not end clean
+echo =======================================
+(
+	request after.c
+	request broken.c '{"line":10, "removed":1, "added":0}'
+	request after.c '{"line":10, "removed":0, "added":1}'
+) | ${CTAGS} --_interactive |s
+
+echo
+echo parse the whole if the edit does not match the contents
+echo =======================================
+(
+	request after.c
+	request after.c '{"line":1, "removed":0, "added":1}'
+) | ${CTAGS} --_interactive |s
+
+echo
+echo parse the whole without a snapshot
+echo =======================================
+request after.c '{"line":6, "removed":4, "added":5}' | ${CTAGS} --_interactive |s
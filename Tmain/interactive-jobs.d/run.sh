@@ -0,0 +1,27 @@
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS=$1
+. ../utils.sh
+
+is_feature_available ${CTAGS} interactive
+is_feature_available ${CTAGS} jobs
+
+s()
+{
+	sed -e s/':"'/': "'/g | jdropver
+}
+
+CTAGS="$CTAGS --options=NONE"
+
+# The requests with "id" may complete in any order.
+echo requests with id
+echo =======================================
+size=$(filesize test.rb)
+(
+  echo '{"command":"generate-tags", "filename":"test.c", "id":1}'
+  echo '{"command":"generate-tags", "filename":"foobar.rb", "size":'$size', "id":"two", "priority":1}'
+  cat test.rb
+  echo '{"command":"generate-tags", "filename":"test.rb", "id":3}'
+  echo '{"command":"generate-tags", "filename":"test.rb"}'
+) | ${CTAGS} --jobs=2 --_interactive | s | LC_ALL=C sort
@@ -54,3 +54,31 @@ size=$(filesize test.rb)
   echo '{"command":"generate-tags", "filename":"foobar.rb", "size":'$size'}'
   cat test.rb
 ) | ${CTAGS} --_interactive |s
+
+echo
+echo generate tags for a batch of files and data
+echo =======================================
+(
+  echo '{"command":"generate-tags-batch", "files":[{"filename":"test.c"}, {"filename":"foobar.rb", "size":'$size'}, {"filename":"test.rb"}]}'
+  cat test.rb
+) | ${CTAGS} --_interactive |s
+
+echo
+echo error on invalid batch
+echo =======================================
+(
+  echo '{"command":"generate-tags-batch", "files":[{"filename":"foobar.rb", "size":'$size'}, {"size":3}]}'
+  cat test.rb
+  printf 'abc'
+  echo '{"command":"generate-tags", "filename":"test.rb"}'
+) | ${CTAGS} --_interactive |s
+
+echo
+echo framed request
+echo =======================================
+request='{"command":"generate-tags",
+ "filename":"foobar.rb", "size":'$size'}'
+(
+  printf '%d\n%s' ${#request} "$request"
+  cat test.rb
+) | ${CTAGS} --_interactive |s
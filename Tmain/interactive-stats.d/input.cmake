@@ -0,0 +1 @@
+set(VAR 1)
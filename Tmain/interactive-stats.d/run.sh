@@ -0,0 +1,33 @@
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS=$1
+BUILDDIR=$2
+. ../utils.sh
+
+is_feature_available ${CTAGS} interactive
+
+s()
+{
+	sed -e s/':"'/': "'/g | jdropver \
+		| sed -e 's/"wall": [0-9.]*, "cpu": [0-9.]*/"wall": N, "cpu": N/g' \
+			  -e 's/"maxrss": -*[0-9]*/"maxrss": N/'
+}
+
+CTAGS="$CTAGS --options=NONE"
+
+echo counters before any request
+echo =======================================
+echo '{"command":"stats"}' | ${CTAGS} --_interactive |s
+
+echo
+echo counters summed over the requests
+echo =======================================
+(
+  echo '{"command":"generate-tags", "filename":"input.c"}'
+  echo '{"command":"generate-tags", "filename":"input.c"}'
+  echo '{"command":"generate-tags", "filename":"in-memory.c", "size":25}'
+  echo 'int y; int z; int w = 1;'
+  echo '{"command":"generate-tags", "filename":"input.cmake"}'
+  echo '{"command":"stats"}'
+) | ${CTAGS} --_interactive |s | grep -v '"_type": "tag"'
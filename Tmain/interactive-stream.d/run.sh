@@ -0,0 +1,45 @@
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS=$1
+BUILDDIR=$2
+. ../utils.sh
+
+is_feature_available ${CTAGS} interactive
+
+s()
+{
+	sed -e s/':"'/': "'/g | jdropver
+}
+
+CTAGS="$CTAGS --options=NONE"
+
+D=${BUILDDIR}/interactive-stream.tmp
+rm -rf $D
+mkdir -p $D
+seq 1 3000 | sed -e 's/.*/int v&;/' > $D/many.c
+seq 1 200000 | sed -e 's/.*/int v&;/' > $D/big.c
+
+echo streamed tags are the tags not streamed
+echo =======================================
+(
+  echo '{"command":"generate-tags", "filename":"many.c", "size":'$(filesize $D/many.c)', "stream":true}'
+  cat $D/many.c
+) | ${CTAGS} --_interactive |s > $D/streamed.json
+(
+  echo '{"command":"generate-tags", "filename":"many.c", "size":'$(filesize $D/many.c)'}'
+  cat $D/many.c
+) | ${CTAGS} --_interactive |s > $D/not-streamed.json
+if cmp $D/streamed.json $D/not-streamed.json; then
+	grep -c '"_type": "tag"' $D/streamed.json
+fi
+
+echo
+echo retract the tags streamed before the deadline
+echo =======================================
+(
+  echo '{"command":"generate-tags", "filename":"big.c", "size":'$(filesize $D/big.c)', "stream":true, "deadline":50}'
+  cat $D/big.c
+) | ${CTAGS} --_interactive |s | grep -v '"_type": "tag"'
+
+rm -rf $D
@@ -0,0 +1,33 @@
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS=$1
+BUILDDIR=$2
+
+. ../utils.sh
+
+is_feature_available ${CTAGS} jobs
+
+# More files than a batch of 2 workers, spread over directories
+D=${BUILDDIR}/jobs-batches.tmp
+rm -rf $D
+for d in a b c; do
+	mkdir -p $D/src/$d/sub
+	for i in $(seq 0 99); do
+		echo "int ${d}_$i (void) { return $i; }" > $D/src/$d/f$i.c
+		echo "int ${d}_sub_$i;" > $D/src/$d/sub/g$i.c
+	done
+done
+
+O="--quiet --options=NONE --sort=no --pseudo-tags= -R"
+
+(
+	cd $D &&
+	${CTAGS} $O -o serial.tags src &&
+	${CTAGS} $O --jobs=2 -o parallel.tags src &&
+	diff serial.tags parallel.tags &&
+	wc -l < parallel.tags
+)
+s=$?
+rm -rf $D
+exit $s
@@ -0,0 +1,2 @@
+struct point { int x, y; };
+int distance (struct point a, struct point b);
@@ -0,0 +1,2 @@
+#define ORIGIN 0
+enum color { RED, GREEN };
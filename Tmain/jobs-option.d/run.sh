@@ -0,0 +1,20 @@
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS=$1
+BUILDDIR=$2
+
+. ../utils.sh
+
+is_feature_available ${CTAGS} jobs
+
+O="--quiet --options=NONE --sort=no --pseudo-tags=TAG_KIND_DESCRIPTION --kinds-C=+p"
+F="input-0.c input-1.py input-2.c --language-force=C input-3.x --language-force=auto input-4.py"
+
+${CTAGS} $O -o ${BUILDDIR}/serial.tags $F &&
+${CTAGS} $O --jobs=3 -o ${BUILDDIR}/parallel.tags $F &&
+diff ${BUILDDIR}/serial.tags ${BUILDDIR}/parallel.tags &&
+cat ${BUILDDIR}/parallel.tags
+s=$?
+rm -f ${BUILDDIR}/serial.tags ${BUILDDIR}/parallel.tags
+exit $s
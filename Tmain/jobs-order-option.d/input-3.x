@@ -0,0 +1,2 @@
+typedef int length_t;
+static void reset (void) { }
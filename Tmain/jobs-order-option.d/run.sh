@@ -0,0 +1,26 @@
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS=$1
+BUILDDIR=$2
+
+. ../utils.sh
+
+is_feature_available ${CTAGS} jobs
+
+O="--quiet --options=NONE --pseudo-tags=TAG_KIND_DESCRIPTION --kinds-C=+p"
+F="input-0.c input-1.py input-2.c --language-force=C input-3.x --language-force=auto input-4.py"
+
+# With --sort=no, ready is ignored, and the tags are in the order of
+# the input files.
+${CTAGS} $O --sort=no -o ${BUILDDIR}/serial.tags $F &&
+${CTAGS} $O --sort=no --jobs=3 --jobs-order=ready -o ${BUILDDIR}/parallel.tags $F &&
+diff ${BUILDDIR}/serial.tags ${BUILDDIR}/parallel.tags &&
+${CTAGS} $O --sort=yes -o ${BUILDDIR}/serial.tags $F &&
+${CTAGS} $O --sort=yes --jobs=3 --jobs-order=ready -o ${BUILDDIR}/parallel.tags $F &&
+diff ${BUILDDIR}/serial.tags ${BUILDDIR}/parallel.tags &&
+cat ${BUILDDIR}/parallel.tags &&
+${CTAGS} $O --jobs-order=any -o ${BUILDDIR}/parallel.tags $F
+s=$?
+rm -f ${BUILDDIR}/serial.tags ${BUILDDIR}/parallel.tags
+exit $s
@@ -0,0 +1,26 @@
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS=$1
+BUILDDIR=$2
+
+. ../utils.sh
+
+is_feature_available ${CTAGS} jobs
+
+O="--quiet --options=NONE --sort-method=internal --pseudo-tags=TAG_KIND_DESCRIPTION --pseudo-tags=+TAG_FILE_SORTED --kinds-C=+p"
+F="input-0.c input-1.py input-2.c --language-force=C input-3.x --language-force=auto input-4.py"
+
+# The workers sort their fragments, and the fragments are merged.
+for s in yes foldcase; do
+	${CTAGS} $O --sort=$s -o ${BUILDDIR}/serial.tags $F &&
+	${CTAGS} $O --sort=$s --jobs=3 -o ${BUILDDIR}/parallel.tags $F &&
+	diff ${BUILDDIR}/serial.tags ${BUILDDIR}/parallel.tags || break
+	${CTAGS} $O --sort=$s --sort-in-memory -o ${BUILDDIR}/serial.tags $F &&
+	${CTAGS} $O --sort=$s --sort-in-memory --jobs=3 -o ${BUILDDIR}/parallel.tags $F &&
+	diff ${BUILDDIR}/serial.tags ${BUILDDIR}/parallel.tags || break
+done &&
+cat ${BUILDDIR}/parallel.tags
+s=$?
+rm -f ${BUILDDIR}/serial.tags ${BUILDDIR}/parallel.tags
+exit $s
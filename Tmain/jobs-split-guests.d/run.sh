@@ -0,0 +1,40 @@
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS=$1
+BUILDDIR=$2
+
+. ../utils.sh
+
+is_feature_available ${CTAGS} jobs
+
+D=${BUILDDIR}/jobs-split-guests.tmp
+rm -rf $D
+mkdir -p $D
+
+# Regions parsed in the guest workers
+for i in $(seq 0 99); do
+	printf '# Section %d\n\n```c\nint f%d (void) { return %d; }\nstatic int g%d;\n```\n\n' $i $i $i $i
+done > $D/plain.md
+
+# Regions with anonymous names and regions making promises: the guest
+# parsers are run again in order.
+for i in $(seq 0 19); do
+	printf '# Section %d\n\n```c\nstruct { int a%d; } v%d;\n```\n\n' $i $i $i
+	printf '```html\n<div id="d%d"></div>\n<script>\nfunction h%d () {}\n</script>\n```\n\n' $i $i
+done > $D/mixed.md
+
+O="--quiet --options=NONE --sort=no --pseudo-tags= --fields=+nS --extras=+g"
+
+(
+	cd $D &&
+	for f in plain.md mixed.md; do
+		${CTAGS} $O -o serial.tags $f &&
+		${CTAGS} $O --jobs=3 --split-guests=2 -o split.tags $f &&
+		diff serial.tags split.tags &&
+		wc -l < split.tags || exit 1
+	done
+)
+s=$?
+rm -rf $D
+exit $s
@@ -0,0 +1,33 @@
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS=$1
+BUILDDIR=$2
+
+. ../utils.sh
+
+is_feature_available ${CTAGS} jobs
+
+# A file larger than the ones read into memory by default (1 MiB)
+D=${BUILDDIR}/jobs-split-size-large.tmp
+rm -rf $D
+mkdir -p $D
+for i in $(seq 0 9999); do
+	echo "struct { int a$i; } v$i;"
+	echo "int f$i (int x) { return x + '}'; }"
+	echo "typedef struct s$i { union { int u; char c; } m; } t$i; /* ................................ */"
+done > $D/input.c
+
+O="--quiet --options=NONE --sort=no --pseudo-tags= --fields=+nS --extras=+q"
+
+(
+	cd $D &&
+	${CTAGS} $O -o serial.tags input.c &&
+	${CTAGS} $O --verbose --jobs=4 --split-size=1000 -o split.tags input.c 2> verbose.txt &&
+	grep '^parsing input.c in 4 chunks' verbose.txt &&
+	diff serial.tags split.tags &&
+	wc -l < split.tags
+)
+s=$?
+rm -rf $D
+exit $s
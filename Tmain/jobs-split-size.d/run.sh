@@ -0,0 +1,37 @@
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS=$1
+BUILDDIR=$2
+
+. ../utils.sh
+
+is_feature_available ${CTAGS} jobs
+
+# A large file with anonymous types, conditionals, and function bodies
+D=${BUILDDIR}/jobs-split-size.tmp
+rm -rf $D
+mkdir -p $D
+for i in $(seq 0 199); do
+	echo "struct { int a$i; } v$i;"
+	echo "enum { E$i = $i };"
+	echo "#if X$i"
+	echo "int f$i (int x) { return x + '}'; }"
+	echo "#else"
+	echo "int g$i (void) { static const char *s = \"{\"; return $i; }"
+	echo "#endif"
+	echo "typedef struct s$i { union { int u; char c; } m; } t$i;"
+done > $D/input.c
+
+O="--quiet --options=NONE --sort=no --pseudo-tags= --fields=+nS --extras=+q"
+
+(
+	cd $D &&
+	${CTAGS} $O -o serial.tags input.c &&
+	${CTAGS} $O --jobs=4 --split-size=1000 -o split.tags input.c &&
+	diff serial.tags split.tags &&
+	wc -l < split.tags
+)
+s=$?
+rm -rf $D
+exit $s
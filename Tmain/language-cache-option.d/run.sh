@@ -0,0 +1,37 @@
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS=$1
+BUILDDIR=$2
+
+O="--quiet --options=NONE"
+D=${BUILDDIR}/language-cache-option.tmp
+
+run ()
+{
+	(cd $D && ${CTAGS} $O --verbose --language-cache=lang.cache --print-language "$@" 2>&1 >/dev/null) | grep '^Get cached'
+	(cd $D && ${CTAGS} $O --language-cache=lang.cache --print-language "$@")
+}
+
+rm -rf $D
+mkdir -p $D
+cp input-script input-a.c $D
+chmod +x $D/input-script
+
+echo '# first'
+run input-script input-a.c
+echo '# second'
+run input-script input-a.c
+echo '# modified'
+printf '#!/bin/zsh\nf() { :; }\n' > $D/input-script
+run input-script input-a.c
+echo '# languages changed'
+run --languages=-C input-script input-a.c
+echo '# maps changed'
+run --langmap=Sh:.c input-script input-a.c
+echo '# not executable'
+chmod -x $D/input-script
+run input-script
+s=$?
+rm -rf $D
+exit $s
@@ -0,0 +1,11 @@
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS=$1
+
+${CTAGS} --quiet --options=NONE \
+		 --options=./anchor.ctags \
+		 --fields=+K \
+		 --sort=no \
+		 -o - \
+		 input.an
@@ -0,0 +1,14 @@
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS=$1
+
+# The broken pattern of A is reported only when A is used.
+for input in input.bbb "input.aaa input.bbb"; do
+	echo "# $input"
+	echo "# $input" 1>&2
+	${CTAGS} --quiet --options=NONE \
+			 --langdef=A --map-A=.aaa --regex-A='/(x/\1/v/' \
+			 --langdef=B --map-B=.bbb --regex-B='/(y)/\1/v/' \
+			 -o - $input
+done
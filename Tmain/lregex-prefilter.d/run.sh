@@ -0,0 +1,10 @@
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS=$1
+
+${CTAGS} --quiet --options=NONE \
+		 --options=./prefilter.ctags \
+		 --fields=+K \
+		 -o - \
+		 input.pf
@@ -7,5 +7,6 @@ CTAGS=$1
 
 stats=/tmp/ctags-Tmain-$$
 ${CTAGS} --quiet --options=NONE --options=./args.ctags --totals=extra -o - ./input.foo 2> ${stats}
-sed -n -e '/^MTABLE REGEX.*/,$p' ${stats} 1>&2
+sed -n -e '/^MTABLE REGEX.*/,$p' ${stats} \
+	| sed -e '/^MEMORY USAGE/,$d' | sed -e '$d' 1>&2
 rm ${stats}
@@ -0,0 +1,10 @@
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS=$1
+
+${CTAGS} --quiet --options=NONE --options=./args.ctags -o - input.log
+echo '# mapped'
+${CTAGS} --quiet --options=NONE --options=./args.ctags --map-input -o - input.log
+echo '# wrong window'
+${CTAGS} --quiet --options=NONE --options=./args.ctags --_tabledef-LOG='bad{window=x}' -o - input.log 2>&1
@@ -0,0 +1,4 @@
+int x;
+static void func0 (void) { }
+static void func1 (void) { }
+int main (void) { return 0; }
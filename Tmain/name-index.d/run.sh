@@ -0,0 +1,34 @@
+#!/bin/sh
+
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS=$1
+BUILDDIR=$2
+READTAGS=$3
+
+. ../utils.sh
+
+if ! [ -x "${READTAGS}" ]; then
+	skip "no readtags"
+fi
+
+O=${BUILDDIR}/name-index.tmp
+
+rm -f $O $O.idx
+echo '# index' &&
+${CTAGS} --quiet --options=NONE --name-index --pseudo-tags=TAG_NAME_INDEX -o $O input.c &&
+grep '^!_TAG_NAME_INDEX' $O &&
+awk -F'\t' -v OFS='\t' 'NR == 1 { $3 = "SIZE" } { print }' $O.idx &&
+
+echo '# find' &&
+${READTAGS} -e -t $O main &&
+${READTAGS} -e -t $O zzz &&
+${READTAGS} -p -t $O fu &&
+
+echo '# unsorted' &&
+${CTAGS} --quiet --options=NONE --name-index --sort=no -o $O input.c
+
+s=$?
+rm -f $O $O.idx
+exit $s
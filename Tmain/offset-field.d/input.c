@@ -0,0 +1,11 @@
+int x;
+
+struct point {
+	int px;
+	int py;
+};
+
+int main (void)
+{
+	return 0;
+}
@@ -0,0 +1,30 @@
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS=$1
+READTAGS=$3
+
+. ../utils.sh
+
+if ! [ -x "${READTAGS}" ]; then
+	skip "no readtags"
+fi
+
+if ! ( "${READTAGS}" -h | grep -q -e -Q ); then
+	skip "no qualifier function in readtags"
+fi
+
+O=/tmp/ctags-offset-field-$$.tags
+
+echo '# tags'
+${CTAGS} --quiet --options=NONE --excmd=number --fields=+{offset} -o - input.c
+
+echo '# xformat'
+${CTAGS} --quiet --options=NONE -x --_xformat='%N %{offset}' input.c
+
+echo '# readtags'
+${CTAGS} --quiet --options=NONE --excmd=number --fields=+{offset} -o $O input.c &&
+	${READTAGS} -t $O -Q '(< 10 $offset)' -S '(<> &offset $offset)' -F '(list $name " " $offset #t)' -l
+s=$?
+rm -f $O
+exit $s
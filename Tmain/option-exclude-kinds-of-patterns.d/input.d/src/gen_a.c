@@ -0,0 +1 @@
+int gen_a;
@@ -0,0 +1,14 @@
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS="$1"
+
+# A literal, a suffix, a prefix, and an other wildcard pattern:
+# each kind is compiled in a different way.
+${CTAGS} --quiet --options=NONE -o - -R \
+		 --exclude=build \
+		 --exclude='*_test.c' \
+		 --exclude='gen_*' \
+		 --exclude='*/[x]*' \
+		 --exclude-exception='keep_*' \
+		 input.d
@@ -5,4 +5,5 @@ CTAGS=$1
 
 ${CTAGS} --quiet --options=NONE --totals=extra --language-force=CTagsSelfTest -o - input.unknown 2>&1 \
 	| grep -v ^N \
-	| sed -ne '/^STATISTICS.*/,$p'
+	| sed -ne '/^STATISTICS.*/,$p' \
+	| sed -e '/^MEMORY USAGE/,$d' | sed -e '$d'
@@ -0,0 +1,14 @@
+struct point {
+	int x;
+	int y;
+};
+
+static int origin (struct point *p)
+{
+	return p->x == 0 && p->y == 0;
+}
+
+int main (void)
+{
+	return 0;
+}
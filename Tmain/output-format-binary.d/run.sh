@@ -0,0 +1,37 @@
+#!/bin/sh
+
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS=$1
+BUILDDIR=$2
+READTAGS=$3
+
+. ../utils.sh
+
+if ! [ -x "${READTAGS}" ]; then
+	skip "no readtags"
+fi
+
+O=${BUILDDIR}/output-format-binary.tmp
+
+rm -f $O
+echo '# list' &&
+${CTAGS} --quiet --options=NONE --output-format=binary -o $O input.c &&
+${READTAGS} -e -n -t $O -l &&
+
+echo '# find' &&
+${READTAGS} -e -t $O x &&
+${READTAGS} -i -p -t $O OR &&
+
+echo '# overwrite without sorting' &&
+${CTAGS} --quiet --options=NONE --output-format=binary --sort=no --excmd=number -o $O input.c &&
+${READTAGS} -t $O -l &&
+${READTAGS} -t $O main &&
+
+echo '# append' &&
+${CTAGS} --quiet --options=NONE --output-format=binary -a -o $O input.c
+
+s=$?
+rm -f $O
+exit $s
@@ -0,0 +1,13 @@
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS=$1
+
+# The HTML parser writes its pseudo tags even if the inline HTML has no
+# markup.
+O="--quiet --options=NONE --extras=+gp --pseudo-tags=TAG_PARSER_VERSION"
+
+for f in empty.php text.php; do
+	echo "# $f"
+	${CTAGS} $O -o - $f
+done
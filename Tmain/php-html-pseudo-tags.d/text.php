@@ -0,0 +1,2 @@
+text
+<?php $a = 1; ?>
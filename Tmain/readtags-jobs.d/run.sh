@@ -0,0 +1,48 @@
+#!/bin/sh
+
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+READTAGS=$3
+
+. ../utils.sh
+
+#V="valgrind --leak-check=full -v"
+V=
+
+if ! [ -x "${READTAGS}" ]; then
+	skip "no readtags"
+fi
+
+if ! ( "${READTAGS}" -h | grep -q -e --jobs ); then
+	skip "no jobs option in readtags"
+fi
+
+if "${READTAGS}" -t output.tags -j 2 -Q '#t' -l 2>&1 >/dev/null | grep -q "not supported"; then
+	skip "no worker process on this platform"
+fi
+
+Q='(or (eq? $kind "member") (prefix? $name "i"))'
+
+cleanup()
+{
+	rm -f single.tmp jobs.tmp
+}
+trap cleanup EXIT
+
+echo '!_FILTERING in a process'
+${V} ${READTAGS} -t output.tags -ne -Q "$Q" -l > single.tmp || exit 1
+cat single.tmp
+
+for j in 2 3 5 27 100; do
+	echo "!_FILTERING in $j processes"
+	${V} ${READTAGS} -t output.tags -ne -j $j -Q "$Q" -l > jobs.tmp || exit 1
+	cmp single.tmp jobs.tmp || exit 1
+done
+
+echo '!_FILTERING the standard input in 3 processes'
+${V} ${READTAGS} -t - -ne --jobs 3 -Q "$Q" -l < output.tags > jobs.tmp || exit 1
+cmp single.tmp jobs.tmp || exit 1
+
+echo '!_FORMATTING in 3 processes'
+${V} ${READTAGS} -t output.tags -j 3 -Q "$Q" -F '(list $name " " $line #t)' -l
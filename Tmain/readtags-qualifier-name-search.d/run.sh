@@ -0,0 +1,43 @@
+#!/bin/sh
+
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+READTAGS=$3
+
+. ../utils.sh
+
+#V="valgrind --leak-check=full -v"
+V=
+
+if ! [ -x "${READTAGS}" ]; then
+    skip "no readtags"
+fi
+
+if ! ( "${READTAGS}" -h | grep -q -e -Q ); then
+    skip "no qualifier function in readtags"
+fi
+
+# The names written to stderr with -d are the ones searched for.
+rt()
+{
+    { ${V} ${READTAGS} "$@" 2>&1 1>&3 | sed -e 's|^.*readtags[^:]*: |readtags: |' 1>&2; } 3>&1
+}
+
+echo '# eq?' &&
+rt -d -t sorted.tags -Q '(eq? $name "m0")' -l &&
+
+echo '# prefix?' &&
+rt -d -t sorted.tags -Q '(prefix? $name "m")' -l &&
+
+echo '# and' &&
+rt -d -t sorted.tags -Q '(and (eq? $kind "member") (eq? "m0" $name))' -l &&
+
+echo '# after a test which can be an error' &&
+rt -d -t sorted.tags -Q '(and (prefix? $kind "m") (prefix? $name "m"))' -l &&
+
+echo '# not found' &&
+rt -d -t sorted.tags -Q '(prefix? $name "x")' -l &&
+
+echo '# unsorted' &&
+rt -d -s0 -t sorted.tags -Q '(prefix? $name "m")' -l
@@ -0,0 +1,46 @@
+#!/bin/sh
+
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+READTAGS=$3
+
+. ../utils.sh
+
+#V="valgrind --leak-check=full -v"
+V=
+
+if ! [ -x "${READTAGS}" ]; then
+	skip "no readtags"
+fi
+
+if ! ( "${READTAGS}" -h | grep -q -e -S ); then
+	skip "no sorter function in readtags"
+fi
+
+S='(<or> (<> $input &input) (<> $line &line) (<> $name &name))'
+
+echo '!_LIMIT' &&
+${V} ${READTAGS} -t output.tags -ne -L 5 -l &&
+
+echo '!_LIMIT with a name' &&
+${V} ${READTAGS} -t output.tags -ne --limit 2 x &&
+
+echo '!_LIMIT with the sorter' &&
+${V} ${READTAGS} -t output.tags -ne -L 5 -S "$S" -l &&
+
+echo '!_LIMIT with the flipped sorter' &&
+${V} ${READTAGS} -t output.tags -ne -L 5 -S "(*- $S)" -l &&
+
+echo '!_LIMIT larger than the tags' &&
+${V} ${READTAGS} -t output.tags -ne -L 100 -S "$S" -l &&
+
+echo '!_SORTING in temporary files' &&
+${V} ${READTAGS} -t output.tags -ne --sort-buffer-size 1k -S "$S" -l > spilled.tmp &&
+${V} ${READTAGS} -t output.tags -ne -S "$S" -l > sorted.tmp &&
+cmp spilled.tmp sorted.tmp &&
+${V} ${READTAGS} -t output.tags -ne --sort-buffer-size 1 -Q '(eq? $kind "member")' -S "$S" -l
+
+r=$?
+rm -f spilled.tmp sorted.tmp
+exit $r
@@ -0,0 +1,26 @@
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS=$1
+BUILDDIR=$2
+
+. ../utils.sh
+
+D=${BUILDDIR}/recursive-link.tmp
+rm -rf $D
+mkdir -p $D/d/a/b || exit 1
+echo "int x;" > $D/d/a/b/x.c
+echo "int y;" > $D/d/a/y.c
+ln -s .. $D/d/a/up || skip "symbolic links are not available"
+ln -s . $D/d/a/self
+ln -s ../../.. $D/d/a/b/top
+ln -s a $D/d/other
+
+(
+	cd $D &&
+	${CTAGS} --quiet --options=NONE --verbose -R -o - d 2> stderr.txt &&
+	grep "recursive link" stderr.txt | sort
+)
+s=$?
+rm -rf $D
+exit $s
@@ -0,0 +1,12 @@
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS=$1
+
+. ../utils.sh
+
+stats=/tmp/ctags-Tmain-$$
+${CTAGS} --quiet --options=NONE --options=./args.ctags --totals=extra -o - ./input.foo 2> ${stats}
+# The time columns vary from run to run.
+sed -n -e '/^REGEX PROFILE.*/,/^$/p' ${stats} | awk 'NF >= 6 && $1 != "match(ms)" { print $2, $3, $5, $6, $7 }' | sort 1>&2
+rm ${stats}
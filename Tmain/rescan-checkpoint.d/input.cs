@@ -0,0 +1,11 @@
+class A { void f() {} }
+class B { int x; }
+
+#if X
+class C {
+#endif
+class D { int y; }
+}
+class E { int w; }
+}
+class F { int v; }
@@ -0,0 +1,17 @@
+#!/bin/sh
+
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS=$1
+BUILDDIR=$2
+
+. ../utils.sh
+
+is_feature_available ${CTAGS} sampling-profile
+
+# The number of the samples and the regions depend on the speed of the
+# machine; only the shape of the report is compared.
+${CTAGS} --quiet --options=NONE --sampling-profile=3 -o - input.c 2>&1 > /dev/null \
+	| sed -n -e '/^SAMPLED PROFILE$/,/ of the CPU time/p' \
+	| sed -e 's/^[0-9]* samples\{0,1\} of/N samples of/'
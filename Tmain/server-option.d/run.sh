@@ -0,0 +1,37 @@
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS=$1
+BUILDDIR=$2
+
+. ../utils.sh
+
+is_feature_available ${CTAGS} server
+
+O="--quiet --options=NONE"
+
+# sun_path is short; don't put the socket under BUILDDIR.
+D=$(mktemp -d "${TMPDIR:-/tmp}/ctags-server.XXXXXX") || exit 1
+S=$D/sock
+
+${CTAGS} $O --_server=$S &
+for i in 1 2 3 4 5 6 7 8 9 10; do
+	[ -S $S ] && break
+	sleep 0.2
+done
+
+echo '# request'
+${CTAGS} $O --_client=$S input-a.c input-b.py > $D/server.tags
+${CTAGS} $O -o - input-a.c input-b.py > $D/ref.tags
+cmp $D/ref.tags $D/server.tags && cat $D/server.tags
+
+echo '# second request'
+${CTAGS} $O --_client=$S input-b.py
+
+echo '# shutdown'
+${CTAGS} $O --_shutdown-server=$S
+wait
+[ -e $S ] && echo "socket is left"
+
+rm -rf $D
+exit 0
@@ -0,0 +1,57 @@
+#!/bin/sh
+
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS=$1
+BUILDDIR=$2
+READTAGS=$3
+
+. ../utils.sh
+
+if ! [ -x "${READTAGS}" ]; then
+	skip "no readtags"
+fi
+
+D=${BUILDDIR}/shard-by.tmp
+O=$D/tags
+
+rm -rf $D
+mkdir -p $D
+
+listShards ()
+{
+	(cd $D; ls)
+	grep '^!_TAG_SHARD' $O
+}
+
+echo '# directory' &&
+${CTAGS} --quiet --options=NONE --shard-by=directory -o $O -R src &&
+listShards &&
+grep -v '^!_' "$O-src%2Fa" &&
+
+echo '# read' &&
+${READTAGS} -t $O -l &&
+${READTAGS} -t $O -p f &&
+${READTAGS} -t $O -e top &&
+
+echo '# append' &&
+${CTAGS} --quiet --options=NONE --shard-by=directory -o $O -a src/c/z.py &&
+listShards &&
+
+echo '# rewrite' &&
+${CTAGS} --quiet --options=NONE --shard-by=directory -o $O src/t.c &&
+listShards &&
+
+echo '# language' &&
+rm -f $D/* &&
+${CTAGS} --quiet --options=NONE --shard-by=language -o $O -R src &&
+listShards &&
+${READTAGS} -t $O -l &&
+
+echo '# stdout' &&
+${CTAGS} --quiet --options=NONE --shard-by=directory -o - src/t.c
+
+s=$?
+rm -rf $D
+exit $s
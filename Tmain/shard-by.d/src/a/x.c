@@ -0,0 +1 @@
+int fa (void) { return 0; }
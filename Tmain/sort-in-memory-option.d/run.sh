@@ -0,0 +1,17 @@
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS=$1
+BUILDDIR=$2
+
+O="--quiet --options=NONE --pseudo-tags=TAG_PROGRAM_NAME --sort-method=internal"
+
+for s in yes foldcase; do
+	echo "# $s"
+	${CTAGS} $O --sort=$s -o ${BUILDDIR}/file.tags input.c input.c &&
+	${CTAGS} $O --sort=$s --sort-in-memory -o ${BUILDDIR}/memory.tags input.c input.c &&
+	diff ${BUILDDIR}/file.tags ${BUILDDIR}/memory.tags &&
+	${CTAGS} $O --sort=$s --sort-in-memory -o - input.c input.c ||
+	exit $?
+done
+rm -f ${BUILDDIR}/file.tags ${BUILDDIR}/memory.tags
@@ -0,0 +1,6 @@
+int beta;
+int Alpha;
+int alpha;
+int Beta;
+static int gamma (void) { return 0; }
+int _under;
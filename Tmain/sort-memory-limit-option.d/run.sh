@@ -0,0 +1,14 @@
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS=$1
+
+O="--quiet --options=NONE --pseudo-tags= --sort-method=internal"
+
+for l in 1 1k 64M; do
+	echo "# $l"
+	${CTAGS} $O --sort-memory-limit=$l --sort=foldcase -o - input.c input.c || exit $?
+done
+echo '# invalid'
+${CTAGS} $O --sort-memory-limit=0 -o - input.c
+${CTAGS} $O --sort-memory-limit=1x -o - input.c
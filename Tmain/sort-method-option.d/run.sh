@@ -0,0 +1,13 @@
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS=$1
+
+O="--quiet --options=NONE --pseudo-tags= --sort-method=internal"
+
+echo '# sorted'
+${CTAGS} $O --sort=yes -o - input.c input.c &&
+echo '# foldcase' &&
+${CTAGS} $O --sort=foldcase -o - input.c input.c &&
+echo '# invalid' &&
+${CTAGS} $O --sort-method=quick -o - input.c
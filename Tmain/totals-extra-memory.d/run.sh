@@ -0,0 +1,17 @@
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS=$1
+
+. ../utils.sh
+
+stats=/tmp/ctags-Tmain-$$
+${CTAGS} --quiet --options=NONE --totals=extra -o - input.c > /dev/null 2> ${stats}
+if grep -q "^not available" ${stats}; then
+	rm ${stats}
+	skip "memory accounting is not available"
+fi
+
+sed -n -e '/^MEMORY USAGE.*/,$p' ${stats} \
+	| sed -e 's/  */ /g' -e 's/[0-9][0-9]*/N/g'
+rm ${stats}
@@ -0,0 +1,2 @@
+struct point { int x, y; };
+static int origin (struct point *p) { return p->x == 0 && p->y == 0; }
@@ -0,0 +1,14 @@
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS=$1
+
+# The numbers vary from run to run.
+${CTAGS} --quiet --options=NONE --totals=extra -o - input.c 2>&1 > /dev/null \
+	| sed -n -e '/^TIMING.*/,/^$/p' \
+	| sed -e 's/, "maxrss": -*[0-9]*//' -e 's/[0-9][0-9.]*/N/g'
+
+# The time of a guest parser is accounted to its language.
+${CTAGS} --quiet --options=NONE --extras=+g --totals=extra -o - input.html 2>&1 > /dev/null \
+	| sed -n -e 's/.*"languages": {\(.*\)}, "total".*/\1/p' \
+	| sed -e 's/[0-9][0-9.]*/N/g'
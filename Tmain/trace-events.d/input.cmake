@@ -0,0 +1,3 @@
+set(VAR 1)
+function(f)
+endfunction()
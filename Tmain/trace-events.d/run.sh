@@ -0,0 +1,14 @@
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS=$1
+BUILDDIR=$2
+
+O=${BUILDDIR}/trace-events.json
+
+# The spans of the files, the parsers, a promise, a regex table,
+# writing the cork queue, and sorting.
+${CTAGS} --quiet --options=NONE --pseudo-tags= --extras=+g --trace-events=$O -o $BUILDDIR/trace-events.tags \
+		 input.html input.cmake
+sed -e 's/"ts": [0-9.]*/"ts": N/' $O
+rm -f $O $BUILDDIR/trace-events.tags
@@ -0,0 +1,6 @@
+int counter;
+static int getCounter (void) { return counter; }
+static void setCounter (int n) { counter = n; }
+static void resetCounters (void) { counter = 0; }
+struct COUNTER { int c; };
+int main (void) { return getCounter (); }
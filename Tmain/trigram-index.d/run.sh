@@ -0,0 +1,53 @@
+#!/bin/sh
+
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS=$1
+BUILDDIR=$2
+READTAGS=$3
+
+. ../utils.sh
+
+if ! [ -x "${READTAGS}" ]; then
+	skip "no readtags"
+fi
+
+O=${BUILDDIR}/trigram-index.tmp
+
+find_counters()
+{
+	${READTAGS} -c -t $O Counter &&
+	${READTAGS} -c -i -t $O counter &&
+	${READTAGS} -c -t $O xyz &&
+	${READTAGS} -c -t $O et
+}
+
+rm -f $O $O.tri
+echo '# index' &&
+${CTAGS} --quiet --options=NONE --trigram-index --pseudo-tags=TAG_TRIGRAM_INDEX -o $O input.c &&
+grep '^!_TAG_TRIGRAM_INDEX' $O &&
+head -n 1 $O.tri | awk -F'\t' -v OFS='\t' 'NR == 1 { $3 = "SIZE" } { print }' &&
+
+echo '# find' &&
+find_counters > $O.indexed &&
+cat $O.indexed &&
+
+echo '# without the index' &&
+mv $O.tri $O.tri.saved &&
+find_counters | cmp - $O.indexed &&
+
+echo '# broken index' &&
+head -c 60 $O.tri.saved > $O.tri &&
+find_counters | cmp - $O.indexed &&
+
+echo '# unsorted' &&
+${CTAGS} --quiet --options=NONE --trigram-index --sort=no -o $O input.c &&
+${READTAGS} -c -t $O Counter &&
+
+echo '# stdout' &&
+${CTAGS} --quiet --options=NONE --trigram-index -o - input.c > /dev/null
+
+s=$?
+rm -f $O $O.tri $O.tri.saved $O.indexed
+exit $s
@@ -0,0 +1,32 @@
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS=$1
+BUILDDIR=$2
+
+O="--quiet --options=NONE --extras=-p --fields=-t --sort-method=internal"
+T=${BUILDDIR}/tags
+L=${BUILDDIR}/update.list
+
+printf 'M\tinput-a.c\nD\tgone.c\nR100\told.c\tinput-b.c\n' > $L
+
+# The tags of input-a.c, gone.c, and old.c are replaced; kept.c stays.
+printf '!_TAG_FILE_SORTED\t1\t/0=unsorted, 1=sorted, 2=foldcase/\nfoo\tgone.c\t/^foo$/;"\tv\nkeep\tkept.c\t/^keep$/;"\tv\nold\told.c\t/^old$/;"\tv\nstale\tinput-a.c\t/^stale$/;"\tv\n' > $T
+${CTAGS} $O -f $T --update-from=$L
+echo '# sorted'
+cat $T
+
+printf '!_TAG_FILE_SORTED\t0\t/0=unsorted, 1=sorted, 2=foldcase/\nstale\tinput-a.c\t/^stale$/;"\tv\nkeep\tkept.c\t/^keep$/;"\tv\nfoo\tgone.c\t/^foo$/;"\tv\nold\told.c\t/^old$/;"\tv\n' > $T
+${CTAGS} $O --sort=no -f $T --update-from=$L
+echo '# unsorted'
+cat $T
+
+# Only removed: a file name not found is removed.
+printf '!_TAG_FILE_SORTED\t1\t/0=unsorted, 1=sorted, 2=foldcase/\nfoo\tgone.c\t/^foo$/;"\tv\nkeep\tkept.c\t/^keep$/;"\tv\n' > $T
+echo gone.c | ${CTAGS} $O -f $T --update-from=-
+echo '# removed'
+cat $T
+
+s=$?
+rm -f $T ${T}.tmp $L
+exit $s
@@ -0,0 +1,27 @@
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS=$1
+BUILDDIR=$2
+
+D=${BUILDDIR}/use-ignore-files-option.tmp
+
+# The tree is made here; ignore files in the source tree would
+# affect git itself.
+rm -rf $D
+mkdir -p $D/node_modules/x $D/build $D/src/sub $D/src/build $D/keep $D/docs
+for f in node_modules/x/m.c build/b.c src/build/sb.c src/a.c src/sub/gen.c \
+		 src/sub/s.c src/x.h top.h keep/k.c docs/d.c top.c; do
+	echo "int v_$(echo $f | tr '/.' '__');" > $D/$f
+done
+printf 'node_modules/\n/build\n*.h\n# comment\n\nkeep/\n!keep/\n**/d.c\n' > $D/.gitignore
+printf 'gen.c\n' > $D/src/sub/.ignore
+printf '!*.h\n' > $D/src/.ignore
+
+echo '# yes'
+(cd $D && ${CTAGS} --quiet --options=NONE --use-ignore-files -R -o - | cut -f2)
+echo '# no'
+(cd $D && ${CTAGS} --quiet --options=NONE -R -o - | cut -f2)
+s=$?
+rm -rf $D
+exit $s
@@ -0,0 +1,8 @@
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS=$1
+# "input" is larger than the window read for guessing.  The line
+# count of "input-short" used to make the last line invisible to the
+# taster of vim modeline at EOF.
+$CTAGS --quiet --options=NONE -G --print-language input input-short
@@ -0,0 +1,31 @@
+#if 0
+int a0; /* a comment
+#endif
+*/
+const char *s0 = "#endif";
+#define M0 x
+int c0 = 1'000 + 'x' + '#' + 0xf'f;
+#if 1
+int a1;
+#endif
+  x \
+#endif
+#else
+int b0;
+#endif
+
+#if 0
+int a2, '\'', "\"";
+??=else
+int b1;
+#endif
+
+#if 0
+int a3; // a comment \
+#else
+%:else
+int b2;
+  %:define M1
+  ??=define M2
+#endif
+int b3;
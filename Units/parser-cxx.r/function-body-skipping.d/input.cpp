@@ -0,0 +1,63 @@
+// Function bodies are skipped when no local tag can be made:
+// the tags made in them must still be found.
+#define CLOSE }
+
+int f0(int a)
+{
+	const char * s = "}{ '\"";
+	char c = '}';
+	const char * r = R"xx(} { )" })xx";
+	/* } */
+	// }
+	if(a) { return a + '{'; } else { a++; }
+	for(int i = 0;i < a;i++)
+		switch(i) { case 1: break; default: goto out; }
+out:
+	return s[0] + c + r[0];
+}
+
+int f1(int a)
+{
+	struct S1 { int m1; } s1 = { 1 };
+	enum E1 { e1 };
+	auto l = [](int x) { struct S2 { int m2; }; return x; };
+	std::vector<int> v { 1, 2 };
+	int arr[2] { 1, 2 };
+	return l(a) + s1.m1 + v[0] + arr[0];
+}
+
+void f2()
+{
+	WRAP(S3) { int m3; };
+	class C1 { public: int m4; };
+	typedef int T1;
+	using T2 = int;
+#if 0
+	}
+#endif
+}
+
+int f3() { return {}; }
+
+void f4()
+{
+	[[maybe_unused]] int unused = 0;
+	__attribute__((unused)) int unused2 = 0;
+	try { throw 1; } catch(int e) { }
+	do { } while(0);
+}
+
+struct S4
+{
+	int m5() { union U1 { int u; }; return 0; }
+	int m6;
+};
+
+int f5(int a) try { return a; } catch(...) { return 0; }
+
+void f6()
+{
+	auto c = [&](){ return [](){ struct S5 {}; }; };
+}
+
+int g0;
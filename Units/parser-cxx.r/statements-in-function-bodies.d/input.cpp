@@ -0,0 +1,20 @@
+struct Point
+{
+	int x;
+	int y;
+
+	template <class Archive>
+	void serialize (Archive & ar, const unsigned int version)
+	{
+		ar & boost::make_nvp ("x", x);
+		ar & boost::make_nvp ("y", y);
+		a * b;
+	}
+};
+
+int area (const Point & p)
+{
+	struct Local { int w; };
+	Local l;
+	return p.x * p.y;
+}
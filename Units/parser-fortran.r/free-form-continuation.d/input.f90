@@ -0,0 +1,15 @@
+      module shapes
+        interface
+          subroutine draw (x, y,  &
+                           colour)
+            real :: x, y
+            integer :: colour
+          end subroutine draw
+        end interface
+      contains
+        function area (w, &
+                       h)
+          real :: area, w, h
+          area = w * h
+        end function area
+      end module shapes
@@ -0,0 +1,8 @@
+CXX = g++
+CFLAGS = -O2
+LIBS += -lm
+CC := c++
+LDFLAGS = -Wl,-rpath,/usr/lib++ \
+	-L/opt/lib
+OBJS = main.o
+all: prog
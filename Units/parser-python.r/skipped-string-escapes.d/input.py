@@ -0,0 +1,24 @@
+# Strings whose contents are not tagged are skipped at once; the
+# escapes and the quotes inside them must not end them early.
+
+"""docstring with \""" and a " and ''' inside"""
+a = 'it\'s # not a comment'
+def f1(x='a\\'):  # comment with a " quote
+    """a docstring \
+ending with """
+    return x
+
+b = "line \
+continued" ; c = 1
+d = '''single
+triple with \''' and "" inside''' # 'comment'
+def f2(y="""d"e"f"""):
+    e = ''  # empty
+    g = r'\'' + "''" + '""'
+    pass
+
+class C:
+    '\\'
+    h = "\\"
+    def m(self, z='\\"'):
+        pass
@@ -0,0 +1,16 @@
+#![allow(dead_code)]
+
+#[instrument(fields(keywords.impl.type.fn = _arg), skip(_arg))]
+fn after_keywords(_arg: &str) {}
+
+#[doc = "a ] in a string, and fn in a comment"] // fn commented()
+struct Point {
+    #[serde(rename = "x")]
+    x: i32,
+}
+
+macro_rules! make {
+    ($name:ident) => { fn $name() { let s = "}"; } };
+}
+
+fn after_macro() {}
@@ -0,0 +1,14 @@
+CREATE TABLE items (id integer, kind varchar(10));
+INSERT INTO items (id, kind) VALUES (1, 'table'), (2, 'it''s; quoted'), (3, "view");
+INSERT INTO items VALUES
+  (4, 'multi
+line; value'), -- a comment; with a terminator
+  (5, /* create table c1 (x int); */ 'x');
+CREATE VIEW items_view AS SELECT * FROM items;
+COPY items (id, kind) FROM stdin;
+6	create table bogus (x int);
+7	it's
+\.
+CREATE TABLE after_copy (id integer);
+COPY items TO stdout;
+CREATE TABLE after_copy_out (id integer);
@@ -18,9 +18,30 @@
 /*
  * TYPES
  */
+typedef struct sDSLNode DSLNode;
+typedef EsObject* (* DSLNodeProc) (DSLNode *node, DSLEnv *env);
+
+/* A node of the tree dsl_compile () makes from an expression. The forms
+ * testing fields are run on the strings of the tag entry; the other
+ * forms are evaluated by dsl_eval0 (). */
+struct sDSLNode
+{
+	DSLNodeProc proc;
+	EsObject *expr;
+	/* the arguments of and, or, and not */
+	DSLNode **args;
+	int count;
+	/* the field and the string or regex to test it with */
+	DSLFieldProc field;
+	EsObject *operand;
+	const char *str;
+	size_t len;
+};
+
 struct sDSLCode
 {
 	EsObject *expr;
+	DSLNode *node;
 };
 
 struct sDSLEngine
@@ -97,6 +118,7 @@ DECLARE_VALUE_FN(implementation);
 DECLARE_VALUE_FN(kind);
 DECLARE_VALUE_FN(language);
 DECLARE_VALUE_FN(nth);
+DECLARE_VALUE_FN(offset);
 DECLARE_VALUE_FN(scope);
 DECLARE_VALUE_FN(scope_kind);
 DECLARE_VALUE_FN(scope_name);
@@ -107,6 +129,8 @@ DECLARE_VALUE_FN(typeref_name);
 DECLARE_VALUE_FN(roles);
 DECLARE_VALUE_FN(xpath);
 
+static const char* entry_xget (const tagEntry *entry, const char* name);
+
 static EsObject* macro_string_append (EsObject *args);
 static EsObject* macro_string2regexp (EsObject *args);
 static EsObject* macro_regexp_quote (EsObject *args);
@@ -116,6 +140,7 @@ static EsObject* macro_debug_printX (EsObject *args);
  * DATA DEFINITIONS
  */
 static DSLEngine engines [DSL_ENGINE_COUNT];
+static DSLProcBind *cached_pbinds;
 
 static DSLProcBind pbinds_interanl_pseudo [] = {
 	{ "#/PATTERN/", NULL, NULL, 0, 0,
@@ -216,6 +241,8 @@ static DSLProcBind pbinds [] = {
 	  .helpstr = "-> #f|<string>" },
 	{ "$nth",            value_nth,            NULL, DSL_PATTR_MEMORABLE, 0UL,
 	  .helpstr = "-> #f|<integer>"},
+	{ "$offset",         value_offset,         NULL, DSL_PATTR_MEMORABLE, 0UL,
+	  .helpstr = "-> #f|<integer>; byte offset of the line in the input file"},
 	{ "$kind",           value_kind,           NULL, DSL_PATTR_MEMORABLE, 0UL,
 	  .helpstr = "-> #f|<string>"},
 	{ "$language",       value_language,       NULL, DSL_PATTR_MEMORABLE, 0UL,
@@ -323,20 +350,28 @@ void dsl_help (DSLEngineType engine, FILE *fp)
 	dsl_help0 (engine, fp);
 }
 
-static void dsl_cache_reset0 (DSLProcBind  *pb)
+static EsObject *dsl_cache_set (DSLProcBind *pb, EsObject *r)
 {
 	if (pb->flags & DSL_PATTR_MEMORABLE)
-		pb->cache = NULL;
+	{
+		pb->cache = r;
+		pb->cache_next = cached_pbinds;
+		cached_pbinds = pb;
+	}
+	return r;
 }
 
+/* Only the bindings cached since the last reset are walked. */
 void dsl_cache_reset (DSLEngineType engine)
 {
-	for (int i = 0; i < sizeof(pbinds)/sizeof(pbinds [0]); i++)
-		dsl_cache_reset0 (pbinds + i);
+	while (cached_pbinds)
+	{
+		DSLProcBind *pb = cached_pbinds;
 
-	DSLEngine *e = engines + engine;
-	for (int i = 0; i < e->pbinds_count; i++)
-		dsl_cache_reset0( e->pbinds + i);
+		cached_pbinds = pb->cache_next;
+		pb->cache = NULL;
+		pb->cache_next = NULL;
+	}
 }
 
 static int length (EsObject *object)
@@ -387,9 +422,7 @@ static EsObject *dsl_eval0 (EsObject *object, DSLEnv *env)
 				return pb->cache;
 
 			r = pb->proc (es_nil, env);
-			if (pb->flags & DSL_PATTR_MEMORABLE)
-				pb->cache = r;
-			return r;
+			return dsl_cache_set (pb, r);
 		}
 		else
 			dsl_throw (UNBOUND_VARIABLE, object);
@@ -468,17 +501,418 @@ static EsObject *dsl_eval0 (EsObject *object, DSLEnv *env)
 		}
 
 		r = pb->proc (cdr, env);
-		if (pb->flags & DSL_PATTR_MEMORABLE)
-			pb->cache = r;
-		return r;
+		return dsl_cache_set (pb, r);
 	}
 	else
 		dsl_throw (CALLABLE_REQUIRED, car);
 }
 
+/*
+ * Fields read without making objects
+ */
+#define DEFINE_XGET_FIELD_FN(N, KEY)									\
+static const char* field_##N (const tagEntry *entry, size_t *len)		\
+{																		\
+	const char *value = entry_xget (entry, KEY);						\
+	if (value)															\
+		*len = strlen (value);											\
+	return value;														\
+}
+
+static const char* field_string (const char *value, size_t *len)
+{
+	if (value)
+		*len = strlen (value);
+	return value;
+}
+
+static const char* field_name (const tagEntry *entry, size_t *len)
+{
+	return field_string (entry->name, len);
+}
+
+static const char* field_input (const tagEntry *entry, size_t *len)
+{
+	return field_string (entry->file, len);
+}
+
+static const char* field_pattern (const tagEntry *entry, size_t *len)
+{
+	return field_string (entry->address.pattern, len);
+}
+
+static const char* field_kind (const tagEntry *entry, size_t *len)
+{
+	return field_string (entry->kind, len);
+}
+
+DEFINE_XGET_FIELD_FN(access, "access")
+DEFINE_XGET_FIELD_FN(extras, "extras")
+DEFINE_XGET_FIELD_FN(inherits, "inherits")
+DEFINE_XGET_FIELD_FN(implementation, "implementation")
+DEFINE_XGET_FIELD_FN(language, "language")
+DEFINE_XGET_FIELD_FN(scope, "scope")
+DEFINE_XGET_FIELD_FN(signature, "signature")
+DEFINE_XGET_FIELD_FN(typeref, "typeref")
+DEFINE_XGET_FIELD_FN(roles, "roles")
+DEFINE_XGET_FIELD_FN(xpath, "xpath")
+
+/* KEY is "scope" or "typeref"; do the same as dsl_entry_scope_kind ()
+ * and the others. */
+static const char* field_kind_part (const tagEntry *entry, const char *key, size_t *len)
+{
+	const char *value = entry_xget (entry, key);
+	const char *sep;
+
+	if (value == NULL || (sep = strchr (value, ':')) == NULL)
+		return NULL;
+	*len = sep - value;
+	return value;
+}
+
+static const char* field_name_part (const tagEntry *entry, const char *key, size_t *len)
+{
+	const char *value = entry_xget (entry, key);
+	const char *sep;
+
+	if (value == NULL || (sep = strchr (value, ':')) == NULL
+		|| *(sep + 1) == '\0')
+		return NULL;
+	return field_string (sep + 1, len);
+}
+
+static const char* field_scope_kind (const tagEntry *entry, size_t *len)
+{
+	return field_kind_part (entry, "scope", len);
+}
+
+static const char* field_scope_name (const tagEntry *entry, size_t *len)
+{
+	return field_name_part (entry, "scope", len);
+}
+
+static const char* field_typeref_kind (const tagEntry *entry, size_t *len)
+{
+	return field_kind_part (entry, "typeref", len);
+}
+
+static const char* field_typeref_name (const tagEntry *entry, size_t *len)
+{
+	return field_name_part (entry, "typeref", len);
+}
+
+static struct {
+	DSLProc value;
+	DSLFieldProc field;
+} field_procs [] = {
+	{ value_name,           field_name },
+	{ value_input,          field_input },
+	{ value_pattern,        field_pattern },
+	{ value_access,         field_access },
+	{ value_extras,         field_extras },
+	{ value_inherits,       field_inherits },
+	{ value_implementation, field_implementation },
+	{ value_kind,           field_kind },
+	{ value_language,       field_language },
+	{ value_scope,          field_scope },
+	{ value_scope_kind,     field_scope_kind },
+	{ value_scope_name,     field_scope_name },
+	{ value_signature,      field_signature },
+	{ value_typeref,        field_typeref },
+	{ value_typeref_kind,   field_typeref_kind },
+	{ value_typeref_name,   field_typeref_name },
+	{ value_roles,          field_roles },
+	{ value_xpath,          field_xpath },
+};
+
+static DSLFieldProc lookup_field (DSLEngineType engine, EsObject *object)
+{
+	DSLProcBind *pb;
+
+	if (!es_symbol_p (object))
+		return NULL;
+	pb = dsl_lookup (engine, object);
+	if (pb == NULL)
+		return NULL;
+
+	for (int i = 0; i < sizeof(field_procs)/sizeof(field_procs [0]); i++)
+	{
+		if (field_procs [i].value == pb->proc)
+			return field_procs [i].field;
+	}
+	return NULL;
+}
+
+/*
+ * Evaluating the tree of nodes
+ */
+static EsObject *node_eval (DSLNode *node, DSLEnv *env)
+{
+	return dsl_eval0 (node->expr, env);
+}
+
+/* Do the same as sfrom_and (). */
+static EsObject *node_and (DSLNode *node, DSLEnv *env)
+{
+	EsObject *o = es_true;
+
+	for (int i = 0; i < node->count; i++)
+	{
+		o = node->args [i]->proc (node->args [i], env);
+		if (es_object_equal (o, es_false))
+			return es_false;
+		else if (es_error_p (o))
+			return o;
+	}
+	return o;
+}
+
+/* Do the same as sform_or (). */
+static EsObject *node_or (DSLNode *node, DSLEnv *env)
+{
+	EsObject *o;
+
+	for (int i = 0; i < node->count; i++)
+	{
+		o = node->args [i]->proc (node->args [i], env);
+		if (! es_object_equal (o, es_false))
+			return o;
+	}
+	return es_false;
+}
+
+/* Do the same as builtin_not (). */
+static EsObject *node_not (DSLNode *node, DSLEnv *env)
+{
+	EsObject *o = node->args [0]->proc (node->args [0], env);
+
+	if (es_object_equal (o, es_false))
+		return es_true;
+	else if (es_error_p (o))
+		return o;
+	else
+		return es_false;
+}
+
+static EsObject *node_eq (DSLNode *node, DSLEnv *env)
+{
+	size_t len;
+	const char *s = node->field (env->entry, &len);
+
+	return (s && len == node->len && memcmp (s, node->str, len) == 0)
+		? es_true
+		: es_false;
+}
+
+/* A field of #f is an error reported by node_eval (). */
+#define DEFINE_NODE_STRING_TEST(N, X)							\
+static EsObject *node_##N (DSLNode *node, DSLEnv *env)			\
+{																\
+	size_t len;													\
+	const char *s = node->field (env->entry, &len);				\
+																\
+	if (s == NULL)												\
+		return node_eval (node, env);							\
+	return (X)? es_true: es_false;								\
+}
+
+static int contains (const char *s, size_t len, const char *str, size_t l)
+{
+	if (l == 0)
+		return 1;
+	for (; len >= l; s++, len--)
+	{
+		if (*s == *str && memcmp (s, str, l) == 0)
+			return 1;
+	}
+	return 0;
+}
+
+DEFINE_NODE_STRING_TEST(prefix, len >= node->len && memcmp (s, node->str, node->len) == 0)
+DEFINE_NODE_STRING_TEST(suffix, len >= node->len && memcmp (s + len - node->len, node->str, node->len) == 0)
+DEFINE_NODE_STRING_TEST(substr, contains (s, len, node->str, node->len))
+
+/* A part of a field is not terminated; node_eval () makes a string for it. */
+static EsObject *node_regex (DSLNode *node, DSLEnv *env)
+{
+	size_t len;
+	const char *s = node->field (env->entry, &len);
+
+	if (s == NULL || s [len] != '\0')
+		return node_eval (node, env);
+	return es_regex_exec_cstr (node->operand, s);
+}
+
+static void node_free (DSLNode *node)
+{
+	if (node == NULL)
+		return;
+	for (int i = 0; i < node->count; i++)
+		node_free (node->args [i]);
+	free (node->args);
+	free (node);
+}
+
+/* Return the node for the test of a field with the string or regex, or
+ * NULL if EXPR is not such a test. */
+static DSLNode *node_new_string_test (DSLEngineType engine, DSLProcBind *pb,
+									  EsObject *expr)
+{
+	static const struct {
+		DSLProc proc;
+		DSLNodeProc node;
+	} tests [] = {
+		{ builtin_eq,     node_eq },
+		{ builtin_prefix, node_prefix },
+		{ builtin_suffix, node_suffix },
+		{ builtin_substr, node_substr },
+	};
+	EsObject *a = es_car (es_cdr (expr));
+	EsObject *b = es_car (es_cdr (es_cdr (expr)));
+	DSLNodeProc proc = NULL;
+	DSLFieldProc field;
+	DSLNode *node;
+
+	for (int i = 0; i < sizeof(tests)/sizeof(tests [0]); i++)
+	{
+		if (tests [i].proc == pb->proc)
+			proc = tests [i].node;
+	}
+	if (proc == NULL)
+		return NULL;
+
+	/* (eq? "..." $field) is the same as (eq? $field "..."). */
+	if (proc == node_eq && es_string_p (a))
+	{
+		EsObject *t = a;
+		a = b;
+		b = t;
+	}
+	if (!es_string_p (b) || (field = lookup_field (engine, a)) == NULL)
+		return NULL;
+
+	node = calloc (1, sizeof (DSLNode));
+	if (node == NULL)
+		return NULL;
+	node->proc = proc;
+	node->expr = expr;
+	node->field = field;
+	node->operand = b;
+	node->str = es_string_get (b);
+	node->len = strlen (node->str);
+	return node;
+}
+
+/* Make the tree of nodes for EXPR compiled already. A node of a form not
+ * run directly evaluates the form with dsl_eval0 (); the errors are the
+ * ones of the evaluator. Return NULL only if memory is exhausted. */
+static DSLNode *node_new (DSLEngineType engine, EsObject *expr)
+{
+	DSLNode *node = NULL;
+
+	if (es_cons_p (expr) && es_list_p (expr))
+	{
+		EsObject *car = es_car (expr);
+		EsObject *cdr = es_cdr (expr);
+		int l = length (cdr);
+		DSLProcBind *pb = es_symbol_p (car)? dsl_lookup (engine, car): NULL;
+
+		if (pb && (pb->proc == sfrom_and || pb->proc == sform_or
+				   || (pb->proc == builtin_not && l == 1)))
+		{
+			node = calloc (1, sizeof (DSLNode));
+			if (node == NULL)
+				return NULL;
+			node->proc = (pb->proc == sfrom_and)? node_and
+				: (pb->proc == sform_or)? node_or
+				: node_not;
+			node->expr = expr;
+			node->args = calloc (l? l: 1, sizeof (DSLNode *));
+			if (node->args == NULL)
+				goto error;
+			for (; !es_null (cdr); cdr = es_cdr (cdr))
+			{
+				node->args [node->count] = node_new (engine, es_car (cdr));
+				if (node->args [node->count] == NULL)
+					goto error;
+				node->count++;
+			}
+			return node;
+		}
+		else if (pb && l == 2)
+			node = node_new_string_test (engine, pb, expr);
+		else if (es_regex_p (car) && l == 1
+				 && (node = calloc (1, sizeof (DSLNode))))
+		{
+			node->field = lookup_field (engine, es_car (cdr));
+			if (node->field)
+			{
+				node->proc = node_regex;
+				node->expr = expr;
+				node->operand = car;
+				return node;
+			}
+			free (node);
+			node = NULL;
+		}
+	}
+
+	if (node == NULL)
+	{
+		node = calloc (1, sizeof (DSLNode));
+		if (node == NULL)
+			return NULL;
+		node->proc = node_eval;
+		node->expr = expr;
+	}
+	return node;
+
+ error:
+	node_free (node);
+	return NULL;
+}
+
 EsObject *dsl_eval (DSLCode *code, DSLEnv *env)
 {
-	return dsl_eval0 (code->expr, env);
+	return code->node->proc (code->node, env);
+}
+
+/* Return 1 if NODE evaluates to #f for the tags of the names not equal to,
+ * or starting with if *PARTIAL is set to 1, *NAME. Return 0 if NODE never
+ * evaluates to an error, and -1 if it may. */
+static int node_name_constraint (DSLNode *node, const char **name, int *partial)
+{
+	if (node->proc == node_and)
+	{
+		/* An argument after one evaluating to an error for a tag is
+		 * not evaluated; the error is reported for the tag even if
+		 * a later argument rejects it. */
+		for (int i = 0; i < node->count; i++)
+		{
+			int r = node_name_constraint (node->args [i], name, partial);
+			if (r != 0)
+				return r;
+		}
+		return 0;
+	}
+	else if (node->proc == node_eq || node->proc == node_prefix)
+	{
+		if (node->field != field_name)
+			return (node->proc == node_eq)? 0: -1;
+		*name = node->str;
+		*partial = (node->proc == node_prefix);
+		return 1;
+	}
+	return -1;
+}
+
+const char *dsl_name_constraint (DSLCode *code, int *partial)
+{
+	const char *name = NULL;
+
+	if (node_name_constraint (code->node, &name, partial) != 1)
+		return NULL;
+	return name;
 }
 
 EsObject *dsl_compile_and_eval (EsObject *expr, DSLEnv *env)
@@ -531,11 +965,46 @@ DSLCode *dsl_compile (DSLEngineType engine, EsObject *expr)
 		free (code);
 		return NULL;
 	}
+
+	code->node = node_new (engine, code->expr);
+	if (code->node == NULL)
+	{
+		es_object_unref (code->expr);
+		free (code);
+		return NULL;
+	}
+	return code;
+}
+
+EsObject *dsl_code_expr (DSLCode *code)
+{
+	return code->expr;
+}
+
+DSLCode *dsl_code_new (DSLEngineType engine, EsObject *expr)
+{
+	DSLCode *code = malloc (sizeof (DSLCode));
+	if (code == NULL)
+		return NULL;
+
+	code->node = node_new (engine, expr);
+	if (code->node == NULL)
+	{
+		free (code);
+		return NULL;
+	}
+	code->expr = es_object_ref (expr);
 	return code;
 }
 
+DSLFieldProc dsl_lookup_field (DSLEngineType engine, EsObject *object)
+{
+	return lookup_field (engine, object);
+}
+
 void dsl_release (DSLEngineType engine, DSLCode *code)
 {
+	node_free (code->node);
 	es_object_unref (code->expr);
 	free (code);
 }
@@ -907,6 +1376,7 @@ DEFINE_VALUE_FN(implementation)
 DEFINE_VALUE_FN(kind)
 DEFINE_VALUE_FN(language)
 DEFINE_VALUE_FN(nth)
+DEFINE_VALUE_FN(offset)
 DEFINE_VALUE_FN(scope)
 DEFINE_VALUE_FN(scope_kind)
 DEFINE_VALUE_FN(scope_name)
@@ -1004,6 +1474,11 @@ EsObject* dsl_entry_nth (const tagEntry *entry)
 	return dsl_entry_xget_integer(entry, "nth");
 }
 
+EsObject* dsl_entry_offset (const tagEntry *entry)
+{
+	return dsl_entry_xget_integer(entry, "offset");
+}
+
 EsObject* dsl_entry_implementation (const tagEntry *entry)
 {
 	return dsl_entry_xget_string (entry, "implementation");
@@ -57,10 +57,17 @@ struct sDSLProcBind {
 	int arity;
 	const char* helpstr;
 	DSLMacro macro;
+
+	/* used internally: the next binding in the list of cached ones */
+	DSLProcBind *cache_next;
 };
 
 typedef struct sDSLCode DSLCode;
 
+/* Returns the value of a string field of ENTRY without making an
+ * object, or NULL if the value is #f. */
+typedef const char* (* DSLFieldProc) (const tagEntry *entry, size_t *len);
+
 #define DSL_ERR_UNBOUND_VARIABLE    (es_error_intern("unbound-variable"))
 #define DSL_ERR_TOO_FEW_ARGUMENTS   (es_error_intern("too-few-arguments"))
 #define DSL_ERR_TOO_MANY_ARGUMENTS  (es_error_intern("too-many-arguments"))
@@ -90,6 +97,22 @@ void           dsl_help        (DSLEngineType engine, FILE *fp);
 void           dsl_cache_reset (DSLEngineType engine);
 DSLCode       *dsl_compile     (DSLEngineType engine, EsObject *expr);
 EsObject      *dsl_eval        (DSLCode *code, DSLEnv *env);
+
+/* Return the string the names of the tags CODE evaluates to non-#f are
+ * equal to, or start with if *PARTIAL is set to 1. Return NULL if CODE
+ * doesn't test the name that way before anything evaluating to an error. */
+const char    *dsl_name_constraint (DSLCode *code, int *partial);
+
+/* Return the expression CODE is compiled from, with the macros expanded. */
+EsObject      *dsl_code_expr   (DSLCode *code);
+
+/* Make the code for EXPR, a part of the expression of a code made by
+ * dsl_compile (). Return NULL only if memory is exhausted. */
+DSLCode       *dsl_code_new    (DSLEngineType engine, EsObject *expr);
+
+/* Return the function reading the field the symbol OBJECT evaluates to
+ * without making an object, or NULL if OBJECT is no such symbol. */
+DSLFieldProc   dsl_lookup_field (DSLEngineType engine, EsObject *object);
 void           dsl_release     (DSLEngineType engine, DSLCode *code);
 
 /* This should be remove when we have a real compiler. */
@@ -113,6 +136,7 @@ EsObject* dsl_entry_implementation (const tagEntry *entry);
 EsObject* dsl_entry_kind (const tagEntry *entry);
 EsObject* dsl_entry_language (const tagEntry *entry);
 EsObject* dsl_entry_nth (const tagEntry *entry);
+EsObject* dsl_entry_offset (const tagEntry *entry);
 EsObject* dsl_entry_scope (const tagEntry *entry);
 EsObject* dsl_entry_scope_kind (const tagEntry *entry);
 EsObject* dsl_entry_scope_name (const tagEntry *entry);
@@ -30,6 +30,7 @@
 #include <string.h>
 #include <errno.h>
 #include <limits.h>
+#include <stdint.h>
 
 #include <regex.h>
 
@@ -84,6 +85,7 @@ struct _EsSingleton
 {
 	EsObject     base;
 	char*        quark;
+	unsigned long hash;
 };
 
 struct _EsSymbol
@@ -180,8 +182,8 @@ static void es_pointer_print(const EsObject* object, MIO* fp);
 
 static EsSingleton* es_obarray_intern(EsType type, const char* name);
 static const char*  es_singleton_get   (EsSingleton *singleton);
-static unsigned int hash(const char* keyarg);
-#define OBARRAY_SIZE    83
+static unsigned long djb2(unsigned char *str);
+#define OBARRAY_SIZE    521
 static EsSingleton  *symbol_obarray[OBARRAY_SIZE];
 static EsSingleton  *error_obarray [OBARRAY_SIZE];
 
@@ -324,6 +326,17 @@ static MIO *mio_stderr (void)
 
 
 
+/* An integer that fits in a pointer is not allocated: it is stored in
+ * the pointer itself, shifted left by one, with the lowest bit set. The
+ * lowest bit of an allocated object is 0. */
+#define ES_IMMEDIATE_P(object) ((((uintptr_t)(object)) & 1) != 0)
+#define ES_IMMEDIATE_INTEGER_P(value)		\
+	(((intptr_t)(value)) >= (INTPTR_MIN >> 1)	\
+	 && ((intptr_t)(value)) <= (INTPTR_MAX >> 1))
+#define ES_IMMEDIATE_INTEGER_NEW(value)						\
+	((EsObject *)((((uintptr_t)(intptr_t)(value)) << 1) | 1))
+#define ES_IMMEDIATE_INTEGER_GET(object) ((int)(((intptr_t)(object)) >> 1))
+
 static EsObjectClass*
 class_of(const EsObject* object)
 {
@@ -371,13 +384,15 @@ const char* es_type_get_name        (int t)
 EsType
 es_object_get_type      (const EsObject*      object)
 {
+	if (ES_IMMEDIATE_P(object))
+		return ES_TYPE_INTEGER;
 	return object? object->type: ES_TYPE_NIL;
 }
 
 EsObject*
 es_object_ref           (EsObject*       object)
 {
-	if (object)
+	if (object && !ES_IMMEDIATE_P(object))
     {
 		if (class_of(object)->obarray)
 			return object;
@@ -396,7 +411,7 @@ void
 es_object_unref         (EsObject*       object)
 {
 
-	if (object)
+	if (object && !ES_IMMEDIATE_P(object))
     {
 		if (class_of(object)->obarray)
 			return;
@@ -491,6 +506,9 @@ es_integer_new (int                value)
 {
 	EsObject* r;
 
+	if (ES_IMMEDIATE_INTEGER_P(value))
+		return ES_IMMEDIATE_INTEGER_NEW(value);
+
 	r = es_object_new(ES_TYPE_INTEGER);
 	((EsInteger*)r)->value = value;
 	return r;
@@ -505,7 +523,9 @@ es_integer_p   (const EsObject*   object)
 int
 es_integer_get (const EsObject*   object)
 {
-	if (es_integer_p(object))
+	if (ES_IMMEDIATE_P(object))
+		return ES_IMMEDIATE_INTEGER_GET(object);
+	else if (es_integer_p(object))
 		return ((EsInteger *)object)->value;
 	else
     {
@@ -689,6 +709,7 @@ es_boolean_print(const EsObject* object, MIO* fp)
 static EsSingleton*
 es_obarray_intern(EsType type, const char* name)
 {
+	unsigned long h;
 	unsigned int hv;
 	EsSingleton** obarray;
 	EsSingleton* s;
@@ -699,13 +720,14 @@ es_obarray_intern(EsType type, const char* name)
 	if (!obarray)
 		return NULL;
 
-	hv = hash(name);
+	h = djb2((unsigned char *)name);
+	hv = (unsigned int)(h % OBARRAY_SIZE);
 	tmp = obarray[hv];
 
 	s = NULL;
 	while (tmp)
     {
-		if (!strcmp(tmp->quark, name))
+		if (tmp->hash == h && !strcmp(tmp->quark, name))
 		{
 			s = tmp;
 			break;
@@ -718,6 +740,7 @@ es_obarray_intern(EsType type, const char* name)
     {
 		s = (EsSingleton*) es_object_new(type);
 		s->quark = strdup(name);
+		s->hash = h;
 		tmp = obarray[hv];
 		obarray[hv] = s;
 		((EsObject *)s)->next = tmp;
@@ -1348,7 +1371,14 @@ EsObject*
 es_regex_exec    (const EsObject* regex,
 				  const EsObject* str)
 {
-	return regexec (((EsRegex*)regex)->code, es_string_get (str),
+	return es_regex_exec_cstr (regex, es_string_get (str));
+}
+
+EsObject*
+es_regex_exec_cstr (const EsObject* regex,
+					const char* str)
+{
+	return regexec (((EsRegex*)regex)->code, str,
 					0, NULL, 0)? es_false: es_true;
 }
 
@@ -1680,10 +1710,6 @@ djb2(unsigned char *str)
 	return hash;
 }
 
-static unsigned int hash(const char* keyarg)
-{
-	return ((unsigned int)djb2((unsigned char *)keyarg)) % OBARRAY_SIZE;
-}
 
 /*
  * Print
@@ -2660,6 +2686,11 @@ es_object_autounref   (EsObject* object)
 {
 	EsChain* r;
 
+	/* Nothing is released for them. */
+	if (object == es_nil || ES_IMMEDIATE_P(object)
+		|| class_of(object)->obarray)
+		return object;
+
 	r = es_chain_new(object);
 	r->next = currrent_pool->chain;
 	currrent_pool->chain = r;
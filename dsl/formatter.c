@@ -54,12 +54,186 @@ static int initialize (void)
 
 /*
  * FCode
+ *
+ * The expression is compiled into steps appending strings and fields
+ * to the output buffer. The forms other than list, if, concat, the
+ * literals, and the string fields are evaluated as before by steps of
+ * FSTEP_EVAL.
  */
+enum eFStepType {
+	FSTEP_STRING,				/* append str */
+	FSTEP_FIELD,				/* append the field unless it is #f */
+	FSTEP_LINE,					/* append the line number unless it is 0 */
+	FSTEP_EVAL,					/* append the value of expr */
+	FSTEP_UNLESS,				/* go to target if test evaluates to #f */
+	FSTEP_GOTO,					/* go to target */
+};
+
+typedef struct sFStep {
+	enum eFStepType type;
+	const char *str;
+	size_t len;
+	DSLFieldProc field;
+	/* For a field of concat, the form to evaluate for the error if
+	 * the field is #f */
+	EsObject *expr;
+	DSLCode *test;
+	int target;
+} FStep;
+
 struct sFCode
 {
 	DSLCode *dsl;
+	FStep *steps;
+	int count;
+	int size;
+	char *buf;
+	size_t len;
+	size_t bufsize;
 };
 
+static DSLProc proc_if;
+static DSLProc proc_concat;
+
+static FStep *add_step (FCode *code, enum eFStepType type)
+{
+	if (code->count == code->size)
+	{
+		int size = code->size? code->size * 2: 16;
+		FStep *steps = realloc (code->steps, size * sizeof (FStep));
+		if (steps == NULL)
+			return NULL;
+		code->steps = steps;
+		code->size = size;
+	}
+
+	FStep *step = code->steps + code->count++;
+	memset (step, 0, sizeof (FStep));
+	step->type = type;
+	return step;
+}
+
+static DSLProc lookup_proc (EsObject *object)
+{
+	DSLProcBind *pb = es_symbol_p (object)
+		? dsl_lookup (DSL_FORMATTER, object)
+		: NULL;
+	return pb? pb->proc: NULL;
+}
+
+static int count_args (EsObject *args)
+{
+	int n = 0;
+
+	for (; !es_null (args); args = es_cdr (args))
+		n++;
+	return n;
+}
+
+/* CONCAT is the form of concat EXPR is an argument of, or NULL.
+ * Return 0 only if memory is exhausted. */
+static int compile_steps (FCode *code, EsObject *expr, EsObject *concat)
+{
+	FStep *step;
+	DSLFieldProc field;
+
+	if (es_string_p (expr))
+	{
+		step = add_step (code, FSTEP_STRING);
+		if (step == NULL)
+			return 0;
+		step->str = es_string_get (expr);
+		step->len = strlen (step->str);
+		return 1;
+	}
+	else if (concat == NULL && es_object_equal (expr, es_false))
+		return 1;
+	else if (concat == NULL && es_object_equal (expr, es_true))
+	{
+		step = add_step (code, FSTEP_STRING);
+		if (step == NULL)
+			return 0;
+		step->str = "\n";
+		step->len = 1;
+		return 1;
+	}
+	else if ((field = dsl_lookup_field (DSL_FORMATTER, expr)))
+	{
+		step = add_step (code, FSTEP_FIELD);
+		if (step == NULL)
+			return 0;
+		step->field = field;
+		step->expr = concat;
+		return 1;
+	}
+	else if (concat == NULL && es_symbol_p (expr)
+			 && strcmp (es_symbol_get (expr), "$line") == 0)
+		return add_step (code, FSTEP_LINE) != NULL;
+	else if (es_cons_p (expr) && es_list_p (expr))
+	{
+		DSLProc proc = lookup_proc (es_car (expr));
+		EsObject *args = es_cdr (expr);
+
+		if (proc && concat == NULL && proc == formatter_proc_list)
+		{
+			for (; !es_null (args); args = es_cdr (args))
+				if (!compile_steps (code, es_car (args), NULL))
+					return 0;
+			return 1;
+		}
+		else if (proc && concat == NULL && proc == proc_if
+				 && count_args (args) == 3)
+		{
+			int unless = code->count;
+			int jump;
+
+			step = add_step (code, FSTEP_UNLESS);
+			if (step == NULL)
+				return 0;
+			step->test = dsl_code_new (DSL_FORMATTER, es_car (args));
+			if (step->test == NULL)
+				return 0;
+			if (!compile_steps (code, es_car (es_cdr (args)), NULL))
+				return 0;
+			jump = code->count;
+			if (add_step (code, FSTEP_GOTO) == NULL)
+				return 0;
+			code->steps [unless].target = code->count;
+			if (!compile_steps (code, es_car (es_cdr (es_cdr (args))), NULL))
+				return 0;
+			code->steps [jump].target = code->count;
+			return 1;
+		}
+		else if (proc && concat == NULL && proc == proc_concat)
+		{
+			int first = code->count;
+
+			for (; !es_null (args); args = es_cdr (args))
+			{
+				EsObject *arg = es_car (args);
+
+				if (!es_string_p (arg)
+					&& dsl_lookup_field (DSL_FORMATTER, arg) == NULL)
+				{
+					/* Evaluate the form as a whole. */
+					code->count = first;
+					goto eval;
+				}
+				if (!compile_steps (code, arg, expr))
+					return 0;
+			}
+			return 1;
+		}
+	}
+
+ eval:
+	step = add_step (code, FSTEP_EVAL);
+	if (step == NULL)
+		return 0;
+	step->expr = expr;
+	return 1;
+}
+
 FCode *f_compile (EsObject *exp)
 {
 	FCode *code;
@@ -67,7 +241,7 @@ FCode *f_compile (EsObject *exp)
 	if (!initialize ())
 		exit (1);
 
-	code = malloc (sizeof (FCode));
+	code = calloc (1, sizeof (FCode));
 	if (code == NULL)
 	{
 		fprintf(stderr, "MEMORY EXHAUSTED\n");
@@ -82,10 +256,53 @@ FCode *f_compile (EsObject *exp)
 		return NULL;
 	}
 
+	if (proc_if == NULL)
+	{
+		proc_if = lookup_proc (es_symbol_intern ("if"));
+		proc_concat = lookup_proc (es_symbol_intern ("concat"));
+	}
+	if (!compile_steps (code, dsl_code_expr (code->dsl), NULL))
+	{
+		fprintf(stderr, "MEMORY EXHAUSTED\n");
+		f_destroy (code);
+		return NULL;
+	}
+
 	return code;
 }
 
-static int f_print0(EsObject *r, FILE *out)
+static int append (FCode *code, const char *s, size_t len)
+{
+	if (code->len + len > code->bufsize)
+	{
+		size_t size = code->bufsize? code->bufsize: 256;
+		char *buf;
+
+		while (size < code->len + len)
+			size *= 2;
+		buf = realloc (code->buf, size);
+		if (buf == NULL)
+		{
+			fprintf(stderr, "MEMORY EXHAUSTED\n");
+			return 1;
+		}
+		code->buf = buf;
+		code->bufsize = size;
+	}
+	memcpy (code->buf + code->len, s, len);
+	code->len += len;
+	return 0;
+}
+
+static int append_integer (FCode *code, long n)
+{
+	char s [32];
+	int len = snprintf (s, sizeof (s), "%ld", n);
+
+	return append (code, s, len);
+}
+
+static int f_print0(EsObject *r, FCode *code)
 {
 	if (es_error_p (r))
 	{
@@ -94,23 +311,17 @@ static int f_print0(EsObject *r, FILE *out)
 	}
 	else if (es_string_p (r))
 	{
-		fputs (es_string_get(r), out);
-		return 0;
+		const char *s = es_string_get(r);
+		return append (code, s, strlen (s));
 	}
 	else if (es_integer_p (r))
-	{
-		fprintf(out, "%d", es_integer_get(r));
-		return 0;
-	}
+		return append_integer (code, es_integer_get(r));
 	else if (es_object_equal(r, es_false))
 	{
 		return 0;
 	}
 	else if (es_object_equal(r, es_true))
-	{
-		putc ('\n', out);
-		return 0;
-	}
+		return append (code, "\n", 1);
 	else if (es_cons_p (r))
 	{
 		EsObject *car = es_car (r);
@@ -119,7 +330,7 @@ static int f_print0(EsObject *r, FILE *out)
 		for (; !es_null (car);
 			 car = es_car (cdr), cdr = es_cdr (cdr))
 		{
-			if (f_print0 (car, out))
+			if (f_print0 (car, code))
 				return 1;
 		}
 		return 0;
@@ -131,9 +342,59 @@ static int f_print0(EsObject *r, FILE *out)
 	}
 }
 
+static int f_run (FCode *code, DSLEnv *env)
+{
+	const tagEntry *entry = env->entry;
+
+	for (int i = 0; i < code->count; i++)
+	{
+		const FStep *step = code->steps + i;
+		const char *s;
+		size_t len;
+		EsObject *r;
+
+		switch (step->type)
+		{
+		case FSTEP_STRING:
+			if (append (code, step->str, step->len))
+				return 1;
+			break;
+		case FSTEP_FIELD:
+			s = step->field (entry, &len);
+			if (s)
+			{
+				if (append (code, s, len))
+					return 1;
+			}
+			else if (step->expr)
+				return f_print0 (dsl_compile_and_eval (step->expr, env), code);
+			break;
+		case FSTEP_LINE:
+			if (entry->address.lineNumber != 0
+				&& append_integer (code, (long) entry->address.lineNumber))
+				return 1;
+			break;
+		case FSTEP_EVAL:
+			if (f_print0 (dsl_compile_and_eval (step->expr, env), code))
+				return 1;
+			break;
+		case FSTEP_UNLESS:
+			r = dsl_eval (step->test, env);
+			if (es_error_p (r))
+				return f_print0 (r, code);
+			if (es_object_equal (r, es_false))
+				i = step->target - 1;
+			break;
+		case FSTEP_GOTO:
+			i = step->target - 1;
+			break;
+		}
+	}
+	return 0;
+}
+
 int f_print (const tagEntry * entry, FCode *code, FILE *out)
 {
-	EsObject *r;
 	int exit_code = 0;
 
 	DSLEnv env = {
@@ -141,21 +402,31 @@ int f_print (const tagEntry * entry, FCode *code, FILE *out)
 		.entry = entry,
 	};
 
+	code->len = 0;
 	es_autounref_pool_push ();
-	r = dsl_eval (code->dsl, &env);
-	exit_code = f_print0 (r, out);
+	exit_code = f_run (code, &env);
 	es_autounref_pool_pop ();
 
 	dsl_cache_reset (DSL_FORMATTER);
 
+	/* Nothing is printed for the entry the expression fails for. */
 	if (exit_code)
 		exit (exit_code);
+	if (code->len > 0)
+		fwrite (code->buf, 1, code->len, out);
 
 	return 0;
 }
 
 void f_destroy        (FCode *code)
 {
+	for (int i = 0; i < code->count; i++)
+	{
+		if (code->steps [i].test)
+			dsl_release (DSL_FORMATTER, code->steps [i].test);
+	}
+	free (code->steps);
+	free (code->buf);
 	dsl_release (DSL_FORMATTER, code->dsl);
 	free (code);
 }
@@ -39,6 +39,8 @@ struct sOptVM
 	int        read_depth;
 	char      *prompt;
 	void      *app_data;
+
+	struct OptVMCounters counters;
 };
 
 typedef struct sOperatorFat
@@ -117,6 +119,8 @@ static EsObject* OPT_KEY_command;
 static EsObject* OPT_KEY_ostack;
 static EsObject* OPT_KEY_estack;
 static EsObject* OPT_KEY_dstack;
+static EsObject* OPT_KEY_mark_array;	/* [ */
+static EsObject* OPT_KEY_mark_dict;		/* << */
 
 /* Naming conversions
  *
@@ -604,6 +608,8 @@ opt_init (void)
 	defKey(ostack);
 	defKey(estack);
 	defKey(dstack);
+	OPT_KEY_mark_array = es_symbol_intern ("[");
+	OPT_KEY_mark_dict = es_symbol_intern ("<<");
 
 	es_autounref_pool_pop ();
 
@@ -810,6 +816,8 @@ vm_eval (OptVM *vm, EsObject * o)
 			EsObject *val  = es_nil;
 			EsObject *dict = vm_dstack_known_and_get (vm, sym, &val);
 
+			vm->counters.lookups++;
+
 			if (es_object_get_type (dict) == OPT_TYPE_DICT)
 			{
 				int t = es_object_get_type (val);
@@ -870,6 +878,21 @@ opt_vm_eval (OptVM *vm, EsObject *obj)
 	return vm_eval (vm, obj);
 }
 
+EsObject *
+opt_vm_exec (OptVM *vm, EsObject *obj)
+{
+	if (es_object_get_type (obj) == OPT_TYPE_ARRAY
+		&& (((ArrayFat *)es_fatptr_get (obj))->attr & ATTR_EXECUTABLE))
+		return vm_call_proc (vm, obj);
+	return vm_eval (vm, obj);
+}
+
+void
+opt_vm_get_counters (OptVM *vm, struct OptVMCounters *counters)
+{
+	*counters = vm->counters;
+}
+
 void
 opt_vm_report_error (OptVM *vm, EsObject *eobj, MIO *err)
 {
@@ -1467,6 +1490,7 @@ vm_call_operator (OptVM *vm, EsObject *op)
 	Operator operator = es_pointer_get (op);
 	OperatorFat *ofat = es_fatptr_get (op);
 
+	vm->counters.operators++;
 	vm_estack_push (vm, op);
 
 	if (ofat->arity > 0)
@@ -1501,6 +1525,7 @@ vm_call_proc     (OptVM *vm, EsObject *proc)
 	ptrArray *a = es_pointer_get (proc);
 	unsigned int c = ptrArrayCount (a);
 
+	vm->counters.procs++;
 	vm_estack_push (vm, proc);
 	for (unsigned int i = 0; i < c; i++)
 	{
@@ -2063,7 +2088,14 @@ opt_es_hash (const void * const key)
 	const EsObject *k = key;
 
 	if (es_integer_p (key))
-		return hashInthash (key);
+	{
+		/* An integer may not be allocated; see es_integer_new ().
+		 * The hash of an integer key has been the one of the type
+		 * stored at the head of the object; the order of the keys
+		 * printed for a dict depends on it. */
+		int t = ES_TYPE_INTEGER;
+		return hashInthash (&t);
+	}
 	else if (es_boolean_p (key))
 		return es_object_equal (key, es_true)? 1: 0;
 
@@ -2826,9 +2858,9 @@ static EsObject*
 op_mark (OptVM *vm, EsObject *name)
 {
 	EsObject *mark;
-	if (es_object_equal (name, es_symbol_intern ("[")))
+	if (es_object_equal (name, OPT_KEY_mark_array))
 		mark = OPT_MARK_ARRAY;
-	else if (es_object_equal (name, es_symbol_intern ("<<")))
+	else if (es_object_equal (name, OPT_KEY_mark_dict))
 		mark = OPT_MARK_DICT;
 	else
 		mark = OPT_MARK_MARK;
@@ -18,6 +18,13 @@
 typedef struct sOptVM OptVM;
 typedef EsObject* (* OptOperatorFn) (OptVM *, EsObject *);
 
+/* The number of operations since the VM is made */
+struct OptVMCounters {
+	unsigned long operators;	/* calls of operators */
+	unsigned long procs;		/* calls of executable arrays */
+	unsigned long lookups;		/* resolving executable names */
+};
+
 struct OptHelpExtender {
 	void        (* add)          (ptrArray *, void *);
 	const char* (* get_help_str) (EsObject *, void *);
@@ -30,8 +37,12 @@ void      opt_vm_delete       (OptVM *vm);
 
 EsObject *opt_vm_read         (OptVM *vm, MIO *in);
 EsObject *opt_vm_eval         (OptVM *vm, EsObject *obj);
+/* Same as pushing OBJ and evaluating //exec. */
+EsObject *opt_vm_exec         (OptVM *vm, EsObject *obj);
 void      opt_vm_report_error (OptVM *vm, EsObject *eobj, MIO *err);
 
+void      opt_vm_get_counters (OptVM *vm, struct OptVMCounters *counters);
+
 void     *opt_vm_set_app_data (OptVM *vm, void *app_data);
 void     *opt_vm_get_app_data (OptVM *vm);
 
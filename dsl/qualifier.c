@@ -100,6 +100,13 @@ enum QRESULT q_is_acceptable  (QCode *code, tagEntry *entry)
 	return i;
 }
 
+/* Only the tags of the names given by the constraint can be accepted;
+ * the other tags need not be read. */
+const char *q_name_constraint (QCode *code, int *partial)
+{
+	return dsl_name_constraint (code->dsl, partial);
+}
+
 void q_destroy (QCode *code)
 {
 	dsl_release (DSL_QUALIFIER, code->dsl);
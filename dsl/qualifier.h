@@ -24,6 +24,7 @@ enum QRESULT {
 
 QCode       *q_compile        (EsObject *exp);
 enum QRESULT q_is_acceptable  (QCode *code, tagEntry *entry);
+const char  *q_name_constraint (QCode *code, int *partial);
 void         q_destroy        (QCode *code);
 void         q_help           (FILE *fp);
 
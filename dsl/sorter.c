@@ -60,6 +60,7 @@ DECLARE_ALT_VALUE_FN(implementation);
 DECLARE_ALT_VALUE_FN(kind);
 DECLARE_ALT_VALUE_FN(language);
 DECLARE_ALT_VALUE_FN(nth);
+DECLARE_ALT_VALUE_FN(offset);
 DECLARE_ALT_VALUE_FN(scope);
 DECLARE_ALT_VALUE_FN(scope_kind);
 DECLARE_ALT_VALUE_FN(scope_name);
@@ -118,6 +119,8 @@ static DSLProcBind pbinds [] = {
 	  .helpstr = "-> #f|<string>" },
 	{ "&nth",            alt_value_nth,            NULL, DSL_PATTR_MEMORABLE, 0UL,
 	  .helpstr = "-> #f|<integer>"},
+	{ "&offset",         alt_value_offset,         NULL, DSL_PATTR_MEMORABLE, 0UL,
+	  .helpstr = "-> #f|<integer>; byte offset of the line in the input file"},
 	{ "&scope",          alt_value_scope,          NULL, DSL_PATTR_MEMORABLE, 0UL,
 	  .helpstr = "-> #f|<string>; $scope-kind:$scope-name"},
 	{ "&scope-kind",     alt_value_scope_kind,     NULL, DSL_PATTR_MEMORABLE, 0UL,
@@ -159,6 +162,7 @@ DEFINE_ALT_VALUE_FN(implementation);
 DEFINE_ALT_VALUE_FN(kind);
 DEFINE_ALT_VALUE_FN(language);
 DEFINE_ALT_VALUE_FN(nth);
+DEFINE_ALT_VALUE_FN(offset);
 DEFINE_ALT_VALUE_FN(scope);
 DEFINE_ALT_VALUE_FN(scope_kind);
 DEFINE_ALT_VALUE_FN(scope_name);
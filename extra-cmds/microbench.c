@@ -0,0 +1,407 @@
+/*
+*   Copyright (c) 2026, Universal Ctags Team
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License version 2 or (at your option) any later version.
+*
+*   Measures the time of the primitives used in the hot paths of parsers,
+*   one at a time, for comparing the implementations of them.
+*
+*   Usage: microbench [-n <scale>] [<benchmark>...]
+*/
+
+#include "general.h"  /* must always come first */
+
+#include "entry_p.h"
+#include "error_p.h"
+#include "field_p.h"
+#include "htable.h"
+#include "keyword.h"
+#include "lregex_p.h"
+#include "mio.h"
+#include "options_p.h"
+#include "parse_p.h"
+#include "read.h"
+#include "read_p.h"
+#include "routines.h"
+#include "stats_p.h"
+#include "trashbox_p.h"
+#include "vstring.h"
+#include "writer_p.h"
+#include "xtag_p.h"
+
+#include <regex.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+*   DATA DECLARATIONS
+*/
+typedef struct sBenchmark {
+	const char *name;
+	const char *description;
+	/* Returns the number of operations done. */
+	unsigned long (* run) (unsigned long scale);
+} benchmark;
+
+/* The input for the benchmarks reading lines */
+#define INPUT_LINES 10000
+
+static char *Input;
+static size_t InputSize;
+static langType LangC;
+static unsigned long Written;
+
+/* The result of a benchmark is stored here not to be optimized away. */
+static volatile unsigned long Sink;
+
+/*
+*   FUNCTION DEFINITIONS
+*/
+
+static int writeEntry (tagWriter *writer CTAGS_ATTR_UNUSED, MIO *mio CTAGS_ATTR_UNUSED,
+					   const tagEntryInfo *const tag CTAGS_ATTR_UNUSED,
+					   void *clientData CTAGS_ATTR_UNUSED)
+{
+	Written++;
+	return 1;
+}
+
+static tagWriter benchWriter = {
+	.writeEntry = writeEntry,
+	.defaultFileName = "tags_file_which_should_never_appear_anywhere",
+};
+
+static void makeInput (void)
+{
+	vString *v = vStringNew ();
+
+	for (unsigned int i = 0; i < INPUT_LINES; i++)
+	{
+		char line [96];
+
+		switch (i % 4)
+		{
+		case 0:
+			snprintf (line, sizeof (line), "static int function%u (int a, char *b)\n", i);
+			break;
+		case 1:
+			snprintf (line, sizeof (line), "{\n");
+			break;
+		case 2:
+			snprintf (line, sizeof (line), "\treturn a + strlen (b) * %u;\n", i);
+			break;
+		default:
+			snprintf (line, sizeof (line), "}\n");
+			break;
+		}
+		vStringCatS (v, line);
+	}
+	InputSize = vStringLength (v);
+	Input = vStringDeleteUnwrap (v);
+}
+
+static unsigned long benchVStringPut (unsigned long scale)
+{
+	vString *v = vStringNew ();
+	const unsigned long n = scale * 10000000;
+
+	for (unsigned long i = 0; i < n; i++)
+	{
+		if (vStringLength (v) >= 4096)
+			vStringClear (v);
+		vStringPut (v, 'a' + (int) (i % 26));
+	}
+	Sink = vStringLength (v);
+	vStringDelete (v);
+	return n;
+}
+
+static unsigned long benchVStringCatS (unsigned long scale)
+{
+	vString *v = vStringNew ();
+	const unsigned long n = scale * 2000000;
+
+	for (unsigned long i = 0; i < n; i++)
+	{
+		if (vStringLength (v) >= 4096)
+			vStringClear (v);
+		vStringCatS (v, "identifier");
+	}
+	Sink = vStringLength (v);
+	vStringDelete (v);
+	return n;
+}
+
+static unsigned long benchHashTableGetItem (unsigned long scale)
+{
+	const unsigned int count = 4096;
+	hashTable *table = hashTableNew (count, hashCstrhash, hashCstreq, eFree, NULL);
+	char **keys = xMalloc (count * 2, char *);
+	const unsigned long n = scale * 5000000;
+	unsigned long found = 0;
+
+	/* The half of the keys looked up are not in the table. */
+	for (unsigned int i = 0; i < count * 2; i++)
+	{
+		char key [32];
+
+		snprintf (key, sizeof (key), "%s%u", (i % 2)? "missing": "key", i);
+		keys [i] = eStrdup (key);
+		if (i % 2 == 0)
+			hashTablePutItem (table, eStrdup (key), keys [i]);
+	}
+
+	for (unsigned long i = 0; i < n; i++)
+		if (hashTableGetItem (table, keys [i % (count * 2)]))
+			found++;
+	Sink = found;
+
+	for (unsigned int i = 0; i < count * 2; i++)
+		eFree (keys [i]);
+	eFree (keys);
+	hashTableDelete (table);
+	return n;
+}
+
+static unsigned long benchLookupKeyword (unsigned long scale)
+{
+	static const char *const words [] = {
+		"int", "while", "function", "static", "return", "value",
+		"struct", "typedef", "buffer", "unsigned", "length", "for",
+	};
+	const unsigned long n = scale * 5000000;
+	unsigned long found = 0;
+
+	for (unsigned long i = 0; i < n; i++)
+		if (lookupKeyword (words [i % ARRAY_SIZE (words)], LangC) != KEYWORD_NONE)
+			found++;
+	Sink = found;
+	return n;
+}
+
+static unsigned long benchMioGetc (unsigned long scale)
+{
+	MIO *mio = mio_new_memory ((unsigned char *) Input, InputSize, NULL, NULL);
+	unsigned long n = 0;
+	unsigned long sum = 0;
+
+	for (unsigned long r = 0; r < scale * 20; r++)
+	{
+		int c;
+
+		mio_rewind (mio);
+		while ((c = mio_getc (mio)) != EOF)
+		{
+			sum += c;
+			n++;
+		}
+	}
+	Sink = sum;
+	mio_unref (mio);
+	return n;
+}
+
+static MIO *openBenchInput (void)
+{
+	MIO *mio = mio_new_memory ((unsigned char *) Input, InputSize, NULL, NULL);
+
+	if (! openInputFile ("microbench.c", LangC, mio, 0))
+		error (FATAL, "cannot open the input");
+	return mio;
+}
+
+static unsigned long benchReadLineFromInputFile (unsigned long scale)
+{
+	unsigned long n = 0;
+	unsigned long sum = 0;
+
+	for (unsigned long r = 0; r < scale * 20; r++)
+	{
+		MIO *mio = openBenchInput ();
+		const unsigned char *line;
+
+		while ((line = readLineFromInputFile ()) != NULL)
+		{
+			sum += line [0];
+			n++;
+		}
+		closeInputFile ();
+		mio_unref (mio);
+	}
+	Sink = sum;
+	return n;
+}
+
+static unsigned long benchMakeTagEntry (unsigned long scale)
+{
+	const unsigned long n = scale * 500000;
+	MIO *mio = openBenchInput ();
+
+	Written = 0;
+	setupWriter (NULL);
+	corkTagFile (CORK_QUEUE);
+	for (unsigned long i = 0; i < n; i++)
+	{
+		tagEntryInfo e;
+
+		/* The kind of the function in the C parser */
+		initTagEntry (&e, "function", 0);
+		e.lineNumber = 1 + i % INPUT_LINES;
+		makeTagEntry (&e);
+	}
+	uncorkTagFile ();
+	teardownWriter ("microbench.c");
+	closeInputFile ();
+	mio_unref (mio);
+
+	Sink = Written;
+	return n;
+}
+
+static unsigned long runRegexBackend (void (* flag) (char, void *), char c,
+									  unsigned long scale)
+{
+	struct flagDefsDescriptor desc = {
+		.backend = NULL,
+		.flags = 0,
+		.regptype = REG_PARSER_SINGLE_LINE,
+	};
+	const char *pattern = (c == 'b')
+		? "^static[ \t]*int[ \t]*\\([a-zA-Z_][a-zA-Z0-9_]*\\)"
+		: "^static[ \t]+int[ \t]+([a-zA-Z_][a-zA-Z0-9_]*)";
+	regexCompiledCode code;
+	regmatch_t pmatch [BACK_REFERENCE_COUNT];
+	unsigned long n = 0;
+	unsigned long found = 0;
+
+	flag (c, &desc);
+	code = desc.backend->compile (desc.backend, pattern, desc.flags);
+	if (code.code == NULL)
+		error (FATAL, "cannot compile \"%s\"", pattern);
+
+	for (unsigned long r = 0; r < scale * 20; r++)
+	{
+		const char *line = Input;
+
+		while (line < Input + InputSize)
+		{
+			const char *end = strchr (line, '\n');
+			if (code.backend->match (code.backend, code.code, line,
+									 end - line, pmatch) == 0)
+				found++;
+			line = end + 1;
+			n++;
+		}
+	}
+	Sink = found;
+	code.backend->delete_code (code.code);
+	return n;
+}
+
+static unsigned long benchRegexBasic (unsigned long scale)
+{
+	return runRegexBackend (basic_regex_flag_short, 'b', scale);
+}
+
+static unsigned long benchRegexExtended (unsigned long scale)
+{
+	return runRegexBackend (extend_regex_flag_short, 'e', scale);
+}
+
+#ifdef HAVE_PCRE2
+static unsigned long benchRegexPcre2 (unsigned long scale)
+{
+	return runRegexBackend (pcre2_regex_flag_short, 'p', scale);
+}
+#endif
+
+static benchmark Benchmarks [] = {
+	{ "vstring-put",    "vStringPut a character",           benchVStringPut },
+	{ "vstring-cats",   "vStringCatS a 10 byte string",     benchVStringCatS },
+	{ "htable-get",     "hashTableGetItem in 4096 strings", benchHashTableGetItem },
+	{ "keyword-lookup", "lookupKeyword for C",              benchLookupKeyword },
+	{ "mio-getc",       "mio_getc a byte from memory",      benchMioGetc },
+	{ "read-line",      "readLineFromInputFile a line",     benchReadLineFromInputFile },
+	{ "make-tag-entry", "makeTagEntry into the cork queue", benchMakeTagEntry },
+	{ "regex-basic",    "match a line with {basic}",        benchRegexBasic },
+	{ "regex-extended", "match a line with {extend}",       benchRegexExtended },
+#ifdef HAVE_PCRE2
+	{ "regex-pcre2",    "match a line with {pcre2}",        benchRegexPcre2 },
+#endif
+};
+
+static void runBenchmark (benchmark *b, unsigned long scale)
+{
+	const double start = getWallClock ();
+	const unsigned long n = b->run (scale);
+	const double elapsed = getWallClock () - start;
+
+	printf ("%-16s %12lu %10.3f %10.2f  %s\n", b->name, n, elapsed,
+			(n > 0)? elapsed * 1e9 / n: 0.0, b->description);
+}
+
+static void initCtags (void)
+{
+	initDefaultTrashBox ();
+	setTagWriter (WRITER_CUSTOM, &benchWriter);
+
+	checkRegex ();
+	initFieldObjects ();
+	initXtagObjects ();
+
+	initializeParsing ();
+	initOptions ();
+	initRegexOptscript ();
+
+	LangC = getNamedLanguage ("C", 0);
+	initializeParser (LangC);
+}
+
+extern int main (int argc, char **argv)
+{
+	unsigned long scale = 1;
+	int i = 1;
+	int r = 0;
+
+	if (argc > 2 && strcmp (argv [1], "-n") == 0)
+	{
+		scale = strtoul (argv [2], NULL, 10);
+		if (scale == 0)
+		{
+			fprintf (stderr, "invalid scale: %s\n", argv [2]);
+			return 1;
+		}
+		i = 3;
+	}
+
+	initCtags ();
+	makeInput ();
+
+	printf ("%-16s %12s %10s %10s  %s\n", "benchmark", "operations", "seconds",
+			"ns/op", "description");
+	if (i == argc)
+	{
+		for (unsigned int j = 0; j < ARRAY_SIZE (Benchmarks); j++)
+			runBenchmark (Benchmarks + j, scale);
+	}
+	for (; i < argc; i++)
+	{
+		unsigned int j;
+
+		for (j = 0; j < ARRAY_SIZE (Benchmarks); j++)
+			if (strcmp (argv [i], Benchmarks [j].name) == 0)
+				break;
+		if (j == ARRAY_SIZE (Benchmarks))
+		{
+			fprintf (stderr, "unknown benchmark: %s\n", argv [i]);
+			r = 1;
+			continue;
+		}
+		runBenchmark (Benchmarks + j, scale);
+	}
+
+	eFree (Input);
+	return r;
+}
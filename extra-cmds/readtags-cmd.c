@@ -13,9 +13,19 @@
 #include "printtags.h"
 #include "routines.h"
 #include "routines_p.h"
+#include <errno.h>
 #include <string.h>		/* strerror */
 #include <stdlib.h>		/* exit */
 #include <stdio.h>		/* stderr */
+#ifdef HAVE_UNISTD_H
+# include <unistd.h>
+#endif
+#ifdef HAVE_SYS_TYPES_H
+# include <sys/types.h>
+#endif
+#ifdef HAVE_SYS_WAIT_H
+# include <sys/wait.h>
+#endif
 
 typedef struct sReadOption {
 	int sortOverride;
@@ -27,6 +37,8 @@ typedef struct sReadOption {
 static const char *TagFileName = "tags";
 static const char *ProgramName;
 static int debugMode;
+/* The number of tags to print at most; 0 for no limit */
+static unsigned long TagLimit;
 #ifdef READTAGS_DSL
 #include "dsl/qualifier.h"
 static QCode *Qualifier;
@@ -34,6 +46,12 @@ static QCode *Qualifier;
 static SCode *Sorter;
 #include "dsl/formatter.h"
 static FCode *Formatter;
+/* The memory for the tags to sort before writing them to temporary files */
+static size_t SortBufferSize = 64 * 1024 * 1024;
+/* The number of worker processes filtering the tags listed with -l */
+static unsigned int Jobs = 1;
+/* Set in a worker process */
+static int InWorker;
 #endif
 
 static const char* tagsStrerror (int err)
@@ -78,55 +96,71 @@ static void printPseudoTag (const tagEntry *entry, void *data)
 }
 
 #ifdef READTAGS_DSL
-static void freeCopiedTag (tagEntry *e)
+/* A copied tag is a block of memory holding the tagEntry, the list of
+ * fields, and the strings, in this order. */
+static size_t copiedStringSize (const char *s)
 {
-	free ((void *)e->name);
-	free ((void *)e->file);
-	if (e->address.pattern)
-		free ((void *)e->address.pattern);
-	if (e->kind)
-		free ((void *)e->kind);
-	for (unsigned short c = 0; c < e->fields.count; c++)
+	return s? strlen (s) + 1: 0;
+}
+
+static char *copyString (const char **dest, const char *s, char *p)
+{
+	size_t len;
+
+	if (s == NULL)
 	{
-		free ((void *)e->fields.list[c].key);
-		free ((void *)e->fields.list[c].value);
+		*dest = NULL;
+		return p;
 	}
-	if (e->fields.count)
-		free ((void *)e->fields.list);
-	free ((void *)e);
+	len = strlen (s) + 1;
+	memcpy (p, s, len);
+	*dest = p;
+	return p + len;
 }
 
-static tagEntry *copyTag (tagEntry *o)
+static size_t copiedTagSize (const tagEntry *o)
 {
-	tagEntry *n;
+	size_t size = sizeof (*o) + o->fields.count * sizeof (*o->fields.list);
 
-	n = eCalloc (1, sizeof  (*o));
+	size += copiedStringSize (o->name);
+	size += copiedStringSize (o->file);
+	size += copiedStringSize (o->address.pattern);
+	size += copiedStringSize (o->kind);
+	for (unsigned short c = 0; c < o->fields.count; c++)
+	{
+		size += copiedStringSize (o->fields.list[c].key);
+		size += copiedStringSize (o->fields.list[c].value);
+	}
+	return size;
+}
 
-	n->name = eStrdup (o->name);
+static void freeCopiedTag (tagEntry *e)
+{
+	free ((void *)e);
+}
 
-	if (o->file)
-		n->file = eStrdup (o->file);
+static tagEntry *copyTag (const tagEntry *o, size_t *size)
+{
+	tagEntry *n;
+	char *p;
 
-	if (o->address.pattern)
-		n->address.pattern = eStrdup (o->address.pattern);
+	*size = copiedTagSize (o);
+	n = eMalloc (*size);
 
 	n->address.lineNumber = o->address.lineNumber;
-
-	if (o->kind)
-		n->kind = eStrdup (o->kind);
-
 	n->fileScope = o->fileScope;
 	n->fields.count = o->fields.count;
+	n->fields.list = o->fields.count? (tagExtensionField *)(n + 1): NULL;
 
-	if (o->fields.count == 0)
-		return n;
-
-	n->fields.list = eMalloc (o->fields.count * sizeof (*o->fields.list));
-
+	p = (char *)((tagExtensionField *)(n + 1) + o->fields.count);
+	p = copyString (&n->name, o->name, p);
+	p = copyString (&n->file, o->file, p);
+	p = copyString (&n->address.pattern, o->address.pattern, p);
+	p = copyString (&n->kind, o->kind, p);
 	for (unsigned short c = 0; c < o->fields.count; c++)
 	{
-		n->fields.list[c].key = eStrdup (o->fields.list[c].key);
-		n->fields.list[c].value = eStrdup (o->fields.list[c].value);
+		p = copyString (&n->fields.list[c].key, o->fields.list[c].key, p);
+		p = copyString (&n->fields.list[c].value, o->fields.list[c].value, p);
 	}
 
 	return n;
@@ -134,10 +168,12 @@ static tagEntry *copyTag (tagEntry *o)
 
 struct tagEntryHolder {
 	tagEntry *e;
+	size_t size;
 };
 struct tagEntryArray {
 	int count;
 	int length;
+	size_t size;				/* the memory used by the tags */
 	struct tagEntryHolder *a;
 };
 
@@ -147,12 +183,13 @@ struct tagEntryArray *tagEntryArrayNew (void)
 
 	a->count = 0;
 	a->length = 1024;
+	a->size = 0;
 	a->a = eMalloc(a->length * sizeof (a->a[0]));
 
 	return a;
 }
 
-void tagEntryArrayPush (struct tagEntryArray *a, tagEntry *e)
+void tagEntryArrayPush (struct tagEntryArray *a, tagEntry *e, size_t size)
 {
 	if (a->count + 1 == a->length)
 	{
@@ -166,16 +203,24 @@ void tagEntryArrayPush (struct tagEntryArray *a, tagEntry *e)
 		a->length *= 2;
 	}
 
-	a->a[a->count++].e = e;
+	a->a[a->count].e = e;
+	a->a[a->count].size = size;
+	a->count++;
+	a->size += size + sizeof (a->a[0]);
+}
+
+void tagEntryArrayClear (struct tagEntryArray *a)
+{
+	for (int i = 0; i < a->count; i++)
+		freeCopiedTag (a->a[i].e);
+	a->count = 0;
+	a->size = 0;
 }
 
 void tagEntryArrayFree (struct tagEntryArray *a, int freeTags)
 {
 	if (freeTags)
-	{
-		for (int i = 0; i < a->count; i++)
-			freeCopiedTag (a->a[i].e);
-	}
+		tagEntryArrayClear (a);
 	free (a->a);
 	free (a);
 }
@@ -185,11 +230,220 @@ static int compareTagEntry (const void *a, const void *b)
 	return s_compare (((struct tagEntryHolder *)a)->e, ((struct tagEntryHolder *)b)->e, Sorter);
 }
 
+/* The entries kept with --limit: the last one in the order of the sorter
+ * is at the top of the heap. */
+static void tagEntryHeapUp (struct tagEntryArray *a, int i)
+{
+	while (i > 0)
+	{
+		int parent = (i - 1) / 2;
+		if (compareTagEntry (a->a + parent, a->a + i) >= 0)
+			break;
+		struct tagEntryHolder tmp = a->a[parent];
+		a->a[parent] = a->a[i];
+		a->a[i] = tmp;
+		i = parent;
+	}
+}
+
+static void tagEntryHeapDown (struct tagEntryArray *a, int i)
+{
+	while (1)
+	{
+		int largest = i;
+		int l = 2 * i + 1;
+		int r = l + 1;
+
+		if (l < a->count && compareTagEntry (a->a + l, a->a + largest) > 0)
+			largest = l;
+		if (r < a->count && compareTagEntry (a->a + r, a->a + largest) > 0)
+			largest = r;
+		if (largest == i)
+			break;
+		struct tagEntryHolder tmp = a->a[largest];
+		a->a[largest] = a->a[i];
+		a->a[i] = tmp;
+		i = largest;
+	}
+}
+
+static void keepBestTag (struct tagEntryArray *a, const tagEntry *entry)
+{
+	tagEntry *e;
+	size_t size;
+
+	if ((unsigned long) a->count < TagLimit)
+	{
+		e = copyTag (entry, &size);
+		tagEntryArrayPush (a, e, size);
+		tagEntryHeapUp (a, a->count - 1);
+	}
+	else if (s_compare (entry, a->a[0].e, Sorter) < 0)
+	{
+		a->size -= a->a[0].size;
+		freeCopiedTag (a->a[0].e);
+		a->a[0].e = copyTag (entry, &size);
+		a->a[0].size = size;
+		a->size += size;
+		tagEntryHeapDown (a, 0);
+	}
+}
+
+/* When the tags to sort don't fit in SortBufferSize, they are sorted in
+ * runs written to temporary files, then merged. In a file, a tag is
+ * saved as its size and its block of memory, with the pointers turned
+ * into offsets from the start of the block. The offset 0 stands for NULL:
+ * no string is there. */
+struct tagRun {
+	FILE *fp;
+	char *name;
+	int removed;				/* the file is removed while open */
+	tagEntry *e;
+};
+
+struct tagRunArray {
+	int count;
+	int length;
+	struct tagRun *a;
+};
+
+#define TAG_OFFSET(P,BASE) ((const char *)((P)? (const char *)(P) - (const char *)(BASE): 0))
+#define TAG_POINTER(P,BASE) ((const char *)((P)? (const char *)(BASE) + (size_t)(P): NULL))
+
+static void tagRunError (const char *what, const char *name)
+{
+	fprintf (stderr, "%s: error in %s a temporary file for sorting: %s: %s\n",
+			 ProgramName, what, name, strerror (errno));
+	exit (1);
+}
+
+static void writeTagToRun (struct tagRun *run, tagEntry *e, size_t size)
+{
+	tagExtensionField *list = e->fields.list;
+
+	for (unsigned short c = 0; c < e->fields.count; c++)
+	{
+		list[c].key = TAG_OFFSET (list[c].key, e);
+		list[c].value = TAG_OFFSET (list[c].value, e);
+	}
+	e->fields.list = (tagExtensionField *) TAG_OFFSET (list, e);
+	e->name = TAG_OFFSET (e->name, e);
+	e->file = TAG_OFFSET (e->file, e);
+	e->address.pattern = TAG_OFFSET (e->address.pattern, e);
+	e->kind = TAG_OFFSET (e->kind, e);
+
+	if (fwrite (&size, sizeof (size), 1, run->fp) != 1
+		|| fwrite (e, size, 1, run->fp) != 1)
+		tagRunError ("writing", run->name);
+}
+
+static tagEntry *readTagFromRun (struct tagRun *run)
+{
+	size_t size;
+	tagEntry *e;
+
+	if (fread (&size, sizeof (size), 1, run->fp) != 1)
+	{
+		if (ferror (run->fp))
+			tagRunError ("reading", run->name);
+		return NULL;
+	}
+
+	e = eMalloc (size);
+	if (fread (e, size, 1, run->fp) != 1)
+		tagRunError ("reading", run->name);
+
+	e->name = TAG_POINTER (e->name, e);
+	e->file = TAG_POINTER (e->file, e);
+	e->address.pattern = TAG_POINTER (e->address.pattern, e);
+	e->kind = TAG_POINTER (e->kind, e);
+	e->fields.list = (tagExtensionField *) TAG_POINTER (e->fields.list, e);
+	for (unsigned short c = 0; c < e->fields.count; c++)
+	{
+		e->fields.list[c].key = TAG_POINTER (e->fields.list[c].key, e);
+		e->fields.list[c].value = TAG_POINTER (e->fields.list[c].value, e);
+	}
+	return e;
+}
+
+static void spillTags (struct tagRunArray *runs, struct tagEntryArray *a)
+{
+	struct tagRun *run;
+
+	if (runs->count == runs->length)
+	{
+		runs->length = runs->length? runs->length * 2: 8;
+		runs->a = eRealloc (runs->a, sizeof (runs->a[0]) * runs->length);
+	}
+	run = runs->a + runs->count++;
+	run->name = NULL;
+	run->e = NULL;
+	run->fp = tempFileFP ("w+b", &run->name);
+	/* Where an open file can be removed, no file is left behind even
+	 * if readtags is killed. */
+	run->removed = (remove (run->name) == 0);
+
+	if (debugMode)
+		fprintf (stderr, "%s: writing %d tags to \"%s\" for sorting\n",
+				 ProgramName, a->count, run->name);
+
+	qsort (a->a, a->count, sizeof (a->a[0]), compareTagEntry);
+	for (int i = 0; i < a->count; i++)
+		writeTagToRun (run, a->a[i].e, a->a[i].size);
+	tagEntryArrayClear (a);
+
+	if (fflush (run->fp) != 0 || fseek (run->fp, 0, SEEK_SET) != 0)
+		tagRunError ("writing", run->name);
+}
+
+static void mergeTagRuns (struct tagRunArray *runs,
+						  void (* actionfn) (const tagEntry *, void *), void *data)
+{
+	unsigned long printed = 0;
+
+	for (int i = 0; i < runs->count; i++)
+		runs->a[i].e = readTagFromRun (runs->a + i);
+
+	while (TagLimit == 0 || printed < TagLimit)
+	{
+		struct tagRun *best = NULL;
+
+		for (int i = 0; i < runs->count; i++)
+		{
+			struct tagRun *run = runs->a + i;
+			if (run->e
+				&& (best == NULL || s_compare (run->e, best->e, Sorter) < 0))
+				best = run;
+		}
+		if (best == NULL)
+			break;
+
+		(* actionfn) (best->e, data);
+		printed++;
+		freeCopiedTag (best->e);
+		best->e = readTagFromRun (best);
+	}
+
+	for (int i = 0; i < runs->count; i++)
+	{
+		struct tagRun *run = runs->a + i;
+		if (run->e)
+			freeCopiedTag (run->e);
+		fclose (run->fp);
+		if (!run->removed)
+			remove (run->name);
+		eFree (run->name);
+	}
+	eFree (runs->a);
+}
+
 static void walkTags (tagFile *const file, tagEntry *first_entry,
 					  tagResult (* nextfn) (tagFile *const, tagEntry *),
 					  void (* actionfn) (const tagEntry *, void *), void *data)
 {
 	struct tagEntryArray *a = NULL;
+	struct tagRunArray runs = { 0, 0, NULL };
+	unsigned long printed = 0;
 
 	if (Sorter)
 		a = tagEntryArrayNew ();
@@ -208,13 +462,22 @@ static void walkTags (tagFile *const file, tagEntry *first_entry,
 			}
 		}
 
-		if (a)
+		if (a && TagLimit)
+			keepBestTag (a, first_entry);
+		else if (a)
 		{
-			tagEntry *e = copyTag (first_entry);
-			tagEntryArrayPush (a, e);
+			size_t size;
+			tagEntry *e = copyTag (first_entry, &size);
+			tagEntryArrayPush (a, e, size);
+			if (a->size > SortBufferSize)
+				spillTags (&runs, a);
 		}
 		else
+		{
 			(* actionfn) (first_entry, data);
+			if (TagLimit && ++printed == TagLimit)
+				break;
+		}
 	} while ( (*nextfn) (file, first_entry) == TagSuccess);
 
 	int err = tagsGetErrno (file);
@@ -226,7 +489,14 @@ static void walkTags (tagFile *const file, tagEntry *first_entry,
 		exit (1);
 	}
 
-	if (a)
+	if (a && runs.count > 0)
+	{
+		if (a->count > 0)
+			spillTags (&runs, a);
+		mergeTagRuns (&runs, actionfn, data);
+		tagEntryArrayFree (a, 1);
+	}
+	else if (a)
 	{
 		qsort (a->a, a->count, sizeof (a->a[0]), compareTagEntry);
 		for (int i = 0; i < a->count; i++)
@@ -239,8 +509,14 @@ static void walkTags (tagFile *const file, tagEntry *first_entry,
 					  tagResult (* nextfn) (tagFile *const, tagEntry *),
 					  void (* actionfn) (const tagEntry *, void *), void *data)
 {
+	unsigned long printed = 0;
+
 	do
+	{
 		(* actionfn) (first_entry, data);
+		if (TagLimit && ++printed == TagLimit)
+			break;
+	}
 	while ( (*nextfn) (file, first_entry) == TagSuccess);
 
 	int err = tagsGetErrno (file);
@@ -254,7 +530,7 @@ static void walkTags (tagFile *const file, tagEntry *first_entry,
 }
 #endif
 
-static int copyFile (FILE *in, FILE *out)
+static int copyFile (FILE *in, const char *inName, FILE *out, const char *outName)
 {
 #define BUFSIZE (4096 * 10)
 	static unsigned char buffer [BUFSIZE];
@@ -268,7 +544,7 @@ static int copyFile (FILE *in, FILE *out)
 		{
 			if (ferror(in))
 			{
-				fprintf (stderr, "%s: error in reading from stdin\n", ProgramName);
+				fprintf (stderr, "%s: error in reading from %s\n", ProgramName, inName);
 				return -1;
 			}
 			/* EOF */
@@ -277,7 +553,7 @@ static int copyFile (FILE *in, FILE *out)
 		t = fwrite (buffer, 1, r, out);
 		if (r != t)
 		{
-			fprintf (stderr, "%s error in writing to the temporarily file", ProgramName);
+			fprintf (stderr, "%s error in writing to %s", ProgramName, outName);
 			return -1;
 		}
 	}
@@ -286,6 +562,11 @@ static int copyFile (FILE *in, FILE *out)
 
 static void removeTagFile (void)
 {
+#ifdef READTAGS_DSL
+	/* The parent process and the other workers still read it. */
+	if (InWorker)
+		return;
+#endif
 	remove (TagFileName);
 	eFree ((char *)TagFileName);
 }
@@ -306,7 +587,7 @@ static tagFile *openTags (const char *const filePath, tagFileInfo *const info)
 		TagFileName = tempName;
 		atexit (removeTagFile);
 
-		if (copyFile (stdin, tempFP) < 0)
+		if (copyFile (stdin, "stdin", tempFP, "the temporarily file") < 0)
 		{
 			fclose (tempFP);
 			exit (1);
@@ -390,7 +671,195 @@ static void findTag (const char *const name, readOptions *readOpts,
 	tagsClose (file);
 }
 
-static void listTags (int pseudoTags, tagPrintOptions *printOpts)
+#ifdef READTAGS_DSL
+/* In a sorted tag file, the tags the qualifier can accept are the ones
+ * found with the name the qualifier tests first. Return 0 if the tags
+ * must be read from the start to the end. */
+static int findQualifiedTags (tagFile *const file, tagFileInfo *const info,
+							  readOptions *readOpts, tagPrintOptions *printOpts,
+							  tagEntry *entry)
+{
+	int err;
+	int partial;
+	const char *name;
+	sortType sortMethod = readOpts->sortOverride? readOpts->sortMethod: info->file.sort;
+
+	if (Qualifier == NULL
+		|| (sortMethod != TAG_SORTED && sortMethod != TAG_FOLDSORTED)
+		|| (name = q_name_constraint (Qualifier, &partial)) == NULL)
+		return 0;
+
+	/* tagsFind () compares the names as written in the tag file: a
+	 * character escaped there, or a pseudo tag, is not found as the
+	 * qualifier sees it. An empty name is found in every line. */
+	if (name [0] == '!' || name [0] == '\0')
+		return 0;
+	for (const char *p = name; *p; p++)
+	{
+		if (*p == '\\' || (unsigned char) *p < 0x20 || *p == 0x7f)
+			return 0;
+	}
+
+	if (readOpts->sortOverride
+		&& tagsSetSortType (file, readOpts->sortMethod) != TagSuccess)
+		return 0;
+
+	if (debugMode)
+		fprintf (stderr, "%s: searching for \"%s\" in \"%s\" for the filter\n",
+				 ProgramName, name, TagFileName);
+
+	/* The case of names is tested by the qualifier. */
+	if (tagsFind (file, entry, name,
+				  (partial? TAG_PARTIALMATCH: TAG_FULLMATCH)
+				  | (sortMethod == TAG_FOLDSORTED? TAG_IGNORECASE: TAG_OBSERVECASE))
+		== TagSuccess)
+		walkTags (file, entry, tagsFindNext,
+				  Formatter? printTagWithFormatter: printTag, printOpts);
+	else if ((err = tagsGetErrno (file)) != 0)
+	{
+		fprintf (stderr, "%s: error in tagsFind(): %s\n",
+				 ProgramName,
+				 tagsStrerror (err));
+		exit (1);
+	}
+	return 1;
+}
+#endif
+
+#ifdef READTAGS_DSL
+#ifdef HAVE_FORK
+struct tagWorker {
+	pid_t pid;
+	FILE *fp;
+	char *name;
+	int status;
+};
+
+/* Print the tags of the part PART of FILE to FP in a worker process. */
+static int listTagsOfPart (tagFile *const file, unsigned int part, FILE *fp,
+						   tagPrintOptions *printOpts)
+{
+	tagFile *cursor;
+	tagEntry entry;
+	int err;
+
+	InWorker = 1;
+	if (dup2 (fileno (fp), STDOUT_FILENO) < 0)
+	{
+		fprintf (stderr, "%s: cannot redirect the output of a worker process: %s\n",
+				 ProgramName, strerror (errno));
+		return 1;
+	}
+
+	cursor = tagsOpenCursor (file, NULL);
+	if (cursor == NULL || tagsSetPart (cursor, part, Jobs) != TagSuccess)
+	{
+		fprintf (stderr, "%s: cannot read a part of tag file: %s\n",
+				 ProgramName, TagFileName);
+		return 1;
+	}
+
+	if (tagsFirst (cursor, &entry) == TagSuccess)
+		walkTags (cursor, &entry, tagsNext,
+				  Formatter? printTagWithFormatter: printTag, printOpts);
+	else if ((err = tagsGetErrno (cursor)) != 0)
+	{
+		fprintf (stderr, "%s: error in tagsFirst(): %s\n",
+				 ProgramName,
+				 tagsStrerror (err));
+		return 1;
+	}
+
+	if (fflush (stdout) != 0)
+		return 1;
+	tagsClose (cursor);
+	return 0;
+}
+#endif
+
+/* With --jobs, the tags listed with a filter are filtered in worker
+ * processes, each reading a part of the tag file made by tagsSetPart ().
+ * A worker prints the tags of its part to a temporary file; the files are
+ * copied to stdout in the order of the parts. So the output is the same
+ * as the one made in a process. Return 0 if the tags must be read in this
+ * process. */
+static int listTagsInWorkers (tagFile *const file, tagPrintOptions *printOpts)
+{
+#ifdef HAVE_FORK
+	struct tagWorker *workers;
+	int failed = 0;
+
+	/* The sorter and --limit need all the tags in a process. */
+	if (Jobs <= 1 || Qualifier == NULL || Sorter || TagLimit)
+		return 0;
+
+	if (debugMode)
+		fprintf (stderr, "%s: filtering the tags of \"%s\" in %u processes\n",
+				 ProgramName, TagFileName, Jobs);
+
+	fflush (stdout);
+	workers = eCalloc (Jobs, sizeof (workers[0]));
+	for (unsigned int i = 0; i < Jobs; i++)
+	{
+		struct tagWorker *w = workers + i;
+
+		w->fp = tempFileFP ("w+b", &w->name);
+		w->pid = fork ();
+		if (w->pid == -1)
+		{
+			fprintf (stderr, "%s: cannot fork a worker process: %s\n",
+					 ProgramName, strerror (errno));
+			exit (1);
+		}
+		if (w->pid == 0)
+			_exit (listTagsOfPart (file, i, w->fp, printOpts));
+	}
+
+	for (unsigned int i = 0; i < Jobs; i++)
+	{
+		struct tagWorker *w = workers + i;
+
+		while (waitpid (w->pid, &w->status, 0) == -1)
+		{
+			if (errno != EINTR)
+			{
+				fprintf (stderr, "%s: cannot wait for a worker process: %s\n",
+						 ProgramName, strerror (errno));
+				exit (1);
+			}
+		}
+	}
+
+	/* Print the tags a process would print before an error. */
+	for (unsigned int i = 0; i < Jobs; i++)
+	{
+		struct tagWorker *w = workers + i;
+
+		if (!failed)
+		{
+			if (fseek (w->fp, 0, SEEK_SET) != 0
+				|| copyFile (w->fp, w->name, stdout, "stdout") < 0)
+				failed = 1;
+			if (!WIFEXITED (w->status) || WEXITSTATUS (w->status) != 0)
+				failed = 1;
+		}
+		fclose (w->fp);
+		remove (w->name);
+		eFree (w->name);
+	}
+	eFree (workers);
+
+	if (failed)
+		exit (1);
+	return 1;
+#else
+	return 0;
+#endif
+}
+#endif
+
+static void listTags (int pseudoTags, readOptions *readOpts,
+					  tagPrintOptions *printOpts)
 {
 	tagFileInfo info;
 	tagEntry entry;
@@ -428,6 +897,12 @@ static void listTags (int pseudoTags, tagPrintOptions *printOpts)
 			exit (1);
 		}
 	}
+#ifdef READTAGS_DSL
+	else if (findQualifiedTags (file, &info, readOpts, printOpts, &entry))
+		;
+	else if (listTagsInWorkers (file, printOpts))
+		;
+#endif
 	else
 	{
 		if (tagsFirst (file, &entry) == TagSuccess)
@@ -480,8 +955,14 @@ static const char *const Usage =
 	"        Perform case-insensitive matching in the NAME action.\n"
 	"    -n | --line-number\n"
 	"        Also include the line number field when -e option is given.\n"
+	"    -L NUM | --limit NUM\n"
+	"        Print NUM tags at most for each ACTION.\n"
 	"    -p | --prefix-match\n"
 	"        Perform prefix matching in the NAME action.\n"
+	"    -c | --substring-match\n"
+	"        Perform substring matching in the NAME action.\n"
+	"    -f | --file-match\n"
+	"        Match the input files of the tags instead of the names in the NAME action.\n"
 	"    -t TAGFILE | --tag-file TAGFILE\n"
 	"        Use specified tag file (default: \"tags\").\n"
 	"        \"-\" indicates taking tag file data from standard input.\n"
@@ -493,8 +974,14 @@ static const char *const Usage =
 	"        Format the tags listed by ACTION with EXP when printing.\n"
 	"    -Q EXP | --filter EXP\n"
 	"        Filter the tags listed by ACTION with EXP before printing.\n"
+	"    -j NUM | --jobs NUM\n"
+	"        Filter the tags listed by -l in NUM worker processes.\n"
 	"    -S EXP | --sorter EXP\n"
 	"        Sort the tags listed by ACTION with EXP before printing.\n"
+	"        With -L, print the first NUM tags in the order of EXP.\n"
+	"    --sort-buffer-size SIZE\n"
+	"        Write the tags to sort to temporary files if they take more memory\n"
+	"        than SIZE (default: 64m). SIZE may end with k, m, or g.\n"
 #endif
 	;
 
@@ -558,6 +1045,73 @@ static void *compileExpression(const char* exp, void * (*compiler) (EsObject *),
 }
 #endif
 
+/* Parse ARG as a positive number for OPTNAME option. With SUFFIX, the
+ * number may end with k, m, or g for kibibytes, mebibytes or gibibytes. */
+static unsigned long long parseNumber (const char *arg, const char *optname,
+									   int suffix)
+{
+	unsigned long long n;
+	unsigned int shift = 0;
+	char *end;
+
+	errno = 0;
+	n = strtoull (arg, &end, 10);
+	if (suffix && end != arg)
+	{
+		switch (*end)
+		{
+		case 'k': case 'K': shift = 10; end++; break;
+		case 'm': case 'M': shift = 20; end++; break;
+		case 'g': case 'G': shift = 30; end++; break;
+		}
+	}
+	if (end == arg || *end != '\0' || arg [0] == '-' || errno != 0
+		|| n == 0 || (n << shift) >> shift != n)
+	{
+		fprintf (stderr, "%s: invalid number for --%s option: %s\n",
+				 ProgramName, optname, arg);
+		exit (1);
+	}
+	return n << shift;
+}
+
+static void setTagLimit (const char *arg, const char *optname)
+{
+	unsigned long long n = parseNumber (arg, optname, 0);
+
+	TagLimit = (n > (unsigned long) -1)? (unsigned long) -1: (unsigned long) n;
+}
+
+#ifdef READTAGS_DSL
+static void setSortBufferSize (const char *arg, const char *optname)
+{
+	unsigned long long n = parseNumber (arg, optname, 1);
+
+	SortBufferSize = (n > (size_t) -1)? (size_t) -1: (size_t) n;
+}
+
+static void setJobs (const char *arg, const char *optname)
+{
+	unsigned long long n = parseNumber (arg, optname, 0);
+
+	if (n > 1024)
+	{
+		fprintf (stderr, "%s: too many jobs for --%s option: %s\n",
+				 ProgramName, optname, arg);
+		exit (1);
+	}
+	Jobs = (unsigned int) n;
+#ifndef HAVE_FORK
+	if (Jobs > 1)
+	{
+		fprintf (stderr, "%s: --%s option is not supported on this platform; ignored\n",
+				 ProgramName, optname);
+		Jobs = 1;
+	}
+#endif
+}
+#endif
+
 static void printVersion(void)
 {
 	/* readtags uses code of ctags via libutil.
@@ -598,7 +1152,7 @@ extern int main (int argc, char **argv)
 				debugMode++;
 			else if (strcmp (optname, "list-pseudo-tags") == 0)
 			{
-				listTags (1, &printOpts);
+				listTags (1, &readOpts, &printOpts);
 				actionSupplied = 1;
 			}
 			else if (strcmp (optname, "help") == 0)
@@ -641,13 +1195,28 @@ extern int main (int argc, char **argv)
 				readOpts.matchOpts |= TAG_IGNORECASE;
 			else if (strcmp (optname, "prefix-match") == 0)
 				readOpts.matchOpts |= TAG_PARTIALMATCH;
+			else if (strcmp (optname, "substring-match") == 0)
+				readOpts.matchOpts |= TAG_SUBSTRINGMATCH;
+			else if (strcmp (optname, "file-match") == 0)
+				readOpts.matchOpts |= TAG_FILEMATCH;
 			else if (strcmp (optname, "list") == 0)
 			{
-				listTags (0, &printOpts);
+				listTags (0, &readOpts, &printOpts);
 				actionSupplied = 1;
 			}
 			else if (strcmp (optname, "line-number") == 0)
 				printOpts.lineNumber = 1;
+			else if (strcmp (optname, "limit") == 0)
+			{
+				if (i + 1 < argc)
+					setTagLimit (argv [++i], optname);
+				else
+				{
+					fprintf (stderr, "%s: missing number for --%s option\n",
+							 ProgramName, optname);
+					exit (1);
+				}
+			}
 			else if (strcmp (optname, "tag-file") == 0)
 			{
 				if (i + 1 < argc)
@@ -710,6 +1279,28 @@ extern int main (int argc, char **argv)
 					exit (1);
 				}
 			}
+			else if (strcmp (optname, "jobs") == 0)
+			{
+				if (i + 1 < argc)
+					setJobs (argv [++i], optname);
+				else
+				{
+					fprintf (stderr, "%s: missing number for --%s option\n",
+							 ProgramName, optname);
+					exit (1);
+				}
+			}
+			else if (strcmp (optname, "sort-buffer-size") == 0)
+			{
+				if (i + 1 < argc)
+					setSortBufferSize (argv [++i], optname);
+				else
+				{
+					fprintf (stderr, "%s: missing size for --%s option\n",
+							 ProgramName, optname);
+					exit (1);
+				}
+			}
 			else if (strcmp (optname, "formatter") == 0)
 			{
 				if (i + 1 < argc)
@@ -740,7 +1331,7 @@ extern int main (int argc, char **argv)
 				switch (arg [j])
 				{
 					case 'd': debugMode++; break;
-					case 'D': listTags (1, &printOpts); actionSupplied = 1; break;
+					case 'D': listTags (1, &readOpts, &printOpts); actionSupplied = 1; break;
 					case 'h': printUsage (stdout, 0); break;
 #ifdef READTAGS_DSL
 					case 'H':
@@ -764,8 +1355,15 @@ extern int main (int argc, char **argv)
 					case 'e': printOpts.extensionFields = 1; break;
 					case 'i': readOpts.matchOpts |= TAG_IGNORECASE;   break;
 					case 'p': readOpts.matchOpts |= TAG_PARTIALMATCH; break;
-					case 'l': listTags (0, &printOpts); actionSupplied = 1; break;
+					case 'c': readOpts.matchOpts |= TAG_SUBSTRINGMATCH; break;
+					case 'f': readOpts.matchOpts |= TAG_FILEMATCH; break;
+					case 'l': listTags (0, &readOpts, &printOpts); actionSupplied = 1; break;
 					case 'n': printOpts.lineNumber = 1; break;
+					case 'L':
+						if (i + 1 == argc)
+							printUsage(stderr, 1);
+						setTagLimit (argv[++i], "limit");
+						break;
 					case 't':
 						if (arg [j+1] != '\0')
 						{
@@ -802,6 +1400,11 @@ extern int main (int argc, char **argv)
 													   (void * (*)(EsObject *))s_compile,
 													   "sorter");
 						break;
+					case 'j':
+						if (i + 1 == argc)
+							printUsage(stderr, 1);
+						setJobs (argv[++i], "jobs");
+						break;
 					case 'F':
 						if (i + 1 == argc)
 							printUsage(stderr, 1);
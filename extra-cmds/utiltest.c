@@ -8,9 +8,16 @@
 #include "general.h"
 
 #include "acutest.h"
+#include "arena_p.h"
 #include "fname.h"
 #include "htable.h"
+#include "mio.h"
+#include "ptrarray.h"
 #include "routines.h"
+#include "trashbox.h"
+#include "trashbox_p.h"
+#include "vstring.h"
+#include <stdio.h>
 #include <string.h>
 
 static void test_fname_absolute(void)
@@ -69,9 +76,225 @@ static void test_routines_strrstr(void)
 	TEST_CHECK(strcmp(strrstr("abcdcdb", "cd"), "cdb") == 0);
 }
 
+static void test_vstring_grow(void)
+{
+	const char *s = "0123456789abcdefghijklmnopqrstuvwxyz";
+	arena *a = arenaNew (64);
+	vString *vs[2] = { vStringNew (), vStringNewInArena (a) };
+	char *str;
+
+	for (int i = 0; i < 2; i++)
+	{
+		for (const char *c = s; *c; c++)
+			vStringPut (vs[i], *c);
+		TEST_CHECK(vStringLength (vs[i]) == strlen (s));
+		TEST_CHECK(strcmp (vStringValue (vs[i]), s) == 0);
+		vStringCatS (vs[i], s);
+		TEST_CHECK(vStringLength (vs[i]) == 2 * strlen (s));
+		TEST_CHECK(strncmp (vStringValue (vs[i]) + strlen (s), s, strlen (s)) == 0);
+	}
+	TEST_CHECK(arenaOwns (a, vs[1]));
+	TEST_CHECK(arenaOwns (a, vStringValue (vs[1])));
+
+	/* A string stored in the vString itself is copied. */
+	str = vStringDeleteUnwrap (vStringNewInit ("a"));
+	TEST_CHECK(strcmp (str, "a") == 0);
+	eFree (str);
+
+	str = vStringDeleteUnwrap (vs[0]);
+	TEST_CHECK(strlen (str) == 2 * strlen (s));
+	eFree (str);
+
+	vStringDelete (vs[1]);
+	arenaDelete (a);
+}
+
+static void test_ptrarray_items(void)
+{
+	static int n[6];
+	void *head[] = { n + 0, n + 1 };
+	void *middle[] = { n + 2, n + 3 };
+	ptrArray *a, *b;
+
+	a = ptrArrayNew (NULL);
+	ptrArrayAdd (a, n + 4);
+	ptrArrayInsertItems (a, 0, head, 2);
+	ptrArrayInsertItems (a, 2, middle, 2);
+	b = ptrArrayNew (NULL);
+	ptrArrayAdd (b, n + 5);
+	ptrArrayCombine (a, b);
+	TEST_CHECK(ptrArrayCount (a) == 6);
+	for (unsigned int i = 0; i < 6; i++)
+		TEST_CHECK(ptrArrayItem (a, i) == n + i);
+
+	for (int i = 0; i < 1000; i++)
+		ptrArrayAddItems (a, head, 2);
+	ptrArrayClear (a);
+	ptrArrayShrink (a);
+	ptrArrayAddItems (a, middle, 2);
+	TEST_CHECK(ptrArrayCount (a) == 2);
+	TEST_CHECK(ptrArrayLast (a) == n + 3);
+	ptrArrayDelete (a);
+
+	/* An array taken from the pool is empty. */
+	a = ptrArrayNew (NULL);
+	TEST_CHECK(ptrArrayIsEmpty (a));
+	ptrArrayDelete (a);
+}
+
+static void test_trashbox_alloc(void)
+{
+	struct sArena *a;
+	int *p;
+
+	initDefaultTrashBox ();
+	initParserTrashBox ();
+	a = parserTrashBoxArena ();
+	p = PARSER_TRASH_BOX_ALLOC (8, int);
+	TEST_CHECK(arenaOwns (a, p));
+	for (int i = 0; i < 8; i++)
+		TEST_CHECK(p[i] == 0);
+	finiParserTrashBox ();
+	TEST_CHECK(!arenaOwns (a, p));
+	finiDefaultTrashBox ();
+}
+
+static void test_mio_mmap(void)
+{
+	static const char contents[] = "abc\ndef\n";
+	const char *name = "utiltest-mmap.tmp";
+	char buf[8];
+	unsigned char *data;
+	size_t size;
+	FILE *fp;
+	MIO *mio;
+
+	fp = fopen (name, "wb");
+	TEST_CHECK(fp != NULL);
+	fputs (contents, fp);
+	fclose (fp);
+
+	mio = mio_new_mmap (name);
+	if (mio == NULL)
+	{
+		/* The platform doesn't support mmap. */
+		remove (name);
+		return;
+	}
+
+	data = mio_memory_get_data (mio, &size);
+	TEST_CHECK(data != NULL);
+	TEST_CHECK(size == strlen (contents));
+	TEST_CHECK(memcmp (data, contents, size) == 0);
+
+	TEST_CHECK(mio_getc (mio) == 'a');
+	TEST_CHECK(mio_gets (mio, buf, sizeof (buf)) != NULL);
+	TEST_CHECK(strcmp (buf, "bc\n") == 0);
+	TEST_CHECK(mio_seek (mio, -1, SEEK_END) == 0);
+	TEST_CHECK(mio_getc (mio) == '\n');
+	TEST_CHECK(mio_getc (mio) == EOF);
+
+	/* The buffer of the mapped stream doesn't grow. */
+	TEST_CHECK(mio_putc (mio, 'x') == EOF);
+
+	mio_unref (mio);
+	remove (name);
+
+	/* Empty file cannot be mapped. */
+	fp = fopen (name, "wb");
+	fclose (fp);
+	TEST_CHECK(mio_new_mmap (name) == NULL);
+	remove (name);
+}
+
+static void test_mio_fd(void)
+{
+	static const char contents[] = "abc\ndef\n";
+	const char *name = "utiltest-fd.tmp";
+	unsigned char *data;
+	size_t size;
+	FILE *fp, *in;
+	MIO *mio;
+
+	fp = fopen (name, "wb");
+	TEST_CHECK(fp != NULL);
+	fputs (contents, fp);
+	fclose (fp);
+
+	in = fopen (name, "rb");
+	TEST_CHECK(in != NULL);
+	mio = mio_new_fd (fileno (in), 0);
+	if (mio == NULL)
+	{
+		/* The platform doesn't support it. */
+		fclose (in);
+		remove (name);
+		return;
+	}
+
+	/* The contents of a descriptor not sealed are copied, so truncating
+	 * the file doesn't change them. */
+	fp = fopen (name, "wb");
+	fclose (fp);
+	data = mio_memory_get_data (mio, &size);
+	TEST_CHECK(size == strlen (contents));
+	TEST_CHECK(memcmp (data, contents, size) == 0);
+	mio_unref (mio);
+
+	/* The file is shorter than the size asked. */
+	TEST_CHECK(mio_new_fd (fileno (in), 4) == NULL);
+
+	fclose (in);
+	remove (name);
+}
+
+static void test_mio_lines(void)
+{
+	static char contents[] = "ab\n\ncd";
+	const unsigned char *line;
+	char buf[8];
+	size_t len;
+	MIO *mio;
+
+	mio = mio_new_memory ((unsigned char *) contents, strlen (contents), NULL, NULL);
+
+	line = mio_memory_peek_line (mio, &len);
+	TEST_CHECK(line != NULL && len == 3 && memcmp (line, "ab\n", 3) == 0);
+	TEST_CHECK(mio_tell (mio) == 0);
+	TEST_CHECK(mio_seek (mio, (long) len, SEEK_CUR) == 0);
+
+	line = mio_memory_peek_line (mio, &len);
+	TEST_CHECK(line != NULL && len == 1 && line[0] == '\n');
+
+	/* A pushed back character is not in the buffer. */
+	TEST_CHECK(mio_getc (mio) == '\n');
+	TEST_CHECK(mio_ungetc (mio, '\n') == '\n');
+	TEST_CHECK(mio_memory_peek_line (mio, &len) == NULL);
+	TEST_CHECK(mio_gets (mio, buf, sizeof (buf)) != NULL);
+	TEST_CHECK(strcmp (buf, "\n") == 0);
+
+	/* The last line has no new-line character. */
+	TEST_CHECK(mio_memory_peek_line (mio, &len) == NULL);
+	TEST_CHECK(mio_gets (mio, buf, 2) != NULL);
+	TEST_CHECK(strcmp (buf, "c") == 0);
+	TEST_CHECK(!mio_eof (mio));
+	TEST_CHECK(mio_gets (mio, buf, sizeof (buf)) != NULL);
+	TEST_CHECK(strcmp (buf, "d") == 0);
+	TEST_CHECK(mio_eof (mio));
+	TEST_CHECK(mio_gets (mio, buf, sizeof (buf)) == NULL);
+
+	mio_unref (mio);
+}
+
 TEST_LIST = {
    { "fname/absolute",   test_fname_absolute   },
    { "htable/update",    test_htable_update    },
+   { "mio/mmap",         test_mio_mmap         },
+   { "mio/fd",           test_mio_fd           },
+   { "mio/lines",        test_mio_lines        },
+   { "ptrarray/items",   test_ptrarray_items   },
    { "routines/strrstr", test_routines_strrstr },
+   { "trashbox/alloc",   test_trashbox_alloc   },
+   { "vstring/grow",     test_vstring_grow     },
    { NULL, NULL }     /* zeroed record marking the end of the list */
 };
@@ -9,6 +9,13 @@
 /*
 *   INCLUDE FILES
 */
+#ifdef HAVE_CONFIG_H
+#include <config.h>  /* zlib.h includes unistd.h, which may be of gnulib */
+#endif
+#if defined(HAVE_ZLIB) && !defined(_WIN32) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE  /* to declare fopencookie () */
+#endif
+
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
@@ -16,6 +23,16 @@
 #include <errno.h>
 #include <sys/types.h>  /* to declare off_t */
 
+#if defined (HAVE_MMAP) && defined (HAVE_SYS_MMAN_H)
+#include <stdint.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
 #include "readtags.h"
 
 /*
@@ -39,6 +56,133 @@ typedef long long rt_off_t;
 typedef off_t rt_off_t;
 #endif
 
+/* Columns of a binary tag database in the order they are stored */
+enum {
+	BINARY_COLUMN_NAME,
+	BINARY_COLUMN_KIND,
+	BINARY_COLUMN_FILE,
+	BINARY_COLUMN_LINE,
+	BINARY_COLUMN_END,
+	BINARY_COLUMN_PATTERN,
+	BINARY_COLUMN_SCOPE,
+	BINARY_COLUMN_FLAGS,
+	BINARY_COLUMN_COUNT
+};
+
+typedef struct {
+	unsigned long count;
+	unsigned long *values;
+} binaryTable;
+
+/* Binary tag database loaded in memory */
+typedef struct {
+		/* the strings, each of them is terminated by NUL */
+	char *data;
+	const char **strings;
+	unsigned long stringCount;
+		/* language: name */
+	binaryTable languages;
+		/* kind: language, letter, name */
+	binaryTable kinds;
+		/* file: path */
+	binaryTable files;
+		/* scope: kind name, scope name */
+	binaryTable scopes;
+	unsigned long rowCount;
+	unsigned long *columns [BINARY_COLUMN_COUNT];
+		/* the row read next */
+	unsigned long row;
+		/* buffers for the entry of the last row read */
+	char lineNumber [21];
+	char endLine [21];
+	tagExtensionField fields [3];
+} binaryDb;
+
+#ifdef HAVE_ZLIB
+/* A gzip member of a tag file compressed by ctags */
+typedef struct {
+		/* offset and size of the member in the compressed file */
+	rt_off_t offset;
+	unsigned long size;
+		/* offset and length of the data in the tag file */
+	rt_off_t start;
+	unsigned long length;
+} gzipMember;
+
+/* Random access to a tag file compressed by ctags */
+typedef struct {
+	FILE *fp;
+	gzipMember *members;
+	size_t count;
+	rt_off_t size;
+	rt_off_t pos;
+		/* index of the member decompressed in data, or count */
+	size_t cached;
+	unsigned char *data;
+	size_t dataSize;
+	unsigned char *buf;
+	size_t bufSize;
+	z_stream z;
+} gzipReader;
+#endif
+
+/* Sparse index of names written by ctags --name-index */
+typedef struct {
+	rt_off_t offset;
+	const char *name;
+} nameIndexEntry;
+
+typedef struct {
+		/* the content of the index file */
+	char *data;
+	nameIndexEntry *entries;
+	size_t count;
+		/* the size and the sort method of the tag file indexed */
+	rt_off_t size;
+	tagSortType sortMethod;
+} nameIndex;
+
+/* Index of the trigrams in names written by ctags --trigram-index */
+typedef struct {
+	unsigned long trigram;
+		/* number of the lines in the postings */
+	unsigned long count;
+	const unsigned char *postings;
+	size_t length;
+} trigramIndexEntry;
+
+typedef struct {
+		/* the content of the index file */
+	unsigned char *data;
+		/* offsets of the tag lines */
+	rt_off_t *offsets;
+	unsigned long lines;
+	trigramIndexEntry *entries;
+	unsigned long count;
+		/* the size of the tag file indexed */
+	rt_off_t size;
+} trigramIndex;
+
+/* Index of the tag lines of the input files written by ctags --file-index */
+typedef struct {
+		/* the input file as written in the tag lines; not terminated */
+	const char *name;
+	size_t nameLength;
+		/* number of the lines in the postings */
+	unsigned long count;
+	const unsigned char *postings;
+	size_t length;
+} fileIndexEntry;
+
+typedef struct {
+		/* the content of the index file */
+	unsigned char *data;
+	fileIndexEntry *entries;
+	unsigned long count;
+		/* the size of the tag file indexed */
+	rt_off_t size;
+} fileIndex;
+
 /* Information about current tag file */
 struct sTagFile {
 		/* has the file been opened and this structure initialized? */
@@ -51,8 +195,24 @@ struct sTagFile {
 	unsigned char inputUCtagsMode;
 		/* how is the tag file sorted? */
 	tagSortType sortMethod;
-		/* pointer to file structure */
+		/* pointer to file structure (NULL for a cursor) */
 	FILE* fp;
+		/* path the file is opened with */
+	char *path;
+		/* the tag file a cursor made by tagsOpenCursor() reads;
+		 * NULL for a tag file opened by tagsOpen() */
+	tagFile *owner;
+		/* the content of the tag file mapped in memory; the lines
+		 * are read from it instead of fp unless data is NULL */
+	struct {
+		char *data;
+		rt_off_t size;
+			/* offset of the line read next */
+		rt_off_t pos;
+			/* 1 if cursors read the mapping; it is not mapped
+			 * again then */
+		short shared;
+	} map;
 		/* file position of first character of `line' */
 	rt_off_t pos;
 		/* size of tag file in seekable positions */
@@ -73,6 +233,32 @@ struct sTagFile {
 			short partial;
 				/* ignoring case */
 			short ignorecase;
+				/* file position no line matching the name last
+				 * searched for is before; tagsFindAfter() starts
+				 * there for a name not less than it */
+			rt_off_t cursor;
+				/* performing substring match */
+			short substring;
+				/* 1 if the lines of the candidates are read
+				 * instead of the whole tag file */
+			short indexed;
+				/* numbers of the tag lines in the trigram index
+				 * whose names may contain the name */
+			unsigned long *candidates;
+			unsigned long candidateCount;
+				/* index of the candidate read next */
+			unsigned long candidate;
+				/* matching the input files instead of the names */
+			short byFile;
+				/* 1 if the lines in the postings of the file index
+				 * are read instead of the whole tag file */
+			short fileIndexed;
+				/* the postings of the input file not decoded yet */
+			const unsigned char *postings;
+			const unsigned char *postingsEnd;
+			unsigned long postingsLeft;
+				/* offset of the line of the last posting decoded */
+			rt_off_t postingOffset;
 	} search;
 		/* miscellaneous extension fields */
 	struct {
@@ -95,6 +281,57 @@ struct sTagFile {
 		/* 0 (initial state set by calloc), errno value,
 		 * or tagErrno typed value */
 	int err;
+		/* NULL unless the file is a binary tag database */
+	binaryDb *binary;
+		/* name index referred by TAG_NAME_INDEX pseudo tag */
+	struct {
+			/* path of the index file, or NULL */
+		char *path;
+			/* has loading the index been tried? */
+		short tried;
+			/* NULL if the index is not available */
+		nameIndex *index;
+	} nameIndex;
+		/* trigram index referred by TAG_TRIGRAM_INDEX pseudo tag */
+	struct {
+			/* path of the index file, or NULL */
+		char *path;
+			/* has loading the index been tried? */
+		short tried;
+			/* 1 if the index is the one of the owner of a cursor */
+		short borrowed;
+			/* NULL if the index is not available */
+		trigramIndex *index;
+	} trigramIndex;
+		/* file index referred by TAG_FILE_INDEX pseudo tag */
+	struct {
+			/* path of the index file, or NULL */
+		char *path;
+			/* has loading the index been tried? */
+		short tried;
+			/* 1 if the index is the one of the owner of a cursor */
+		short borrowed;
+			/* NULL if the index is not available */
+		fileIndex *index;
+	} fileIndex;
+		/* shards referred by TAG_SHARD pseudo tags */
+	struct {
+		char **paths;
+		tagFile **files;
+		unsigned int count;
+			/* index of the shard being read */
+		unsigned int current;
+	} shards;
+		/* the part of the tag file tagsFirst() and tagsNext() read;
+		 * set by tagsSetPart() */
+	struct {
+		unsigned int part;
+			/* 0 for reading the whole tag file */
+		unsigned int parts;
+			/* offset, or row of a binary tag database, the part
+			 * ends before */
+		rt_off_t end;
+	} range;
 };
 
 /*
@@ -103,6 +340,11 @@ struct sTagFile {
 static const char *const EmptyString = "";
 static const char *const PseudoTagPrefix = "!_";
 static const size_t PseudoTagPrefixLength = 2;
+static const char *const NameIndexMagic = "!_CTAGS_NAME_INDEX\t";
+static const char *const TrigramIndexMagic = "!_CTAGS_TRIGRAM_INDEX\t";
+static const char *const FileIndexMagic = "!_CTAGS_FILE_INDEX\t";
+static const char *const BinaryDbMagic = "!_CTAGS_BINARY_DB\t";
+static const size_t BinaryDbMagicLength = 18;
 
 /*
 *   FUNCTION DEFINITIONS
@@ -134,6 +376,85 @@ static int readtags_fseek(FILE *fp, rt_off_t pos, int whence)
 	return ret;
 }
 
+static void unmapTagFile (tagFile *const file)
+{
+#if defined (HAVE_MMAP) && defined (HAVE_SYS_MMAN_H)
+	if (file->map.data)
+		munmap (file->map.data, (size_t) file->map.size);
+#endif
+	file->map.data = NULL;
+	file->map.size = 0;
+	file->map.pos = 0;
+}
+
+/* Map the tag file opened as fp in memory if the platform allows it.
+ * Looking up a name in a large tag file then reads a few pages of the
+ * page cache without a system call for each probe of the binary
+ * search. A compressed tag file is read through fp. */
+static void mapTagFile (tagFile *const file)
+{
+#if defined (HAVE_MMAP) && defined (HAVE_SYS_MMAN_H)
+	struct stat st;
+	void *data;
+	int fd = fileno (file->fp);
+
+	if (fd < 0 || fstat (fd, &st) < 0 || !S_ISREG (st.st_mode)
+		|| st.st_size <= 0 || (uintmax_t) st.st_size > SIZE_MAX)
+		return;
+
+	data = mmap (NULL, (size_t) st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	if (data == MAP_FAILED)
+		return;
+
+	file->map.data = (char *) data;
+	file->map.size = (rt_off_t) st.st_size;
+	file->map.pos = 0;
+#endif
+}
+
+/* A tag file rewritten while it is open must not be read beyond its
+ * end through the mapping. Map it again if its size has changed. */
+static void remapTagFileIfResized (tagFile *const file)
+{
+#if defined (HAVE_MMAP) && defined (HAVE_SYS_MMAN_H)
+	struct stat st;
+
+	if (file->map.data == NULL || file->map.shared || file->owner)
+		return;
+	if (fstat (fileno (file->fp), &st) == 0
+		&& (rt_off_t) st.st_size == file->map.size)
+		return;
+
+	unmapTagFile (file);
+	mapTagFile (file);
+#endif
+}
+
+static rt_off_t tellTagFile (tagFile *const file)
+{
+	if (file->map.data)
+		return file->map.pos;
+	return readtags_ftell (file->fp);
+}
+
+static int seekTagFile (tagFile *const file, rt_off_t pos, int whence)
+{
+	if (file->map.data == NULL)
+		return readtags_fseek (file->fp, pos, whence);
+
+	if (whence == SEEK_CUR)
+		pos += file->map.pos;
+	else if (whence == SEEK_END)
+		pos += file->map.size;
+	if (pos < 0)
+	{
+		errno = EINVAL;
+		return -1;
+	}
+	file->map.pos = pos;
+	return 0;
+}
+
 /* Converts a hexadecimal digit to its value */
 static int xdigitValue (char digit)
 {
@@ -250,6 +571,64 @@ static int tagncmp (const char *s1, const char *s2, size_t n)
 	return result;
 }
 
+/* Return 1 if NAME contains the name searched for. ESCAPED is 1 for
+ * a name written in a tag line. */
+static int containsSearchName (tagFile *const file, const char *name,
+							   const int escaped)
+{
+	for (;;)
+	{
+		const char *s1 = file->search.name;
+		const char *s2 = name;
+		int c1, c2;
+
+		do
+		{
+			c1 = (unsigned char) *s1++;
+			if (c1 == '\0')
+				return 1;
+			c2 = escaped? readTagCharacter (&s2): (unsigned char) *s2++;
+			if (file->search.ignorecase)
+			{
+				c1 = toupper (c1);
+				c2 = toupper (c2);
+			}
+		} while (c1 == c2);
+
+		if (*name == '\0')
+			return 0;
+		if (escaped)
+			readTagCharacter (&name);
+		else
+			++name;
+	}
+}
+
+/* Compare the name searched for with the input file INPUT, ending at a
+ * tab or the end of the string. ESCAPED is 1 for an input file written
+ * in a tag line in u-ctags output mode. */
+static int compareSearchFile (tagFile *const file, const char *input,
+							  const int escaped)
+{
+	const char *s1 = file->search.name;
+	int c1, c2;
+
+	do
+	{
+		c1 = (unsigned char) *s1++;
+		if (*input == TAB || *input == '\0')
+			c2 = '\0';
+		else
+			c2 = escaped? readTagCharacter (&input): (unsigned char) *input++;
+		if (file->search.ignorecase)
+		{
+			c1 = toupper (c1);
+			c2 = toupper (c2);
+		}
+	} while (c1 == c2  &&  c1 != '\0');
+	return c1 - c2;
+}
+
 static tagResult growString (vstring *s)
 {
 	tagResult result = TagFailure;
@@ -303,11 +682,54 @@ static tagResult copyName (tagFile *const file)
 	return TagSuccess;
 }
 
-/* Return 1 on success.
- * Return 0 on failure or EOF.
- * errno is set to *err unless EOF.
- */
-static int readTagLineRaw (tagFile *const file, int *err)
+/* Strip the line terminators at the end of the line read. */
+static void chopLine (tagFile *const file)
+{
+	size_t i = strlen (file->line.buffer);
+	while (i > 0  &&
+		   (file->line.buffer [i - 1] == '\n' || file->line.buffer [i - 1] == '\r'))
+	{
+		file->line.buffer [i - 1] = '\0';
+		--i;
+	}
+}
+
+/* Copy the next line of the mapped tag file to the line buffer, as
+ * fgets () would read it. */
+static int readTagLineFromMap (tagFile *const file, int *err)
+{
+	const char *start, *nl;
+	size_t length;
+
+	file->pos = file->map.pos;
+	if (file->map.pos >= file->map.size)
+	{
+		*err = 0;
+		return 0;
+	}
+
+	start = file->map.data + file->map.pos;
+	length = (size_t) (file->map.size - file->map.pos);
+	nl = (const char *) memchr (start, '\n', length);
+	if (nl)
+		length = (size_t) (nl - start) + 1;
+
+	while (length >= file->line.size)
+	{
+		if (growString (&file->line) != TagSuccess)
+		{
+			*err = ENOMEM;
+			return 0;
+		}
+	}
+	memcpy (file->line.buffer, start, length);
+	file->line.buffer [length] = '\0';
+	file->map.pos += length;
+	chopLine (file);
+	return 1;
+}
+
+static int readTagLineFromFile (tagFile *const file, int *err)
 {
 	int result = 1;
 	int reReadLine;
@@ -358,16 +780,23 @@ static int readTagLineRaw (tagFile *const file, int *err)
 			reReadLine = 1;
 		}
 		else
-		{
-			size_t i = strlen (file->line.buffer);
-			while (i > 0  &&
-				   (file->line.buffer [i - 1] == '\n' || file->line.buffer [i - 1] == '\r'))
-			{
-				file->line.buffer [i - 1] = '\0';
-				--i;
-			}
-		}
+			chopLine (file);
 	} while (reReadLine  &&  result);
+	return result;
+}
+
+/* Return 1 on success.
+ * Return 0 on failure or EOF.
+ * errno is set to *err unless EOF.
+ */
+static int readTagLineRaw (tagFile *const file, int *err)
+{
+	int result;
+
+	if (file->map.data)
+		result = readTagLineFromMap (file, err);
+	else
+		result = readTagLineFromFile (file, err);
 	if (result)
 	{
 		if (copyName (file) != TagSuccess)
@@ -410,12 +839,31 @@ static tagResult growFields (tagFile *const file)
 	return result;
 }
 
+/* When unescaping, the input string becomes shorter.
+ * e.g. \t occupies two bytes on the tag file.
+ * It is converted to 0x9 and occupies one byte.
+ * The characters are moved within the string only; the
+ * rest of the line buffer stays where it is. Returns the
+ * new end of the string. */
+static char *unescapeInPlace (char *q)
+{
+	char *w = strchr (q, '\\');
+	const char *r = w;
+
+	if (w == NULL)
+		return q + strlen (q);
+
+	while (*r != '\0')
+		*w++ = (char) readTagCharacter (&r);
+	*w = '\0';
+
+	return w;
+}
+
 static tagResult parseExtensionFields (tagFile *const file, tagEntry *const entry,
 									   char *const string, int *err)
 {
 	char *p = string;
-	char *tail = string + (string? strlen(string):0);
-	size_t q_len;
 
 	while (p != NULL  &&  *p != '\0')
 	{
@@ -439,28 +887,7 @@ static tagResult parseExtensionFields (tagFile *const file, tagEntry *const entr
 				const int key_len = colon - key;
 				*colon = '\0';
 
-				q_len = tail - q;
-
-				/* Unescaping */
-				while (*q != '\0')
-				{
-					const char *next = q;
-					int ch = readTagCharacter (&next);
-					size_t skip = next - q;
-
-					*q = (char) ch;
-					q++;
-					q_len -= skip;
-					if (skip > 1)
-					{
-						/* + 1 is for moving the area including the last '\0'. */
-						memmove (q, next, q_len + 1);
-						if (p)
-							p -= skip - 1;
-						if (tail != string)
-							tail -= skip - 1;
-					}
-				}
+				unescapeInPlace (q);
 
 				if (key_len == 4)
 				{
@@ -523,41 +950,10 @@ static unsigned int countContinuousBackslashesBackward(const char *from,
 	return counter;
 }
 
-/* When unescaping, the input string becomes shorter.
- * e.g. \t occupies two bytes on the tag file.
- * It is converted to 0x9 and occupies one byte.
- * memmove called here for shortening the line
- * buffer. */
-static char *unescapeInPlace (char *q, char **tab, size_t *p_len)
-{
-	char *p = q;
-
-	while (*p != '\0')
-	{
-		const char *next = p;
-		int ch = readTagCharacter (&next);
-		size_t skip = next - p;
-
-		*p = (char) ch;
-		p++;
-		*p_len -= skip;
-		if (skip > 1)
-		{
-			/* + 1 is for moving the area including the last '\0'. */
-			memmove (p, next, *p_len + 1);
-			if (*tab)
-				*tab -= skip - 1;
-		}
-	}
-
-	return p;
-}
-
 static tagResult parseTagLine (tagFile *file, tagEntry *const entry, int *err)
 {
 	int i;
 	char *p = file->line.buffer;
-	size_t p_len = strlen (p);
 	char *tab = strchr (p, TAB);
 
 	memset(entry, 0, sizeof(*entry));
@@ -568,7 +964,7 @@ static tagResult parseTagLine (tagFile *file, tagEntry *const entry, int *err)
 		*tab = '\0';
 	}
 
-	p = unescapeInPlace (p, &tab, &p_len);
+	p = unescapeInPlace (p);
 
 	if (tab != NULL)
 	{
@@ -581,7 +977,7 @@ static tagResult parseTagLine (tagFile *file, tagEntry *const entry, int *err)
 			{
 				*tab = '\0';
 			}
-			p = unescapeInPlace (p, &tab, &p_len);
+			p = unescapeInPlace (p);
 		}
 
 		if (tab != NULL)
@@ -688,7 +1084,7 @@ static int isPseudoTagLine (const char *buffer)
 
 static tagResult readPseudoTags (tagFile *const file, tagFileInfo *const info)
 {
-	fpos_t startOfLine;
+	rt_off_t startOfLine;
 	int err = 0;
 	tagResult result = TagSuccess;
 	const size_t prefixLength = strlen (PseudoTagPrefix);
@@ -704,7 +1100,7 @@ static tagResult readPseudoTags (tagFile *const file, tagFileInfo *const info)
 
 	while (1)
 	{
-		if (fgetpos (file->fp, &startOfLine) < 0)
+		if ((startOfLine = tellTagFile (file)) < 0)
 		{
 			err = errno;
 			break;
@@ -789,6 +1185,54 @@ static tagResult readPseudoTags (tagFile *const file, tagFileInfo *const info)
 				if (strcmp (value, "slash") == 0)
 					tag_output_filesep_slash = 1;
 			}
+			else if (strcmp (key, "TAG_SHARD") == 0)
+			{
+				char **paths = (char**) realloc (file->shards.paths,
+					(file->shards.count + 1) * sizeof (char*));
+				if (paths == NULL)
+				{
+					err = ENOMEM;
+					break;
+				}
+				file->shards.paths = paths;
+				paths [file->shards.count] = duplicate (value);
+				if (paths [file->shards.count] == NULL)
+				{
+					err = ENOMEM;
+					break;
+				}
+				file->shards.count++;
+			}
+			else if (strcmp (key, "TAG_NAME_INDEX") == 0)
+			{
+				free (file->nameIndex.path);
+				file->nameIndex.path = duplicate (value);
+				if (value && file->nameIndex.path == NULL)
+				{
+					err = ENOMEM;
+					break;
+				}
+			}
+			else if (strcmp (key, "TAG_TRIGRAM_INDEX") == 0)
+			{
+				free (file->trigramIndex.path);
+				file->trigramIndex.path = duplicate (value);
+				if (value && file->trigramIndex.path == NULL)
+				{
+					err = ENOMEM;
+					break;
+				}
+			}
+			else if (strcmp (key, "TAG_FILE_INDEX") == 0)
+			{
+				free (file->fileIndex.path);
+				file->fileIndex.path = duplicate (value);
+				if (value && file->fileIndex.path == NULL)
+				{
+					err = ENOMEM;
+					break;
+				}
+			}
 
 			info->file.format     = file->format;
 			info->file.sort       = file->sortMethod;
@@ -802,7 +1246,7 @@ static tagResult readPseudoTags (tagFile *const file, tagFileInfo *const info)
 	if (tag_output_mode_u_ctags && tag_output_filesep_slash)
 		file->inputUCtagsMode = 1;
 
-	if (fsetpos (file->fp, &startOfLine) < 0)
+	if (seekTagFile (file, startOfLine, SEEK_SET) < 0)
 		err = errno;
 
 	info->status.error_number = err;
@@ -816,11 +1260,51 @@ static int doesFilePointPseudoTag (tagFile *const file, void *unused)
 	return isPseudoTagLine (file->name.buffer);
 }
 
+/* Return where the part I of the range set by tagsSetPart() starts in
+ * SIZE offsets or rows. */
+static rt_off_t partStart (tagFile *const file, const unsigned int i,
+						   const rt_off_t size)
+{
+	const rt_off_t parts = (rt_off_t) file->range.parts;
+
+	return size / parts * i + size % parts * i / parts;
+}
+
 static tagResult gotoFirstLogicalTag (tagFile *const file)
 {
-	fpos_t startOfLine;
+	rt_off_t startOfLine;
+	rt_off_t start;
+
+	if (file->binary)
+	{
+		file->binary->row = 0;
+		if (file->range.parts > 0)
+		{
+			rt_off_t rows = (rt_off_t) file->binary->rowCount;
+			file->binary->row = (unsigned long) partStart (file, file->range.part, rows);
+			file->range.end = partStart (file, file->range.part + 1, rows);
+		}
+		return TagSuccess;
+	}
+
+	if (file->shards.count > 0)
+	{
+		/* The shards are not split; they are all in the part 0. */
+		if (file->range.parts > 0 && file->range.part > 0)
+		{
+			file->shards.current = file->shards.count;
+			return TagSuccess;
+		}
+		file->shards.current = 0;
+		if (gotoFirstLogicalTag (file->shards.files [0]) != TagSuccess)
+		{
+			file->err = file->shards.files [0]->err;
+			return TagFailure;
+		}
+		return TagSuccess;
+	}
 
-	if (readtags_fseek(file->fp, 0, SEEK_SET) == -1)
+	if (seekTagFile (file, 0, SEEK_SET) == -1)
 	{
 		file->err = errno;
 		return TagFailure;
@@ -828,7 +1312,7 @@ static tagResult gotoFirstLogicalTag (tagFile *const file)
 
 	while (1)
 	{
-		if (fgetpos (file->fp, &startOfLine) < 0)
+		if ((startOfLine = tellTagFile (file)) < 0)
 		{
 			file->err = errno;
 			return TagFailure;
@@ -842,7 +1326,31 @@ static tagResult gotoFirstLogicalTag (tagFile *const file)
 		if (!isPseudoTagLine (file->line.buffer))
 			break;
 	}
-	if (fsetpos (file->fp, &startOfLine) < 0)
+
+	/* A line is in the part its first character is in. */
+	if (file->range.parts > 0)
+	{
+		start = partStart (file, file->range.part, file->size);
+		file->range.end = partStart (file, file->range.part + 1, file->size);
+		if (start > startOfLine)
+		{
+			if (seekTagFile (file, start - 1, SEEK_SET) < 0)
+			{
+				file->err = errno;
+				return TagFailure;
+			}
+			/* skip the rest of the line of the previous part */
+			if (! readTagLineRaw (file, &file->err) && file->err)
+				return TagFailure;
+			if ((startOfLine = tellTagFile (file)) < 0)
+			{
+				file->err = errno;
+				return TagFailure;
+			}
+		}
+	}
+
+	if (seekTagFile (file, startOfLine, SEEK_SET) < 0)
 	{
 		file->err = errno;
 		return TagFailure;
@@ -850,318 +1358,1958 @@ static tagResult gotoFirstLogicalTag (tagFile *const file)
 	return TagSuccess;
 }
 
-static tagFile *initialize (const char *const filePath, tagFileInfo *const info)
+/*
+ * Binary tag database
+ *
+ * ctags --output-format=binary writes the tags as columns of numbers
+ * referring to interned strings. See main/writer-binary.c of Universal
+ * Ctags for the layout. The whole database is loaded into memory when
+ * the file is opened, and tagEntry values point into it.
+ */
+static int isBinaryDbLine (const char *buffer)
 {
-	tagFile *result = (tagFile*) calloc ((size_t) 1, sizeof (tagFile));
+	return (strncmp (buffer, BinaryDbMagic, BinaryDbMagicLength) == 0);
+}
 
-	if (result == NULL)
+typedef struct {
+	const unsigned char *p;
+	const unsigned char *end;
+} binaryCursor;
+
+static int readVarint (binaryCursor *c, unsigned long *n)
+{
+	unsigned long v = 0;
+	unsigned int shift = 0;
+
+	while (c->p < c->end)
 	{
-		info->status.opened = 0;
-		info->status.error_number = ENOMEM;
-		return NULL;
+		const unsigned char b = *c->p++;
+
+		if (shift < sizeof (v) * 8)
+			v |= (unsigned long) (b & 0x7f) << shift;
+		shift += 7;
+		if ((b & 0x80) == 0)
+		{
+			*n = v;
+			return 1;
+		}
 	}
+	return 0;
+}
 
-	if (growString (&result->line) != TagSuccess)
-		goto mem_error;
-	if (growString (&result->name) != TagSuccess)
-		goto mem_error;
-	result->fields.max = 20;
-	result->fields.list = (tagExtensionField*) calloc (
-		result->fields.max, sizeof (tagExtensionField));
-	if (result->fields.list == NULL)
-		goto mem_error;
+/* Read COUNT numbers, each of them must be less than LIMIT. */
+static unsigned long *readNumbers (binaryCursor *c, unsigned long count,
+								   unsigned long limit)
+{
+	unsigned long *numbers;
+	unsigned long i;
 
-#if defined(__GLIBC__) && (__GLIBC__ >= 2) \
-	&& defined(__GLIBC_MINOR__) && (__GLIBC_MINOR__ >= 3)
-	result->fp = fopen (filePath, "rbm");
-#endif
-	if (result->fp == NULL)
+	/* A number takes one byte at least. */
+	if (count > (unsigned long) (c->end - c->p))
+		return NULL;
+
+	numbers = (unsigned long *) malloc ((count? count: 1) * sizeof (unsigned long));
+	if (numbers == NULL)
+		return NULL;
+
+	for (i = 0; i < count; i++)
 	{
-		errno = 0;
-		result->fp = fopen (filePath, "rb");
+		if (! readVarint (c, numbers + i)
+			|| (limit > 0 && numbers [i] >= limit))
+		{
+			free (numbers);
+			return NULL;
+		}
 	}
-	if (result->fp == NULL)
+	return numbers;
+}
+
+static tagResult readBinaryTable (binaryCursor *c, binaryTable *table,
+								  unsigned int width, const unsigned long *limits)
+{
+	unsigned long i;
+
+	if (! readVarint (c, &table->count)
+		|| table->count > (unsigned long) (c->end - c->p))
+		return TagFailure;
+
+	table->values = readNumbers (c, table->count * width, 0);
+	if (table->values == NULL)
+		return TagFailure;
+
+	for (i = 0; i < table->count * width; i++)
 	{
-		info->status.error_number = errno;
-		goto file_error;
+		if (table->values [i] >= limits [i % width])
+			return TagFailure;
 	}
+	return TagSuccess;
+}
 
-	/* Record the size of the tags file to `size` field of result. */
-	if (readtags_fseek (result->fp, 0, SEEK_END) == -1)
+static void deleteBinaryDb (binaryDb *db)
+{
+	int i;
+
+	free (db->data);
+	free (db->strings);
+	free (db->languages.values);
+	free (db->kinds.values);
+	free (db->files.values);
+	free (db->scopes.values);
+	for (i = 0; i < BINARY_COLUMN_COUNT; i++)
+		free (db->columns [i]);
+	free (db);
+}
+
+static tagResult loadBinaryDb (tagFile *const file, tagFileInfo *const info)
+{
+	binaryDb *db;
+	const char *version = file->line.buffer + BinaryDbMagicLength;
+	rt_off_t start = tellTagFile (file);
+	size_t size;
+	unsigned char *buf = NULL;
+	binaryCursor c;
+	unsigned long sort, i;
+	char *q;
+	unsigned long limits [3];
+
+	if (strtol (version, NULL, 10) != 1)
 	{
-		info->status.error_number = errno;
-		goto file_error;
+		info->status.error_number = TagErrnoUnexpectedFormat;
+		return TagFailure;
 	}
-	result->size = readtags_ftell (result->fp);
-	if (result->size == -1)
+
+	if (start < 0)
 	{
-		/* fseek() retruns an int value.
-		 * We observed following behavior on Windows;
-		 * if sizeof(int) of the platform is too small for
-		 * representing the size of the tags file, fseek()
-		 * returns -1 and it doesn't set errno.
-		 */
 		info->status.error_number = errno;
-		if (info->status.error_number == 0)
-			info->status.error_number = TagErrnoFileMaybeTooBig;
+		return TagFailure;
+	}
+	size = (size_t) (file->size - start);
 
-		goto file_error;
+	db = (binaryDb *) calloc (1, sizeof (binaryDb));
+	buf = (unsigned char *) malloc (size? size: 1);
+	if (db == NULL || buf == NULL)
+		goto mem_error;
+	if (file->map.data)
+		memcpy (buf, file->map.data + start, size);
+	else if (fread (buf, 1, size, file->fp) != size)
+	{
+		info->status.error_number = ferror (file->fp)? errno: TagErrnoUnexpectedFormat;
+		goto error;
 	}
-	if (readtags_fseek(result->fp, 0, SEEK_SET) == -1)
+
+	c.p = buf;
+	c.end = buf + size;
+
+	if (! readVarint (&c, &sort) || sort > TAG_FOLDSORTED)
 	{
-		info->status.error_number = errno;
-		goto file_error;
+		info->status.error_number = TagErrnoUnexpectedSortedMethod;
+		goto error;
 	}
 
-	if (readPseudoTags (result, info) == TagFailure)
-		goto file_error;
+	/* Each string takes its length and bytes. The data has the
+	 * bytes and NUL characters. */
+	if (! readVarint (&c, &db->stringCount) || db->stringCount == 0
+		|| db->stringCount > (unsigned long) (c.end - c.p))
+		goto format_error;
+	db->data = (char *) malloc ((size_t) (c.end - c.p));
+	db->strings = (const char **) malloc (db->stringCount * sizeof (char *));
+	if (db->data == NULL || db->strings == NULL)
+		goto mem_error;
+	q = db->data;
+	for (i = 0; i < db->stringCount; i++)
+	{
+		unsigned long len;
+
+		if (! readVarint (&c, &len) || len > (unsigned long) (c.end - c.p))
+			goto format_error;
+		memcpy (q, c.p, len);
+		c.p += len;
+		db->strings [i] = q;
+		q += len;
+		*q++ = '\0';
+	}
 
-	info->status.opened = 1;
-	result->initialized = 1;
+	limits [0] = db->stringCount;
+	if (readBinaryTable (&c, &db->languages, 1, limits) != TagSuccess)
+		goto format_error;
+	limits [0] = db->languages.count;
+	limits [1] = 256;
+	limits [2] = db->stringCount;
+	if (readBinaryTable (&c, &db->kinds, 3, limits) != TagSuccess)
+		goto format_error;
+	limits [0] = db->stringCount;
+	if (readBinaryTable (&c, &db->files, 1, limits) != TagSuccess)
+		goto format_error;
+	limits [1] = db->stringCount;
+	if (readBinaryTable (&c, &db->scopes, 2, limits) != TagSuccess)
+		goto format_error;
+
+	if (! readVarint (&c, &db->rowCount))
+		goto format_error;
+	for (i = 0; i < BINARY_COLUMN_COUNT; i++)
+	{
+		unsigned long limit = 0;
+
+		switch (i)
+		{
+		case BINARY_COLUMN_NAME:
+		case BINARY_COLUMN_PATTERN:
+			limit = db->stringCount;
+			break;
+		case BINARY_COLUMN_KIND:
+			limit = db->kinds.count;
+			break;
+		case BINARY_COLUMN_FILE:
+			limit = db->files.count;
+			break;
+		case BINARY_COLUMN_SCOPE:
+			limit = db->scopes.count;
+			break;
+		}
+		db->columns [i] = readNumbers (&c, db->rowCount, limit);
+		if (db->columns [i] == NULL)
+			goto format_error;
+	}
+
+	free (buf);
+
+	file->binary = db;
+	file->format = 2;
+	file->sortMethod = (tagSortType) sort;
+	info->file.format = file->format;
+	info->file.sort = file->sortMethod;
+	info->program.author = NULL;
+	info->program.name = NULL;
+	info->program.url = NULL;
+	info->program.version = NULL;
+	return TagSuccess;
 
-	return result;
  mem_error:
 	info->status.error_number = ENOMEM;
- file_error:
-	free (result->line.buffer);
-	free (result->name.buffer);
-	free (result->fields.list);
-	if (result->fp)
-		fclose (result->fp);
-	free (result);
-	info->status.opened = 0;
-	return NULL;
+	goto error;
+ format_error:
+	info->status.error_number = TagErrnoUnexpectedFormat;
+ error:
+	free (buf);
+	if (db)
+		deleteBinaryDb (db);
+	return TagFailure;
 }
 
-static void terminate (tagFile *const file)
+static const char *binaryString (const binaryDb *db, const int column,
+								 unsigned long row)
 {
-	fclose (file->fp);
+	return db->strings [db->columns [column][row]];
+}
 
-	free (file->line.buffer);
-	free (file->name.buffer);
-	free (file->fields.list);
+static void fillBinaryEntry (tagFile *const file, tagEntry *const entry,
+							 unsigned long row)
+{
+	binaryDb *db = file->binary;
+	const unsigned long *kind = db->kinds.values
+		+ 3 * db->columns [BINARY_COLUMN_KIND][row];
+	const unsigned long scope = db->columns [BINARY_COLUMN_SCOPE][row];
+	const unsigned long end = db->columns [BINARY_COLUMN_END][row];
+	const char *language = db->strings [db->languages.values [kind [0]]];
+	unsigned short n = 0;
+
+	memset (entry, 0, sizeof (*entry));
+
+	entry->name = binaryString (db, BINARY_COLUMN_NAME, row);
+	entry->file = db->strings [db->files.values [db->columns [BINARY_COLUMN_FILE][row]]];
+	entry->address.lineNumber = db->columns [BINARY_COLUMN_LINE][row];
+	if (db->columns [BINARY_COLUMN_PATTERN][row])
+		entry->address.pattern = binaryString (db, BINARY_COLUMN_PATTERN, row);
+	else
+	{
+		sprintf (db->lineNumber, "%lu", entry->address.lineNumber);
+		entry->address.pattern = db->lineNumber;
+	}
+	entry->kind = db->strings [kind [2]];
+	entry->fileScope = (db->columns [BINARY_COLUMN_FLAGS][row] & 0x1)? 1: 0;
 
-	if (file->program.author != NULL)
-		free (file->program.author);
-	if (file->program.name != NULL)
-		free (file->program.name);
-	if (file->program.url != NULL)
-		free (file->program.url);
-	if (file->program.version != NULL)
-		free (file->program.version);
-	if (file->search.name != NULL)
-		free (file->search.name);
+	if (language [0] != '\0')
+	{
+		db->fields [n].key = "language";
+		db->fields [n++].value = language;
+	}
+	if (scope)
+	{
+		db->fields [n].key = db->strings [db->scopes.values [2 * scope]];
+		db->fields [n++].value = db->strings [db->scopes.values [2 * scope + 1]];
+	}
+	if (end)
+	{
+		sprintf (db->endLine, "%lu", end);
+		db->fields [n].key = "end";
+		db->fields [n++].value = db->endLine;
+	}
+	entry->fields.count = n;
+	entry->fields.list = n? db->fields: NULL;
+}
 
-	memset (file, 0, sizeof (tagFile));
+static int binaryNameComparison (tagFile *const file, unsigned long row)
+{
+	if (file->search.byFile)
+	{
+		const binaryDb *const db = file->binary;
+		return compareSearchFile (file,
+					db->strings [db->files.values [db->columns [BINARY_COLUMN_FILE][row]]], 0);
+	}
+	if (file->search.substring)
+		return ! containsSearchName (file,
+					binaryString (file->binary, BINARY_COLUMN_NAME, row), 0);
 
-	free (file);
+	const char *s1 = file->search.name;
+	const char *s2 = binaryString (file->binary, BINARY_COLUMN_NAME, row);
+	size_t n = file->search.partial? file->search.nameLength: (size_t) -1;
+	int c1, c2;
+
+	if (n == 0)
+		return 0;
+	do
+	{
+		c1 = (unsigned char) *s1++;
+		c2 = (unsigned char) *s2++;
+		if (file->search.ignorecase)
+		{
+			c1 = toupper (c1);
+			c2 = toupper (c2);
+		}
+	} while (c1 == c2  &&  --n > 0  &&  c1 != '\0');
+	return c1 - c2;
 }
 
-static tagResult readNext (tagFile *const file, tagEntry *const entry)
+static tagResult readBinaryNext (tagFile *const file, tagEntry *const entry)
 {
-	tagResult result;
+	binaryDb *db = file->binary;
 
-	if (file == NULL)
+	if (db->row >= db->rowCount)
 		return TagFailure;
+	if (entry != NULL)
+		fillBinaryEntry (file, entry, db->row);
+	db->row++;
+	return TagSuccess;
+}
 
-	if (! file->initialized)
+static tagResult findBinaryDbSequential (tagFile *const file, tagEntry *const entry)
+{
+	binaryDb *db = file->binary;
+
+	for (; db->row < db->rowCount; db->row++)
 	{
-		file->err = TagErrnoInvalidArgument;
-		return TagFailure;
+		if (binaryNameComparison (file, db->row) == 0)
+			return readBinaryNext (file, entry);
 	}
+	return TagFailure;
+}
 
-	if (! readTagLine (file, &file->err))
-		return TagFailure;
+static tagResult findBinaryDb (tagFile *const file, tagEntry *const entry,
+							   int sorted)
+{
+	binaryDb *db = file->binary;
+	unsigned long lower = 0;
+	unsigned long upper = db->rowCount;
 
-	result = (entry != NULL)
-		? parseTagLine (file, entry, &file->err)
-		: TagSuccess;
+	if (! sorted)
+	{
+		db->row = 0;
+		return findBinaryDbSequential (file, entry);
+	}
 
-	return result;
+	/* The first row not less than the name */
+	while (lower < upper)
+	{
+		unsigned long middle = lower + (upper - lower) / 2;
+
+		if (binaryNameComparison (file, middle) > 0)
+			lower = middle + 1;
+		else
+			upper = middle;
+	}
+	db->row = lower;
+	if (lower < db->rowCount && binaryNameComparison (file, lower) == 0)
+		return readBinaryNext (file, entry);
+
+	db->row = db->rowCount;
+	return TagFailure;
 }
 
-static const char *readFieldValue (
-	const tagEntry *const entry, const char *const key)
+static tagResult findBinaryDbNext (tagFile *const file, tagEntry *const entry,
+								   int sorted)
 {
-	const char *result = NULL;
-	int i;
-	if (strcmp (key, "kind") == 0)
-		result = entry->kind;
-	else if (strcmp (key, "file") == 0)
-		result = EmptyString;
-	else for (i = 0  ;  i < entry->fields.count  &&  result == NULL  ;  ++i)
-		if (strcmp (entry->fields.list [i].key, key) == 0)
-			result = entry->fields.list [i].value;
-	return result;
+	binaryDb *db = file->binary;
+
+	if (! sorted)
+		return findBinaryDbSequential (file, entry);
+
+	if (db->row < db->rowCount && binaryNameComparison (file, db->row) == 0)
+		return readBinaryNext (file, entry);
+
+	db->row = db->rowCount;
+	return TagFailure;
 }
 
-static int readTagLineSeek (tagFile *const file, const rt_off_t pos)
+#ifdef HAVE_ZLIB
+#define GZIP_HEADER_SIZE 24   /* with the extra field written by ctags */
+#define GZIP_TRAILER_SIZE 8
+
+static unsigned long getLE32 (const unsigned char *p)
+{
+	return (unsigned long) p [0]
+		| ((unsigned long) p [1] << 8)
+		| ((unsigned long) p [2] << 16)
+		| ((unsigned long) p [3] << 24);
+}
+
+static void deleteGzipReader (gzipReader *r)
+{
+	inflateEnd (&r->z);
+	free (r->members);
+	free (r->data);
+	free (r->buf);
+	free (r);
+}
+
+# if defined(__GLIBC__)
+/* Walk the headers of the members. Return 0 if the file is not made
+ * of the members written by ctags. */
+static int loadGzipMembers (gzipReader *r)
 {
-	if (readtags_fseek (file->fp, pos, SEEK_SET) < 0)
+	static const unsigned char expected [] = {
+		0x1f, 0x8b, 8, 4, 0, 0, 0, 0, 0, 255, 12, 0, 'C', 'T', 8, 0
+	};
+	rt_off_t offset = 0;
+	size_t allocated = 0;
+
+	while (1)
 	{
-		file->err = errno;
-		return 0;
+		unsigned char header [GZIP_HEADER_SIZE];
+		size_t n;
+		gzipMember *m;
+
+		if (readtags_fseek (r->fp, offset, SEEK_SET) == -1)
+			return 0;
+		n = fread (header, 1, sizeof (header), r->fp);
+		if (n == 0 && feof (r->fp))
+			break;
+		if (n != sizeof (header)
+			|| memcmp (header + 2, expected + 2, sizeof (expected) - 2 - 6) != 0
+			|| memcmp (header + 10, expected + 10, 6) != 0)
+			return 0;
+
+		if (r->count == allocated)
+		{
+			gzipMember *members;
+
+			allocated = allocated? allocated * 2: 64;
+			members = (gzipMember*) realloc (r->members, allocated * sizeof (gzipMember));
+			if (members == NULL)
+				return 0;
+			r->members = members;
+		}
+		m = r->members + r->count++;
+		m->offset = offset;
+		m->size = getLE32 (header + 16);
+		m->start = r->size;
+		m->length = getLE32 (header + 20);
+		if (m->size < GZIP_HEADER_SIZE + GZIP_TRAILER_SIZE)
+			return 0;
+
+		offset += m->size;
+		r->size += m->length;
 	}
+	return r->count > 0;
+}
 
-	/* read probable partial line */
-	if (!readTagLine (file, &file->err))
+static int loadGzipMember (gzipReader *r, size_t i)
+{
+	const gzipMember *m = r->members + i;
+	const size_t size = m->size - GZIP_HEADER_SIZE;
+
+	if (r->cached == i)
+		return 1;
+	r->cached = r->count;
+
+	if (r->bufSize < size)
+	{
+		unsigned char *buf = (unsigned char*) realloc (r->buf, size);
+		if (buf == NULL)
+			return 0;
+		r->buf = buf;
+		r->bufSize = size;
+	}
+	if (r->dataSize < m->length)
+	{
+		unsigned char *data = (unsigned char*) realloc (r->data, m->length);
+		if (data == NULL)
+			return 0;
+		r->data = data;
+		r->dataSize = m->length;
+	}
+
+	if (readtags_fseek (r->fp, m->offset + GZIP_HEADER_SIZE, SEEK_SET) == -1
+		|| fread (r->buf, 1, size, r->fp) != size)
 		return 0;
 
-	/* read complete line */
-	if (pos > 0)
-		return readTagLine (file, &file->err);
+	if (inflateReset (&r->z) != Z_OK)
+		return 0;
+	r->z.next_in = r->buf;
+	r->z.avail_in = (uInt) (size - GZIP_TRAILER_SIZE);
+	r->z.next_out = r->data;
+	r->z.avail_out = (uInt) m->length;
+	if (inflate (&r->z, Z_FINISH) != Z_STREAM_END
+		|| r->z.total_out != m->length
+		|| crc32 (0L, r->data, (uInt) m->length)
+		   != getLE32 (r->buf + size - GZIP_TRAILER_SIZE))
+		return 0;
 
+	r->cached = i;
 	return 1;
 }
 
-static int nameComparison (tagFile *const file)
+static ssize_t readGzipCookie (void *cookie, char *out, size_t n)
+{
+	gzipReader *r = (gzipReader*) cookie;
+	ssize_t total = 0;
+
+	while (n > 0 && r->pos < r->size)
+	{
+		size_t lower = 0;
+		size_t upper = r->count;
+		const gzipMember *m;
+		size_t offset;
+		size_t length;
+
+		/* Find the last member starting at or before pos. */
+		while (upper - lower > 1)
+		{
+			const size_t middle = lower + (upper - lower) / 2;
+			if (r->members [middle].start <= r->pos)
+				lower = middle;
+			else
+				upper = middle;
+		}
+		while (r->pos >= r->members [lower].start
+			   + (rt_off_t) r->members [lower].length)
+			lower++;
+
+		if (! loadGzipMember (r, lower))
+		{
+			errno = EIO;
+			return -1;
+		}
+		m = r->members + lower;
+		offset = (size_t) (r->pos - m->start);
+		length = m->length - offset;
+		if (length > n)
+			length = n;
+		memcpy (out, r->data + offset, length);
+		out += length;
+		n -= length;
+		r->pos += length;
+		total += length;
+	}
+	return total;
+}
+
+static int seekGzipCookie (void *cookie, off64_t *offset, int whence)
+{
+	gzipReader *r = (gzipReader*) cookie;
+	rt_off_t pos;
+
+	switch (whence)
+	{
+	case SEEK_SET:
+		pos = *offset;
+		break;
+	case SEEK_CUR:
+		pos = r->pos + *offset;
+		break;
+	case SEEK_END:
+		pos = r->size + *offset;
+		break;
+	default:
+		errno = EINVAL;
+		return -1;
+	}
+	if (pos < 0)
+	{
+		errno = EINVAL;
+		return -1;
+	}
+	r->pos = pos;
+	*offset = pos;
+	return 0;
+}
+
+static int closeGzipCookie (void *cookie)
+{
+	gzipReader *r = (gzipReader*) cookie;
+	int result = fclose (r->fp);
+
+	deleteGzipReader (r);
+	return result;
+}
+# endif
+
+/* Decompress the whole file to a temporary file. This is used for
+ * a file compressed by the other tools. */
+static FILE *decompressToTemporaryFile (const char *const filePath, int *err)
+{
+	gzFile gz = gzopen (filePath, "rb");
+	FILE *tmp;
+	char buf [BUFSIZ];
+	int n;
+
+	if (gz == NULL)
+	{
+		*err = errno? errno: ENOMEM;
+		return NULL;
+	}
+	tmp = tmpfile ();
+	if (tmp == NULL)
+	{
+		*err = errno;
+		gzclose (gz);
+		return NULL;
+	}
+	while ((n = gzread (gz, buf, sizeof (buf))) > 0)
+	{
+		if (fwrite (buf, 1, (size_t) n, tmp) != (size_t) n)
+		{
+			n = -1;
+			break;
+		}
+	}
+	gzclose (gz);
+	if (n < 0 || readtags_fseek (tmp, 0, SEEK_SET) == -1)
+	{
+		*err = errno? errno: EIO;
+		fclose (tmp);
+		return NULL;
+	}
+	return tmp;
+}
+
+/* Return a stream reading the decompressed content of the gzip file FP.
+ * FP is closed if it is not used by the stream. */
+static FILE *openCompressed (FILE *fp, const char *const filePath, int *err)
+{
+# if defined(__GLIBC__)
+	gzipReader *r = (gzipReader*) calloc (1, sizeof (gzipReader));
+
+	if (r && inflateInit2 (&r->z, -MAX_WBITS) == Z_OK)
+	{
+		r->fp = fp;
+		if (loadGzipMembers (r))
+		{
+			cookie_io_functions_t io = {
+				.read = readGzipCookie,
+				.write = NULL,
+				.seek = seekGzipCookie,
+				.close = closeGzipCookie,
+			};
+			FILE *stream;
+
+			r->cached = r->count;
+			stream = fopencookie (r, "rb", io);
+			if (stream)
+				return stream;
+		}
+		deleteGzipReader (r);
+	}
+	else
+		free (r);
+# endif
+
+	fclose (fp);
+	return decompressToTemporaryFile (filePath, err);
+}
+
+static int isCompressed (FILE *fp)
+{
+	unsigned char magic [2];
+	int r = (fread (magic, 1, 2, fp) == 2
+			 && magic [0] == 0x1f && magic [1] == 0x8b);
+
+	rewind (fp);
+	return r;
+}
+#endif
+
+static void deleteNameIndex (nameIndex *idx)
+{
+	free (idx->data);
+	free (idx->entries);
+	free (idx);
+}
+
+/* Make a path given relative to the directory of the tag file usable
+ * from the current directory. */
+static tagResult resolvePath (char **const relative, const char *const filePath)
+{
+	const char *base = NULL;
+	const char *p;
+	char *path;
+	size_t dirLength;
+
+	if (*relative == NULL || (*relative) [0] == '/')
+		return TagSuccess;
+
+	for (p = filePath; *p != '\0'; ++p)
+		if (*p == '/' || *p == '\\')
+			base = p + 1;
+	if (base == NULL)
+		return TagSuccess;
+
+	dirLength = base - filePath;
+	path = (char*) malloc (dirLength + strlen (*relative) + 1);
+	if (path == NULL)
+		return TagFailure;
+	memcpy (path, filePath, dirLength);
+	strcpy (path + dirLength, *relative);
+	free (*relative);
+	*relative = path;
+	return TagSuccess;
+}
+
+static void deleteShards (tagFile *const file)
+{
+	unsigned int i;
+
+	for (i = 0; i < file->shards.count; ++i)
+	{
+		if (file->shards.files && file->shards.files [i])
+			tagsClose (file->shards.files [i]);
+		free (file->shards.paths [i]);
+	}
+	free (file->shards.files);
+	free (file->shards.paths);
+}
+
+static tagFile *initialize (const char *const filePath, tagFileInfo *const info);
+
+static tagResult openShards (tagFile *const file, const char *const filePath,
+							 tagFileInfo *const info)
+{
+	unsigned int i;
+
+	if (file->shards.count == 0)
+		return TagSuccess;
+
+	file->shards.files = (tagFile**) calloc (file->shards.count, sizeof (tagFile*));
+	if (file->shards.files == NULL)
+	{
+		info->status.error_number = ENOMEM;
+		return TagFailure;
+	}
+
+	for (i = 0; i < file->shards.count; ++i)
+	{
+		tagFileInfo shardInfo;
+
+		if (resolvePath (&file->shards.paths [i], filePath) != TagSuccess)
+		{
+			info->status.error_number = ENOMEM;
+			return TagFailure;
+		}
+		file->shards.files [i] = initialize (file->shards.paths [i], &shardInfo);
+		if (file->shards.files [i] == NULL)
+		{
+			info->status.error_number = shardInfo.status.error_number;
+			return TagFailure;
+		}
+	}
+	return TagSuccess;
+}
+
+/* Return NULL if the index cannot be read or is broken. */
+static nameIndex *loadNameIndex (const char *const path)
+{
+	FILE *fp = fopen (path, "rb");
+	nameIndex *idx = NULL;
+	long length;
+	size_t lines = 0;
+	char *p;
+	char *end;
+	int version;
+	long long size;
+	int sort;
+
+	if (fp == NULL)
+		return NULL;
+
+	idx = (nameIndex*) calloc (1, sizeof (nameIndex));
+	if (idx == NULL)
+		goto broken;
+	if (fseek (fp, 0, SEEK_END) == -1 || (length = ftell (fp)) < 0
+		|| fseek (fp, 0, SEEK_SET) == -1)
+		goto broken;
+	idx->data = (char*) malloc ((size_t) length + 1);
+	if (idx->data == NULL
+		|| fread (idx->data, 1, (size_t) length, fp) != (size_t) length)
+		goto broken;
+	idx->data [length] = '\0';
+	fclose (fp);
+	fp = NULL;
+
+	if (strncmp (idx->data, NameIndexMagic, strlen (NameIndexMagic)) != 0)
+		goto broken;
+	p = idx->data + strlen (NameIndexMagic);
+	if (sscanf (p, "%d\t%lld\t%d", &version, &size, &sort) != 3
+		|| version != 1)
+		goto broken;
+	idx->size = (rt_off_t) size;
+	idx->sortMethod = (tagSortType) sort;
+
+	p = strchr (p, '\n');
+	if (p == NULL)
+		goto broken;
+	++p;
+	for (end = p; *end != '\0'; ++end)
+		if (*end == '\n')
+			++lines;
+	if (lines == 0)
+		goto broken;
+
+	idx->entries = (nameIndexEntry*) malloc (lines * sizeof (nameIndexEntry));
+	if (idx->entries == NULL)
+		goto broken;
+	while (*p != '\0')
+	{
+		char *tab;
+		char *newline = strchr (p, '\n');
+
+		if (newline == NULL)
+			goto broken;
+		*newline = '\0';
+		tab = strchr (p, '\t');
+		if (tab == NULL)
+			goto broken;
+		*tab = '\0';
+		idx->entries [idx->count].offset = (rt_off_t) strtoll (p, NULL, 10);
+		idx->entries [idx->count].name = tab + 1;
+		idx->count++;
+		p = newline + 1;
+	}
+	return idx;
+
+ broken:
+	if (fp)
+		fclose (fp);
+	if (idx)
+		deleteNameIndex (idx);
+	return NULL;
+}
+
+static void deleteTrigramIndex (trigramIndex *idx)
+{
+	free (idx->data);
+	free (idx->offsets);
+	free (idx->entries);
+	free (idx);
+}
+
+/* Return NULL if the index cannot be read or is broken. See
+ * main/trigramindex.c of Universal Ctags for the layout. */
+static trigramIndex *loadTrigramIndex (const char *const path)
+{
+	FILE *fp = fopen (path, "rb");
+	trigramIndex *idx = NULL;
+	long length;
+	const unsigned char *newline;
+	const unsigned char *postings;
+	binaryCursor c;
+	int version;
+	long long size;
+	unsigned long lines;
+	unsigned long count;
+	unsigned long i;
+	unsigned long n;
+	unsigned long trigram = 0;
+	rt_off_t offset = 0;
+
+	if (fp == NULL)
+		return NULL;
+
+	idx = (trigramIndex*) calloc (1, sizeof (trigramIndex));
+	if (idx == NULL)
+		goto broken;
+	if (fseek (fp, 0, SEEK_END) == -1 || (length = ftell (fp)) < 0
+		|| fseek (fp, 0, SEEK_SET) == -1)
+		goto broken;
+	idx->data = (unsigned char*) malloc ((size_t) length + 1);
+	if (idx->data == NULL
+		|| fread (idx->data, 1, (size_t) length, fp) != (size_t) length)
+		goto broken;
+	idx->data [length] = '\0';
+	fclose (fp);
+	fp = NULL;
+
+	if (strncmp ((char*) idx->data, TrigramIndexMagic, strlen (TrigramIndexMagic)) != 0
+		|| sscanf ((char*) idx->data + strlen (TrigramIndexMagic), "%d\t%lld\t%lu\t%lu",
+				   &version, &size, &lines, &count) != 4
+		|| version != 1)
+		goto broken;
+	newline = memchr (idx->data, '\n', (size_t) length);
+	if (newline == NULL)
+		goto broken;
+	c.p = newline + 1;
+	c.end = idx->data + length;
+	idx->size = (rt_off_t) size;
+
+	/* Each number takes a byte at least. */
+	if (lines > (unsigned long) (c.end - c.p)
+		|| count > (unsigned long) (c.end - c.p) / 3)
+		goto broken;
+
+	idx->offsets = (rt_off_t*) malloc ((lines? lines: 1) * sizeof (rt_off_t));
+	if (idx->offsets == NULL)
+		goto broken;
+	for (i = 0; i < lines; ++i)
+	{
+		if (! readVarint (&c, &n) || (i > 0 && n == 0))
+			goto broken;
+		offset += (rt_off_t) n;
+		if (offset >= idx->size)
+			goto broken;
+		idx->offsets [i] = offset;
+	}
+	idx->lines = lines;
+
+	idx->entries = (trigramIndexEntry*) malloc ((count? count: 1) * sizeof (trigramIndexEntry));
+	if (idx->entries == NULL)
+		goto broken;
+	for (i = 0; i < count; ++i)
+	{
+		trigramIndexEntry *const e = idx->entries + i;
+
+		if (! readVarint (&c, &n) || (i > 0 && n == 0))
+			goto broken;
+		trigram += n;
+		if (trigram > 0xffffff
+			|| ! readVarint (&c, &e->count) || e->count == 0
+			|| ! readVarint (&c, &n))
+			goto broken;
+		e->trigram = trigram;
+		e->length = (size_t) n;
+	}
+	postings = c.p;
+	for (i = 0; i < count; ++i)
+	{
+		trigramIndexEntry *const e = idx->entries + i;
+
+		if (e->length > (size_t) (c.end - postings))
+			goto broken;
+		e->postings = postings;
+		postings += e->length;
+	}
+	idx->count = count;
+	return idx;
+
+ broken:
+	if (fp)
+		fclose (fp);
+	if (idx)
+		deleteTrigramIndex (idx);
+	return NULL;
+}
+
+static void deleteFileIndex (fileIndex *idx)
+{
+	free (idx->data);
+	free (idx->entries);
+	free (idx);
+}
+
+/* Return NULL if the index cannot be read or is broken. See
+ * main/fileindex.c of Universal Ctags for the layout. */
+static fileIndex *loadFileIndex (const char *const path)
+{
+	FILE *fp = fopen (path, "rb");
+	fileIndex *idx = NULL;
+	long length;
+	const unsigned char *newline;
+	const unsigned char *postings;
+	binaryCursor c;
+	int version;
+	long long size;
+	unsigned long count;
+	unsigned long i;
+	unsigned long n;
+
+	if (fp == NULL)
+		return NULL;
+
+	idx = (fileIndex*) calloc (1, sizeof (fileIndex));
+	if (idx == NULL)
+		goto broken;
+	if (fseek (fp, 0, SEEK_END) == -1 || (length = ftell (fp)) < 0
+		|| fseek (fp, 0, SEEK_SET) == -1)
+		goto broken;
+	idx->data = (unsigned char*) malloc ((size_t) length + 1);
+	if (idx->data == NULL
+		|| fread (idx->data, 1, (size_t) length, fp) != (size_t) length)
+		goto broken;
+	idx->data [length] = '\0';
+	fclose (fp);
+	fp = NULL;
+
+	if (strncmp ((char*) idx->data, FileIndexMagic, strlen (FileIndexMagic)) != 0
+		|| sscanf ((char*) idx->data + strlen (FileIndexMagic), "%d\t%lld\t%lu",
+				   &version, &size, &count) != 3
+		|| version != 1)
+		goto broken;
+	newline = memchr (idx->data, '\n', (size_t) length);
+	if (newline == NULL)
+		goto broken;
+	c.p = newline + 1;
+	c.end = idx->data + length;
+	idx->size = (rt_off_t) size;
+
+	/* Each entry takes four bytes at least. */
+	if (count > (unsigned long) (c.end - c.p) / 4)
+		goto broken;
+
+	idx->entries = (fileIndexEntry*) malloc ((count? count: 1) * sizeof (fileIndexEntry));
+	if (idx->entries == NULL)
+		goto broken;
+	for (i = 0; i < count; ++i)
+	{
+		fileIndexEntry *const e = idx->entries + i;
+
+		if (! readVarint (&c, &n) || n > (unsigned long) (c.end - c.p))
+			goto broken;
+		e->name = (const char *) c.p;
+		e->nameLength = (size_t) n;
+		c.p += n;
+		if (! readVarint (&c, &e->count) || e->count == 0
+			|| ! readVarint (&c, &n))
+			goto broken;
+		e->length = (size_t) n;
+	}
+	postings = c.p;
+	for (i = 0; i < count; ++i)
+	{
+		fileIndexEntry *const e = idx->entries + i;
+
+		if (e->length > (size_t) (c.end - postings))
+			goto broken;
+		e->postings = postings;
+		postings += e->length;
+	}
+	idx->count = count;
+	return idx;
+
+ broken:
+	if (fp)
+		fclose (fp);
+	if (idx)
+		deleteFileIndex (idx);
+	return NULL;
+}
+
+static tagFile *initialize (const char *const filePath, tagFileInfo *const info)
+{
+	tagFile *result = (tagFile*) calloc ((size_t) 1, sizeof (tagFile));
+	int err = 0;
+
+	if (result == NULL)
+	{
+		info->status.opened = 0;
+		info->status.error_number = ENOMEM;
+		return NULL;
+	}
+
+	if (growString (&result->line) != TagSuccess)
+		goto mem_error;
+	if (growString (&result->name) != TagSuccess)
+		goto mem_error;
+	result->fields.max = 20;
+	result->fields.list = (tagExtensionField*) calloc (
+		result->fields.max, sizeof (tagExtensionField));
+	if (result->fields.list == NULL)
+		goto mem_error;
+	result->path = strdup (filePath);
+	if (result->path == NULL)
+		goto mem_error;
+
+#if defined(__GLIBC__) && (__GLIBC__ >= 2) \
+	&& defined(__GLIBC_MINOR__) && (__GLIBC_MINOR__ >= 3)
+	result->fp = fopen (filePath, "rbm");
+#endif
+	if (result->fp == NULL)
+	{
+		errno = 0;
+		result->fp = fopen (filePath, "rb");
+	}
+	if (result->fp == NULL)
+	{
+		info->status.error_number = errno;
+		goto file_error;
+	}
+
+#ifdef HAVE_ZLIB
+	if (isCompressed (result->fp))
+	{
+		result->fp = openCompressed (result->fp, filePath,
+									 &info->status.error_number);
+		if (result->fp == NULL)
+			goto file_error;
+	}
+#endif
+	mapTagFile (result);
+
+	/* Record the size of the tags file to `size` field of result. */
+	if (seekTagFile (result, 0, SEEK_END) == -1)
+	{
+		info->status.error_number = errno;
+		goto file_error;
+	}
+	result->size = tellTagFile (result);
+	if (result->size == -1)
+	{
+		/* fseek() retruns an int value.
+		 * We observed following behavior on Windows;
+		 * if sizeof(int) of the platform is too small for
+		 * representing the size of the tags file, fseek()
+		 * returns -1 and it doesn't set errno.
+		 */
+		info->status.error_number = errno;
+		if (info->status.error_number == 0)
+			info->status.error_number = TagErrnoFileMaybeTooBig;
+
+		goto file_error;
+	}
+	if (seekTagFile (result, 0, SEEK_SET) == -1)
+	{
+		info->status.error_number = errno;
+		goto file_error;
+	}
+
+	if (readTagLine (result, &err)
+		&& isBinaryDbLine (result->line.buffer))
+	{
+		if (loadBinaryDb (result, info) == TagFailure)
+			goto file_error;
+	}
+	else if (err)
+	{
+		info->status.error_number = err;
+		goto file_error;
+	}
+	else if (seekTagFile (result, 0, SEEK_SET) == -1)
+	{
+		info->status.error_number = errno;
+		goto file_error;
+	}
+	else if (readPseudoTags (result, info) == TagFailure)
+		goto file_error;
+	else if (resolvePath (&result->nameIndex.path, filePath) == TagFailure)
+		goto mem_error;
+	else if (resolvePath (&result->trigramIndex.path, filePath) == TagFailure)
+		goto mem_error;
+	else if (resolvePath (&result->fileIndex.path, filePath) == TagFailure)
+		goto mem_error;
+	else if (openShards (result, filePath, info) == TagFailure)
+		goto file_error;
+
+	info->status.opened = 1;
+	result->initialized = 1;
+
+	return result;
+ mem_error:
+	info->status.error_number = ENOMEM;
+ file_error:
+	free (result->line.buffer);
+	free (result->name.buffer);
+	free (result->fields.list);
+	free (result->path);
+	free (result->nameIndex.path);
+	free (result->trigramIndex.path);
+	free (result->fileIndex.path);
+	deleteShards (result);
+	unmapTagFile (result);
+	if (result->fp)
+		fclose (result->fp);
+	free (result);
+	info->status.opened = 0;
+	return NULL;
+}
+
+static void terminate (tagFile *const file)
+{
+	/* A cursor reads the mapping and the name index of its owner. */
+	if (file->owner == NULL)
+	{
+		unmapTagFile (file);
+		fclose (file->fp);
+		if (file->nameIndex.index)
+			deleteNameIndex (file->nameIndex.index);
+	}
+
+	if (file->trigramIndex.index && ! file->trigramIndex.borrowed)
+		deleteTrigramIndex (file->trigramIndex.index);
+	if (file->fileIndex.index && ! file->fileIndex.borrowed)
+		deleteFileIndex (file->fileIndex.index);
+
+	if (file->binary)
+		deleteBinaryDb (file->binary);
+	free (file->path);
+	free (file->nameIndex.path);
+	free (file->trigramIndex.path);
+	free (file->fileIndex.path);
+	deleteShards (file);
+
+	free (file->line.buffer);
+	free (file->name.buffer);
+	free (file->fields.list);
+
+	if (file->program.author != NULL)
+		free (file->program.author);
+	if (file->program.name != NULL)
+		free (file->program.name);
+	if (file->program.url != NULL)
+		free (file->program.url);
+	if (file->program.version != NULL)
+		free (file->program.version);
+	if (file->search.name != NULL)
+		free (file->search.name);
+	free (file->search.candidates);
+
+	memset (file, 0, sizeof (tagFile));
+
+	free (file);
+}
+
+/* Read the shards one after another. */
+static tagResult readShardNext (tagFile *const file, tagEntry *const entry)
+{
+	while (file->shards.current < file->shards.count)
+	{
+		tagFile *const shard = file->shards.files [file->shards.current];
+
+		if (tagsNext (shard, entry) == TagSuccess)
+			return TagSuccess;
+		if (shard->err)
+		{
+			file->err = shard->err;
+			return TagFailure;
+		}
+
+		if (++file->shards.current < file->shards.count)
+		{
+			tagFile *const next = file->shards.files [file->shards.current];
+			if (gotoFirstLogicalTag (next) != TagSuccess)
+			{
+				file->err = next->err;
+				return TagFailure;
+			}
+		}
+	}
+	return TagFailure;
+}
+
+static tagResult readNext (tagFile *const file, tagEntry *const entry)
+{
+	tagResult result;
+
+	if (file == NULL)
+		return TagFailure;
+
+	if (! file->initialized)
+	{
+		file->err = TagErrnoInvalidArgument;
+		return TagFailure;
+	}
+
+	if (file->binary)
+	{
+		if (file->range.parts > 0
+			&& (rt_off_t) file->binary->row >= file->range.end)
+			return TagFailure;
+		return readBinaryNext (file, entry);
+	}
+
+	if (file->shards.count > 0)
+		return readShardNext (file, entry);
+
+	if (! readTagLine (file, &file->err))
+		return TagFailure;
+
+	if (file->range.parts > 0 && file->pos >= file->range.end)
+		return TagFailure;
+
+	result = (entry != NULL)
+		? parseTagLine (file, entry, &file->err)
+		: TagSuccess;
+
+	return result;
+}
+
+static const char *readFieldValue (
+	const tagEntry *const entry, const char *const key)
+{
+	const char *result = NULL;
+	int i;
+	if (strcmp (key, "kind") == 0)
+		result = entry->kind;
+	else if (strcmp (key, "file") == 0)
+		result = EmptyString;
+	else for (i = 0  ;  i < entry->fields.count  &&  result == NULL  ;  ++i)
+		if (strcmp (entry->fields.list [i].key, key) == 0)
+			result = entry->fields.list [i].value;
+	return result;
+}
+
+static int readTagLineSeek (tagFile *const file, const rt_off_t pos)
+{
+	if (seekTagFile (file, pos, SEEK_SET) < 0)
+	{
+		file->err = errno;
+		return 0;
+	}
+
+	/* read probable partial line */
+	if (!readTagLine (file, &file->err))
+		return 0;
+
+	/* read complete line */
+	if (pos > 0)
+		return readTagLine (file, &file->err);
+
+	return 1;
+}
+
+static int nameComparisonWith (tagFile *const file, const char *const name)
+{
+	int result;
+	if (file->search.ignorecase)
+	{
+		if (file->search.partial)
+			result = tagnuppercmp (file->search.name, name,
+					file->search.nameLength);
+		else
+			result = taguppercmp (file->search.name, name);
+	}
+	else
+	{
+		if (file->search.partial)
+			result = tagncmp (file->search.name, name,
+					file->search.nameLength);
+		else
+			result = tagcmp (file->search.name, name);
+	}
+	return result;
+}
+
+static int nameComparison (tagFile *const file)
+{
+	return nameComparisonWith (file, file->name.buffer);
+}
+
+static tagResult findFirstNonMatchBefore (tagFile *const file)
+{
+#define JUMP_BACK 512
+	int more_lines;
+	int comp;
+	rt_off_t start = file->pos;
+	rt_off_t pos = start;
+	do
+	{
+		if (pos < (rt_off_t) JUMP_BACK)
+			pos = 0;
+		else
+			pos = pos - JUMP_BACK;
+		more_lines = readTagLineSeek (file, pos);
+		if (more_lines == 0 && file->err)
+			return TagFailure;
+		comp = nameComparison (file);
+	} while (more_lines  &&  comp == 0  &&  pos > 0  &&  pos < start);
+	return TagSuccess;
+}
+
+static tagResult findFirstMatchBefore (tagFile *const file)
+{
+	tagResult result = TagFailure;
+	int more_lines;
+	rt_off_t start = file->pos;
+	if (findFirstNonMatchBefore (file) != TagSuccess)
+		return TagFailure;
+	do
+	{
+		more_lines = readTagLine (file, &file->err);
+		if (more_lines == 0 && file->err)
+			return TagFailure;
+		if (nameComparison (file) == 0)
+			result = TagSuccess;
+	} while (more_lines  &&  result != TagSuccess  &&  file->pos < start);
+	return result;
+}
+
+/* Binary search between the lines after LOWER_LIMIT and UPPER_LIMIT. */
+static tagResult findBinaryBetween (tagFile *const file,
+									rt_off_t lower_limit, rt_off_t upper_limit)
+{
+	tagResult result = TagFailure;
+	rt_off_t last_pos = lower_limit;
+	rt_off_t pos = lower_limit + ((upper_limit - lower_limit) / 2);
+	while (result != TagSuccess)
+	{
+		if (! readTagLineSeek (file, pos))
+		{
+			if (file->err)
+				break;
+			/* in case we fell off end of file */
+			result = findFirstMatchBefore (file);
+			break;
+		}
+		else if (pos == last_pos)
+		{
+			/* prevent infinite loop if we backed up to beginning of file */
+			break;
+		}
+		else
+		{
+			const int comp = nameComparison (file);
+			last_pos = pos;
+			if (comp < 0)
+			{
+				upper_limit = pos;
+				pos = lower_limit + ((upper_limit - lower_limit) / 2);
+			}
+			else if (comp > 0)
+			{
+				lower_limit = pos;
+				pos = lower_limit + ((upper_limit - lower_limit) / 2);
+			}
+			else if (pos == 0)
+				result = TagSuccess;
+			else
+			{
+				result = findFirstMatchBefore (file);
+				if (result != TagSuccess && file->err)
+					break;
+			}
+		}
+	}
+	return result;
+}
+
+static tagResult findBinary (tagFile *const file)
+{
+	return findBinaryBetween (file, 0, file->size);
+}
+
+/* Search the lines from CURSOR, the start of a line no match is before.
+ * The distance to the match is found by doubling steps first, so a name
+ * near the cursor is found with a few probes near the cursor. */
+static tagResult findFromCursor (tagFile *const file, const rt_off_t cursor)
+{
+	/* The line read at CURSOR - 1 is the one starting at CURSOR. */
+	rt_off_t lower_limit = cursor - 1;
+	rt_off_t step = JUMP_BACK;
+	rt_off_t pos;
+
+	while ((pos = lower_limit + step) < file->size)
+	{
+		int comp;
+
+		if (! readTagLineSeek (file, pos))
+		{
+			if (file->err)
+				return TagFailure;
+			break;
+		}
+		comp = nameComparison (file);
+		if (comp == 0)
+			return findFirstMatchBefore (file);
+		else if (comp < 0)
+			return findBinaryBetween (file, lower_limit, pos);
+		lower_limit = pos;
+		step *= 2;
+	}
+	return findBinaryBetween (file, lower_limit, file->size);
+}
+
+/* Return the name index if it is usable for the current search. */
+static nameIndex *getNameIndex (tagFile *const file)
+{
+	nameIndex *idx;
+
+	if (file->nameIndex.path == NULL)
+		return NULL;
+	if (! file->nameIndex.tried)
+	{
+		file->nameIndex.index = loadNameIndex (file->nameIndex.path);
+		file->nameIndex.tried = 1;
+	}
+
+	idx = file->nameIndex.index;
+	if (idx == NULL
+		|| idx->size != file->size
+		|| idx->sortMethod != file->sortMethod)
+		return NULL;
+	return idx;
+}
+
+/* Look up the block where the name can start in the index, and read
+ * the tag lines from there. */
+static tagResult findIndexed (tagFile *const file, nameIndex *const idx)
+{
+	size_t lower = 0;
+	size_t upper = idx->count;
+	rt_off_t pos;
+
+	/* Find the first entry not less than the name. */
+	while (lower < upper)
+	{
+		const size_t middle = lower + (upper - lower) / 2;
+		if (nameComparisonWith (file, idx->entries [middle].name) > 0)
+			lower = middle + 1;
+		else
+			upper = middle;
+	}
+	pos = idx->entries [lower > 0? lower - 1: 0].offset;
+
+	if (seekTagFile (file, pos, SEEK_SET) < 0)
+	{
+		file->err = errno;
+		return TagFailure;
+	}
+	while (readTagLine (file, &file->err))
+	{
+		const int comp = nameComparison (file);
+		if (comp == 0)
+			return TagSuccess;
+		else if (comp < 0)
+			break;
+	}
+	return TagFailure;
+}
+
+static tagResult findSequentialFull (tagFile *const file,
+									 int (* isAcceptable) (tagFile *const, void *),
+									 void *data)
+{
+	if (file == NULL)
+		return TagFailure;
+
+	if (!file->initialized || file->err)
+	{
+		file->err = TagErrnoInvalidArgument;
+		return TagFailure;
+	}
+
+	tagResult result = TagFailure;
+	while (result == TagFailure)
+	{
+		if (! readTagLine (file, &file->err))
+			break;
+		if (isAcceptable (file, data))
+			result = TagSuccess;
+	}
+	return result;
+}
+
+static int nameAcceptable (tagFile *const file, void *unused)
+{
+	return (nameComparison (file) == 0);
+}
+
+static tagResult findSequential (tagFile *const file)
+{
+	return findSequentialFull (file, nameAcceptable, NULL);
+}
+
+static int substringAcceptable (tagFile *const file, void *unused)
+{
+	return (! isPseudoTagLine (file->name.buffer)
+			&& containsSearchName (file, file->name.buffer, 1));
+}
+
+/* Return the trigram index if it is usable for the tag file. */
+static trigramIndex *getTrigramIndex (tagFile *const file)
+{
+	trigramIndex *idx;
+
+	if (file->trigramIndex.path == NULL)
+		return NULL;
+	if (! file->trigramIndex.tried)
+	{
+		file->trigramIndex.index = loadTrigramIndex (file->trigramIndex.path);
+		file->trigramIndex.tried = 1;
+	}
+
+	idx = file->trigramIndex.index;
+	if (idx == NULL || idx->size != file->size)
+		return NULL;
+	return idx;
+}
+
+static unsigned long foldTrigramByte (const char c)
+{
+	const unsigned char b = (unsigned char) c;
+	return (b >= 'A' && b <= 'Z')? b - 'A' + 'a': b;
+}
+
+/* The trigram index has the bytes of names as written in the tag lines,
+ * with ASCII letters in lower case. Return 1 if the trigrams of the name
+ * searched for are found in it as they are in the names. */
+static int isTrigramSearchable (tagFile *const file)
+{
+	const char *p;
+
+	if (file->search.nameLength < 3)
+		return 0;
+	/* A leading space or exclamation mark of a name is escaped. */
+	if (file->search.name [0] == ' ' || file->search.name [0] == '!')
+		return 0;
+	for (p = file->search.name; *p != '\0'; ++p)
+	{
+		const unsigned char b = (unsigned char) *p;
+		if (b == '\\' || b < 0x20 || b == 0x7f
+			|| (file->search.ignorecase && b >= 0x80))
+			return 0;
+	}
+	return 1;
+}
+
+static int compareTrigramCounts (const void *a, const void *b)
+{
+	const trigramIndexEntry *ea = *(const trigramIndexEntry *const *) a;
+	const trigramIndexEntry *eb = *(const trigramIndexEntry *const *) b;
+
+	return (ea->count > eb->count) - (ea->count < eb->count);
+}
+
+static trigramIndexEntry *lookUpTrigram (trigramIndex *const idx,
+										 const unsigned long trigram)
+{
+	unsigned long lower = 0;
+	unsigned long upper = idx->count;
+
+	while (lower < upper)
+	{
+		const unsigned long middle = lower + (upper - lower) / 2;
+		if (idx->entries [middle].trigram < trigram)
+			lower = middle + 1;
+		else
+			upper = middle;
+	}
+	if (lower < idx->count && idx->entries [lower].trigram == trigram)
+		return idx->entries + lower;
+	return NULL;
+}
+
+/* Make the candidates of the search, the lines having all the trigrams
+ * of the name, by intersecting the postings of the trigrams from the
+ * shortest. Return TagFailure if the index is broken. */
+static tagResult findCandidates (tagFile *const file, trigramIndex *const idx)
+{
+	const char *const name = file->search.name;
+	const size_t n = file->search.nameLength - 2;
+	trigramIndexEntry **entries;
+	unsigned long *candidates = NULL;
+	unsigned long count = 0;
+	unsigned long line;
+	unsigned long delta;
+	binaryCursor c;
+	size_t i;
+
+	entries = (trigramIndexEntry**) malloc (n * sizeof (trigramIndexEntry*));
+	if (entries == NULL)
+	{
+		file->err = ENOMEM;
+		return TagFailure;
+	}
+	for (i = 0; i < n; ++i)
+	{
+		const unsigned long trigram = (foldTrigramByte (name [i]) << 16)
+			| (foldTrigramByte (name [i + 1]) << 8)
+			| foldTrigramByte (name [i + 2]);
+
+		entries [i] = lookUpTrigram (idx, trigram);
+		if (entries [i] == NULL)
+			goto found;
+	}
+	qsort (entries, n, sizeof (trigramIndexEntry*), compareTrigramCounts);
+
+	candidates = (unsigned long*) malloc (entries [0]->count * sizeof (unsigned long));
+	if (candidates == NULL)
+	{
+		free (entries);
+		file->err = ENOMEM;
+		return TagFailure;
+	}
+	c.p = entries [0]->postings;
+	c.end = c.p + entries [0]->length;
+	for (line = 0; count < entries [0]->count; ++count)
+	{
+		if (! readVarint (&c, &delta) || (count > 0 && delta == 0))
+			goto broken;
+		line += delta;
+		if (line >= idx->lines)
+			goto broken;
+		candidates [count] = line;
+	}
+
+	for (i = 1; i < n && count > 0; ++i)
+	{
+		unsigned long left = entries [i]->count;
+		unsigned long kept = 0;
+		unsigned long k;
+		int decoded = 0;
+
+		if (entries [i] == entries [i - 1])
+			continue;
+
+		c.p = entries [i]->postings;
+		c.end = c.p + entries [i]->length;
+		line = 0;
+		for (k = 0; k < count; ++k)
+		{
+			while (! decoded || line < candidates [k])
+			{
+				if (left == 0)
+					goto intersected;
+				if (! readVarint (&c, &delta))
+					goto broken;
+				line += delta;
+				left--;
+				decoded = 1;
+			}
+			if (line == candidates [k])
+				candidates [kept++] = candidates [k];
+		}
+	intersected:
+		count = kept;
+	}
+
+ found:
+	free (entries);
+	file->search.indexed = 1;
+	file->search.candidates = candidates;
+	file->search.candidateCount = count;
+	file->search.candidate = 0;
+	return TagSuccess;
+
+ broken:
+	free (entries);
+	free (candidates);
+	return TagFailure;
+}
+
+/* Read the next of the candidates whose name contains the name. */
+static tagResult findCandidate (tagFile *const file)
+{
+	const trigramIndex *const idx = file->trigramIndex.index;
+
+	while (file->search.candidate < file->search.candidateCount)
+	{
+		const unsigned long line = file->search.candidates [file->search.candidate++];
+
+		if (seekTagFile (file, idx->offsets [line], SEEK_SET) < 0)
+		{
+			file->err = errno;
+			return TagFailure;
+		}
+		if (! readTagLine (file, &file->err))
+			return TagFailure;
+		if (substringAcceptable (file, NULL))
+			return TagSuccess;
+	}
+	return TagFailure;
+}
+
+static int fileAcceptable (tagFile *const file, void *unused)
+{
+	const char *tab;
+
+	if (isPseudoTagLine (file->name.buffer))
+		return 0;
+	tab = strchr (file->line.buffer, TAB);
+	return (tab != NULL
+			&& compareSearchFile (file, tab + 1, file->inputUCtagsMode) == 0);
+}
+
+/* Return the file index if it is usable for the tag file. */
+static fileIndex *getFileIndex (tagFile *const file)
+{
+	fileIndex *idx;
+
+	if (file->fileIndex.path == NULL)
+		return NULL;
+	if (! file->fileIndex.tried)
+	{
+		file->fileIndex.index = loadFileIndex (file->fileIndex.path);
+		file->fileIndex.tried = 1;
+	}
+
+	idx = file->fileIndex.index;
+	if (idx == NULL || idx->size != file->size)
+		return NULL;
+	return idx;
+}
+
+/* The file index has the input files as written in the tag lines.
+ * Return 1 if the name searched for is written as it is. */
+static int isFileIndexSearchable (tagFile *const file)
 {
-	int result;
+	const char *p;
+
 	if (file->search.ignorecase)
+		return 0;
+	if (! file->inputUCtagsMode)
+		return 1;
+	for (p = file->search.name; *p != '\0'; ++p)
 	{
-		if (file->search.partial)
-			result = tagnuppercmp (file->search.name, file->name.buffer,
-					file->search.nameLength);
-		else
-			result = taguppercmp (file->search.name, file->name.buffer);
-	}
-	else
-	{
-		if (file->search.partial)
-			result = tagncmp (file->search.name, file->name.buffer,
-					file->search.nameLength);
-		else
-			result = tagcmp (file->search.name, file->name.buffer);
+		const unsigned char b = (unsigned char) *p;
+		if (b == '\\' || b < 0x20 || b == 0x7f)
+			return 0;
 	}
-	return result;
+	return 1;
 }
 
-static tagResult findFirstNonMatchBefore (tagFile *const file)
+static fileIndexEntry *lookUpFile (fileIndex *const idx,
+								   const char *const name, const size_t length)
 {
-#define JUMP_BACK 512
-	int more_lines;
-	int comp;
-	rt_off_t start = file->pos;
-	rt_off_t pos = start;
-	do
+	unsigned long lower = 0;
+	unsigned long upper = idx->count;
+
+	while (lower < upper)
 	{
-		if (pos < (rt_off_t) JUMP_BACK)
-			pos = 0;
+		const unsigned long middle = lower + (upper - lower) / 2;
+		const fileIndexEntry *const e = idx->entries + middle;
+		const size_t n = (e->nameLength < length)? e->nameLength: length;
+		int comp = memcmp (e->name, name, n);
+
+		if (comp == 0)
+			comp = (e->nameLength > length) - (e->nameLength < length);
+		if (comp == 0)
+			return idx->entries + middle;
+		else if (comp < 0)
+			lower = middle + 1;
 		else
-			pos = pos - JUMP_BACK;
-		more_lines = readTagLineSeek (file, pos);
-		if (more_lines == 0 && file->err)
-			return TagFailure;
-		comp = nameComparison (file);
-	} while (more_lines  &&  comp == 0  &&  pos > 0  &&  pos < start);
-	return TagSuccess;
+			upper = middle;
+	}
+	return NULL;
 }
 
-static tagResult findFirstMatchBefore (tagFile *const file)
+/* Start reading the postings of the input file searched for. */
+static void startFilePostings (tagFile *const file, fileIndex *const idx)
 {
-	tagResult result = TagFailure;
-	int more_lines;
-	rt_off_t start = file->pos;
-	if (findFirstNonMatchBefore (file) != TagSuccess)
-		return TagFailure;
-	do
-	{
-		more_lines = readTagLine (file, &file->err);
-		if (more_lines == 0 && file->err)
-			return TagFailure;
-		if (nameComparison (file) == 0)
-			result = TagSuccess;
-	} while (more_lines  &&  result != TagSuccess  &&  file->pos < start);
-	return result;
+	const fileIndexEntry *const e = lookUpFile (idx, file->search.name,
+												file->search.nameLength);
+
+	file->search.fileIndexed = 1;
+	file->search.postings = e? e->postings: NULL;
+	file->search.postingsEnd = e? e->postings + e->length: NULL;
+	file->search.postingsLeft = e? e->count: 0;
+	file->search.postingOffset = 0;
 }
 
-static tagResult findBinary (tagFile *const file)
+/* Read the next line in the postings of the input file. The postings
+ * are decoded one by one; the lines are verified against the name. */
+static tagResult findFileLine (tagFile *const file)
 {
-	tagResult result = TagFailure;
-	rt_off_t lower_limit = 0;
-	rt_off_t upper_limit = file->size;
-	rt_off_t last_pos = 0;
-	rt_off_t pos = upper_limit / 2;
-	while (result != TagSuccess)
+	while (file->search.postingsLeft > 0)
 	{
-		if (! readTagLineSeek (file, pos))
-		{
-			if (file->err)
-				break;
-			/* in case we fell off end of file */
-			result = findFirstMatchBefore (file);
+		binaryCursor c;
+		unsigned long delta;
+
+		c.p = file->search.postings;
+		c.end = file->search.postingsEnd;
+		if (! readVarint (&c, &delta))
 			break;
-		}
-		else if (pos == last_pos)
-		{
-			/* prevent infinite loop if we backed up to beginning of file */
+		file->search.postings = c.p;
+		file->search.postingsLeft--;
+		file->search.postingOffset += (rt_off_t) delta;
+		if (file->search.postingOffset >= file->size)
 			break;
-		}
-		else
+
+		if (seekTagFile (file, file->search.postingOffset, SEEK_SET) < 0)
 		{
-			const int comp = nameComparison (file);
-			last_pos = pos;
-			if (comp < 0)
-			{
-				upper_limit = pos;
-				pos = lower_limit + ((upper_limit - lower_limit) / 2);
-			}
-			else if (comp > 0)
-			{
-				lower_limit = pos;
-				pos = lower_limit + ((upper_limit - lower_limit) / 2);
-			}
-			else if (pos == 0)
-				result = TagSuccess;
-			else
-			{
-				result = findFirstMatchBefore (file);
-				if (result != TagSuccess && file->err)
-					break;
-			}
+			file->err = errno;
+			return TagFailure;
 		}
+		if (! readTagLine (file, &file->err))
+			return TagFailure;
+		if (fileAcceptable (file, NULL))
+			return TagSuccess;
 	}
-	return result;
+	file->search.postingsLeft = 0;
+	return TagFailure;
 }
 
-static tagResult findSequentialFull (tagFile *const file,
-									 int (* isAcceptable) (tagFile *const, void *),
-									 void *data)
+/* Find the name in the shards from START. */
+static tagResult findShards (tagFile *const file, tagEntry *const entry,
+							 unsigned int start)
 {
-	if (file == NULL)
-		return TagFailure;
-
-	if (!file->initialized || file->err)
+	const int options = (file->search.partial? TAG_PARTIALMATCH: 0)
+		| (file->search.ignorecase? TAG_IGNORECASE: 0)
+		| (file->search.substring? TAG_SUBSTRINGMATCH: 0)
+		| (file->search.byFile? TAG_FILEMATCH: 0);
+
+	for (file->shards.current = start;
+		 file->shards.current < file->shards.count;
+		 file->shards.current++)
 	{
-		file->err = TagErrnoInvalidArgument;
-		return TagFailure;
-	}
+		tagFile *const shard = file->shards.files [file->shards.current];
 
-	tagResult result = TagFailure;
-	while (result == TagFailure)
-	{
-		if (! readTagLine (file, &file->err))
-			break;
-		if (isAcceptable (file, data))
-			result = TagSuccess;
+		if (tagsFind (shard, entry, file->search.name, options) == TagSuccess)
+			return TagSuccess;
+		if (shard->err)
+		{
+			file->err = shard->err;
+			return TagFailure;
+		}
 	}
-	return result;
+	return TagFailure;
 }
 
-static int nameAcceptable (tagFile *const file, void *unused)
+static tagResult findShardsNext (tagFile *const file, tagEntry *const entry)
 {
-	return (nameComparison (file) == 0);
+	tagFile *shard;
+
+	if (file->shards.current >= file->shards.count)
+		return TagFailure;
+
+	shard = file->shards.files [file->shards.current];
+	if (tagsFindNext (shard, entry) == TagSuccess)
+		return TagSuccess;
+	if (shard->err)
+	{
+		file->err = shard->err;
+		return TagFailure;
+	}
+	return findShards (file, entry, file->shards.current + 1);
 }
 
-static tagResult findSequential (tagFile *const file)
+/* Return 1 if a name not less than PREV in the sort order of the tag
+ * file has no match before any match of PREV. */
+static int isNameAfter (const char *const prev, const char *const name,
+						const int ignorecase)
 {
-	return findSequentialFull (file, nameAcceptable, NULL);
+	return (ignorecase? taguppercmp (prev, name): tagcmp (prev, name)) <= 0;
 }
 
+/* AFTER is 1 if the search may start at the cursor. */
 static tagResult find (tagFile *const file, tagEntry *const entry,
-					   const char *const name, const int options)
+					   const char *const name, const int options,
+					   const int after)
 {
 	tagResult result;
+	rt_off_t cursor = 0;
+	const rt_off_t size = file->size;
+	const short ignorecase = (options & TAG_IGNORECASE) != 0;
+
+	if (after && file->search.name != NULL
+		&& file->search.ignorecase == ignorecase
+		&& isNameAfter (file->search.name, name, ignorecase))
+		cursor = file->search.cursor;
+
 	if (file->search.name != NULL)
 		free (file->search.name);
 	file->search.name = duplicate (name);
@@ -1172,29 +3320,83 @@ static tagResult find (tagFile *const file, tagEntry *const entry,
 	}
 	file->search.nameLength = strlen (name);
 	file->search.partial = (options & TAG_PARTIALMATCH) != 0;
-	file->search.ignorecase = (options & TAG_IGNORECASE) != 0;
-	if (readtags_fseek (file->fp, 0, SEEK_END) < 0)
+	file->search.ignorecase = ignorecase;
+	file->search.substring = (options & TAG_SUBSTRINGMATCH) != 0;
+	file->search.byFile = (options & TAG_FILEMATCH) != 0;
+	file->search.cursor = 0;
+	file->search.indexed = 0;
+	file->search.fileIndexed = 0;
+	free (file->search.candidates);
+	file->search.candidates = NULL;
+	if (file->shards.count > 0)
+		return findShards (file, entry, 0);
+	if (file->binary)
+		return findBinaryDb (file, entry,
+							 !file->search.substring && !file->search.byFile &&
+							 ((file->sortMethod == TAG_SORTED      && !file->search.ignorecase) ||
+							  (file->sortMethod == TAG_FOLDSORTED  &&  file->search.ignorecase)));
+	remapTagFileIfResized (file);
+	if (seekTagFile (file, 0, SEEK_END) < 0)
 	{
 		file->err = errno;
 		return TagFailure;
 	}
-	file->size = readtags_ftell (file->fp);
+	file->size = tellTagFile (file);
 	if (file->size == -1)
 	{
 		file->err = errno;
 		return TagFailure;
 	}
-	if (readtags_fseek(file->fp, 0, SEEK_SET) == -1)
+	if (seekTagFile (file, 0, SEEK_SET) == -1)
 	{
 		file->err = errno;
 		return TagFailure;
 	}
-	if ((file->sortMethod == TAG_SORTED      && !file->search.ignorecase) ||
-		(file->sortMethod == TAG_FOLDSORTED  &&  file->search.ignorecase))
+	if (file->search.byFile)
+	{
+		fileIndex *const idx = getFileIndex (file);
+
+		if (idx && isFileIndexSearchable (file))
+		{
+			startFilePostings (file, idx);
+			result = findFileLine (file);
+		}
+		else
+			result = findSequentialFull (file, fileAcceptable, NULL);
+		if (result == TagFailure && file->err)
+			return TagFailure;
+	}
+	else if (file->search.substring)
+	{
+		trigramIndex *const idx = getTrigramIndex (file);
+
+		/* A broken index is ignored. */
+		if (idx && isTrigramSearchable (file)
+			&& findCandidates (file, idx) == TagSuccess)
+			result = findCandidate (file);
+		else if (file->err)
+			return TagFailure;
+		else
+			result = findSequentialFull (file, substringAcceptable, NULL);
+		if (result == TagFailure && file->err)
+			return TagFailure;
+	}
+	else if ((file->sortMethod == TAG_SORTED      && !file->search.ignorecase) ||
+			 (file->sortMethod == TAG_FOLDSORTED  &&  file->search.ignorecase))
 	{
-		result = findBinary (file);
+		nameIndex *const idx = getNameIndex (file);
+
+		/* The cursor is for the file of the size known then. */
+		if (file->size != size)
+			cursor = 0;
+
+		if (cursor > 0)
+			result = findFromCursor (file, cursor);
+		else
+			result = idx? findIndexed (file, idx): findBinary (file);
 		if (result == TagFailure && file->err)
 			return TagFailure;
+		file->search.cursor = (result == TagSuccess)? file->pos: cursor;
 	}
 	else
 	{
@@ -1238,10 +3440,32 @@ static tagResult findNextFull (tagFile *const file, tagEntry *const entry,
 
 static tagResult findNext (tagFile *const file, tagEntry *const entry)
 {
-	return findNextFull (file, entry,
-						 (file->sortMethod == TAG_SORTED      && !file->search.ignorecase) ||
-						 (file->sortMethod == TAG_FOLDSORTED  &&  file->search.ignorecase),
-						 nameAcceptable, NULL);
+	int sorted = !file->search.substring && !file->search.byFile &&
+		((file->sortMethod == TAG_SORTED      && !file->search.ignorecase) ||
+		 (file->sortMethod == TAG_FOLDSORTED  &&  file->search.ignorecase));
+
+	if (file->shards.count > 0)
+		return findShardsNext (file, entry);
+	if (file->binary)
+		return findBinaryDbNext (file, entry, sorted);
+	if (file->search.indexed)
+	{
+		tagResult result = findCandidate (file);
+		if (result == TagSuccess && entry != NULL)
+			result = parseTagLine (file, entry, &file->err);
+		return result;
+	}
+	if (file->search.fileIndexed)
+	{
+		tagResult result = findFileLine (file);
+		if (result == TagSuccess && entry != NULL)
+			result = parseTagLine (file, entry, &file->err);
+		return result;
+	}
+	return findNextFull (file, entry, sorted,
+						 file->search.byFile? fileAcceptable:
+						 file->search.substring? substringAcceptable: nameAcceptable,
+						 NULL);
 }
 
 static tagResult findPseudoTag (tagFile *const file, int rewindBeforeFinding, tagEntry *const entry)
@@ -1255,16 +3479,23 @@ static tagResult findPseudoTag (tagFile *const file, int rewindBeforeFinding, ta
 		return TagFailure;
 	}
 
+	/* A binary tag database has no pseudo tag. */
+	if (file->binary)
+		return TagFailure;
+
 	if (rewindBeforeFinding)
 	{
-		if (readtags_fseek(file->fp, 0, SEEK_SET) == -1)
+		if (seekTagFile (file, 0, SEEK_SET) == -1)
 		{
 			file->err = errno;
 			return TagFailure;
 		}
 	}
+	/* The pseudo tags of a manifest are read from the manifest itself,
+	 * not from its shards. */
 	return findNextFull (file, entry,
-						 (file->sortMethod == TAG_SORTED || file->sortMethod == TAG_FOLDSORTED),
+						 (file->sortMethod == TAG_SORTED || file->sortMethod == TAG_FOLDSORTED)
+						 && file->shards.count == 0,
 						 doesFilePointPseudoTag,
 						 NULL);
 }
@@ -1280,8 +3511,139 @@ extern tagFile *tagsOpen (const char *const filePath, tagFileInfo *const info)
 	return initialize (filePath, info? info: &infoDummy);
 }
 
+/* Make a cursor reading the mapping of FILE, or open the tag file again
+ * if it is not mapped. */
+static tagFile *openCursor (tagFile *const file, tagFileInfo *const info)
+{
+	tagFile *result;
+	unsigned int i;
+
+	if (file->map.data == NULL || file->binary)
+		return initialize (file->path, info);
+
+	result = (tagFile*) calloc ((size_t) 1, sizeof (tagFile));
+	if (result == NULL)
+		goto mem_error;
+
+	result->owner = file;
+	if (growString (&result->line) != TagSuccess)
+		goto mem_error;
+	if (growString (&result->name) != TagSuccess)
+		goto mem_error;
+	result->fields.max = 20;
+	result->fields.list = (tagExtensionField*) calloc (
+		result->fields.max, sizeof (tagExtensionField));
+	if (result->fields.list == NULL)
+		goto mem_error;
+	result->path = strdup (file->path);
+	if (result->path == NULL)
+		goto mem_error;
+
+	result->format = file->format;
+	result->inputUCtagsMode = file->inputUCtagsMode;
+	result->sortMethod = file->sortMethod;
+	result->size = file->size;
+
+	/* Nothing of FILE the cursor reads is changed after this. */
+	file->map.shared = 1;
+	result->map.data = file->map.data;
+	result->map.size = file->map.size;
+	getNameIndex (file);
+	if (file->nameIndex.index)
+	{
+		result->nameIndex.path = strdup (file->nameIndex.path);
+		if (result->nameIndex.path == NULL)
+			goto mem_error;
+		result->nameIndex.index = file->nameIndex.index;
+	}
+	result->nameIndex.tried = 1;
+	/* The cursor loads an index of its own if FILE has not loaded one. */
+	if (file->trigramIndex.path)
+	{
+		result->trigramIndex.path = strdup (file->trigramIndex.path);
+		if (result->trigramIndex.path == NULL)
+			goto mem_error;
+		if (file->trigramIndex.tried)
+		{
+			result->trigramIndex.index = file->trigramIndex.index;
+			result->trigramIndex.borrowed = 1;
+			result->trigramIndex.tried = 1;
+		}
+	}
+	if (file->fileIndex.path)
+	{
+		result->fileIndex.path = strdup (file->fileIndex.path);
+		if (result->fileIndex.path == NULL)
+			goto mem_error;
+		if (file->fileIndex.tried)
+		{
+			result->fileIndex.index = file->fileIndex.index;
+			result->fileIndex.borrowed = 1;
+			result->fileIndex.tried = 1;
+		}
+	}
+
+	if (file->shards.count > 0)
+	{
+		result->shards.paths = (char**) calloc (file->shards.count, sizeof (char*));
+		result->shards.files = (tagFile**) calloc (file->shards.count, sizeof (tagFile*));
+		if (result->shards.paths == NULL || result->shards.files == NULL)
+			goto mem_error;
+		result->shards.count = file->shards.count;
+		for (i = 0; i < file->shards.count; ++i)
+		{
+			tagFileInfo shardInfo;
+
+			result->shards.files [i] = openCursor (file->shards.files [i], &shardInfo);
+			if (result->shards.files [i] == NULL)
+			{
+				info->status.error_number = shardInfo.status.error_number;
+				goto error;
+			}
+		}
+	}
+
+	info->status.opened = 1;
+	info->file.format     = file->format;
+	info->file.sort       = file->sortMethod;
+	info->program.author  = file->program.author;
+	info->program.name    = file->program.name;
+	info->program.url     = file->program.url;
+	info->program.version = file->program.version;
+	result->initialized = 1;
+	return result;
+
+ mem_error:
+	info->status.error_number = ENOMEM;
+ error:
+	if (result)
+		terminate (result);
+	info->status.opened = 0;
+	return NULL;
+}
+
+extern tagFile *tagsOpenCursor (tagFile *const file, tagFileInfo *const info)
+{
+	tagFileInfo infoDummy;
+
+	if (file == NULL || !file->initialized || file->err)
+	{
+		if (file)
+			file->err = TagErrnoInvalidArgument;
+		if (info)
+		{
+			info->status.opened = 0;
+			info->status.error_number = TagErrnoInvalidArgument;
+		}
+		return NULL;
+	}
+	return openCursor (file, info? info: &infoDummy);
+}
+
 extern tagResult tagsSetSortType (tagFile *const file, const tagSortType type)
 {
+	unsigned int i;
+
 	if (file == NULL)
 		return TagFailure;
 
@@ -1297,6 +3659,8 @@ extern tagResult tagsSetSortType (tagFile *const file, const tagSortType type)
 	case TAG_SORTED:
 	case TAG_FOLDSORTED:
 		file->sortMethod = type;
+		for (i = 0; i < file->shards.count; ++i)
+			file->shards.files [i]->sortMethod = type;
 		return TagSuccess;
 	default:
 		file->err = TagErrnoUnexpectedSortedMethod;
@@ -1320,6 +3684,23 @@ extern tagResult tagsFirst (tagFile *const file, tagEntry *const entry)
 	return readNext (file, entry);
 }
 
+extern tagResult tagsSetPart (tagFile *const file, const unsigned int part,
+							  const unsigned int parts)
+{
+	if (file == NULL)
+		return TagFailure;
+
+	if (!file->initialized || file->err || parts == 0 || part >= parts)
+	{
+		file->err = TagErrnoInvalidArgument;
+		return TagFailure;
+	}
+
+	file->range.part = (parts > 1)? part: 0;
+	file->range.parts = (parts > 1)? parts: 0;
+	return TagSuccess;
+}
+
 extern tagResult tagsNext (tagFile *const file, tagEntry *const entry)
 {
 	if (file == NULL)
@@ -1354,7 +3735,57 @@ extern tagResult tagsFind (tagFile *const file, tagEntry *const entry,
 		return TagFailure;
 	}
 
-	return find (file, entry, name, options);
+	return find (file, entry, name, options, 0);
+}
+
+extern tagResult tagsFindAfter (tagFile *const file, tagEntry *const entry,
+								const char *const name, const int options)
+{
+	if (file == NULL)
+		return TagFailure;
+
+	if (!file->initialized || file->err)
+	{
+		file->err = TagErrnoInvalidArgument;
+		return TagFailure;
+	}
+
+	return find (file, entry, name, options, 1);
+}
+
+extern tagResult tagsFindEach (tagFile *const file,
+							   const char *const *const names,
+							   const unsigned int count, const int options,
+							   tagFindCallback callback, void *data)
+{
+	tagResult result = TagFailure;
+	tagEntry entry;
+
+	if (file == NULL)
+		return TagFailure;
+
+	if (!file->initialized || file->err || callback == NULL)
+	{
+		file->err = TagErrnoInvalidArgument;
+		return TagFailure;
+	}
+
+	for (unsigned int i = 0; i < count; i++)
+	{
+		tagResult r;
+
+		for (r = tagsFindAfter (file, &entry, names [i], options);
+			 r == TagSuccess;
+			 r = tagsFindNext (file, &entry))
+		{
+			result = TagSuccess;
+			if (callback (&entry, i, data))
+				return result;
+		}
+		if (file->err)
+			return TagFailure;
+	}
+	return result;
 }
 
 extern tagResult tagsFindNext (tagFile *const file, tagEntry *const entry)
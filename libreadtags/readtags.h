@@ -46,6 +46,10 @@ typedef enum {
 #define TAG_OBSERVECASE   0x0
 #define TAG_IGNORECASE    0x2
 
+/* Options for tagsFind() */
+#define TAG_SUBSTRINGMATCH 0x4
+#define TAG_FILEMATCH      0x8
+
 /*
 *  DATA DECLARATIONS
 */
@@ -156,6 +160,13 @@ typedef struct {
 
 } tagEntry;
 
+/* This function is called by tagsFindEach() for each tag found. `index' is
+ * the index of the name in the list of names the tag matches. Returning
+ * nonzero stops the search.
+ */
+typedef int (*tagFindCallback) (const tagEntry *const entry,
+								unsigned int index, void *data);
+
 
 /*
 *  FUNCTION PROTOTYPES
@@ -178,6 +189,37 @@ typedef struct {
 */
 extern tagFile *tagsOpen (const char *const filePath, tagFileInfo *const info);
 
+/*
+*  Make a cursor for reading the tag file opened as `file' by tagsOpen(). A
+*  cursor is a handle of its own for the functions of this library, with
+*  its own position and search state, reading the memory mapping of `file'
+*  and the name index loaded for it. The trigram and file indexes are
+*  shared too if `file' has loaded them already; otherwise the cursor
+*  loads its own when it needs an index. `file' and the cursors made from
+*  it can be used in different threads at once without locking; the tag
+*  file is not mapped again then even if it is rewritten. Call this
+*  function in the thread using `file', and close the cursors before `file'. If
+*  the tag file is not read from a memory mapping, as a binary tag
+*  database is, the cursor is a handle opening the tag file again. `info'
+*  is populated as tagsOpen() does.
+*/
+extern tagFile *tagsOpenCursor (tagFile *const file, tagFileInfo *const info);
+
+/*
+*  Make tagsFirst() and tagsNext() read only the tags of the `part'th,
+*  counted from 0, of `parts' byte ranges of the tag file of about the same
+*  size; a line is in the range its first character is in. Reading the
+*  parts one after another reads the tags of the whole file, each once and
+*  in the same order, so the parts can be read at once by cursors made with
+*  tagsOpenCursor() in different threads. The rows of a binary tag
+*  database are split instead of bytes. A tag file with shards is not split;
+*  all of its tags are in the part 0. If `parts' is 1, the whole file is
+*  read again. The function will return TagFailure if `part' is not less
+*  than `parts'.
+*/
+extern tagResult tagsSetPart (tagFile *const file, const unsigned int part,
+							  const unsigned int parts);
+
 /*
 *  This function allows the client to override the normal automatic detection
 *  of how a tag file is sorted. Permissible values for `type' are
@@ -243,6 +285,21 @@ extern const char *tagsField (const tagEntry *const entry, const char *const key
 *        Matching will be performed in a case-sensitive manner. Note that
 *        this enables binary searches of the tag file.
 *
+*    TAG_SUBSTRINGMATCH
+*        Tags whose names contain `name' will qualify, in the order of the
+*        tag file; TAG_PARTIALMATCH is ignored. The whole tag file is read
+*        unless the trigram index referred by the !_TAG_TRIGRAM_INDEX pseudo
+*        tag can be used: `name' must be three bytes long at least, without
+*        backslashes or control characters, and ASCII with TAG_IGNORECASE.
+*
+*    TAG_FILEMATCH
+*        Tags whose input files are `name' will qualify, in the order of the
+*        tag file; TAG_PARTIALMATCH and TAG_SUBSTRINGMATCH are ignored. The
+*        whole tag file is read unless the file index referred by the
+*        !_TAG_FILE_INDEX pseudo tag can be used: `name' must be given
+*        without TAG_IGNORECASE, and without backslashes or control
+*        characters if the input fields of the tag file are escaped.
+*
 *  The function will return TagSuccess if a tag matching the name is found, or
 *  TagFailure if not.
 */
@@ -257,6 +314,26 @@ extern tagResult tagsFind (tagFile *const file, tagEntry *const entry, const cha
 */
 extern tagResult tagsFindNext (tagFile *const file, tagEntry *const entry);
 
+/*
+*  Does the same as tagsFind(), but for a name not less than the name given
+*  to the previous search in the tag file with the same TAG_IGNORECASE
+*  option, the search starts at the first tag matching that name. A name
+*  near the previous one is found in a few steps then; lookups in the sort
+*  order of the tag file are faster than with tagsFind(). For any other name,
+*  the search is the one of tagsFind().
+*/
+extern tagResult tagsFindAfter (tagFile *const file, tagEntry *const entry, const char *const name, const int options);
+
+/*
+*  Find the tags matching each of the `count' names in `names' with
+*  tagsFindAfter() and tagsFindNext(), and call `callback' for each with
+*  `data'. With the names sorted as the tag file is, the tag file is read
+*  from the start to the end once at most. The function will return
+*  TagSuccess if a tag is found, or TagFailure if none is found or an error
+*  occurs.
+*/
+extern tagResult tagsFindEach (tagFile *const file, const char *const *const names, unsigned int count, const int options, tagFindCallback callback, void *data);
+
 /*
 *  Does the same as tagsFirst(), but is specialized to pseudo tags.
 *  If tagFileInfo doesn't contain pseudo tags you are interested in, read
@@ -0,0 +1,269 @@
+/*
+*   Copyright (c) 2026, Universal Ctags Team
+*
+*   This source code is released into the public domain.
+*
+*   Testing tagsFind() API function with TAG_FILEMATCH
+*/
+
+#include "readtags.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define	TAGS "./remove-me-after-testing-file.tags"
+#define	INDEX TAGS ".fdx"
+#define COUNT 2000
+#define FILES 7
+
+static void
+put_varint (FILE *fp, unsigned long n)
+{
+	while (n >= 0x80)
+	{
+		fputc ((int) ((n & 0x7f) | 0x80), fp);
+		n >>= 7;
+	}
+	fputc ((int) n, fp);
+}
+
+static size_t
+varint_size (unsigned long n)
+{
+	size_t s = 1;
+	while (n >= 0x80)
+	{
+		n >>= 7;
+		s++;
+	}
+	return s;
+}
+
+/* The files are named in the order of the bytes. */
+static void
+make_file (char *file, size_t size, unsigned int i)
+{
+	snprintf (file, size, "src/f%u.c", i % FILES);
+}
+
+/* Write the tag file and its file index in the layout written by
+ * ctags --file-index. */
+static int
+make_tags (void)
+{
+	FILE *fp = fopen (TAGS, "w");
+	FILE *ip;
+	long offsets [COUNT];
+	long size;
+	int r = 0;
+
+	if (fp == NULL)
+		return 1;
+
+	if (fprintf (fp, "!_TAG_FILE_FORMAT	2	/extended format/\n"
+				 "!_TAG_FILE_SORTED	1	/0=unsorted, 1=sorted, 2=foldcase/\n"
+				 "!_TAG_FILE_INDEX	%s	/index of input files/\n",
+				 INDEX + 2) < 0)
+		r = 1;
+
+	for (unsigned int i = 0; r == 0 && i < COUNT; i++)
+	{
+		char file [32];
+
+		make_file (file, sizeof (file), i);
+		offsets [i] = ftell (fp);
+		if (fprintf (fp, "name%04u	%s	/^int name%04u;$/;\"	v\n", i, file, i) < 0)
+			r = 1;
+	}
+	size = ftell (fp);
+	if (fclose (fp) != 0)
+		r = 1;
+	if (r)
+		return r;
+
+	ip = fopen (INDEX, "wb");
+	if (ip == NULL)
+		return 1;
+
+	fprintf (ip, "!_CTAGS_FILE_INDEX\t1\t%ld\t%u\n", size, FILES);
+	for (unsigned int f = 0; f < FILES; f++)
+	{
+		char file [32];
+		unsigned long count = 0, length = 0, last = 0;
+
+		make_file (file, sizeof (file), f);
+		for (unsigned int i = f; i < COUNT; i += FILES)
+		{
+			count++;
+			length += varint_size (offsets [i] - last);
+			last = offsets [i];
+		}
+		put_varint (ip, strlen (file));
+		fputs (file, ip);
+		put_varint (ip, count);
+		put_varint (ip, length);
+	}
+	for (unsigned int f = 0; f < FILES; f++)
+	{
+		unsigned long last = 0;
+
+		for (unsigned int i = f; i < COUNT; i += FILES)
+		{
+			put_varint (ip, offsets [i] - last);
+			last = offsets [i];
+		}
+	}
+
+	if (fclose (ip) != 0)
+		r = 1;
+	return r;
+}
+
+static int
+check_found (tagFile *t, const char *file, const int options, int expected)
+{
+	tagEntry e;
+	int n = 0;
+	char last [32] = "";
+
+	for (tagResult r = tagsFind (t, &e, file, options | TAG_FILEMATCH);
+		 r == TagSuccess;
+		 r = tagsFindNext (t, &e))
+	{
+		if (((options & TAG_IGNORECASE)? strcasecmp (e.file, file): strcmp (e.file, file)) != 0)
+		{
+			fprintf (stderr, "unexpected file for \"%s\": %s\n", file, e.file);
+			return 1;
+		}
+		/* The tags are in the order of the tag file. */
+		if (strcmp (last, e.name) >= 0)
+		{
+			fprintf (stderr, "unexpected order for \"%s\": %s after %s\n",
+					 file, e.name, last);
+			return 1;
+		}
+		snprintf (last, sizeof (last), "%s", e.name);
+		n++;
+	}
+
+	if (tagsGetErrno (t) != 0)
+	{
+		fprintf (stderr, "error in finding \"%s\": %d\n", file, tagsGetErrno (t));
+		return 1;
+	}
+	if (n != expected)
+	{
+		fprintf (stderr, "%d tag(s) found for \"%s\" (expected: %d)\n", n, file, expected);
+		return 1;
+	}
+	return 0;
+}
+
+static int
+check_files (const char *tags)
+{
+	tagFileInfo info;
+	tagFile *t = tagsOpen (tags, &info);
+	int r = 1;
+
+	if (t == NULL)
+	{
+		fprintf (stderr, "unexpected result (t: %p, opened: %d, error_number: %d)\n",
+				 t, info.status.opened, info.status.error_number);
+		return 1;
+	}
+
+	if (check_found (t, "src/f0.c", TAG_OBSERVECASE, COUNT / FILES + 1) != 0
+		|| check_found (t, "src/f6.c", TAG_OBSERVECASE, COUNT / FILES) != 0
+		|| check_found (t, "SRC/F3.C", TAG_OBSERVECASE, 0) != 0
+		|| check_found (t, "SRC/F3.C", TAG_IGNORECASE, COUNT / FILES + 1) != 0
+		|| check_found (t, "src/f", TAG_PARTIALMATCH, 0) != 0
+		|| check_found (t, "src/f7.c", TAG_OBSERVECASE, 0) != 0
+		|| check_found (t, "", TAG_OBSERVECASE, 0) != 0)
+		goto out;
+
+	/* A search with the index and a cursor */
+	tagFile *c = tagsOpenCursor (t, NULL);
+	if (c == NULL
+		|| check_found (c, "src/f1.c", TAG_OBSERVECASE, COUNT / FILES + 1) != 0
+		|| tagsClose (c) != TagSuccess)
+		goto out;
+
+	r = 0;
+ out:
+	tagsClose (t);
+	return r;
+}
+
+static int
+check_escaped (void)
+{
+	tagFile *t = tagsOpen ("./unescaping-input-fields.tags", NULL);
+	int r = 1;
+
+	if (t == NULL)
+		return 1;
+
+	if (check_found (t, "\tabc", TAG_OBSERVECASE, 1) != 0
+		|| check_found (t, "a\\bc", TAG_OBSERVECASE, 1) != 0
+		|| check_found (t, "ab\nc", TAG_OBSERVECASE, 1) != 0
+		|| check_found (t, "abc", TAG_OBSERVECASE, 0) != 0)
+		goto out;
+
+	r = 0;
+ out:
+	tagsClose (t);
+	return r;
+}
+
+int
+main (void)
+{
+	char *srcdir = getenv ("srcdir");
+	int r = 1;
+
+	if (srcdir)
+	{
+		if (chdir (srcdir) == -1)
+		{
+			perror ("chdir");
+			return 99;
+		}
+	}
+
+	fprintf (stderr, "finding escaped input files...");
+	if (check_escaped () != 0)
+		goto out;
+	fprintf (stderr, "ok\n");
+
+	fprintf (stderr, "generating %s...", TAGS);
+	if (make_tags () != 0)
+	{
+		fprintf (stderr, "failed\n");
+		goto out;
+	}
+	fprintf (stderr, "done\n");
+
+	fprintf (stderr, "finding input files with the index...");
+	if (check_files (TAGS) != 0)
+		goto out;
+	fprintf (stderr, "ok\n");
+
+	fprintf (stderr, "finding input files with a broken index...");
+	if (truncate (INDEX, 40) != 0 || check_files (TAGS) != 0)
+		goto out;
+	fprintf (stderr, "ok\n");
+
+	fprintf (stderr, "finding input files without the index...");
+	if (remove (INDEX) != 0 || check_files (TAGS) != 0)
+		goto out;
+	fprintf (stderr, "ok\n");
+
+	r = 0;
+ out:
+	remove (TAGS);
+	remove (INDEX);
+	return r;
+}
@@ -0,0 +1,348 @@
+/*
+*   Copyright (c) 2026, Universal Ctags Team
+*
+*   This source code is released into the public domain.
+*
+*   Testing tagsFind() API function with TAG_SUBSTRINGMATCH
+*/
+
+#include "readtags.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define	TAGS "./remove-me-after-testing-substring.tags"
+#define	INDEX TAGS ".tri"
+#define COUNT 2000
+
+struct posting {
+	unsigned long trigram;
+	unsigned long line;
+};
+
+static void
+put_varint (FILE *fp, unsigned long n)
+{
+	while (n >= 0x80)
+	{
+		fputc ((int) ((n & 0x7f) | 0x80), fp);
+		n >>= 7;
+	}
+	fputc ((int) n, fp);
+}
+
+static size_t
+varint_size (unsigned long n)
+{
+	size_t s = 1;
+	while (n >= 0x80)
+	{
+		n >>= 7;
+		s++;
+	}
+	return s;
+}
+
+static unsigned long
+fold (char c)
+{
+	return (c >= 'A' && c <= 'Z')? c - 'A' + 'a': (unsigned char) c;
+}
+
+static int
+compare_postings (const void *a, const void *b)
+{
+	const struct posting *pa = a;
+	const struct posting *pb = b;
+
+	if (pa->trigram != pb->trigram)
+		return pa->trigram < pb->trigram? -1: 1;
+	if (pa->line != pb->line)
+		return pa->line < pb->line? -1: 1;
+	return 0;
+}
+
+static void
+make_name (char *name, size_t size, unsigned int i)
+{
+	snprintf (name, size, "%s%04u", (i % 2)? "getValue": "setname", i);
+}
+
+/* Write the tag file and its trigram index in the layout written by
+ * ctags --trigram-index. */
+static int
+make_tags (void)
+{
+	FILE *fp = fopen (TAGS, "w");
+	FILE *ip;
+	long offsets [COUNT];
+	struct posting *postings = malloc (COUNT * 16 * sizeof (struct posting));
+	size_t n = 0;
+	long size;
+	int r = 0;
+
+	if (fp == NULL || postings == NULL)
+		return 1;
+
+	if (fprintf (fp, "!_TAG_FILE_FORMAT	2	/extended format/\n"
+				 "!_TAG_FILE_SORTED	0	/0=unsorted, 1=sorted, 2=foldcase/\n"
+				 "!_TAG_TRIGRAM_INDEX	%s	/index of trigrams in names/\n",
+				 INDEX + 2) < 0)
+		r = 1;
+
+	for (unsigned int i = 0; r == 0 && i < COUNT; i++)
+	{
+		char name [32];
+
+		make_name (name, sizeof (name), i);
+		offsets [i] = ftell (fp);
+		if (fprintf (fp, "%s	a.c	/^int %s;$/;\"	v\n", name, name) < 0)
+			r = 1;
+		for (size_t j = 0; j + 3 <= strlen (name); j++)
+		{
+			postings [n].trigram = (fold (name [j]) << 16)
+				| (fold (name [j + 1]) << 8) | fold (name [j + 2]);
+			postings [n].line = i;
+			n++;
+		}
+	}
+	size = ftell (fp);
+	if (fclose (fp) != 0)
+		r = 1;
+	if (r)
+		goto out;
+
+	qsort (postings, n, sizeof (struct posting), compare_postings);
+
+	ip = fopen (INDEX, "wb");
+	if (ip == NULL)
+	{
+		r = 1;
+		goto out;
+	}
+
+	size_t trigrams = 0;
+	for (size_t i = 0; i < n; i++)
+		if (i == 0 || postings [i].trigram != postings [i - 1].trigram)
+			trigrams++;
+	fprintf (ip, "!_CTAGS_TRIGRAM_INDEX\t1\t%ld\t%u\t%zu\n", size, COUNT, trigrams);
+
+	for (unsigned int i = 0; i < COUNT; i++)
+		put_varint (ip, offsets [i] - (i? offsets [i - 1]: 0));
+
+	/* The table of the trigrams, skipping the duplicated postings */
+	unsigned long previous = 0;
+	for (size_t i = 0; i < n; )
+	{
+		unsigned long count = 0, length = 0, last = 0;
+		size_t j;
+
+		for (j = i; j < n && postings [j].trigram == postings [i].trigram; j++)
+		{
+			if (j > i && postings [j].line == postings [j - 1].line)
+				continue;
+			count++;
+			length += varint_size (postings [j].line - last);
+			last = postings [j].line;
+		}
+		put_varint (ip, postings [i].trigram - previous);
+		put_varint (ip, count);
+		put_varint (ip, length);
+		previous = postings [i].trigram;
+		i = j;
+	}
+	for (size_t i = 0; i < n; )
+	{
+		unsigned long last = 0;
+		size_t j;
+
+		for (j = i; j < n && postings [j].trigram == postings [i].trigram; j++)
+		{
+			if (j > i && postings [j].line == postings [j - 1].line)
+				continue;
+			put_varint (ip, postings [j].line - last);
+			last = postings [j].line;
+		}
+		i = j;
+	}
+
+	if (fclose (ip) != 0)
+		r = 1;
+ out:
+	free (postings);
+	return r;
+}
+
+static int
+contains (const char *s, const char *sub, int ignorecase)
+{
+	for (; ; s++)
+	{
+		size_t i;
+
+		for (i = 0; sub [i] != '\0'; i++)
+		{
+			char a = s [i], b = sub [i];
+			if (ignorecase)
+			{
+				a = (char) tolower ((unsigned char) a);
+				b = (char) tolower ((unsigned char) b);
+			}
+			if (a != b)
+				break;
+		}
+		if (sub [i] == '\0')
+			return 1;
+		if (*s == '\0')
+			return 0;
+	}
+}
+
+static int
+check_found (tagFile *t, const char *name, const int options, int expected)
+{
+	tagEntry e;
+	int n = 0;
+
+	for (tagResult r = tagsFind (t, &e, name, options | TAG_SUBSTRINGMATCH);
+		 r == TagSuccess;
+		 r = tagsFindNext (t, &e))
+	{
+		if (! contains (e.name, name, options & TAG_IGNORECASE))
+		{
+			fprintf (stderr, "unexpected name for \"%s\": %s\n", name, e.name);
+			return 1;
+		}
+		n++;
+	}
+
+	if (tagsGetErrno (t) != 0)
+	{
+		fprintf (stderr, "error in finding \"%s\": %d\n", name, tagsGetErrno (t));
+		return 1;
+	}
+	if (n != expected)
+	{
+		fprintf (stderr, "%d tag(s) found for \"%s\" (expected: %d)\n", n, name, expected);
+		return 1;
+	}
+	return 0;
+}
+
+static int
+check_names (const char *tags)
+{
+	tagFileInfo info;
+	tagFile *t = tagsOpen (tags, &info);
+	int r = 1;
+
+	if (t == NULL)
+	{
+		fprintf (stderr, "unexpected result (t: %p, opened: %d, error_number: %d)\n",
+				 t, info.status.opened, info.status.error_number);
+		return 1;
+	}
+
+	if (check_found (t, "Value", TAG_OBSERVECASE, COUNT / 2) != 0
+		|| check_found (t, "value", TAG_OBSERVECASE, 0) != 0
+		|| check_found (t, "value", TAG_IGNORECASE, COUNT / 2) != 0
+		|| check_found (t, "name1", TAG_OBSERVECASE, 500) != 0
+		|| check_found (t, "lue19", TAG_OBSERVECASE, 50) != 0
+		|| check_found (t, "NAME0", TAG_IGNORECASE, 500) != 0
+		|| check_found (t, "e1998", TAG_OBSERVECASE, 1) != 0
+		|| check_found (t, "e1999", TAG_OBSERVECASE, 1) != 0
+		|| check_found (t, "tValue", TAG_PARTIALMATCH, COUNT / 2) != 0
+		|| check_found (t, "zzz", TAG_OBSERVECASE, 0) != 0
+		|| check_found (t, "e0", TAG_OBSERVECASE, 1000) != 0
+		|| check_found (t, "TAG", TAG_OBSERVECASE, 0) != 0
+		|| check_found (t, "", TAG_OBSERVECASE, COUNT) != 0)
+		goto out;
+
+	/* A search with the index and a cursor */
+	tagFile *c = tagsOpenCursor (t, NULL);
+	if (c == NULL
+		|| check_found (c, "Val", TAG_OBSERVECASE, COUNT / 2) != 0
+		|| tagsClose (c) != TagSuccess)
+		goto out;
+
+	r = 0;
+ out:
+	tagsClose (t);
+	return r;
+}
+
+static int
+check_escaped (void)
+{
+	tagFile *t = tagsOpen ("./unescaping.tags", NULL);
+	int r = 1;
+
+	if (t == NULL)
+		return 1;
+
+	if (check_found (t, "aa", TAG_OBSERVECASE, 2) != 0
+		|| check_found (t, "\taa", TAG_OBSERVECASE, 1) != 0
+		|| check_found (t, "\\\a", TAG_OBSERVECASE, 1) != 0
+		|| check_found (t, "!level", TAG_OBSERVECASE, 2) != 0
+		|| check_found (t, "level3", TAG_OBSERVECASE, 2) != 0
+		|| check_found (t, "LEVEL2", TAG_IGNORECASE, 2) != 0)
+		goto out;
+
+	r = 0;
+ out:
+	tagsClose (t);
+	return r;
+}
+
+int
+main (void)
+{
+	char *srcdir = getenv ("srcdir");
+	int r = 1;
+
+	if (srcdir)
+	{
+		if (chdir (srcdir) == -1)
+		{
+			perror ("chdir");
+			return 99;
+		}
+	}
+
+	fprintf (stderr, "finding escaped names...");
+	if (check_escaped () != 0)
+		goto out;
+	fprintf (stderr, "ok\n");
+
+	fprintf (stderr, "generating %s...", TAGS);
+	if (make_tags () != 0)
+	{
+		fprintf (stderr, "failed\n");
+		goto out;
+	}
+	fprintf (stderr, "done\n");
+
+	fprintf (stderr, "finding names with the index...");
+	if (check_names (TAGS) != 0)
+		goto out;
+	fprintf (stderr, "ok\n");
+
+	fprintf (stderr, "finding names with a broken index...");
+	if (truncate (INDEX, 100) != 0 || check_names (TAGS) != 0)
+		goto out;
+	fprintf (stderr, "ok\n");
+
+	fprintf (stderr, "finding names without the index...");
+	if (remove (INDEX) != 0 || check_names (TAGS) != 0)
+		goto out;
+	fprintf (stderr, "ok\n");
+
+	r = 0;
+ out:
+	remove (TAGS);
+	remove (INDEX);
+	return r;
+}
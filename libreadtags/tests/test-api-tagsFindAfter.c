@@ -0,0 +1,186 @@
+/*
+*   Copyright (c) 2026, Universal Ctags Team
+*
+*   This source code is released into the public domain.
+*
+*   Testing tagsFindAfter() and tagsFindEach() API functions
+*/
+
+#include "readtags.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define	TAGS "./remove-me-after-testing-find-after.tags"
+#define COUNT 20000
+
+static int
+make_tags (const char *output)
+{
+	FILE *fp = fopen(output, "w");
+	if (fp == NULL)
+		return 1;
+
+	int r = 0;
+	if (fputs("!_TAG_FILE_FORMAT	2	/extended format/\n"
+			  "!_TAG_FILE_SORTED	1	/0=unsorted, 1=sorted, 2=foldcase/\n", fp) < 0)
+		r = 1;
+
+	/* Each name appears twice: in a.c and in b.c. */
+	for (unsigned int i = 0; r == 0 && i < COUNT; i++)
+	{
+		if (fprintf(fp, "name%05u	a.c	/^int name%05u;$/;\"	v\n", i * 2, i * 2) < 0
+			|| fprintf(fp, "name%05u	b.c	/^int name%05u;$/;\"	v\n", i * 2, i * 2) < 0)
+			r = 1;
+	}
+
+	if (fclose(fp) != 0)
+		r = 1;
+	return r;
+}
+
+static int
+check_found (tagFile *t, const char *name, const int options, int expected)
+{
+	tagEntry e;
+	int n = 0;
+
+	for (tagResult r = tagsFindAfter (t, &e, name, options);
+		 r == TagSuccess;
+		 r = tagsFindNext (t, &e))
+	{
+		if (strncmp (e.name, name, strlen (name)) != 0)
+		{
+			fprintf (stderr, "unexpected name for \"%s\": %s\n", name, e.name);
+			return 1;
+		}
+		if (n == 0 && strcmp (e.file, "a.c") != 0)
+		{
+			fprintf (stderr, "not the first tag of \"%s\": %s\n", name, e.file);
+			return 1;
+		}
+		n++;
+	}
+
+	if (tagsGetErrno (t) != 0)
+	{
+		fprintf (stderr, "error in finding \"%s\": %d\n", name, tagsGetErrno (t));
+		return 1;
+	}
+	if (n != expected)
+	{
+		fprintf (stderr, "%d tag(s) found for \"%s\" (expected: %d)\n", n, name, expected);
+		return 1;
+	}
+	return 0;
+}
+
+static int
+count_found (const tagEntry *const entry, unsigned int index, void *data)
+{
+	unsigned int *counts = data;
+
+	counts [index]++;
+	return 0;
+}
+
+int
+main (void)
+{
+	tagFileInfo info;
+	tagFile *t;
+	char name [16];
+	int r = 1;
+
+	fprintf (stderr, "generating %s...", TAGS);
+	if (make_tags (TAGS) != 0)
+	{
+		fprintf (stderr, "failed\n");
+		goto out;
+	}
+	fprintf (stderr, "done\n");
+
+	t = tagsOpen (TAGS, &info);
+	if (t == NULL)
+	{
+		fprintf (stderr, "unexpected result (t: %p, opened: %d, error_number: %d)\n",
+				 t, info.status.opened, info.status.error_number);
+		goto out;
+	}
+
+	fprintf (stderr, "finding names in order...");
+	for (unsigned int i = 0; i < COUNT * 2; i += 37)
+	{
+		snprintf (name, sizeof (name), "name%05u", i);
+		if (check_found (t, name, TAG_FULLMATCH, (i % 2)? 0: 2) != 0)
+			goto close;
+	}
+	fprintf (stderr, "ok\n");
+
+	fprintf (stderr, "finding each name twice...");
+	for (unsigned int i = 0; i < COUNT * 2; i += 2)
+	{
+		snprintf (name, sizeof (name), "name%05u", i);
+		if (check_found (t, name, TAG_FULLMATCH, 2) != 0
+			|| check_found (t, name, TAG_FULLMATCH, 2) != 0)
+			goto close;
+	}
+	fprintf (stderr, "ok\n");
+
+	fprintf (stderr, "finding prefixes in order...");
+	for (unsigned int i = 0; i < COUNT * 2 / 100; i += 3)
+	{
+		snprintf (name, sizeof (name), "name%03u", i);
+		if (check_found (t, name, TAG_PARTIALMATCH, 100) != 0)
+			goto close;
+	}
+	fprintf (stderr, "ok\n");
+
+	fprintf (stderr, "finding names in reverse order...");
+	for (int i = COUNT * 2 - 2; i >= 0; i -= 1234)
+	{
+		snprintf (name, sizeof (name), "name%05d", i);
+		if (check_found (t, name, TAG_FULLMATCH, 2) != 0)
+			goto close;
+	}
+	fprintf (stderr, "ok\n");
+
+	fprintf (stderr, "finding names after the last one...");
+	if (check_found (t, "name39998", TAG_FULLMATCH, 2) != 0
+		|| check_found (t, "name4", TAG_PARTIALMATCH, 0) != 0
+		|| check_found (t, "zzz", TAG_FULLMATCH, 0) != 0)
+		goto close;
+	fprintf (stderr, "ok\n");
+
+	fprintf (stderr, "finding a list of names...");
+	{
+		const char *names [] = { "name00000", "name00001", "name0001", "name12344", "name39998", "zzz" };
+		const unsigned int expected [] = { 2, 0, 10, 2, 2, 0 };
+		unsigned int counts [6] = { 0 };
+
+		if (tagsFindEach (t, names, 6, TAG_PARTIALMATCH, count_found, counts) != TagSuccess)
+		{
+			fprintf (stderr, "failed: %d\n", tagsGetErrno (t));
+			goto close;
+		}
+		for (unsigned int i = 0; i < 6; i++)
+		{
+			if (counts [i] != expected [i])
+			{
+				fprintf (stderr, "%u tag(s) found for \"%s\" (expected: %u)\n",
+						 counts [i], names [i], expected [i]);
+				goto close;
+			}
+		}
+	}
+	fprintf (stderr, "ok\n");
+
+	r = 0;
+ close:
+	tagsClose (t);
+ out:
+	remove (TAGS);
+	return r;
+}
@@ -0,0 +1,139 @@
+/*
+*   Copyright (c) 2026, Universal Ctags Team
+*
+*   This source code is released into the public domain.
+*
+*   Testing tagsOpenCursor() API function
+*/
+
+#include "readtags.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static int
+check_next (tagFile *t, tagEntry *e, const char *label, const char *name)
+{
+	fprintf (stderr, "%s: next \"%s\"...", label, name);
+	if (tagsFindNext (t, e) != TagSuccess)
+	{
+		fprintf (stderr, "not found\n");
+		return 1;
+	}
+	if (strcmp (e->name, name) != 0)
+	{
+		fprintf (stderr, "unexpected: %s\n", e->name);
+		return 1;
+	}
+	fprintf (stderr, "ok\n");
+	return 0;
+}
+
+static int
+check_find (tagFile *t, tagEntry *e, const char *label, const char *name)
+{
+	fprintf (stderr, "%s: finding \"%s\"...", label, name);
+	if (tagsFind (t, e, name, TAG_FULLMATCH) != TagSuccess)
+	{
+		fprintf (stderr, "not found\n");
+		return 1;
+	}
+	if (strcmp (e->name, name) != 0)
+	{
+		fprintf (stderr, "unexpected: %s\n", e->name);
+		return 1;
+	}
+	fprintf (stderr, "ok\n");
+	return 0;
+}
+
+int
+main (void)
+{
+	char *srcdir = getenv ("srcdir");
+	if (srcdir)
+	{
+		if (chdir (srcdir) == -1)
+		{
+			perror ("chdir");
+			return 99;
+		}
+	}
+
+	tagFileInfo info;
+	tagEntry e0, e1, e2;
+	const char *tags = "./duplicated-names--sorted-yes.tags";
+
+	tagFile *t = tagsOpen (tags, &info);
+	if (t == NULL)
+	{
+		fprintf (stderr, "unexpected result (t: %p, opened: %d, error_number: %d)\n",
+				 t, info.status.opened, info.status.error_number);
+		return 1;
+	}
+
+	fprintf (stderr, "opening cursors...");
+	tagFile *c1 = tagsOpenCursor (t, &info);
+	if (c1 == NULL || !info.status.opened || info.file.sort != TAG_SORTED)
+	{
+		fprintf (stderr, "unexpected result (c1: %p, opened: %d, error_number: %d)\n",
+				 c1, info.status.opened, info.status.error_number);
+		return 1;
+	}
+	tagFile *c2 = tagsOpenCursor (t, NULL);
+	if (c2 == NULL)
+	{
+		fprintf (stderr, "failed\n");
+		return 1;
+	}
+	fprintf (stderr, "ok\n");
+
+	/* The handles don't share the search state. */
+	if (check_find (t, &e0, "file", "n")
+		|| check_find (c1, &e1, "cursor 1", "m")
+		|| check_find (c2, &e2, "cursor 2", "n")
+		|| check_next (t, &e0, "file", "n")
+		|| check_next (c2, &e2, "cursor 2", "n")
+		|| check_next (c2, &e2, "cursor 2", "n")
+		|| check_find (c1, &e1, "cursor 1", "o")
+		|| check_next (t, &e0, "file", "n"))
+		return 1;
+
+	fprintf (stderr, "reading all tags with a cursor...");
+	int count = 0;
+	for (tagResult r = tagsFirst (c1, &e1); r == TagSuccess; r = tagsNext (c1, &e1))
+		count++;
+	if (count != 12 || tagsGetErrno (c1) != 0)
+	{
+		fprintf (stderr, "unexpected: %d tags, error %d\n", count, tagsGetErrno (c1));
+		return 1;
+	}
+	fprintf (stderr, "ok\n");
+
+	fprintf (stderr, "closing cursors...");
+	if (tagsClose (c1) != TagSuccess || tagsClose (c2) != TagSuccess)
+	{
+		fprintf (stderr, "failed\n");
+		return 1;
+	}
+	fprintf (stderr, "ok\n");
+
+	if (check_next (t, &e0, "file", "n"))
+		return 1;
+
+	fprintf (stderr, "opening a cursor with NULL...");
+	if (tagsOpenCursor (NULL, &info) != NULL
+		|| info.status.opened
+		|| info.status.error_number != TagErrnoInvalidArgument)
+	{
+		fprintf (stderr, "unexpected result\n");
+		return 1;
+	}
+	fprintf (stderr, "ok\n");
+
+	if (tagsClose (t) != TagSuccess)
+		return 1;
+	return 0;
+}
@@ -0,0 +1,150 @@
+/*
+*   Copyright (c) 2026, Universal Ctags Team
+*
+*   This source code is released into the public domain.
+*
+*   Testing tagsSetPart() API function
+*/
+
+#include "readtags.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define	TAGS "./remove-me-after-testing-set-part.tags"
+#define COUNT 500
+
+static int
+make_tags (const char *output)
+{
+	FILE *fp = fopen(output, "w");
+	if (fp == NULL)
+		return 1;
+
+	int r = 0;
+	if (fputs("!_TAG_FILE_FORMAT	2	/extended format/\n"
+			  "!_TAG_FILE_SORTED	0	/0=unsorted, 1=sorted, 2=foldcase/\n", fp) < 0)
+		r = 1;
+
+	/* Lines of different lengths, and a few empty lines */
+	for (unsigned int i = 0; r == 0 && i < COUNT; i++)
+	{
+		if (fprintf(fp, "name%u	%.*s.c	/^int name%u;$/;\"	v\n",
+					i, (int) (i % 37) + 1, "abcdefghijklmnopqrstuvwxyzabcdefghijk", i) < 0
+			|| (i % 101 == 0 && fputs("\n", fp) < 0))
+			r = 1;
+	}
+
+	if (fclose(fp) != 0)
+		r = 1;
+	return r;
+}
+
+static int
+check_parts (tagFile *t, unsigned int parts)
+{
+	tagEntry e;
+	unsigned int expected = 0;
+
+	fprintf (stderr, "reading %u part(s)...", parts);
+	for (unsigned int part = 0; part < parts; part++)
+	{
+		if (tagsSetPart (t, part, parts) != TagSuccess)
+		{
+			fprintf (stderr, "failed in setting the part %u\n", part);
+			return 1;
+		}
+		for (tagResult r = tagsFirst (t, &e); r == TagSuccess; r = tagsNext (t, &e))
+		{
+			char name [16];
+
+			snprintf (name, sizeof (name), "name%u", expected);
+			if (strcmp (e.name, name) != 0)
+			{
+				fprintf (stderr, "unexpected tag in the part %u: %s (expected: %s)\n",
+						 part, e.name, name);
+				return 1;
+			}
+			expected++;
+		}
+		if (tagsGetErrno (t) != 0)
+		{
+			fprintf (stderr, "error in the part %u: %d\n", part, tagsGetErrno (t));
+			return 1;
+		}
+	}
+	if (expected != COUNT)
+	{
+		fprintf (stderr, "%u tag(s) read (expected: %u)\n", expected, COUNT);
+		return 1;
+	}
+	fprintf (stderr, "ok\n");
+	return 0;
+}
+
+int
+main (void)
+{
+	tagFileInfo info;
+	tagFile *t;
+	int r = 1;
+
+	fprintf (stderr, "generating %s...", TAGS);
+	if (make_tags (TAGS) != 0)
+	{
+		fprintf (stderr, "failed\n");
+		goto out;
+	}
+	fprintf (stderr, "done\n");
+
+	t = tagsOpen (TAGS, &info);
+	if (t == NULL)
+	{
+		fprintf (stderr, "unexpected result (t: %p, opened: %d, error_number: %d)\n",
+				 t, info.status.opened, info.status.error_number);
+		goto out;
+	}
+
+	const unsigned int parts [] = { 1, 2, 3, 7, 64, 999, 5000 };
+	for (unsigned int i = 0; i < sizeof (parts) / sizeof (parts [0]); i++)
+	{
+		if (check_parts (t, parts [i]) != 0)
+			goto close;
+	}
+
+	fprintf (stderr, "reading a part with a cursor...");
+	{
+		tagFile *c = tagsOpenCursor (t, NULL);
+		tagEntry e;
+
+		if (c == NULL
+			|| tagsSetPart (c, 1, 2) != TagSuccess
+			|| tagsFirst (c, &e) != TagSuccess
+			|| strncmp (e.name, "name", 4) != 0
+			|| atoi (e.name + 4) == 0)
+		{
+			fprintf (stderr, "unexpected result\n");
+			goto close;
+		}
+		tagsClose (c);
+	}
+	fprintf (stderr, "ok\n");
+
+	fprintf (stderr, "setting an invalid part...");
+	if (tagsSetPart (t, 2, 2) != TagFailure
+		|| tagsGetErrno (t) != TagErrnoInvalidArgument)
+	{
+		fprintf (stderr, "unexpected result\n");
+		goto close;
+	}
+	fprintf (stderr, "ok\n");
+
+	r = 0;
+ close:
+	tagsClose (t);
+ out:
+	remove (TAGS);
+	return r;
+}
@@ -0,0 +1,200 @@
+/*
+*   Copyright (c) 2026, Universal Ctags Team
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License version 2 or (at your option) any later version.
+*
+*   Defines a bump pointer allocator for objects freed all together.
+*
+*   Memory is cut from chunks in order. A request not fitting the current
+*   chunk starts a new chunk, twice as large as the current one up to
+*   ARENA_MAX_CHUNK_SIZE, so an arena holding many objects has a few
+*   chunks only. arenaOwns () searches the chunks sorted by their
+*   addresses, for the arenas that grow to many chunks all the same.
+*/
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"  /* must always come first */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "arena_p.h"
+#include "debug.h"
+#include "routines.h"
+
+/*
+*   MACROS
+*/
+#define ARENA_MAX_CHUNK_SIZE (4 * 1024 * 1024)
+
+/*
+*   DATA DECLARATIONS
+*/
+typedef union uArenaAlign {
+	void *p;
+	long l;
+	long long ll;
+	double d;
+	long double ld;
+} arenaAlign;
+
+typedef struct sArenaChunk {
+	struct sArenaChunk *next;	/* the chunk allocated before this one */
+	size_t size;
+	size_t used;
+	arenaAlign data [];
+} arenaChunk;
+
+struct sArena {
+	arenaChunk *chunk;			/* the chunk allocated last */
+	size_t chunkSize;
+	/* The chunks sorted by their addresses, for arenaOwns () */
+	arenaChunk **sorted;
+	unsigned int chunkCount;
+	unsigned int sortedSize;
+};
+
+/*
+*   FUNCTION DEFINITIONS
+*/
+
+static arenaChunk *newChunk (size_t size, arenaChunk *next)
+{
+	arenaChunk *c = eMalloc (sizeof (arenaChunk) + size);
+
+	c->next = next;
+	c->size = size;
+	c->used = 0;
+	return c;
+}
+
+extern arena *arenaNew (size_t chunkSize)
+{
+	arena *a = xMalloc (1, arena);
+
+	Assert (chunkSize > 0);
+	a->chunk = NULL;
+	a->chunkSize = chunkSize;
+	a->sorted = NULL;
+	a->chunkCount = 0;
+	a->sortedSize = 0;
+	return a;
+}
+
+static void addSortedChunk (arena *a, arenaChunk *c)
+{
+	unsigned int i = a->chunkCount;
+
+	if (a->chunkCount == a->sortedSize)
+	{
+		a->sortedSize = a->sortedSize? a->sortedSize * 2: 8;
+		a->sorted = xRealloc (a->sorted, a->sortedSize, arenaChunk *);
+	}
+	while (i > 0 && (uintptr_t) a->sorted [i - 1] > (uintptr_t) c)
+	{
+		a->sorted [i] = a->sorted [i - 1];
+		i--;
+	}
+	a->sorted [i] = c;
+	a->chunkCount++;
+}
+
+static void deleteChunks (arenaChunk *c)
+{
+	while (c)
+	{
+		arenaChunk *next = c->next;
+		eFree (c);
+		c = next;
+	}
+}
+
+extern void arenaDelete (arena *a)
+{
+	deleteChunks (a->chunk);
+	if (a->sorted)
+		eFree (a->sorted);
+	eFree (a);
+}
+
+extern void *arenaAlloc (arena *a, size_t size)
+{
+	const size_t align = sizeof (arenaAlign);
+	arenaChunk *c = a->chunk;
+	void *p;
+
+	size = (size + align - 1) / align * align;
+	if (size == 0)
+		size = align;
+
+	if (c == NULL || c->size - c->used < size)
+	{
+		size_t chunkSize = c? c->size * 2: a->chunkSize;
+
+		if (chunkSize > ARENA_MAX_CHUNK_SIZE)
+			chunkSize = ARENA_MAX_CHUNK_SIZE;
+		if (chunkSize < size)
+			chunkSize = size;
+		/* Keep the chunk size a multiple of the alignment. */
+		chunkSize = (chunkSize + align - 1) / align * align;
+
+		c = newChunk (chunkSize, c);
+		a->chunk = c;
+		addSortedChunk (a, c);
+	}
+
+	p = ((char *)c->data) + c->used;
+	c->used += size;
+	return p;
+}
+
+extern char *arenaStrndup (arena *a, const char *str, size_t len)
+{
+	char *s = arenaAlloc (a, len + 1);
+
+	memcpy (s, str, len);
+	s [len] = '\0';
+	return s;
+}
+
+extern char *arenaStrdup (arena *a, const char *str)
+{
+	return arenaStrndup (a, str, strlen (str));
+}
+
+extern void arenaReset (arena *a)
+{
+	if (a->chunk == NULL)
+		return;
+
+	deleteChunks (a->chunk->next);
+	a->chunk->next = NULL;
+	a->chunk->used = 0;
+	a->sorted [0] = a->chunk;
+	a->chunkCount = 1;
+}
+
+extern bool arenaOwns (const arena *a, const void *ptr)
+{
+	const uintptr_t p = (uintptr_t) ptr;
+	unsigned int lo = 0, hi = a->chunkCount;
+
+	if (hi == 0 || p < (uintptr_t) a->sorted [0]->data)
+		return false;
+
+	/* Find the last chunk starting at or before PTR. */
+	while (hi - lo > 1)
+	{
+		unsigned int mid = lo + (hi - lo) / 2;
+		if ((uintptr_t) a->sorted [mid]->data <= p)
+			lo = mid;
+		else
+			hi = mid;
+	}
+
+	const arenaChunk *c = a->sorted [lo];
+	return p < (uintptr_t) c->data + c->used;
+}
@@ -0,0 +1,43 @@
+/*
+*   Copyright (c) 2026, Universal Ctags Team
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License version 2 or (at your option) any later version.
+*
+*   Defines a bump pointer allocator for objects freed all together.
+*/
+#ifndef CTAGS_MAIN_ARENA_PRIVATE_H
+#define CTAGS_MAIN_ARENA_PRIVATE_H
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"  /* must always come first */
+
+#include <stddef.h>
+
+/*
+*   DATA DECLARATIONS
+*/
+struct sArena;
+typedef struct sArena arena;
+
+/*
+*   FUNCTION PROTOTYPES
+*/
+extern arena *arenaNew (size_t chunkSize);
+extern void arenaDelete (arena *a);
+
+/* The memory returned is aligned for any object. It stays valid until
+ * arenaReset () or arenaDelete () is called. */
+extern void *arenaAlloc (arena *a, size_t size);
+extern char *arenaStrdup (arena *a, const char *str);
+extern char *arenaStrndup (arena *a, const char *str, size_t len);
+
+/* Releases all the memory allocated, keeping the last chunk for reuse. */
+extern void arenaReset (arena *a);
+
+/* Returns whether PTR points to memory allocated from A. */
+extern bool arenaOwns (const arena *a, const void *ptr);
+
+#endif  /* CTAGS_MAIN_ARENA_PRIVATE_H */
@@ -13,14 +13,30 @@
 #include "general.h"  /* must always come first */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#ifdef HAVE_POLL_H
+# include <poll.h>
+#endif
 
 #include "args_p.h"
 #include "debug.h"
 #include "routines.h"
+#include "routines_p.h"
 #include "vstring.h"
 
+/*
+*   DATA DECLARATIONS
+*/
+
+/* The number of lines of a list file read ahead at most while the
+ * lines are coming */
+#define LIST_READ_AHEAD_MAX 65536
+
+/* How many files ahead of the current one are prefetched */
+#define LIST_PREFETCH_DISTANCE 4
+
 /*
 *   FUNCTION DEFINITIONS
 */
@@ -288,6 +304,216 @@ static char* nextFileString (const Arguments* const current, FILE* const fp)
 	return result;
 }
 
+/*  Read ahead of a list file (-L)
+ *
+ *  The lines of a list file are read into a queue while they are
+ *  available, so the program writing to a pipe is not blocked while a
+ *  file is parsed. The contents of a file a few entries ahead are
+ *  prefetched.
+ *
+ *  An option in the list applies to the files after it. So the file
+ *  names are made unique and sorted only between options.
+ */
+
+static bool isListInputReady (FILE* const fp CTAGS_ATTR_UNUSED)
+{
+#if defined (HAVE_POLL_H) && defined (HAVE_POLL)
+	struct pollfd pfd;
+
+	pfd.fd = fileno (fp);
+	pfd.events = POLLIN;
+	pfd.revents = 0;
+	return (poll (&pfd, 1, 0) > 0);
+#else
+	return false;
+#endif
+}
+
+static bool isListOption (const char* const item)
+{
+	return (item [0] == '-');
+}
+
+static void listPush (struct sListArgs* const list, char* const item)
+{
+	if (list->head > 0 && list->count == list->size)
+	{
+		memmove (list->items, list->items + list->head,
+				 (list->count - list->head) * sizeof (char*));
+		list->count -= list->head;
+		list->head = 0;
+	}
+
+	if (list->count == list->size)
+	{
+		list->size = list->size? list->size * 2: 64;
+		list->items = xRealloc (list->items, list->size, char*);
+	}
+	list->items [list->count++] = item;
+}
+
+/* Read a line, and push it if it is not a duplicate. Returns false at
+ * the end of the file. */
+static bool listReadLine (struct sListArgs* const list)
+{
+	char* const item = nextFileLineSkippingComments (list->fp);
+
+	if (item == NULL)
+	{
+		list->eof = true;
+		return false;
+	}
+
+	if (list->order != INPUT_ORDER_GIVEN)
+	{
+		if (isListOption (item))
+			hashTableClear (list->seen);
+		else if (hashTableHasItem (list->seen, item))
+		{
+			eFree (item);
+			return true;
+		}
+		else
+		{
+			char* const key = eStrdup (item);
+			hashTablePutItem (list->seen, key, key);
+		}
+	}
+	listPush (list, item);
+	return true;
+}
+
+struct orderedFileName {
+	char* name;
+	size_t dirLength;		/* the length of the directory part of name */
+	unsigned long long ino;	/* 0 if not known */
+};
+
+static int compareFileNames (const void* a, const void* b)
+{
+	const struct orderedFileName* const f1 = a;
+	const struct orderedFileName* const f2 = b;
+	int r;
+
+	r = strncmp (f1->name, f2->name,
+				 (f1->dirLength < f2->dirLength)? f1->dirLength: f2->dirLength);
+	if (r == 0 && f1->dirLength != f2->dirLength)
+		r = (f1->dirLength < f2->dirLength)? -1: 1;
+	if (r == 0 && f1->ino != f2->ino)
+		r = (f1->ino < f2->ino)? -1: 1;
+	if (r == 0)
+		r = strcmp (f1->name + f1->dirLength, f2->name + f2->dirLength);
+	return r;
+}
+
+/*  Drop the duplicates in NAMES, and sort them as ORDER tells. The names
+ *  dropped are freed. Returns the number of the names left.
+ */
+extern unsigned int argOrderFileNames (char** const names, unsigned int count,
+									   inputOrder order)
+{
+	hashTable* seen;
+	unsigned int n = 0;
+
+	if (order == INPUT_ORDER_GIVEN)
+		return count;
+
+	seen = hashTableNew (count * 2 + 1, hashCstrhash, hashCstreq, NULL, NULL);
+	for (unsigned int i = 0; i < count; i++)
+	{
+		if (hashTableHasItem (seen, names [i]))
+			eFree (names [i]);
+		else
+		{
+			hashTablePutItem (seen, names [i], names [i]);
+			names [n++] = names [i];
+		}
+	}
+	hashTableDelete (seen);
+
+	if (order == INPUT_ORDER_DIRECTORY || order == INPUT_ORDER_INODE)
+	{
+		struct orderedFileName* const files = xMalloc (n, struct orderedFileName);
+
+		for (unsigned int i = 0; i < n; i++)
+		{
+			files [i].name = names [i];
+			files [i].dirLength = baseFilename (names [i]) - names [i];
+			files [i].ino = 0;
+			if (order == INPUT_ORDER_INODE)
+			{
+				/* Reading files in the order of their inodes reduces
+				 * the seeks of the disk on many file systems. */
+				fileStatus* const status = eStat (names [i]);
+				if (status->exists)
+					files [i].ino = status->ino;
+			}
+		}
+		qsort (files, n, sizeof (struct orderedFileName), compareFileNames);
+		for (unsigned int i = 0; i < n; i++)
+			names [i] = files [i].name;
+		eFree (files);
+	}
+	return n;
+}
+
+static void listFill (struct sListArgs* const list)
+{
+	if (list->eof)
+		return;
+
+	if (list->head == list->count)
+		list->head = list->count = 0;
+
+	if (list->order == INPUT_ORDER_DIRECTORY || list->order == INPUT_ORDER_INODE)
+	{
+		unsigned int from;
+		bool option = false;
+
+		/* Sorting needs all the file names before the next option. */
+		if (list->head < list->count)
+			return;
+		from = list->count;
+		while (listReadLine (list))
+		{
+			if (isListOption (list->items [list->count - 1]))
+			{
+				option = true;
+				break;
+			}
+		}
+		argOrderFileNames (list->items + from,
+						   list->count - from - (option? 1: 0), list->order);
+		return;
+	}
+
+	while (list->head == list->count
+		   || (list->count - list->head < LIST_READ_AHEAD_MAX
+			   && isListInputReady (list->fp)))
+	{
+		if (! listReadLine (list))
+			break;
+	}
+}
+
+static char* listNext (struct sListArgs* const list)
+{
+	char* item;
+
+	listFill (list);
+	if (list->head == list->count)
+		return NULL;
+
+	item = list->items [list->head++];
+	if (list->head + LIST_PREFETCH_DISTANCE - 1 < list->count)
+	{
+		const char* const ahead = list->items [list->head + LIST_PREFETCH_DISTANCE - 1];
+		if (! isListOption (ahead))
+			prefetchFile (ahead);
+	}
+	return item;
+}
+
 extern Arguments* argNewFromString (const char* const string)
 {
 	Arguments* result = xMalloc (1, Arguments);
@@ -330,6 +556,21 @@ extern Arguments* argNewFromLineFile (FILE* const fp)
 	return result;
 }
 
+extern Arguments* argNewFromListFile (FILE* const fp, inputOrder order)
+{
+	Arguments* result = xMalloc (1, Arguments);
+	memset (result, 0, sizeof (Arguments));
+	result->type = ARG_LIST;
+	result->lineMode = true;
+	result->u.listArgs.fp = fp;
+	result->u.listArgs.order = order;
+	if (order != INPUT_ORDER_GIVEN)
+		result->u.listArgs.seen = hashTableNew (1024, hashCstrhash, hashCstreq,
+												eFree, NULL);
+	result->item = listNext (&result->u.listArgs);
+	return result;
+}
+
 extern char *argItem (const Arguments* const current)
 {
 	Assert (current != NULL);
@@ -375,6 +616,11 @@ extern void argForth (Arguments* const current)
 				eFree (current->item);
 			current->item = nextFileString (current, current->u.fileArgs.fp);
 			break;
+		case ARG_LIST:
+			if (current->item != NULL)
+				eFree (current->item);
+			current->item = listNext (&current->u.listArgs);
+			break;
 		default:
 			Assert ("Invalid argument type" == NULL);
 			break;
@@ -385,8 +631,19 @@ extern void argDelete (Arguments* const current)
 {
 	Assert (current != NULL);
 	if ((current->type ==  ARG_STRING
-		 || current->type ==  ARG_FILE) &&  current->item != NULL)
+		 || current->type ==  ARG_FILE
+		 || current->type ==  ARG_LIST) &&  current->item != NULL)
 		eFree (current->item);
+	if (current->type == ARG_LIST)
+	{
+		struct sListArgs* const list = &current->u.listArgs;
+		for (unsigned int i = list->head; i < list->count; i++)
+			eFree (list->items [i]);
+		if (list->items)
+			eFree (list->items);
+		if (list->seen)
+			hashTableDelete (list->seen);
+	}
 	memset (current, 0, sizeof (Arguments));
 	eFree (current);
 }
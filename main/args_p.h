@@ -16,11 +16,21 @@
 
 #include <stdio.h>
 
+#include "htable.h"
+
 /*
 *   DATA DECLARATIONS
 */
 
-typedef enum { ARG_NONE, ARG_STRING, ARG_ARGV, ARG_FILE } argType;
+typedef enum { ARG_NONE, ARG_STRING, ARG_ARGV, ARG_FILE, ARG_LIST } argType;
+
+/* How the input file names are ordered */
+typedef enum {
+	INPUT_ORDER_GIVEN,		/* as given */
+	INPUT_ORDER_UNIQUE,		/* as given, skipping the names seen before */
+	INPUT_ORDER_DIRECTORY,	/* unique, and sorted by directory */
+	INPUT_ORDER_INODE,		/* unique, and sorted by directory and inode number */
+} inputOrder;
 
 typedef struct sArgs {
 	argType type;
@@ -35,6 +45,16 @@ typedef struct sArgs {
 		struct sFileArgs {
 			FILE* fp;
 		} fileArgs;
+		struct sListArgs {
+			FILE* fp;
+			bool eof;
+			inputOrder order;
+			hashTable* seen;	/* the file names seen since the last option */
+			char** items;		/* the lines read ahead */
+			unsigned int head;
+			unsigned int count;
+			unsigned int size;
+		} listArgs;
 	} u;
 	char* item;
 	bool lineMode;
@@ -47,11 +67,14 @@ extern Arguments* argNewFromString (const char* const string);
 extern Arguments* argNewFromArgv (char* const* const argv);
 extern Arguments* argNewFromFile (FILE* const fp);
 extern Arguments* argNewFromLineFile (FILE* const fp);
+extern Arguments* argNewFromListFile (FILE* const fp, inputOrder order);
 extern char *argItem (const Arguments* const current);
 extern bool argOff (const Arguments* const current);
 extern void argSetWordMode (Arguments* const current);
 extern void argSetLineMode (Arguments* const current);
 extern void argForth (Arguments* const current);
 extern void argDelete (Arguments* const current);
+extern unsigned int argOrderFileNames (char** const names, unsigned int count,
+									   inputOrder order);
 
 #endif  /* CTAGS_MAIN_ARGS_PRIVATE_H */
@@ -0,0 +1,195 @@
+/*
+*   Copyright (c) 2026, Universal Ctags Team
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License version 2 or (at your option) any later version.
+*
+*   This module implements compressed tag files: a tag file whose name
+*   ends with COMPRESSED_SUFFIX is written in gzip format.
+*
+*   The tag file is written and sorted as usual, and then replaced with
+*   its compressed form. The compressed file is a sequence of gzip
+*   members, each of them holding COMPRESS_BLOCK_SIZE bytes of the tag
+*   file at most. Any gzip implementation can decompress the file. In
+*   addition, the header of each member has an extra field with the
+*   following subfield, so a reader can seek to a member holding an
+*   offset of the tag file without decompressing the members before it:
+*
+*	SI1 'C', SI2 'T', LEN 8:
+*	  the size of the whole member (4 bytes, little endian)
+*	  the size of the data before compression (4 bytes, little endian)
+*/
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"  /* must always come first */
+
+#include <stdio.h>
+#include <string.h>
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#include "compress_p.h"
+#include "debug.h"
+#include "mio.h"
+#include "options.h"
+#include "routines.h"
+#include "vstring.h"
+
+/*
+*   DATA DECLARATIONS
+*/
+#define COMPRESSED_SUFFIX ".gz"
+#define COMPRESS_BLOCK_SIZE (64 * 1024)
+
+#define GZIP_HEADER_SIZE 24		/* with the extra field */
+#define GZIP_TRAILER_SIZE 8
+
+/*
+*   FUNCTION DEFINITIONS
+*/
+
+extern bool isCompressedTagFileName (const char *const fileName)
+{
+	const size_t length = strlen (fileName);
+	const size_t suffixLength = strlen (COMPRESSED_SUFFIX);
+
+	return (length > suffixLength
+			&& strcmp (fileName + length - suffixLength, COMPRESSED_SUFFIX) == 0);
+}
+
+extern bool isCompressedFile (const char *const fileName)
+{
+	MIO *mio = mio_new_file (fileName, "rb");
+	unsigned char magic [2];
+	bool r;
+
+	if (mio == NULL)
+		return false;
+	r = (mio_read (mio, magic, 1, 2) == 2
+		 && magic [0] == 0x1f && magic [1] == 0x8b);
+	mio_unref (mio);
+	return r;
+}
+
+#ifdef HAVE_ZLIB
+static void putLE32 (unsigned char *p, unsigned long n)
+{
+	p [0] = n & 0xff;
+	p [1] = (n >> 8) & 0xff;
+	p [2] = (n >> 16) & 0xff;
+	p [3] = (n >> 24) & 0xff;
+}
+
+static bool writeMember (MIO *const out, z_stream *const z,
+						 unsigned char *const data, const size_t length,
+						 unsigned char *const buf, const size_t bufSize)
+{
+	static const unsigned char header [] = {
+		0x1f, 0x8b,				/* ID1, ID2 */
+		8,						/* CM: deflate */
+		4,						/* FLG: FEXTRA */
+		0, 0, 0, 0,				/* MTIME */
+		0,						/* XFL */
+		255,					/* OS: unknown */
+		12, 0,					/* XLEN */
+		'C', 'T', 8, 0,			/* SI1, SI2, LEN */
+	};
+	size_t size;
+
+	if (deflateReset (z) != Z_OK)
+		return false;
+	z->next_in = data;
+	z->avail_in = (uInt) length;
+	z->next_out = buf + GZIP_HEADER_SIZE;
+	z->avail_out = (uInt) (bufSize - GZIP_HEADER_SIZE - GZIP_TRAILER_SIZE);
+	if (deflate (z, Z_FINISH) != Z_STREAM_END)
+		return false;
+
+	size = GZIP_HEADER_SIZE + z->total_out + GZIP_TRAILER_SIZE;
+	memcpy (buf, header, sizeof (header));
+	putLE32 (buf + sizeof (header), (unsigned long) size);
+	putLE32 (buf + sizeof (header) + 4, (unsigned long) length);
+	putLE32 (buf + size - GZIP_TRAILER_SIZE, crc32 (0L, data, (uInt) length));
+	putLE32 (buf + size - 4, (unsigned long) length);
+
+	return (mio_write (out, buf, 1, size) == size);
+}
+
+static bool writeCompressedFile (MIO *const in, const char *const fileName)
+{
+	MIO *out = mio_new_file (fileName, "wb");
+	z_stream z;
+	unsigned char *data;
+	unsigned char *buf;
+	size_t bufSize;
+	bool ok = true;
+
+	if (out == NULL)
+		return false;
+
+	memset (&z, 0, sizeof (z));
+	if (deflateInit2 (&z, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS,
+					  8, Z_DEFAULT_STRATEGY) != Z_OK)
+	{
+		mio_unref (out);
+		return false;
+	}
+
+	bufSize = GZIP_HEADER_SIZE + deflateBound (&z, COMPRESS_BLOCK_SIZE)
+		+ GZIP_TRAILER_SIZE;
+	data = xMalloc (COMPRESS_BLOCK_SIZE, unsigned char);
+	buf = xMalloc (bufSize, unsigned char);
+
+	/* An empty tag file is compressed to an empty member because gzip
+	 * rejects a file having no member. */
+	do
+	{
+		const size_t length = mio_read (in, data, 1, COMPRESS_BLOCK_SIZE);
+
+		ok = writeMember (out, &z, data, length, buf, bufSize);
+		if (length < COMPRESS_BLOCK_SIZE)
+			break;
+	} while (ok);
+
+	eFree (buf);
+	eFree (data);
+	deflateEnd (&z);
+	if (mio_unref (out) != 0)
+		ok = false;
+	return ok;
+}
+#endif
+
+extern void compressTagFile (const char *const tagFileName)
+{
+#ifdef HAVE_ZLIB
+	MIO *in = mio_new_file (tagFileName, "rb");
+	vString *tmp;
+	bool ok;
+
+	if (in == NULL)
+		error (FATAL | PERROR, "cannot read tag file \"%s\" for compression",
+			   tagFileName);
+
+	/* Write to a temporary file first not to leave a broken file. */
+	tmp = vStringNewInit (tagFileName);
+	vStringCatS (tmp, ".tmp");
+
+	verbose ("compressing tag file \"%s\"\n", tagFileName);
+	ok = writeCompressedFile (in, vStringValue (tmp));
+	mio_unref (in);
+	if (! ok || rename (vStringValue (tmp), tagFileName) != 0)
+	{
+		remove (vStringValue (tmp));
+		error (FATAL | PERROR, "cannot compress tag file \"%s\"", tagFileName);
+	}
+	vStringDelete (tmp);
+#else
+	error (FATAL, "cannot compress tag file \"%s\": ctags is built without zlib",
+		   tagFileName);
+#endif
+}
@@ -0,0 +1,30 @@
+/*
+*   Copyright (c) 2026, Universal Ctags Team
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License version 2 or (at your option) any later version.
+*
+*   Main part private interface to compress.c
+*/
+#ifndef CTAGS_MAIN_COMPRESS_PRIVATE_H
+#define CTAGS_MAIN_COMPRESS_PRIVATE_H
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"  /* must always come first */
+
+/*
+*   FUNCTION PROTOTYPES
+*/
+
+/* Returns true if the tag file should be compressed for its name. */
+extern bool isCompressedTagFileName (const char *const fileName);
+
+/* Returns true if the file starts with the magic of gzip. */
+extern bool isCompressedFile (const char *const fileName);
+
+/* Replaces the tag file with its compressed form. */
+extern void compressTagFile (const char *const tagFileName);
+
+#endif  /* CTAGS_MAIN_COMPRESS_PRIVATE_H */
@@ -0,0 +1,675 @@
+/*
+*   Copyright (c) 2026, Universal Ctags Team
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License version 2 or (at your option) any later version.
+*
+*   This module implements --dedup-headers option: parsing a C/C++ header,
+*   or a makefile, only once when the same contents are reachable through
+*   several paths.
+*
+*   While a header is parsed, a copy of each tag written to the tag file
+*   is recorded with a hash of the contents of the header. The copies are
+*   taken when the tags are written, so the scopes are already resolved in
+*   the cork queue, and the tags made automatically at that time, like the
+*   qualified tags, are recorded too. When another header has the same
+*   contents, the parser is not run; the recorded tags are written again
+*   with the name of the header. The input file is open at that time, so
+*   the patterns are made from the header as usual.
+*
+*   An input file given again with the same path is not even opened: the
+*   tags written for it the first time would be written again as they were.
+*
+*   --dedup-tags drops a tag before it is written if a tag with the same
+*   name, file, line, language, kind, roles, scope, and extras is written
+*   before. These are kept in a byte string for each tag written, and the
+*   byte strings are compared when their hashes are equal.
+*
+*   With --jobs, a worker process writes the byte strings of the tags of
+*   its tag file fragment, with their ranges in the fragment, to a file
+*   next to the fragment. The parent process drops the tags written before
+*   while appending the fragment, as if it wrote all the tags itself.
+*/
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"  /* must always come first */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "arena_p.h"
+#include "debug.h"
+#include "dedup_p.h"
+#include "entry_p.h"
+#include "htable.h"
+#include "options_p.h"
+#include "parse.h"
+#include "ptrarray.h"
+#include "read.h"
+#include "read_p.h"
+#include "routines.h"
+#include "routines_p.h"
+#include "trashbox.h"
+#include "vstring.h"
+#include "xtag_p.h"
+
+/*
+*   DATA DECLARATIONS
+*/
+typedef struct sDedupTag {
+	struct sDedupTag *next;
+	tagEntryInfo tag;			/* The strings are in the arena. */
+	bool sourceIsInput;			/* no #line directive applied */
+	unsigned int fieldCount;
+	tagField *fields;
+} dedupTag;
+
+typedef struct sDedupHeader {
+	unsigned long long hash;
+	size_t size;
+	langType language;
+	langType exclusiveSubparser;
+	const char *fileName;		/* the header parsed */
+	dedupTag *tags;
+	dedupTag *lastTag;
+} dedupHeader;
+
+/* An input file parsed, under its absolute path */
+typedef struct sDedupInput {
+	const char *path;
+	unsigned long long dev;
+	unsigned long long ino;
+	time_t mtime;
+} dedupInput;
+
+/* A tag written, for --dedup-tags */
+typedef struct sDedupTagKey {
+	struct sDedupTagKey *prev;	/* written before */
+	long offset;				/* in the tag file */
+	long length;				/* in the tag file, or -1 while written */
+	unsigned long long hash;	/* of the bytes */
+	size_t size;
+	const char *bytes;			/* the strings and the numbers of the tag */
+} dedupTagKey;
+
+/* The tags of a tag file fragment of --jobs; see writeTagKeysOfFragment(). */
+struct sFragmentTagKeys {
+	MIO *mio;
+	char *fileName;
+	bool pending;				/* the tag read is not taken yet */
+	long start;
+	long length;
+	char *bytes;
+	size_t allocated;
+	dedupTagKey key;
+};
+
+#define TAG_KEYS_SUFFIX ".keys"
+
+/* The anonymous names in the strings of a tag written again */
+typedef struct sAnonRenaming {
+	char from [9];
+	char to [9];
+	bool rename;
+	unsigned int used;
+	ptrArray *buffers;
+} anonRenaming;
+
+/*
+*   DATA DEFINITIONS
+*/
+static hashTable *Headers;
+static hashTable *Inputs;
+static hashTable *Tags;
+static dedupTagKey *LastTag;
+static vString *TagKeyBytes;
+static arena *DedupArena;
+static dedupHeader *Recording;
+
+/*
+*   FUNCTION DEFINITIONS
+*/
+
+static unsigned int dedupHeaderHash (const void *const key)
+{
+	const dedupHeader *h = key;
+
+	return (unsigned int) (h->hash ^ (h->hash >> 32));
+}
+
+static bool dedupHeaderEqual (const void *a, const void *b)
+{
+	const dedupHeader *ha = a;
+	const dedupHeader *hb = b;
+
+	return (ha->hash == hb->hash
+			&& ha->size == hb->size
+			&& ha->language == hb->language);
+}
+
+static unsigned int dedupTagHash (const void *const key)
+{
+	const dedupTagKey *k = key;
+
+	return (unsigned int) (k->hash ^ (k->hash >> 32));
+}
+
+static bool dedupTagEqual (const void *a, const void *b)
+{
+	const dedupTagKey *ka = a;
+	const dedupTagKey *kb = b;
+
+	return (ka->hash == kb->hash
+			&& ka->size == kb->size
+			&& memcmp (ka->bytes, kb->bytes, ka->size) == 0);
+}
+
+static void deleteDedupResources (void *data CTAGS_ATTR_UNUSED)
+{
+	hashTableDelete (Headers);
+	Headers = NULL;
+	hashTableDelete (Inputs);
+	Inputs = NULL;
+	hashTableDelete (Tags);
+	Tags = NULL;
+	LastTag = NULL;
+	vStringDelete (TagKeyBytes);
+	TagKeyBytes = NULL;
+	arenaDelete (DedupArena);
+	DedupArena = NULL;
+}
+
+static void initDedup (void)
+{
+	if (DedupArena)
+		return;
+
+	Headers = hashTableNew (256, dedupHeaderHash, dedupHeaderEqual,
+							NULL, NULL);
+	Inputs = hashTableNew (256, hashCstrhash, hashCstreq, NULL, NULL);
+	Tags = hashTableNew (1024, dedupTagHash, dedupTagEqual, NULL, NULL);
+	TagKeyBytes = vStringNew ();
+	DedupArena = arenaNew (64 * 1024);
+	DEFAULT_TRASH_BOX (&Headers, deleteDedupResources);
+}
+
+extern bool isInputFileParsedBefore (const char *const fileName,
+									 const fileStatus *const status)
+{
+	char *path;
+	dedupInput *in;
+
+	if (! Option.dedupHeaders)
+		return false;
+
+	initDedup ();
+
+	path = absoluteFilename (fileName);
+	in = hashTableGetItem (Inputs, path);
+	if (in && in->dev == status->dev && in->ino == status->ino
+		&& in->mtime == status->mtime)
+	{
+		verbose ("ignoring \"%s\" (parsed already)\n", fileName);
+		eFree (path);
+		return true;
+	}
+
+	/* A file modified or replaced since is parsed again. */
+	if (in == NULL)
+	{
+		in = arenaAlloc (DedupArena, sizeof (dedupInput));
+		in->path = arenaStrdup (DedupArena, path);
+		hashTablePutItem (Inputs, (void *) in->path, in);
+	}
+	in->dev = status->dev;
+	in->ino = status->ino;
+	in->mtime = status->mtime;
+	eFree (path);
+	return false;
+}
+
+static bool isDedupInput (const langType language)
+{
+	static const char *const names [] = { "C", "C++", "CUDA" };
+
+	/* Generated makefiles are copied into each directory of a tree;
+	 * they are not headers. */
+	if (language == getNamedLanguage ("Make", 0))
+		return true;
+
+	if (! isInputHeaderFile ())
+		return false;
+	for (unsigned int i = 0; i < ARRAY_SIZE (names); i++)
+		if (language == getNamedLanguage (names [i], 0))
+			return true;
+	return false;
+}
+
+/* Returns STR with the hash of the name of the recorded header replaced
+ * by the one of the current input file. The string returned is valid
+ * until the tag is written. */
+static const char *renameAnon (anonRenaming *anon, const char *str)
+{
+	const char *p;
+	vString *b;
+
+	if (! anon->rename || str == NULL
+		|| (p = strstr (str, anon->from)) == NULL)
+		return str;
+
+	if (anon->used == ptrArrayCount (anon->buffers))
+		ptrArrayAdd (anon->buffers, vStringNew ());
+	b = ptrArrayItem (anon->buffers, anon->used++);
+
+	vStringClear (b);
+	do
+	{
+		vStringNCatSUnsafe (b, str, p - str);
+		vStringCatS (b, anon->to);
+		str = p + strlen (anon->from);
+	}
+	while ((p = strstr (str, anon->from)) != NULL);
+	vStringCatS (b, str);
+	return vStringValue (b);
+}
+
+extern bool writeTagsOfDuplicatedHeader (const langType language,
+										 langType *exclusiveSubparser)
+{
+	const unsigned char *data;
+	dedupHeader key;
+	dedupHeader *h;
+	anonRenaming anon;
+
+	Assert (Recording == NULL);
+
+	if (! Option.dedupHeaders
+		|| ! isDedupInput (language))
+		return false;
+
+	initDedup ();
+
+	data = getInputFileData (&key.size);
+	if (data)
+		key.hash = hashBytes (HASH_BYTES_INIT, data, key.size);
+	else
+	{
+		/* A file stream is hashed block by block. */
+		unsigned char buf [BUFSIZ];
+		size_t n;
+
+		key.hash = HASH_BYTES_INIT;
+		key.size = 0;
+		while ((n = readInputFileBytes ((long) key.size, buf, sizeof (buf))) > 0)
+		{
+			key.hash = hashBytes (key.hash, buf, n);
+			key.size += n;
+		}
+	}
+	key.language = language;
+	h = hashTableGetItem (Headers, &key);
+	if (h == NULL)
+	{
+		Recording = arenaAlloc (DedupArena, sizeof (dedupHeader));
+		*Recording = key;
+		Recording->exclusiveSubparser = LANG_IGNORE;
+		Recording->fileName = arenaStrdup (DedupArena, getInputFileName ());
+		Recording->tags = NULL;
+		Recording->lastTag = NULL;
+		return false;
+	}
+
+	verbose ("using the tags of \"%s\" for \"%s\" (same contents)\n",
+			 h->fileName, getInputFileName ());
+
+	/* The names of anonymous tags are made from the name of the input
+	 * file; the ones of H are renamed for the current input file. */
+	anonHashString (h->fileName, anon.from);
+	anonHashString (getInputFileName (), anon.to);
+	anon.rename = (strcmp (anon.from, anon.to) != 0);
+	anon.buffers = ptrArrayNew ((ptrArrayDeleteFunc) vStringDelete);
+
+	for (const dedupTag *d = h->tags; d; d = d->next)
+	{
+		tagEntryInfo e = d->tag;
+
+		anon.used = 0;
+		e.inputFileName = getInputFileTagPath ();
+		if (d->sourceIsInput)
+			e.sourceFileName = e.inputFileName;
+		e.name = renameAnon (&anon, e.name);
+		e.extensionFields.scopeName = renameAnon (&anon, e.extensionFields.scopeName);
+		e.extensionFields.typeRef[1] = renameAnon (&anon, e.extensionFields.typeRef[1]);
+		e.extensionFields.signature = renameAnon (&anon, e.extensionFields.signature);
+		e.extensionFields.inheritance = renameAnon (&anon, e.extensionFields.inheritance);
+
+		e.usedParserFields = 0;
+		e.parserFieldsDynamic = NULL;
+		for (unsigned int i = 0; i < d->fieldCount; i++)
+			attachParserField (&e, false, d->fields [i].ftype,
+							   renameAnon (&anon, d->fields [i].value));
+
+		/* The cork queue is not used; the tag is written at once. */
+		makeTagEntry (&e);
+	}
+	ptrArrayDelete (anon.buffers);
+	*exclusiveSubparser = h->exclusiveSubparser;
+	return true;
+}
+
+extern void endHeaderRecording (bool keep, const langType exclusiveSubparser)
+{
+	if (Recording == NULL)
+		return;
+
+	/* The memory of a header not kept is released with the arena. */
+	if (keep)
+	{
+		Recording->exclusiveSubparser = exclusiveSubparser;
+		hashTablePutItem (Headers, Recording, Recording);
+	}
+	Recording = NULL;
+}
+
+static const char *dedupStrdup (const char *str)
+{
+	return str? arenaStrdup (DedupArena, str): NULL;
+}
+
+extern void recordHeaderTag (const tagEntryInfo *const tag)
+{
+	dedupTag *d;
+	tagEntryInfo *e;
+
+	if (Recording == NULL)
+		return;
+
+	/* Resolve the scope in the cork queue; it is gone when the tag
+	 * is written again. const is discarded for caching the result in
+	 * TAG as writers do. */
+	getTagScopeInformation ((tagEntryInfo *)tag, NULL, NULL);
+
+	d = arenaAlloc (DedupArena, sizeof (dedupTag));
+	d->next = NULL;
+	e = &d->tag;
+	*e = *tag;
+
+	e->inCorkQueue = 0;
+	e->pattern = dedupStrdup (tag->pattern);
+	e->inputFileName = NULL;
+	e->name = dedupStrdup (tag->name);
+	e->extensionFields.access = dedupStrdup (tag->extensionFields.access);
+	e->extensionFields.implementation = dedupStrdup (tag->extensionFields.implementation);
+	e->extensionFields.inheritance = dedupStrdup (tag->extensionFields.inheritance);
+	e->extensionFields.scopeName = dedupStrdup (tag->extensionFields.scopeName);
+	e->extensionFields.scopeIndex = CORK_NIL;
+	e->extensionFields.signature = dedupStrdup (tag->extensionFields.signature);
+	e->extensionFields.typeRef[0] = dedupStrdup (tag->extensionFields.typeRef[0]);
+	e->extensionFields.typeRef[1] = dedupStrdup (tag->extensionFields.typeRef[1]);
+#ifdef HAVE_LIBXML
+	e->extensionFields.xpath = dedupStrdup (tag->extensionFields.xpath);
+#endif
+
+	if (tag->extraDynamic)
+	{
+		int n = countXtags () - XTAG_COUNT;
+		e->extraDynamic = arenaAlloc (DedupArena, (n / 8) + 1);
+		memcpy (e->extraDynamic, tag->extraDynamic, (n / 8) + 1);
+	}
+
+	d->sourceIsInput = (tag->sourceFileName == tag->inputFileName
+						|| (tag->sourceFileName && tag->inputFileName
+							&& strcmp (tag->sourceFileName, tag->inputFileName) == 0));
+	e->sourceFileName = d->sourceIsInput? NULL: dedupStrdup (tag->sourceFileName);
+
+	d->fieldCount = tag->usedParserFields;
+	d->fields = d->fieldCount
+		? arenaAlloc (DedupArena, sizeof (tagField) * d->fieldCount)
+		: NULL;
+	for (unsigned int i = 0; i < d->fieldCount; i++)
+	{
+		const tagField *f = getParserFieldForIndex (tag, i);
+
+		d->fields [i].ftype = f->ftype;
+		d->fields [i].value = dedupStrdup (f->value);
+		d->fields [i].valueOwner = false;
+	}
+	e->usedParserFields = 0;
+	e->parserFieldsDynamic = NULL;
+
+	if (Recording->lastTag)
+		Recording->lastTag->next = d;
+	else
+		Recording->tags = d;
+	Recording->lastTag = d;
+}
+
+static void catTagKeyString (vString *b, const char *str)
+{
+	/* The terminator separates the strings one after another. */
+	vStringNCatSUnsafe (b, str? str: "", strlen (str? str: "") + 1);
+}
+
+#define catTagKeyNumber(B,N) vStringNCatSUnsafe ((B), (const char *) &(N), sizeof (N))
+
+/* Makes KEY for TAG. The bytes are valid until the next call. */
+static void makeTagKey (const tagEntryInfo *const tag, dedupTagKey *key)
+{
+	const char *scopeKind, *scopeName;
+	vString *b = TagKeyBytes;
+	const char fileScope = tag->isFileScope;
+
+	/* const is discarded for caching the scope in TAG as writers do. */
+	getTagScopeInformation ((tagEntryInfo *)tag, &scopeKind, &scopeName);
+
+	vStringClear (b);
+	catTagKeyString (b, tag->name);
+	catTagKeyString (b, tag->inputFileName);
+	catTagKeyString (b, tag->sourceFileName);
+	catTagKeyString (b, scopeKind);
+	catTagKeyString (b, scopeName);
+	catTagKeyNumber (b, tag->lineNumber);
+	catTagKeyNumber (b, tag->langType);
+	catTagKeyNumber (b, tag->kindIndex);
+	catTagKeyNumber (b, tag->extensionFields.roleBits);
+	catTagKeyNumber (b, fileScope);
+	/* A qualified tag may have the name of the tag it is made for. */
+	vStringNCatSUnsafe (b, (const char *) tag->extra, sizeof (tag->extra));
+	if (tag->extraDynamic)
+		vStringNCatSUnsafe (b, (const char *) tag->extraDynamic,
+							((countXtags () - XTAG_COUNT) / 8) + 1);
+
+	key->bytes = vStringValue (b);
+	key->size = vStringLength (b);
+	key->hash = hashBytes (HASH_BYTES_INIT, key->bytes, key->size);
+}
+
+/* Returns true if a tag with KEY has been written before; KEY is
+ * remembered as written at OFFSET otherwise. */
+static bool isTagKeyWrittenBefore (const dedupTagKey *const key, long offset,
+								   long length)
+{
+	dedupTagKey *k;
+	char *bytes;
+
+	if (hashTableHasItem (Tags, key))
+		return true;
+
+	bytes = arenaAlloc (DedupArena, key->size);
+	memcpy (bytes, key->bytes, key->size);
+	k = arenaAlloc (DedupArena, sizeof (dedupTagKey));
+	*k = *key;
+	k->bytes = bytes;
+	k->prev = LastTag;
+	k->offset = offset;
+	k->length = length;
+	hashTablePutItem (Tags, k, k);
+	LastTag = k;
+	return false;
+}
+
+extern bool isTagWrittenBefore (const tagEntryInfo *const tag, long offset)
+{
+	dedupTagKey key;
+
+	if (! Option.dedupTags)
+		return false;
+
+	initDedup ();
+	makeTagKey (tag, &key);
+	return isTagKeyWrittenBefore (&key, offset, -1);
+}
+
+extern void setEndOfTagWritten (long offset)
+{
+	if (LastTag && LastTag->length < 0)
+		LastTag->length = offset - LastTag->offset;
+}
+
+extern void forgetTagsWritten (void)
+{
+	/* The memory of the tags forgotten is released with the arena. */
+	if (Tags)
+		hashTableClear (Tags);
+	LastTag = NULL;
+}
+
+static char *tagKeysFileName (const char *const fragmentName)
+{
+	vString *name = vStringNewInit (fragmentName);
+
+	vStringCatS (name, TAG_KEYS_SUFFIX);
+	return vStringDeleteUnwrap (name);
+}
+
+extern void writeTagKeysOfFragment (const char *const fragmentName)
+{
+	ptrArray *keys;
+	char *fileName;
+	MIO *mio;
+
+	if (! Option.dedupTags || LastTag == NULL)
+		return;
+
+	keys = ptrArrayNew (NULL);
+	for (dedupTagKey *k = LastTag; k; k = k->prev)
+		ptrArrayAdd (keys, k);
+	ptrArrayReverse (keys);
+
+	fileName = tagKeysFileName (fragmentName);
+	mio = mio_new_file (fileName, "wb");
+	if (mio == NULL)
+		error (FATAL | PERROR, "cannot open \"%s\"", fileName);
+	for (unsigned int i = 0; i < ptrArrayCount (keys); i++)
+	{
+		const dedupTagKey *k = ptrArrayItem (keys, i);
+
+		mio_write (mio, &k->offset, sizeof (k->offset), 1);
+		mio_write (mio, &k->length, sizeof (k->length), 1);
+		mio_write (mio, &k->size, sizeof (k->size), 1);
+		mio_write (mio, k->bytes, 1, k->size);
+	}
+	if (mio_error (mio) || mio_unref (mio) != 0)
+		error (FATAL | PERROR, "cannot write \"%s\"", fileName);
+	eFree (fileName);
+	ptrArrayDelete (keys);
+}
+
+extern fragmentTagKeys *openTagKeysOfFragment (const char *const fragmentName)
+{
+	fragmentTagKeys *keys;
+	char *fileName;
+	MIO *mio;
+
+	if (! Option.dedupTags)
+		return NULL;
+
+	/* A worker writing no tag writes no keys. */
+	fileName = tagKeysFileName (fragmentName);
+	mio = mio_new_file (fileName, "rb");
+	if (mio == NULL)
+	{
+		eFree (fileName);
+		return NULL;
+	}
+
+	initDedup ();
+	keys = xCalloc (1, fragmentTagKeys);
+	keys->mio = mio;
+	keys->fileName = fileName;
+	return keys;
+}
+
+extern bool peekTagOfFragment (fragmentTagKeys *const keys,
+							   long *start, long *length)
+{
+	size_t size;
+
+	if (! keys->pending)
+	{
+		if (mio_read (keys->mio, &keys->start, sizeof (keys->start), 1) != 1)
+			return false;
+		if (mio_read (keys->mio, &keys->length, sizeof (keys->length), 1) != 1
+			|| mio_read (keys->mio, &size, sizeof (size), 1) != 1)
+			error (FATAL, "broken \"%s\"", keys->fileName);
+		if (size > keys->allocated)
+		{
+			keys->bytes = xRealloc (keys->bytes, size, char);
+			keys->allocated = size;
+		}
+		if (mio_read (keys->mio, keys->bytes, 1, size) != size)
+			error (FATAL, "broken \"%s\"", keys->fileName);
+
+		keys->key.bytes = keys->bytes;
+		keys->key.size = size;
+		keys->key.hash = hashBytes (HASH_BYTES_INIT, keys->bytes, size);
+		keys->pending = true;
+	}
+
+	*start = keys->start;
+	*length = keys->length;
+	return true;
+}
+
+extern bool isTagOfFragmentWrittenBefore (fragmentTagKeys *const keys,
+										  long offset)
+{
+	Assert (keys->pending);
+
+	keys->pending = false;
+	return isTagKeyWrittenBefore (&keys->key, offset, keys->length);
+}
+
+extern void closeTagKeysOfFragment (fragmentTagKeys *const keys)
+{
+	mio_unref (keys->mio);
+	remove (keys->fileName);
+	eFree (keys->fileName);
+	if (keys->bytes)
+		eFree (keys->bytes);
+	eFree (keys);
+}
+
+extern void removeTagKeysOfFragment (const char *const fragmentName)
+{
+	char *fileName;
+
+	if (! Option.dedupTags)
+		return;
+
+	fileName = tagKeysFileName (fragmentName);
+	remove (fileName);
+	eFree (fileName);
+}
+
+extern void forgetTagsWrittenAfter (long offset)
+{
+	/* The memory of the tags forgotten is released with the arena. */
+	while (LastTag && LastTag->offset >= offset)
+	{
+		hashTableDeleteItem (Tags, LastTag);
+		LastTag = LastTag->prev;
+	}
+}
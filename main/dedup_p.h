@@ -0,0 +1,78 @@
+/*
+*   Copyright (c) 2026, Universal Ctags Team
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License version 2 or (at your option) any later version.
+*
+*   Main part private interface to dedup.c
+*/
+#ifndef CTAGS_MAIN_DEDUP_PRIVATE_H
+#define CTAGS_MAIN_DEDUP_PRIVATE_H
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"  /* must always come first */
+
+#include "entry.h"
+#include "routines_p.h"
+#include "types.h"
+
+/*
+*   DATA DECLARATIONS
+*/
+typedef struct sFragmentTagKeys fragmentTagKeys;
+
+/*
+*   FUNCTION PROTOTYPES
+*/
+
+/* Writes the tags of the header parsed before with the same contents as
+ * the current input file, for the current input file. Returns false if
+ * no such header has been parsed; then the tags written until
+ * endHeaderRecording () is called are recorded for the current input
+ * file if it is a header. KEEP is false if the tags written are not
+ * the ones of the whole input file. */
+extern bool writeTagsOfDuplicatedHeader (const langType language,
+										 langType *exclusiveSubparser);
+extern void endHeaderRecording (bool keep, const langType exclusiveSubparser);
+
+/* Returns true if FILENAME, with STATUS, has been given as an input file
+ * before and is not modified since. */
+extern bool isInputFileParsedBefore (const char *const fileName,
+									 const fileStatus *const status);
+
+/* Returns true if --dedup-tags is given and a tag equal to TAG has been
+ * written before; TAG is remembered otherwise, as written at OFFSET of
+ * the tag file. */
+extern bool isTagWrittenBefore (const tagEntryInfo *const tag, long offset);
+/* Tells where the tag remembered last ends in the tag file. */
+extern void setEndOfTagWritten (long offset);
+/* Forgets the tags written at OFFSET of the tag file or after, when the
+ * tag file is truncated for parsing an input file again. */
+extern void forgetTagsWrittenAfter (long offset);
+/* Forgets all the tags written, when a --jobs worker starts writing its
+ * own tag file fragment. */
+extern void forgetTagsWritten (void);
+
+/* A --jobs worker writes the tags remembered for its tag file fragment
+ * FRAGMENTNAME to a file next to it. The parent reads them with
+ * openTagKeysOfFragment (), which returns NULL if there are none, while
+ * appending the fragment: peekTagOfFragment () tells the range of the
+ * next tag in the fragment, and isTagOfFragmentWrittenBefore () takes
+ * it, as isTagWrittenBefore () does for a tag written at OFFSET of the tag
+ * file. closeTagKeysOfFragment () removes the file, and
+ * removeTagKeysOfFragment () removes the one of a fragment discarded. */
+extern void writeTagKeysOfFragment (const char *const fragmentName);
+extern fragmentTagKeys *openTagKeysOfFragment (const char *const fragmentName);
+extern bool peekTagOfFragment (fragmentTagKeys *const keys,
+							   long *start, long *length);
+extern bool isTagOfFragmentWrittenBefore (fragmentTagKeys *const keys,
+										  long offset);
+extern void closeTagKeysOfFragment (fragmentTagKeys *const keys);
+extern void removeTagKeysOfFragment (const char *const fragmentName);
+
+/* Called for each tag written to the tag file. */
+extern void recordHeaderTag (const tagEntryInfo *const tag);
+
+#endif  /* CTAGS_MAIN_DEDUP_PRIVATE_H */
@@ -14,6 +14,7 @@
 
 #include "debug.h"
 #include "dependency.h"
+#include "entry.h"
 #include "options.h"
 #include "parse_p.h"
 #include "read.h"
@@ -31,6 +32,13 @@ struct slaveControlBlock {
 	subparser   *subparsersDefault;
 	subparser   *subparsersInUse;
 	langType     owner;
+
+	/* Which tags notifyMakeTagEntry () passes to the subparsers:
+	   notifyKinds [K] is true if a subparser attached or specified
+	   wants the tags of kind K. */
+	bool         notifyAllKinds;
+	bool        *notifyKinds;
+	unsigned int notifyKindCount;
 };
 
 extern void linkDependencyAtInitializeParsing (depType dtype,
@@ -56,10 +64,36 @@ extern void linkDependencyAtInitializeParsing (depType dtype,
 	}
 }
 
+static void addNotifyKinds (struct slaveControlBlock *cb, subparser *subparser)
+{
+	if (subparser->makeTagEntryNotify == NULL)
+		return;
+
+	if (subparser->makeTagEntryNotifyKinds == NULL)
+	{
+		cb->notifyAllKinds = true;
+		return;
+	}
+
+	for (const int *k = subparser->makeTagEntryNotifyKinds; *k != KIND_GHOST_INDEX; k++)
+	{
+		Assert (*k >= 0);
+		if ((unsigned int) *k >= cb->notifyKindCount)
+		{
+			cb->notifyKinds = xRealloc (cb->notifyKinds, *k + 1, bool);
+			memset (cb->notifyKinds + cb->notifyKindCount, 0,
+					(*k + 1 - cb->notifyKindCount) * sizeof (bool));
+			cb->notifyKindCount = *k + 1;
+		}
+		cb->notifyKinds [*k] = true;
+	}
+}
+
 static void attachSubparser (struct slaveControlBlock *base_sb, subparser *subparser)
 {
 	   subparser->next = base_sb->subparsersDefault;
 	   base_sb->subparsersDefault = subparser;
+	   addNotifyKinds (base_sb, subparser);
 }
 
 
@@ -72,12 +106,17 @@ extern struct slaveControlBlock *allocSlaveControlBlock (parserDefinition *parse
 	cb->subparsersDefault = NULL;
 	cb->subparsersInUse = NULL;
 	cb->owner = parser->id;
+	cb->notifyAllKinds = false;
+	cb->notifyKinds = NULL;
+	cb->notifyKindCount = 0;
 
 	return cb;
 }
 
 extern void freeSlaveControlBlock (struct slaveControlBlock *cb)
 {
+	if (cb->notifyKinds)
+		eFree (cb->notifyKinds);
 	eFree (cb);
 }
 
@@ -183,6 +222,15 @@ extern void notifyInputEnd   (void)
 extern void notifyMakeTagEntry (const tagEntryInfo *tag, int corkIndex)
 {
 	subparser *s;
+	struct slaveControlBlock *cb = getInputLanguageSlaveControlBlock ();
+
+	/* Called for every tag; most base parsers have no subparser
+	 * interested in it. */
+	if (!cb->notifyAllKinds
+		&& (tag->kindIndex < 0
+			|| (unsigned int) tag->kindIndex >= cb->notifyKindCount
+			|| !cb->notifyKinds [tag->kindIndex]))
+		return;
 
 	foreachSubparser(s, false)
 	{
@@ -229,6 +277,7 @@ extern void useSpecifiedSubparser (struct slaveControlBlock *controlBlock, subpa
 {
 	s->schedulingBaseparserExplicitly = true;
 	controlBlock->subparsersInUse = s;
+	addNotifyKinds (controlBlock, s);
 }
 
 extern void setupSubparsersInUse (struct slaveControlBlock *controlBlock)
@@ -39,25 +39,35 @@
 #include <stdint.h>
 #include <limits.h>  /* to define INT_MAX */
 
+#include "arena_p.h"
+#include "compress_p.h"
 #include "debug.h"
+#include "dedup_p.h"
 #include "entry_p.h"
 #include "field.h"
+#include "fileindex_p.h"
 #include "fmt_p.h"
+#include "htable.h"
 #include "kind.h"
+#include "nameindex_p.h"
 #include "nestlevel.h"
+#include "numarray.h"
 #include "options_p.h"
 #include "ptag_p.h"
-#include "rbtree.h"
 #include "read.h"
 #include "read_p.h"
 #include "routines.h"
 #include "routines_p.h"
 #include "parse_p.h"
 #include "ptrarray.h"
+#include "shard_p.h"
 #include "sort_p.h"
+#include "stats_p.h"
 #include "strlist.h"
 #include "subparser_p.h"
+#include "traceevent_p.h"
 #include "trashbox.h"
+#include "trigramindex_p.h"
 #include "writer_p.h"
 #include "xtag_p.h"
 
@@ -95,17 +105,111 @@ typedef struct eTagFile {
 	int cork;
 	unsigned int corkFlags;
 	ptrArray *corkQueue;
-
-	bool patternCacheValid;
+	/* Holds the entries in the cork queue and their strings. Reset
+	 * when the cork queue is flushed. */
+	arena *corkArena;
+	/* The strings interned in corkArena */
+	hashTable *corkStrings;
+	/* Maps a corkSymbol to the last entry of the name in the scope */
+	hashTable *corkSymtab;
+	/* The entries up to this index have been written */
+	unsigned int corkWritten;
+	/* The entries written since the memory was released last */
+	unsigned int corkWrittenSinceRelease;
+	/* An empty arena swapped with corkArena when the entries are released */
+	arena *corkSpareArena;
+	/* The entries up to this index have been released or kept */
+	unsigned int corkReleased;
+	/* The indexes of the entries kept when the entries are released */
+	intArray *corkKept;
+	/* The entries are written only when the cork queue is uncorked. */
+	bool corkHeld;
+
+	/* Incremented when the patterns cached are invalidated */
+	unsigned int patternCacheGeneration;
+
+	/* Set only in a --jobs worker. Holds (offset, length) pairs of
+	 * the pseudo tags written to the fragment. */
+	longArray *ptagRanges;
+
+	/* The bytes at the head of the tag file appended to, sorted already
+	 * as the tag file is going to be; 0 if the whole file is sorted. */
+	long sortedSize;
+
+	/* The size of the tag file appended to, before the tags are added. */
+	long appendedSize;
 } tagFile;
 
+/* The key of an entry in the symbol table of its scope */
+typedef struct sCorkSymbol {
+	int scopeIndex;
+	const char *name;
+} corkSymbol;
+
 typedef struct sTagEntryInfoX  {
 	tagEntryInfo slot;
 	int corkIndex;
-	struct rb_root symtab;
-	struct rb_node symnode;
+	/* The entries registered to the symbol table of this entry as their
+	 * scope, in no particular order. */
+	struct sTagEntryInfoX *members;
+	/* Set while this entry is in the symbol table of its scope. */
+	bool registered;
+	corkSymbol symkey;
+	/* The next entry having the same name in the same scope. The entries
+	 * of the same name are ordered by line number and address, from the
+	 * last one. */
+	struct sTagEntryInfoX *symNext;
+	/* Link the members of the scope. */
+	struct sTagEntryInfoX *memberPrev, *memberNext;
+	/* The full qualified name of this entry, used for the scope names of
+	 * its children. NULL until it is needed. */
+	char *fqName;
+	/* Set with closeCorkEntry () and closeCorkScope () */
+	bool closed;
+	/* Set if this entry or its scope is closed with closeCorkScope () */
+	bool sealed;
+	/* The copy of this entry made when the cork queue is released */
+	struct sTagEntryInfoX *moved;
 } tagEntryInfoX;
 
+/* A reference tag having no field but its scope and the ones every tag
+ * has is put in the cork queue as this record, a fraction of the size
+ * of a tagEntryInfoX, with the lowest bit of the pointer set. It is
+ * written without making the whole entry, which is made only when a
+ * parser or the cork queue needs it; see getCorkEntry (). */
+typedef struct sCorkRef {
+	const char *name;
+	const char *inputFileName;
+	const char *sourceFileName;
+	const char *scopeName;
+	unsigned long lineNumber;
+	unsigned long sourceLineNumberDifference;
+	MIOPos filePosition;
+	roleBitsType roleBits;
+	int kindIndex;
+	int scopeIndex;
+	int scopeKindIndex;
+	langType scopeLangType;
+	langType langType;
+	langType sourceLangType;
+	unsigned int boundaryInfo;
+	uint8_t extra[ ((XTAG_COUNT) / 8) + 1 ];
+	unsigned int lineNumberEntry:1;
+	unsigned int isFileScope    :1;
+} corkRef;
+
+#define CORK_REF_BIT ((uintptr_t) 1)
+
+static bool isCorkRef (const void *item)
+{
+	return ((uintptr_t) item & CORK_REF_BIT) != 0;
+}
+
+static corkRef *corkRefOf (void *item)
+{
+	return (corkRef *) ((uintptr_t) item & ~CORK_REF_BIT);
+}
+
 /*
 *   DATA DEFINITIONS
 */
@@ -119,11 +223,44 @@ static tagFile TagFile = {
     NULL,                /* vLine */
     .cork = false,
     .corkQueue = NULL,
-    .patternCacheValid = false,
+    .corkArena = NULL,
+    .corkStrings = NULL,
+    .corkSymtab = NULL,
+    .corkWritten = 0,
+    .corkWrittenSinceRelease = 0,
+    .corkSpareArena = NULL,
+    .corkReleased = 0,
+    .corkKept = NULL,
+    .corkHeld = false,
+    .patternCacheGeneration = 1,
+    .ptagRanges = NULL,
 };
 
 static bool TagsToStdout = false;
 
+/* With --sort-in-memory, the tag lines are kept in a memory stream and
+ * written to the destination only once, after sorting. */
+static bool TagsInMemory = false;
+
+/* The tag file is compressed after it is closed. */
+static bool TagFileCompressed = false;
+
+/* The paths, as written in the input field, of the input files whose
+ * tags in the tag file appended to are dropped; see --update-from. */
+static hashTable *DroppedInputs = NULL;
+
+/* With startTagFileStream (), the tag lines in the memory stream are
+ * sent to stdout in chunks of about TAG_STREAM_CHUNK_SIZE bytes while
+ * parsing. SENT is the number of bytes sent. */
+#define TAG_STREAM_CHUNK_SIZE 4096
+static struct {
+	void (* retract) (void);
+	long sent;
+} TagStream;
+
+/* Pseudo tags already taken from fragments; see appendTagFileFragment(). */
+static hashTable *FragmentPtags = NULL;
+
 /*
 *   FUNCTION PROTOTYPES
 */
@@ -144,6 +281,21 @@ extern void freeTagFileResources (void)
 	if (TagFile.directory != NULL)
 		eFree (TagFile.directory);
 	vStringDelete (TagFile.vLine);
+	if (TagFile.corkArena)
+		arenaDelete (TagFile.corkArena);
+	if (TagFile.corkStrings)
+		hashTableDelete (TagFile.corkStrings);
+	if (TagFile.corkSymtab)
+		hashTableDelete (TagFile.corkSymtab);
+	if (TagFile.corkSpareArena)
+		arenaDelete (TagFile.corkSpareArena);
+	if (TagFile.corkKept)
+		intArrayDelete (TagFile.corkKept);
+	if (DroppedInputs)
+	{
+		hashTableDelete (DroppedInputs);
+		DroppedInputs = NULL;
+	}
 }
 
 extern const char *tagFileName (void)
@@ -247,10 +399,38 @@ static void updateSortedFlag (
 	}
 }
 
+/*  Counts the lines from the current position of MIO to its end, by
+ *  blocks instead of line by line. A last line without newline counts.
+ */
+static unsigned long countRemainingLines (MIO *const mio)
+{
+	enum { blockSize = 64 * 1024 };
+	char *const block = xMalloc (blockSize, char);
+	unsigned long lines = 0;
+	size_t size;
+	char last = '\n';
+
+	while ((size = mio_read (mio, block, 1, blockSize)) > 0)
+	{
+		const char *p = block;
+		const char *const end = block + size;
+
+		while ((p = memchr (p, '\n', end - p)) != NULL)
+		{
+			++lines;
+			++p;
+		}
+		last = end [-1];
+	}
+	eFree (block);
+	return lines + (last != '\n'? 1: 0);
+}
+
 /*  Look through all line beginning with "!_TAG_FILE", and update those which
- *  require it.
+ *  require it. The lines of the tag file are counted only when --totals
+ *  shows them.
  */
-static long unsigned int updatePseudoTags (MIO *const mio)
+static long unsigned int updatePseudoTags (MIO *const mio, int *sortedFlag)
 {
 	enum { maxEntryLength = 20 };
 	char entry [maxEntryLength + 1];
@@ -276,17 +456,19 @@ static long unsigned int updatePseudoTags (MIO *const mio)
 				tab == '\t')
 			{
 				if (strcmp (classType, "_SORTED") == 0)
+				{
+					*sortedFlag = line [entryLength + strlen (classType) + 1];
 					updateSortedFlag (line, mio, startOfLine);
+				}
 			}
 			mio_getpos (mio, &startOfLine);
 		}
 		line = readLineRaw (TagFile.vLine, mio);
 	}
-	while (line != NULL)  /* skip to end of file */
-	{
-		++linesRead;
-		line = readLineRaw (TagFile.vLine, mio);
-	}
+	/* The lines after the pseudo tags are counted only for --totals;
+	 * appending doesn't need them read. */
+	if (line != NULL && Option.printTotals)
+		linesRead += 1 + countRemainingLines (mio);
 	return linesRead;
 }
 
@@ -375,14 +557,61 @@ static bool isTagFile (const char *const filename)
 		else
 			ok = (bool) (isCtagsLine (line) || isEtagsLine (line));
 		mio_unref (mio);
+		if (! ok && isCompressedTagFileName (filename))
+			ok = isCompressedFile (filename);
 	}
 	return ok;
 }
 
+/*  Returns the size of the tag file being appended to if the new tags
+ *  can be merged with it instead of sorting the whole file again: it
+ *  must be sorted already the way it is going to be, and end with a
+ *  newline. SORTEDFLAG is the value of its TAG_FILE_SORTED pseudo tag.
+ */
+static long getSortedSizeOfTagFile (MIO *const mio, int sortedFlag)
+{
+	long size;
+
+	if (Option.sorted == SO_UNSORTED
+		|| sortedFlag != '0' + (int) Option.sorted
+		|| writerSortsEntries ()
+		|| TagFileCompressed)
+		return 0;
+	/* "sort -u -f" also drops the lines differing only in case, which
+	 * the merge doesn't. */
+	if (Option.sortMethod != SORT_METHOD_INTERNAL
+		&& Option.sorted == SO_FOLDSORTED)
+		return 0;
+
+	if (mio_seek (mio, -1L, SEEK_END) != 0 || mio_getc (mio) != '\n')
+		return 0;
+	size = mio_tell (mio);
+	return (size > 0)? size: 0;
+}
+
+extern MIO *newTagFileOutput (const char *const fileName, const char *const mode)
+{
+	MIO *mio = mio_new_file (fileName, mode);
+
+	if (mio != NULL)
+		mio_file_set_buffer_size (mio, TAG_FILE_BUFFER_SIZE);
+	return mio;
+}
+
 extern void openTagFile (void)
 {
 	setDefaultTagFileName ();
+	TagFile.sortedSize = 0;
+	TagFile.appendedSize = 0;
 	TagsToStdout = isDestinationStdout ();
+	TagFileCompressed = (! TagsToStdout
+						 && isCompressedTagFileName (Option.tagFileName));
+	TagsInMemory = (Option.sortInMemory
+					&& Option.sorted != SO_UNSORTED
+					&& ! writerSortsEntries ()
+					&& ! Option.etags
+					&& ! (Option.append && ! TagsToStdout
+						  && doesFileExist (Option.tagFileName)));
 
 	if (TagFile.vLine == NULL)
 		TagFile.vLine = vStringNew ();
@@ -391,13 +620,18 @@ extern void openTagFile (void)
 	 */
 	if (TagsToStdout)
 	{
-		if (Option.interactive == INTERACTIVE_SANDBOX)
+		/* The interactive mode opens the tag file for each request;
+		 * don't make a temporary file each time. */
+		if (Option.interactive || TagsInMemory)
 		{
 			TagFile.mio = mio_new_memory (NULL, 0, eRealloc, eFreeNoNullCheck);
 			TagFile.name = NULL;
 		}
 		else
+		{
 			TagFile.mio = tempFile ("w+", &TagFile.name);
+			mio_file_set_buffer_size (TagFile.mio, TAG_FILE_BUFFER_SIZE);
+		}
 		if (isXtagEnabled (XTAG_PSEUDO_TAGS))
 			addCommonPseudoTags ();
 	}
@@ -411,13 +645,15 @@ extern void openTagFile (void)
 			error (FATAL,
 			  "\"%s\" doesn't look like a tag file; I refuse to overwrite it.",
 				  TagFile.name);
+		if (Option.shardBy != SHARD_BY_NONE)
+			loadShardManifest (TagFile.name);
 
 		if (Option.etags)
 		{
 			if (Option.append  &&  fileExists)
-				TagFile.mio = mio_new_file (TagFile.name, "a+b");
+				TagFile.mio = newTagFileOutput (TagFile.name, "a+b");
 			else
-				TagFile.mio = mio_new_file (TagFile.name, "w+b");
+				TagFile.mio = newTagFileOutput (TagFile.name, "w+b");
 		}
 		else
 		{
@@ -426,14 +662,25 @@ extern void openTagFile (void)
 				TagFile.mio = mio_new_file (TagFile.name, "r+");
 				if (TagFile.mio != NULL)
 				{
-					TagFile.numTags.prev = updatePseudoTags (TagFile.mio);
+					int sortedFlag = EOF;
+
+					TagFile.numTags.prev = updatePseudoTags (TagFile.mio, &sortedFlag);
+					TagFile.sortedSize = getSortedSizeOfTagFile (TagFile.mio, sortedFlag);
+					if (mio_seek (TagFile.mio, 0L, SEEK_END) == 0)
+						TagFile.appendedSize = mio_tell (TagFile.mio);
 					mio_unref (TagFile.mio);
-					TagFile.mio = mio_new_file (TagFile.name, "a+");
+					TagFile.mio = newTagFileOutput (TagFile.name, "a+");
 				}
 			}
 			else
 			{
-				TagFile.mio = mio_new_file (TagFile.name, "w");
+				if (TagsInMemory)
+					TagFile.mio = mio_new_memory (NULL, 0, eRealloc, eFreeNoNullCheck);
+				else
+					/* --cache-file and --cache-dir read back what is written. */
+					TagFile.mio = newTagFileOutput (TagFile.name,
+													(Option.cacheFileName
+													 || Option.cacheDirName)? "w+": "w");
 				if (TagFile.mio != NULL && isXtagEnabled (XTAG_PSEUDO_TAGS))
 					addCommonPseudoTags ();
 			}
@@ -453,25 +700,6 @@ extern void openTagFile (void)
 
 #ifdef USE_REPLACEMENT_TRUNCATE
 
-static void copyBytes (MIO* const fromMio, MIO* const toMio, const long size)
-{
-	enum { BufferSize = 1000 };
-	long toRead, numRead;
-	char* buffer = xMalloc (BufferSize, char);
-	long remaining = size;
-	do
-	{
-		toRead = (0 < remaining && remaining < BufferSize) ?
-					remaining : (long) BufferSize;
-		numRead = mio_read (fromMio, buffer, (size_t) 1, (size_t) toRead);
-		if (mio_write (toMio, buffer, (size_t)1, (size_t)numRead) < (size_t)numRead)
-			error (FATAL | PERROR, "cannot complete write");
-		if (remaining > 0)
-			remaining -= numRead;
-	} while (numRead == toRead  &&  remaining != 0);
-	eFree (buffer);
-}
-
 static void copyFile (const char *const from, const char *const to, const long size)
 {
 	MIO* const fromMio = mio_new_file (from, "rb");
@@ -484,7 +712,7 @@ static void copyFile (const char *const from, const char *const to, const long s
 			error (FATAL | PERROR, "cannot open copy destination");
 		else
 		{
-			copyBytes (fromMio, toMio, size);
+			copyMioBytes (fromMio, toMio, size);
 			mio_unref (toMio);
 		}
 		mio_unref (fromMio);
@@ -495,25 +723,130 @@ static void copyFile (const char *const from, const char *const to, const long s
  */
 static int replacementTruncate (const char *const name, const long size)
 {
-#define WHOLE_FILE  -1L
-	char *tempName = NULL;
-	MIO *mio = tempFile ("w", &tempName);
-	mio_unref (mio);
-	copyFile (name, tempName, size);
-	copyFile (tempName, name, WHOLE_FILE);
-	remove (tempName);
-	eFree (tempName);
+	vString *tempName = vStringNewInit (name);
+	int result = 0;
+
+	/* Copy the part kept next to the file and rename it into place
+	 * instead of copying it back. */
+	vStringCatS (tempName, ".tmp");
+	copyFile (name, vStringValue (tempName), size);
+	if (rename (vStringValue (tempName), name) != 0)
+	{
+		/* rename () of some systems does not replace an existing file. */
+		if (remove (name) != 0)
+		{
+			remove (vStringValue (tempName));
+			result = -1;
+		}
+		else if (rename (vStringValue (tempName), name) != 0)
+			result = -1;
+	}
+	vStringDelete (tempName);
 
-	return 0;
+	return result;
 }
 
 #endif
 
-#ifndef EXTERNAL_SORT
+/*  Sorts the tags appended to the tag file and merges them with the
+ *  part sorted already, in one pass over the file. Returns false if
+ *  the file must be sorted as a whole because that part was not sorted.
+ */
+static bool mergeAppendedTags (void)
+{
+	vString *tmp = vStringNewInit (tagFileName ());
+	MIO *mio = mio_new_file (tagFileName (), "r");
+	bool ordered;
+
+	if (mio == NULL || mio_seek (mio, TagFile.sortedSize, SEEK_SET) != 0)
+		failedSort (mio, NULL);
+
+	/* Write to a temporary file first not to leave a broken file. */
+	vStringCatS (tmp, ".tmp");
+	ordered = internalMergeTags (mio, tagFileName (), TagFile.sortedSize,
+								 DroppedInputs, vStringValue (tmp));
+	mio_unref (mio);
+	if (rename (vStringValue (tmp), tagFileName ()) != 0)
+	{
+		remove (vStringValue (tmp));
+		failedSort (NULL, NULL);
+	}
+	vStringDelete (tmp);
+
+	if (! ordered)
+		verbose ("the tag file was not sorted; sorting it as a whole\n");
+	return ordered;
+}
+
+extern void dropTagsOfInputFile (const char *const fileName)
+{
+	const char *tagPath = getTagPath (fileName);
+	vString *escaped;
+
+	if (DroppedInputs == NULL)
+		DroppedInputs = hashTableNew (64, hashCstrhash, hashCstreq, eFree, NULL);
+
+	if (! hashTableHasItem (DroppedInputs, tagPath))
+		hashTablePutItem (DroppedInputs, eStrdup (tagPath), DroppedInputs);
+
+	/* u-ctags writes the path escaped, e-ctags as is. */
+	escaped = vStringNew ();
+	vStringCatSWithEscaping (escaped, tagPath);
+	if (strcmp (vStringValue (escaped), tagPath) != 0
+		&& ! hashTableHasItem (DroppedInputs, vStringValue (escaped)))
+		hashTablePutItem (DroppedInputs, vStringDeleteUnwrap (escaped), DroppedInputs);
+	else
+		vStringDelete (escaped);
+}
+
+/*  Copies the tag file leaving out the lines of the dropped input files
+ *  in the part that was there before appending, when the lines are not
+ *  merged with the tags added.
+ */
+static void dropTagLinesOfInputs (void)
+{
+	vString *tmp = vStringNewInit (tagFileName ());
+	vString *line = vStringNew ();
+	vString *input = vStringNew ();
+	MIO *in = mio_new_file (tagFileName (), "r");
+	MIO *out;
+	unsigned long dropped = 0;
+
+	vStringCatS (tmp, ".tmp");
+	out = newTagFileOutput (vStringValue (tmp), "w");
+	if (in == NULL || out == NULL)
+		error (FATAL | PERROR, "cannot drop tags from tag file");
+
+	while (mio_tell (in) < TagFile.appendedSize
+		   && readLineRaw (line, in) != NULL)
+	{
+		if (isTagLineOfInputs (vStringValue (line), DroppedInputs, input))
+			dropped++;
+		else if (mio_write (out, vStringValue (line), 1, vStringLength (line))
+				 != vStringLength (line))
+			error (FATAL | PERROR, "cannot write tag file");
+	}
+	copyMioBytes (in, out, LONG_MAX);
+	mio_unref (in);
+
+	if (mio_unref (out) != 0
+		|| rename (vStringValue (tmp), tagFileName ()) != 0)
+	{
+		remove (vStringValue (tmp));
+		error (FATAL | PERROR, "cannot drop tags from tag file");
+	}
+	verbose ("dropped %lu tags of the files updated\n", dropped);
+
+	vStringDelete (input);
+	vStringDelete (line);
+	vStringDelete (tmp);
+}
+
 static void internalSortTagFile (void)
 {
 	MIO *mio;
 
+
 	/*  Open/Prepare the tag file and place its lines into allocated buffers.
 	 */
 	if (TagsToStdout)
@@ -528,27 +861,64 @@ static void internalSortTagFile (void)
 			failedSort (mio, NULL);
 	}
 
-	internalSortTags (TagsToStdout,
-			  mio,
-			  TagFile.numTags.added + TagFile.numTags.prev);
+	internalSortTags (TagsToStdout, mio);
 
 	if (! TagsToStdout)
 		mio_unref (mio);
 }
-#endif
 
-static void sortTagFile (void)
+static void sortTagFileInMemory (void)
 {
+	size_t size;
+	unsigned char *data = mio_memory_get_data (TagFile.mio, &size);
+
 	if (TagFile.numTags.added > 0L)
 	{
+		verbose ("sorting tag file in memory\n");
+		internalSortTagBuffer (TagsToStdout, (char *) data, size);
+	}
+	else if (TagsToStdout)
+		catFile (TagFile.mio);
+	else
+	{
+		MIO *mio = newTagFileOutput (TagFile.name, "w");
+
+		if (mio == NULL || mio_write (mio, data, 1, size) != size)
+			error (FATAL | PERROR, "cannot write tag file");
+		if (mio_unref (mio) != 0)
+			error (FATAL | PERROR, "cannot close tag file");
+	}
+}
+
+static void sortTagFile (void)
+{
+	const bool dropping = (DroppedInputs != NULL && TagFile.appendedSize > 0);
+
+	if (writerSortsEntries ())
+	{
+		if (TagsToStdout)
+			catFile (TagFile.mio);
+	}
+	else if (TagFile.numTags.added > 0L || dropping)
+	{
+		/* The merge drops the lines itself. */
+		if (dropping && TagFile.sortedSize == 0)
+			dropTagLinesOfInputs ();
+
 		if (Option.sorted != SO_UNSORTED)
 		{
 			verbose ("sorting tag file\n");
+			if (TagFile.sortedSize > 0 && mergeAppendedTags ())
+				return;
+			/* Only lines of the old part were dropped. */
+			if (TagFile.numTags.added == 0L && TagFile.sortedSize == 0)
+				return;
 #ifdef EXTERNAL_SORT
-			externalSortTags (TagsToStdout, TagFile.mio);
-#else
-			internalSortTagFile ();
+			if (Option.sortMethod == SORT_METHOD_EXTERNAL)
+				externalSortTags (TagsToStdout, TagFile.mio);
+			else
 #endif
+				internalSortTagFile ();
 		}
 		else if (TagsToStdout)
 			catFile (TagFile.mio);
@@ -605,19 +975,45 @@ static void writeEtagsIncludes (MIO *const mio)
 	}
 }
 
+extern void startTagFileStream (void (* retract) (void))
+{
+	/* Only the tag lines kept in memory for stdout can be streamed. */
+	if (TagsToStdout && TagFile.name == NULL && ! TagsInMemory)
+	{
+		TagStream.retract = retract;
+		TagStream.sent = 0;
+	}
+}
+
+static void sendTagStream (void)
+{
+	size_t size;
+	unsigned char *data = mio_memory_get_data (TagFile.mio, &size);
+	long end = mio_tell (TagFile.mio);
+
+	if (end > TagStream.sent)
+	{
+		fwrite (data + TagStream.sent, 1, end - TagStream.sent, stdout);
+		fflush (stdout);
+		TagStream.sent = end;
+	}
+}
+
 extern void closeTagFile (const bool resize)
 {
 	long desiredSize, size;
 
 	if (Option.etags)
 		writeEtagsIncludes (TagFile.mio);
+	writerFinishOutput (TagFile.mio);
 	mio_flush (TagFile.mio);
 
+
 	abort_if_ferror (TagFile.mio);
 	desiredSize = mio_tell (TagFile.mio);
 	mio_seek (TagFile.mio, 0L, SEEK_END);
 	size = mio_tell (TagFile.mio);
-	if (! TagsToStdout)
+	if (! TagsToStdout && ! TagsInMemory)
 		/* The tag file should be closed before resizing. */
 		if (mio_unref (TagFile.mio) != 0)
 			error (FATAL | PERROR, "cannot close tag file");
@@ -627,10 +1023,32 @@ extern void closeTagFile (const bool resize)
 		DebugStatement (
 			debugPrintf (DEBUG_STATUS, "shrinking %s from %ld to %ld bytes\n",
 				TagFile.name? TagFile.name: "<mio>", size, desiredSize); )
-		resizeTagFile (desiredSize);
+		if (TagsInMemory)
+			mio_try_resize (TagFile.mio, desiredSize);
+		else
+			resizeTagFile (desiredSize);
 	}
-	sortTagFile ();
-	if (TagsToStdout)
+	if (TagsInMemory)
+	{
+		sortTagFileInMemory ();
+		if (mio_unref (TagFile.mio) != 0)
+			error (FATAL | PERROR, "cannot close tag file");
+	}
+	else if (TagStream.retract)
+	{
+		/* The streamed tag lines are not sorted. */
+		sendTagStream ();
+		TagStream.retract = NULL;
+	}
+	else
+	{
+		const timingPhase phase = enterTimingPhase (PHASE_SORT);
+		beginTraceEvent (TRACE_PHASE, "sort");
+		sortTagFile ();
+		endTraceEvent (TRACE_PHASE);
+		leaveTimingPhase (phase);
+	}
+	if (TagsToStdout && ! TagsInMemory)
 	{
 		if (mio_unref (TagFile.mio) != 0)
 			error (FATAL | PERROR, "cannot close tag file");
@@ -638,10 +1056,384 @@ extern void closeTagFile (const bool resize)
 			remove (TagFile.name);  /* remove temporary file */
 	}
 
+	/* Nothing was sorted if no tag was added. */
+	discardSortedTagFiles ();
+
+	if (Option.nameIndex && ! TagsToStdout)
+		writeNameIndex (TagFile.name);
+	if (Option.trigramIndex && ! TagsToStdout)
+		writeTrigramIndex (TagFile.name);
+	if (Option.fileIndex && ! TagsToStdout)
+		writeFileIndex (TagFile.name);
+	if (Option.shardBy != SHARD_BY_NONE && ! TagsToStdout)
+		writeShards (TagFile.name);
+	if (TagFileCompressed)
+		compressTagFile (TagFile.name);
+
 	TagFile.mio = NULL;
 	if (TagFile.name)
 		eFree (TagFile.name);
 	TagFile.name = NULL;
+
+	if (FragmentPtags)
+	{
+		hashTableDelete (FragmentPtags);
+		FragmentPtags = NULL;
+	}
+}
+
+/*
+ *  Tag lines for --cache-file
+ */
+extern long getTagFileOffset (void)
+{
+	return mio_tell (TagFile.mio);
+}
+
+extern void readTagFileRange (const long start, vString *const lines)
+{
+	long end;
+	size_t size;
+
+	mio_flush (TagFile.mio);
+	abort_if_ferror (TagFile.mio);
+	end = mio_tell (TagFile.mio);
+	size = (size_t) (end - start);
+
+	vStringClear (lines);
+	vStringResize (lines, size + 1);
+	if (mio_seek (TagFile.mio, start, SEEK_SET) != 0
+		|| mio_read (TagFile.mio, vStringValue (lines), 1, size) != size
+		|| mio_seek (TagFile.mio, end, SEEK_SET) != 0)
+		error (FATAL | PERROR, "cannot read back tag file");
+	vStringLength (lines) = size;
+	vStringValue (lines) [size] = '\0';
+}
+
+extern void writeTagFileLines (const char *const lines, const size_t size,
+							   const unsigned long count)
+{
+	if (mio_write (TagFile.mio, lines, 1, size) != size)
+		error (FATAL | PERROR, "cannot write tag file");
+	TagFile.numTags.added += count;
+}
+
+/*
+ *  Tag file fragments (--jobs)
+ *
+ *  A worker process redirects its output to a private fragment file.
+ *  The parent appends the fragments to the real tag file in the order
+ *  the input files were given, so the result is the same as the one
+ *  made by a single process.
+ */
+extern void redirectTagFile (const char *const fileName)
+{
+	/* The stream of the real tag file is shared with the parent
+	 * process. Just forget it here. */
+	TagFile.mio = newTagFileOutput (fileName, "w+");
+	if (TagFile.mio == NULL)
+		error (FATAL | PERROR, "cannot open tag file fragment \"%s\"", fileName);
+
+	TagFile.name = eStrdup (fileName);
+	TagFile.numTags.added = 0;
+	TagFile.max.line = 0;
+	TagFile.max.tag = 0;
+	TagFile.patternCacheGeneration++;
+	TagFile.ptagRanges = longArrayNew ();
+	/* The parent drops the tags of the fragment written before. */
+	forgetTagsWritten ();
+}
+
+extern void closeRedirectedTagFile (tagFileFragment *const fragment)
+{
+	mio_flush (TagFile.mio);
+	abort_if_ferror (TagFile.mio);
+
+	fragment->size = mio_tell (TagFile.mio);
+	fragment->added = TagFile.numTags.added;
+	fragment->maxLine = TagFile.max.line;
+	fragment->maxTag = TagFile.max.tag;
+	fragment->ptagRanges = TagFile.ptagRanges;
+	fragment->sorted = false;
+	TagFile.ptagRanges = NULL;
+	writeTagKeysOfFragment (TagFile.name);
+
+	if (mio_unref (TagFile.mio) != 0)
+		error (FATAL | PERROR, "cannot close tag file fragment");
+	TagFile.mio = NULL;
+	eFree (TagFile.name);
+	TagFile.name = NULL;
+}
+
+/* Copies the bytes of a tag file fragment MIO from OFFSET to END to the
+ * tag file, and drops the tags of KEYS written before (--dedup-tags).
+ * DROPPED counts the tags dropped. */
+static void copyFragmentBytes (MIO *mio, long offset, const long end,
+							   fragmentTagKeys *keys, unsigned long *dropped)
+{
+	long start, length;
+
+	while (keys && offset < end && peekTagOfFragment (keys, &start, &length)
+		   && start + length <= end)
+	{
+		if (start > offset)
+			copyMioBytes (mio, TagFile.mio, start - offset);
+		if (isTagOfFragmentWrittenBefore (keys, mio_tell (TagFile.mio)))
+		{
+			if (mio_seek (mio, length, SEEK_CUR) != 0)
+				error (FATAL | PERROR, "cannot read tag file fragment");
+			(*dropped)++;
+		}
+		else
+			copyMioBytes (mio, TagFile.mio, length);
+		offset = start + length;
+	}
+	if (end > offset)
+		copyMioBytes (mio, TagFile.mio, end - offset);
+}
+
+extern void appendTagFileFragment (const char *const fileName,
+								   const tagFileFragment *const fragment)
+{
+	MIO *mio = mio_new_file (fileName, "r");
+	fragmentTagKeys *keys = NULL;
+	unsigned long dropped = 0;
+	long offset = 0;
+
+	if (mio == NULL)
+		error (FATAL | PERROR, "cannot open tag file fragment \"%s\"", fileName);
+
+	/* The offsets of the tags are lost when a fragment is sorted, so a
+	 * worker doesn't sort it with --dedup-tags. */
+	if (!fragment->sorted)
+		keys = openTagKeysOfFragment (fileName);
+
+	if (FragmentPtags == NULL)
+		FragmentPtags = hashTableNew (31, hashCstrhash, hashCstreq, eFree, NULL);
+
+	/* Parser specific pseudo tags are written by each worker that
+	 * parses a file of the language. Keep only the first one. */
+	for (unsigned int i = 0; i + 1 < longArrayCount (fragment->ptagRanges); i += 2)
+	{
+		const long start = longArrayItem (fragment->ptagRanges, i);
+		const long length = longArrayItem (fragment->ptagRanges, i + 1);
+		char *ptag;
+
+		if (start < offset || start + length > fragment->size)
+			continue;
+
+		copyFragmentBytes (mio, offset, start, keys, &dropped);
+
+		ptag = xMalloc (length + 1, char);
+		if (mio_read (mio, ptag, 1, (size_t) length) != (size_t) length)
+			error (FATAL | PERROR, "cannot read tag file fragment \"%s\"", fileName);
+		ptag [length] = '\0';
+
+		if (hashTableHasItem (FragmentPtags, ptag))
+		{
+			eFree (ptag);
+			dropped++;
+		}
+		else
+		{
+			if (TagFile.ptagRanges)
+			{
+				longArrayAdd (TagFile.ptagRanges, mio_tell (TagFile.mio));
+				longArrayAdd (TagFile.ptagRanges, length);
+			}
+			mio_puts (TagFile.mio, ptag);
+			hashTablePutItem (FragmentPtags, ptag, ptag);
+		}
+		offset = start + length;
+	}
+	if (fragment->sorted)
+		addSortedTagFile (fileName, offset, true);
+	else
+		copyFragmentBytes (mio, offset, fragment->size, keys, &dropped);
+	abort_if_ferror (TagFile.mio);
+	mio_unref (mio);
+	if (keys)
+		closeTagKeysOfFragment (keys);
+
+	TagFile.numTags.added += fragment->added - dropped;
+	if (fragment->maxLine > TagFile.max.line)
+		TagFile.max.line = fragment->maxLine;
+	if (fragment->maxTag > TagFile.max.tag)
+		TagFile.max.tag = fragment->maxTag;
+}
+
+extern bool canSortTagFileFragments (void)
+{
+	return (Option.sorted != SO_UNSORTED && ! writerSortsEntries ()
+			&& (TagsInMemory || Option.sortMethod == SORT_METHOD_INTERNAL));
+}
+
+extern void sortTagFileFragment (const char *const fileName,
+								 tagFileFragment *const fragment)
+{
+	unsigned int count = longArrayCount (fragment->ptagRanges);
+	char *data, *body;
+	size_t bodySize = 0;
+	long offset = 0;
+	longArray *ptagRanges;
+	MIO *mio;
+
+	/* The fragment is read into the memory. */
+	if (fragment->size == 0 || (size_t) fragment->size > Option.sortMemoryLimit)
+		return;
+
+	ptagRanges = longArrayNew ();
+	data = xMalloc (fragment->size, char);
+	body = xMalloc (fragment->size, char);
+	mio = mio_new_file (fileName, "r");
+	if (mio == NULL
+		|| mio_read (mio, data, 1, fragment->size) != (size_t) fragment->size)
+		error (FATAL | PERROR, "cannot read tag file fragment \"%s\"", fileName);
+	mio_unref (mio);
+
+	mio = mio_new_file (fileName, "w");
+	if (mio == NULL)
+		error (FATAL | PERROR, "cannot open tag file fragment \"%s\"", fileName);
+
+	/* The pseudo tags are written first as appendTagFileFragment()
+	 * looks for them. */
+	for (unsigned int i = 0; i + 1 < count; i += 2)
+	{
+		const long start = longArrayItem (fragment->ptagRanges, i);
+		const long length = longArrayItem (fragment->ptagRanges, i + 1);
+
+		if (start < offset || start + length > fragment->size)
+			continue;
+
+		memcpy (body + bodySize, data + offset, start - offset);
+		bodySize += start - offset;
+		longArrayAdd (ptagRanges, mio_tell (mio));
+		longArrayAdd (ptagRanges, length);
+		mio_write (mio, data + start, 1, length);
+		offset = start + length;
+	}
+	memcpy (body + bodySize, data + offset, fragment->size - offset);
+	bodySize += fragment->size - offset;
+	longArrayDelete (fragment->ptagRanges);
+	fragment->ptagRanges = ptagRanges;
+
+	internalSortTagBufferToMIO (mio, body, bodySize);
+	mio_flush (mio);
+	abort_if_ferror (mio);
+	fragment->size = mio_tell (mio);
+	fragment->sorted = true;
+	if (mio_unref (mio) != 0)
+		error (FATAL | PERROR, "cannot close tag file fragment");
+
+	eFree (body);
+	eFree (data);
+}
+
+/*
+ *  Merging partial tag files (--merge-tags)
+ *
+ *  The tag files made by the runs for the shards of the input files
+ *  (--input-shard) are merged into one. The common pseudo tags are the
+ *  ones of this run; the parser specific ones are kept once.
+ */
+static bool isParserSpecificPtagLine (const char *const line)
+{
+	const char *name = line + 2;
+	const size_t length = strcspn (name, "\t\n");
+
+	return (memchr (name, '!', length) != NULL);
+}
+
+/* Counts the lines from the current position. LAST is the character
+ * read before it. */
+static unsigned long countTagLines (MIO *const mio, char last,
+									bool *const terminated)
+{
+	char buf [8192];
+	unsigned long count = 0;
+	const long start = mio_tell (mio);
+	size_t n;
+
+	while ((n = mio_read (mio, buf, 1, sizeof (buf))) > 0)
+	{
+		for (const char *p = buf; (p = memchr (p, '\n', buf + n - p)) != NULL; p++)
+			count++;
+		last = buf [n - 1];
+	}
+	*terminated = (last == '\n');
+	if (! *terminated && mio_tell (mio) > start)
+		count++;
+	return count;
+}
+
+extern void mergeTagFile (const char *const fileName)
+{
+	static const char sortedPtag [] = "!_TAG_FILE_SORTED\t";
+	vString *const vLine = vStringNew ();
+	const char *line;
+	int sortedFlag = EOF;
+	unsigned long added;
+	bool terminated;
+	long offset;
+	MIO *mio = mio_new_file (fileName, "r");
+
+	if (mio == NULL)
+	{
+		error (WARNING | PERROR, "cannot open tag file \"%s\"", fileName);
+		vStringDelete (vLine);
+		return;
+	}
+
+	if (FragmentPtags == NULL)
+		FragmentPtags = hashTableNew (31, hashCstrhash, hashCstreq, eFree, NULL);
+
+	for (offset = 0; (line = readLineRaw (vLine, mio)) != NULL; offset = mio_tell (mio))
+	{
+		if (strncmp (line, "!_", 2) != 0)
+			break;
+		if (strncmp (line, sortedPtag, sizeof (sortedPtag) - 1) == 0)
+			sortedFlag = line [sizeof (sortedPtag) - 1];
+		else if (isParserSpecificPtagLine (line)
+				 && isXtagEnabled (XTAG_PSEUDO_TAGS)
+				 && ! hashTableHasItem (FragmentPtags, line))
+		{
+			char *const ptag = eStrdup (line);
+
+			mio_puts (TagFile.mio, ptag);
+			hashTablePutItem (FragmentPtags, ptag, ptag);
+		}
+	}
+
+	if (line == NULL)
+		;
+	else if (offset == 0 && ! isCtagsLine (line))
+		error (WARNING, "\"%s\" doesn't look like a tag file; ignored", fileName);
+	else
+	{
+		added = countTagLines (mio, line [vStringLength (vLine) - 1],
+							   &terminated) + 1;
+		if (terminated
+			&& sortedFlag == '0' + (int) Option.sorted
+			&& canSortTagFileFragments ())
+		{
+			verbose ("merging sorted tag file \"%s\"\n", fileName);
+			addSortedTagFile (fileName, offset, false);
+		}
+		else
+		{
+			verbose ("copying tag file \"%s\"\n", fileName);
+			if (mio_seek (mio, offset, SEEK_SET) != 0)
+				error (FATAL | PERROR, "cannot read tag file \"%s\"", fileName);
+			copyMioBytes (mio, TagFile.mio, LONG_MAX);
+			if (! terminated)
+				mio_putc (TagFile.mio, '\n');
+			abort_if_ferror (TagFile.mio);
+		}
+		TagFile.numTags.added += added;
+	}
+
+	mio_unref (mio);
+	vStringDelete (vLine);
 }
 
 /*
@@ -753,35 +1545,65 @@ extern size_t truncateTagLineAfterTag (
 	return len;
 }
 
-static char* getFullQualifiedScopeNameFromCorkQueue (const tagEntryInfo * inner_scope)
+/* Copies STR into the arena of the cork queue. */
+static const char *corkStrdup (const char *str)
+{
+	return str? arenaStrdup (TagFile.corkArena, str): NULL;
+}
+
+/* Like corkStrdup (), but stores the strings equal to STR only once. Use
+ * this for the strings shared by many entries. */
+static const char *corkIntern (const char *str)
 {
+	char *s;
+
+	if (str == NULL)
+		return NULL;
+
+	s = hashTableGetItem (TagFile.corkStrings, str);
+	if (s == NULL)
+	{
+		s = arenaStrdup (TagFile.corkArena, str);
+		hashTablePutItem (TagFile.corkStrings, s, s);
+	}
+	return s;
+}
 
-	int kindIndex = KIND_GHOST_INDEX;
-	langType lang;
+/* Returns the full qualified name of SCOPE, made of the names of the
+ * non-placeholder entries on its scope chain, or "" if it has no such
+ * entry. The name of each entry on the chain is computed only once, and
+ * kept in the entry for its other children. */
+static const char* getFullQualifiedScopeNameFromCorkQueue (const tagEntryInfo * inner_scope)
+{
+	static ptrArray *chain;
+	static vString *n;
 	const tagEntryInfo *scope = inner_scope;
-	const tagEntryInfo *root_scope = NULL;
-	stringList *queue = stringListNew ();
-	vString *v;
-	vString *n;
-	unsigned int c;
-	const char *sep;
+	tagEntryInfoX *parent = NULL;
+	tagEntryInfoX *innermost = NULL;
+
+	if (chain == NULL)
+	{
+		chain = ptrArrayNew (NULL);
+		DEFAULT_TRASH_BOX (chain, ptrArrayDelete);
+		n = vStringNew ();
+		DEFAULT_TRASH_BOX (n, vStringDelete);
+	}
 
+	/* Collect the entries having no full qualified name yet. */
 	while (scope)
 	{
 		if (!scope->placeholder)
 		{
-			if (kindIndex != KIND_GHOST_INDEX)
+			tagEntryInfoX *x = (tagEntryInfoX *)scope;
+
+			if (innermost == NULL)
+				innermost = x;
+			if (x->fqName)
 			{
-				sep = scopeSeparatorFor (lang, kindIndex, scope->kindIndex);
-				v = vStringNewInit (sep);
-				stringListAdd (queue, v);
+				parent = x;
+				break;
 			}
-			/* TODO: scope field of SCOPE can be used for optimization. */
-			v = vStringNewInit (scope->name);
-			stringListAdd (queue, v);
-			kindIndex = scope->kindIndex;
-			lang = scope->langType;
-			root_scope = scope;
+			ptrArrayAdd (chain, x);
 		}
 		int scopeIndex = scope->extensionFields.scopeIndex;
 		scope =  getEntryInCorkQueue (scopeIndex);
@@ -796,21 +1618,32 @@ static char* getFullQualifiedScopeNameFromCorkQueue (const tagEntryInfo * inner_
 		}
 	}
 
-	n = vStringNew ();
-	sep = root_scope? scopeSeparatorFor (root_scope->langType, root_scope->kindIndex, KIND_GHOST_INDEX): NULL;
-	if (sep)
-		vStringCatS(n, sep);
-
-	while ((c = stringListCount (queue)) > 0)
+	/* Make them from the outermost one. */
+	for (unsigned int i = ptrArrayCount (chain); i > 0; i--)
 	{
-		v = stringListLast (queue);
-		vStringCat (n, v);
-		vStringDelete (v);
-		stringListRemoveLast (queue);
+		tagEntryInfoX *x = ptrArrayItem (chain, i - 1);
+		const char *sep;
+
+		vStringClear (n);
+		if (parent)
+		{
+			vStringCatS (n, parent->fqName);
+			sep = scopeSeparatorFor (x->slot.langType, x->slot.kindIndex,
+									 parent->slot.kindIndex);
+		}
+		else
+			sep = scopeSeparatorFor (x->slot.langType, x->slot.kindIndex, KIND_GHOST_INDEX);
+		if (sep)
+			vStringCatS (n, sep);
+		vStringCatS (n, x->slot.name);
+
+		x->fqName = arenaStrndup (TagFile.corkArena,
+								  vStringValue (n), vStringLength (n));
+		parent = x;
 	}
-	stringListDelete (queue);
+	ptrArrayClear (chain);
 
-	return vStringDeleteUnwrap (n);
+	return innermost? innermost->fqName: "";
 }
 
 extern void getTagScopeInformation (tagEntryInfo *const tag,
@@ -821,14 +1654,60 @@ extern void getTagScopeInformation (tagEntryInfo *const tag,
 	if (name)
 		*name = NULL;
 
-	const tagEntryInfo * scope = getEntryInCorkQueue (tag->extensionFields.scopeIndex);
+	const int scopeIndex = tag->extensionFields.scopeIndex;
+	void *item = NULL;
+	const tagEntryInfo * scope = NULL;
+
+	if (tag->extensionFields.scopeKindIndex == KIND_GHOST_INDEX
+	    && tag->extensionFields.scopeName == NULL
+		&& CORK_NIL < scopeIndex
+		&& (size_t) scopeIndex < ptrArrayCount (TagFile.corkQueue))
+		item = ptrArrayItem (TagFile.corkQueue, scopeIndex);
+
+	/* A reference record at the top level, like a module imported, is
+	 * the scope of the names imported from it. Its name is the full
+	 * qualified one; don't make the whole entry for it. */
+	if (isCorkRef (item) && corkRefOf (item)->scopeIndex == CORK_NIL)
+	{
+		const corkRef *r = corkRefOf (item);
+		const char *sep = scopeSeparatorFor (r->langType, r->kindIndex,
+											 KIND_GHOST_INDEX);
+		const char *fqsn = r->name;
+
+		if (sep && sep[0] != '\0')
+		{
+			static vString *n;
+
+			n = vStringNewOrClearWithAutoRelease (n);
+			vStringCatS (n, sep);
+			vStringCatS (n, r->name);
+			fqsn = vStringValue (n);
+		}
+		tag->extensionFields.scopeLangType = r->langType;
+		tag->extensionFields.scopeKindIndex = r->kindIndex;
+		tag->extensionFields.scopeName = tag->inCorkQueue
+			? corkIntern (fqsn)
+			: eStrdup (fqsn);
+	}
+	else if (item)
+		scope = getEntryInCorkQueue (scopeIndex);
+
 	if (tag->extensionFields.scopeKindIndex == KIND_GHOST_INDEX
 	    && tag->extensionFields.scopeName == NULL
 	    && scope
 	    && ptrArrayCount (TagFile.corkQueue) > 0)
 	{
-		char *full_qualified_scope_name = getFullQualifiedScopeNameFromCorkQueue(scope);
-		Assert (full_qualified_scope_name);
+		const char *fqsn = getFullQualifiedScopeNameFromCorkQueue(scope);
+		const char *full_qualified_scope_name;
+
+		/* The entries in the cork queue share the name kept in their
+		 * scope entry. */
+		if (!tag->inCorkQueue)
+			full_qualified_scope_name = eStrdup (fqsn);
+		else if (fqsn[0] == '\0')
+			full_qualified_scope_name = corkIntern (fqsn);
+		else
+			full_qualified_scope_name = fqsn;
 
 		/* Make the information reusable to generate full qualified entry, and xformat output*/
 		tag->extensionFields.scopeLangType = scope->langType;
@@ -854,6 +1733,23 @@ extern void getTagScopeInformation (tagEntryInfo *const tag,
 }
 
 
+/* The patterns made recently, indexed by their line numbers. Tags of
+ * different lines are often emitted alternately when the cork queue is
+ * flushed, so a single entry is not enough to avoid reading the same
+ * line again. */
+#define PATTERN_CACHE_SIZE 64
+static struct patternCacheSlot {
+	unsigned int generation;
+	MIOPos location;
+	bool boundaryStart;
+	vString *pattern;
+} PatternCache [PATTERN_CACHE_SIZE];
+
+static struct {
+	unsigned long hits;
+	unsigned long misses;
+} PatternCacheCounts;
+
 static int   makePatternStringCommon (const tagEntryInfo *const tag,
 				      int (* putc_func) (char , void *),
 				      int (* puts_func) (const char* , void *),
@@ -867,16 +1763,23 @@ static int   makePatternStringCommon (const tagEntryInfo *const tag,
 	bool  omitted;
 	size_t line_len;
 
-	bool making_cache = false;
+	struct patternCacheSlot *slot = NULL;
 	int (* puts_o_func)(const char* , void *);
 	void * o_output;
 
-	static vString *cached_pattern;
-	static MIOPos   cached_location;
-	if (TagFile.patternCacheValid
-	    && (! tag->truncateLineAfterTag)
-	    && (memcmp (&tag->filePosition, &cached_location, sizeof(MIOPos)) == 0))
-		return puts_func (vStringValue (cached_pattern), output);
+	const bool boundaryStart = (tag->boundaryInfo & BOUNDARY_START);
+	if (! tag->truncateLineAfterTag)
+	{
+		slot = PatternCache + (tag->lineNumber % PATTERN_CACHE_SIZE);
+		if (slot->generation == TagFile.patternCacheGeneration
+			&& slot->boundaryStart == boundaryStart
+			&& (memcmp (&tag->filePosition, &slot->location, sizeof(MIOPos)) == 0))
+		{
+			PatternCacheCounts.hits++;
+			return puts_func (vStringValue (slot->pattern), output);
+		}
+		PatternCacheCounts.misses++;
+	}
 
 	line = readLineFromBypassForTag (TagFile.vLine, tag, NULL);
 	if (line == NULL)
@@ -901,31 +1804,31 @@ static int   makePatternStringCommon (const tagEntryInfo *const tag,
 	searchChar = Option.backward ? '?' : '/';
 	terminator = (line_len > 0 && (line [line_len - 1] == '\n')) ? "$": "";
 
-	if (!tag->truncateLineAfterTag)
+	if (slot)
 	{
-		making_cache = true;
-		cached_pattern = vStringNewOrClearWithAutoRelease (cached_pattern);
+		slot->pattern = vStringNewOrClearWithAutoRelease (slot->pattern);
 
 		puts_o_func = puts_func;
 		o_output    = output;
 		putc_func   = vstring_putc;
 		puts_func   = vstring_puts;
-		output      = cached_pattern;
+		output      = slot->pattern;
 	}
 
 	length += putc_func(searchChar, output);
-	if ((tag->boundaryInfo & BOUNDARY_START) == 0)
+	if (! boundaryStart)
 		length += putc_func('^', output);
 	length += appendInputLine (putc_func, line, Option.patternLengthLimit,
 							   output, &omitted);
 	length += puts_func (omitted? "": terminator, output);
 	length += putc_func (searchChar, output);
 
-	if (making_cache)
+	if (slot)
 	{
-		puts_o_func (vStringValue (cached_pattern), o_output);
-		cached_location = tag->filePosition;
-		TagFile.patternCacheValid = true;
+		puts_o_func (vStringValue (slot->pattern), o_output);
+		slot->location = tag->filePosition;
+		slot->boundaryStart = boundaryStart;
+		slot->generation = TagFile.patternCacheGeneration;
 	}
 
 	return length;
@@ -1031,6 +1934,15 @@ extern const char* getParserFieldValueForType (tagEntryInfo *const tag, fieldTyp
 	return NULL;
 }
 
+extern void freeTagEntryMemory (const void *ptr)
+{
+	if (ptr == NULL)
+		return;
+	if (TagFile.corkArena && arenaOwns (TagFile.corkArena, ptr))
+		return;
+	eFree ((void *)ptr);
+}
+
 static void copyParserFields (const tagEntryInfo *const tag, tagEntryInfo* slot)
 {
 	unsigned int i;
@@ -1043,21 +1955,21 @@ static void copyParserFields (const tagEntryInfo *const tag, tagEntryInfo* slot)
 
 		value = f->value;
 		if (value)
-			value = eStrdup (value);
+			value = corkStrdup (value);
 
 		attachParserFieldGeneric (slot,
 								  f->ftype,
 								  value,
-								  true);
+								  false);
 	}
 
 }
 
 static tagEntryInfo *newNilTagEntry (unsigned int corkFlags)
 {
-	tagEntryInfoX *x = xCalloc (1, tagEntryInfoX);
+	tagEntryInfoX *x = arenaAlloc (TagFile.corkArena, sizeof (tagEntryInfoX));
+	memset (x, 0, sizeof (tagEntryInfoX));
 	x->corkIndex = CORK_NIL;
-	x->symtab = RB_ROOT;
 	x->slot.kindIndex = KIND_FILE_INDEX;
 	return &(x->slot);
 }
@@ -1065,54 +1977,151 @@ static tagEntryInfo *newNilTagEntry (unsigned int corkFlags)
 static tagEntryInfoX *copyTagEntry (const tagEntryInfo *const tag,
 								   unsigned int corkFlags)
 {
-	tagEntryInfoX *x = xMalloc (1, tagEntryInfoX);
-	x->symtab = RB_ROOT;
+	tagEntryInfoX *x = arenaAlloc (TagFile.corkArena, sizeof (tagEntryInfoX));
+	x->members = NULL;
+	x->registered = false;
 	x->corkIndex = CORK_NIL;
+	x->fqName = NULL;
+	x->closed = false;
+	x->sealed = false;
 	tagEntryInfo  *slot = (tagEntryInfo *)x;
 
 	*slot = *tag;
 
-	if (slot->pattern)
-		slot->pattern = eStrdup (slot->pattern);
-
-	slot->inputFileName = eStrdup (slot->inputFileName);
-	slot->name = eStrdup (slot->name);
-	if (slot->extensionFields.access)
-		slot->extensionFields.access = eStrdup (slot->extensionFields.access);
-	if (slot->extensionFields.implementation)
-		slot->extensionFields.implementation = eStrdup (slot->extensionFields.implementation);
-	if (slot->extensionFields.inheritance)
-		slot->extensionFields.inheritance = eStrdup (slot->extensionFields.inheritance);
-	if (slot->extensionFields.scopeName)
-		slot->extensionFields.scopeName = eStrdup (slot->extensionFields.scopeName);
-	if (slot->extensionFields.signature)
-		slot->extensionFields.signature = eStrdup (slot->extensionFields.signature);
-	if (slot->extensionFields.typeRef[0])
-		slot->extensionFields.typeRef[0] = eStrdup (slot->extensionFields.typeRef[0]);
-	if (slot->extensionFields.typeRef[1])
-		slot->extensionFields.typeRef[1] = eStrdup (slot->extensionFields.typeRef[1]);
+	slot->pattern = corkStrdup (slot->pattern);
+
+	/* inputFileName is kept by the input module until the end of the run. */
+	slot->name = corkStrdup (slot->name);
+	slot->extensionFields.access = corkIntern (slot->extensionFields.access);
+	slot->extensionFields.implementation = corkIntern (slot->extensionFields.implementation);
+	slot->extensionFields.inheritance = corkIntern (slot->extensionFields.inheritance);
+	slot->extensionFields.scopeName = corkIntern (slot->extensionFields.scopeName);
+	slot->extensionFields.signature = corkStrdup (slot->extensionFields.signature);
+	slot->extensionFields.typeRef[0] = corkIntern (slot->extensionFields.typeRef[0]);
+	slot->extensionFields.typeRef[1] = corkIntern (slot->extensionFields.typeRef[1]);
 #ifdef HAVE_LIBXML
-	if (slot->extensionFields.xpath)
-		slot->extensionFields.xpath = eStrdup (slot->extensionFields.xpath);
+	slot->extensionFields.xpath = corkStrdup (slot->extensionFields.xpath);
 #endif
 
 	if (slot->extraDynamic)
 	{
 		int n = countXtags () - XTAG_COUNT;
-		slot->extraDynamic = xCalloc ((n / 8) + 1, uint8_t);
+		slot->extraDynamic = arenaAlloc (TagFile.corkArena, (n / 8) + 1);
 		memcpy (slot->extraDynamic, tag->extraDynamic, (n / 8) + 1);
 	}
 
-	if (slot->sourceFileName)
-		slot->sourceFileName = eStrdup (slot->sourceFileName);
+	slot->sourceFileName = corkIntern (slot->sourceFileName);
+
+	slot->usedParserFields = 0;
+	slot->parserFieldsDynamic = NULL;
+	copyParserFields (tag, slot);
+	if (slot->parserFieldsDynamic)
+		PARSER_TRASH_BOX_TAKE_BACK(slot->parserFieldsDynamic);
+
+	return x;
+}
+
+/* Whether TAG is a reference tag the cork queue can keep as a corkRef
+ * without losing anything. */
+static bool isCorkRefEntry (const tagEntryInfo *const tag)
+{
+	return (tag->extensionFields.roleBits != 0
+			&& !tag->placeholder
+			&& !tag->isFileEntry
+			&& !tag->isPseudoTag
+			&& !tag->truncateLineAfterTag
+			&& !tag->skipAutoFQEmission
+			&& tag->pattern == NULL
+			&& tag->extraDynamic == NULL
+			&& tag->extensionFields.access == NULL
+			&& tag->extensionFields.implementation == NULL
+			&& tag->extensionFields.inheritance == NULL
+			&& tag->extensionFields.signature == NULL
+			&& tag->extensionFields.typeRef[0] == NULL
+			&& tag->extensionFields.typeRef[1] == NULL
+#ifdef HAVE_LIBXML
+			&& tag->extensionFields.xpath == NULL
+#endif
+			&& tag->extensionFields.endLine == 0
+			&& tag->extensionFields.epoch == 0
+			&& tag->extensionFields.nth == NO_NTH_FIELD
+			&& tag->usedParserFields == 0
+			&& tag->parserFieldsDynamic == NULL);
+}
+
+static void *newCorkRef (const tagEntryInfo *const tag)
+{
+	corkRef *r = arenaAlloc (TagFile.corkArena, sizeof (corkRef));
+
+	/* The same names are referred to many times. */
+	r->name = corkIntern (tag->name);
+	r->inputFileName = tag->inputFileName;
+	r->sourceFileName = corkIntern (tag->sourceFileName);
+	r->scopeName = corkIntern (tag->extensionFields.scopeName);
+	r->lineNumber = tag->lineNumber;
+	r->sourceLineNumberDifference = tag->sourceLineNumberDifference;
+	r->filePosition = tag->filePosition;
+	r->roleBits = tag->extensionFields.roleBits;
+	r->kindIndex = tag->kindIndex;
+	r->scopeIndex = tag->extensionFields.scopeIndex;
+	r->scopeKindIndex = tag->extensionFields.scopeKindIndex;
+	r->scopeLangType = tag->extensionFields.scopeLangType;
+	r->langType = tag->langType;
+	r->sourceLangType = tag->sourceLangType;
+	r->boundaryInfo = tag->boundaryInfo;
+	memcpy (r->extra, tag->extra, sizeof (r->extra));
+	r->lineNumberEntry = tag->lineNumberEntry;
+	r->isFileScope = tag->isFileScope;
+
+	return (void *) ((uintptr_t) r | CORK_REF_BIT);
+}
+
+/* Fills E with the entry R was made from, as if it were in the cork
+ * queue. */
+static void expandCorkRef (const corkRef *r, tagEntryInfo *const e)
+{
+	memset (e, 0, sizeof (tagEntryInfo));
+	e->lineNumberEntry = r->lineNumberEntry;
+	e->isFileScope = r->isFileScope;
+	e->inCorkQueue = 1;
+	e->lineNumber = r->lineNumber;
+	e->boundaryInfo = r->boundaryInfo;
+	e->filePosition = r->filePosition;
+	e->langType = r->langType;
+	e->inputFileName = r->inputFileName;
+	e->name = r->name;
+	e->kindIndex = r->kindIndex;
+	memcpy (e->extra, r->extra, sizeof (e->extra));
+	e->extensionFields.scopeLangType = r->scopeLangType;
+	e->extensionFields.scopeKindIndex = r->scopeKindIndex;
+	e->extensionFields.scopeName = r->scopeName;
+	e->extensionFields.scopeIndex = r->scopeIndex;
+	e->extensionFields.roleBits = r->roleBits;
+	e->extensionFields.nth = NO_NTH_FIELD;
+	for (int i = 0; i < PRE_ALLOCATED_PARSER_FIELDS; i++)
+		e->parserFields[i].ftype = FIELD_UNKNOWN;
+	e->sourceLangType = r->sourceLangType;
+	e->sourceFileName = r->sourceFileName;
+	e->sourceLineNumberDifference = r->sourceLineNumberDifference;
+}
 
+/* Returns the entry at INDEX of the cork queue, replacing a corkRef
+ * there with the whole entry. */
+static tagEntryInfoX *getCorkEntry (unsigned int index)
+{
+	void *item = ptrArrayItem (TagFile.corkQueue, index);
+	tagEntryInfoX *x;
 
-	slot->usedParserFields = 0;
-	slot->parserFieldsDynamic = NULL;
-	copyParserFields (tag, slot);
-	if (slot->parserFieldsDynamic)
-		PARSER_TRASH_BOX_TAKE_BACK(slot->parserFieldsDynamic);
+	if (!isCorkRef (item))
+		return item;
 
+	memorySubsystem m = enterMemorySubsystem (MEMORY_CORK);
+	x = arenaAlloc (TagFile.corkArena, sizeof (tagEntryInfoX));
+	leaveMemorySubsystem (m);
+	memset (x, 0, sizeof (tagEntryInfoX));
+	expandCorkRef (corkRefOf (item), &x->slot);
+	x->corkIndex = (int) index;
+	ptrArrayUpdate (TagFile.corkQueue, index, x, NULL);
 	return x;
 }
 
@@ -1141,201 +2150,212 @@ static void clearParserFields (tagEntryInfo *const tag)
 	}
 }
 
+/* The entry and the strings copied to it are in the arena of the cork
+ * queue, and released with it. Only the memory a parser attached to the
+ * entry after putting it in the cork queue is freed here. */
 static void deleteTagEnry (void *data)
 {
 	tagEntryInfo *slot = data;
 
+	/* Released with closeCorkScope () */
+	if (slot == NULL)
+		return;
+
+	/* The record has nothing but the arena holds. */
+	if (isCorkRef (data))
+		return;
+
 	if (slot->kindIndex == KIND_FILE_INDEX)
-		goto out;
+		return;
 
-	if (slot->pattern)
-		eFree ((char *)slot->pattern);
-	eFree ((char *)slot->inputFileName);
-	eFree ((char *)slot->name);
-
-	if (slot->extensionFields.access)
-		eFree ((char *)slot->extensionFields.access);
-	if (slot->extensionFields.implementation)
-		eFree ((char *)slot->extensionFields.implementation);
-	if (slot->extensionFields.inheritance)
-		eFree ((char *)slot->extensionFields.inheritance);
-	if (slot->extensionFields.scopeName)
-		eFree ((char *)slot->extensionFields.scopeName);
-	if (slot->extensionFields.signature)
-		eFree ((char *)slot->extensionFields.signature);
-	if (slot->extensionFields.typeRef[0])
-		eFree ((char *)slot->extensionFields.typeRef[0]);
-	if (slot->extensionFields.typeRef[1])
-		eFree ((char *)slot->extensionFields.typeRef[1]);
+	freeTagEntryMemory (slot->pattern);
+	freeTagEntryMemory (slot->name);
+
+	freeTagEntryMemory (slot->extensionFields.access);
+	freeTagEntryMemory (slot->extensionFields.implementation);
+	freeTagEntryMemory (slot->extensionFields.inheritance);
+	freeTagEntryMemory (slot->extensionFields.scopeName);
+	freeTagEntryMemory (slot->extensionFields.signature);
+	freeTagEntryMemory (slot->extensionFields.typeRef[0]);
+	freeTagEntryMemory (slot->extensionFields.typeRef[1]);
 #ifdef HAVE_LIBXML
-	if (slot->extensionFields.xpath)
-		eFree ((char *)slot->extensionFields.xpath);
+	freeTagEntryMemory (slot->extensionFields.xpath);
 #endif
 
-	if (slot->extraDynamic)
-		eFree (slot->extraDynamic);
+	freeTagEntryMemory (slot->extraDynamic);
 
-	if (slot->sourceFileName)
-		eFree ((char *)slot->sourceFileName);
+	freeTagEntryMemory (slot->sourceFileName);
 
 	clearParserFields (slot);
+}
+
+static unsigned int corkSymbolHash (const void *x)
+{
+	const corkSymbol *sym = x;
+	/* Spread the members of the same name in consecutive scopes. */
+	return hashCstrhash (sym->name) ^ ((unsigned int) sym->scopeIndex * 0x9e3779b1U);
+}
+
+static bool corkSymbolEqual (const void *a, const void *b)
+{
+	const corkSymbol *x = a;
+	const corkSymbol *y = b;
+	return x->scopeIndex == y->scopeIndex && strcmp (x->name, y->name) == 0;
+}
 
- out:
-	eFree (slot);
+/* Returns whether A comes after B in the entries of a same name. */
+static bool isSymbolAfter (const tagEntryInfoX *a, const tagEntryInfoX *b)
+{
+	if (a->slot.lineNumber != b->slot.lineNumber)
+		return a->slot.lineNumber > b->slot.lineNumber;
+	return a > b;
 }
 
 static void corkSymtabPut (tagEntryInfoX *scope, const char* name, tagEntryInfoX *item)
 {
-	struct rb_root *root = &scope->symtab;
+	tagEntryInfoX *last;
 
-	struct rb_node **new = &(root->rb_node), *parent = NULL;
+	Assert (!item->registered);
 
-	while (*new)
-	{
-		tagEntryInfoX *this = container_of(*new, tagEntryInfoX, symnode);
-		int result = strcmp(item->slot.name, this->slot.name);
+	item->symkey.scopeIndex = scope->corkIndex;
+	item->symkey.name = name;
+	item->registered = true;
 
-		parent = *new;
+	item->memberPrev = NULL;
+	item->memberNext = scope->members;
+	if (scope->members)
+		scope->members->memberPrev = item;
+	scope->members = item;
 
-		if (result < 0)
-			new = &((*new)->rb_left);
-		else if (result > 0)
-			new = &((*new)->rb_right);
-		else
-		{
-			unsigned long lthis = this->slot.lineNumber;
-			unsigned long litem = item->slot.lineNumber;
-
-			/* Comparing lineNumber */
-			if (litem < lthis)
-				new = &((*new)->rb_left);
-			else if (litem > lthis)
-				new = &((*new)->rb_right);
-			else
-			{
-				/* Comparing memory address */
-				if (item < this)
-					new = &((*new)->rb_left);
-				else if (item > this)
-					new = &((*new)->rb_right);
-				else
-				{
-					AssertNotReached(); /* registering the same object twice. */
-					return;
-				}
-			}
-		}
+	last = hashTableGetItem (TagFile.corkSymtab, &item->symkey);
+	if (last == NULL || isSymbolAfter (item, last))
+	{
+		/* Tags are made in order usually. */
+		if (last)
+			hashTableDeleteItem (TagFile.corkSymtab, &last->symkey);
+		item->symNext = last;
+		hashTablePutItem (TagFile.corkSymtab, &item->symkey, item);
+	}
+	else
+	{
+		tagEntryInfoX *prev = last;
+
+		while (prev->symNext && isSymbolAfter (prev->symNext, item))
+			prev = prev->symNext;
+		item->symNext = prev->symNext;
+		prev->symNext = item;
 	}
 
 	verbose ("symtbl[:=] %s<-%s/%p (line: %lu)\n",
-			*new? container_of(*new, tagEntryInfoX, symnode)->slot.name: "*root*",
+			 scope->slot.name? scope->slot.name: "*root*",
 			 item->slot.name, &item->slot, item->slot.lineNumber);
-	/* Add new node and rebalance tree. */
-	rb_link_node(&item->symnode, parent, new);
-	rb_insert_color(&item->symnode, root);
 }
 
-static void corkSymtabUnlink (tagEntryInfoX *scope, tagEntryInfoX *item)
+static void corkSymtabUnlink (tagEntryInfoX *item)
 {
-	struct rb_root *root = &scope->symtab;
-	rb_erase (&item->symnode, root);
-}
+	tagEntryInfoX *scope;
+	tagEntryInfoX *last;
 
-extern bool foreachEntriesInScope (int corkIndex,
-								   const char *name,
-								   entryForeachFunc func,
-								   void *data)
-{
-	tagEntryInfoX *x = ptrArrayItem (TagFile.corkQueue, corkIndex);
+	if (!item->registered)
+		return;
+	item->registered = false;
 
-	struct rb_root *root = &x->symtab;
-	tagEntryInfoX *rep = NULL;
+	/* The scope may be changed after registering. */
+	scope = getCorkEntry (item->symkey.scopeIndex);
 
-	/* More than one tag can have a same name.
-	 * Visit them from the last.
-	 *
-	 * 1. find one of them as the representative,
-	 * 2. find the last one of them from the representative with rb_next,
-	 * 3. call FUNC iteratively from the last to the first.
-	 */
-	if (name)
+	if (item->memberPrev)
+		item->memberPrev->memberNext = item->memberNext;
+	else
+		scope->members = item->memberNext;
+	if (item->memberNext)
+		item->memberNext->memberPrev = item->memberPrev;
+
+	last = hashTableGetItem (TagFile.corkSymtab, &item->symkey);
+	if (last == item)
 	{
-		struct rb_node *node = root->rb_node;
-		while (node)
-		{
-			tagEntryInfoX *entry = container_of(node, tagEntryInfoX, symnode);
-			int result;
+		hashTableDeleteItem (TagFile.corkSymtab, &item->symkey);
+		if (item->symNext)
+			hashTablePutItem (TagFile.corkSymtab, &item->symNext->symkey, item->symNext);
+	}
+	else if (last)
+	{
+		tagEntryInfoX *prev = last;
 
-			result = strcmp(name, entry->slot.name);
+		while (prev->symNext && prev->symNext != item)
+			prev = prev->symNext;
+		prev->symNext = item->symNext;
+	}
+}
 
-			if (result < 0)
-				node = node->rb_left;
-			else if (result > 0)
-				node = node->rb_right;
-			else
-			{
-				rep = entry;
-				break;
-			}
-		}
-		if (rep == NULL)
-			return true;
+/* The order foreachEntriesInScope () visits all the entries in a scope:
+ * by name, line number, and address, from the last one. */
+static int compareMembers (const void *a, const void *b)
+{
+	const tagEntryInfoX *x = a;
+	const tagEntryInfoX *y = b;
+	int r = strcmp (y->symkey.name, x->symkey.name);
 
-		verbose("symtbl[<>] %s->%p\n", name, &rep->slot);
-	}
+	if (r != 0)
+		return r;
+	if (x == y)
+		return 0;
+	return isSymbolAfter (x, y)? -1: 1;
+}
 
-	struct rb_node *last;
+extern bool foreachEntriesInScope (int corkIndex,
+								   const char *name,
+								   entryForeachFunc func,
+								   void *data)
+{
+	tagEntryInfoX *x = getCorkEntry (corkIndex);
 
 	if (name)
 	{
-		struct rb_node *tmp = &rep->symnode;
-		last = tmp;
+		corkSymbol sym = {
+			.scopeIndex = x->corkIndex,
+			.name = name,
+		};
+		tagEntryInfoX *entry = hashTableGetItem (TagFile.corkSymtab, &sym);
 
-		while ((tmp = rb_next (tmp)))
+		/* More than one tag can have a same name.
+		 * Visit them from the last. */
+		for (; entry; entry = entry->symNext)
 		{
-			tagEntryInfoX *entry = container_of(tmp, tagEntryInfoX, symnode);
-			if (strcmp(name, entry->slot.name) == 0)
-			{
-				verbose ("symtbl[ >] %s->%p\n", name, &container_of(tmp, tagEntryInfoX, symnode)->slot);
-				last = tmp;
-			}
-			else
-				break;
+			verbose ("symtbl[< ] %s->%p\n", name, &entry->slot);
+			if (!func (entry->corkIndex, &entry->slot, data))
+				return false;
 		}
-	}
-	else
-	{
-		last = rb_last(root);
-		verbose ("last for %d<%p>: %p\n", corkIndex, root, last);
+		return true;
 	}
 
-	if (!last)
+	if (x->members == NULL)
 	{
-		verbose ("symtbl[>V] %s->%p\n", name? name: "(null)", NULL);
+		verbose ("symtbl[>V] %s->%p\n", "(null)", NULL);
 		return true;			/* Nothing here in this node. */
 	}
 
-	verbose ("symtbl[>|] %s->%p\n", name, &container_of(last, tagEntryInfoX, symnode)->slot);
+	/* The entries of the scope are sorted only when all of them are
+	 * visited. The callbacks may register and unregister entries. */
+	ptrArray *members = ptrArrayNew (NULL);
+	bool r = true;
 
-	struct rb_node *cursor = last;
-	bool revisited_rep = false;
-	do
+	for (tagEntryInfoX *m = x->members; m; m = m->memberNext)
+		ptrArrayAdd (members, m);
+	ptrArraySort (members, compareMembers);
+
+	for (unsigned int i = 0; i < ptrArrayCount (members); i++)
 	{
-		tagEntryInfoX *entry = container_of(cursor, tagEntryInfoX, symnode);
-		if (!revisited_rep || !name || !strcmp(name, entry->slot.name))
+		tagEntryInfoX *entry = ptrArrayItem (members, i);
+
+		verbose ("symtbl[< ] %s->%p\n", "(null)", &entry->slot);
+		if (!func (entry->corkIndex, &entry->slot, data))
 		{
-			verbose ("symtbl[< ] %s->%p\n", name, &entry->slot);
-			if (!func (entry->corkIndex, &entry->slot, data))
-				return false;
-			if (cursor == &rep->symnode)
-				revisited_rep = true;
-		}
-		else if (name)
+			r = false;
 			break;
+		}
 	}
-	while ((cursor = rb_prev(cursor)));
-
-	return true;
+	ptrArrayDelete (members);
+	return r;
 }
 
 struct countData {
@@ -1367,10 +2387,11 @@ unsigned int countEntriesInScope (int corkIndex, bool onlyDefinitionTag,
 		.func = func,
 		.cbData = cbData,
 	};
+	tagEntryInfoX *x = getCorkEntry (corkIndex);
 
-	foreachEntriesInScope (corkIndex, NULL,
-						   &countEntryMaybe,
-						   &data);
+	/* Counting doesn't depend on the order. */
+	for (tagEntryInfoX *m = x->members; m; m = m->memberNext)
+		countEntryMaybe (m->corkIndex, &m->slot, &data);
 
 	return data.count;
 }
@@ -1490,9 +2511,9 @@ extern void registerEntry (int corkIndex)
 	Assert (TagFile.corkFlags & CORK_SYMTAB);
 	Assert (corkIndex != CORK_NIL);
 
-	tagEntryInfoX *e = ptrArrayItem (TagFile.corkQueue, corkIndex);
+	tagEntryInfoX *e = getCorkEntry (corkIndex);
 	{
-		tagEntryInfoX *scope = ptrArrayItem (TagFile.corkQueue, e->slot.extensionFields.scopeIndex);
+		tagEntryInfoX *scope = getCorkEntry (e->slot.extensionFields.scopeIndex);
 		corkSymtabPut (scope, e->slot.name, e);
 	}
 }
@@ -1502,12 +2523,8 @@ extern void unregisterEntry(int corkIndex)
 	Assert (TagFile.corkFlags & CORK_SYMTAB);
 	Assert (corkIndex != CORK_NIL);
 
-	tagEntryInfoX *e = ptrArrayItem (TagFile.corkQueue, corkIndex);
-	{
-		tagEntryInfoX *scope = ptrArrayItem (TagFile.corkQueue, e->slot.extensionFields.scopeIndex);
-		corkSymtabUnlink (scope, e);
-	}
-
+	tagEntryInfoX *e = getCorkEntry (corkIndex);
+	corkSymtabUnlink (e);
 }
 
 static int queueTagEntry(const tagEntryInfo *const tag)
@@ -1515,8 +2532,8 @@ static int queueTagEntry(const tagEntryInfo *const tag)
 	static bool warned;
 
 	int corkIndex;
-	tagEntryInfoX * entry = copyTagEntry (tag,
-										TagFile.corkFlags);
+	tagEntryInfoX *entry = NULL;
+	void *item;
 
 	if (ptrArrayCount (TagFile.corkQueue) == (size_t)INT_MAX)
 	{
@@ -1532,9 +2549,17 @@ static int queueTagEntry(const tagEntryInfo *const tag)
 	}
 	warned = false;
 
-	corkIndex = (int)ptrArrayAdd (TagFile.corkQueue, entry);
-	entry->corkIndex = corkIndex;
-	entry->slot.inCorkQueue = 1;
+	if (isCorkRefEntry (tag))
+		item = newCorkRef (tag);
+	else
+		item = entry = copyTagEntry (tag, TagFile.corkFlags);
+
+	corkIndex = (int)ptrArrayAdd (TagFile.corkQueue, item);
+	if (entry)
+	{
+		entry->corkIndex = corkIndex;
+		entry->slot.inCorkQueue = 1;
+	}
 
 	return corkIndex;
 }
@@ -1570,21 +2595,9 @@ static bool isTagWritable(const tagEntryInfo *const tag)
 			(makeRoleBit(available_roles)))
 			return false;
 
-		/* TODO: optimization
-		   A Bitmasks representing all enabled roles can be calculated at the
-		   end of initializing the parser. Calculating each time when checking
-		   a tag entry is not needed. */
-		for (unsigned int roleIndex = 0; roleIndex < available_roles; roleIndex++)
-		{
-			if (isRoleAssigned(tag, roleIndex))
-			{
-				if (isLanguageRoleEnabled (tag->langType, tag->kindIndex,
-											 roleIndex))
-					return true;
-			}
-
-		}
-		return false;
+		/* Writable if one of the roles assigned is enabled. */
+		return (tag->extensionFields.roleBits
+				& getLanguageEnabledRoleBits (tag->langType, tag->kindIndex)) != 0;
 	}
 	else if (isLanguageKindRefOnly(tag->langType, tag->kindIndex))
 	{
@@ -1615,6 +2628,10 @@ static void writeTagEntry (const tagEntryInfo *const tag)
 
 	DebugStatement ( debugEntry (tag); )
 
+	if (Option.dedupTags && TagFile.mio
+		&& isTagWrittenBefore (tag, mio_tell (TagFile.mio)))
+		return;
+
 #ifdef WIN32
 	if (getFilenameSeparator(Option.useSlashAsFilenameSeparator) == FILENAME_SEP_USE_SLASH)
 	{
@@ -1639,12 +2656,21 @@ static void writeTagEntry (const tagEntryInfo *const tag)
 		buildFqTagCache ( (tagEntryInfo *const)tag);
 	}
 
+	const timingPhase phase = enterTimingPhase (PHASE_WRITE);
 	length = writerWriteTag (TagFile.mio, tag);
+	leaveTimingPhase (phase);
+	if (Option.dedupTags && TagFile.mio)
+		setEndOfTagWritten (mio_tell (TagFile.mio));
+	recordHeaderTag (tag);
 
 	if (length > 0)
 	{
 		++TagFile.numTags.added;
+		accountTimingTag (tag->langType);
 		rememberMaxLengths (strlen (tag->name), (size_t) length);
+		if (TagStream.retract
+			&& mio_tell (TagFile.mio) - TagStream.sent >= TAG_STREAM_CHUNK_SIZE)
+			sendTagStream ();
 	}
 	DebugStatement ( if (TagFile.mio) mio_flush (TagFile.mio); )
 
@@ -1657,12 +2683,22 @@ extern bool writePseudoTag (const ptagDesc *desc,
 			       const char *const parserName)
 {
 	int length;
+	long offset = 0;
+
+	if (TagFile.ptagRanges)
+		offset = mio_tell (TagFile.mio);
 
 	length = writerWritePtag (TagFile.mio, desc, fileName,
 							  pattern, parserName);
 	if (length < 0)
 		return false;
 
+	if (TagFile.ptagRanges)
+	{
+		longArrayAdd (TagFile.ptagRanges, offset);
+		longArrayAdd (TagFile.ptagRanges, mio_tell (TagFile.mio) - offset);
+	}
+
 	abort_if_ferror (TagFile.mio);
 
 	++TagFile.numTags.added;
@@ -1677,10 +2713,311 @@ extern void corkTagFile(unsigned int corkFlags)
 	if (TagFile.cork == 1)
 	{
 		TagFile.corkFlags = corkFlags;
+		if (TagFile.corkArena == NULL)
+		{
+			TagFile.corkArena = arenaNew (64 * 1024);
+			TagFile.corkStrings = hashTableNew (1021, hashCstrhash, hashCstreq,
+												NULL, NULL);
+			TagFile.corkSymtab = hashTableNew (8191, corkSymbolHash, corkSymbolEqual,
+											   NULL, NULL);
+		}
 		TagFile.corkQueue = ptrArrayNew (deleteTagEnry);
 		tagEntryInfo *nil = newNilTagEntry (corkFlags);
 		ptrArrayAdd (TagFile.corkQueue, nil);
+		TagFile.corkWritten = 0;
+		TagFile.corkWrittenSinceRelease = 0;
+		TagFile.corkReleased = 0;
+		if (TagFile.corkKept == NULL)
+			TagFile.corkKept = intArrayNew ();
+		else
+			intArrayClear (TagFile.corkKept);
+	}
+}
+
+static void writeCorkEntry (tagEntryInfo *tag)
+{
+	if (!isTagWritable(tag))
+		return;
+
+	writeTagEntry (tag);
+
+	if (doesInputLanguageRequestAutomaticFQTag (tag)
+		&& isXtagEnabled (XTAG_QUALIFIED_TAGS)
+		&& !isTagExtraBitMarked (tag, XTAG_QUALIFIED_TAGS)
+		&& !tag->skipAutoFQEmission
+		&& ((tag->extensionFields.scopeKindIndex != KIND_GHOST_INDEX
+			 && tag->extensionFields.scopeName != NULL
+			 && tag->extensionFields.scopeIndex != CORK_NIL)
+			|| (tag->extensionFields.scopeKindIndex == KIND_GHOST_INDEX
+				&& tag->extensionFields.scopeName == NULL
+				&& tag->extensionFields.scopeIndex == CORK_NIL)))
+		makeQualifiedTagEntry (tag);
+}
+
+/* Copies X to the arena of the cork queue. The scope of X must be copied
+ * before. */
+static void moveCorkEntry (tagEntryInfoX *x)
+{
+	tagEntryInfoX *y = copyTagEntry (&x->slot, TagFile.corkFlags);
+
+	y->corkIndex = x->corkIndex;
+	y->slot.inCorkQueue = 1;
+	y->closed = x->closed;
+	if (x->registered)
+	{
+		tagEntryInfoX *scope = ptrArrayItem (TagFile.corkQueue,
+											 x->slot.extensionFields.scopeIndex);
+		corkSymtabPut (scope->moved, y->slot.name, y);
+	}
+	x->moved = y;
+}
+
+/* Releases the memory of the entries, all of which have been written.
+ * The entries not sealed are moved to the spare arena, which becomes
+ * the arena of the cork queue; they may still be the scope of new
+ * entries. */
+static void releaseCorkQueue (void)
+{
+	const unsigned int count = ptrArrayCount (TagFile.corkQueue);
+	arena *old = TagFile.corkArena;
+	intArray *kept = intArrayNew ();
+	tagEntryInfoX *nil = getCorkEntry (CORK_NIL);
+
+	if (TagFile.corkSpareArena == NULL)
+		TagFile.corkSpareArena = arenaNew (64 * 1024);
+
+	hashTableClear (TagFile.corkStrings);
+	if (hashTableCountItem (TagFile.corkSymtab) > 0)
+		hashTableClear (TagFile.corkSymtab);
+
+	/* Move the entries kept in order, so the scope of an entry is moved
+	 * before the entry. Only the entries kept at the last release and the
+	 * entries made after it are visited. */
+	TagFile.corkArena = TagFile.corkSpareArena;
+	nil->moved = (tagEntryInfoX *) newNilTagEntry (TagFile.corkFlags);
+	for (unsigned int i = 0; i < intArrayCount (TagFile.corkKept); i++)
+	{
+		const int index = intArrayItem (TagFile.corkKept, i);
+
+		moveCorkEntry (getCorkEntry (index));
+		intArrayAdd (kept, index);
+	}
+	for (unsigned int i = TagFile.corkReleased + 1; i < count; i++)
+	{
+		tagEntryInfoX *x = getCorkEntry (i);
+
+		if (x->sealed)
+			continue;
+		moveCorkEntry (x);
+		intArrayAdd (kept, i);
+	}
+
+	/* Free the memory the parser attached to the old entries. */
+	TagFile.corkArena = old;
+	ptrArrayUpdate (TagFile.corkQueue, CORK_NIL, nil->moved, NULL);
+	for (unsigned int i = 0; i < intArrayCount (TagFile.corkKept); i++)
+	{
+		const int index = intArrayItem (TagFile.corkKept, i);
+		tagEntryInfoX *x = getCorkEntry (index);
+
+		ptrArrayUpdate (TagFile.corkQueue, index, x->moved, NULL);
+	}
+	for (unsigned int i = TagFile.corkReleased + 1; i < count; i++)
+	{
+		tagEntryInfoX *x = getCorkEntry (i);
+
+		ptrArrayUpdate (TagFile.corkQueue, i, x->sealed? NULL: x->moved, NULL);
+	}
+	intArrayDelete (TagFile.corkKept);
+	TagFile.corkKept = kept;
+	TagFile.corkReleased = count - 1;
+
+	arenaReset (old);
+	TagFile.corkArena = TagFile.corkSpareArena;
+	TagFile.corkSpareArena = old;
+	TagFile.corkWrittenSinceRelease = 0;
+}
+
+/* Release the memory only after writing this many entries, not to
+ * release it too often. */
+#define CORK_RELEASE_ENTRIES 1024
+
+static void flushCorkQueue (void)
+{
+	const unsigned int count = ptrArrayCount (TagFile.corkQueue);
+	unsigned int i;
+
+	if (TagFile.corkHeld)
+		return;
+
+	for (i = TagFile.corkWritten + 1; i < count; i++)
+	{
+		tagEntryInfoX *x = getCorkEntry (i);
+		const int scopeIndex = x->slot.extensionFields.scopeIndex;
+
+		/* The scope of X, made before X, has been written. */
+		if (!x->sealed && CORK_NIL < scopeIndex && (unsigned int) scopeIndex < i)
+		{
+			tagEntryInfoX *scope = getCorkEntry (scopeIndex);
+			x->sealed = scope->sealed;
+		}
+		if (!(x->closed || x->sealed))
+			break;
+
+		writeCorkEntry (&x->slot);
+		TagFile.corkWritten = i;
+		TagFile.corkWrittenSinceRelease++;
+	}
+
+	if (i == count && TagFile.corkWrittenSinceRelease >= CORK_RELEASE_ENTRIES)
+		releaseCorkQueue ();
+}
+
+extern void closeCorkEntry (int corkIndex)
+{
+	tagEntryInfoX *x;
+
+	if (corkIndex == CORK_NIL || TagFile.corkQueue == NULL)
+		return;
+
+	x = getCorkEntry (corkIndex);
+	if (x == NULL || x->closed)
+		return;
+
+	x->closed = true;
+	if ((unsigned int) corkIndex == TagFile.corkWritten + 1)
+		flushCorkQueue ();
+}
+
+extern void closeCorkScope (int corkIndex)
+{
+	tagEntryInfoX *x;
+
+	if (corkIndex == CORK_NIL || TagFile.corkQueue == NULL)
+		return;
+
+	x = getCorkEntry (corkIndex);
+	if (x == NULL || x->sealed)
+		return;
+
+	x->closed = true;
+	x->sealed = true;
+	if ((unsigned int) corkIndex <= TagFile.corkWritten + 1)
+		flushCorkQueue ();
+}
+
+extern bool truncateCorkQueue (size_t count)
+{
+	const unsigned int n = ptrArrayCount (TagFile.corkQueue);
+
+	Assert (count > CORK_NIL && count <= n);
+	if (TagFile.cork != 1 || TagFile.corkWritten >= count)
+		return false;
+
+	for (unsigned int i = n; i > count; i--)
+	{
+		void *item = ptrArrayItem (TagFile.corkQueue, i - 1);
+
+		/* A reference record is never in the symbol table. */
+		if (!isCorkRef (item))
+			corkSymtabUnlink (item);
+	}
+	ptrArrayDeleteLastInBatch (TagFile.corkQueue, n - count);
+	return true;
+}
+
+extern void holdCorkQueue (void)
+{
+	TagFile.corkHeld = true;
+}
+
+/* Returns STR with the numbers of the anonymous names made with HASH, up
+ * to COUNT, increased by OFFSET. A name made by anonGenerate () is HASH
+ * followed by the number and the kind index, "%02x%02x". */
+static const char *renumberAnon (const char *str, const char *hash,
+								 unsigned int count, unsigned int offset,
+								 vString *b)
+{
+	const size_t hashLength = strlen (hash);
+	const char *p;
+
+	if (str == NULL || (p = strstr (str, hash)) == NULL)
+		return str;
+
+	vStringClear (b);
+	do
+	{
+		const char *q;
+		unsigned long id = 0;
+
+		p += hashLength;
+		vStringNCatSUnsafe (b, str, p - str);
+		for (q = p; isdigit ((unsigned char) *q) || ('a' <= *q && *q <= 'f'); q++)
+			;
+
+		if (q - p >= 4 && q - p <= 10)
+		{
+			char num [16];
+
+			memcpy (num, p, q - p - 2);
+			num [q - p - 2] = '\0';
+			id = strtoul (num, NULL, 16);
+		}
+
+		if (0 < id && id <= count)
+		{
+			char num [32];
+
+			snprintf (num, sizeof (num), "%02lx%.2s", id + offset, q - 2);
+			vStringCatS (b, num);
+		}
+		else
+			vStringNCatSUnsafe (b, p, q - p);
+		str = q;
+	}
+	while ((p = strstr (str, hash)) != NULL);
+	vStringCatS (b, str);
+	return corkStrdup (vStringValue (b));
+}
+
+extern void renumberAnonInCorkQueue (const char *hash,
+									 unsigned int count, unsigned int offset)
+{
+	vString *b = vStringNew ();
+
+	for (unsigned int i = CORK_NIL + 1; i < ptrArrayCount (TagFile.corkQueue); i++)
+	{
+		void *item = ptrArrayItem (TagFile.corkQueue, i);
+		tagEntryInfoX *x;
+		tagEntryInfo *e;
+
+		if (isCorkRef (item))
+		{
+			corkRef *r = corkRefOf (item);
+			r->name = renumberAnon (r->name, hash, count, offset, b);
+			r->scopeName = renumberAnon (r->scopeName, hash, count, offset, b);
+			continue;
+		}
+
+		x = item;
+		e = &x->slot;
+		e->name = renumberAnon (e->name, hash, count, offset, b);
+		e->extensionFields.scopeName = renumberAnon (e->extensionFields.scopeName,
+													 hash, count, offset, b);
+		e->extensionFields.typeRef[1] = renumberAnon (e->extensionFields.typeRef[1],
+													  hash, count, offset, b);
+		e->extensionFields.signature = renumberAnon (e->extensionFields.signature,
+													 hash, count, offset, b);
+		e->extensionFields.inheritance = renumberAnon (e->extensionFields.inheritance,
+													   hash, count, offset, b);
+		for (unsigned int j = 0; j < e->usedParserFields; j++)
+		{
+			tagField *f = (tagField *) getParserFieldForIndex (e, j);
+			f->value = renumberAnon (f->value, hash, count, offset, b);
+		}
+		x->fqName = NULL;
 	}
+	vStringDelete (b);
 }
 
 extern void uncorkTagFile(void)
@@ -1692,36 +3029,37 @@ extern void uncorkTagFile(void)
 	if (TagFile.cork > 0)
 		return ;
 
-	for (i = 1; i < ptrArrayCount (TagFile.corkQueue); i++)
+	/* The tags written one by one without the cork queue are not
+	 * traced; a span for each would be larger than the tag. */
+	beginTraceEvent (TRACE_PHASE, "write");
+	for (i = TagFile.corkWritten + 1; i < ptrArrayCount (TagFile.corkQueue); i++)
 	{
-		tagEntryInfo *tag = ptrArrayItem (TagFile.corkQueue, i);
-
-		if (!isTagWritable(tag))
-			continue;
+		void *item = ptrArrayItem (TagFile.corkQueue, i);
 
-		writeTagEntry (tag);
+		if (isCorkRef (item))
+		{
+			tagEntryInfo e;
 
-		if (doesInputLanguageRequestAutomaticFQTag (tag)
-		    && isXtagEnabled (XTAG_QUALIFIED_TAGS)
-			&& !isTagExtraBitMarked (tag, XTAG_QUALIFIED_TAGS)
-			&& !tag->skipAutoFQEmission
-			&& ((tag->extensionFields.scopeKindIndex != KIND_GHOST_INDEX
-				 && tag->extensionFields.scopeName != NULL
-				 && tag->extensionFields.scopeIndex != CORK_NIL)
-				|| (tag->extensionFields.scopeKindIndex == KIND_GHOST_INDEX
-					&& tag->extensionFields.scopeName == NULL
-					&& tag->extensionFields.scopeIndex == CORK_NIL)))
-			makeQualifiedTagEntry (tag);
+			expandCorkRef (corkRefOf (item), &e);
+			writeCorkEntry (&e);
+		}
+		else
+			writeCorkEntry (item);
 	}
+	endTraceEvent (TRACE_PHASE);
 
 	ptrArrayDelete (TagFile.corkQueue);
 	TagFile.corkQueue = NULL;
+	hashTableClear (TagFile.corkStrings);
+	if (hashTableCountItem (TagFile.corkSymtab) > 0)
+		hashTableClear (TagFile.corkSymtab);
+	arenaReset (TagFile.corkArena);
 }
 
 extern tagEntryInfo *getEntryInCorkQueue   (int n)
 {
 	if ((CORK_NIL < n) && (((size_t)n) < ptrArrayCount (TagFile.corkQueue)))
-		return ptrArrayItem (TagFile.corkQueue, n);
+		return (tagEntryInfo *) getCorkEntry ((unsigned int) n);
 	else
 		return NULL;
 }
@@ -1789,7 +3127,12 @@ extern int makeTagEntry (const tagEntryInfo *const tag)
 	}
 
 	if (TagFile.cork)
+	{
+		memorySubsystem m = enterMemorySubsystem (MEMORY_CORK);
+
 		r = queueTagEntry (tag);
+		leaveMemorySubsystem (m);
+	}
 	else
 		writeTagEntry (tag);
 
@@ -1999,9 +3342,13 @@ static void    markTagExtraBitFull     (tagEntryInfo *const tag, xtagType extra,
 		Assert (extra < countXtags ());
 
 		int n = countXtags () - XTAG_COUNT;
-		tag->extraDynamic = xCalloc ((n / 8) + 1, uint8_t);
-		if (!tag->inCorkQueue)
-			PARSER_TRASH_BOX(tag->extraDynamic, eFree);
+		if (tag->inCorkQueue)
+		{
+			tag->extraDynamic = arenaAlloc (TagFile.corkArena, (n / 8) + 1);
+			memset (tag->extraDynamic, 0, (n / 8) + 1);
+		}
+		else
+			tag->extraDynamic = PARSER_TRASH_BOX_ALLOC ((n / 8) + 1, uint8_t);
 		markTagExtraBitFull (tag, extra, mark);
 		return;
 	}
@@ -2120,7 +3467,18 @@ extern unsigned long maxTagsLine (void)
 
 extern void invalidatePatternCache(void)
 {
-	TagFile.patternCacheValid = false;
+	TagFile.patternCacheGeneration++;
+}
+
+extern unsigned int getPatternCacheGeneration (void)
+{
+	return TagFile.patternCacheGeneration;
+}
+
+extern void getPatternCacheCounts (unsigned long *hits, unsigned long *misses)
+{
+	*hits = PatternCacheCounts.hits;
+	*misses = PatternCacheCounts.misses;
 }
 
 extern void tagFilePosition (MIOPos *p)
@@ -2155,6 +3513,23 @@ extern void setTagFilePosition (MIOPos *p, bool truncation)
 		if (!mio_try_resize (TagFile.mio, (size_t)t1))
 			error (FATAL|PERROR,
 				   "failed to truncate the tag file %ld -> %ld\n", t0, t1);
+		forgetTagsWrittenAfter (t1);
+
+		/* The client drops the tag lines streamed, and they are sent
+		 * again. */
+		if (TagStream.retract && t1 < TagStream.sent)
+		{
+			TagStream.retract ();
+			TagStream.sent = 0;
+		}
+
+		while (TagFile.ptagRanges && longArrayCount (TagFile.ptagRanges) > 0
+			   && longArrayItem (TagFile.ptagRanges,
+								 longArrayCount (TagFile.ptagRanges) - 2) >= t1)
+		{
+			longArrayRemoveLast (TagFile.ptagRanges);
+			longArrayRemoveLast (TagFile.ptagRanges);
+		}
 	}
 }
 
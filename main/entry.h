@@ -168,6 +168,31 @@ tagEntryInfo *getEntryInCorkQueue   (int n);
 tagEntryInfo *getEntryOfNestingLevel (const NestingLevel *nl);
 size_t        countEntryInCorkQueue (void);
 
+/* The strings of an entry in the cork queue are allocated in the memory
+ * of the cork queue. To replace one of them, allocate the new string with
+ * eMalloc () or its friends, and release the old one with this function
+ * instead of eFree (). */
+void          freeTagEntryMemory (const void *ptr);
+
+/* A parser making many tags can let the cork queue write and release its
+ * entries before the end of the input file.
+ *
+ * closeCorkEntry () tells that the parser doesn't update the entry at
+ * CORKINDEX any more. Entries may still be made in its scope.
+ * closeCorkScope () tells also that no entry is made in the scope of the
+ * entry or in the scopes in it any more; the entries already made in the
+ * scopes are not updated either.
+ *
+ * The entries are written in the order they are made, as soon as every
+ * entry before them is closed. When the whole queue is written, the
+ * memory of the entries is released, except for the entries closed with
+ * closeCorkEntry () only; they are kept because a new entry may refer
+ * them as its scope. getEntryInCorkQueue () returns NULL for an entry
+ * released, and a pointer to an entry is invalid after calling these
+ * functions. */
+void          closeCorkEntry (int corkIndex);
+void          closeCorkScope (int corkIndex);
+
 /* If a parser sets (CORK_QUEUE and )CORK_SYMTAB to useCork,
  * the parsesr can use symbol lookup tables for the current input.
  * Each scope has a symbol lookup table.
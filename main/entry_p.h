@@ -15,8 +15,22 @@
 */
 #include "general.h"  /* must always come first */
 #include "entry.h"
+#include "numarray.h"
 #include "types.h"
 
+/*
+*   DATA DECLARATIONS
+*/
+
+/* What a --jobs worker passes to the parent about its tag file fragment. */
+typedef struct sTagFileFragment {
+	long size;
+	unsigned long added;
+	size_t maxLine, maxTag;
+	longArray *ptagRanges;	/* (offset, length) pairs of pseudo tags */
+	bool sorted;			/* see sortTagFileFragment() */
+} tagFileFragment;
+
 /*
 *   FUNCTION PROTOTYPES
 */
@@ -30,6 +44,40 @@ extern void freeTagFileResources (void);
 extern const char *tagFileName (void);
 extern void openTagFile (void);
 extern void closeTagFile (const bool resize);
+/* The tags of fileName already in the tag file appended to are dropped
+ * when it is closed; the tags added for fileName are kept. */
+extern void dropTagsOfInputFile (const char *const fileName);
+
+/* In the interactive mode, the tag lines written after
+ * startTagFileStream () are sent to stdout in chunks while parsing, not
+ * only when closeTagFile () is called. When the tag lines already sent are
+ * dropped, for rescanning an input file for example, RETRACT is called
+ * to tell the client, and the tag lines are sent again from the start of
+ * the tag file. */
+extern void startTagFileStream (void (* retract) (void));
+extern long getTagFileOffset (void);
+extern void readTagFileRange (const long start, vString *const lines);
+extern void writeTagFileLines (const char *const lines, const size_t size,
+							   const unsigned long count);
+
+/* The tag file, the fragments of --jobs, and the output of the sort
+ * are written through a buffer this large. */
+#define TAG_FILE_BUFFER_SIZE (1024 * 1024)
+extern MIO *newTagFileOutput (const char *const fileName, const char *const mode);
+extern void redirectTagFile (const char *const fileName);
+extern void closeRedirectedTagFile (tagFileFragment *const fragment);
+extern void appendTagFileFragment (const char *const fileName,
+								   const tagFileFragment *const fragment);
+/* Whether a worker can sort its fragment for the parent to merge it
+ * into the tag file sorted. */
+extern bool canSortTagFileFragments (void);
+/* Moves the pseudo tags of the fragment to its head, and sorts the
+ * lines after them. appendTagFileFragment() then keeps the file and
+ * lets the sort of the tag file merge the lines. */
+extern void sortTagFileFragment (const char *const fileName,
+								 tagFileFragment *const fragment);
+/* Merges the tags of a tag file made by another run (--merge-tags). */
+extern void mergeTagFile (const char *const fileName);
 extern void  setupWriter (void *writerClientData);
 extern bool  teardownWriter (const char *inputFilename);
 
@@ -38,6 +86,11 @@ extern void setNumTagsAdded (unsigned long nadded);
 extern unsigned long numTagsTotal(void);
 extern unsigned long maxTagsLine(void);
 extern void invalidatePatternCache(void);
+/* Returns a number changing whenever the same file position may refer
+ * to another input line than before. */
+extern unsigned int getPatternCacheGeneration (void);
+/* Counts the patterns taken from the cache and the ones made. */
+extern void getPatternCacheCounts (unsigned long *hits, unsigned long *misses);
 extern void tagFilePosition (MIOPos *p);
 extern void setTagFilePosition (MIOPos *p, bool truncation);
 extern const char* getTagFileDirectory (void);
@@ -60,6 +113,16 @@ extern bool writePseudoTag (const ptagDesc *pdesc,
 
 void          corkTagFile(unsigned int corkFlags);
 void          uncorkTagFile(void);
+/* Drops the entries of the cork queue but the first COUNT ones. Returns
+ * false if some of the entries to drop are written already. */
+extern bool truncateCorkQueue (size_t count);
+/* Keeps the entries in the cork queue until it is uncorked, instead of
+ * writing the ones closed as early as possible. */
+extern void holdCorkQueue (void);
+/* Increases by OFFSET the numbers, up to COUNT, of the anonymous names
+ * made with HASH, in the strings of the entries in the cork queue. */
+extern void renumberAnonInCorkQueue (const char *hash,
+									 unsigned int count, unsigned int offset);
 
 extern void makeFileTag (const char *const fileName);
 
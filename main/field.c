@@ -26,6 +26,7 @@
 #include "options_p.h"
 #include "parse_p.h"
 #include "read.h"
+#include "read_p.h"
 #include "routines.h"
 #include "trashbox.h"
 #include "writer_p.h"
@@ -72,6 +73,7 @@ static const char *renderFieldScopeKindName(const tagEntryInfo *const tag, const
 static const char *renderFieldEnd (const tagEntryInfo *const tag, const char *value, vString* b);
 static const char *renderFieldEpoch (const tagEntryInfo *const tag, const char *value, vString* b);
 static const char *renderFieldNth (const tagEntryInfo *const tag, const char *value, vString* b);
+static const char *renderFieldOffset (const tagEntryInfo *const tag, const char *value, vString* b);
 
 static bool doesContainAnyCharInName (const tagEntryInfo *const tag, const char *value, const char *chars);
 static bool doesContainAnyCharInInput (const tagEntryInfo *const tag, const char*value, const char *chars);
@@ -89,6 +91,7 @@ static bool     isXpathFieldAvailable     (const tagEntryInfo *const tag);
 static bool     isEndFieldAvailable       (const tagEntryInfo *const tag);
 static bool     isEpochAvailable          (const tagEntryInfo *const tag);
 static bool     isNthAvailable            (const tagEntryInfo *const tag);
+static bool     isOffsetAvailable         (const tagEntryInfo *const tag);
 
 static EsObject* getFieldValueForName (const tagEntryInfo *, const fieldDefinition *);
 static EsObject* setFieldValueForName (tagEntryInfo *, const fieldDefinition *, const EsObject *);
@@ -460,6 +463,17 @@ static fieldDefinition fieldDefinitionsUniversal [] = {
 		.isValueAvailable	= isNthAvailable,
 		.dataType			= FIELDTYPE_INTEGER,
 	},
+	[FIELD_OFFSET - FIELDS_UCTAGS_START] = {
+		.letter				= NUL_FIELD_LETTER,
+		.name				= "offset",
+		.description		= "byte offset of the line where the tag is in the input file",
+		.enabled			= false,
+		.render				= renderFieldOffset,
+		.renderNoEscaping	= NULL,
+		.doesContainAnyChar = NULL,
+		.isValueAvailable	= isOffsetAvailable,
+		.dataType			= FIELDTYPE_INTEGER,
+	},
 };
 
 
@@ -467,6 +481,9 @@ static unsigned int       fieldObjectUsed = 0;
 static unsigned int       fieldObjectAllocated = 0;
 static fieldObject* fieldObjects = NULL;
 
+/* Incremented when a field is enabled or disabled */
+static unsigned int       FieldEnablementGeneration = 0;
+
 extern void initFieldObjects (void)
 {
 	unsigned int i;
@@ -1163,6 +1180,24 @@ static const char *renderFieldNth (const tagEntryInfo *const tag,
 #undef buf_len
 }
 
+/* Unlike the pattern, the offset is taken without reading the line. */
+static const char *renderFieldOffset (const tagEntryInfo *const tag,
+									  const char *value, vString* b)
+{
+#define buf_len 21
+	static char buf[buf_len];
+	/* The file entry stands for the whole file. */
+	long offset = tag->isFileEntry
+		? 0: getInputFileOffsetForPosition (tag->filePosition);
+
+	if (offset >= 0
+		&& snprintf (buf, buf_len, "%ld", offset) > 0)
+		return renderAsIs (b, buf);
+	else
+		return NULL;
+#undef buf_len
+}
+
 static bool     isTyperefFieldAvailable  (const tagEntryInfo *const tag)
 {
 	return (tag->extensionFields.typeRef [0] != NULL
@@ -1234,6 +1269,18 @@ static bool isNthAvailable (const tagEntryInfo *const tag)
 	return (tag->extensionFields.nth != NO_NTH_FIELD)? true: false;
 }
 
+static bool isOffsetAvailable (const tagEntryInfo *const tag)
+{
+	return (tag->isPseudoTag)? false: true;
+}
+
+/* Writers can cache the set of the enabled fields while this returns
+ * the same value. */
+extern unsigned int getFieldEnablementGeneration (void)
+{
+	return FieldEnablementGeneration;
+}
+
 extern bool isFieldEnabled (fieldType type)
 {
 	return getFieldObject(type)->def->enabled;
@@ -1244,6 +1291,8 @@ extern bool enableField (fieldType type, bool state)
 	fieldDefinition *def = getFieldObject(type)->def;
 	bool old = def->enabled;
 	getFieldObject(type)->def->enabled = state;
+	if (old != state)
+		FieldEnablementGeneration++;
 
 	if (isCommonField (type))
 		verbose ("enable field \"%s\": %s\n",
@@ -1587,7 +1636,7 @@ static EsObject* getFieldValueForName (const tagEntryInfo *tag, const fieldDefin
 
 static EsObject* setFieldValueForName (tagEntryInfo *tag, const fieldDefinition *fdef, const EsObject *val)
 {
-	eFree ((char*) tag->name);
+	freeTagEntryMemory (tag->name);
 	const char *cstr = opt_string_get_cstr (val);
 	tag->name = eStrdup (cstr);
 	return es_false;
@@ -1685,7 +1734,7 @@ static EsObject* setFieldValueForTyperef (tagEntryInfo *tag, const fieldDefiniti
 
 	for (int i = 0; i < 2; i++)
 		if (tmp [i])
-			eFree ((char*)tmp[i]);
+			freeTagEntryMemory (tmp[i]);
 
 	return es_false;
 }
@@ -1794,8 +1843,7 @@ static EsObject* getFieldValueForCOMMON (const char *field, const tagEntryInfo *
 
 static EsObject* setFieldValueForCOMMON (const char **field, tagEntryInfo *tag, const fieldDefinition *fdef, const EsObject *obj)
 {
-	if (*field)
-		eFree ((char *)*field);
+	freeTagEntryMemory (*field);
 
 	const char *str = opt_string_get_cstr (obj);
 	*field = eStrdup (str);
@@ -1902,7 +1950,7 @@ static EsObject* setFieldValueForInherits (tagEntryInfo *tag, const fieldDefinit
 	if (es_object_get_type (obj) == OPT_TYPE_STRING)
 	{
 		if (tag->extensionFields.inheritance)
-			eFree ((void *)tag->extensionFields.inheritance);
+			freeTagEntryMemory (tag->extensionFields.inheritance);
 		const char *str = opt_string_get_cstr (obj);
 		tag->extensionFields.inheritance = eStrdup (str);
 	}
@@ -1910,7 +1958,7 @@ static EsObject* setFieldValueForInherits (tagEntryInfo *tag, const fieldDefinit
 	{
 		if (tag->extensionFields.inheritance)
 		{
-			eFree ((void *)tag->extensionFields.inheritance);
+			freeTagEntryMemory (tag->extensionFields.inheritance);
 			tag->extensionFields.inheritance = NULL;
 		}
 	}
@@ -65,8 +65,9 @@ typedef enum eFieldType { /* extension field content control */
 	FIELD_END_LINE,
 	FIELD_EPOCH,
 	FIELD_NTH,
+	FIELD_OFFSET,
 
-	FIELD_BUILTIN_LAST = FIELD_NTH,
+	FIELD_BUILTIN_LAST = FIELD_OFFSET,
 } fieldType ;
 
 #define fieldDataTypeFalgs "sib" /* used in --list-fields */
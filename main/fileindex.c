@@ -0,0 +1,265 @@
+/*
+*   Copyright (c) 2026, Universal Ctags Team
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License version 2 or (at your option) any later version.
+*
+*   This module implements --file-index option: writing an index of the
+*   input files of a tag file.
+*
+*   A reader listing the tags of an input file, for an outline of the
+*   file, can do no binary search in a tag file sorted by names; it must
+*   read all the tag lines. The file index records, for each input file,
+*   the offsets of its tag lines, so a reader reads only them.
+*
+*   The index is written to the file made by appending FILE_INDEX_SUFFIX
+*   to the tag file name. The TAG_FILE_INDEX pseudo tag in the tag file
+*   refers to it. The format of the index file is:
+*
+*	!_CTAGS_FILE_INDEX<TAB>1<TAB>size<TAB>files<NL>
+*	the table of the input files
+*	the postings of the input files
+*
+*   "size" is the size of the tag file. A reader uses the index only if
+*   it matches the tag file. "files" is the number of the entries in the
+*   table of the input files. An entry is the length of the name of the
+*   input file, the bytes of the name as written in the tag lines, the
+*   number of the tag lines of the file, and the size in bytes of the
+*   postings. The entries are in the order of the names compared byte
+*   by byte. The postings of a file are the differences between the
+*   offsets of its tag lines, the first one counted from 0, in the
+*   order of the table. The pseudo tags are not indexed.
+*
+*   All numbers after the first line, but the bytes of the names, are
+*   unsigned LEB128 varints.
+*/
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"  /* must always come first */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "entry_p.h"
+#include "fileindex_p.h"
+#include "htable.h"
+#include "mio.h"
+#include "numarray.h"
+#include "options_p.h"
+#include "ptag_p.h"
+#include "ptrarray.h"
+#include "read.h"
+#include "routines.h"
+#include "vstring.h"
+
+/*
+*   DATA DECLARATIONS
+*/
+#define FILE_INDEX_MAGIC "!_CTAGS_FILE_INDEX"
+#define FILE_INDEX_VERSION 1
+#define FILE_INDEX_SUFFIX ".fdx"
+
+typedef struct {
+	char *name;
+	unsigned long lines;
+	unsigned long last;
+	ucharArray *postings;
+} fileEntry;
+
+/*
+*   FUNCTION DEFINITIONS
+*/
+
+static void putVarint (MIO *mio, unsigned long n)
+{
+	while (n >= 0x80)
+	{
+		mio_putc (mio, (int) ((n & 0x7f) | 0x80));
+		n >>= 7;
+	}
+	mio_putc (mio, (int) n);
+}
+
+static void addVarint (ucharArray *a, unsigned long n)
+{
+	while (n >= 0x80)
+	{
+		ucharArrayAdd (a, (unsigned char) ((n & 0x7f) | 0x80));
+		n >>= 7;
+	}
+	ucharArrayAdd (a, (unsigned char) n);
+}
+
+static void deleteFileEntry (void *data)
+{
+	fileEntry *e = data;
+
+	eFree (e->name);
+	ucharArrayDelete (e->postings);
+	eFree (e);
+}
+
+static void addLine (hashTable *table, const char *name, size_t length,
+					 unsigned long offset)
+{
+	char *key = eStrndup (name, length);
+	fileEntry *e = hashTableGetItem (table, key);
+
+	if (e == NULL)
+	{
+		e = xMalloc (1, fileEntry);
+		e->name = key;
+		e->lines = 0;
+		e->last = 0;
+		e->postings = ucharArrayNew ();
+		hashTablePutItem (table, e->name, e);
+	}
+	else
+		eFree (key);
+
+	addVarint (e->postings, offset - e->last);
+	e->last = offset;
+	e->lines++;
+}
+
+static bool collectFileEntry (const void *key CTAGS_ATTR_UNUSED,
+							  void *value, void *user_data)
+{
+	ptrArrayAdd (user_data, value);
+	return true;
+}
+
+static int compareFileEntries (const void *a, const void *b)
+{
+	const fileEntry *ea = a;
+	const fileEntry *eb = b;
+
+	return strcmp (ea->name, eb->name);
+}
+
+static bool writeIndexFile (MIO *const in, const char *const indexFileName)
+{
+	MIO *out;
+	vString *line = vStringNew ();
+	hashTable *table = hashTableNew (1024, hashCstrhash, hashCstreq,
+									 NULL, deleteFileEntry);
+	ptrArray *entries = ptrArrayNew (NULL);
+	long size;
+	bool ok;
+
+	mio_seek (in, 0L, SEEK_END);
+	size = mio_tell (in);
+	mio_seek (in, 0L, SEEK_SET);
+
+	while (true)
+	{
+		const long offset = mio_tell (in);
+		const char *l;
+		const char *file;
+		const char *tab;
+
+		if (readLineRaw (line, in) == NULL)
+			break;
+
+		l = vStringValue (line);
+		if (strncmp (l, PSEUDO_TAG_PREFIX, strlen (PSEUDO_TAG_PREFIX)) == 0)
+			continue;
+		file = strchr (l, '\t');
+		if (file == NULL)
+			continue;
+		file++;
+		tab = strchr (file, '\t');
+		if (tab == NULL)
+			continue;
+
+		addLine (table, file, tab - file, (unsigned long) offset);
+	}
+	vStringDelete (line);
+
+	hashTableForeachItem (table, collectFileEntry, entries);
+	ptrArraySort (entries, compareFileEntries);
+
+	out = mio_new_file (indexFileName, "wb");
+	ok = (out != NULL);
+	if (ok)
+		ok = (mio_printf (out, "%s\t%d\t%ld\t%u\n", FILE_INDEX_MAGIC,
+						  FILE_INDEX_VERSION, size,
+						  ptrArrayCount (entries)) >= 0);
+	for (unsigned int i = 0; ok && i < ptrArrayCount (entries); i++)
+	{
+		const fileEntry *e = ptrArrayItem (entries, i);
+		const size_t length = strlen (e->name);
+
+		putVarint (out, (unsigned long) length);
+		mio_write (out, e->name, 1, length);
+		putVarint (out, e->lines);
+		putVarint (out, ucharArrayCount (e->postings));
+	}
+	for (unsigned int i = 0; ok && i < ptrArrayCount (entries); i++)
+	{
+		const fileEntry *e = ptrArrayItem (entries, i);
+		const unsigned int count = ucharArrayCount (e->postings);
+		for (unsigned int j = 0; j < count; j++)
+			mio_putc (out, ucharArrayItem (e->postings, j));
+	}
+
+	if (out && mio_unref (out) != 0)
+		ok = false;
+	ptrArrayDelete (entries);
+	hashTableDelete (table);
+	return ok;
+}
+
+extern void writeFileIndex (const char *const tagFileName)
+{
+	MIO *in = mio_new_file (tagFileName, "rb");
+	vString *indexFileName;
+	vString *tmp;
+
+	if (in == NULL)
+	{
+		error (WARNING | PERROR, "cannot read tag file \"%s\" for the file index",
+			   tagFileName);
+		return;
+	}
+
+	indexFileName = vStringNewInit (tagFileName);
+	vStringCatS (indexFileName, FILE_INDEX_SUFFIX);
+
+	/* Write to a temporary file first not to leave a broken index. */
+	tmp = vStringNewCopy (indexFileName);
+	vStringCatS (tmp, ".tmp");
+
+	verbose ("writing file index \"%s\"\n", vStringValue (indexFileName));
+	if (! writeIndexFile (in, vStringValue (tmp))
+		|| rename (vStringValue (tmp), vStringValue (indexFileName)) != 0)
+	{
+		error (WARNING | PERROR, "cannot write file index \"%s\"",
+			   vStringValue (indexFileName));
+		remove (vStringValue (tmp));
+	}
+
+	mio_unref (in);
+	vStringDelete (tmp);
+	vStringDelete (indexFileName);
+}
+
+extern bool ptagMakeFileIndex (ptagDesc *desc, langType language CTAGS_ATTR_UNUSED,
+							   const void *data)
+{
+	const optionValues *opt = data;
+	vString *name;
+	bool r;
+
+	if (! opt->fileIndex)
+		return false;
+
+	name = vStringNewInit (baseFilename (opt->tagFileName));
+	vStringCatS (name, FILE_INDEX_SUFFIX);
+	r = writePseudoTag (desc, vStringValue (name),
+						"index of input files", NULL);
+	vStringDelete (name);
+	return r;
+}
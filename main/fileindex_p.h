@@ -0,0 +1,29 @@
+/*
+*   Copyright (c) 2026, Universal Ctags Team
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License version 2 or (at your option) any later version.
+*
+*   Main part private interface to fileindex.c
+*/
+#ifndef CTAGS_MAIN_FILEINDEX_PRIVATE_H
+#define CTAGS_MAIN_FILEINDEX_PRIVATE_H
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"  /* must always come first */
+
+#include "types.h"
+
+/*
+*   FUNCTION PROTOTYPES
+*/
+
+/* Writes the index of the input files in the tag file. */
+extern void writeFileIndex (const char *const tagFileName);
+
+extern bool ptagMakeFileIndex (ptagDesc *desc, langType language,
+							   const void *data);
+
+#endif  /* CTAGS_MAIN_FILEINDEX_PRIVATE_H */
@@ -18,42 +18,95 @@
 #include "field_p.h"
 #include "parse.h"
 #include "routines.h"
+#include "trashbox.h"
+#include "vstring.h"
 #include <string.h>
 #include <errno.h>
 
 typedef union uFmtSpec {
-	char *const_str;
+	struct {
+		char *str;
+		size_t length;
+	} literal;
 	struct {
 		fieldType ftype;
 		int width;
-		char *raw_fmtstr;
+		bool leftJustified;
+		bool truncation;
+		/* compatible [t] is true if a parser field of type t is printed
+		 * for this element. This is made for the fields defined when the
+		 * element is printed first, and made again if more fields are
+		 * defined after that. */
+		bool *compatible;
+		int compatibleCount;
 	} field;
 } fmtSpec;
 
 struct sFmtElement {
 	union uFmtSpec spec;
-	int (* printer) (fmtSpec*, MIO* fp, const tagEntryInfo *);
+	int (* printer) (fmtSpec*, vString* buf, const tagEntryInfo *);
 	struct sFmtElement *next;
 };
 
-static int printLiteral (fmtSpec* fspec, MIO* fp, const tagEntryInfo * tag CTAGS_ATTR_UNUSED)
+/* A line is assembled in this buffer, and written at once. */
+static vString *LineBuffer;
+
+static int printLiteral (fmtSpec* fspec, vString* buf, const tagEntryInfo * tag CTAGS_ATTR_UNUSED)
 {
-	return mio_puts (fp, fspec->const_str);
+	vStringNCatSUnsafe (buf, fspec->literal.str, fspec->literal.length);
+	return (int) fspec->literal.length;
 }
 
-static bool isParserFieldCompatibleWithFtype (const tagField *pfield, int baseFtype)
+static void prepareCompatibleFields (fmtSpec* fspec)
 {
+	int count = countFields ();
+	fieldType ftype;
+
+	if (fspec->field.compatible && fspec->field.compatibleCount == count)
+		return;
+
+	fspec->field.compatible = xRealloc (fspec->field.compatible, count, bool);
+	memset (fspec->field.compatible, 0, sizeof (bool) * count);
+	fspec->field.compatibleCount = count;
+
+	ftype = fspec->field.ftype;
 	do {
-		if (pfield->ftype == baseFtype)
-			return true;
-		baseFtype = nextSiblingField (baseFtype);
-	} while (baseFtype != FIELD_UNKNOWN);
-	return false;
+		fspec->field.compatible [ftype] = true;
+		ftype = nextSiblingField (ftype);
+	} while (ftype != FIELD_UNKNOWN);
 }
 
-static int printTagField (fmtSpec* fspec, MIO* fp, const tagEntryInfo * tag)
+/* Same as "%*s", "%-*s", "%.*s", or "%-.*s" of printf. */
+static int putWithWidth (vString* buf, const char *str, const fmtSpec* fspec)
+{
+	size_t width = fspec->field.width;
+	size_t length = strlen (str);
+
+	if (fspec->field.truncation)
+	{
+		if (length > width)
+			length = width;
+		vStringNCatSUnsafe (buf, str, length);
+		return (int) length;
+	}
+
+	if (length >= width)
+	{
+		vStringNCatSUnsafe (buf, str, length);
+		return (int) length;
+	}
+
+	if (fspec->field.leftJustified)
+		vStringNCatSUnsafe (buf, str, length);
+	for (size_t i = length; i < width; i++)
+		vStringPut (buf, ' ');
+	if (! fspec->field.leftJustified)
+		vStringNCatSUnsafe (buf, str, length);
+	return (int) width;
+}
+
+static int printTagField (fmtSpec* fspec, vString* buf, const tagEntryInfo * tag)
 {
-	int i;
 	int width = fspec->field.width;
 	int ftype;
 	const char* str = NULL;
@@ -67,10 +120,12 @@ static int printTagField (fmtSpec* fspec, MIO* fp, const tagEntryInfo * tag)
 		unsigned int findex;
 		const tagField *f;
 
+		prepareCompatibleFields (fspec);
 		for (findex = 0; findex < tag->usedParserFields; findex++)
 		{
 			f = getParserFieldForIndex(tag, findex);
-			if (isParserFieldCompatibleWithFtype (f, ftype))
+			if (f->ftype < fspec->field.compatibleCount
+				&& fspec->field.compatible [f->ftype])
 				break;
 		}
 
@@ -103,20 +158,21 @@ static int printTagField (fmtSpec* fspec, MIO* fp, const tagEntryInfo * tag)
 		str = "";
 
 	if (width)
-		i = mio_printf (fp, fspec->field.raw_fmtstr, width, str);
+		return putWithWidth (buf, str, fspec);
 	else
 	{
-		mio_puts (fp, str);
-		i = strlen (str);
+		size_t length = strlen (str);
+		vStringNCatSUnsafe (buf, str, length);
+		return (int) length;
 	}
-	return i;
 }
 
 static fmtElement** queueLiteral (fmtElement **last, char *literal)
 {
 	fmtElement *cur = xMalloc (1, fmtElement);
 
-	cur->spec.const_str = literal;
+	cur->spec.literal.str = literal;
+	cur->spec.literal.length = strlen (literal);
 	cur->printer = printLiteral;
 	cur->next = NULL;
 	*last = cur;
@@ -219,16 +275,16 @@ static fmtElement** queueTagField (fmtElement **last, long width, bool truncatio
 
 	cur->spec.field.width = width;
 	cur->spec.field.ftype = ftype;
+	cur->spec.field.leftJustified = false;
+	cur->spec.field.truncation = truncation;
+	cur->spec.field.compatible = NULL;
+	cur->spec.field.compatibleCount = 0;
 
 	if (width < 0)
 	{
 		cur->spec.field.width *= -1;
-		cur->spec.field.raw_fmtstr = (truncation? "%-.*s": "%-*s");
+		cur->spec.field.leftJustified = true;
 	}
-	else if (width > 0)
-		cur->spec.field.raw_fmtstr = (truncation? "%.*s": "%*s");
-	else
-		cur->spec.field.raw_fmtstr = NULL;
 
 	enableField (ftype, true);
 	if (language == LANG_AUTO)
@@ -366,11 +422,21 @@ extern int fmtPrint   (fmtElement * fmtelts, MIO* fp, const tagEntryInfo *tag)
 {
 	fmtElement *f = fmtelts;
 	int i = 0;
+
+	if (LineBuffer == NULL)
+	{
+		LineBuffer = vStringNew ();
+		DEFAULT_TRASH_BOX (LineBuffer, vStringDelete);
+	}
+	else
+		vStringClear (LineBuffer);
+
 	while (f)
 	{
-		i += f->printer (&(f->spec), fp, tag);
+		i += f->printer (&(f->spec), LineBuffer, tag);
 		f = f->next;
 	}
+	mio_write (fp, vStringValue (LineBuffer), 1, vStringLength (LineBuffer));
 	return i;
 }
 
@@ -384,9 +450,11 @@ extern void fmtDelete  (fmtElement * fmtelts)
 		next = f->next;
 		if (f->printer == printLiteral)
 		{
-			eFree (f->spec.const_str);
-			f->spec.const_str = NULL;
+			eFree (f->spec.literal.str);
+			f->spec.literal.str = NULL;
 		}
+		else if (f->spec.field.compatible)
+			eFree (f->spec.field.compatible);
 		f->next = NULL;
 		eFree (f);
 		f = next;
@@ -29,20 +29,29 @@
 #endif
 #endif	/* MAIN */
 
+#include <stdint.h>
 #include <string.h>
 
-
+/* The items are stored in an open addressing table with linear probing.
+ * The number of the slots is a power of 2, and the table grows before
+ * it is 3/4 full. Deleting an item shifts the items after it backward
+ * instead of leaving a tombstone.
+ *
+ * The items having a same hash value are kept on the probe sequence in
+ * the order from the last added one, so the first one found for a key
+ * is the last one added. */
 typedef struct sHashEntry hentry;
 struct sHashEntry {
 	void *key;
 	void *value;
 	unsigned int hash;
-	hentry *next;
+	bool used;
 };
 
 struct sHashTable {
-	hentry** table;
-	unsigned int size;
+	hentry* table;
+	unsigned int size;			/* the number of the slots */
+	unsigned int bits;			/* size == 1 << bits */
 	unsigned int count;
 	hashTableHashFunc hashfn;
 	hashTableEqualFunc equalfn;
@@ -52,23 +61,22 @@ struct sHashTable {
 	hashTableDeleteFunc valForNotUnknownKeyfreefn;
 };
 
-struct chainTracker {
-	const void *const target_key;
-	hashTableForeachFunc user_proc;
-	void *user_data;
-	hashTableEqualFunc equalfn;
-};
+#define HTABLE_MIN_BITS 3
 
-static hentry* entry_new (void *key, void *value, unsigned int hash, hentry* next)
+static unsigned int home_slot (const hashTable *htable, unsigned int hash)
 {
-	hentry* entry = xMalloc (1, hentry);
+	return hash & (htable->size - 1);
+}
 
-	entry->key = key;
-	entry->value = value;
-	entry->next = next;
-	entry->hash = hash;
+static unsigned int next_slot (const hashTable *htable, unsigned int i)
+{
+	return (i + 1) & (htable->size - 1);
+}
 
-	return entry;
+static bool entry_match (const hashTable *htable, const hentry *entry,
+						 const void *key, unsigned int hash)
+{
+	return entry->hash == hash && htable->equalfn (key, entry->key);
 }
 
 static void entry_reset  (hentry* entry,
@@ -87,99 +95,11 @@ static void entry_reset  (hentry* entry,
 	entry->value = newval;
 }
 
-static hentry* entry_destroy (hentry* entry,
-			      hashTableDeleteFunc keyfreefn,
-			      hashTableDeleteFunc valfreefn)
-{
-	hentry* tmp;
-
-	entry_reset (entry, NULL, NULL, keyfreefn, valfreefn);
-	tmp = entry->next;
-	eFree (entry);
-
-	return tmp;
-}
-
-static void  entry_reclaim (hentry* entry,
-			    hashTableDeleteFunc keyfreefn,
-			    hashTableDeleteFunc valfreefn)
-{
-	while (entry)
-		entry = entry_destroy (entry, keyfreefn, valfreefn);
-}
-
-/* Looking for an entry having KEY as its key in the chain:
- * entry, entry->next, entry->next->next,...
- *
- * We have a chance to optimize for the case when a same key is
- * used repeatedly. By moving the entry found in the last time to
- * the head of the chain, we can avoid taking time for tracking
- * down the ->next-> chain.
- * The cost for the optimization is very small.
- */
-static void *entry_find (hentry** root_entry, const void* const key, hashTableEqualFunc equalfn,
-						 void *valForNotUnknownKey)
-{
-	hentry *entry = *root_entry;
-	hentry *last = NULL;
-	while (entry)
-	{
-		if (equalfn( key, entry->key))
-		{
-			if (last)
-			{
-				last->next = entry->next;
-				entry->next = *root_entry;
-				*root_entry = entry;
-			}
-			return entry->value;
-		}
-
-		last = entry;
-		entry = entry->next;
-	}
-	return valForNotUnknownKey;
-}
-
-static bool		entry_delete (hentry **entry, const void *key, hashTableEqualFunc equalfn,
-			      hashTableDeleteFunc keyfreefn, hashTableDeleteFunc valfreefn)
-{
-	while (*entry)
-	{
-		if (equalfn (key, (*entry)->key))
-		{
-			*entry = entry_destroy (*entry, keyfreefn, valfreefn);
-			return true;
-		}
-		entry = &((*entry)->next);
-	}
-	return false;
-}
-
-static bool		entry_update (hentry *entry, void *key, void *value, hashTableEqualFunc equalfn,
-			      hashTableDeleteFunc keyfreefn, hashTableDeleteFunc valfreefn)
+static void table_alloc (hashTable *htable, unsigned int bits)
 {
-	while (entry)
-	{
-		if (equalfn (key, entry->key))
-		{
-			entry_reset (entry, key, value, keyfreefn, valfreefn);
-			return true;
-		}
-		entry = entry->next;
-	}
-	return false;
-}
-
-static bool  entry_foreach (hentry *entry, hashTableForeachFunc proc, void *user_data)
-{
-	while (entry)
-	{
-		if (!proc (entry->key, entry->value, user_data))
-			return false;
-		entry = entry->next;
-	}
-	return true;
+	htable->bits = bits;
+	htable->size = 1U << bits;
+	htable->table = xCalloc (htable->size, hentry);
 }
 
 extern hashTable *hashTableNew    (unsigned int size,
@@ -189,17 +109,15 @@ extern hashTable *hashTableNew    (unsigned int size,
 				   hashTableDeleteFunc valfreefn)
 {
 	hashTable *htable;
+	unsigned int bits = HTABLE_MIN_BITS;
 
 	htable = xMalloc (1, hashTable);
 
-	if (size < 3)
-		size = 3;
-	if ((size % 2) == 0)
-		size++;
-
-	htable->size = size;
+	/* SIZE tells the number of the items expected. */
+	while ((1U << bits) < size && bits < 31)
+		bits++;
+	table_alloc (htable, bits);
 	htable->count = 0;
-	htable->table = xCalloc (size, hentry*);
 
 	htable->hashfn = hashfn;
 	htable->equalfn = equalfn;
@@ -241,136 +159,184 @@ extern void       hashTableClear (hashTable *htable)
 	if (!htable)
 		return;
 
-	for (i = 0; i < htable->size; i++)
+	if (htable->count == 0)
+		return;
+
+	if (htable->keyfreefn || htable->valfreefn)
 	{
-		hentry *entry;
+		for (i = 0; i < htable->size; i++)
+		{
+			hentry *entry = htable->table + i;
+			if (entry->used)
+				entry_reset (entry, NULL, NULL, htable->keyfreefn, htable->valfreefn);
+		}
+	}
 
-		entry = htable->table[i];
-		entry_reclaim (entry, htable->keyfreefn, htable->valfreefn);
-		htable->table[i] = NULL;
+	/* A table cleared after each of many small inputs, like the cork
+	 * tables for the guest regions of a file, would pay for clearing
+	 * all the slots sized for the largest input every time. Shrink
+	 * the table to the size the last use needed. */
+	unsigned int bits = HTABLE_MIN_BITS;
+	while ((1U << bits) < htable->count * 2)
+		bits++;
+	if (bits + 2 < htable->bits)
+	{
+		eFree (htable->table);
+		table_alloc (htable, bits);
 	}
+	else
+		memset (htable->table, 0, htable->size * sizeof (hentry));
+	htable->count = 0;
 }
 
-static void       hashTablePutItem00    (hashTable *htable, void *key, void *value, unsigned int h)
+/* Put ENTRY at the end of its probe sequence. */
+static void       hashTablePlace       (hashTable *htable, const hentry *entry)
 {
-	unsigned int i = h % htable->size;
-	htable->table[i] = entry_new(key, value, h, htable->table[i]);
-	htable->count++;
+	unsigned int i = home_slot (htable, entry->hash);
+
+	while (htable->table[i].used)
+		i = next_slot (htable, i);
+	htable->table[i] = *entry;
 }
 
-/* TODO: A pre-calculated array can be used instead of
- * finding a new one at runtume. */
-static unsigned int
-prime_double(unsigned int i)
+static void       hashTableGrow        (hashTable *htable)
 {
-	Assert (i > 2);
-	Assert (i % 2);
+	hentry *old_table = htable->table;
+	unsigned int old_size = htable->size;
+	unsigned int start;
+
+	table_alloc (htable, htable->bits + 1);
 
-	for (unsigned int c = 2 * i + 1; ; c += 2)
+	/* Start from an empty slot to move the items of a probe sequence
+	 * wrapping around the end of the table in their order. */
+	for (start = 0; old_table[start].used; start++)
+		;
+	for (unsigned int n = 1; n <= old_size; n++)
 	{
-		for (unsigned int i0 = 3; i0 < i; i0 += 2)
-		{
-			if ((c % i0) == 0)
-				goto next;
-		}
-		return c;
-	next:;
+		hentry *entry = old_table + ((start + n) & (old_size - 1));
+		if (entry->used)
+			hashTablePlace (htable, entry);
 	}
-
-	return i;
+	eFree (old_table);
 }
 
-static void       hashTableGrow        (hashTable *htable)
+static void       hashTablePutItem0    (hashTable *htable, void *key, void *value, unsigned int h)
 {
-	unsigned int current_size = htable->size;
-	unsigned int new_size = prime_double (current_size);
+	hentry entry = {
+		.key = key,
+		.value = value,
+		.hash = h,
+		.used = true,
+	};
 
-	if (new_size <= current_size)
-		return;
+	if ((htable->count + 1) * 4 > htable->size * 3)
+		hashTableGrow (htable);
 
-	hentry** new_table = xCalloc (new_size, hentry*);
-	for (unsigned int i = 0; i < current_size; i++)
+	/* The new item comes before the items having the same hash value,
+	 * including the items for the same key. */
+	unsigned int i = home_slot (htable, h);
+	while (htable->table[i].used)
 	{
-		hentry *entry;
-		while ((entry = htable->table[i]))
+		hentry *slot = htable->table + i;
+		if (slot->hash == entry.hash)
 		{
-			unsigned int hash = entry->hash;
-			unsigned int j = hash % new_size;
-			htable->table[i] = entry->next;
-			entry->next = new_table[j];
-			new_table[j] = entry;
+			hentry tmp = *slot;
+			*slot = entry;
+			entry = tmp;
 		}
+		i = next_slot (htable, i);
 	}
+	htable->table[i] = entry;
+	htable->count++;
+}
 
-	hentry** old_table = htable->table;
-	htable->table = new_table;
-	htable->size = new_size;
-	eFree (old_table);
+extern void       hashTablePutItem    (hashTable *htable, void *key, void *value)
+{
+	hashTablePutItem0 (htable, key, value, htable->hashfn (key));
 }
 
-static void       hashTablePutItem0    (hashTable *htable, void *key, void *value, unsigned int h)
+static hentry*    hashTableFind        (hashTable *htable, const void *key, unsigned int h)
 {
-	if (((double)htable->count / (double)htable->size) < 0.8)
+	for (unsigned int i = home_slot (htable, h);
+		 htable->table[i].used;
+		 i = next_slot (htable, i))
 	{
-		hashTablePutItem00 (htable, key, value,  h);
-		return;
+		if (entry_match (htable, htable->table + i, key, h))
+			return htable->table + i;
 	}
-
-	hashTableGrow (htable);
-	hashTablePutItem00 (htable, key, value, h);
+	return NULL;
 }
 
-extern void       hashTablePutItem    (hashTable *htable, void *key, void *value)
+extern void*      hashTableGetItem   (hashTable *htable, const void * key)
 {
-	hashTablePutItem0 (htable, key, value, htable->hashfn (key));
+	hentry *entry = hashTableFind (htable, key, htable->hashfn (key));
+
+	return entry? entry->value: htable->valForNotUnknownKey;
 }
 
-extern void*      hashTableGetItem   (hashTable *htable, const void * key)
+/* Fill the slot of ENTRY with the items after it in the probe sequence. */
+static void       hashTableShiftBack   (hashTable *htable, hentry *entry)
 {
-	unsigned int h, i;
+	unsigned int i = entry - htable->table;
+	unsigned int j = i;
 
-	h = htable->hashfn (key);
-	i = h % htable->size;
-	return entry_find(& (htable->table[i]), key, htable->equalfn, htable->valForNotUnknownKey);
+	while (true)
+	{
+		j = next_slot (htable, j);
+		if (!htable->table[j].used)
+			break;
+
+		/* The item at J can move to I unless its home slot is in (I, J]. */
+		unsigned int k = home_slot (htable, htable->table[j].hash);
+		bool stay = (i <= j)
+			? (i < k && k <= j)
+			: (i < k || k <= j);
+		if (stay)
+			continue;
+
+		htable->table[i] = htable->table[j];
+		i = j;
+	}
+	memset (htable->table + i, 0, sizeof (hentry));
 }
 
 extern bool     hashTableDeleteItem (hashTable *htable, const void *key)
 {
-	unsigned int h;
-	unsigned int i;
-	h = htable->hashfn (key);
-	i = h % htable->size;
+	hentry *entry = hashTableFind (htable, key, htable->hashfn (key));
+
+	if (!entry)
+		return false;
 
-	bool r = entry_delete(&htable->table[i], key,
-			    htable->equalfn, htable->keyfreefn, htable->valfreefn);
-	if (r)
-		htable->count--;
-	return r;
+	entry_reset (entry, NULL, NULL, htable->keyfreefn, htable->valfreefn);
+	hashTableShiftBack (htable, entry);
+	htable->count--;
+	return true;
 }
 
 extern bool    hashTableUpdateItem (hashTable *htable, const void *key, void *value)
 {
-	unsigned int h, i;
+	hentry *entry = hashTableFind (htable, key, htable->hashfn (key));
+
+	if (!entry)
+		return false;
 
-	h = htable->hashfn (key);
-	i = h % htable->size;
-	bool r = entry_update(htable->table[i], (void *)key, value,
-						  htable->equalfn, NULL, htable->valfreefn);
-	return r;
+	entry_reset (entry, (void *)key, value, NULL, htable->valfreefn);
+	return true;
 }
 
 extern bool    hashTableUpdateOrPutItem (hashTable *htable, void *key, void *value)
 {
-	unsigned int h, i;
+	unsigned int h = htable->hashfn (key);
+	hentry *entry = hashTableFind (htable, key, h);
 
-	h = htable->hashfn (key);
-	i = h % htable->size;
-	bool r = entry_update(htable->table[i], key, value,
-						  htable->equalfn, NULL, htable->valfreefn);
-	if (!r)
-		hashTablePutItem0(htable, key, value, h);
+	if (entry)
+	{
+		entry_reset (entry, key, value, NULL, htable->valfreefn);
+		return true;
+	}
 
-	return r;
+	hashTablePutItem0(htable, key, value, h);
+	return false;
 }
 
 extern bool    hashTableHasItem    (hashTable *htable, const void *key)
@@ -383,18 +349,9 @@ extern bool       hashTableForeachItem (hashTable *htable, hashTableForeachFunc
 	unsigned int i;
 
 	for (i = 0; i < htable->size; i++)
-		if (!entry_foreach(htable->table[i], proc, user_data))
-			return false;
-	return true;
-}
-
-static bool track_chain (const void *const key, void *value, void *chain_data)
-{
-	struct chainTracker *chain_tracker = chain_data;
-
-	if (chain_tracker->equalfn (chain_tracker->target_key, key))
 	{
-		if (! chain_tracker->user_proc (key, value, chain_tracker->user_data))
+		hentry *entry = htable->table + i;
+		if (entry->used && !proc (entry->key, entry->value, user_data))
 			return false;
 	}
 	return true;
@@ -402,55 +359,46 @@ static bool track_chain (const void *const key, void *value, void *chain_data)
 
 extern bool       hashTableForeachItemOnChain (hashTable *htable, const void *key, hashTableForeachFunc proc, void *user_data)
 {
-	unsigned int h, i;
-	struct chainTracker chain_tracker = {
-		.target_key = key,
-		.user_proc = proc,
-		.user_data = user_data,
-		.equalfn   = htable->equalfn,
-	};
+	unsigned int h = htable->hashfn (key);
 
-	h = htable->hashfn (key);
-	i = h % htable->size;
-	if (!entry_foreach(htable->table[i], track_chain, &chain_tracker))
-		return false;
+	for (unsigned int i = home_slot (htable, h);
+		 htable->table[i].used;
+		 i = next_slot (htable, i))
+	{
+		hentry *entry = htable->table + i;
+		if (entry_match (htable, entry, key, h)
+			&& !proc (entry->key, entry->value, user_data))
+			return false;
+	}
 	return true;
 }
 
 extern void hashTablePrintStatistics(hashTable *htable)
 {
 	if (htable->size == 0 || htable->count == 0)
+	{
 		fprintf(stderr, "size: %u, count: %u, average: 0\n",
 				htable->size, htable->count);
-
-	double sum = 0.0;
-	for (size_t i = 0; i < htable->size; i++)
-	{
-		hentry *e = htable->table[i];
-		while (e)
-		{
-			sum += 1.0;
-			e = e->next;
-		}
+		return;
 	}
-	double average = sum / (double)htable->size;
 
-	double variance = 0.0;
-	for (size_t i = 0; i < htable->size; i++)
+	/* The number of the probes for finding each item */
+	double sum = 0.0;
+	unsigned int longest = 0;
+	for (unsigned int i = 0; i < htable->size; i++)
 	{
-		double sum0 = 0;
-		hentry *e = htable->table[i];
-		while (e)
-		{
-			sum0 += 1.0;
-			e = e->next;
-		}
-		double d = sum0 - average;
-		variance += (d * d);
+		if (!htable->table[i].used)
+			continue;
+		unsigned int k = home_slot (htable, htable->table[i].hash);
+		unsigned int probes = ((i - k) & (htable->size - 1)) + 1;
+		sum += probes;
+		if (probes > longest)
+			longest = probes;
 	}
-	variance = variance / (double)htable->size;
-	fprintf(stderr, "size: %u, count: %u, average: %lf, s.d.: sqrt(%lf)\n",
-			htable->size, htable->count, average, variance);
+	fprintf(stderr, "size: %u, count: %u, load: %lf, average probes: %lf, longest: %u\n",
+			htable->size, htable->count,
+			(double)htable->count / (double)htable->size,
+			sum / (double)htable->count, longest);
 }
 
 extern unsigned int hashTableCountItem   (hashTable *htable)
@@ -460,14 +408,11 @@ extern unsigned int hashTableCountItem   (hashTable *htable)
 
 unsigned int hashPtrhash (const void * const x)
 {
-	union {
-		const void * ptr;
-		unsigned int ui;
-	} v;
-	v.ui = 0;
-	v.ptr = x;
+	const uintptr_t p = (uintptr_t) x;
 
-	return v.ui;
+	/* The lower bits of a pointer are zero because of the alignment,
+	 * and a slot is chosen with the lower bits of the hash value. */
+	return (unsigned int) ((p >> 3) ^ (p >> 19));
 }
 
 bool hashPtreq (const void *const a, const void *const b)
@@ -506,10 +451,24 @@ casedjb2(const unsigned char *str)
 }
 
 
+/* djb2 gives similar strings ("f1", "f2", ...) consecutive values. A slot
+ * of the table is chosen with the lower bits of the hash value, and such
+ * values would make one long probe sequence. */
+static unsigned int mixHash (unsigned long hash)
+{
+	/* unsigned long may have 32 bits only. */
+	unsigned int h = (unsigned int) (hash ^ ((hash >> 16) >> 16));
+
+	h ^= h >> 16;
+	h *= 0x45d9f3bU;
+	h ^= h >> 16;
+	return h;
+}
+
 unsigned int hashCstrhash (const void *const x)
 {
 	const char *const s = x;
-	return (unsigned int)djb2((const unsigned char *)s);
+	return mixHash (djb2((const unsigned char *)s));
 }
 
 bool hashCstreq (const void * const a, const void *const b)
@@ -541,7 +500,7 @@ bool hashInteq (const void *const a, const void *const b)
 unsigned int hashCstrcasehash (const void *const x)
 {
 	const char *const s = x;
-	return (unsigned int)casedjb2((const unsigned char *)s);
+	return mixHash (casedjb2((const unsigned char *)s));
 }
 
 bool hashCstrcaseeq (const void *const a, const void *const b)
@@ -0,0 +1,392 @@
+/*
+*   Copyright (c) 2026, Universal Ctags Team
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License version 2 or (at your option) any later version.
+*
+*   This module implements --use-ignore-files option: pruning the files
+*   and directories listed in .gitignore and .ignore files during
+*   recursion.
+*
+*   When the recursion enters a directory, the rules in the .gitignore
+*   and .ignore files of the directory are pushed on a stack, and they
+*   are popped when the recursion leaves it. An entry matching a rule is
+*   skipped before it is examined, so an ignored directory is never
+*   opened.
+*
+*   The syntax of the rules follows gitignore(5):
+*   - A blank line and a line starting with '#' are skipped.
+*   - '!' at the start negates the rule.
+*   - '/' at the end makes the rule match only a directory.
+*   - A rule having '/' at the start or in the middle matches the path
+*     relative to the directory of the ignore file. Another rule matches
+*     the name of an entry at any level.
+*   - '*' and '?' don't match '/'. "**" matches any path components when
+*     it is a whole path component.
+*
+*   The last matching rule in a directory decides. The rules of a deeper
+*   directory take precedence over the ones of its parent directories,
+*   and the rules of .ignore take precedence over the ones of .gitignore.
+*   Ignore files in the parent directories of a directory given on the
+*   command line, .git/info/exclude, and the global excludes file of git
+*   are not read.
+*/
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"  /* must always come first */
+
+#include <ctype.h>
+#include <string.h>
+
+#include "debug.h"
+#include "ignorefile_p.h"
+#include "options.h"
+#include "ptrarray.h"
+#include "routines.h"
+#include "routines_p.h"
+#include "strlist.h"
+#include "vstring.h"
+
+/*
+*   DATA DECLARATIONS
+*/
+typedef struct sIgnoreRule {
+	char *pattern;
+	bool negated;
+	bool dirOnly;
+	bool anchored;		/* matching the relative path, not the name */
+} ignoreRule;
+
+typedef struct sIgnoreFrame {
+	char *dir;
+	size_t dirLength;
+	ptrArray *rules;	/* NULL if the directory has no ignore file */
+} ignoreFrame;
+
+/*
+*   DATA DEFINITIONS
+*/
+static const char *const IgnoreFileNames [] = {
+	/* In the ascending order of precedence */
+	".gitignore",
+	".ignore",
+};
+
+static ptrArray *IgnoreFrames = NULL;
+
+/*
+*   FUNCTION DEFINITIONS
+*/
+
+static void deleteIgnoreRule (void *data)
+{
+	ignoreRule *rule = data;
+
+	eFree (rule->pattern);
+	eFree (rule);
+}
+
+static void deleteIgnoreFrame (void *data)
+{
+	ignoreFrame *frame = data;
+
+	eFree (frame->dir);
+	if (frame->rules)
+		ptrArrayDelete (frame->rules);
+	eFree (frame);
+}
+
+static ignoreRule *newIgnoreRule (const char *line)
+{
+	ignoreRule *rule;
+	vString *pattern;
+	const char *slash;
+
+	if (line [0] == '#')
+		return NULL;
+
+	rule = xCalloc (1, ignoreRule);
+	if (line [0] == '!')
+	{
+		rule->negated = true;
+		line++;
+	}
+	else if (line [0] == '\\'
+			 && (line [1] == '!' || line [1] == '#'))
+		line++;
+
+	pattern = vStringNewInit (line);
+	if (vStringLast (pattern) == '/')
+	{
+		rule->dirOnly = true;
+		vStringChop (pattern);
+	}
+
+	slash = strchr (vStringValue (pattern), '/');
+	if (slash)
+	{
+		rule->anchored = true;
+		if (slash == vStringValue (pattern))
+		{
+			vString *tmp = vStringNewInit (slash + 1);
+			vStringDelete (pattern);
+			pattern = tmp;
+		}
+	}
+
+	if (vStringIsEmpty (pattern))
+	{
+		vStringDelete (pattern);
+		eFree (rule);
+		return NULL;
+	}
+
+	rule->pattern = vStringDeleteUnwrap (pattern);
+	return rule;
+}
+
+static void loadIgnoreFile (ignoreFrame *frame, const char *const fileName)
+{
+	stringList *lines = stringListNewFromFile (fileName);
+
+	if (lines == NULL)
+		return;
+
+	verbose ("reading ignore file \"%s\"\n", fileName);
+	for (unsigned int i = 0; i < stringListCount (lines); i++)
+	{
+		ignoreRule *rule = newIgnoreRule (vStringValue (stringListItem (lines, i)));
+
+		if (rule == NULL)
+			continue;
+		if (frame->rules == NULL)
+			frame->rules = ptrArrayNew (deleteIgnoreRule);
+		ptrArrayAdd (frame->rules, rule);
+	}
+	stringListDelete (lines);
+}
+
+extern void pushIgnoreFiles (const char *const dirName)
+{
+	ignoreFrame *frame = xCalloc (1, ignoreFrame);
+
+	if (IgnoreFrames == NULL)
+		IgnoreFrames = ptrArrayNew (deleteIgnoreFrame);
+
+	/* The paths under "." are made without "./" prefix. */
+	if (strcmp (dirName, ".") == 0)
+		frame->dir = eStrdup ("");
+	else
+		frame->dir = eStrdup (dirName);
+	frame->dirLength = strlen (frame->dir);
+
+	for (unsigned int i = 0; i < ARRAY_SIZE (IgnoreFileNames); i++)
+	{
+		char *fileName = combinePathAndFile (dirName, IgnoreFileNames [i]);
+		loadIgnoreFile (frame, fileName);
+		eFree (fileName);
+	}
+
+	ptrArrayAdd (IgnoreFrames, frame);
+}
+
+extern void popIgnoreFiles (void)
+{
+	Assert (IgnoreFrames && ptrArrayCount (IgnoreFrames) > 0);
+
+	ptrArrayDeleteLast (IgnoreFrames);
+	if (ptrArrayCount (IgnoreFrames) == 0)
+	{
+		ptrArrayDelete (IgnoreFrames);
+		IgnoreFrames = NULL;
+	}
+}
+
+static bool isPathSeparator (int c)
+{
+#if defined (WIN32)
+	if (c == PATH_SEPARATOR)
+		return true;
+#endif
+	return c == OUTPUT_PATH_SEPARATOR || c == '/';
+}
+
+static bool isSameChar (int a, int b)
+{
+#ifdef CASE_INSENSITIVE_FILENAMES
+	return tolower (a) == tolower (b);
+#else
+	return a == b;
+#endif
+}
+
+/* Match C against the bracket expression at P, and store the result to
+ * MATCHED. Returns the pointer after the expression, or NULL if the
+ * expression is not closed. */
+static const char *matchBracket (const char *p, int c, bool *matched)
+{
+	bool negated = false;
+	bool found = false;
+
+	p++;
+	if (*p == '!' || *p == '^')
+	{
+		negated = true;
+		p++;
+	}
+
+	/* ']' just after '[' is a member. */
+	if (*p == ']')
+	{
+		found = (c == ']');
+		p++;
+	}
+
+	while (*p && *p != ']')
+	{
+		int lo = (unsigned char) *p;
+
+		if (lo == '\\' && p [1])
+			lo = (unsigned char) *++p;
+		p++;
+		if (*p == '-' && p [1] && p [1] != ']')
+		{
+			int hi = (unsigned char) p [1];
+			p += 2;
+			if (lo <= c && c <= hi)
+				found = true;
+		}
+		else if (isSameChar (lo, c))
+			found = true;
+	}
+
+	if (*p != ']')
+		return NULL;
+
+	*matched = (found != negated);
+	return p + 1;
+}
+
+static bool matchGlob (const char *start, const char *p, const char *s)
+{
+	while (*p)
+	{
+		if (p [0] == '*' && p [1] == '*'
+			&& (p == start || p [-1] == '/')
+			&& (p [2] == '/' || p [2] == '\0'))
+		{
+			/* "**" as a whole component */
+			if (p [2] == '\0')
+				return true;
+			for (;;)
+			{
+				if (matchGlob (start, p + 3, s))
+					return true;
+				while (*s && ! isPathSeparator (*s))
+					s++;
+				if (*s == '\0')
+					return false;
+				s++;
+			}
+		}
+
+		switch (*p)
+		{
+		case '*':
+			while (*p == '*')
+				p++;
+			for (;;)
+			{
+				if (matchGlob (start, p, s))
+					return true;
+				if (*s == '\0' || isPathSeparator (*s))
+					return false;
+				s++;
+			}
+		case '?':
+			if (*s == '\0' || isPathSeparator (*s))
+				return false;
+			p++;
+			s++;
+			break;
+		case '[':
+		{
+			bool matched = false;
+			const char *q;
+
+			if (*s == '\0' || isPathSeparator (*s))
+				return false;
+			q = matchBracket (p, (unsigned char) *s, &matched);
+			if (q == NULL)
+				goto literal;	/* an unclosed '[' is a literal */
+			if (! matched)
+				return false;
+			p = q;
+			s++;
+			break;
+		}
+		case '\\':
+			if (p [1])
+				p++;
+			/* Fall through */
+		default:
+		literal:
+			if (*p == '/' ? ! isPathSeparator (*s) : ! isSameChar (*p, *s))
+				return false;
+			p++;
+			s++;
+			break;
+		}
+	}
+	return *s == '\0';
+}
+
+/* Returns the rule deciding whether PATH is ignored in FRAME, or NULL. */
+static ignoreRule *findIgnoreRule (ignoreFrame *frame, const char *path,
+								   bool isDirectory)
+{
+	const char *relative;
+	const char *name;
+
+	if (frame->rules == NULL)
+		return NULL;
+
+	if (strncmp (path, frame->dir, frame->dirLength) != 0)
+		return NULL;
+	relative = path + frame->dirLength;
+	if (frame->dirLength > 0 && isPathSeparator (*relative))
+		relative++;
+
+	name = relative + strlen (relative);
+	while (name > relative && ! isPathSeparator (name [-1]))
+		name--;
+
+	for (unsigned int i = ptrArrayCount (frame->rules); i > 0; i--)
+	{
+		ignoreRule *rule = ptrArrayItem (frame->rules, i - 1);
+
+		if (rule->dirOnly && ! isDirectory)
+			continue;
+		if (matchGlob (rule->pattern, rule->pattern,
+					   rule->anchored? relative: name))
+			return rule;
+	}
+	return NULL;
+}
+
+extern bool isIgnoredByIgnoreFiles (const char *const path, bool isDirectory)
+{
+	if (IgnoreFrames == NULL)
+		return false;
+
+	for (unsigned int i = ptrArrayCount (IgnoreFrames); i > 0; i--)
+	{
+		ignoreRule *rule = findIgnoreRule (ptrArrayItem (IgnoreFrames, i - 1),
+										   path, isDirectory);
+		if (rule)
+			return ! rule->negated;
+	}
+	return false;
+}
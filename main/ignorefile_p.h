@@ -0,0 +1,30 @@
+/*
+*   Copyright (c) 2026, Universal Ctags Team
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License version 2 or (at your option) any later version.
+*
+*   Main part private interface to ignorefile.c
+*/
+#ifndef CTAGS_MAIN_IGNOREFILE_PRIVATE_H
+#define CTAGS_MAIN_IGNOREFILE_PRIVATE_H
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"  /* must always come first */
+
+/*
+*   FUNCTION PROTOTYPES
+*/
+
+/* Reads the ignore files in dirName when the recursion enters dirName,
+ * and drops them when it leaves. */
+extern void pushIgnoreFiles (const char *const dirName);
+extern void popIgnoreFiles (void);
+
+/* path must be made by combining the directory names given to
+ * pushIgnoreFiles() and the name of an entry. */
+extern bool isIgnoredByIgnoreFiles (const char *const path, bool isDirectory);
+
+#endif  /* CTAGS_MAIN_IGNOREFILE_PRIVATE_H */
@@ -0,0 +1,995 @@
+/*
+*   Copyright (c) 2026, Universal Ctags Team
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License version 2 or (at your option) any later version.
+*
+*   This module implements --jobs option: parsing input files in
+*   parallel worker processes.
+*
+*   Parsers keep their state in file scope variables, so the input files
+*   cannot be parsed in threads of a process. Instead, the files are
+*   queued, and the queue is split into contiguous slices, one for each
+*   worker process. A worker writes tags for its slice to a tag file
+*   fragment. The parent process appends the fragments to the tag file
+*   in the order of the slices. So the output is the same as the one
+*   made without --jobs option.
+*
+*   When many files are queued while walking directories, the queue is
+*   handed to the workers in batches. The workers parse a batch while the
+*   parent process walks on and fills the next one, so reading the
+*   directories overlaps parsing. The parent collects the workers of a
+*   batch before starting the next one to keep the order of the output.
+*
+*   A batch is split into more slices than workers, and a worker process
+*   is started for a slice whenever one exits, so a slice of slow files
+*   doesn't keep the other workers idle. The slices are cut at about the
+*   same number of bytes, counting the sizes of the files queued, and a
+*   file larger than a share makes a slice alone. Of the slices waiting,
+*   the largest one is started first, so a large file doesn't start last
+*   and leave the other workers idle at the end of the batch. The
+*   fragment of a slice is appended when all the slices before it are
+*   appended; the slices started are limited to a window from the first
+*   one not appended, so are the fragments waiting. With --jobs-order=ready, a fragment is appended
+*   as soon as its worker exits if the tag file is sorted; the order of
+*   the lines is decided by sorting then.
+*
+*   With --split-size option, a file large enough is parsed by a worker
+*   alone. If the parser can split the file, the worker starts a worker
+*   process for each chunk of the file, as many as --jobs, and appends
+*   their fragments to its own. A chunk worker keeps its tags until all
+*   the chunk workers report how their chunks end; if a chunk does not
+*   end in the state the parser starts a file in, the tags of the chunks
+*   are thrown away, and the worker parses the file as a whole.
+*
+*   With --split-guests option, a worker parsing a file with many guest
+*   regions runs the guest parsers in worker processes, each for a
+*   contiguous slice of the promises, and appends their fragments in the
+*   order of the promises. A guest worker may not make the same tags as
+*   the promises run in order: it cannot force the promises made by the
+*   guest parsers after all the promises, and it cannot number the
+*   anonymous names following the ones of the slices before it. If a
+*   guest worker meets either, the tags of the guest workers are thrown
+*   away, and the worker runs the promises by itself.
+*/
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"  /* must always come first */
+
+#include <stdio.h>
+#include <errno.h>
+#include <limits.h>
+#ifdef HAVE_UNISTD_H
+# include <unistd.h>
+#endif
+#ifdef HAVE_SYS_TYPES_H
+# include <sys/types.h>
+#endif
+#ifdef HAVE_SYS_WAIT_H
+# include <sys/wait.h>
+#endif
+#ifdef HAVE_POLL_H
+# include <poll.h>
+#endif
+
+#include "debug.h"
+#include "dedup_p.h"
+#include "entry_p.h"
+#include "jobs_p.h"
+#include "langcache_p.h"
+#include "numarray.h"
+#include "options_p.h"
+#include "parse_p.h"
+#include "promise_p.h"
+#include "routines.h"
+#include "routines_p.h"
+#include "read.h"
+#include "sampler_p.h"
+#include "stats_p.h"
+#include "strlist.h"
+#include "traceevent_p.h"
+#include "writer_p.h"
+
+/*
+*   DATA DECLARATIONS
+*/
+
+/* The number of files per worker process in a batch */
+#define JOB_BATCH_FILES_PER_WORKER 128
+
+/* The number of slices per worker process in a batch */
+#define JOB_SLICES_PER_WORKER 4
+
+/* The number of slices per worker process started ahead of the first
+ * one not appended */
+#define JOB_WINDOW_PER_WORKER 2
+
+/* What opening and walking to a file costs, in bytes of input, when the
+ * files are divided into slices */
+#define JOB_FILE_COST 4096
+
+/* What a worker writes to its pipe. ptagRangeCount longs of
+ * tagFileFragment::ptagRanges follow. */
+struct jobReport {
+	long size;
+	unsigned long added;
+	size_t maxLine, maxTag;
+	unsigned long files, lines, bytes;
+	unsigned int ptagRangeCount;
+	bool sorted;
+};
+
+/* What a chunk worker writes to its pipe before writing its tags */
+struct chunkReport {
+	bool clean;
+	unsigned int anonCount;
+};
+
+/* What a guest worker writes to its pipe before the report of the job */
+struct promiseReport {
+	bool clean;
+	bool tagFileResized;
+};
+
+/* What the worker of a file writes back to the pipe of a chunk worker:
+ * the number of the anonymous names in the chunks before it, or
+ * CHUNK_ABORT if the tags of the chunks are not used. */
+#define CHUNK_ABORT UINT_MAX
+
+#ifdef HAVE_FORK
+enum workerState {
+	WORKER_WAITING,				/* not started yet */
+	WORKER_RUNNING,
+	WORKER_EXITED,				/* the fragment is not appended yet */
+	WORKER_APPENDED,
+};
+
+struct worker {
+	pid_t pid;
+	int fd;
+	int toWorkerFd;				/* only for a chunk worker */
+	char *fragmentName;
+
+	/* Only for a worker of a batch */
+	enum workerState state;
+	unsigned int from, to;		/* the files of the slice */
+	unsigned long cost;			/* the bytes of the files, and JOB_FILE_COST each */
+	struct jobReport report;
+	tagFileFragment fragment;
+};
+
+/* The files queued before startWorkers() and the workers parsing them */
+struct batch {
+	stringList *files;
+	ulongArray *costs;			/* for each file */
+	struct worker *workers;		/* one for each slice */
+	unsigned int sliceCount;
+	unsigned int started;		/* the slices started */
+	unsigned int running;		/* the workers running */
+	unsigned int appended;		/* the slices appended */
+	unsigned int next;			/* the first slice not appended */
+	unsigned int maxRunning, window;
+	bool readyOrder;
+	bool sortsFragments;		/* see sortTagFileFragment() */
+};
+#endif
+
+/*
+*   DATA DEFINITIONS
+*/
+static stringList *JobQueue = NULL;
+static ulongArray *JobCosts = NULL;
+
+#ifdef HAVE_FORK
+/* The batch parsed last */
+static struct batch *RunningBatch = NULL;
+
+static void startWorkers (void);
+static void serviceWorkers (bool wait);
+static void collectWorkers (void);
+
+/* In a worker process */
+static bool InWorker = false;
+/* In a chunk worker process, the pipes to and from the worker of the file */
+static int ChunkReportFd = -1;
+static int ChunkOffsetFd = -1;
+#endif
+
+/*
+*   FUNCTION DEFINITIONS
+*/
+
+extern void beginJobs (void)
+{
+	Assert (JobQueue == NULL);
+
+#ifdef HAVE_FORK
+	/* Tags are written to stdout directly in these modes.
+	 * --cache-file and --cache-dir record the tags of each file in this
+	 * process.
+	 * A writer sorting entries by itself keeps them in this process.
+	 * --slowest-files and --file-stats time the files in this process.
+	 * --trace-events records the spans in this process.
+	 * --sampling-profile samples this process.
+	 * --dedup-tags drops the tags of a fragment at their offsets, but
+	 * the etags writer writes a section of an input file at once. */
+	if (Option.jobs > 1 && !Option.filter && !Option.printLanguage
+		&& Option.cacheFileName == NULL && Option.cacheDirName == NULL
+		&& !writerSortsEntries ()
+		&& !(Option.dedupTags && Option.etags)
+		&& !isRecordingFileStatistics () && !isTracingEvents ()
+		&& !isSampling ())
+	{
+		JobQueue = stringListNew ();
+		JobCosts = ulongArrayNew ();
+	}
+#endif
+}
+
+extern bool queueJob (const char *const fileName,
+					  const fileStatus *const status)
+{
+	if (JobQueue == NULL)
+		return false;
+
+	/* A worker cannot record its guesses to the language cache of this
+	 * process. Guess here so that the worker finds the language in the
+	 * cache copied to it. */
+	if (isLanguageCacheEnabled ())
+		getLanguageForFilenameAndContents (fileName);
+
+#ifdef HAVE_FORK
+	/* The worker of a large file uses the other workers for parsing its
+	 * chunks. Wait for the files queued before, and let the next batch
+	 * wait for this one. */
+	if (Option.splitSize > 0 && status->size >= Option.splitSize)
+	{
+		runQueuedJobs ();
+		stringListAdd (JobQueue, vStringNewInit (fileName));
+		ulongArrayAdd (JobCosts, status->size + JOB_FILE_COST);
+		startWorkers ();
+		return true;
+	}
+#endif
+
+	stringListAdd (JobQueue, vStringNewInit (fileName));
+	ulongArrayAdd (JobCosts, status->size + JOB_FILE_COST);
+
+#ifdef HAVE_FORK
+	if (stringListCount (JobQueue) >= Option.jobs * JOB_BATCH_FILES_PER_WORKER)
+	{
+		collectWorkers ();
+		startWorkers ();
+	}
+	else
+		serviceWorkers (false);
+#endif
+	return true;
+}
+
+#ifdef HAVE_FORK
+static bool writeFully (int fd, const void *buf, size_t size)
+{
+	const char *p = buf;
+
+	while (size > 0)
+	{
+		ssize_t n = write (fd, p, size);
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n <= 0)
+			return false;
+		p += n;
+		size -= n;
+	}
+	return true;
+}
+
+static bool readFully (int fd, void *buf, size_t size)
+{
+	char *p = buf;
+
+	while (size > 0)
+	{
+		ssize_t n = read (fd, p, size);
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n <= 0)
+			return false;
+		p += n;
+		size -= n;
+	}
+	return true;
+}
+
+/* Closes the tag file fragment, writes the report of the worker to FD,
+ * and exits. If SORTEDNAME is not NULL, the fragment of the name is
+ * sorted for the parent to merge it. */
+static void exitWorker (int fd, unsigned long files0, unsigned long lines0,
+						unsigned long bytes0, const char *const sortedName)
+{
+	struct jobReport report;
+	tagFileFragment fragment;
+	bool ok;
+
+	closeRedirectedTagFile (&fragment);
+	if (sortedName)
+		sortTagFileFragment (sortedName, &fragment);
+
+	report.size = fragment.size;
+	report.added = fragment.added;
+	report.maxLine = fragment.maxLine;
+	report.maxTag = fragment.maxTag;
+	getTotals (&report.files, &report.lines, &report.bytes);
+	report.files -= files0;
+	report.lines -= lines0;
+	report.bytes -= bytes0;
+	report.ptagRangeCount = longArrayCount (fragment.ptagRanges);
+	report.sorted = fragment.sorted;
+
+	ok = writeFully (fd, &report, sizeof (report));
+	for (unsigned int i = 0; ok && i < report.ptagRangeCount; i++)
+	{
+		long l = longArrayItem (fragment.ptagRanges, i);
+		ok = writeFully (fd, &l, sizeof (l));
+	}
+	longArrayDelete (fragment.ptagRanges);
+	close (fd);
+
+	fflush (stdout);
+	fflush (stderr);
+	/* Don't run the clean up code of the parent process. */
+	_exit (ok? 0: 1);
+}
+
+static void runWorker (stringList *files, unsigned int from, unsigned int to,
+					   const char *const fragmentName, int fd, bool sortsFragment)
+{
+	unsigned long files0, lines0, bytes0;
+
+	InWorker = true;
+	getTotals (&files0, &lines0, &bytes0);
+
+	redirectTagFile (fragmentName);
+	for (unsigned int i = from; i < to; i++)
+		parseFile (vStringValue (stringListItem (files, i)));
+	exitWorker (fd, files0, lines0, bytes0, sortsFragment? fragmentName: NULL);
+}
+
+/* Waits for the worker W, and reads its report. */
+static void reapWorker (struct worker *w)
+{
+	bool ok;
+	int status;
+
+	w->fragment.ptagRanges = longArrayNew ();
+
+	ok = readFully (w->fd, &w->report, sizeof (w->report));
+	for (unsigned int i = 0; ok && i < w->report.ptagRangeCount; i++)
+	{
+		long l;
+		ok = readFully (w->fd, &l, sizeof (l));
+		longArrayAdd (w->fragment.ptagRanges, l);
+	}
+	close (w->fd);
+
+	while (waitpid (w->pid, &status, 0) == -1)
+	{
+		if (errno != EINTR)
+			error (FATAL | PERROR, "failed to wait worker process %ld", (long) w->pid);
+	}
+
+	if (!ok || !WIFEXITED (status) || WEXITSTATUS (status) != 0)
+	{
+		remove (w->fragmentName);
+		removeTagKeysOfFragment (w->fragmentName);
+		error (FATAL, "worker process %ld failed", (long) w->pid);
+	}
+
+	w->fragment.size = w->report.size;
+	w->fragment.added = w->report.added;
+	w->fragment.maxLine = w->report.maxLine;
+	w->fragment.maxTag = w->report.maxTag;
+	w->fragment.sorted = w->report.sorted;
+}
+
+/* Appends the tags of the worker W reaped. A sorted fragment is
+ * removed after merged into the tag file. */
+static void appendWorker (struct worker *w)
+{
+	appendTagFileFragment (w->fragmentName, &w->fragment);
+	addTotals (w->report.files, w->report.lines, w->report.bytes);
+
+	longArrayDelete (w->fragment.ptagRanges);
+	if (!w->fragment.sorted)
+		remove (w->fragmentName);
+	eFree (w->fragmentName);
+}
+
+static void collectWorker (struct worker *w)
+{
+	reapWorker (w);
+	appendWorker (w);
+}
+
+/* In a chunk worker process */
+static void runChunkWorker (const langType language,
+							unsigned long startLine, unsigned long endLine,
+							const char *const fragmentName, int fd)
+{
+	redirectTagFile (fragmentName);
+	parseInputChunk (language, startLine, endLine);
+	exitWorker (fd, 0, 0, 0, NULL);
+}
+
+extern unsigned int reportInputChunk (bool clean, unsigned int anonCount)
+{
+	struct chunkReport report = {
+		.clean = clean,
+		.anonCount = anonCount,
+	};
+	unsigned int offset;
+
+	Assert (ChunkReportFd != -1);
+
+	if (!writeFully (ChunkReportFd, &report, sizeof (report))
+		|| !readFully (ChunkOffsetFd, &offset, sizeof (offset))
+		|| offset == CHUNK_ABORT)
+	{
+		/* The worker of the file removes the fragment. */
+		_exit (0);
+	}
+	close (ChunkOffsetFd);
+	return offset;
+}
+
+static void discardWorker (struct worker *w)
+{
+	int status;
+
+	close (w->fd);
+	while (waitpid (w->pid, &status, 0) == -1 && errno == EINTR)
+		;
+	remove (w->fragmentName);
+	removeTagKeysOfFragment (w->fragmentName);
+	eFree (w->fragmentName);
+}
+
+/* Parses the current input file in chunks starting at LINES and at the
+ * first line. Returns false if a chunk doesn't end clean. */
+static bool runChunkWorkers (const langType language, ulongArray *lines)
+{
+	const unsigned int count = ulongArrayCount (lines) + 1;
+	struct worker *workers = xCalloc (count, struct worker);
+	unsigned int *anonCounts = xCalloc (count, unsigned int);
+	bool clean = true;
+	unsigned int offset = 0;
+
+	verbose ("parsing %s in %u chunks\n", getInputFileName (), count);
+
+	/* Don't let the workers write the buffered data again. */
+	fflush (NULL);
+
+	for (unsigned int i = 0; i < count; i++)
+	{
+		struct worker *w = workers + i;
+		int fds [2], offsetFds [2];
+		MIO *mio = tempFile ("w", &w->fragmentName);
+
+		mio_unref (mio);
+		if (pipe (fds) != 0 || pipe (offsetFds) != 0)
+			error (FATAL | PERROR, "cannot make a pipe for worker process");
+
+		w->pid = fork ();
+		if (w->pid == -1)
+			error (FATAL | PERROR, "cannot fork worker process");
+		else if (w->pid == 0)
+		{
+			for (unsigned int j = 0; j < i; j++)
+			{
+				close (workers [j].fd);
+				close (workers [j].toWorkerFd);
+			}
+			close (fds [0]);
+			close (offsetFds [1]);
+			ChunkReportFd = fds [1];
+			ChunkOffsetFd = offsetFds [0];
+			runChunkWorker (language,
+							(i == 0)? 1: ulongArrayItem (lines, i - 1),
+							(i + 1 == count)? 0: ulongArrayItem (lines, i) - 1,
+							w->fragmentName, fds [1]);
+		}
+		close (fds [1]);
+		close (offsetFds [0]);
+		w->fd = fds [0];
+		w->toWorkerFd = offsetFds [1];
+	}
+
+	for (unsigned int i = 0; i < count; i++)
+	{
+		struct chunkReport report;
+
+		if (!readFully (workers [i].fd, &report, sizeof (report)))
+		{
+			/* The worker has exited; don't write to its pipe. */
+			close (workers [i].toWorkerFd);
+			workers [i].toWorkerFd = -1;
+			clean = false;
+		}
+		else if (!report.clean)
+			clean = false;
+		else
+			anonCounts [i] = report.anonCount;
+	}
+
+	for (unsigned int i = 0; i < count; i++)
+	{
+		struct worker *w = workers + i;
+		unsigned int o = clean? offset: CHUNK_ABORT;
+
+		if (w->toWorkerFd == -1)
+			continue;
+		writeFully (w->toWorkerFd, &o, sizeof (o));
+		close (w->toWorkerFd);
+		offset += anonCounts [i];
+	}
+
+	for (unsigned int i = 0; i < count; i++)
+	{
+		if (clean)
+			collectWorker (workers + i);
+		else
+			discardWorker (workers + i);
+	}
+
+	if (!clean)
+		verbose ("parsing %s again as a whole\n", getInputFileName ());
+
+	eFree (anonCounts);
+	eFree (workers);
+	return clean;
+}
+
+/* In a guest worker process */
+static void runPromiseWorker (int from, int to, int count, bool first,
+							  const char *const fragmentName, int fd)
+{
+	struct promiseReport report;
+	unsigned long files0, lines0, bytes0;
+	unsigned int anonCount = countAnonNamesInCurrentInput ();
+
+	getTotals (&files0, &lines0, &bytes0);
+	redirectTagFile (fragmentName);
+	report.tagFileResized = forcePromisesInRange (from, to);
+	report.clean = (getLastPromise () + 1 == count
+					&& (first || countAnonNamesInCurrentInput () == anonCount));
+	if (!writeFully (fd, &report, sizeof (report)))
+		_exit (1);
+	exitWorker (fd, files0, lines0, bytes0, NULL);
+}
+
+static bool runPromiseWorkers (int count, bool *tagFileResized)
+{
+	const unsigned int njobs = (Option.jobs < (unsigned int) count)
+		? Option.jobs: (unsigned int) count;
+	struct worker *workers = xCalloc (njobs, struct worker);
+	bool *resized = xCalloc (njobs, bool);
+	bool clean = true;
+
+	verbose ("running guest parsers for %d promises in %u worker processes\n",
+			 count, njobs);
+
+	/* Don't let the workers write the buffered data again. */
+	fflush (NULL);
+
+	for (unsigned int i = 0; i < njobs; i++)
+	{
+		struct worker *w = workers + i;
+		int fds [2];
+		MIO *mio = tempFile ("w", &w->fragmentName);
+
+		mio_unref (mio);
+		if (pipe (fds) != 0)
+			error (FATAL | PERROR, "cannot make a pipe for worker process");
+
+		w->pid = fork ();
+		if (w->pid == -1)
+			error (FATAL | PERROR, "cannot fork worker process");
+		else if (w->pid == 0)
+		{
+			for (unsigned int j = 0; j < i; j++)
+				close (workers [j].fd);
+			close (fds [0]);
+			runPromiseWorker ((int)(((unsigned long) count * i) / njobs),
+							  (int)(((unsigned long) count * (i + 1)) / njobs),
+							  count, i == 0, w->fragmentName, fds [1]);
+		}
+		close (fds [1]);
+		w->fd = fds [0];
+	}
+
+	for (unsigned int i = 0; i < njobs; i++)
+	{
+		struct promiseReport report;
+
+		if (!readFully (workers [i].fd, &report, sizeof (report))
+			|| !report.clean)
+			clean = false;
+		else
+			resized [i] = report.tagFileResized;
+	}
+
+	for (unsigned int i = 0; i < njobs; i++)
+	{
+		if (clean)
+		{
+			collectWorker (workers + i);
+			if (resized [i])
+				*tagFileResized = true;
+		}
+		else
+			discardWorker (workers + i);
+	}
+
+	if (!clean)
+		verbose ("running guest parsers for %d promises again in order\n", count);
+
+	eFree (resized);
+	eFree (workers);
+	return clean;
+}
+
+/* Divides the files of B into slices of about the same cost, at most
+ * MAXSLICES of them unless a file costs more than a share. */
+static void sliceBatch (struct batch *b, unsigned int maxSlices)
+{
+	const unsigned int count = stringListCount (b->files);
+	unsigned long total = 0, share, cost = 0;
+	unsigned int from = 0;
+
+	for (unsigned int i = 0; i < count; i++)
+		total += ulongArrayItem (b->costs, i);
+	share = total / maxSlices + 1;
+
+	b->workers = xCalloc (count, struct worker);
+	b->sliceCount = 0;
+	for (unsigned int i = 0; i <= count; i++)
+	{
+		unsigned long c = (i < count)? ulongArrayItem (b->costs, i): 0;
+
+		if (i == count || (i > from && cost + c > share))
+		{
+			struct worker *w = b->workers + b->sliceCount++;
+
+			w->state = WORKER_WAITING;
+			w->from = from;
+			w->to = i;
+			w->cost = cost;
+			from = i;
+			cost = 0;
+		}
+		cost += c;
+	}
+}
+
+/* Start worker processes for the queued files, and empty the queue. */
+static void startWorkers (void)
+{
+	unsigned int count;
+	unsigned int njobs;
+	struct batch *b;
+
+	Assert (RunningBatch == NULL);
+
+	count = stringListCount (JobQueue);
+	if (count == 0)
+		return;
+
+	njobs = (Option.jobs < count)? Option.jobs: count;
+	verbose ("parsing %u file%s with %u worker processes\n",
+			 count, (count == 1)? "": "s", njobs);
+
+	b = xCalloc (1, struct batch);
+	b->files = JobQueue;
+	b->costs = JobCosts;
+	JobQueue = stringListNew ();
+	JobCosts = ulongArrayNew ();
+	sliceBatch (b, (njobs * JOB_SLICES_PER_WORKER < count)
+				? njobs * JOB_SLICES_PER_WORKER: count);
+	b->maxRunning = njobs;
+	b->window = njobs * JOB_WINDOW_PER_WORKER;
+	b->readyOrder = (Option.jobsOrder == JOBS_ORDER_READY
+					 && Option.sorted != SO_UNSORTED);
+	/* --dedup-tags drops the tags of a fragment at their offsets. */
+	b->sortsFragments = canSortTagFileFragments () && !Option.dedupTags;
+
+	RunningBatch = b;
+	serviceWorkers (false);
+}
+
+static void startWorker (struct batch *b, struct worker *w)
+{
+	int fds [2];
+	MIO *mio = tempFile ("w", &w->fragmentName);
+
+	mio_unref (mio);
+	if (pipe (fds) != 0)
+		error (FATAL | PERROR, "cannot make a pipe for worker process");
+
+	/* Don't let the worker write the buffered data again. */
+	fflush (NULL);
+
+	w->pid = fork ();
+	if (w->pid == -1)
+		error (FATAL | PERROR, "cannot fork worker process");
+	else if (w->pid == 0)
+	{
+		for (unsigned int j = 0; j < b->sliceCount; j++)
+		{
+			if (b->workers [j].state == WORKER_RUNNING)
+				close (b->workers [j].fd);
+		}
+		close (fds [0]);
+		runWorker (b->files, w->from, w->to, w->fragmentName, fds [1],
+				   b->sortsFragments);
+	}
+	close (fds [1]);
+	w->fd = fds [0];
+	w->state = WORKER_RUNNING;
+	b->running++;
+	b->started++;
+}
+
+/* Reaps the workers exited. If WAIT is true, waits until one exits.
+ * Returns the number of the workers reaped. */
+static unsigned int reapWorkers (struct batch *b, bool wait)
+{
+	unsigned int reaped = 0;
+#ifdef HAVE_POLL_H
+	struct pollfd *fds;
+	unsigned int *slices;
+	unsigned int n = 0;
+	int r;
+
+	if (b->running == 0)
+		return 0;
+
+	fds = xMalloc (b->running, struct pollfd);
+	slices = xMalloc (b->running, unsigned int);
+	for (unsigned int i = 0; i < b->sliceCount; i++)
+	{
+		if (b->workers [i].state != WORKER_RUNNING)
+			continue;
+		fds [n].fd = b->workers [i].fd;
+		fds [n].events = POLLIN;
+		fds [n].revents = 0;
+		slices [n++] = i;
+	}
+
+	/* A worker writes its report just before exiting. */
+	while ((r = poll (fds, n, wait? -1: 0)) == -1 && errno == EINTR)
+		;
+	if (r == -1)
+		error (FATAL | PERROR, "cannot poll worker processes");
+
+	for (unsigned int i = 0; r > 0 && i < n; i++)
+	{
+		if (fds [i].revents == 0)
+			continue;
+		reapWorker (b->workers + slices [i]);
+		b->workers [slices [i]].state = WORKER_EXITED;
+		b->running--;
+		reaped++;
+	}
+	eFree (slices);
+	eFree (fds);
+#else
+	/* Wait for the first one running. */
+	for (unsigned int i = 0; wait && i < b->sliceCount; i++)
+	{
+		if (b->workers [i].state != WORKER_RUNNING)
+			continue;
+		reapWorker (b->workers + i);
+		b->workers [i].state = WORKER_EXITED;
+		b->running--;
+		reaped++;
+		break;
+	}
+#endif
+	return reaped;
+}
+
+static void appendWorkers (struct batch *b)
+{
+	if (b->readyOrder)
+	{
+		for (unsigned int i = 0; i < b->sliceCount; i++)
+		{
+			if (b->workers [i].state != WORKER_EXITED)
+				continue;
+			appendWorker (b->workers + i);
+			b->workers [i].state = WORKER_APPENDED;
+			b->appended++;
+		}
+	}
+
+	while (b->next < b->sliceCount
+		   && b->workers [b->next].state >= WORKER_EXITED)
+	{
+		if (b->workers [b->next].state == WORKER_EXITED)
+		{
+			appendWorker (b->workers + b->next);
+			b->workers [b->next].state = WORKER_APPENDED;
+			b->appended++;
+		}
+		b->next++;
+	}
+}
+
+/* Returns the slice costing the most of the ones waiting in the window
+ * of B, or NULL. */
+static struct worker *nextWorker (struct batch *b)
+{
+	const unsigned int end = (b->readyOrder || b->next + b->window > b->sliceCount)
+		? b->sliceCount: b->next + b->window;
+	struct worker *next = NULL;
+
+	for (unsigned int i = b->next; i < end; i++)
+	{
+		struct worker *w = b->workers + i;
+
+		if (w->state == WORKER_WAITING
+			&& (next == NULL || w->cost > next->cost))
+			next = w;
+	}
+	return next;
+}
+
+/* Starts the workers for the slices of the last batch as the workers
+ * before them exit, and appends their tags. If WAIT is true, returns
+ * when all the tags of the batch are appended. */
+static void serviceWorkers (bool wait)
+{
+	struct batch *b = RunningBatch;
+	struct worker *w;
+
+	if (b == NULL)
+		return;
+
+	while (b->appended < b->sliceCount)
+	{
+		while (b->started < b->sliceCount
+			   && b->running < b->maxRunning
+			   && (w = nextWorker (b)) != NULL)
+			startWorker (b, w);
+
+		if (reapWorkers (b, wait) == 0)
+			return;
+		appendWorkers (b);
+	}
+}
+
+/* Wait for the workers started last, and append their tags. */
+static void collectWorkers (void)
+{
+	struct batch *b = RunningBatch;
+
+	if (b == NULL)
+		return;
+
+	serviceWorkers (true);
+
+	stringListDelete (b->files);
+	ulongArrayDelete (b->costs);
+	eFree (b->workers);
+	eFree (b);
+	RunningBatch = NULL;
+}
+#else
+extern unsigned int reportInputChunk (bool clean CTAGS_ATTR_UNUSED,
+									  unsigned int anonCount CTAGS_ATTR_UNUSED)
+{
+	/* No chunk is parsed without worker processes. */
+	return 0;
+}
+#endif
+
+#ifdef HAVE_FORK
+static bool mayParseInputInChunks (const langType language, size_t size)
+{
+	/* A chunk worker records its tags in the worker of the file, so the
+	 * tags are written only in the formats of ctags. */
+	return (InWorker && ChunkReportFd == -1
+			&& Option.splitSize != 0 && size >= Option.splitSize
+			&& !Option.dedupHeaders
+			&& writerIsCtags ()
+			&& doesParserSplitInput (language));
+}
+#endif
+
+extern bool doesInputFileRequireMemoryStream (const char *const fileName,
+											  const langType language)
+{
+#ifdef HAVE_FORK
+	fileStatus *st;
+	bool r;
+
+	if (!InWorker || Option.splitSize == 0)
+		return false;
+
+	st = eStat (fileName);
+	r = st->exists && mayParseInputInChunks (language, st->size);
+	eStatFree (st);
+	return r;
+#else
+	return false;
+#endif
+}
+
+extern bool parseInputInChunks (const langType language)
+{
+#ifdef HAVE_FORK
+	ulongArray *lines;
+	size_t size;
+	bool r;
+
+	if (getInputFileData (&size) == NULL
+		|| !mayParseInputInChunks (language, size))
+		return false;
+
+	lines = ulongArrayNew ();
+	r = (splitInputFile (language, size / Option.jobs + 1, lines)
+		 && runChunkWorkers (language, lines));
+	ulongArrayDelete (lines);
+	return r;
+#else
+	return false;
+#endif
+}
+
+extern bool forcePromisesInWorkers (int count, bool *tagFileResized)
+{
+#ifdef HAVE_FORK
+	/* A guest worker records its tags in the worker of the file as
+	 * a chunk worker does. */
+	if (!InWorker || ChunkReportFd != -1
+		|| Option.splitGuests == 0 || (unsigned int) count < Option.splitGuests
+		|| Option.jobs < 2 || Option.dedupHeaders
+		|| !writerIsCtags ())
+		return false;
+
+	return runPromiseWorkers (count, tagFileResized);
+#else
+	return false;
+#endif
+}
+
+/*  Parse the queued files. This must be called before an option on the
+ *  command line is evaluated because the option affects only the files
+ *  after it.
+ */
+extern void runQueuedJobs (void)
+{
+#ifdef HAVE_FORK
+	if (JobQueue == NULL)
+		return;
+
+	collectWorkers ();
+	startWorkers ();
+	collectWorkers ();
+#endif
+}
+
+extern void endJobs (void)
+{
+	if (JobQueue == NULL)
+		return;
+
+	runQueuedJobs ();
+	stringListDelete (JobQueue);
+	JobQueue = NULL;
+	ulongArrayDelete (JobCosts);
+	JobCosts = NULL;
+}
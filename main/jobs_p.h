@@ -0,0 +1,51 @@
+/*
+*   Copyright (c) 2026, Universal Ctags Team
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License version 2 or (at your option) any later version.
+*
+*   Main part private interface to jobs.c
+*/
+#ifndef CTAGS_MAIN_JOBS_PRIVATE_H
+#define CTAGS_MAIN_JOBS_PRIVATE_H
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"  /* must always come first */
+
+#include "routines_p.h"
+#include "types.h"
+
+/*
+*   FUNCTION PROTOTYPES
+*/
+extern void beginJobs (void);
+extern bool queueJob (const char *const fileName,
+					  const fileStatus *const status);
+extern void runQueuedJobs (void);
+extern void endJobs (void);
+
+/* Parses the current input file in chunks in worker processes if it is
+ * large enough; see --split-size option. Returns false if the input file
+ * is not parsed yet. */
+extern bool parseInputInChunks (const langType language);
+/* The chunk workers share the input file read before they are forked,
+ * so a file to be parsed in chunks is read into a memory stream, however
+ * large it is. */
+extern bool doesInputFileRequireMemoryStream (const char *const fileName,
+											  const langType language);
+/* Called in a worker process parsing a chunk, before writing the tags of
+ * the chunk. CLEAN tells whether the chunk has ended clean, and ANONCOUNT
+ * is the number of the anonymous names made in the chunk. Returns the
+ * number of the anonymous names made in the chunks before, or doesn't
+ * return if the tags of the chunk are not used. */
+extern unsigned int reportInputChunk (bool clean, unsigned int anonCount);
+
+/* Runs the guest parsers for the first COUNT promises in worker processes
+ * if there are enough of them; see --split-guests option. Returns false
+ * if the promises are not forced yet. TAGFILERESIZED is set if a guest
+ * parser has resized the tag file. */
+extern bool forcePromisesInWorkers (int count, bool *tagFileResized);
+
+#endif  /* CTAGS_MAIN_JOBS_PRIVATE_H */
@@ -24,53 +24,76 @@
 /*
 *   DATA DECLARATIONS
 */
-typedef struct sHashEntry {
-	struct sHashEntry *next;
+typedef struct sKeywordEntry {
 	const char *string;
-	langType language;
+	unsigned int hash;
 	int value;
-} hashEntry;
+} keywordEntry;
+
+/* The keywords of a language. The entries are kept in the order they
+ * are added, and indexed with an open addressing hash table. The index
+ * is kept less than half full, so a lookup takes one probe usually. */
+typedef struct sLangKeywords {
+	keywordEntry *entries;
+	unsigned int count;
+	unsigned int allocated;
+
+	/* The index of an entry plus one, or 0 for an empty slot */
+	unsigned int *index;
+	unsigned int mask;			/* the number of the slots - 1 */
+} langKeywords;
 
 /*
 *   DATA DEFINITIONS
 */
-static const unsigned int TableSize = 2039;  /* prime */
-static hashEntry **HashTable = NULL;
+static const unsigned int InitialIndexSize = 64;  /* power of 2 */
+static langKeywords **KeywordTables = NULL;
+static unsigned int KeywordTableCount = 0;
 
 /*
 *   FUNCTION DEFINITIONS
 */
 
-static hashEntry **getHashTable (void)
+static langKeywords *newKeywordTable (void)
 {
-	static bool allocated = false;
-
-	if (! allocated)
-	{
-		unsigned int i;
+	langKeywords *const table = xMalloc (1, langKeywords);
 
-		HashTable = xMalloc (TableSize, hashEntry*);
+	table->allocated = InitialIndexSize / 2;
+	table->entries = xMalloc (table->allocated, keywordEntry);
+	table->count = 0;
+	table->index = xCalloc (InitialIndexSize, unsigned int);
+	table->mask = InitialIndexSize - 1;
 
-		for (i = 0  ;  i < TableSize  ;  ++i)
-			HashTable [i] = NULL;
-
-		allocated = true;
-	}
-	return HashTable;
+	return table;
 }
 
-static hashEntry *getHashTableEntry (unsigned long hashedValue)
+static langKeywords *getKeywordTable (langType language, bool create)
 {
-	hashEntry **const table = getHashTable ();
-	hashEntry *entry;
+	if (language < 0)
+		return NULL;
 
-	Assert (hashedValue < TableSize);
-	entry = table [hashedValue];
+	if ((unsigned int) language >= KeywordTableCount)
+	{
+		unsigned int count;
+
+		if (! create)
+			return NULL;
+
+		count = KeywordTableCount? KeywordTableCount: 64;
+		while (count <= (unsigned int) language)
+			count *= 2;
+		KeywordTables = xRealloc (KeywordTables, count, langKeywords*);
+		memset (KeywordTables + KeywordTableCount, 0,
+				(count - KeywordTableCount) * sizeof (langKeywords*));
+		KeywordTableCount = count;
+	}
 
-	return entry;
+	if (KeywordTables [language] == NULL && create)
+		KeywordTables [language] = newKeywordTable ();
+	return KeywordTables [language];
 }
 
-static unsigned int hashValue (const char *const string, langType language)
+static unsigned int hashValue (const char *const string)
 {
 	const signed char *p;
 	unsigned int h = 5381;
@@ -81,23 +104,35 @@ static unsigned int hashValue (const char *const string, langType language)
 	for (p = (const signed char *)string; *p != '\0'; p++)
 		h = (h << 5) + h + tolower (*p);
 
-	/* consider language as an extra "character" and add it to the hash */
-	h = (h << 5) + h + language;
+	/* Mix the bits for indexing with the lower bits */
+	h ^= h >> 16;
 
 	return h;
 }
 
-static hashEntry *newEntry (
-		const char *const string, langType language, int value)
+static void indexEntry (langKeywords *const table, unsigned int n)
 {
-	hashEntry *const entry = xMalloc (1, hashEntry);
+	unsigned int i = table->entries [n].hash & table->mask;
+
+	while (table->index [i] != 0)
+		i = (i + 1) & table->mask;
+	table->index [i] = n + 1;
+}
 
-	entry->next     = NULL;
-	entry->string   = string;
-	entry->language = language;
-	entry->value    = value;
+static void growKeywordTable (langKeywords *const table)
+{
+	const unsigned int size = (table->mask + 1) * 2;
 
-	return entry;
+	table->allocated = size / 2;
+	table->entries = xRealloc (table->entries, table->allocated, keywordEntry);
+
+	eFree (table->index);
+	table->index = xCalloc (size, unsigned int);
+	table->mask = size - 1;
+
+	/* Index them in the order added to keep the order of the probes. */
+	for (unsigned int n = 0; n < table->count; n++)
+		indexEntry (table, n);
 }
 
 /*  Note that it is assumed that a "value" of zero means an undefined keyword
@@ -107,54 +142,43 @@ static hashEntry *newEntry (
  */
 extern void addKeyword (const char *const string, langType language, int value)
 {
-	const unsigned int index = hashValue (string, language) % TableSize;
-	hashEntry *entry = getHashTableEntry (index);
+	langKeywords *const table = getKeywordTable (language, true);
+	keywordEntry *entry;
 
-	if (entry == NULL)
-	{
-		hashEntry **const table = getHashTable ();
-		table [index] = newEntry (string, language, value);
-	}
-	else
-	{
-		hashEntry *prev = NULL;
+	Assert (table != NULL);
+	Assert (lookupKeyword (string, language) == KEYWORD_NONE);
 
-		while (entry != NULL)
-		{
-			if (language == entry->language  &&
-				strcmp (string, entry->string) == 0)
-			{
-				Assert (("Already in table" == NULL));
-			}
-			prev = entry;
-			entry = entry->next;
-		}
-		if (entry == NULL)
-		{
-			Assert (prev != NULL);
-			prev->next = newEntry (string, language, value);
-		}
-	}
+	if (table->count == table->allocated)
+		growKeywordTable (table);
+
+	entry = table->entries + table->count;
+	entry->string = string;
+	entry->hash   = hashValue (string);
+	entry->value  = value;
+	indexEntry (table, table->count++);
 }
 
 static int lookupKeywordFull (const char *const string, bool caseSensitive, langType language)
 {
-	const unsigned int index = hashValue (string, language) % TableSize;
-	hashEntry *entry = getHashTableEntry (index);
-	int result = KEYWORD_NONE;
+	const langKeywords *const table = getKeywordTable (language, false);
+	unsigned int hash;
 
-	while (entry != NULL)
+	if (table == NULL)
+		return KEYWORD_NONE;
+
+	hash = hashValue (string);
+	for (unsigned int i = hash & table->mask;
+		 table->index [i] != 0;
+		 i = (i + 1) & table->mask)
 	{
-		if (language == entry->language &&
+		const keywordEntry *const entry = table->entries + table->index [i] - 1;
+
+		if (entry->hash == hash &&
 			((caseSensitive && strcmp (string, entry->string) == 0) ||
 			 (!caseSensitive && strcasecmp (string, entry->string) == 0)))
-		{
-			result = entry->value;
-			break;
-		}
-		entry = entry->next;
+			return entry->value;
 	}
-	return result;
+	return KEYWORD_NONE;
 }
 
 extern int lookupKeyword (const char *const string, langType language)
@@ -169,91 +193,66 @@ extern int lookupCaseKeyword (const char *const string, langType language)
 
 extern void freeKeywordTable (void)
 {
-	if (HashTable != NULL)
+	for (unsigned int i = 0; i < KeywordTableCount; i++)
 	{
-		unsigned int i;
-
-		for (i = 0  ;  i < TableSize  ;  ++i)
-		{
-			hashEntry *entry = HashTable [i];
+		langKeywords *const table = KeywordTables [i];
 
-			while (entry != NULL)
-			{
-				hashEntry *next = entry->next;
-				eFree (entry);
-				entry = next;
-			}
-		}
-		eFree (HashTable);
+		if (table == NULL)
+			continue;
+		eFree (table->entries);
+		eFree (table->index);
+		eFree (table);
 	}
+	if (KeywordTables != NULL)
+		eFree (KeywordTables);
+	KeywordTables = NULL;
+	KeywordTableCount = 0;
 }
 
 #ifdef DEBUG
 
-static void printEntry (const hashEntry *const entry)
-{
-	printf ("  %-15s %-7s\n", entry->string, getLanguageName (entry->language));
-}
-
-static unsigned int printBucket (const unsigned int i)
+extern void printKeywordTable (void)
 {
-	hashEntry **const table = getHashTable ();
-	hashEntry *entry = table [i];
-	unsigned int measure = 1;
-	bool first = true;
-
-	printf ("%2d:", i);
-	if (entry == NULL)
-		printf ("\n");
-	else while (entry != NULL)
+	for (unsigned int i = 0; i < KeywordTableCount; i++)
 	{
-		if (! first)
-			printf ("    ");
-		else
-		{
-			printf (" ");
-			first = false;
-		}
-		printEntry (entry);
-		entry = entry->next;
-		measure = 2 * measure;
-	}
-	return measure - 1;
-}
+		const langKeywords *const table = KeywordTables [i];
+		unsigned long probes = 0;
 
-extern void printKeywordTable (void)
-{
-	unsigned long emptyBucketCount = 0;
-	unsigned long measure = 0;
-	unsigned int i;
+		if (table == NULL)
+			continue;
 
-	for (i = 0  ;  i < TableSize  ;  ++i)
-	{
-		const unsigned int pass = printBucket (i);
+		printf ("%s:\n", getLanguageName (i));
+		for (unsigned int n = 0; n < table->count; n++)
+		{
+			const keywordEntry *const entry = table->entries + n;
+			unsigned int slot = entry->hash & table->mask;
+			unsigned int measure = 1;
 
-		measure += pass;
-		if (pass == 0)
-			++emptyBucketCount;
+			while (table->index [slot] != n + 1)
+			{
+				slot = (slot + 1) & table->mask;
+				measure++;
+			}
+			printf ("  %-15s %u\n", entry->string, measure);
+			probes += measure;
+		}
+		printf ("%u keywords in %u slots, %lu probes\n",
+				table->count, table->mask + 1, probes);
 	}
-
-	printf ("spread measure = %ld\n", measure);
-	printf ("%ld empty buckets\n", emptyBucketCount);
 }
 
 #endif
 
 extern void dumpKeywordTable (FILE *fp)
 {
-	unsigned int i;
-	for (i = 0  ;  i < TableSize  ;  ++i)
+	for (unsigned int i = 0; i < KeywordTableCount; i++)
 	{
-		hashEntry **const table = getHashTable ();
-		hashEntry *entry = table [i];
-		while (entry != NULL)
-		{
-			fprintf(fp, "%s	%s\n", entry->string, getLanguageName (entry->language));
-			entry = entry->next;
-		}
+		const langKeywords *const table = KeywordTables [i];
+
+		if (table == NULL)
+			continue;
+		for (unsigned int n = 0; n < table->count; n++)
+			fprintf(fp, "%s	%s\n", table->entries [n].string, getLanguageName (i));
 	}
 }
 
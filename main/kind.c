@@ -13,13 +13,15 @@
 #include "general.h"
 
 #include <ctype.h>
+#include <limits.h>
 #include <stdio.h>
 #include <string.h>
 
 #include "colprint_p.h"
 #include "ctags.h"
 #include "debug.h"
-#include "entry.h"
+#include "entry_p.h"
+#include "htable.h"
 #include "kind.h"
 #include "parse_p.h"
 #include "options.h"
@@ -36,6 +38,11 @@ struct roleControlBlock {
 	roleObject *role;
 	unsigned int count;
 	int owner;
+
+	/* The roles enabled, valid while enabledBitsGeneration equals
+	   RoleEnablementGeneration. */
+	roleBitsType enabledBits;
+	unsigned int enabledBitsGeneration;
 };
 
 typedef struct sKindObject {
@@ -51,6 +58,13 @@ struct kindControlBlock {
 	langType owner;
 	scopeSeparator defaultScopeSeparator;
 	scopeSeparator defaultRootScopeSeparator;
+
+	/* Lookup tables made on the first lookup, and updated by
+	   defineKind (). letterIndex has the index of the first kind
+	   having a letter plus 1, or 0. nameIndex maps a name to the index
+	   of the first kind having it plus 1. */
+	int *letterIndex;
+	hashTable *nameIndex;
 };
 
 extern const char *renderRole (const roleDefinition* const role, vString* b)
@@ -81,8 +95,14 @@ extern void enableKind (kindDefinition *kind, bool enable)
 	}
 }
 
+/* Incremented when a role is enabled, disabled, or defined. Starts at
+   1 so the cache of a new roleControlBlock is stale. */
+static unsigned int RoleEnablementGeneration = 1;
+
 extern void enableRole (roleDefinition *role, bool enable)
 {
+	if (role->enabled != enable)
+		RoleEnablementGeneration++;
 	role->enabled = enable;
 }
 
@@ -106,6 +126,8 @@ static struct roleControlBlock* allocRoleControlBlock (kindObject *kind)
 	rcb = xMalloc(1, struct roleControlBlock);
 	rcb->count = kind->def->nRoles;
 	rcb->owner = kind->def->id;
+	rcb->enabledBits = 0;
+	rcb->enabledBitsGeneration = 0;
 	rcb->role = xMalloc(rcb->count, roleObject);
 	for (j = 0; j < rcb->count; j++)
 		initRoleObject (rcb->role + j, kind->def->roles + j, NULL, j);
@@ -122,6 +144,8 @@ extern struct kindControlBlock* allocKindControlBlock (parserDefinition *parser)
 	kcb->kind = xMalloc (parser->kindCount, kindObject);
 	kcb->count = parser->kindCount;
 	kcb->owner = parser->id;
+	kcb->letterIndex = NULL;
+	kcb->nameIndex = NULL;
 
 	kcb->defaultScopeSeparator.parentKindIndex = KIND_WILDCARD_INDEX;
 	kcb->defaultScopeSeparator.separator = NULL;
@@ -176,6 +200,11 @@ extern void freeKindControlBlock (struct kindControlBlock* kcb)
 			ptrArrayDelete(kcb->kind [i].dynamicSeparators);
 	}
 
+	if (kcb->letterIndex)
+		eFree (kcb->letterIndex);
+	if (kcb->nameIndex)
+		hashTableDelete (kcb->nameIndex);
+
 	if (kcb->defaultRootScopeSeparator.separator)
 		eFree((char *)kcb->defaultRootScopeSeparator.separator);
 	if (kcb->defaultScopeSeparator.separator)
@@ -186,6 +215,42 @@ extern void freeKindControlBlock (struct kindControlBlock* kcb)
 	eFree (kcb);
 }
 
+static void indexKind (struct kindControlBlock* kcb, int kindIndex)
+{
+	kindDefinition *kdef = kcb->kind [kindIndex].def;
+
+	if (kcb->letterIndex && kcb->letterIndex [(unsigned char) kdef->letter] == 0)
+		kcb->letterIndex [(unsigned char) kdef->letter] = kindIndex + 1;
+
+	if (kcb->nameIndex && kdef->name
+		&& !hashTableHasItem (kcb->nameIndex, kdef->name))
+		hashTablePutItem (kcb->nameIndex, kdef->name, HT_INT_TO_PTR (kindIndex + 1));
+}
+
+static int *getLetterIndex (struct kindControlBlock* kcb)
+{
+	if (kcb->letterIndex == NULL)
+	{
+		kcb->letterIndex = xCalloc (UCHAR_MAX + 1, int);
+		for (unsigned int i = 0; i < kcb->count; i++)
+			indexKind (kcb, i);
+	}
+	return kcb->letterIndex;
+}
+
+static hashTable *getNameIndex (struct kindControlBlock* kcb)
+{
+	if (kcb->nameIndex == NULL)
+	{
+		kcb->nameIndex = hashTableNew (kcb->count * 2 + 1,
+									   hashCstrhash, hashCstreq,
+									   NULL, NULL);
+		for (unsigned int i = 0; i < kcb->count; i++)
+			indexKind (kcb, i);
+	}
+	return kcb->nameIndex;
+}
+
 extern int  defineKind (struct kindControlBlock* kcb, kindDefinition *def,
 						freeKindDefFunc freeKindDef)
 {
@@ -195,6 +260,7 @@ extern int  defineKind (struct kindControlBlock* kcb, kindDefinition *def,
 	kcb->kind [def->id].free = freeKindDef;
 	kcb->kind [def->id].rcb = allocRoleControlBlock(kcb->kind + def->id);
 	kcb->kind [def->id].dynamicSeparators = NULL;
+	indexKind (kcb, def->id);
 
 	verbose ("Add kind[%d] \"%c,%s,%s\" to %s\n", def->id,
 			 def->letter, def->name, def->description,
@@ -220,6 +286,7 @@ extern int defineRole (struct kindControlBlock* kcb, int kindIndex,
 
 	rcb->role = xRealloc (rcb->role, rcb->count, roleObject);
 	initRoleObject (rcb->role + roleIndex, def, freeRoleDef, roleIndex);
+	RoleEnablementGeneration++;
 
 	return roleIndex;
 }
@@ -230,6 +297,21 @@ extern bool isRoleEnabled (struct kindControlBlock* kcb, int kindIndex, int role
 	return rdef->enabled;
 }
 
+extern roleBitsType getEnabledRoleBits (struct kindControlBlock* kcb, int kindIndex)
+{
+	struct roleControlBlock *rcb = kcb->kind [kindIndex].rcb;
+
+	if (rcb->enabledBitsGeneration != RoleEnablementGeneration)
+	{
+		rcb->enabledBits = 0;
+		for (unsigned int i = 0; i < rcb->count; i++)
+			if (rcb->role [i].def->enabled)
+				rcb->enabledBits |= makeRoleBit (i);
+		rcb->enabledBitsGeneration = RoleEnablementGeneration;
+	}
+	return rcb->enabledBits;
+}
+
 extern unsigned int countKinds (struct kindControlBlock* kcb)
 {
 	return kcb->count;
@@ -247,60 +329,30 @@ extern kindDefinition *getKind (struct kindControlBlock* kcb, int kindIndex)
 
 extern kindDefinition *getKindForLetter (struct kindControlBlock* kcb, char letter)
 {
-	unsigned int i;
-	kindDefinition * kdef;
+	int i = getKindIndexForLetter (kcb, letter);
 
-	for (i = 0;  i < countKinds (kcb);  ++i)
-	{
-		kdef = getKind (kcb, i);
-		if (kdef->letter == letter)
-			return kdef;
-	}
-	return NULL;
+	return (i == KIND_GHOST_INDEX)? NULL: getKind (kcb, i);
 }
 
 extern kindDefinition *getKindForName (struct kindControlBlock* kcb, const char* name)
 {
-	unsigned int i;
-	kindDefinition * kdef;
+	int i = getKindIndexForName (kcb, name);
 
-	for (i = 0;  i < countKinds (kcb);  ++i)
-	{
-		kdef = getKind (kcb, i);
-		Assert(kdef);
-		if (kdef->name && (strcmp(kdef->name, name) == 0))
-			return kdef;
-	}
-	return NULL;
+	return (i == KIND_GHOST_INDEX)? NULL: getKind (kcb, i);
 }
 
 extern int getKindIndexForLetter (struct kindControlBlock* kcb, char letter)
 {
-	unsigned int i;
-	kindDefinition * kdef;
+	int i = getLetterIndex (kcb) [(unsigned char) letter];
 
-	for (i = 0;  i < countKinds (kcb);  ++i)
-	{
-		kdef = getKind (kcb, i);
-		if (kdef->letter == letter)
-			return (unsigned int)i;
-	}
-	return KIND_GHOST_INDEX;
+	return i? i - 1: KIND_GHOST_INDEX;
 }
 
 extern int getKindIndexForName (struct kindControlBlock* kcb, const char* name)
 {
-	unsigned int i;
-	kindDefinition * kdef;
+	int i = HT_PTR_TO_INT (hashTableGetItem (getNameIndex (kcb), name));
 
-	for (i = 0;  i < countKinds (kcb);  ++i)
-	{
-		kdef = getKind (kcb, i);
-		Assert(kdef);
-		if (kdef->name && (strcmp(kdef->name, name) == 0))
-			return (int)i;
-	}
-	return KIND_GHOST_INDEX;
+	return i? i - 1: KIND_GHOST_INDEX;
 }
 
 extern roleDefinition* getRole(struct kindControlBlock* kcb, int kindIndex, int roleIndex)
@@ -0,0 +1,416 @@
+/*
+*   Copyright (c) 2026, Universal Ctags Team
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License version 2 or (at your option) any later version.
+*
+*   This module implements --language-cache option: reusing the languages
+*   guessed for input files in the last run.
+*
+*   Guessing the language of a file having no known extension opens the
+*   file and reads it for an interpreter, a modeline, and so on. For each
+*   input file, the cache file records the modification time, the size,
+*   whether it is executable, and the guessed language of the file. When ctags runs again with the
+*   same cache file, the language of an input file that has not changed is
+*   taken from the cache without opening the file.
+*
+*   The format of the cache file is:
+*
+*	!_CTAGS_LANGUAGE_CACHE<TAB>1
+*	L<TAB>mtime<TAB>size<TAB>mode<TAB>maps<TAB>language<TAB>name
+*	L<TAB>...
+*
+*   "mode" is "x" for an executable file and "-" for
+*   the others; the interpreter is looked for only in an executable file
+*   unless --guess-language-eagerly is given. "maps" is a hash of the language maps, the aliases, and the enabled
+*   languages in effect when the language was guessed. An entry made with
+*   different ones is not used. "language" is empty if no parser was
+*   chosen for the file.
+*/
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"  /* must always come first */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "ctags.h"
+#include "debug.h"
+#include "htable.h"
+#include "langcache_p.h"
+#include "options_p.h"
+#include "parse_p.h"
+#include "ptrarray.h"
+#include "read.h"
+#include "routines.h"
+#include "routines_p.h"
+#include "vstring.h"
+
+/*
+*   DATA DECLARATIONS
+*/
+#define CACHE_MAGIC "!_CTAGS_LANGUAGE_CACHE"
+#define CACHE_VERSION 1
+
+typedef unsigned long long cacheHash;
+
+typedef struct sLanguageCacheEntry {
+	char *name;
+	long long mtime;
+	unsigned long size;
+	bool executable;
+	cacheHash maps;
+	char *language;		/* NULL if no parser was chosen */
+} languageCacheEntry;
+
+/*
+*   DATA DEFINITIONS
+*/
+static bool CacheEnabled = false;
+
+/* Entries loaded from the cache file */
+static hashTable *OldEntries = NULL;
+
+/* Entries to be written to the cache file, in the order of input files */
+static ptrArray *NewEntries = NULL;
+static hashTable *NewEntryTable = NULL;
+
+/* The hash of the language maps and the generation of the maps it
+ * was computed for */
+static cacheHash MapsHash;
+static unsigned int MapsHashGeneration;
+static bool MapsHashGuessEagerly;
+static bool MapsHashValid = false;
+
+/*
+*   FUNCTION DEFINITIONS
+*/
+
+/* FNV-1a */
+#define CACHE_HASH_INIT 14695981039346656037ULL
+
+static cacheHash updateHash (cacheHash h, const unsigned char *p, size_t len)
+{
+	for (size_t i = 0; i < len; i++)
+	{
+		h ^= p [i];
+		h *= 1099511628211ULL;
+	}
+	return h;
+}
+
+static cacheHash hashLanguageMaps (void)
+{
+	if (MapsHashValid
+		&& MapsHashGeneration == getLanguageMapGeneration ()
+		&& MapsHashGuessEagerly == Option.guessLanguageEagerly)
+		return MapsHash;
+
+	vString *fp = vStringNewInit (PROGRAM_VERSION);
+
+	vStringPut (fp, '\n');
+	if (Option.guessLanguageEagerly)
+		vStringCatS (fp, "-G\n");
+	catLanguageMapFingerprint (fp);
+
+	MapsHash = updateHash (CACHE_HASH_INIT,
+						   (const unsigned char *) vStringValue (fp),
+						   vStringLength (fp));
+	MapsHashGeneration = getLanguageMapGeneration ();
+	MapsHashGuessEagerly = Option.guessLanguageEagerly;
+	MapsHashValid = true;
+
+	vStringDelete (fp);
+	return MapsHash;
+}
+
+static void deleteCacheEntry (void *data)
+{
+	languageCacheEntry *entry = data;
+
+	eFree (entry->name);
+	if (entry->language)
+		eFree (entry->language);
+	eFree (entry);
+}
+
+static languageCacheEntry *parseEntry (const char *line)
+{
+	languageCacheEntry *entry;
+	long long mtime;
+	unsigned long size;
+	char mode;
+	cacheHash maps;
+	int consumed = 0;
+	const char *language;
+	const char *tab;
+
+	/* "\t" in the format skips all the white spaces, so the tab before
+	 * an empty language is checked by hand. */
+	if (sscanf (line, "L\t%lld\t%lu\t%c\t%llx%n",
+				&mtime, &size, &mode, &maps, &consumed) != 4
+		|| (mode != 'x' && mode != '-')
+		|| line [consumed] != '\t')
+		return NULL;
+
+	language = line + consumed + 1;
+	tab = strchr (language, '\t');
+	if (tab == NULL || tab [1] == '\0')
+		return NULL;
+
+	entry = xCalloc (1, languageCacheEntry);
+	entry->mtime = mtime;
+	entry->size = size;
+	entry->executable = (mode == 'x');
+	entry->maps = maps;
+	if (tab != language)
+		entry->language = eStrndup (language, tab - language);
+	entry->name = eStrdup (tab + 1);
+	return entry;
+}
+
+static bool loadCacheFile (const char *const fileName)
+{
+	MIO *mio = mio_new_file (fileName, "rb");
+	vString *vLine;
+	bool ok = true;
+
+	if (mio == NULL)
+	{
+		/* The first run */
+		verbose ("language cache file \"%s\" is not found\n", fileName);
+		return true;
+	}
+
+	vLine = vStringNew ();
+	if (readLineRaw (vLine, mio) == NULL)
+		ok = false;
+	else
+	{
+		int version = 0;
+
+		vStringStripNewline (vLine);
+		if (sscanf (vStringValue (vLine), CACHE_MAGIC "\t%d", &version) != 1
+			|| version != CACHE_VERSION)
+			ok = false;
+	}
+
+	while (ok && readLineRaw (vLine, mio) != NULL)
+	{
+		languageCacheEntry *entry;
+
+		vStringStripNewline (vLine);
+		entry = parseEntry (vStringValue (vLine));
+		if (entry == NULL)
+		{
+			ok = false;
+			break;
+		}
+
+		if (hashTableHasItem (OldEntries, entry->name))
+			deleteCacheEntry (entry);
+		else
+			hashTablePutItem (OldEntries, entry->name, entry);
+	}
+
+	vStringDelete (vLine);
+	mio_unref (mio);
+	return ok;
+}
+
+static bool deleteOldEntry (const void *key CTAGS_ATTR_UNUSED, void *value,
+							void *user_data CTAGS_ATTR_UNUSED)
+{
+	deleteCacheEntry (value);
+	return true;
+}
+
+static void deleteOldEntries (void)
+{
+	hashTableForeachItem (OldEntries, deleteOldEntry, NULL);
+	hashTableClear (OldEntries);
+}
+
+extern void openLanguageCache (void)
+{
+	Assert (! CacheEnabled);
+
+	if (Option.languageCacheFileName == NULL)
+		return;
+
+	OldEntries = hashTableNew (1024, hashCstrhash, hashCstreq,
+							   NULL, NULL);
+	NewEntryTable = hashTableNew (1024, hashCstrhash, hashCstreq,
+								  NULL, NULL);
+	NewEntries = ptrArrayNew (deleteCacheEntry);
+
+	if (! loadCacheFile (Option.languageCacheFileName))
+	{
+		error (WARNING, "broken language cache file \"%s\"; ignored",
+			   Option.languageCacheFileName);
+		deleteOldEntries ();
+	}
+	CacheEnabled = true;
+}
+
+extern bool isLanguageCacheEnabled (void)
+{
+	return CacheEnabled;
+}
+
+static void addNewEntry (languageCacheEntry *entry)
+{
+	languageCacheEntry *old = hashTableGetItem (NewEntryTable, entry->name);
+
+	if (old)
+	{
+		/* The same file is given twice, and the language maps are
+		 * changed between them. Keep the last guess at the place of
+		 * the first. */
+		char *language = old->language;
+
+		old->mtime = entry->mtime;
+		old->size = entry->size;
+		old->executable = entry->executable;
+		old->maps = entry->maps;
+		old->language = entry->language;
+		entry->language = language;
+		deleteCacheEntry (entry);
+		return;
+	}
+	ptrArrayAdd (NewEntries, entry);
+	hashTablePutItem (NewEntryTable, entry->name, entry);
+}
+
+static bool isEntryValid (const languageCacheEntry *entry,
+						  const fileStatus *const status)
+{
+	return (entry->size == status->size
+			&& entry->mtime == (long long) status->mtime
+			&& entry->executable == status->isExecutable
+			&& entry->maps == hashLanguageMaps ());
+}
+
+extern langType getCachedLanguage (const char *const fileName)
+{
+	languageCacheEntry *entry;
+	fileStatus *status;
+	langType language;
+	bool fromOld = false;
+
+	if (! CacheEnabled)
+		return LANG_AUTO;
+
+	entry = hashTableGetItem (NewEntryTable, fileName);
+	if (entry == NULL)
+	{
+		entry = hashTableGetItem (OldEntries, fileName);
+		fromOld = true;
+	}
+	if (entry == NULL)
+		return LANG_AUTO;
+
+	status = eStat (fileName);
+	if (! status->exists || ! isEntryValid (entry, status))
+		return LANG_AUTO;
+
+	if (entry->language == NULL)
+		language = LANG_IGNORE;
+	else
+	{
+		language = getNamedLanguage (entry->language, 0);
+		if (language == LANG_IGNORE)
+			return LANG_AUTO;
+	}
+
+	verbose ("Get cached language for %s: %s\n", fileName,
+			 entry->language? entry->language: "NONE");
+
+	if (fromOld)
+	{
+		/* Move the entry to the new cache. */
+		hashTableDeleteItem (OldEntries, fileName);
+		addNewEntry (entry);
+	}
+	return language;
+}
+
+extern void cacheLanguage (const char *const fileName, langType language)
+{
+	languageCacheEntry *entry;
+	fileStatus *status;
+
+	if (! CacheEnabled)
+		return;
+
+	status = eStat (fileName);
+	if (! status->exists || ! status->isNormalFile)
+		return;
+
+	entry = xCalloc (1, languageCacheEntry);
+	entry->name = eStrdup (fileName);
+	entry->mtime = (long long) status->mtime;
+	entry->size = status->size;
+	entry->executable = status->isExecutable;
+	entry->maps = hashLanguageMaps ();
+	if (language != LANG_IGNORE)
+		entry->language = eStrdup (getLanguageName (language));
+
+	addNewEntry (entry);
+}
+
+static bool writeCacheFile (const char *const fileName)
+{
+	MIO *mio = mio_new_file (fileName, "wb");
+	bool ok;
+
+	if (mio == NULL)
+		return false;
+
+	ok = (mio_printf (mio, "%s\t%d\n", CACHE_MAGIC, CACHE_VERSION) >= 0);
+	for (unsigned int i = 0; ok && i < ptrArrayCount (NewEntries); i++)
+	{
+		languageCacheEntry *entry = ptrArrayItem (NewEntries, i);
+
+		ok = (mio_printf (mio, "L\t%lld\t%lu\t%c\t%llx\t%s\t%s\n",
+						  entry->mtime, entry->size,
+						  entry->executable? 'x': '-', entry->maps,
+						  entry->language? entry->language: "",
+						  entry->name) >= 0);
+	}
+
+	if (mio_unref (mio) != 0)
+		ok = false;
+	return ok;
+}
+
+extern void closeLanguageCache (void)
+{
+	if (! CacheEnabled)
+		return;
+
+	/* Write to a temporary file first not to break the old cache
+	 * when something goes wrong. */
+	vString *tmp = vStringNewInit (Option.languageCacheFileName);
+	vStringCatS (tmp, ".tmp");
+
+	if (! writeCacheFile (vStringValue (tmp))
+		|| rename (vStringValue (tmp), Option.languageCacheFileName) != 0)
+	{
+		error (WARNING | PERROR, "cannot write language cache file \"%s\"",
+			   Option.languageCacheFileName);
+		remove (vStringValue (tmp));
+	}
+	vStringDelete (tmp);
+
+	hashTableDelete (NewEntryTable);
+	NewEntryTable = NULL;
+	ptrArrayDelete (NewEntries);
+	NewEntries = NULL;
+	deleteOldEntries ();
+	hashTableDelete (OldEntries);
+	OldEntries = NULL;
+	CacheEnabled = false;
+}
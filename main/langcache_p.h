@@ -0,0 +1,34 @@
+/*
+*   Copyright (c) 2026, Universal Ctags Team
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License version 2 or (at your option) any later version.
+*
+*   Main part private interface to langcache.c
+*/
+#ifndef CTAGS_MAIN_LANGCACHE_PRIVATE_H
+#define CTAGS_MAIN_LANGCACHE_PRIVATE_H
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"  /* must always come first */
+
+#include "types.h"
+
+/*
+*   FUNCTION PROTOTYPES
+*/
+extern void openLanguageCache (void);
+extern void closeLanguageCache (void);
+extern bool isLanguageCacheEnabled (void);
+
+/* Returns the language guessed for fileName in the last run if fileName
+ * and the language maps are not changed since then. Returns LANG_AUTO
+ * if there is no such entry. */
+extern langType getCachedLanguage (const char *const fileName);
+
+/* Records the language guessed for fileName. */
+extern void cacheLanguage (const char *const fileName, langType language);
+
+#endif  /* CTAGS_MAIN_LANGCACHE_PRIVATE_H */
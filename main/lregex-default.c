@@ -16,8 +16,11 @@
 */
 #include "general.h"  /* must always come first */
 
+#include <ctype.h>
+#include <string.h>
 #include <regex.h>
 #include "lregex_p.h"
+#include "vstring.h"
 
 /*
 *    FUNCTION DECLARATIONS
@@ -30,6 +33,13 @@ static regexCompiledCode compile (struct regexBackend *backend,
 								  int flags);
 static void delete_code (void *code);
 static void set_icase_flag (int *flags);
+static char *required_literal (struct regexBackend *backend,
+							   const char *const regexp,
+							   int flags);
+static bool first_bytes (struct regexBackend *backend,
+						 const char *const regexp,
+						 int flags,
+						 unsigned char set [256 / 8]);
 
 /*
 *    DATA DEFINITIONS
@@ -41,6 +51,8 @@ static struct regexBackend defaultRegexBackend = {
 	.compile = compile,
 	.match = match,
 	.delete_code = delete_code,
+	.required_literal = required_literal,
+	.first_bytes = first_bytes,
 };
 
 /*
@@ -115,13 +127,545 @@ static regexCompiledCode compile (struct regexBackend *backend,
 }
 
 static int match (struct regexBackend *backend,
-				  void *code, const char *input, size_t size CTAGS_ATTR_UNUSED,
+				  void *code, const char *input, size_t size,
 				  regmatch_t pmatch[BACK_REFERENCE_COUNT])
 {
-	return regexec ((regex_t *)code, input, BACK_REFERENCE_COUNT, pmatch, 0);
+	/* The input of multiline patterns may be the data of a memory
+	 * stream, matched in place and not terminated with NUL. Otherwise
+	 * it is the copy of the lines read. */
+	pmatch [0].rm_so = 0;
+	pmatch [0].rm_eo = size;
+	return regexec ((regex_t *)code, input, BACK_REFERENCE_COUNT, pmatch, REG_STARTEND);
 }
 
 static void set_icase_flag (int *flags)
 {
 	*flags |= REG_ICASE;
 }
+
+/* The literal extraction below is conservative: when a construct is
+ * not understood well, the literal being collected is dropped. */
+
+static bool isInterval (const char *p, bool extended, const char **end,
+						unsigned int *min)
+{
+	/* p points '{' (extended) or '\{' (basic). */
+	p += extended? 1: 2;
+
+	*min = 0;
+	while (isdigit ((unsigned char) *p))
+	{
+		if (*min < 256)
+			*min = *min * 10 + (*p - '0');
+		p++;
+	}
+	if (*p == ',')
+		p++;
+	while (isdigit ((unsigned char) *p))
+		p++;
+
+	if (extended && *p == '}')
+		*end = p + 1;
+	else if (!extended && p[0] == '\\' && p[1] == '}')
+		*end = p + 2;
+	else
+		return false;
+	return true;
+}
+
+/* Skip quantifiers at P. Set *REQUIRED false if the quantified atom
+ * may not appear. */
+static const char *skipQuantifiers (const char *p, bool extended, bool *required)
+{
+	const char *end;
+	unsigned int min;
+
+	*required = true;
+	while (true)
+	{
+		if (*p == '*')
+		{
+			*required = false;
+			p++;
+		}
+		else if (extended && (*p == '+' || *p == '?'))
+		{
+			if (*p == '?')
+				*required = false;
+			p++;
+		}
+		else if (!extended && p[0] == '\\' && (p[1] == '+' || p[1] == '?'))
+		{
+			if (p[1] == '?')
+				*required = false;
+			p += 2;
+		}
+		else if ((extended? (*p == '{'): (p[0] == '\\' && p[1] == '{'))
+				 && isInterval (p, extended, &end, &min))
+		{
+			if (min == 0)
+				*required = false;
+			p = end;
+		}
+		else
+			break;
+	}
+	return p;
+}
+
+static bool isQuantifier (const char *p, bool extended)
+{
+	bool required;
+	return (skipQuantifiers (p, extended, &required) != p);
+}
+
+/* p points '['. */
+static const char *skipBracket (const char *p)
+{
+	p++;
+	if (*p == '^')
+		p++;
+	if (*p == ']')
+		p++;
+
+	while (*p != ']')
+	{
+		if (*p == '\0')
+			return NULL;
+		if (*p == '[' && (p[1] == ':' || p[1] == '.' || p[1] == '='))
+		{
+			char delim = p[1];
+
+			p += 2;
+			while (!(p[0] == delim && p[1] == ']'))
+			{
+				if (*p == '\0')
+					return NULL;
+				p++;
+			}
+			p += 2;
+		}
+		else
+			p++;
+	}
+	return p + 1;
+}
+
+/* p points '(' (extended) or '\(' (basic). */
+static const char *skipGroup (const char *p, bool extended)
+{
+	int depth = 0;
+
+	do
+	{
+		if (*p == '\0')
+			return NULL;
+		else if (*p == '[')
+		{
+			p = skipBracket (p);
+			if (p == NULL)
+				return NULL;
+			continue;
+		}
+		else if (*p == '\\')
+		{
+			if (p[1] == '\0')
+				return NULL;
+			if (!extended && p[1] == '(')
+				depth++;
+			else if (!extended && p[1] == ')')
+				depth--;
+			p += 2;
+			continue;
+		}
+		else if (extended && *p == '(')
+			depth++;
+		else if (extended && *p == ')')
+			depth--;
+		p++;
+	}
+	while (depth > 0);
+
+	return p;
+}
+
+static void flushLiteral (vString *current, vString *best)
+{
+	if (vStringLength (current) > vStringLength (best))
+		vStringCopy (best, current);
+	vStringClear (current);
+}
+
+static char *required_literal (struct regexBackend *backend CTAGS_ATTR_UNUSED,
+							   const char *const regexp,
+							   int flags)
+{
+	bool extended = (flags & REG_EXTENDED);
+	vString *current = vStringNew ();
+	vString *best = vStringNew ();
+	const char *p = regexp;
+	bool required;
+
+	while (*p)
+	{
+		unsigned char c = *p;
+
+		if (c == '[' || (extended? (c == '('): (c == '\\' && p[1] == '(')))
+		{
+			flushLiteral (current, best);
+			p = (c == '[')? skipBracket (p): skipGroup (p, extended);
+			if (p == NULL)
+				goto giveup;
+			p = skipQuantifiers (p, extended, &required);
+			continue;
+		}
+		else if ((extended && (c == '|' || c == ')'))
+				 || (c == '\\' && (p[1] == '|' || p[1] == '\0'
+								   || (!extended && p[1] == ')'))))
+			goto giveup;
+		else if (c == '.' || c == '^' || c == '$' || c >= 0x80
+				 || isQuantifier (p, extended)
+				 || (extended && (c == '{' || c == '+' || c == '?'))
+				 || (c == '\\' && (isalnum ((unsigned char) p[1])
+									|| ((unsigned char) p[1]) >= 0x80
+									/* GNU extensions */
+									|| strchr (extended? "<>`'": "<>`'{}+?", p[1]))))
+		{
+			/* Not a literal character */
+			flushLiteral (current, best);
+			p += (c == '\\')? 2: 1;
+			p = skipQuantifiers (p, extended, &required);
+			continue;
+		}
+
+		if (c == '\\')
+			c = *++p;
+		p++;
+
+		if (!isQuantifier (p, extended))
+			vStringPut (current, c);
+		else
+		{
+			p = skipQuantifiers (p, extended, &required);
+			if (required)
+				vStringPut (current, c);
+			flushLiteral (current, best);
+		}
+	}
+	flushLiteral (current, best);
+	vStringDelete (current);
+
+	if (vStringLength (best) == 0)
+	{
+		vStringDelete (best);
+		return NULL;
+	}
+	return vStringDeleteUnwrap (best);
+
+ giveup:
+	vStringDelete (current);
+	vStringDelete (best);
+	return NULL;
+}
+
+/* Computing the set of bytes a match can start with.
+ *
+ * This works on patterns anchored with '^' like those of mtable
+ * parsers. Anything not understood well makes the computation
+ * give up. */
+
+struct firstInfo {
+	unsigned char set [256 / 8];
+	bool nullable;
+};
+
+struct firstParser {
+	const char *p;
+	bool extended;
+	bool icase;
+	bool failed;
+};
+
+static void addFirstByte (struct firstParser *fp, struct firstInfo *info, unsigned char c)
+{
+	info->set [c / 8] |= 1 << (c % 8);
+	if (fp->icase && isalpha (c))
+	{
+		unsigned char d = isupper (c)? tolower (c): toupper (c);
+		info->set [d / 8] |= 1 << (d % 8);
+	}
+}
+
+static void addFirstBytesIf (struct firstParser *fp, struct firstInfo *info,
+							 int (* pred) (int), bool negate)
+{
+	for (int c = 1; c < 256; c++)
+		if ((pred (c) != 0) != negate)
+			addFirstByte (fp, info, c);
+}
+
+static int isWordChar (int c)
+{
+	return (isalnum (c) || c == '_');
+}
+
+static int (* classToPredicate (const char *name, size_t len)) (int)
+{
+	static const struct {
+		const char *name;
+		int (* pred) (int);
+	} classes [] = {
+		{ "alnum", isalnum }, { "alpha", isalpha }, { "blank", isblank },
+		{ "cntrl", iscntrl }, { "digit", isdigit }, { "graph", isgraph },
+		{ "lower", islower }, { "print", isprint }, { "punct", ispunct },
+		{ "space", isspace }, { "upper", isupper }, { "xdigit", isxdigit },
+	};
+
+	for (unsigned int i = 0; i < ARRAY_SIZE (classes); i++)
+		if (strlen (classes [i].name) == len
+			&& strncmp (classes [i].name, name, len) == 0)
+			return classes [i].pred;
+	return NULL;
+}
+
+static void parseFirstBracket (struct firstParser *fp, struct firstInfo *info)
+{
+	struct firstInfo members;
+	const char *p = fp->p + 1;
+	bool negate = false;
+
+	memset (&members, 0, sizeof (members));
+
+	if (*p == '^')
+	{
+		negate = true;
+		p++;
+	}
+
+	for (bool first = true; first || *p != ']'; first = false)
+	{
+		if (*p == '\0')
+			goto failed;
+
+		if (p [0] == '[' && p [1] == ':')
+		{
+			const char *name = p + 2;
+			const char *end = strstr (name, ":]");
+			int (* pred) (int);
+
+			if (end == NULL
+				|| (pred = classToPredicate (name, end - name)) == NULL)
+				goto failed;
+			addFirstBytesIf (fp, &members, pred, false);
+			p = end + 2;
+		}
+		else if (p [0] == '[' && (p [1] == '.' || p [1] == '='))
+			goto failed;
+		else if (p [1] == '-' && p [2] != ']' && p [2] != '\0')
+		{
+			unsigned char from = p [0], to = p [2];
+
+			if (to == '[')
+				goto failed;
+			for (unsigned int c = from; c <= to; c++)
+				addFirstByte (fp, &members, c);
+			p += 3;
+		}
+		else
+			addFirstByte (fp, &members, *p++);
+	}
+	fp->p = p + 1;
+
+	for (int c = 1; c < 256; c++)
+	{
+		bool member = members.set [c / 8] & (1 << (c % 8));
+		if (member != negate)
+			addFirstByte (fp, info, c);
+	}
+	info->nullable = false;
+	return;
+
+ failed:
+	fp->failed = true;
+}
+
+static void parseFirstAlternatives (struct firstParser *fp, struct firstInfo *info, bool top);
+static bool isEndOfBranch (struct firstParser *fp);
+
+static void parseFirstAtom (struct firstParser *fp, struct firstInfo *info, bool leading)
+{
+	const char *p = fp->p;
+	unsigned char c = *p;
+
+	memset (info, 0, sizeof (*info));
+
+	if (c == '[')
+	{
+		parseFirstBracket (fp, info);
+		return;
+	}
+	else if (fp->extended? (c == '('): (c == '\\' && p [1] == '('))
+	{
+		fp->p += fp->extended? 1: 2;
+		parseFirstAlternatives (fp, info, false);
+		if (fp->failed)
+			return;
+		if (fp->extended? (*fp->p != ')'): (fp->p [0] != '\\' || fp->p [1] != ')'))
+			fp->failed = true;
+		else
+			fp->p += fp->extended? 1: 2;
+		return;
+	}
+	else if (c == '.')
+	{
+		for (int i = 1; i < 256; i++)
+			addFirstByte (fp, info, i);
+		fp->p++;
+		return;
+	}
+	else if (c == '^' || c == '$')
+	{
+		fp->p++;
+		/* In a basic regex, they are anchors only at the ends of a branch. */
+		if (fp->extended
+			|| (c == '^' && leading)
+			|| (c == '$' && isEndOfBranch (fp)))
+			info->nullable = true; /* match the empty string */
+		else
+			addFirstByte (fp, info, c);
+		return;
+	}
+	else if (c == '\\')
+	{
+		unsigned char d = p [1];
+
+		fp->p += 2;
+		switch (d)
+		{
+		case 'w': addFirstBytesIf (fp, info, isWordChar, false); return;
+		case 'W': addFirstBytesIf (fp, info, isWordChar, true); return;
+		case 's': addFirstBytesIf (fp, info, isspace, false); return;
+		case 'S': addFirstBytesIf (fp, info, isspace, true); return;
+		case 'b': case 'B': case '<': case '>': case '`': case '\'':
+			info->nullable = true;
+			return;
+		}
+		if (d == '\0' || isalnum (d)
+			|| (!fp->extended && strchr ("{}+?|()", d)))
+			fp->failed = true;
+		else
+			addFirstByte (fp, info, d);
+		return;
+	}
+	else if (c == '*' || (fp->extended && strchr ("+?{", c)))
+	{
+		/* A quantifier without an atom */
+		fp->failed = true;
+		return;
+	}
+
+	addFirstByte (fp, info, c);
+	fp->p++;
+}
+
+static bool isEndOfBranch (struct firstParser *fp)
+{
+	const char *p = fp->p;
+
+	if (*p == '\0')
+		return true;
+	if (fp->extended)
+		return (*p == '|' || *p == ')');
+	return (p [0] == '\\' && (p [1] == '|' || p [1] == ')'));
+}
+
+static void parseFirstBranch (struct firstParser *fp, struct firstInfo *info)
+{
+	const char *start = fp->p;
+
+	memset (info, 0, sizeof (*info));
+	info->nullable = true;
+
+	while (! isEndOfBranch (fp))
+	{
+		struct firstInfo atom;
+		bool required;
+
+		parseFirstAtom (fp, &atom, fp->p == start);
+		if (fp->failed)
+			return;
+
+		bool zeroWidth = atom.nullable;
+		for (unsigned int i = 0; zeroWidth && i < sizeof (atom.set); i++)
+			zeroWidth = (atom.set [i] == 0);
+		if (zeroWidth && isQuantifier (fp->p, fp->extended))
+		{
+			/* "^*" in a basic regex matches '*'. Don't think about it. */
+			fp->failed = true;
+			return;
+		}
+		fp->p = skipQuantifiers (fp->p, fp->extended, &required);
+		if (! required)
+			atom.nullable = true;
+
+		if (info->nullable)
+		{
+			for (unsigned int i = 0; i < sizeof (info->set); i++)
+				info->set [i] |= atom.set [i];
+			info->nullable = atom.nullable;
+		}
+	}
+}
+
+static void parseFirstAlternatives (struct firstParser *fp, struct firstInfo *info, bool top)
+{
+	memset (info, 0, sizeof (*info));
+
+	while (true)
+	{
+		struct firstInfo branch;
+
+		/* A branch not anchored can match anywhere. */
+		if (top && *fp->p != '^')
+		{
+			fp->failed = true;
+			return;
+		}
+
+		parseFirstBranch (fp, &branch);
+		if (fp->failed)
+			return;
+
+		for (unsigned int i = 0; i < sizeof (info->set); i++)
+			info->set [i] |= branch.set [i];
+		info->nullable |= branch.nullable;
+
+		if (fp->extended && *fp->p == '|')
+			fp->p++;
+		else if (!fp->extended && fp->p [0] == '\\' && fp->p [1] == '|')
+			fp->p += 2;
+		else
+			break;
+	}
+}
+
+static bool first_bytes (struct regexBackend *backend CTAGS_ATTR_UNUSED,
+						 const char *const regexp,
+						 int flags,
+						 unsigned char set [256 / 8])
+{
+	struct firstParser fp = {
+		.p = regexp,
+		.extended = (flags & REG_EXTENDED),
+		.icase = (flags & REG_ICASE),
+		.failed = false,
+	};
+	struct firstInfo info;
+
+	parseFirstAlternatives (&fp, &info, true);
+	if (fp.failed || *fp.p != '\0' || info.nullable)
+		return false;
+
+	memcpy (set, info.set, sizeof (info.set));
+	return true;
+}
@@ -39,6 +39,19 @@ static regexCompiledCode compile (struct regexBackend *backend,
 static void delete_code (void *code);
 static void set_icase_flag (int *flags);
 
+/*
+*    DATA DECLARATIONS
+*/
+struct pcre2Code {
+	pcre2_code *code;
+	bool jit;
+};
+
+/* The JIT stack is allocated lazily and grows up to this size.
+ * Patterns needing more stack fall back to the interpreter. */
+#define PCRE2_JIT_STACK_START (32 * 1024)
+#define PCRE2_JIT_STACK_MAX   (1024 * 1024)
+
 /*
 *    DATA DEFINITIONS
 */
@@ -77,7 +90,25 @@ extern void pcre2_regex_flag_long (const char* const s, const char* const unused
 
 static void delete_code (void *code)
 {
-	pcre2_code_free (code);
+	struct pcre2Code *pcode = code;
+
+	pcre2_code_free (pcode->code);
+	eFree (pcode);
+}
+
+static bool isJitAvailable (void)
+{
+	static int available = -1;
+
+	if (available < 0)
+	{
+		uint32_t jit = 0;
+
+		if (pcre2_config (PCRE2_CONFIG_JIT, &jit) < 0)
+			jit = 0;
+		available = jit? 1: 0;
+	}
+	return available;
 }
 
 static regexCompiledCode compile (struct regexBackend *backend,
@@ -100,7 +131,40 @@ static regexCompiledCode compile (struct regexBackend *backend,
 			   buffer);
 		return (regexCompiledCode) { .backend = NULL, .code = NULL };
 	}
-	return (regexCompiledCode) { .backend = &pcre2RegexBackend, .code = regex_code };
+
+	struct pcre2Code *pcode = xMalloc (1, struct pcre2Code);
+	pcode->code = regex_code;
+	/* The interpreter is used if JIT compilation fails. */
+	pcode->jit = (isJitAvailable ()
+				  && pcre2_jit_compile (regex_code, PCRE2_JIT_COMPLETE) == 0);
+
+	return (regexCompiledCode) { .backend = &pcre2RegexBackend, .code = pcode };
+}
+
+/* ctags doesn't use threads; the worker processes of --jobs have
+ * their own copies. */
+static pcre2_match_context *getMatchContext (void)
+{
+	static pcre2_match_context *match_context;
+
+	if (match_context == NULL)
+	{
+		match_context = pcre2_match_context_create (NULL);
+		DEFAULT_TRASH_BOX (match_context, pcre2_match_context_free);
+
+		if (isJitAvailable ())
+		{
+			pcre2_jit_stack *jit_stack = pcre2_jit_stack_create (PCRE2_JIT_STACK_START,
+																 PCRE2_JIT_STACK_MAX,
+																 NULL);
+			if (jit_stack)
+			{
+				DEFAULT_TRASH_BOX (jit_stack, pcre2_jit_stack_free);
+				pcre2_jit_stack_assign (match_context, NULL, jit_stack);
+			}
+		}
+	}
+	return match_context;
 }
 
 static int match (struct regexBackend *backend,
@@ -114,8 +178,20 @@ static int match (struct regexBackend *backend,
 		DEFAULT_TRASH_BOX (match_data, pcre2_match_data_free);
 	}
 
-	int rc = pcre2_match (code, (PCRE2_SPTR)input, size,
-						  0, 0, match_data, NULL);
+	struct pcre2Code *pcode = code;
+	pcre2_match_context *match_context = getMatchContext ();
+	int rc = -1;
+
+	if (pcode->jit)
+	{
+		rc = pcre2_jit_match (pcode->code, (PCRE2_SPTR)input, size,
+							  0, 0, match_data, match_context);
+		if (rc == PCRE2_ERROR_JIT_STACKLIMIT)
+			pcode->jit = false;
+	}
+	if (! pcode->jit)
+		rc = pcre2_match (pcode->code, (PCRE2_SPTR)input, size,
+						  0, PCRE2_NO_JIT, match_data, match_context);
 	if (rc > 0)
 	{
 		PCRE2_SIZE *ovector = pcre2_get_ovector_pointer(match_data);
@@ -0,0 +1,231 @@
+/*
+*   Copyright (c) 2026, Universal Ctags Team
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License version 2 or (at your option) any later version.
+*
+*   This module implements a prefilter for single line regex patterns.
+*
+*   A literal string that any match of a pattern must contain is
+*   extracted when the pattern is added. All the literals of a parser
+*   are put into an Aho-Corasick automaton. Each input line is scanned
+*   once with the automaton, and only the patterns whose literals are
+*   found in the line are given to the regex backend.
+*
+*   The automaton matches ASCII letters case-insensitively, so the
+*   literals of patterns with {icase} flag need no special care. The
+*   prefilter may let a pattern run needlessly, but never skips a
+*   pattern that could match.
+*/
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"  /* must always come first */
+
+#include <string.h>
+
+#include "debug.h"
+#include "lregex_p.h"
+#include "routines.h"
+
+/*
+*   DATA DECLARATIONS
+*/
+#define AC_ROOT 0
+#define AC_NONE -1
+
+typedef struct sAcState {
+	int child;				/* the first child */
+	int sibling;			/* the next child of the parent */
+	unsigned char c;		/* the byte on the edge from the parent */
+	int fail;
+	int dict;				/* the nearest state on the fail chain having ids */
+	int id;					/* the first output id; AC_NONE if no output */
+} acState;
+
+typedef struct sAcOutput {
+	unsigned int id;
+	int next;				/* the next output of the same state */
+} acOutput;
+
+struct regexPrefilter {
+	acState *states;
+	unsigned int stateCount;
+	unsigned int stateSize;
+
+	acOutput *outputs;
+	unsigned int outputCount;
+	unsigned int outputSize;
+
+	/* The transitions from the root are looked up most often. */
+	int rootNext [256];
+
+	bool built;
+};
+
+/*
+*   FUNCTION DEFINITIONS
+*/
+
+static unsigned char foldByte (unsigned char c)
+{
+	return (c >= 'A' && c <= 'Z')? (c - 'A' + 'a'): c;
+}
+
+static int newState (struct regexPrefilter *pf, unsigned char c)
+{
+	if (pf->stateCount == pf->stateSize)
+	{
+		pf->stateSize = pf->stateSize? pf->stateSize * 2: 64;
+		pf->states = xRealloc (pf->states, pf->stateSize, acState);
+	}
+
+	acState *s = pf->states + pf->stateCount;
+	s->child = AC_NONE;
+	s->sibling = AC_NONE;
+	s->c = c;
+	s->fail = AC_ROOT;
+	s->dict = AC_ROOT;
+	s->id = AC_NONE;
+	return pf->stateCount++;
+}
+
+extern struct regexPrefilter *regexPrefilterNew (void)
+{
+	struct regexPrefilter *pf = xCalloc (1, struct regexPrefilter);
+
+	newState (pf, 0);
+	for (unsigned int i = 0; i < ARRAY_SIZE (pf->rootNext); i++)
+		pf->rootNext [i] = AC_NONE;
+	return pf;
+}
+
+extern void regexPrefilterDelete (struct regexPrefilter *pf)
+{
+	if (pf->states)
+		eFree (pf->states);
+	if (pf->outputs)
+		eFree (pf->outputs);
+	eFree (pf);
+}
+
+static int findChild (const struct regexPrefilter *pf, int s, unsigned char c)
+{
+	if (s == AC_ROOT)
+		return pf->rootNext [c];
+
+	for (int t = pf->states [s].child; t != AC_NONE; t = pf->states [t].sibling)
+		if (pf->states [t].c == c)
+			return t;
+	return AC_NONE;
+}
+
+extern void regexPrefilterAdd (struct regexPrefilter *pf,
+							   const char *literal, unsigned int id)
+{
+	int s = AC_ROOT;
+
+	Assert (! pf->built);
+	Assert (*literal != '\0');
+
+	for (const unsigned char *p = (const unsigned char *) literal; *p; p++)
+	{
+		unsigned char c = foldByte (*p);
+		int t = findChild (pf, s, c);
+
+		if (t == AC_NONE)
+		{
+			t = newState (pf, c);
+			pf->states [t].sibling = pf->states [s].child;
+			pf->states [s].child = t;
+			if (s == AC_ROOT)
+				pf->rootNext [c] = t;
+		}
+		s = t;
+	}
+
+	if (pf->outputCount == pf->outputSize)
+	{
+		pf->outputSize = pf->outputSize? pf->outputSize * 2: 16;
+		pf->outputs = xRealloc (pf->outputs, pf->outputSize, acOutput);
+	}
+	pf->outputs [pf->outputCount].id = id;
+	pf->outputs [pf->outputCount].next = pf->states [s].id;
+	pf->states [s].id = pf->outputCount++;
+}
+
+/* Compute the fail and dict links in breadth first order. */
+extern void regexPrefilterBuild (struct regexPrefilter *pf)
+{
+	int *queue = xMalloc (pf->stateCount, int);
+	unsigned int head = 0, tail = 0;
+
+	for (int t = pf->states [AC_ROOT].child; t != AC_NONE; t = pf->states [t].sibling)
+		queue [tail++] = t;
+
+	while (head < tail)
+	{
+		int r = queue [head++];
+
+		for (int u = pf->states [r].child; u != AC_NONE; u = pf->states [u].sibling)
+		{
+			unsigned char c = pf->states [u].c;
+			int f = pf->states [r].fail;
+			int g;
+
+			while ((g = findChild (pf, f, c)) == AC_NONE && f != AC_ROOT)
+				f = pf->states [f].fail;
+
+			f = (g == AC_NONE)? AC_ROOT: g;
+			pf->states [u].fail = f;
+			pf->states [u].dict = (pf->states [f].id != AC_NONE)
+				? f: pf->states [f].dict;
+			queue [tail++] = u;
+		}
+	}
+
+	eFree (queue);
+	pf->built = true;
+}
+
+extern unsigned int regexPrefilterScan (struct regexPrefilter *pf,
+										const char *input, size_t len,
+										unsigned int *marks, unsigned int stamp,
+										unsigned int limit)
+{
+	const unsigned char *p = (const unsigned char *) input;
+	const unsigned char *end = p + len;
+	unsigned int found = 0;
+	int s = AC_ROOT;
+
+	Assert (pf->built);
+
+	for (; p < end; p++)
+	{
+		unsigned char c = foldByte (*p);
+		int t;
+
+		while ((t = findChild (pf, s, c)) == AC_NONE && s != AC_ROOT)
+			s = pf->states [s].fail;
+		s = (t == AC_NONE)? AC_ROOT: t;
+
+		for (int o = (pf->states [s].id != AC_NONE)? s: pf->states [s].dict;
+			 o != AC_ROOT;
+			 o = pf->states [o].dict)
+		{
+			for (int i = pf->states [o].id; i != AC_NONE; i = pf->outputs [i].next)
+			{
+				unsigned int id = pf->outputs [i].id;
+
+				if (marks [id] != stamp)
+				{
+					marks [id] = stamp;
+					if (++found == limit)
+						return found;
+				}
+			}
+		}
+	}
+	return found;
+}
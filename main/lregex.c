@@ -25,6 +25,7 @@
 #endif
 
 #include <inttypes.h>
+#include <time.h>
 
 #include "debug.h"
 #include "colprint_p.h"
@@ -33,7 +34,9 @@
 #include "flags_p.h"
 #include "htable.h"
 #include "kind.h"
+#include "numarray.h"
 #include "options.h"
+#include "options_p.h"
 #include "optscript.h"
 #include "parse_p.h"
 #include "promise.h"
@@ -43,7 +46,7 @@
 #include "routines_p.h"
 #include "script_p.h"
 #include "trace.h"
-#include "trashbox.h"
+#include "traceevent_p.h"
 #include "xtag_p.h"
 
 static bool regexAvailable = false;
@@ -166,6 +169,33 @@ typedef struct {
 
 	char *pattern_string;
 
+	/* A string any match contains; used in the prefilter */
+	char *literal;
+
+	/* A bitmap of bytes a match can start with; used for mtable and
+	 * anchored single line patterns */
+	unsigned char *first_bytes;
+
+	/* The source of the pattern not compiled yet */
+	struct {
+		char *regex;
+		int flags;
+		bool onFirstMatch;	/* or when the parser is used first */
+		bool unhinted;		/* literal and first_bytes not made yet */
+	} deferred;
+
+	/* Shown with --totals=extra. The time spent in matching is
+	 * measured only when the option is given. */
+	struct {
+		unsigned long attempts;	/* calls of the backend */
+		unsigned long matches;
+		clock_t compile;
+		clock_t match;
+
+		unsigned long script_runs;
+		struct OptVMCounters script;	/* spent in the optscript code */
+	} profile;
+
 	char *anonymous_tag_prefix;
 
 	struct {
@@ -188,6 +218,7 @@ typedef struct {
 	struct {
 		unsigned int match;
 		unsigned int unmatch;
+		unsigned int skip;	/* unmatch without running the backend */
 	} statistics;
 } regexTableEntry;
 
@@ -196,6 +227,9 @@ typedef struct {
 struct regexTable {
 	char *name;
 	ptrArray *entries;
+	/* {window=N}: the patterns see N bytes from the cursor at most.
+	   0 for the rest of the input. */
+	unsigned long window;
 };
 
 struct boundaryInRequest {
@@ -239,6 +273,35 @@ struct lregexControlBlock {
 	langType owner;
 
 	scriptWindow *window;
+
+	/* Prefilter for the single line patterns */
+	struct regexPrefilter *prefilter;
+	bool prefilter_stale;
+	unsigned int *prefilter_marks;	/* indexed by the entry index */
+	unsigned int prefilter_stamp;
+	unsigned int prefilter_literals;
+
+	/* Some patterns must be compiled before parsing an input */
+	bool uncompiled;
+
+	/* Some patterns have no literal and first_bytes made yet */
+	bool unhinted;
+
+	/* Reused in matchTagPattern () not to allocate strings for
+	 * each match. The tag entry doesn't refer to them after
+	 * makeTagEntry (). */
+	vString *name_buf;
+	ptrArray *field_bufs;
+
+	/* The indexes of the single line patterns which can match a line
+	 * starting with a byte. The last one is for empty lines. Made on
+	 * demand. Not used if no pattern has first_bytes. */
+	uintArray *anchor_buckets [256 + 1];
+	bool anchor_used;
+
+	/* The offset in the input of the mtable parser where the data before
+	 * is released last; see {window=N}. */
+	unsigned int released_offset;
 };
 
 /*
@@ -263,6 +326,7 @@ static void   guestRequestClear (struct guestRequest *);
 static void   guestRequestSubmit (struct guestRequest *);
 
 static EsObject *scriptRead (OptVM *vm, const char *src);
+static EsObject *scriptEvalPattern (OptVM *vm, regexPattern *ptrn);
 static void scriptSetup (OptVM *vm, struct lregexControlBlock *lcb, int corkIndex, scriptWindow *window);
 static EsObject* scriptEval (OptVM *vm, EsObject *optscript);
 static void scriptEvalHook (OptVM *vm, struct lregexControlBlock *lcb, enum scriptHook hook);
@@ -295,7 +359,10 @@ static void deletePattern (regexPattern *p)
 	if (p->refcount > 0)
 		return;
 
-	p->pattern.backend->delete_code (p->pattern.code);
+	if (p->pattern.code)
+		p->pattern.backend->delete_code (p->pattern.code);
+	if (p->deferred.regex)
+		eFree (p->deferred.regex);
 
 	if (p->type == PTRN_TAG)
 	{
@@ -311,6 +378,12 @@ static void deletePattern (regexPattern *p)
 
 	eFree (p->pattern_string);
 
+	if (p->literal)
+		eFree (p->literal);
+
+	if (p->first_bytes)
+		eFree (p->first_bytes);
+
 	if (p->message.message_string)
 		eFree (p->message.message_string);
 
@@ -325,11 +398,25 @@ static void deletePattern (regexPattern *p)
 	eFree (p);
 }
 
+static void clearAnchorBuckets (struct lregexControlBlock *lcb)
+{
+	for (unsigned int i = 0; i < ARRAY_SIZE (lcb->anchor_buckets); i++)
+	{
+		if (lcb->anchor_buckets [i])
+		{
+			uintArrayDelete (lcb->anchor_buckets [i]);
+			lcb->anchor_buckets [i] = NULL;
+		}
+	}
+	lcb->anchor_used = false;
+}
+
 static void clearPatternSet (struct lregexControlBlock *lcb)
 {
 	ptrArrayClear (lcb->entries [REG_PARSER_SINGLE_LINE]);
 	ptrArrayClear (lcb->entries [REG_PARSER_MULTI_LINE]);
 	ptrArrayClear (lcb->tables);
+	lcb->prefilter_stale = true;
 }
 
 extern struct lregexControlBlock* allocLregexControlBlock (parserDefinition *parser)
@@ -352,6 +439,9 @@ extern struct lregexControlBlock* allocLregexControlBlock (parserDefinition *par
 	}
 	lcb->owner = parser->id;
 
+	lcb->name_buf = vStringNew ();
+	lcb->field_bufs = ptrArrayNew ((ptrArrayDeleteFunc)vStringDelete);
+
 	return lcb;
 }
 
@@ -367,6 +457,23 @@ extern void freeLregexControlBlock (struct lregexControlBlock* lcb)
 	ptrArrayDelete (lcb->tables);
 	lcb->tables = NULL;
 
+	vStringDelete (lcb->name_buf);
+	lcb->name_buf = NULL;
+	ptrArrayDelete (lcb->field_bufs);
+	lcb->field_bufs = NULL;
+
+	if (lcb->prefilter)
+	{
+		regexPrefilterDelete (lcb->prefilter);
+		lcb->prefilter = NULL;
+	}
+	if (lcb->prefilter_marks)
+	{
+		eFree (lcb->prefilter_marks);
+		lcb->prefilter_marks = NULL;
+	}
+	clearAnchorBuckets (lcb);
+
 	ptrArrayDelete (lcb->tstack);
 	lcb->tstack = NULL;
 
@@ -708,7 +815,11 @@ static regexPattern* addCompiledTagCommon (struct lregexControlBlock *lcb,
 		ptrArrayAdd (table->entries, entry);
 	}
 	else
+	{
 		ptrArrayAdd (lcb->entries[regptype], entry);
+		if (regptype == REG_PARSER_SINGLE_LINE)
+			lcb->prefilter_stale = true;
+	}
 
 	useRegexMethod(lcb->owner);
 
@@ -1440,9 +1551,76 @@ static struct flagDefsDescriptor choose_backend (const char *flags, enum regexPa
 	return desc;
 }
 
-static regexCompiledCode compileRegex (enum regexParserType regptype,
-									   const char* const regexp, const char* const flags)
+typedef struct {
+	char *regex;
+	int flags;
+} regexCompileInfo;
+
+/* A pattern is compiled when the parser is used first, so the
+ * definitions of parsers not used in a run cost little.
+ *
+ * The patterns of the built-in parsers are assumed to be valid. They
+ * are compiled when they are tried first. Most patterns of a parser
+ * are not tried at all for a short input with the help of the
+ * prefilter and the first byte sets. */
+static bool compilationDeferred = false;
+
+extern void deferRegexCompilation (bool defer)
+{
+	compilationDeferred = defer;
+}
+
+static void storeCompileInfo (struct lregexControlBlock *lcb,
+							  regexPattern *ptrn, regexCompileInfo *info)
 {
+	ptrn->deferred.regex = info->regex;
+	ptrn->deferred.flags = info->flags;
+	ptrn->deferred.onFirstMatch = compilationDeferred;
+	ptrn->deferred.unhinted = true;
+	if (!compilationDeferred)
+		lcb->uncompiled = true;
+	lcb->unhinted = true;
+}
+
+/* Compute the hints for the prefilter and the first byte test from
+ * the source of the pattern. Like the compilation, this is done when
+ * the parser is used first: a large optlib configuration defines many
+ * patterns never tried in a run. */
+static void prepareRegexHints (regexPattern *ptrn)
+{
+	struct regexBackend *backend = ptrn->pattern.backend;
+	const char *regexp = ptrn->deferred.regex;
+	int flags = ptrn->deferred.flags;
+
+	ptrn->deferred.unhinted = false;
+
+	if (ptrn->regptype == REG_PARSER_SINGLE_LINE
+		&& backend->required_literal)
+		ptrn->literal = backend->required_literal (backend, regexp, flags);
+
+	if ((ptrn->regptype == REG_PARSER_MULTI_TABLE
+		 || ptrn->regptype == REG_PARSER_SINGLE_LINE)
+		&& backend->first_bytes)
+	{
+		ptrn->first_bytes = xMalloc (256 / 8, unsigned char);
+		if (! backend->first_bytes (backend, regexp, flags, ptrn->first_bytes))
+		{
+			eFree (ptrn->first_bytes);
+			ptrn->first_bytes = NULL;
+		}
+	}
+}
+
+/* Choose the backend. The hints and the code are made later with
+ * prepareRegexHints () and compileDeferredPattern (). */
+static regexCompiledCode prepareRegex (enum regexParserType regptype,
+									   const char* const regexp, const char* const flags,
+									   regexCompileInfo *info)
+{
+	regexCompiledCode cp;
+
+	memset (info, 0, sizeof (*info));
+
 	struct flagDefsDescriptor desc = choose_backend (flags, regptype, false);
 
 	/* Evaluate backend specific flags */
@@ -1456,7 +1634,12 @@ static regexCompiledCode compileRegex (enum regexParserType regptype,
 			   ARRAY_SIZE (backendCommonRegexFlagDefs),
 			   &desc);
 
-	return desc.backend->compile (desc.backend, regexp, desc.flags);
+	cp.backend = desc.backend;
+	cp.code = NULL;
+	info->regex = eStrdup (regexp);
+	info->flags = desc.flags;
+
+	return cp;
 }
 
 
@@ -1528,12 +1711,13 @@ static bool parseKinds (
 */
 
 
-static vString* substitute (
+static void substituteInto (vString *result,
 		const char* const in, const char* out,
 		const int nmatch, const regmatch_t* const pmatch)
 {
-	vString* result = vStringNew ();
 	const char* p;
+
+	vStringClear (result);
 	for (p = out  ;  *p != '\0'  ;  p++)
 	{
 		if (*p == '\\'  &&  isdigit ((int) *++p))
@@ -1548,9 +1732,25 @@ static vString* substitute (
 		else if (*p != '\n'  &&  *p != '\r')
 			vStringPut (result, *p);
 	}
+}
+
+static vString* substitute (
+		const char* const in, const char* out,
+		const int nmatch, const regmatch_t* const pmatch)
+{
+	vString* result = vStringNew ();
+
+	substituteInto (result, in, out, nmatch, pmatch);
 	return result;
 }
 
+static vString *getFieldBuffer (struct lregexControlBlock *lcb, unsigned int i)
+{
+	while (ptrArrayCount (lcb->field_bufs) <= i)
+		ptrArrayAdd (lcb->field_bufs, vStringNew ());
+	return ptrArrayItem (lcb->field_bufs, i);
+}
+
 static unsigned long getInputLineNumberInRegPType (enum regexParserType regptype,
 												   off_t offset)
 {
@@ -1590,21 +1790,26 @@ static int scopeActionRef (int currentScope)
 
 static void matchTagPattern (struct lregexControlBlock *lcb,
 		const char* line,
-		const regexPattern* const patbuf,
+		regexPattern* const patbuf,
 		const regmatch_t* const pmatch,
 			     off_t offset, scriptWindow *window)
 {
-	vString *const name =
-		(patbuf->u.tag.name_pattern[0] != '\0') ? substitute (line,
-															  patbuf->u.tag.name_pattern,
-															  BACK_REFERENCE_COUNT, pmatch):
-		(patbuf->anonymous_tag_prefix) ? anonGenerateNew (patbuf->anonymous_tag_prefix,
-														  patbuf->u.tag.kindIndex):
-		vStringNewInit ("");
+	vString *const name = lcb->name_buf;
 	bool placeholder = !!((patbuf->scopeActions & SCOPE_PLACEHOLDER) == SCOPE_PLACEHOLDER);
 	int scope = CORK_NIL;
 	int n;
 
+	if (patbuf->u.tag.name_pattern[0] != '\0')
+		substituteInto (name, line, patbuf->u.tag.name_pattern,
+						BACK_REFERENCE_COUNT, pmatch);
+	else
+	{
+		vStringClear (name);
+		if (patbuf->anonymous_tag_prefix)
+			anonGenerate (name, patbuf->anonymous_tag_prefix,
+						  patbuf->u.tag.kindIndex);
+	}
+
 	vStringStripLeading (name);
 	vStringStripTrailing (name);
 
@@ -1661,7 +1866,6 @@ static void matchTagPattern (struct lregexControlBlock *lcb,
 	}
 	else
 	{
-		static TrashBox* field_trashbox;
 		unsigned long ln = 0;
 		MIOPos pos;
 		tagEntryInfo e;
@@ -1682,12 +1886,6 @@ static void matchTagPattern (struct lregexControlBlock *lcb,
 		initRegexTag (&e, vStringValue (name), kind, ROLE_DEFINITION_INDEX, scope, placeholder,
 					  ln, ln == 0? NULL: &pos, patbuf->xtagType);
 
-		if (field_trashbox == NULL)
-		{
-			field_trashbox = trashBoxNew();
-			DEFAULT_TRASH_BOX (field_trashbox, trashBoxDelete);
-		}
-
 		if (patbuf->fieldPatterns)
 		{
 			for (unsigned int i = 0; i < ptrArrayCount(patbuf->fieldPatterns); i++)
@@ -1695,11 +1893,11 @@ static void matchTagPattern (struct lregexControlBlock *lcb,
 				struct fieldPattern *fp = ptrArrayItem(patbuf->fieldPatterns, i);
 				if (isFieldEnabled (fp->ftype))
 				{
-					vString * const value = substitute (line, fp->template,
-														BACK_REFERENCE_COUNT, pmatch);
+					vString * const value = getFieldBuffer (lcb, i);
+
+					substituteInto (value, line, fp->template,
+									BACK_REFERENCE_COUNT, pmatch);
 					attachParserField (&e, false, fp->ftype, vStringValue (value));
-					trashBoxPut (field_trashbox, value,
-								 (TrashBoxDestroyItemProc)vStringDelete);
 				}
 			}
 		}
@@ -1721,8 +1919,6 @@ static void matchTagPattern (struct lregexControlBlock *lcb,
 			markTagExtraBit (&e, XTAG_ANONYMOUS);
 
 		n = makeTagEntry (&e);
-
-		trashBoxMakeEmpty(field_trashbox);
 	}
 
 	if (patbuf->scopeActions & SCOPE_PUSH)
@@ -1731,7 +1927,7 @@ static void matchTagPattern (struct lregexControlBlock *lcb,
 	if (n != CORK_NIL && window)
 	{
 		scriptSetup (optvm, lcb, n, window);
-		EsObject *e = scriptEval (optvm, patbuf->optscript);
+		EsObject *e = scriptEvalPattern (optvm, patbuf);
 		if (es_error_p (e))
 			error (WARNING, "error when evaluating: %s %% input: %s, line:%lu", patbuf->optscript_src,
 				   getInputFileName (),
@@ -1739,8 +1935,6 @@ static void matchTagPattern (struct lregexControlBlock *lcb,
 		es_object_unref (e);
 		scriptTeardown (optvm, lcb);
 	}
-
-	vStringDelete (name);
 }
 
 static bool matchCallbackPattern (
@@ -1852,6 +2046,115 @@ static bool fillGuestRequest (const char *start,
 	return guestRequestIsFilled (guest_req);
 }
 
+/* A broken pattern is reported once, and never matches. */
+static bool compileDeferredPattern (regexPattern *patbuf)
+{
+	if (patbuf->deferred.unhinted)
+		prepareRegexHints (patbuf);
+
+	clock_t start = clock ();
+	regexCompiledCode cp = patbuf->pattern.backend->compile (patbuf->pattern.backend,
+															 patbuf->deferred.regex,
+															 patbuf->deferred.flags);
+	patbuf->profile.compile = clock () - start;
+	patbuf->pattern.code = cp.code;
+
+	if (cp.code == NULL)
+		error (WARNING, "pattern: %s", patbuf->deferred.regex);
+
+	eFree (patbuf->deferred.regex);
+	patbuf->deferred.regex = NULL;
+	return (cp.code != NULL);
+}
+
+static void compileDeferredPatternsInEntries (struct lregexControlBlock *lcb,
+											  ptrArray *entries,
+											  const char *table_name)
+{
+	for (unsigned int i = 0; i < ptrArrayCount (entries); i++)
+	{
+		regexTableEntry *entry = ptrArrayItem (entries, i);
+		regexPattern *ptrn = entry->pattern;
+
+		if (ptrn->deferred.regex == NULL || ptrn->deferred.onFirstMatch)
+			continue;
+
+		if (compileDeferredPattern (ptrn))
+			continue;
+
+		if (table_name)
+		{
+			error (WARNING, "table: %s[%u]", table_name, i);
+			error (WARNING, "language: %s", getLanguageName (lcb->owner));
+		}
+		else
+			error (WARNING, "language: %s[%u]", getLanguageName (lcb->owner), i);
+	}
+}
+
+static void prepareRegexHintsInEntries (ptrArray *entries)
+{
+	for (unsigned int i = 0; i < ptrArrayCount (entries); i++)
+	{
+		regexTableEntry *entry = ptrArrayItem (entries, i);
+		regexPattern *ptrn = entry->pattern;
+
+		if (ptrn->deferred.unhinted)
+			prepareRegexHints (ptrn);
+	}
+}
+
+static void prepareDeferredHints (struct lregexControlBlock *lcb)
+{
+	lcb->unhinted = false;
+
+	prepareRegexHintsInEntries (lcb->entries [REG_PARSER_SINGLE_LINE]);
+	prepareRegexHintsInEntries (lcb->entries [REG_PARSER_MULTI_LINE]);
+	for (unsigned int i = 0; i < ptrArrayCount (lcb->tables); i++)
+	{
+		struct regexTable *table = ptrArrayItem (lcb->tables, i);
+		prepareRegexHintsInEntries (table->entries);
+	}
+	lcb->prefilter_stale = true;
+}
+
+/* Compile the patterns given with options. Done here, not when
+ * matching, to report broken patterns when the parser is used first. */
+static void compileDeferredPatterns (struct lregexControlBlock *lcb)
+{
+	lcb->uncompiled = false;
+
+	compileDeferredPatternsInEntries (lcb, lcb->entries [REG_PARSER_SINGLE_LINE], NULL);
+	compileDeferredPatternsInEntries (lcb, lcb->entries [REG_PARSER_MULTI_LINE], NULL);
+	for (unsigned int i = 0; i < ptrArrayCount (lcb->tables); i++)
+	{
+		struct regexTable *table = ptrArrayItem (lcb->tables, i);
+		compileDeferredPatternsInEntries (lcb, table->entries, table->name);
+	}
+}
+
+static int runBackendMatch (regexPattern *patbuf,
+							const char *input, size_t size,
+							regmatch_t pmatch [BACK_REFERENCE_COUNT])
+{
+	if (patbuf->deferred.regex)
+		compileDeferredPattern (patbuf);
+	if (patbuf->pattern.code == NULL)
+		return REG_NOMATCH;
+
+	clock_t start = (Option.printTotals > 1)? clock (): 0;
+	int match = patbuf->pattern.backend->match (patbuf->pattern.backend,
+												patbuf->pattern.code,
+												input, size, pmatch);
+
+	if (Option.printTotals > 1)
+		patbuf->profile.match += clock () - start;
+	patbuf->profile.attempts++;
+	if (match == 0)
+		patbuf->profile.matches++;
+	return match;
+}
+
 static bool matchRegexPattern (struct lregexControlBlock *lcb,
 							   const vString* const line,
 							   regexTableEntry *entry)
@@ -1865,10 +2168,8 @@ static bool matchRegexPattern (struct lregexControlBlock *lcb,
 	if (patbuf->disabled && *(patbuf->disabled))
 		return false;
 
-	match = patbuf->pattern.backend->match (patbuf->pattern.backend,
-											patbuf->pattern.code, vStringValue (line),
-											vStringLength (line),
-											pmatch);
+	match = runBackendMatch (patbuf, vStringValue (line), vStringLength (line),
+							 pmatch);
 
 	if (match == 0)
 	{
@@ -1886,7 +2187,7 @@ static bool matchRegexPattern (struct lregexControlBlock *lcb,
 		if (patbuf->optscript && (! hasNameSlot (patbuf)))
 		{
 			scriptSetup (optvm, lcb, CORK_NIL, &window);
-			EsObject *e = scriptEval (optvm, patbuf->optscript);
+			EsObject *e = scriptEvalPattern (optvm, patbuf);
 			if (es_error_p (e))
 				error (WARNING, "error when evaluating: %s %% input: %s", patbuf->optscript_src,
 					   getInputFileName ());
@@ -1930,7 +2231,7 @@ static bool matchRegexPattern (struct lregexControlBlock *lcb,
 }
 
 static bool matchMultilineRegexPattern (struct lregexControlBlock *lcb,
-										const vString* const allLines,
+										const char *const input, size_t size,
 										regexTableEntry *entry)
 {
 	const char *start;
@@ -1949,13 +2250,11 @@ static bool matchMultilineRegexPattern (struct lregexControlBlock *lcb,
 	if (patbuf->disabled && *(patbuf->disabled))
 		return false;
 
-	current = start = vStringValue (allLines);
+	current = start = input;
 	do
 	{
-		match = patbuf->pattern.backend->match (patbuf->pattern.backend,
-												patbuf->pattern.code, current,
-												vStringLength (allLines) - (current - start),
-												pmatch);
+		match = runBackendMatch (patbuf, current, size - (current - start),
+								 pmatch);
 
 		if (match != 0)
 		{
@@ -1979,7 +2278,7 @@ static bool matchMultilineRegexPattern (struct lregexControlBlock *lcb,
 		if (patbuf->optscript && (! hasNameSlot (patbuf)))
 		{
 			scriptSetup (optvm, lcb, CORK_NIL, &window);
-			EsObject *e = scriptEval (optvm, patbuf->optscript);
+			EsObject *e = scriptEvalPattern (optvm, patbuf);
 			if (es_error_p (e))
 				error (WARNING, "error when evaluating: %s %% input: %s", patbuf->optscript_src,
 					   getInputFileName ());
@@ -2028,22 +2327,122 @@ static bool matchMultilineRegexPattern (struct lregexControlBlock *lcb,
 		}
 		current += delta;
 
-	} while (current < start + vStringLength (allLines));
+	} while (current < start + size);
 
 	return result;
 }
 
 /* PUBLIC INTERFACE */
 
+static void prepareRegexPrefilter (struct lregexControlBlock *lcb)
+{
+	ptrArray *entries = lcb->entries[REG_PARSER_SINGLE_LINE];
+	unsigned int count = ptrArrayCount (entries);
+
+	if (lcb->prefilter)
+	{
+		regexPrefilterDelete (lcb->prefilter);
+		lcb->prefilter = NULL;
+	}
+	if (lcb->prefilter_marks)
+	{
+		eFree (lcb->prefilter_marks);
+		lcb->prefilter_marks = NULL;
+	}
+	lcb->prefilter_literals = 0;
+	lcb->prefilter_stale = false;
+
+	clearAnchorBuckets (lcb);
+
+	for (unsigned int i = 0; i < count; i++)
+	{
+		regexTableEntry *entry = ptrArrayItem (entries, i);
+
+		if (entry->pattern->first_bytes)
+			lcb->anchor_used = true;
+
+		if (entry->pattern->literal == NULL)
+			continue;
+
+		if (lcb->prefilter == NULL)
+			lcb->prefilter = regexPrefilterNew ();
+		regexPrefilterAdd (lcb->prefilter, entry->pattern->literal, i);
+		lcb->prefilter_literals++;
+	}
+
+	if (lcb->prefilter)
+	{
+		regexPrefilterBuild (lcb->prefilter);
+		lcb->prefilter_marks = xCalloc (count, unsigned int);
+		lcb->prefilter_stamp = 0;
+	}
+}
+
+/* C is the first byte of a line, or -1 for an empty line. */
+static uintArray *getAnchorBucket (struct lregexControlBlock *lcb, int c)
+{
+	unsigned int b = (c == -1)? 256: (unsigned int) c;
+
+	if (lcb->anchor_buckets [b])
+		return lcb->anchor_buckets [b];
+
+	ptrArray *entries = lcb->entries[REG_PARSER_SINGLE_LINE];
+	uintArray *bucket = uintArrayNew ();
+	for (unsigned int i = 0; i < ptrArrayCount (entries); i++)
+	{
+		regexTableEntry *entry = ptrArrayItem (entries, i);
+		unsigned char *first_bytes = entry->pattern->first_bytes;
+
+		/* first_bytes is not given to a pattern matching the empty
+		 * string. */
+		if (first_bytes == NULL
+			|| (c != -1 && (first_bytes [c / 8] & (1 << (c % 8)))))
+			uintArrayAdd (bucket, i);
+	}
+	lcb->anchor_buckets [b] = bucket;
+	return bucket;
+}
+
 /* Match against all patterns for specified language. Returns true if at least
  * on pattern matched.
  */
+static void scanRegexPrefilter (struct lregexControlBlock *lcb, const vString* const line)
+{
+	if (++lcb->prefilter_stamp == 0)
+	{
+		/* Wrapped around */
+		memset (lcb->prefilter_marks, 0,
+				sizeof (*lcb->prefilter_marks)
+				* ptrArrayCount (lcb->entries[REG_PARSER_SINGLE_LINE]));
+		lcb->prefilter_stamp = 1;
+	}
+	regexPrefilterScan (lcb->prefilter, vStringValue (line), vStringLength (line),
+						lcb->prefilter_marks, lcb->prefilter_stamp,
+						lcb->prefilter_literals);
+}
+
 extern bool matchRegex (struct lregexControlBlock *lcb, const vString* const line)
 {
 	bool result = false;
-	unsigned int i;
-	for (i = 0  ;  i < ptrArrayCount(lcb->entries[REG_PARSER_SINGLE_LINE])  ;  ++i)
+	bool scanned = false;
+	uintArray *bucket = NULL;
+
+	if (lcb->unhinted)
+		prepareDeferredHints (lcb);
+	if (lcb->prefilter_stale)
+		prepareRegexPrefilter (lcb);
+
+	/* Patterns anchored to the start of the line are tried only when
+	 * they can start with the first byte of the line. */
+	if (lcb->anchor_used)
+		bucket = getAnchorBucket (lcb, vStringLength (line) > 0
+								  ? (unsigned char) vStringChar (line, 0): -1);
+
+	unsigned int count = bucket? uintArrayCount (bucket)
+		: ptrArrayCount (lcb->entries[REG_PARSER_SINGLE_LINE]);
+	for (unsigned int j = 0  ;  j < count  ;  ++j)
 	{
+		unsigned int i = bucket? uintArrayItem (bucket, j): j;
 		regexTableEntry *entry = ptrArrayItem(lcb->entries[REG_PARSER_SINGLE_LINE], i);
 		regexPattern *ptrn = entry->pattern;
 
@@ -2053,6 +2452,25 @@ extern bool matchRegex (struct lregexControlBlock *lcb, const vString* const lin
 			&& (!isXtagEnabled (ptrn->xtagType)))
 				continue;
 
+		if (ptrn->literal && ! (ptrn->disabled && *(ptrn->disabled)))
+		{
+			/* The line is scanned for the literals when a pattern
+			 * enabled needs it; a subparser not activated yet has all
+			 * its patterns disabled. */
+			if (! scanned)
+			{
+				scanRegexPrefilter (lcb, line);
+				scanned = true;
+			}
+			if (lcb->prefilter_marks [i] != lcb->prefilter_stamp)
+			{
+				/* The line doesn't contain the literal; the pattern can't match. */
+				entry->statistics.unmatch++;
+				entry->statistics.skip++;
+				continue;
+			}
+		}
+
 		if (matchRegexPattern (lcb, line, entry))
 		{
 			result = true;
@@ -2065,6 +2483,11 @@ extern bool matchRegex (struct lregexControlBlock *lcb, const vString* const lin
 
 extern void notifyRegexInputStart (struct lregexControlBlock *lcb)
 {
+	if (lcb->unhinted)
+		prepareDeferredHints (lcb);
+	if (lcb->uncompiled)
+		compileDeferredPatterns (lcb);
+
 	lcb->currentScope = CORK_NIL;
 
 	ptrArrayClear (lcb->tstack);
@@ -2179,21 +2602,8 @@ static regexPattern *addTagRegexInternal (struct lregexControlBlock *lcb,
 	if (!regexAvailable)
 		return NULL;
 
-	regexCompiledCode cp = compileRegex (regptype, regex, flags);
-	if (cp.code == NULL)
-	{
-		error (WARNING, "pattern: %s", regex);
-		if (table_index != TABLE_INDEX_UNUSED)
-		{
-			struct regexTable *table = ptrArrayItem (lcb->tables, table_index);
-			error (WARNING, "table: %s[%u]", table->name, ptrArrayCount (table->entries));
-			error (WARNING, "language: %s", getLanguageName (lcb->owner));
-		}
-		else
-			error (WARNING, "language: %s[%u]", getLanguageName (lcb->owner),
-				   ptrArrayCount (lcb->entries[regptype]));
-		return NULL;
-	}
+	regexCompileInfo info;
+	regexCompiledCode cp = prepareRegex (regptype, regex, flags, &info);
 
 	char kindLetter;
 	char* kindName;
@@ -2263,6 +2673,7 @@ static regexPattern *addTagRegexInternal (struct lregexControlBlock *lcb,
 												explictly_defined,
 												disabled);
 	rptr->pattern_string = escapeRegexPattern(regex);
+	storeCompileInfo (lcb, rptr, &info);
 
 	eFree (kindName);
 	if (description)
@@ -2339,17 +2750,13 @@ extern void addCallbackRegex (struct lregexControlBlock *lcb,
 		return;
 
 
-	regexCompiledCode cp = compileRegex (REG_PARSER_SINGLE_LINE, regex, flags);
-	if (cp.code == NULL)
-	{
-		error (WARNING, "pattern: %s", regex);
-		error (WARNING, "language: %s", getLanguageName (lcb->owner));
-		return;
-	}
+	regexCompileInfo info;
+	regexCompiledCode cp = prepareRegex (REG_PARSER_SINGLE_LINE, regex, flags, &info);
 
 	regexPattern *rptr = addCompiledCallbackPattern (lcb, &cp, callback, flags,
 													 disabled, userData);
 	rptr->pattern_string = escapeRegexPattern(regex);
+	storeCompileInfo (lcb, rptr, &info);
 }
 
 static void addTagRegexOption (struct lregexControlBlock *lcb,
@@ -2537,6 +2944,11 @@ extern void freeRegexResources (void)
 	opt_vm_delete (optvm);
 }
 
+extern bool regexHasLinePatterns (struct lregexControlBlock *lcb)
+{
+	return (ptrArrayCount(lcb->entries [REG_PARSER_SINGLE_LINE]) > 0);
+}
+
 extern bool regexNeedsMultilineBuffer (struct lregexControlBlock *lcb)
 {
 	if  (ptrArrayCount(lcb->entries [REG_PARSER_MULTI_LINE]) > 0)
@@ -2547,7 +2959,27 @@ extern bool regexNeedsMultilineBuffer (struct lregexControlBlock *lcb)
 		return false;
 }
 
-extern bool matchMultilineRegex (struct lregexControlBlock *lcb, const vString* const allLines)
+extern bool regexHasWindowedTables (struct lregexControlBlock *lcb)
+{
+	return (ptrArrayCount (lcb->tables) > 0
+			&& !regexNeedsWholeInput (lcb));
+}
+
+extern bool regexNeedsWholeInput (struct lregexControlBlock *lcb)
+{
+	if (ptrArrayCount(lcb->entries [REG_PARSER_MULTI_LINE]) > 0)
+		return true;
+
+	for (unsigned int i = 0; i < ptrArrayCount (lcb->tables); i++)
+	{
+		struct regexTable *table = ptrArrayItem (lcb->tables, i);
+		if (table->window == 0)
+			return true;
+	}
+	return false;
+}
+
+extern bool matchMultilineRegex (struct lregexControlBlock *lcb, const char *input, size_t size)
 {
 	bool result = false;
 
@@ -2562,7 +2994,7 @@ extern bool matchMultilineRegex (struct lregexControlBlock *lcb, const vString*
 			&& (!isXtagEnabled (entry->pattern->xtagType)))
 			continue;
 
-		result = matchMultilineRegexPattern (lcb, allLines, entry) || result;
+		result = matchMultilineRegexPattern (lcb, input, size, entry) || result;
 	}
 	return result;
 }
@@ -2581,22 +3013,50 @@ static int getTableIndexForName (const struct lregexControlBlock *const lcb, con
 	return TABLE_INDEX_UNUSED;
 }
 
-extern void addRegexTable (struct lregexControlBlock *lcb, const char *name)
+static void table_flag_window_long (const char* const s, const char* const v, void* data)
 {
+	struct regexTable *table = data;
+
+	if (!v)
+	{
+		error (WARNING, "no value is given for: %s", s);
+		return;
+	}
+	if (!strToULong (v, 10, &table->window) || table->window == 0)
+	{
+		error (WARNING, "wrong %s specification: %s", s, v);
+		table->window = 0;
+	}
+}
+
+static flagDefinition tableFlagDef[] = {
+	{ '\0',  "window", NULL, table_flag_window_long,
+	  "N", "the longest input in bytes the patterns of the table match"},
+};
+
+extern void addRegexTable (struct lregexControlBlock *lcb, const char *spec)
+{
+	const char *flags = strchr (spec, LONG_FLAGS_OPEN);
+	size_t len = flags? (size_t) (flags - spec): strlen (spec);
 	const char *c;
-	for (c = name; *c; c++)
+
+	for (c = spec; c < spec + len; c++)
 		if (! (isalnum(*c) || *c == '_'))
-			error (FATAL, "`%c' in \"%s\" is not acceptable as part of table name", *c, name);
+			error (FATAL, "`%c' in \"%s\" is not acceptable as part of table name", *c, spec);
 
+	char *name = eStrndup (spec, len);
 	if (getTableIndexForName(lcb, name) >= 0)
 	{
 		error (WARNING, "regex table \"%s\" is already defined", name);
+		eFree (name);
 		return;
 	}
 
 	struct regexTable *table = xCalloc(1, struct regexTable);
-	table->name = eStrdup (name);
+	table->name = name;
 	table->entries = ptrArrayNew(deleteTableEntry);
+	if (flags)
+		flagsEval (flags, tableFlagDef, ARRAY_SIZE (tableFlagDef), table);
 
 	ptrArrayAdd (lcb->tables, table);
 }
@@ -2634,14 +3094,14 @@ static void dumpTstack(FILE* fp, ptrArray *tstack)
 	fprintf(fp, "\n");
 }
 
-static void printInputLine(FILE* vfp, const char *c, const off_t offset)
+static void printInputLine(FILE* vfp, const char *c, const char *end, const off_t offset)
 {
 	vString *v = vStringNew ();
 
-	for (; *c && (*c != '\n'); c++)
+	for (; c < end && *c && (*c != '\n'); c++)
 		vStringPut(v, *c);
 
-	if (vStringLength (v) == 0 && *c == '\n')
+	if (vStringLength (v) == 0 && c < end && *c == '\n')
 		vStringCatS (v, "\\n");
 
 	fprintf (vfp, "\ninput : \"%s\" L%lu\n",
@@ -2679,29 +3139,43 @@ static void printMultitableMessage(const langType language,
 }
 
 static struct regexTable * matchMultitableRegexTable (struct lregexControlBlock *lcb,
-													  struct regexTable *table, const vString *const start, unsigned int *offset)
+													  struct regexTable *table,
+													  const char *const cstart, size_t size,
+													  unsigned int *offset)
 {
 	struct regexTable *next = NULL;
 	const char *current;
 	regmatch_t pmatch [BACK_REFERENCE_COUNT];
-	const char *cstart = vStringValue(start);
 	unsigned int delta;
 
 
  restart:
 	current = cstart + *offset;
 
-	/* Accept the case *offset == vStringLength(start)
+	/* Accept the case *offset == size
 	   because we want an empty regex // still matches empty input. */
-	if (*offset > vStringLength(start))
+	if (*offset > size)
 	{
-		*offset = vStringLength(start);
+		*offset = size;
 		goto out;
 	}
 
+	/* The patterns of a table with a window look at the input from the
+	   cursor, so the input behind it can leave the memory; it is read
+	   again from the file if a tag needs it. */
+	if (table->window > 0
+		&& *offset - lcb->released_offset >= INPUT_RELEASE_STEP)
+	{
+		releaseInputFileData (current);
+		lcb->released_offset = *offset;
+	}
+
+	/* The input may not be terminated with NUL. */
+	int c = (*offset < size)? (unsigned char) *current: -1;
+
 	BEGIN_VERBOSE(vfp);
 	{
-		printInputLine(vfp, current, *offset);
+		printInputLine(vfp, current, cstart + size, *offset);
 	}
 	END_VERBOSE();
 
@@ -2720,19 +3194,19 @@ static struct regexTable * matchMultitableRegexTable (struct lregexControlBlock
 		BEGIN_VERBOSE(vfp);
 		{
 			char s[3];
-			if (*current == '\n')
+			if (c == '\n')
 			{
 				s [0] = '\\';
 				s [1] = 'n';
 				s [2] = '\0';
 			}
-			else if (*current == '\t')
+			else if (c == '\t')
 			{
 				s [0] = '\\';
 				s [1] = 't';
 				s [2] = '\0';
 			}
-			else if (*current == '\\')
+			else if (c == '\\')
 			{
 				s [0] = '\\';
 				s [1] = '\\';
@@ -2740,7 +3214,7 @@ static struct regexTable * matchMultitableRegexTable (struct lregexControlBlock
 			}
 			else
 			{
-				s[0] = *current;
+				s[0] = (c == -1)? '\0': c;
 				s[1] = '\0';
 			}
 
@@ -2759,10 +3233,22 @@ static struct regexTable * matchMultitableRegexTable (struct lregexControlBlock
 		if (ptrn->disabled && *(ptrn->disabled))
 			continue;
 
-		match = ptrn->pattern.backend->match (ptrn->pattern.backend,
-											  ptrn->pattern.code, current,
-											  vStringLength(start) - (current - cstart),
-											  pmatch);
+		if (ptrn->first_bytes
+			&& (c == -1
+				|| (c != '\0'
+					&& !(ptrn->first_bytes [c / 8] & (1 << (c % 8))))))
+		{
+			/* No match can start with the byte at the cursor. The set
+			 * doesn't tell about NUL in the middle of the input. */
+			entry->statistics.unmatch++;
+			entry->statistics.skip++;
+			continue;
+		}
+
+		size_t rest = size - (current - cstart);
+		if (table->window > 0 && rest > table->window)
+			rest = table->window;
+		match = runBackendMatch (ptrn, current, rest, pmatch);
 		if (match == 0)
 		{
 			entry->statistics.match++;
@@ -2779,7 +3265,7 @@ static struct regexTable * matchMultitableRegexTable (struct lregexControlBlock
 			if (ptrn->optscript && (! hasNameSlot (ptrn)))
 			{
 				scriptSetup (optvm, lcb, CORK_NIL, &window);
-				EsObject *e = scriptEval (optvm, ptrn->optscript);
+				EsObject *e = scriptEvalPattern (optvm, ptrn);
 				if (es_error_p (e))
 					error (WARNING, "error when evaluating: %s", ptrn->optscript_src);
 				es_object_unref (e);
@@ -2965,6 +3451,148 @@ extern void extendRegexTable (struct lregexControlBlock *lcb, const char *src, c
 	}
 }
 
+static void collectPatternsForProfile (ptrArray *entries, ptrArray *patterns,
+									   hashTable *seen)
+{
+	for (unsigned int i = 0; i < ptrArrayCount (entries); i++)
+	{
+		regexTableEntry *entry = ptrArrayItem (entries, i);
+		regexPattern *ptrn = entry->pattern;
+
+		if (ptrn->profile.attempts == 0 || hashTableHasItem (seen, ptrn))
+			continue;
+		hashTablePutItem (seen, ptrn, ptrn);
+		ptrArrayAdd (patterns, ptrn);
+	}
+}
+
+static int comparePatternsForProfile (const void *a, const void *b)
+{
+	const regexPattern *pa = a;
+	const regexPattern *pb = b;
+
+	if (pa->profile.match != pb->profile.match)
+		return (pa->profile.match < pb->profile.match)? 1: -1;
+	if (pa->profile.attempts != pb->profile.attempts)
+		return (pa->profile.attempts < pb->profile.attempts)? 1: -1;
+	return strcmp (pa->pattern_string, pb->pattern_string);
+}
+
+static int comparePatternsForScriptProfile (const void *a, const void *b)
+{
+	const regexPattern *pa = a;
+	const regexPattern *pb = b;
+
+	if (pa->profile.script.operators != pb->profile.script.operators)
+		return (pa->profile.script.operators < pb->profile.script.operators)? 1: -1;
+	return comparePatternsForProfile (a, b);
+}
+
+static void printScriptProfile (struct lregexControlBlock *lcb, ptrArray *patterns)
+{
+	ptrArray *scripted = ptrArrayNew (NULL);
+
+	for (unsigned int i = 0; i < ptrArrayCount (patterns); i++)
+	{
+		regexPattern *ptrn = ptrArrayItem (patterns, i);
+		if (ptrn->profile.script_runs > 0)
+			ptrArrayAdd (scripted, ptrn);
+	}
+
+	if (ptrArrayCount (scripted) > 0)
+	{
+		ptrArraySort (scripted, comparePatternsForScriptProfile);
+
+		fprintf(stderr, "\nOPTSCRIPT PROFILE of %s\n", getLanguageName (lcb->owner));
+		fputs("==============================================\n", stderr);
+		fprintf(stderr, "%10s %12s %10s %12s %s\n",
+				"runs", "operators", "procs", "lookups", "pattern");
+		for (unsigned int i = 0; i < ptrArrayCount (scripted); i++)
+		{
+			regexPattern *ptrn = ptrArrayItem (scripted, i);
+			fprintf(stderr, "%10lu %12lu %10lu %12lu %s\n",
+					ptrn->profile.script_runs,
+					ptrn->profile.script.operators,
+					ptrn->profile.script.procs,
+					ptrn->profile.script.lookups,
+					ptrn->pattern_string);
+		}
+	}
+	ptrArrayDelete (scripted);
+}
+
+static double clockToMsec (clock_t c)
+{
+	return (double) c * 1000.0 / CLOCKS_PER_SEC;
+}
+
+/* Returns the patterns tried at least once. A pattern shared by
+ * tables appears once. */
+static ptrArray *collectProfiledPatterns (struct lregexControlBlock *lcb)
+{
+	ptrArray *patterns = ptrArrayNew (NULL);
+	hashTable *seen = hashTableNew (64, hashPtrhash, hashPtreq, NULL, NULL);
+
+	for (unsigned int i = 0; i < ARRAY_SIZE (lcb->entries); i++)
+		collectPatternsForProfile (lcb->entries [i], patterns, seen);
+	for (unsigned int i = 0; i < ptrArrayCount (lcb->tables); i++)
+	{
+		struct regexTable *table = ptrArrayItem (lcb->tables, i);
+		collectPatternsForProfile (table->entries, patterns, seen);
+	}
+	hashTableDelete (seen);
+	return patterns;
+}
+
+extern void countRegexMatches (struct lregexControlBlock *lcb,
+							   unsigned long *attempts, unsigned long *matches)
+{
+	ptrArray *patterns = collectProfiledPatterns (lcb);
+
+	*attempts = 0;
+	*matches = 0;
+	for (unsigned int i = 0; i < ptrArrayCount (patterns); i++)
+	{
+		regexPattern *ptrn = ptrArrayItem (patterns, i);
+		*attempts += ptrn->profile.attempts;
+		*matches += ptrn->profile.matches;
+	}
+	ptrArrayDelete (patterns);
+}
+
+extern void printRegexProfile (struct lregexControlBlock *lcb)
+{
+	ptrArray *patterns = collectProfiledPatterns (lcb);
+
+	if (ptrArrayCount (patterns) == 0)
+	{
+		ptrArrayDelete (patterns);
+		return;
+	}
+
+	ptrArraySort (patterns, comparePatternsForProfile);
+
+	fprintf(stderr, "\nREGEX PROFILE of %s\n", getLanguageName (lcb->owner));
+	fputs("==============================================\n", stderr);
+	fprintf(stderr, "%10s %10s %10s %12s %-7s %s\n",
+			"match(ms)", "attempts", "matches", "compile(ms)", "type", "pattern");
+	for (unsigned int i = 0; i < ptrArrayCount (patterns); i++)
+	{
+		regexPattern *ptrn = ptrArrayItem (patterns, i);
+		fprintf(stderr, "%10.3f %10lu %10lu %12.3f %-7s %s\n",
+				clockToMsec (ptrn->profile.match),
+				ptrn->profile.attempts,
+				ptrn->profile.matches,
+				clockToMsec (ptrn->profile.compile),
+				(ptrn->regptype == REG_PARSER_SINGLE_LINE)? "line":
+				(ptrn->regptype == REG_PARSER_MULTI_LINE)? "mline": "mtable",
+				ptrn->pattern_string);
+	}
+
+	printScriptProfile (lcb, patterns);
+	ptrArrayDelete (patterns);
+}
+
 extern void printMultitableStatistics (struct lregexControlBlock *lcb)
 {
 	if (ptrArrayCount(lcb->tables) == 0)
@@ -2981,17 +3609,18 @@ extern void printMultitableStatistics (struct lregexControlBlock *lcb)
 		{
 			regexTableEntry *entry = ptrArrayItem (table->entries, j);
 			Assert (entry && entry->pattern);
-			fprintf(stderr, "%10u/%-10u%-40s ref: %d\n",
+			fprintf(stderr, "%10u/%-10u%-40s ref: %d skip: %u\n",
 					entry->statistics.match,
 					entry->statistics.unmatch + entry->statistics.match,
 					entry->pattern->pattern_string,
-					entry->pattern->refcount);
+					entry->pattern->refcount,
+					entry->statistics.skip);
 		}
 		fputc('\n', stderr);
 	}
 }
 
-extern bool matchMultitableRegex (struct lregexControlBlock *lcb, const vString* const allLines)
+extern bool matchMultitableRegex (struct lregexControlBlock *lcb, const char *input, size_t size)
 {
 	if (ptrArrayCount (lcb->tables) == 0)
 		return false;
@@ -3002,11 +3631,15 @@ extern bool matchMultitableRegex (struct lregexControlBlock *lcb, const vString*
 	int motionless_counter = 0;
 	unsigned int last_offset;
 
+	lcb->released_offset = 0;
+
 
 	while (table)
 	{
 		last_offset = offset;
-		table = matchMultitableRegexTable(lcb, table, allLines, &offset);
+		beginTraceEvent (TRACE_REGEX_TABLE, table->name);
+		table = matchMultitableRegexTable(lcb, table, input, size, &offset);
+		endTraceEvent (TRACE_REGEX_TABLE);
 
 		if (last_offset == offset)
 			motionless_counter++;
@@ -3126,6 +3759,21 @@ extern EsObject* scriptEval (OptVM *vm, EsObject *optscript)
 	return optscriptEval (vm, optscript);
 }
 
+static EsObject *scriptEvalPattern (OptVM *vm, regexPattern *ptrn)
+{
+	struct OptVMCounters before, after;
+
+	opt_vm_get_counters (vm, &before);
+	EsObject *e = scriptEval (vm, ptrn->optscript);
+	opt_vm_get_counters (vm, &after);
+
+	ptrn->profile.script_runs++;
+	ptrn->profile.script.operators += after.operators - before.operators;
+	ptrn->profile.script.procs += after.procs - before.procs;
+	ptrn->profile.script.lookups += after.lookups - before.lookups;
+	return e;
+}
+
 static void scriptEvalHook (OptVM *vm, struct lregexControlBlock *lcb, enum scriptHook hook)
 {
 	if (ptrArrayCount (lcb->hook_code[hook]) == 0)
@@ -3146,7 +3794,8 @@ static void scriptEvalHook (OptVM *vm, struct lregexControlBlock *lcb, enum scri
 		EsObject * e = optscriptEval (vm, code);
 		if (es_error_p (e))
 			error (WARNING, "error when evaluating hook[%d] code: %s",
-				   hook, (char *)ptrArrayItem (lcb->hook[i], i));
+				   hook, (char *)ptrArrayItem (lcb->hook[hook], i));
+		es_object_unref (e);
 	}
 }
 
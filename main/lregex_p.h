@@ -60,6 +60,20 @@ struct regexBackend {
 									   void *, const char *, size_t,
 									   regmatch_t[BACK_REFERENCE_COUNT]);
 	void              (* delete_code) (void *);
+
+	/* Return a literal string which any match of the pattern
+	 * contains, or NULL. Used in the prefilter. Optional. */
+	char *            (* required_literal) (struct regexBackend *,
+											const char* const,
+											int);
+
+	/* Fill the bitmap with the bytes a match of the pattern can start
+	 * with. Return false if unknown. Used for mtable patterns and
+	 * anchored single line patterns. Optional. */
+	bool              (* first_bytes) (struct regexBackend *,
+									   const char* const,
+									   int,
+									   unsigned char [256 / 8]);
 };
 
 struct flagDefsDescriptor {
@@ -97,9 +111,15 @@ extern void addCallbackRegex (struct lregexControlBlock *lcb,
 							  const regexCallback callback,
 							  bool *disabled,
 							  void * userData);
+extern bool regexHasLinePatterns (struct lregexControlBlock *lcb);
 extern bool regexNeedsMultilineBuffer (struct lregexControlBlock *lcb);
-extern bool matchMultilineRegex (struct lregexControlBlock *lcb, const vString* const allLines);
-extern bool matchMultitableRegex (struct lregexControlBlock *lcb, const vString* const allLines);
+/* True if the patterns are in the regex tables having windows only. */
+extern bool regexHasWindowedTables (struct lregexControlBlock *lcb);
+/* True if a multiline pattern or a table without window is defined. */
+extern bool regexNeedsWholeInput (struct lregexControlBlock *lcb);
+/* INPUT doesn't have to be terminated with NUL. */
+extern bool matchMultilineRegex (struct lregexControlBlock *lcb, const char *input, size_t size);
+extern bool matchMultitableRegex (struct lregexControlBlock *lcb, const char *input, size_t size);
 
 extern void notifyRegexInputStart (struct lregexControlBlock *lcb);
 extern void notifyRegexInputEnd (struct lregexControlBlock *lcb);
@@ -114,6 +134,25 @@ extern void addOptscriptToHook (struct lregexControlBlock *lcb, enum scriptHook
 extern void propagateParamToOptscript (struct lregexControlBlock *lcb, const char *param, const char *value);
 
 extern void printMultitableStatistics (struct lregexControlBlock *lcb);
+extern void deferRegexCompilation (bool defer);
+extern void printRegexProfile (struct lregexControlBlock *lcb);
+/* Counts the attempts and the matches of all the patterns so far. */
+extern void countRegexMatches (struct lregexControlBlock *lcb,
+							   unsigned long *attempts, unsigned long *matches);
+
+/* lregex-prefilter.c */
+struct regexPrefilter;
+extern struct regexPrefilter *regexPrefilterNew (void);
+extern void regexPrefilterDelete (struct regexPrefilter *pf);
+extern void regexPrefilterAdd (struct regexPrefilter *pf,
+							   const char *literal, unsigned int id);
+extern void regexPrefilterBuild (struct regexPrefilter *pf);
+/* Set MARKS[id] to STAMP for each literal found in INPUT.
+ * Returns the number of newly marked ids; stops at LIMIT. */
+extern unsigned int regexPrefilterScan (struct regexPrefilter *pf,
+										const char *input, size_t len,
+										unsigned int *marks, unsigned int stamp,
+										unsigned int limit);
 
 extern void basic_regex_flag_short (char c, void* data);
 extern void basic_regex_flag_long (const char* const s, const char* const unused, void* data);
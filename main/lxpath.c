@@ -11,6 +11,8 @@
 #include "general.h"  /* must always come first */
 #include "debug.h"
 #include "entry.h"
+#include "field.h"
+#include "lxpath_p.h"
 #include "options.h"
 #include "parse_p.h"
 #include "read.h"
@@ -19,6 +21,7 @@
 #include "xtag.h"
 
 #ifdef HAVE_LIBXML
+#include <libxml/parser.h>
 #include <libxml/xpath.h>
 #include <libxml/tree.h>
 
@@ -29,7 +32,7 @@ static void simpleXpathMakeTag (xmlNode *node,
 {
 	tagEntryInfo tag;
 	xmlChar* str;
-	char *path;
+	char *path = NULL;
 	int kind;
 
 	str = xmlNodeGetContent(node);
@@ -55,7 +58,10 @@ static void simpleXpathMakeTag (xmlNode *node,
 	tag.lineNumber = XML_GET_LINE (node);
 	tag.filePosition = getInputFilePositionForLine (tag.lineNumber);
 
-	path = (char *)xmlGetNodePath (node);
+	/* xmlGetNodePath () walks the siblings of the node and of its
+	 * ancestors. It is too slow to call for a field not printed. */
+	if (isFieldEnabled (FIELD_XPATH))
+		path = (char *)xmlGetNodePath (node);
 	tag.extensionFields.xpath = path;
 
 	if (spec->make)
@@ -145,6 +151,15 @@ static void suppressWarning (void *ctx CTAGS_ATTR_UNUSED, const char *msg CTAGS_
 {
 }
 
+extern xmlDocPtr makeXMLDocFromMemory (const unsigned char *data, size_t size)
+{
+	xmlSetGenericErrorFunc (NULL, suppressWarning);
+	/* A large document has many blank texts between the elements. No
+	 * xpath table looks at them; they are not kept in the tree. */
+	return xmlReadMemory ((const char *)data, (int)size, NULL, NULL,
+						  XML_PARSE_COMPACT | XML_PARSE_NOBLANKS);
+}
+
 static xmlDocPtr makeXMLDoc (void)
 {
 	const unsigned char* data;
@@ -160,11 +175,7 @@ static xmlDocPtr makeXMLDoc (void)
 
 	data = getInputFileData (&size);
 	if (data)
-	{
-		xmlSetGenericErrorFunc (NULL, suppressWarning);
-		xmlLineNumbersDefault (1);
-		doc = xmlParseMemory((const char*)data, size);
-	}
+		doc = makeXMLDocFromMemory (data, size);
 
 	return doc;
 }
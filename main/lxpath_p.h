@@ -15,6 +15,7 @@
 */
 
 #include "general.h"  /* must always come first */
+#include "lxpath.h"
 #include "types.h"
 
 
@@ -25,4 +26,10 @@
 extern void addTagXpath (const langType language, tagXpathTable *xpathTable);
 extern void removeTagXpath (const langType language, tagXpathTable *xpathTable);
 
+#ifdef HAVE_LIBXML
+/* Parses DATA as a XML document both for selecting a parser and for
+ * tagging, so the document made in the selection can be reused. */
+extern xmlDocPtr makeXMLDocFromMemory (const unsigned char *data, size_t size);
+#endif
+
 #endif  /* CTAGS_LXPATH_PARSE_PRIVATE_H */
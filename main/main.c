@@ -28,6 +28,7 @@
 #include <crt_externs.h>
 #endif
 
+#include <ctype.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
@@ -47,23 +48,42 @@
 #ifdef HAVE_IO_H
 # include <io.h>  /* to declare _findfirst() */
 #endif
+#ifdef HAVE_FCNTL_H
+# include <fcntl.h>  /* to declare openat() */
+#endif
+#if defined (HAVE_OPENAT) && defined (HAVE_FDOPENDIR) && defined (O_DIRECTORY)
+# include <unistd.h>  /* to declare close() */
+# define USE_OPENAT 1
+#endif
 
 
 #include "ctags.h"
 #include "debug.h"
+#include "dedup_p.h"
 #include "entry_p.h"
 #include "error_p.h"
 #include "field_p.h"
+#include "htable.h"
+#include "ignorefile_p.h"
+#include "jobs_p.h"
 #include "keyword_p.h"
+#include "langcache_p.h"
 #include "main_p.h"
 #include "options_p.h"
 #include "optscript.h"
 #include "parse_p.h"
+#include "read.h"
 #include "read_p.h"
 #include "routines_p.h"
+#include "sampler_p.h"
 #include "stats_p.h"
+#include "strlist.h"
+#include "tagcache_p.h"
 #include "trace.h"
+#include "traceevent_p.h"
 #include "trashbox_p.h"
+#include "vstring.h"
+#include "watch_p.h"
 #include "writer_p.h"
 #include "xtag_p.h"
 
@@ -71,6 +91,21 @@
 #include "interactive_p.h"
 #include <jansson.h>
 #include <errno.h>
+#if defined (HAVE_FORK) && defined (HAVE_POLL_H) && defined (HAVE_SYS_WAIT_H)
+# include <poll.h>
+# include <signal.h>
+# include <sys/wait.h>
+# include <unistd.h>
+# define USE_INTERACTIVE_WORKERS 1
+#endif
+#ifdef HAVE_SYS_SOCKET_H
+# include <sys/socket.h>
+# include <sys/stat.h>
+# include <unistd.h>
+# ifdef SCM_RIGHTS
+#  define USE_INTERACTIVE_FD_PASSING 1
+# endif
+#endif
 #endif
 
 /*
@@ -79,25 +114,77 @@
 static mainLoopFunc mainLoop;
 static void *mainData;
 
+#ifdef USE_OPENAT
+/* The entry of the directory being read by recurseUsingOpendir (), passed
+ * to createTagsForEntry (). If the entry is a directory, it is opened
+ * relative to its parent directory instead of resolving the whole path
+ * again. */
+static struct {
+	int dirfd;
+	const char *name;
+	const char *path;
+} WalkEntry = { -1, NULL, NULL };
+#endif
+
 /*
 *   FUNCTION PROTOTYPES
 */
-static bool createTagsForEntry (const char *const entryName);
 
 /*
 *   FUNCTION DEFINITIONS
 */
 
 #if defined (HAVE_OPENDIR) && (defined (HAVE_DIRENT_H) || defined (_MSC_VER))
+static bool isEntryIgnored (const char *const filePath, struct dirent *entry)
+{
+	bool isDirectory;
+
+	if (! Option.useIgnoreFiles)
+		return false;
+
+#ifdef DT_DIR
+	/* Avoid stat(2) if readdir(3) tells the type. */
+	if (entry->d_type != DT_UNKNOWN && entry->d_type != DT_LNK)
+		isDirectory = (entry->d_type == DT_DIR);
+	else
+#endif
+		isDirectory = eStat (filePath)->isDirectory;
+
+	return isIgnoredByIgnoreFiles (filePath, isDirectory);
+}
+
+static DIR *openDirectory (const char *const dirName)
+{
+#ifdef USE_OPENAT
+	if (WalkEntry.path == dirName)
+	{
+		DIR *dir = NULL;
+		int fd = openat (WalkEntry.dirfd, WalkEntry.name, O_RDONLY | O_DIRECTORY);
+
+		if (fd >= 0)
+		{
+			dir = fdopendir (fd);
+			if (dir == NULL)
+				close (fd);
+		}
+		return dir;
+	}
+#endif
+	return opendir (dirName);
+}
+
 static bool recurseUsingOpendir (const char *const dirName)
 {
 	bool resize = false;
-	DIR *const dir = opendir (dirName);
+	DIR *const dir = openDirectory (dirName);
 	if (dir == NULL)
 		error (WARNING | PERROR, "cannot recurse into directory \"%s\"", dirName);
 	else
 	{
 		struct dirent *entry;
+#ifdef USE_OPENAT
+		setRecursionDirectoryFd (dirfd (dir));
+#endif
 		while ((entry = readdir (dir)) != NULL)
 		{
 			if (strcmp (entry->d_name, ".") != 0  &&
@@ -112,7 +199,29 @@ static bool recurseUsingOpendir (const char *const dirName)
 					filePath = combinePathAndFile (dirName, entry->d_name);
 					free_p = true;
 				}
-				resize |= createTagsForEntry (filePath);
+#ifdef USE_OPENAT
+				bool isDirectory = false;
+# ifdef DT_DIR
+				isDirectory = (entry->d_type == DT_DIR);
+# endif
+				/* Fill the cache of eStat () here. Looking up the name
+				 * in the opened directory is cheaper than the path. */
+				eStatAt (dirfd (dir), entry->d_name, filePath, isDirectory);
+#endif
+				if (isEntryIgnored (filePath, entry))
+					verbose ("ignoring \"%s\" (ignore file)\n", filePath);
+				else
+				{
+#ifdef USE_OPENAT
+					WalkEntry.dirfd = dirfd (dir);
+					WalkEntry.name = entry->d_name;
+					WalkEntry.path = filePath;
+#endif
+					resize |= createTagsForEntry (filePath);
+#ifdef USE_OPENAT
+					WalkEntry.path = NULL;
+#endif
+				}
 				if (free_p)
 					eFree (filePath);
 			}
@@ -125,20 +234,18 @@ static bool recurseUsingOpendir (const char *const dirName)
 
 #ifdef HAVE__FINDFIRST
 
-static bool createTagsForWildcardEntry (
-		const char *const pattern, const size_t dirLength,
-		const char *const entryName)
+/* How many entries ahead of the current one are prefetched */
+#define WILDCARD_PREFETCH_DISTANCE 4
+
+static bool createTagsForWildcardEntry (const char *const filePath)
 {
 	bool resize = false;
-	/* we must not recurse into the directories "." or ".." */
-	if (strcmp (entryName, ".") != 0  &&  strcmp (entryName, "..") != 0)
-	{
-		vString *const filePath = vStringNew ();
-		vStringNCopyS (filePath, pattern, dirLength);
-		vStringCatS (filePath, entryName);
-		resize = createTagsForEntry (vStringValue (filePath));
-		vStringDelete (filePath);
-	}
+
+	if (Option.useIgnoreFiles
+		&& isIgnoredByIgnoreFiles (filePath, eStat (filePath)->isDirectory))
+		verbose ("ignoring \"%s\" (ignore file)\n", filePath);
+	else
+		resize = createTagsForEntry (filePath);
 	return resize;
 }
 
@@ -150,12 +257,33 @@ static bool createTagsForWildcardUsingFindfirst (const char *const pattern)
 	intptr_t hFile = _findfirst (pattern, &fileInfo);
 	if (hFile != -1L)
 	{
+		/* The entries are listed first, so the files a few entries
+		 * ahead of the current one can be prefetched. */
+		stringList *const paths = stringListNew ();
 		do
 		{
 			const char *const entry = (const char *) fileInfo.name;
-			resize |= createTagsForWildcardEntry (pattern, dirLength, entry);
+			/* we must not recurse into the directories "." or ".." */
+			if (strcmp (entry, ".") != 0  &&  strcmp (entry, "..") != 0)
+			{
+				vString *const filePath = vStringNew ();
+				vStringNCopyS (filePath, pattern, dirLength);
+				vStringCatS (filePath, entry);
+				stringListAdd (paths, filePath);
+			}
 		} while (_findnext (hFile, &fileInfo) == 0);
 		_findclose (hFile);
+
+		const unsigned int count = stringListCount (paths);
+		for (unsigned int i = 0; i < count && i < WILDCARD_PREFETCH_DISTANCE; i++)
+			prefetchFile (vStringValue (stringListItem (paths, i)));
+		for (unsigned int i = 0; i < count; i++)
+		{
+			if (i + WILDCARD_PREFETCH_DISTANCE < count)
+				prefetchFile (vStringValue (stringListItem (paths, i + WILDCARD_PREFETCH_DISTANCE)));
+			resize |= createTagsForWildcardEntry (vStringValue (stringListItem (paths, i)));
+		}
+		stringListDelete (paths);
 	}
 	return resize;
 }
@@ -179,7 +307,12 @@ static bool recurseIntoDirectory (const char *const dirName)
 				dirName, recursionDepth, Option.maxRecursionDepth);
 	else
 	{
+		bool useIgnoreFiles = Option.useIgnoreFiles;
+
 		verbose ("RECURSING into directory \"%s\"\n", dirName);
+		pushRecursionDirectory (dirName);
+		if (useIgnoreFiles)
+			pushIgnoreFiles (dirName);
 #if defined (HAVE_OPENDIR) && (defined (HAVE_DIRENT_H) || defined (_MSC_VER))
 		resize = recurseUsingOpendir (dirName);
 #elif defined (HAVE__FINDFIRST)
@@ -192,6 +325,9 @@ static bool recurseIntoDirectory (const char *const dirName)
 			vStringDelete (pattern);
 		}
 #endif
+		if (useIgnoreFiles)
+			popIgnoreFiles ();
+		popRecursionDirectory ();
 	}
 
 	recursionDepth--;
@@ -199,9 +335,26 @@ static bool recurseIntoDirectory (const char *const dirName)
 	return resize;
 }
 
-static bool createTagsForEntry (const char *const entryName)
+/* The shard of a file depends only on its name, so the runs for the
+ * shards on different machines parse each file once. */
+static bool isInputFileInShard (const char *const fileName)
+{
+	const char *name = fileName;
+	unsigned long long h;
+
+	if (Option.shardCount == 0)
+		return true;
+
+	while (name [0] == '.' && name [1] == OUTPUT_PATH_SEPARATOR)
+		name += 2;
+	h = hashBytes (HASH_BYTES_INIT, name, strlen (name));
+	return (h % Option.shardCount == Option.shardIndex - 1);
+}
+
+extern bool createTagsForEntry (const char *const entryName)
 {
 	bool resize = false;
+	const timingPhase phase = enterTimingPhase (PHASE_WALK);
 	fileStatus *status = eStat (entryName);
 
 	Assert (entryName != NULL);
@@ -217,10 +370,23 @@ static bool createTagsForEntry (const char *const entryName)
 		verbose ("ignoring \"%s\" (special file)\n", entryName);
 	else if (isExcludedFile (entryName, false))
 		verbose ("excluding \"%s\"\n", entryName);
-	else
+	else if (Option.mergeTags)
+		mergeTagFile (entryName);
+	else if (! isInputFileInShard (entryName))
+		verbose ("skipping \"%s\" (another shard)\n", entryName);
+	else if (isInputFileParsedBefore (entryName, status))
+		;
+	else if (spliceCachedTags (entryName, status))
+		;
+	else if (! queueJob (entryName, status))
+	{
+		beginTagCacheEntry (entryName, status);
 		resize = parseFile (entryName);
+		endTagCacheEntry ();
+	}
 
 	eStatFree (status);
+	leaveTimingPhase (phase);
 	return resize;
 }
 
@@ -250,6 +416,51 @@ static bool createTagsForWildcardArg (const char *const arg)
 
 #endif
 
+static bool createTagsForArg (const char *const arg)
+{
+#ifdef MANUAL_GLOBBING
+	return createTagsForWildcardArg (arg);
+#else
+	return createTagsForEntry (arg);
+#endif
+}
+
+/*  Generate tags for the file names up to the next option in the order
+ *  --input-order tells.
+ */
+static bool createTagsForOrderedArgs (cookedArgs *const args)
+{
+	bool resize = false;
+	char **names = NULL;
+	unsigned int count = 0;
+	unsigned int size = 0;
+
+	while (! cArgOff (args) && ! cArgIsOption (args))
+	{
+		if (count == size)
+		{
+			size = size? size * 2: 64;
+			names = xRealloc (names, size, char *);
+		}
+		names [count++] = eStrdup (cArgItem (args));
+		cArgForth (args);
+	}
+
+	count = argOrderFileNames (names, count, Option.inputOrder);
+	for (unsigned int i = 0; i < count; i++)
+	{
+		resize |= createTagsForArg (names [i]);
+		eFree (names [i]);
+	}
+	if (names)
+		eFree (names);
+
+	if (! cArgOff (args))
+		runQueuedJobs ();
+	parseCmdlineOptions (args);
+	return resize;
+}
+
 static bool createTagsForArgs (cookedArgs *const args)
 {
 	bool resize = false;
@@ -258,14 +469,16 @@ static bool createTagsForArgs (cookedArgs *const args)
 	 */
 	while (! cArgOff (args))
 	{
-		const char *const arg = cArgItem (args);
+		if (Option.inputOrder != INPUT_ORDER_GIVEN)
+		{
+			resize |= createTagsForOrderedArgs (args);
+			continue;
+		}
 
-#ifdef MANUAL_GLOBBING
-		resize |= createTagsForWildcardArg (arg);
-#else
-		resize |= createTagsForEntry (arg);
-#endif
+		resize |= createTagsForArg (cArgItem (args));
 		cArgForth (args);
+		if (! cArgOff (args) && cArgIsOption (args))
+			runQueuedJobs ();
 		parseCmdlineOptions (args);
 	}
 	return resize;
@@ -273,12 +486,11 @@ static bool createTagsForArgs (cookedArgs *const args)
 
 /*  Read from an opened file a list of file names for which to generate tags.
  */
-static bool createTagsFromFileInput (FILE *const fp, const bool filter)
+static bool createTagsFromFileInput (cookedArgs *const args, const bool filter)
 {
 	bool resize = false;
-	if (fp != NULL)
+	if (args != NULL)
 	{
-		cookedArgs *args = cArgNewFromLineFile (fp);
 		parseCmdlineOptions (args);
 		while (! cArgOff (args))
 		{
@@ -290,6 +502,8 @@ static bool createTagsFromFileInput (FILE *const fp, const bool filter)
 				fflush (stdout);
 			}
 			cArgForth (args);
+			if (! cArgOff (args) && cArgIsOption (args))
+				runQueuedJobs ();
 			parseCmdlineOptions (args);
 		}
 		cArgDelete (args);
@@ -304,18 +518,80 @@ static bool createTagsFromListFile (const char *const fileName)
 	bool resize;
 	Assert (fileName != NULL);
 	if (strcmp (fileName, "-") == 0)
-		resize = createTagsFromFileInput (stdin, false);
+		resize = createTagsFromFileInput (cArgNewFromListFile (stdin, Option.inputOrder),
+										  false);
 	else
 	{
 		FILE *const fp = fopen (fileName, "r");
 		if (fp == NULL)
 			error (FATAL | PERROR, "cannot open list file \"%s\"", fileName);
-		resize = createTagsFromFileInput (fp, false);
+		resize = createTagsFromFileInput (cArgNewFromListFile (fp, Option.inputOrder),
+										  false);
 		fclose (fp);
 	}
 	return resize;
 }
 
+/*  Read from a named file the list of the files changed or removed since
+ *  the tag file was made, and replace their tags in the tag file. A line
+ *  is either a file name, or a status letter, a tab, and the file name
+ *  (followed by a tab and the new name for a copy or a rename), as
+ *  "git diff --name-status" prints.
+ */
+static bool createTagsFromUpdateList (const char *const fileName)
+{
+	MIO *mio;
+	vString *line = vStringNew ();
+	bool resize = false;
+
+	Assert (fileName != NULL);
+	if (strcmp (fileName, "-") == 0)
+		mio = mio_new_fp (stdin, NULL);
+	else
+		mio = mio_new_file (fileName, "r");
+	if (mio == NULL)
+		error (FATAL | PERROR, "cannot open update list file \"%s\"", fileName);
+
+	while (readLineRaw (line, mio) != NULL)
+	{
+		char *path, *tab;
+		const char *newPath = NULL;
+		int status = 'M';
+
+		vStringStripNewline (line);
+		path = vStringValue (line);
+		if (*path == '\0')
+			continue;
+
+		tab = strchr (path, '\t');
+		if (tab != NULL)
+		{
+			status = path [0];
+			path = tab + 1;
+			tab = strchr (path, '\t');
+			if (tab != NULL)
+			{
+				*tab = '\0';
+				newPath = tab + 1;
+			}
+		}
+
+		/* A copy leaves its source as it was. */
+		if (status != 'C')
+			dropTagsOfInputFile (path);
+		if (newPath != NULL)
+		{
+			dropTagsOfInputFile (newPath);
+			path = (char *) newPath;
+		}
+		if (status != 'D' && doesFileExist (path))
+			resize |= createTagsForEntry (path);
+	}
+	mio_unref (mio);
+	vStringDelete (line);
+	return resize;
+}
+
 static bool etagsInclude (void)
 {
 	return (bool)(Option.etags && Option.etagsInclude != NULL);
@@ -334,9 +610,10 @@ static void runMainLoop (cookedArgs *args)
 
 static void batchMakeTags (cookedArgs *args, void *user CTAGS_ATTR_UNUSED)
 {
-	clock_t timeStamps [3];
+	double timeStamps [3];
 	bool resize = false;
 	bool files = (bool)(! cArgOff (args) || Option.fileList != NULL
+							  || Option.updateFileList != NULL
 							  || Option.filter);
 
 	if (! files)
@@ -348,11 +625,23 @@ static void batchMakeTags (cookedArgs *args, void *user CTAGS_ATTR_UNUSED)
 			return;
 	}
 
-#define timeStamp(n) timeStamps[(n)]=(Option.printTotals ? clock():(clock_t)0)
+#define timeStamp(n) timeStamps[(n)]=(Option.printTotals ? getWallClock():0.0)
 	if ((! Option.filter) && (! Option.printLanguage))
 		openTagFile ();
 
 	timeStamp (0);
+	if (Option.printTotals > 1)
+	{
+		startMemoryAccounting ();
+		startTiming ();
+	}
+	startFileStatistics (false);
+	if (Option.traceEventsFileName)
+		openEventTrace (Option.traceEventsFileName);
+	startSampling ();
+	openTagCache ();
+	openLanguageCache ();
+	beginJobs ();
 
 	if (! cArgOff (args))
 	{
@@ -364,18 +653,28 @@ static void batchMakeTags (cookedArgs *args, void *user CTAGS_ATTR_UNUSED)
 		verbose ("Reading list file\n");
 		resize = (bool) (createTagsFromListFile (Option.fileList) || resize);
 	}
+	if (Option.updateFileList != NULL)
+	{
+		verbose ("Reading update list file\n");
+		resize = (bool) (createTagsFromUpdateList (Option.updateFileList) || resize);
+	}
 	if (Option.filter)
 	{
 		verbose ("Reading filter input\n");
-		resize = (bool) (createTagsFromFileInput (stdin, true) || resize);
+		resize = (bool) (createTagsFromFileInput (cArgNewFromLineFile (stdin), true) || resize);
 	}
 	if (! files  &&  Option.recurse)
 		resize = recurseIntoDirectory (".");
 
+	endJobs ();
 	timeStamp (1);
 
+	closeLanguageCache ();
+	closeTagCache ();
+
 	if ((! Option.filter) && (!Option.printLanguage))
 		closeTagFile (resize);
+	closeEventTrace ();
 
 	timeStamp (2);
 
@@ -383,14 +682,694 @@ static void batchMakeTags (cookedArgs *args, void *user CTAGS_ATTR_UNUSED)
 	{
 		printTotals (timeStamps, Option.append, Option.sorted);
 		if (Option.printTotals > 1)
+		{
+			printTimingStatistics ();
 			for (unsigned int i = 0; i < countParsers(); i++)
 				printParserStatisticsIfUsed (i);
+			printMemoryStatistics ();
+		}
 	}
+	printFileStatistics ();
+	printSamplingProfile ();
 
 #undef timeStamp
 }
 
 #ifdef HAVE_JANSSON
+/* Reads a request to BUFFER. A request is either a line of json or a
+ * frame: the size of the json in bytes written in decimal on a line,
+ * followed by the json itself. A frame lets a client send a request
+ * without escaping the newlines in it. Returns false at the end of the
+ * input. */
+static bool readInteractiveRequest (vString *buffer)
+{
+	int c;
+
+	vStringClear (buffer);
+	do
+		c = getc (stdin);
+	while (c == '\n');
+	if (c == EOF)
+		return false;
+
+	if (isdigit (c))
+	{
+		size_t size = 0;
+
+		while (isdigit (c) && size < ((size_t) -1) / 10 - 9)
+		{
+			vStringPut (buffer, c);
+			size = size * 10 + (c - '0');
+			c = getc (stdin);
+		}
+		if (c == '\n')
+		{
+			vStringClear (buffer);
+			for (size_t i = 0; i < size && (c = getc (stdin)) != EOF; i++)
+				vStringPut (buffer, c);
+			return true;
+		}
+		/* Not a frame; let the json parser report it. */
+	}
+
+	while (c != EOF && c != '\n')
+	{
+		vStringPut (buffer, c);
+		c = getc (stdin);
+	}
+	return true;
+}
+
+/* Reads SIZE bytes of the contents of a file from stdin to a memory
+ * stream. */
+static MIO *readInteractiveMio (json_int_t size)
+{
+	unsigned char *data = eMalloc (size);
+	size = fread (data, 1, size, stdin);
+	return mio_new_memory (data, size, eRealloc, eFreeNoNullCheck);
+}
+
+/* Reads SIZE bytes of the contents of FILENAME from stdin, and makes
+ * tags for it. */
+static void generateTagsForStream (const char *filename, json_int_t size)
+{
+	MIO *mio = readInteractiveMio (size);
+	parseFileWithMio (filename, mio, NULL);
+	mio_unref (mio);
+}
+
+#ifdef USE_INTERACTIVE_FD_PASSING
+/* Set when stdin is a Unix domain socket a client can send descriptors
+ * over. stdin is not buffered then; a read () of the buffer would drop
+ * the descriptor sent with the data read. */
+static bool StdinIsSocket;
+
+/* Receives a descriptor sent with a byte over stdin. Returns -1 if no
+ * descriptor comes. */
+static int receiveInteractiveFd (void)
+{
+	char byte;
+	struct iovec iov = {
+		.iov_base = &byte,
+		.iov_len = 1,
+	};
+	union {
+		struct cmsghdr header;
+		char buffer [CMSG_SPACE (sizeof (int))];
+	} control;
+	struct msghdr msg = {
+		.msg_iov = &iov,
+		.msg_iovlen = 1,
+		.msg_control = control.buffer,
+		.msg_controllen = sizeof (control.buffer),
+	};
+	struct cmsghdr *c;
+	int fd = -1;
+
+	if (!StdinIsSocket || recvmsg (STDIN_FILENO, &msg, 0) != 1)
+		return -1;
+
+	for (c = CMSG_FIRSTHDR (&msg); c; c = CMSG_NXTHDR (&msg, c))
+	{
+		if (c->cmsg_level == SOL_SOCKET && c->cmsg_type == SCM_RIGHTS
+			&& c->cmsg_len == CMSG_LEN (sizeof (int)))
+			memcpy (&fd, CMSG_DATA (c), sizeof (int));
+	}
+	return fd;
+}
+#endif
+
+/* Opens the contents of a generate-tags request given inline or with
+ * "fd". The contents with "fd" are read from the descriptor, which
+ * is either inherited from the client, or sent over stdin right after
+ * the request if "fd" is "socket". They are mapped only if the client
+ * has sealed the descriptor against shrinking and writing, and copied
+ * otherwise: the client could truncate a mapped file while it is parsed.
+ * SIZE is the size of the contents, or 0 for the whole descriptor.
+ * Returns NULL if the descriptor cannot be read. */
+static MIO *openInteractiveInput (json_t *request, json_int_t size)
+{
+	json_t *fd = json_object_get (request, "fd");
+	MIO *mio = NULL;
+
+	if (! fd)
+		return readInteractiveMio (size);
+
+	if (size < 0)
+		size = 0;
+	if (json_is_integer (fd))
+		mio = mio_new_fd ((int) json_integer_value (fd), (size_t) size);
+#ifdef USE_INTERACTIVE_FD_PASSING
+	else if (json_is_string (fd) && !strcmp (json_string_value (fd), "socket"))
+	{
+		int received = receiveInteractiveFd ();
+		if (received != -1)
+		{
+			mio = mio_new_fd (received, (size_t) size);
+			close (received);
+		}
+	}
+#endif
+	return mio;
+}
+
+/* The snapshots of the contents parsed last by the requests having
+ * "incremental", keyed by the file names */
+static hashTable *InteractiveSnapshots;
+
+/* Makes tags for the lines of MIO, the contents of FILENAME, changed by
+ * EDIT, or for the whole contents if EDIT is NULL. */
+static void generateTagsIncrementally (const char *filename, MIO *mio,
+									   const lineEdit *edit, tagDelta *delta)
+{
+	parseSnapshot *snapshot;
+
+	if (! InteractiveSnapshots)
+		InteractiveSnapshots = hashTableNew (7, hashCstrhash, hashCstreq,
+											 eFree, (void (*) (void *)) parseSnapshotDelete);
+
+	snapshot = hashTableGetItem (InteractiveSnapshots, filename);
+	if (! snapshot)
+	{
+		snapshot = parseSnapshotNew ();
+		hashTablePutItem (InteractiveSnapshots, eStrdup (filename), snapshot);
+	}
+	parseFileWithMioIncrementally (filename, mio, snapshot, edit, delta);
+}
+
+/* Tells the client of a request with "stream" to drop the tags sent for
+ * the request; they are sent again. */
+static void printRetracted (void)
+{
+	fputs ("{\"_type\": \"retracted\", \"command\": \"generate-tags\"}\n", stdout);
+	fflush (stdout);
+}
+
+/* DELTA is given for a request parsed incrementally. */
+static void printCompleted (const char *command, json_t *id, bool cancelled,
+							const tagDelta *delta)
+{
+	json_t *response = json_object ();
+
+	json_object_set_new (response, "_type", json_string ("completed"));
+	json_object_set_new (response, "command", json_string (command));
+	if (id)
+		json_object_set (response, "id", id);
+	if (cancelled)
+		json_object_set_new (response, "cancelled", json_true ());
+	else if (delta && (delta->startLine > 1 || delta->endLine > 0))
+	{
+		json_t *d = json_object ();
+
+		json_object_set_new (d, "startLine", json_integer (delta->startLine));
+		if (delta->endLine > 0)
+		{
+			json_object_set_new (d, "endLine", json_integer (delta->endLine));
+			json_object_set_new (d, "previousEndLine",
+								 json_integer (delta->previousEndLine));
+		}
+		json_object_set_new (d, "lineShift", json_integer (delta->lineShift));
+		json_object_set_new (response, "delta", d);
+	}
+	json_dumpf (response, stdout, JSON_PRESERVE_ORDER);
+	fputs ("\n", stdout);
+	fflush (stdout);
+	json_decref (response);
+}
+
+#ifdef USE_INTERACTIVE_WORKERS
+/* With --jobs, a generate-tags request having "id" is run in a worker
+ * process. The parent process keeps reading requests while the workers
+ * run, and writes the output of a worker followed by its completed
+ * object when the worker finishes, so the requests complete out of
+ * order. The pending requests with larger "priority" start first.
+ * A cancel request kills the worker running the request. */
+typedef struct {
+	json_t *id;
+	json_int_t priority;
+	json_int_t deadline;
+	char *filename;
+	MIO *mio;		/* NULL for reading the file from disk */
+	pid_t pid;
+	int fd;
+	vString *output;
+	bool cancelled;
+} interactiveJob;
+
+/* The exit status of a worker stopped by the deadline */
+#define JOB_CANCELLED 2
+
+static ptrArray *PendingJobs;
+static ptrArray *RunningJobs;
+
+static void deleteInteractiveJob (void *data)
+{
+	interactiveJob *job = data;
+
+	json_decref (job->id);
+	eFree (job->filename);
+	if (job->mio)
+		mio_unref (job->mio);
+	vStringDelete (job->output);
+	eFree (job);
+}
+
+static void queueInteractiveJob (json_t *id, json_int_t priority,
+								 json_int_t deadline,
+								 const char *filename, MIO *mio)
+{
+	interactiveJob *job = xMalloc (1, interactiveJob);
+
+	job->id = json_incref (id);
+	job->priority = priority;
+	job->deadline = deadline;
+	job->cancelled = false;
+	job->filename = eStrdup (filename);
+	job->mio = mio;
+	job->pid = -1;
+	job->fd = -1;
+	job->output = vStringNew ();
+	ptrArrayAdd (PendingJobs, job);
+}
+
+static void runInteractiveJob (interactiveJob *job, int fd)
+{
+	if (dup2 (fd, STDOUT_FILENO) == -1)
+		_exit (1);
+	close (fd);
+
+	openTagFile ();
+	setInputDeadline (job->deadline);
+	if (job->mio)
+		parseFileWithMio (job->filename, job->mio, NULL);
+	else
+		createTagsForEntry (job->filename);
+	if (isInputCancelled ())
+		_exit (JOB_CANCELLED);
+	closeTagFile (false);
+	fflush (stdout);
+	_exit (0);
+}
+
+static void startInteractiveJobs (void)
+{
+	while (ptrArrayCount (RunningJobs) < Option.jobs
+		   && ptrArrayCount (PendingJobs) > 0)
+	{
+		unsigned int next = 0;
+		interactiveJob *job;
+		int fds [2];
+
+		/* The first one of the highest priority */
+		for (unsigned int i = 1; i < ptrArrayCount (PendingJobs); i++)
+		{
+			interactiveJob *j = ptrArrayItem (PendingJobs, i);
+			interactiveJob *n = ptrArrayItem (PendingJobs, next);
+			if (j->priority > n->priority)
+				next = i;
+		}
+		job = ptrArrayRemoveItem (PendingJobs, next);
+
+		if (pipe (fds) != 0)
+			error (FATAL | PERROR, "cannot make a pipe for worker process");
+
+		/* Don't let the worker write the buffered data again. */
+		fflush (stdout);
+		job->pid = fork ();
+		if (job->pid == -1)
+			error (FATAL | PERROR, "cannot fork worker process");
+		else if (job->pid == 0)
+		{
+			close (fds [0]);
+			runInteractiveJob (job, fds [1]);
+		}
+		close (fds [1]);
+		job->fd = fds [0];
+		if (job->mio)
+		{
+			mio_unref (job->mio);
+			job->mio = NULL;
+		}
+		ptrArrayAdd (RunningJobs, job);
+	}
+}
+
+static void finishInteractiveJob (interactiveJob *job)
+{
+	int status;
+
+	close (job->fd);
+	while (waitpid (job->pid, &status, 0) == -1 && errno == EINTR)
+		;
+
+	if (WIFEXITED (status) && WEXITSTATUS (status) == JOB_CANCELLED)
+		job->cancelled = true;
+	if (job->cancelled)
+	{
+		printCompleted ("generate-tags", job->id, true, NULL);
+		return;
+	}
+
+	fwrite (vStringValue (job->output), 1, vStringLength (job->output), stdout);
+	if (!WIFEXITED (status) || WEXITSTATUS (status) != 0)
+		error (WARNING, "worker process for \"%s\" failed", job->filename);
+	printCompleted ("generate-tags", job->id, false, NULL);
+}
+
+static void cancelInteractiveJob (json_t *id)
+{
+	for (unsigned int i = 0; i < ptrArrayCount (PendingJobs); i++)
+	{
+		interactiveJob *job = ptrArrayItem (PendingJobs, i);
+		if (json_equal (job->id, id))
+		{
+			printCompleted ("generate-tags", job->id, true, NULL);
+			ptrArrayDeleteItem (PendingJobs, i);
+			return;
+		}
+	}
+
+	for (unsigned int i = 0; i < ptrArrayCount (RunningJobs); i++)
+	{
+		interactiveJob *job = ptrArrayItem (RunningJobs, i);
+		if (json_equal (job->id, id) && ! job->cancelled)
+		{
+			/* The completed object is written when the pipe is closed. */
+			kill (job->pid, SIGKILL);
+			job->cancelled = true;
+			return;
+		}
+	}
+
+	error (WARNING, "no request to cancel");
+}
+
+/* Waits for a worker finishing or a request coming. Returns true if
+ * stdin is readable. */
+static bool waitInteractiveJobs (bool stdinOpen)
+{
+	const unsigned int count = ptrArrayCount (RunningJobs);
+	struct pollfd *fds = xMalloc (count + 1, struct pollfd);
+	bool stdinReady;
+	int n;
+
+	for (unsigned int i = 0; i < count; i++)
+	{
+		interactiveJob *job = ptrArrayItem (RunningJobs, i);
+		fds [i].fd = job->fd;
+		fds [i].events = POLLIN;
+		fds [i].revents = 0;
+	}
+	fds [count].fd = stdinOpen? STDIN_FILENO: -1;
+	fds [count].events = POLLIN;
+	fds [count].revents = 0;
+
+	do
+		n = poll (fds, count + 1, -1);
+	while (n < 0 && errno == EINTR);
+	if (n < 0)
+		error (FATAL | PERROR, "failed to wait for worker processes");
+
+	for (unsigned int i = count; i > 0; i--)
+	{
+		interactiveJob *job = ptrArrayItem (RunningJobs, i - 1);
+		char buf [4096];
+		ssize_t r;
+
+		if (fds [i - 1].revents == 0)
+			continue;
+
+		r = read (job->fd, buf, sizeof (buf));
+		if (r > 0)
+			vStringNCatS (job->output, buf, (size_t) r);
+		else if (r == 0 || errno != EINTR)
+		{
+			finishInteractiveJob (job);
+			ptrArrayDeleteItem (RunningJobs, i - 1);
+		}
+	}
+
+	stdinReady = (fds [count].revents != 0);
+	eFree (fds);
+	return stdinReady;
+}
+#endif
+
+static void skipInteractiveInput (json_int_t size)
+{
+	while (size-- > 0 && getc (stdin) != EOF)
+		;
+}
+
+/* Handles a generate-tags-batch request. The request has "files", an
+ * array of the objects taking the same arguments as a generate-tags
+ * request. The contents of the files with "size" follow the request in
+ * the order of the array. The tags of all the files are written to one
+ * tag file, and a request is completed once. */
+static void generateTagsBatch (json_t *request, struct interactiveModeArgs *iargs)
+{
+	json_t *files = json_object_get (request, "files");
+	const char *message = NULL;
+	size_t count;
+
+	if (! json_is_array (files))
+	{
+		error (FATAL, "invalid generate-tags-batch request");
+		return;
+	}
+	count = json_array_size (files);
+
+	/* Check all the files before parsing any of them. */
+	for (size_t i = 0; i < count; i++)
+	{
+		json_t *file = json_array_get (files, i);
+		json_int_t size = -1;
+		const char *filename;
+
+		if (json_unpack (file, "{ss}", "filename", &filename) == -1)
+			message = "invalid generate-tags-batch request";
+		json_unpack (file, "{sI}", "size", &size);
+		if (size < -1)
+			message = "invalid generate-tags-batch request";
+		else if (size == -1 && iargs->sandbox && message == NULL)
+			message = "invalid request in sandbox submode: reading file contents from a file is limited";
+	}
+
+	if (message)
+	{
+		/* Don't take the contents for a request. */
+		for (size_t i = 0; i < count; i++)
+		{
+			json_int_t size = -1;
+			json_unpack (json_array_get (files, i), "{sI}", "size", &size);
+			skipInteractiveInput (size);
+		}
+		error (FATAL, "%s", message);
+		return;
+	}
+
+	openTagFile ();
+	for (size_t i = 0; i < count; i++)
+	{
+		json_t *file = json_array_get (files, i);
+		json_int_t size = -1;
+		const char *filename;
+
+		json_unpack (file, "{ss}", "filename", &filename);
+		json_unpack (file, "{sI}", "size", &size);
+		if (size == -1)
+			createTagsForEntry (filename);
+		else
+			generateTagsForStream (filename, size);
+	}
+	closeTagFile (false);
+	fprintf (stdout, "{\"_type\": \"completed\", \"command\": \"generate-tags-batch\", \"files\": %lu}\n",
+			 (unsigned long) count);
+	fflush(stdout);
+}
+
+static void handleInteractiveRequest (json_t *request,
+									  struct interactiveModeArgs *iargs)
+{
+	json_t *command = json_object_get (request, "command");
+	if (! command)
+	{
+		error (FATAL, "command name not found");
+		return;
+	}
+
+	if (!strcmp ("generate-tags", json_string_value (command)))
+	{
+		json_int_t size = -1;
+		json_int_t deadline = 0;
+		int incremental = 0;
+		int stream = 0;
+		json_int_t line = 0, removed = 0, added = 0;
+		const char *filename;
+		MIOPos pos;
+		unsigned long numTags;
+		bool cancelled;
+		lineEdit edit;
+		tagDelta delta;
+		MIO *mio = NULL;
+
+		if (json_unpack (request, "{ss}", "filename", &filename) == -1)
+		{
+			error (FATAL, "invalid generate-tags request");
+			return;
+		}
+
+		json_unpack (request, "{sI}", "size", &size);
+		json_unpack (request, "{sI}", "deadline", &deadline);
+		if (deadline < 0)
+			deadline = 0;
+
+		/* The contents are given inline or with a descriptor. */
+		if (size != -1 || json_object_get (request, "fd"))
+		{
+			mio = openInteractiveInput (request, size);
+			if (! mio)
+			{
+				error (FATAL, "cannot read the contents of \"%s\" from the descriptor",
+					   filename);
+				return;
+			}
+		}
+
+		/* The snapshot of the contents is kept in this process. */
+		json_unpack (request, "{sb}", "incremental", &incremental);
+		if (! mio)
+			incremental = 0;
+		if (incremental
+			&& json_unpack (request, "{s{sIsIsI}}", "edit",
+							"line", &line, "removed", &removed, "added", &added) == 0
+			&& line > 0 && removed >= 0 && added >= 0)
+		{
+			edit.line = line;
+			edit.removed = removed;
+			edit.added = added;
+		}
+		else
+			line = 0;
+
+		/* The output of a worker process is written when it finishes. */
+		json_unpack (request, "{sb}", "stream", &stream);
+
+		json_t *id = json_object_get (request, "id");
+#ifdef USE_INTERACTIVE_WORKERS
+		if (id && PendingJobs && ! incremental && ! stream)
+		{
+			json_int_t priority = 0;
+
+			json_unpack (request, "{sI}", "priority", &priority);
+			queueInteractiveJob (id, priority, deadline, filename, mio);
+			return;
+		}
+#endif
+
+		openTagFile ();
+		if (stream)
+			startTagFileStream (printRetracted);
+		tagFilePosition (&pos);
+		numTags = numTagsAdded ();
+		setInputDeadline (deadline);
+		if (! mio)
+		{					/* read from disk */
+			if (iargs->sandbox) {
+				error (FATAL,
+					   "invalid request in sandbox submode: reading file contents from a file is limited");
+				setInputDeadline (0);
+				closeTagFile (false);
+				return;
+			}
+
+			createTagsForEntry (filename);
+		}
+		else
+		{
+			if (incremental)
+				generateTagsIncrementally (filename, mio, line? &edit: NULL, &delta);
+			else
+				parseFileWithMio (filename, mio, NULL);
+			mio_unref (mio);
+		}
+
+		/* Don't write the tags of the part parsed before the deadline. */
+		cancelled = isInputCancelled ();
+		if (cancelled)
+		{
+			setTagFilePosition (&pos, true);
+			setNumTagsAdded (numTags);
+			/* The snapshot is of the contents not tagged. */
+			if (incremental)
+				hashTableDeleteItem (InteractiveSnapshots, filename);
+		}
+		setInputDeadline (0);
+
+		closeTagFile (false);
+		printCompleted ("generate-tags", id, cancelled, incremental? &delta: NULL);
+	}
+	else if (!strcmp ("cancel", json_string_value (command)))
+	{
+		json_t *id = json_object_get (request, "id");
+
+		if (! id)
+		{
+			error (FATAL, "invalid cancel request");
+			return;
+		}
+#ifdef USE_INTERACTIVE_WORKERS
+		if (PendingJobs)
+		{
+			cancelInteractiveJob (id);
+			return;
+		}
+#endif
+		error (WARNING, "no request to cancel");
+	}
+	else if (!strcmp ("generate-tags-batch", json_string_value (command)))
+		generateTagsBatch (request, iargs);
+	else if (!strcmp ("stats", json_string_value (command)))
+	{
+		printStatisticsCounters (stdout);
+		fflush(stdout);
+	}
+	else if (!strcmp ("watch", json_string_value (command)))
+	{
+		json_int_t delay = 100;
+		const char *directory;
+
+		if (json_unpack (request, "{ss}", "directory", &directory) == -1)
+		{
+			error (FATAL, "invalid watch request");
+			return;
+		}
+
+		json_unpack (request, "{sI}", "delay", &delay);
+		if (delay < 0)
+			delay = 0;
+
+		if (iargs->sandbox) {
+			error (FATAL,
+				   "invalid request in sandbox submode: watching files is limited");
+			return;
+		}
+
+		/* Returns when the next request arrives. */
+		openTagFile ();
+		if (! watchDirectory (directory, (unsigned int) delay, stdout))
+			error (FATAL, "watch is not supported on this platform");
+		closeTagFile (false);
+		fputs ("{\"_type\": \"completed\", \"command\": \"watch\"}\n", stdout);
+		fflush(stdout);
+	}
+	else
+	{
+		error (FATAL, "unknown command name");
+		return;
+	}
+}
+
 void interactiveLoop (cookedArgs *args CTAGS_ATTR_UNUSED, void *user)
 {
 	struct interactiveModeArgs *iargs = user;
@@ -412,78 +1391,84 @@ void interactiveLoop (cookedArgs *args CTAGS_ATTR_UNUSED, void *user)
 		}
 	}
 
-	char buffer[1024];
+	vString *buffer = vStringNew ();
 	json_t *request;
 
+	/* For the stats command */
+	startFileStatistics (true);
+
+#ifdef USE_INTERACTIVE_FD_PASSING
+	{
+		struct stat st;
+
+		StdinIsSocket = (fstat (STDIN_FILENO, &st) == 0 && S_ISSOCK (st.st_mode));
+		if (StdinIsSocket)
+			setvbuf (stdin, NULL, _IONBF, 0);
+	}
+#endif
+
 	fputs ("{\"_type\": \"program\", \"name\": \"" PROGRAM_NAME "\", \"version\": \"" PROGRAM_VERSION "\"}\n", stdout);
 	fflush (stdout);
 
-	while (fgets (buffer, sizeof(buffer), stdin))
+#ifdef USE_INTERACTIVE_WORKERS
+	bool stdinOpen = true;
+
+	if (Option.jobs > 1 && ! iargs->sandbox)
 	{
-		if (buffer[0] == '\n')
-			continue;
+		PendingJobs = ptrArrayNew (deleteInteractiveJob);
+		RunningJobs = ptrArrayNew (deleteInteractiveJob);
+		/* poll () can see only the input not buffered yet. */
+		setvbuf (stdin, NULL, _IONBF, 0);
+	}
+#endif
 
-		request = json_loads (buffer, JSON_DISABLE_EOF_CHECK, NULL);
-		if (! request)
+	while (true)
+	{
+#ifdef USE_INTERACTIVE_WORKERS
+		if (PendingJobs)
 		{
-			error (FATAL, "invalid json");
-			goto next;
+			startInteractiveJobs ();
+			if (ptrArrayCount (RunningJobs) > 0
+				&& ! waitInteractiveJobs (stdinOpen))
+				continue;
+			if (! stdinOpen)
+				break;
 		}
-
-		json_t *command = json_object_get (request, "command");
-		if (! command)
+#endif
+		if (! readInteractiveRequest (buffer))
 		{
-			error (FATAL, "command name not found");
-			goto next;
+#ifdef USE_INTERACTIVE_WORKERS
+			stdinOpen = false;
+			if (PendingJobs)
+				continue;
+#endif
+			break;
 		}
 
-		if (!strcmp ("generate-tags", json_string_value (command)))
-		{
-			json_int_t size = -1;
-			const char *filename;
-
-			if (json_unpack (request, "{ss}", "filename", &filename) == -1)
-			{
-				error (FATAL, "invalid generate-tags request");
-				goto next;
-			}
-
-			json_unpack (request, "{sI}", "size", &size);
-
-			openTagFile ();
-			if (size == -1)
-			{					/* read from disk */
-				if (iargs->sandbox) {
-					error (FATAL,
-						   "invalid request in sandbox submode: reading file contents from a file is limited");
-					closeTagFile (false);
-					goto next;
-				}
-
-				createTagsForEntry (filename);
-			}
-			else
-			{					/* read nbytes from stream */
-				unsigned char *data = eMalloc (size);
-				size = fread (data, 1, size, stdin);
-				MIO *mio = mio_new_memory (data, size, eRealloc, eFreeNoNullCheck);
-				parseFileWithMio (filename, mio, NULL);
-				mio_unref (mio);
-			}
-
-			closeTagFile (false);
-			fputs ("{\"_type\": \"completed\", \"command\": \"generate-tags\"}\n", stdout);
-			fflush(stdout);
-		}
-		else
+		request = json_loadb (vStringValue (buffer), vStringLength (buffer),
+							  JSON_DISABLE_EOF_CHECK, NULL);
+		if (! request)
 		{
-			error (FATAL, "unknown command name");
-			goto next;
+			error (FATAL, "invalid json");
+			continue;
 		}
-
-	next:
+		handleInteractiveRequest (request, iargs);
 		json_decref (request);
 	}
+	vStringDelete (buffer);
+	if (InteractiveSnapshots)
+	{
+		hashTableDelete (InteractiveSnapshots);
+		InteractiveSnapshots = NULL;
+	}
+#ifdef USE_INTERACTIVE_WORKERS
+	if (PendingJobs)
+	{
+		ptrArrayDelete (PendingJobs);
+		ptrArrayDelete (RunningJobs);
+		PendingJobs = RunningJobs = NULL;
+	}
+#endif
 }
 #endif
 
@@ -18,5 +18,6 @@
 *   FUNCTION PROTOTYPES
 */
 extern int ctags_cli_main (int argc, char **argv);
+extern bool createTagsForEntry (const char *const entryName);
 
 #endif  /* CTAGS_MAIN_MAIN_PRIVATE_H */
@@ -30,6 +30,45 @@
 
 static iconv_t iconv_fd = (iconv_t) -1;
 
+/* true if the converter maps every 7-bit byte to itself; then a string
+ * without any high-bit byte can be passed through without iconv. */
+static bool asciiTransparent;
+
+/* Destination buffer reused across convertString () calls. */
+static char  *convBuffer;
+static size_t convBufferSize;
+
+static bool isAsciiTransparent (void)
+{
+	char src [0x80], dest [0x80 * 4];
+	char *src_ptr = src, *dest_ptr = dest;
+	size_t src_len = sizeof (src) - 1, dest_len = sizeof (dest);
+	bool r;
+
+	for (int i = 1; i < 0x80; i++)
+		src [i - 1] = (char) i;
+
+	r = (iconv (iconv_fd, &src_ptr, &src_len, &dest_ptr, &dest_len) != (size_t) -1
+		 && src_len == 0
+		 && (size_t) (dest_ptr - dest) == sizeof (src) - 1
+		 && memcmp (src, dest, sizeof (src) - 1) == 0);
+	iconv (iconv_fd, NULL, NULL, NULL, NULL);
+	return r;
+}
+
+/* ISO-2022 family encodings switch character sets with ESC, SO and SI;
+ * glibc passes a lone ESC through, so the probe above cannot catch them. */
+static bool mayNeedConversion (const vString *const string)
+{
+	const unsigned char *p = (const unsigned char *) vStringValue (string);
+	const unsigned char *const end = p + vStringLength (string);
+
+	for (; p < end; p++)
+		if ((*p & 0x80) || *p == 0x1b || *p == 0x0e || *p == 0x0f)
+			return true;
+	return false;
+}
+
 extern bool openConverter (const char* inputEncoding, const char* outputEncoding)
 {
 	if (!inputEncoding || !outputEncoding)
@@ -50,6 +89,7 @@ extern bool openConverter (const char* inputEncoding, const char* outputEncoding
 					"failed opening encoding from '%s' to '%s'", inputEncoding, outputEncoding);
 		return false;
 	}
+	asciiTransparent = isAsciiTransparent ();
 	return true;
 }
 
@@ -64,12 +104,17 @@ extern bool convertString (vString *const string)
 	char *dest, *dest_ptr, *src;
 	if (iconv_fd == (iconv_t) -1)
 		return false;
+	if (asciiTransparent && !mayNeedConversion (string))
+		return true;
 	src_len = vStringLength (string);
 	/* Should be longest length of bytes. so maybe utf8. */
 	dest_len = src_len * 4;
-	dest_ptr = dest = xCalloc (dest_len, char);
-	if (!dest)
-		return false;
+	if (convBufferSize < dest_len + 1)
+	{
+		convBufferSize = dest_len + 1;
+		convBuffer = xRealloc (convBuffer, convBufferSize, char);
+	}
+	dest_ptr = dest = convBuffer;
 	src = vStringValue (string);
 retry:
 	if (iconv (iconv_fd, &src, &src_len, &dest_ptr, &dest_len) == (size_t) -1)
@@ -83,18 +128,18 @@ retry:
 			verbose ("  Encoding: %s\n", strerror(errno));
 			goto retry;
 		}
-		eFree (dest);
+		iconv (iconv_fd, NULL, NULL, NULL, NULL);
 		return false;
 	}
 
 	dest_len = dest_ptr - dest;
+	*dest_ptr = '\0';
 
 	vStringClear (string);
 	if (vStringSize (string) < dest_len + 1)
 		vStringResize (string, dest_len + 1);
 	memcpy (vStringValue (string), dest, dest_len + 1);
 	vStringLength (string) = dest_len;
-	eFree (dest);
 
 	iconv (iconv_fd, NULL, NULL, NULL, NULL);
 
@@ -108,6 +153,12 @@ extern void closeConverter ()
 		iconv_close(iconv_fd);
 		iconv_fd = (iconv_t) -1;
 	}
+	if (convBuffer)
+	{
+		eFree (convBuffer);
+		convBuffer = NULL;
+		convBufferSize = 0;
+	}
 }
 
 #endif	/* HAVE_ICONV */
@@ -361,6 +361,30 @@ extern int main (int argc, char **argv)
 		parseRawBuffer("whatever", (unsigned char *)program, strlen(program), lang, tagArray);
 
 		processCollectedTags(tagArray);
+
+		/* a buffer being edited is parsed again and again through a session
+		 * keeping its language, parser and output */
+		char *edited = "FOO int foo() {}\n\n int baz() {}\n";
+		parserSession *session = parserSessionNew("whatever", lang, tagArray);
+
+		printf("\nParsing buffer in a session:\n");
+		parserSessionParse(session, (unsigned char *)program, strlen(program));
+		processCollectedTags(tagArray);
+
+		/* the lines 3-5 are replaced with a line; only the declarations
+		 * around the edit are parsed again */
+		lineEdit edit = { .line = 3, .removed = 3, .added = 1 };
+		tagDelta delta;
+
+		printf("\nParsing edited buffer in the session:\n");
+		parserSessionParseEdit(session, (unsigned char *)edited, strlen(edited), &edit, &delta);
+		if (delta.previousEndLine > 0)
+			printf("replacing the tags in lines %lu-%lu\n", delta.startLine, delta.previousEndLine);
+		else
+			printf("replacing the tags from line %lu\n", delta.startLine);
+		processCollectedTags(tagArray);
+
+		parserSessionDelete(session);
 	}
 	else  /* parsing contents of a file */
 	{
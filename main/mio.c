@@ -48,6 +48,13 @@
 #include <unistd.h>
 #endif
 
+#if defined (HAVE_MMAP) && defined (HAVE_SYS_MMAN_H)
+#define MIO_USE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
 #ifdef READTAGS_DSL
 #define xMalloc(n,Type)    (Type *)eMalloc((size_t)(n) * sizeof (Type))
 #define xRealloc(p,n,Type) (Type *)eRealloc((p), (n) * sizeof (Type))
@@ -107,8 +114,8 @@ static void eFree (void *const ptr)
  * file based operations and in-memory operations. Its goal is to ease the port
  * of an application that uses C file I/O API to perform in-memory operations.
  *
- * A #MIO object is created using mio_new_file(), mio_new_memory() or mio_new_mio(),
- * depending on whether you want file or in-memory operations.
+ * A #MIO object is created using mio_new_file(), mio_new_memory(), mio_new_mmap()
+ * or mio_new_mio(), depending on whether you want file or in-memory operations.
  * Its life is managed by reference counting. Just after calling one of functions
  * for creating, the count is 1. mio_ref() increments the counter. mio_unref()
  * decrements it. When the counter becomes 0, the #MIO object will be destroyed
@@ -146,6 +153,7 @@ struct _MIO {
 		struct {
 			FILE *fp;
 			MIOFCloseFunc close_func;
+			char *buf;	/* given with mio_file_set_buffer_size() */
 		} file;
 		struct {
 			unsigned char *buf;
@@ -155,6 +163,12 @@ struct _MIO {
 			size_t allocated_size;
 			MIOReallocFunc realloc_func;
 			MIODestroyNotify free_func;
+			size_t mapped_size;	/* != 0 if buf is mapped by mio_new_mmap() */
+#ifdef MIO_USE_MMAP
+			int mapped_fd;	/* duplicate of the mapped descriptor, or -1 */
+			time_t mapped_mtime;
+			bool mapped_sealed;	/* the mapped file can neither shrink nor change */
+#endif
 			bool error;
 			bool eof;
 		} mem;
@@ -213,6 +227,7 @@ MIO *mio_new_file_full (const char *filename,
 			mio->type = MIO_TYPE_FILE;
 			mio->impl.file.fp = fp;
 			mio->impl.file.close_func = close_func;
+			mio->impl.file.buf = NULL;
 			mio->refcount = 1;
 			mio->udata.d = NULL;
 			mio->udata.f = NULL;
@@ -274,6 +289,7 @@ MIO *mio_new_fp (FILE *fp, MIOFCloseFunc close_func)
 		mio->type = MIO_TYPE_FILE;
 		mio->impl.file.fp = fp;
 		mio->impl.file.close_func = close_func;
+		mio->impl.file.buf = NULL;
 		mio->refcount = 1;
 		mio->udata.d = NULL;
 		mio->udata.f = NULL;
@@ -336,6 +352,11 @@ MIO *mio_new_memory (unsigned char *data,
 		mio->impl.mem.allocated_size = size;
 		mio->impl.mem.realloc_func = realloc_func;
 		mio->impl.mem.free_func = free_func;
+		mio->impl.mem.mapped_size = 0;
+#ifdef MIO_USE_MMAP
+		mio->impl.mem.mapped_fd = -1;
+		mio->impl.mem.mapped_sealed = false;
+#endif
 		mio->impl.mem.eof = false;
 		mio->impl.mem.error = false;
 		mio->refcount = 1;
@@ -346,6 +367,171 @@ MIO *mio_new_memory (unsigned char *data,
 	return mio;
 }
 
+/**
+ * mio_fd_is_sealed:
+ * @fd: A file descriptor
+ *
+ * Returns: %true if @fd is sealed with F_SEAL_SHRINK and F_SEAL_WRITE, so
+ *          its contents can neither shrink nor change, or %false otherwise
+ *          or if sealing is not supported on the platform.
+ */
+bool mio_fd_is_sealed (int fd)
+{
+#if defined (F_GET_SEALS) && defined (F_SEAL_SHRINK) && defined (F_SEAL_WRITE)
+	int seals = fcntl (fd, F_GET_SEALS);
+
+	return seals != -1
+		&& (seals & (F_SEAL_SHRINK | F_SEAL_WRITE)) == (F_SEAL_SHRINK | F_SEAL_WRITE);
+#else
+	return false;
+#endif
+}
+
+/**
+ * mio_new_mmap:
+ * @filename: Filename to open
+ *
+ * Creates a new #MIO object working on memory mapped from the regular file
+ * @filename. The stream works exactly the same as one created with
+ * mio_new_memory(); mio_memory_get_data() returns the mapped data.
+ *
+ * The mapping is private: writing to the stream never modifies the file,
+ * and the buffer cannot grow. mio_unref() unmaps the data.
+ *
+ * If the file gets shorter while it is mapped, reading the bytes past its
+ * new end raises SIGBUS. Use this only for files that don't change.
+ *
+ * Free-function: mio_unref()
+ *
+ * Returns: A new #MIO on success, or %NULL if @filename is not a non-empty
+ *          regular file, if it cannot be mapped, or if memory mapping is not
+ *          supported on the platform.
+ */
+MIO *mio_new_mmap (const char *filename)
+{
+#ifdef MIO_USE_MMAP
+	MIO *mio;
+	int fd;
+
+	fd = open (filename, O_RDONLY);
+	if (fd < 0)
+		return NULL;
+
+	mio = mio_new_mmap_fd (fd, 0);
+	close (fd);
+	return mio;
+#else
+	return NULL;
+#endif
+}
+
+/**
+ * mio_new_mmap_fd:
+ * @fd: A file descriptor of a regular file or a shared memory object
+ * @size: The number of bytes to map, or 0 for the whole file
+ *
+ * Creates a new #MIO object working on memory mapped from @fd, like
+ * mio_new_mmap(). @size must not be larger than the file. @fd is not
+ * closed; the mapping stays valid after closing it.
+ *
+ * Free-function: mio_unref()
+ *
+ * Returns: A new #MIO on success, or %NULL if @fd is not a non-empty
+ *          regular file large enough, if it cannot be mapped, or if memory
+ *          mapping is not supported on the platform.
+ */
+MIO *mio_new_mmap_fd (int fd, size_t size)
+{
+#ifdef MIO_USE_MMAP
+	MIO *mio;
+	struct stat st;
+	void *data;
+
+	if (fstat (fd, &st) != 0 || !S_ISREG (st.st_mode) || st.st_size <= 0
+		|| (size_t) st.st_size < size)
+		return NULL;
+	if (size == 0)
+		size = (size_t) st.st_size;
+
+	data = mmap (NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+	if (data == MAP_FAILED)
+		return NULL;
+
+	mio = mio_new_memory (data, size, NULL, NULL);
+	if (mio == NULL)
+	{
+		munmap (data, size);
+		return NULL;
+	}
+	mio->impl.mem.mapped_size = size;
+	mio->impl.mem.mapped_sealed = mio_fd_is_sealed (fd);
+	if (!mio->impl.mem.mapped_sealed)
+	{
+		/* Kept for mio_memory_release() to check the file. */
+		mio->impl.mem.mapped_fd = dup (fd);
+		mio->impl.mem.mapped_mtime = st.st_mtime;
+	}
+
+	return mio;
+#else
+	return NULL;
+#endif
+}
+
+/**
+ * mio_new_fd:
+ * @fd: A file descriptor of a regular file or a shared memory object
+ * @size: The number of bytes to read, or 0 for the whole file
+ *
+ * Creates a new memory #MIO object on the contents of @fd. If @fd is
+ * sealed (see mio_fd_is_sealed()), they are mapped with mio_new_mmap_fd();
+ * otherwise they are copied into a buffer, so the process is not hurt
+ * when the owner of @fd truncates or writes it. @fd is not closed, and
+ * its file offset is not changed.
+ *
+ * Free-function: mio_unref()
+ *
+ * Returns: A new #MIO on success, or %NULL if @fd is not a non-empty
+ *          regular file large enough, if it cannot be read, or if it is not
+ *          supported on the platform.
+ */
+MIO *mio_new_fd (int fd, size_t size)
+{
+#ifdef MIO_USE_MMAP
+	struct stat st;
+	unsigned char *data;
+	size_t done = 0;
+
+	if (mio_fd_is_sealed (fd))
+		return mio_new_mmap_fd (fd, size);
+
+	if (fstat (fd, &st) != 0 || !S_ISREG (st.st_mode) || st.st_size <= 0
+		|| (size_t) st.st_size < size)
+		return NULL;
+	if (size == 0)
+		size = (size_t) st.st_size;
+
+	data = xMalloc (size, unsigned char);
+	while (done < size)
+	{
+		ssize_t n = pread (fd, data + done, size - done, (off_t) done);
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n <= 0)
+		{
+			/* Truncated while reading it. */
+			eFree (data);
+			return NULL;
+		}
+		done += (size_t) n;
+	}
+
+	return mio_new_memory (data, size, eRealloc, eFreeNoNullCheck);
+#else
+	return NULL;
+#endif
+}
+
 /**
  * mio_new_mio:
  * @base: The original mio
@@ -444,6 +630,39 @@ FILE *mio_file_get_fp (MIO *mio)
 	return fp;
 }
 
+/**
+ * mio_file_set_buffer_size:
+ * @mio: A #MIO file stream
+ * @size: Size of the buffer in bytes
+ *
+ * Makes the #FILE of @mio fully buffered with a buffer of @size bytes,
+ * which is freed when @mio is destroyed. Writing a large file through a
+ * large buffer takes fewer write() calls than the default buffer of the
+ * C library. This must be called before any I/O on @mio.
+ *
+ * Returns: 0 on success, -1 if @mio is not a file stream closed by the
+ *          #MIO object, or if setvbuf() failed.
+ */
+int mio_file_set_buffer_size (MIO *mio, size_t size)
+{
+	char *buf;
+
+	/* The FILE must not outlive the buffer. */
+	if (mio->type != MIO_TYPE_FILE
+		|| mio->impl.file.close_func == NULL
+		|| mio->impl.file.buf != NULL)
+		return -1;
+
+	buf = xMalloc (size, char);
+	if (setvbuf (mio->impl.file.fp, buf, _IOFBF, size) != 0)
+	{
+		eFree (buf);
+		return -1;
+	}
+	mio->impl.file.buf = buf;
+	return 0;
+}
+
 /**
  * mio_memory_get_data:
  * @mio: A #MIO object
@@ -473,6 +692,46 @@ unsigned char *mio_memory_get_data (MIO *mio, size_t *size)
 	return ptr;
 }
 
+/**
+ * mio_memory_release:
+ * @mio: A #MIO object
+ * @size: The number of bytes from the start of the stream
+ *
+ * Tells that the first @size bytes of a stream created with mio_new_mmap()
+ * are not needed soon. The whole pages in them are dropped from the
+ * memory; reading them again maps them from the file again.
+ *
+ * The pages are dropped only if they would be mapped again with the same
+ * data: the file must be sealed against shrinking and writing, or have
+ * the size and modification time it had when it was mapped. Nothing is
+ * done for the other streams.
+ */
+void mio_memory_release (MIO *mio, size_t size)
+{
+#if defined (MIO_USE_MMAP) && defined (MADV_DONTNEED)
+	if (mio->type == MIO_TYPE_MEMORY && mio->impl.mem.mapped_size)
+	{
+		long page = sysconf (_SC_PAGESIZE);
+		struct stat st;
+
+		if (!mio->impl.mem.mapped_sealed
+			&& (mio->impl.mem.mapped_fd < 0
+				|| fstat (mio->impl.mem.mapped_fd, &st) != 0
+				|| st.st_size < 0
+				|| (size_t) st.st_size < mio->impl.mem.mapped_size
+				|| st.st_mtime != mio->impl.mem.mapped_mtime))
+			return;
+
+		if (size > mio->impl.mem.mapped_size)
+			size = mio->impl.mem.mapped_size;
+		if (page > 0)
+			size -= size % (size_t) page;
+		if (size > 0)
+			madvise (mio->impl.mem.buf, size, MADV_DONTNEED);
+	}
+#endif
+}
+
 /**
  * mio_unref:
  * @mio: A #MIO object
@@ -498,13 +757,24 @@ int mio_unref (MIO *mio)
 		{
 			if (mio->impl.file.close_func)
 				rv = mio->impl.file.close_func (mio->impl.file.fp);
+			if (mio->impl.file.buf)
+				eFree (mio->impl.file.buf);
 			mio->impl.file.close_func = NULL;
 			mio->impl.file.fp = NULL;
+			mio->impl.file.buf = NULL;
 		}
 		else if (mio->type == MIO_TYPE_MEMORY)
 		{
 			if (mio->impl.mem.free_func)
 				mio->impl.mem.free_func (mio->impl.mem.buf);
+#ifdef MIO_USE_MMAP
+			if (mio->impl.mem.mapped_size)
+				munmap (mio->impl.mem.buf, mio->impl.mem.mapped_size);
+			if (mio->impl.mem.mapped_fd >= 0)
+				close (mio->impl.mem.mapped_fd);
+			mio->impl.mem.mapped_size = 0;
+			mio->impl.mem.mapped_fd = -1;
+#endif
 			mio->impl.mem.buf = NULL;
 			mio->impl.mem.pos = 0;
 			mio->impl.mem.size = 0;
@@ -623,7 +893,10 @@ static int mem_try_resize (MIO *mio, size_t new_size)
 					size_t newsize;
 					unsigned char *newbuf;
 
-					newsize = MAX (mio->impl.mem.allocated_size + MIO_CHUNK_SIZE,
+					/* Grow geometrically so that writing a large stream
+					 * does not copy the buffer again and again. */
+					newsize = MAX (mio->impl.mem.allocated_size
+								   + MAX (MIO_CHUNK_SIZE, mio->impl.mem.allocated_size / 2),
 								   new_size);
 					newbuf = mio->impl.mem.realloc_func (mio->impl.mem.buf, newsize);
 					if (newbuf)
@@ -1013,17 +1286,25 @@ char *mio_gets (MIO *mio, char *s, size_t size)
 				mio->impl.mem.ungetch = EOF;
 				pos++;
 				i++;
+				if (s[0] == '\n')
+					newline = true;
 			}
-			for (; pos < buf_size && i < (size - 1); i++)
+			if (!newline && pos < buf_size && i < (size - 1))
 			{
-				s[i] = (char)buf[pos];
-				pos++;
-				if (s[i] == '\n')
+				size_t n = buf_size - pos;
+				unsigned char *nl;
+
+				if (n > size - 1 - i)
+					n = size - 1 - i;
+				nl = memchr (buf + pos, '\n', n);
+				if (nl)
 				{
-					i++;
+					n = (size_t)(nl - (buf + pos)) + 1;
 					newline = true;
-					break;
 				}
+				memcpy (s + i, buf + pos, n);
+				pos += n;
+				i += n;
 			}
 			if (i > 0)
 			{
@@ -1045,6 +1326,39 @@ char *mio_gets (MIO *mio, char *s, size_t size)
 	}
 }
 
+/**
+ * mio_memory_peek_line:
+ * @mio: A #MIO object
+ * @len: (out): Return location for the length of the line
+ *
+ * Finds the next line in the buffer of a #MIO memory stream without copying
+ * it nor moving the cursor. The line ends with a new-line character, which
+ * is counted in @len. Use mio_seek() with %SEEK_CUR to consume the line.
+ *
+ * Returns: A pointer to the line in the buffer of @mio, or %NULL if @mio is
+ *          not a memory stream, if a character pushed back with mio_ungetc()
+ *          is pending, or if no new-line character is found before the end of
+ *          the stream.
+ */
+const unsigned char *mio_memory_peek_line (MIO *mio, size_t *len)
+{
+	const unsigned char *line;
+	const unsigned char *nl;
+
+	if (mio->type != MIO_TYPE_MEMORY
+		|| mio->impl.mem.ungetch != EOF
+		|| mio->impl.mem.pos >= mio->impl.mem.size)
+		return NULL;
+
+	line = mio->impl.mem.buf + mio->impl.mem.pos;
+	nl = memchr (line, '\n', mio->impl.mem.size - mio->impl.mem.pos);
+	if (nl == NULL)
+		return NULL;
+
+	*len = (size_t)(nl - line) + 1;
+	return line;
+}
+
 /**
  * mio_clearerr:
  * @mio: A #MIO object
@@ -1294,6 +1608,35 @@ int mio_getpos (MIO *mio, MIOPos *pos)
 	return rv;
 }
 
+/**
+ * mio_memory_getpos_at:
+ * @mio: A #MIO memory stream
+ * @offset: An offset in the stream
+ * @pos: (out): A #MIOPos object to fill-in
+ *
+ * Fills @pos with the position mio_getpos() would store after seeking @mio
+ * to @offset, without moving the stream. This lets a caller keep bare offsets
+ * instead of #MIOPos objects for a memory stream.
+ *
+ * Returns: 0 on success, -1 if @mio is not a memory stream or @offset is
+ *          beyond its end.
+ */
+int mio_memory_getpos_at (MIO *mio, size_t offset, MIOPos *pos)
+{
+	if (mio->type != MIO_TYPE_MEMORY || offset > mio->impl.mem.size)
+		return -1;
+
+	/* The bytes of impl.file not covered by impl.mem are cleared so that
+	 * the positions of an offset compare equal with memcmp(). */
+	memset (pos, 0, sizeof (*pos));
+	pos->type = mio->type;
+	pos->impl.mem = offset;
+#ifdef MIO_DEBUG
+	pos->tag = mio;
+#endif
+	return 0;
+}
+
 /**
  * mio_setpos:
  * @mio: A #MIO object
@@ -122,13 +122,19 @@ MIO *mio_new_memory (unsigned char *data,
 					 size_t size,
 					 MIOReallocFunc realloc_func,
 					 MIODestroyNotify free_func);
+MIO *mio_new_mmap (const char *filename);
+MIO *mio_new_mmap_fd (int fd, size_t size);
+MIO *mio_new_fd (int fd, size_t size);
+bool mio_fd_is_sealed (int fd);
 
 MIO *mio_new_mio    (MIO *base, long start, long size);
 MIO *mio_ref        (MIO *mio);
 
 int mio_unref (MIO *mio);
 FILE *mio_file_get_fp (MIO *mio);
+int mio_file_set_buffer_size (MIO *mio, size_t size);
 unsigned char *mio_memory_get_data (MIO *mio, size_t *size);
+void mio_memory_release (MIO *mio, size_t size);
 size_t mio_read (MIO *mio,
 				 void *ptr,
 				 size_t size,
@@ -139,6 +145,7 @@ size_t mio_write (MIO *mio,
 				  size_t nmemb);
 int mio_getc (MIO *mio);
 char *mio_gets (MIO *mio, char *s, size_t size);
+const unsigned char *mio_memory_peek_line (MIO *mio, size_t *len);
 int mio_ungetc (MIO *mio, int ch);
 int mio_putc (MIO *mio, int c);
 int mio_puts (MIO *mio, const char *s);
@@ -153,6 +160,7 @@ int mio_seek (MIO *mio, long offset, int whence);
 long mio_tell (MIO *mio);
 void mio_rewind (MIO *mio);
 int mio_getpos (MIO *mio, MIOPos *pos);
+int mio_memory_getpos_at (MIO *mio, size_t offset, MIOPos *pos);
 int mio_setpos (MIO *mio, MIOPos *pos);
 int mio_flush (MIO *mio);
 
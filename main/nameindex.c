@@ -0,0 +1,157 @@
+/*
+*   Copyright (c) 2026, Universal Ctags Team
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License version 2 or (at your option) any later version.
+*
+*   This module implements --name-index option: writing a sparse index of
+*   the names in a sorted tag file.
+*
+*   A reader looking for a name in a sorted tag file does a binary search
+*   by seeking to byte offsets of the file. Each step seeks and skips a
+*   partial line, so a lookup in a large tag file costs tens of random
+*   reads. The name index records the name and the offset of the first
+*   tag line in each block of NAME_INDEX_BLOCK_SIZE bytes. A reader finds
+*   the block where a name can start in the index, and reads the tag file
+*   from the offset of the block with a single seek.
+*
+*   The index is written to the file made by appending NAME_INDEX_SUFFIX
+*   to the tag file name. The TAG_NAME_INDEX pseudo tag in the tag file
+*   refers to it. The format of the index file is:
+*
+*	!_CTAGS_NAME_INDEX<TAB>1<TAB>size<TAB>sorted
+*	offset<TAB>name
+*	offset<TAB>...
+*
+*   "size" is the size of the tag file, and "sorted" is the value of
+*   TAG_FILE_SORTED. A reader uses the index only if they match the tag
+*   file. "name" is the name as it is written in the tag line.
+*/
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"  /* must always come first */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "entry_p.h"
+#include "mio.h"
+#include "nameindex_p.h"
+#include "options_p.h"
+#include "ptag_p.h"
+#include "read.h"
+#include "routines.h"
+#include "vstring.h"
+
+/*
+*   DATA DECLARATIONS
+*/
+#define NAME_INDEX_MAGIC "!_CTAGS_NAME_INDEX"
+#define NAME_INDEX_VERSION 1
+#define NAME_INDEX_SUFFIX ".idx"
+#define NAME_INDEX_BLOCK_SIZE (64 * 1024)
+
+/*
+*   FUNCTION DEFINITIONS
+*/
+
+static bool writeIndexFile (MIO *const in, const char *const indexFileName)
+{
+	MIO *out = mio_new_file (indexFileName, "wb");
+	vString *line;
+	long size;
+	long next = 0;
+	bool ok;
+
+	if (out == NULL)
+		return false;
+
+	mio_seek (in, 0L, SEEK_END);
+	size = mio_tell (in);
+	mio_seek (in, 0L, SEEK_SET);
+
+	ok = (mio_printf (out, "%s\t%d\t%ld\t%d\n", NAME_INDEX_MAGIC,
+					  NAME_INDEX_VERSION, size, (int) Option.sorted) >= 0);
+
+	line = vStringNew ();
+	while (ok)
+	{
+		const long offset = mio_tell (in);
+		const char *l;
+		const char *tab;
+
+		if (readLineRaw (line, in) == NULL)
+			break;
+		if (offset < next)
+			continue;
+
+		l = vStringValue (line);
+		if (strncmp (l, PSEUDO_TAG_PREFIX, strlen (PSEUDO_TAG_PREFIX)) == 0)
+			continue;
+		tab = strchr (l, '\t');
+		if (tab == NULL)
+			continue;
+
+		ok = (mio_printf (out, "%ld\t%.*s\n", offset, (int) (tab - l), l) >= 0);
+		next = offset + NAME_INDEX_BLOCK_SIZE;
+	}
+	vStringDelete (line);
+
+	if (mio_unref (out) != 0)
+		ok = false;
+	return ok;
+}
+
+extern void writeNameIndex (const char *const tagFileName)
+{
+	MIO *in = mio_new_file (tagFileName, "rb");
+	vString *indexFileName;
+	vString *tmp;
+
+	if (in == NULL)
+	{
+		error (WARNING | PERROR, "cannot read tag file \"%s\" for the name index",
+			   tagFileName);
+		return;
+	}
+
+	indexFileName = vStringNewInit (tagFileName);
+	vStringCatS (indexFileName, NAME_INDEX_SUFFIX);
+
+	/* Write to a temporary file first not to leave a broken index. */
+	tmp = vStringNewCopy (indexFileName);
+	vStringCatS (tmp, ".tmp");
+
+	verbose ("writing name index \"%s\"\n", vStringValue (indexFileName));
+	if (! writeIndexFile (in, vStringValue (tmp))
+		|| rename (vStringValue (tmp), vStringValue (indexFileName)) != 0)
+	{
+		error (WARNING | PERROR, "cannot write name index \"%s\"",
+			   vStringValue (indexFileName));
+		remove (vStringValue (tmp));
+	}
+
+	mio_unref (in);
+	vStringDelete (tmp);
+	vStringDelete (indexFileName);
+}
+
+extern bool ptagMakeNameIndex (ptagDesc *desc, langType language CTAGS_ATTR_UNUSED,
+							   const void *data)
+{
+	const optionValues *opt = data;
+	vString *name;
+	bool r;
+
+	if (! opt->nameIndex)
+		return false;
+
+	name = vStringNewInit (baseFilename (opt->tagFileName));
+	vStringCatS (name, NAME_INDEX_SUFFIX);
+	r = writePseudoTag (desc, vStringValue (name),
+						"sparse index of names", NULL);
+	vStringDelete (name);
+	return r;
+}
@@ -0,0 +1,29 @@
+/*
+*   Copyright (c) 2026, Universal Ctags Team
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License version 2 or (at your option) any later version.
+*
+*   Main part private interface to nameindex.c
+*/
+#ifndef CTAGS_MAIN_NAMEINDEX_PRIVATE_H
+#define CTAGS_MAIN_NAMEINDEX_PRIVATE_H
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"  /* must always come first */
+
+#include "types.h"
+
+/*
+*   FUNCTION PROTOTYPES
+*/
+
+/* Writes the name index for the sorted tag file. */
+extern void writeNameIndex (const char *const tagFileName);
+
+extern bool ptagMakeNameIndex (ptagDesc *desc, langType language,
+							   const void *data);
+
+#endif  /* CTAGS_MAIN_NAMEINDEX_PRIVATE_H */
@@ -20,9 +20,18 @@
 
 #include <string.h>
 
-/* TODO: Alignment */
-#define NL_SIZE(nls) (sizeof(NestingLevel) + (nls)->userDataSize)
-#define NL_NTH(nls,n) (NestingLevel *)(((char *)((nls)->levels)) + ((n) * NL_SIZE (nls)))
+#define NL_NTH(nls,n) (NestingLevel *)(((char *)((nls)->levels)) + ((n) * (nls)->stride))
+
+/* The first levels are allocated at once; most files nest only a few
+ * levels. */
+#define NL_INITIAL_ALLOCATION 8
+
+/* The tag of a level when the cached scope was made, and the length of
+ * the scope up to the level. */
+struct nestingLevelScope {
+	int corkIndex;
+	size_t length;
+};
 
 /*
 *   FUNCTION DEFINITIONS
@@ -31,8 +40,10 @@
 extern NestingLevels *nestingLevelsNewFull(size_t userDataSize,
 										   void (* deleteUserData)(NestingLevel *, void *))
 {
+	const size_t align = sizeof (nestingLevelAlign);
 	NestingLevels *nls = xCalloc (1, NestingLevels);
 	nls->userDataSize = userDataSize;
+	nls->stride = (sizeof (NestingLevel) + userDataSize + align - 1) / align * align;
 	nls->deleteUserData = deleteUserData;
 	return nls;
 }
@@ -55,6 +66,8 @@ extern void nestingLevelsFreeFull(NestingLevels *nls, void *ctxData)
 		nl->corkIndex = CORK_NIL;
 	}
 	if (nls->levels) eFree(nls->levels);
+	if (nls->scopeLevels) eFree(nls->scopeLevels);
+	vStringDelete (nls->scope);
 	eFree(nls);
 }
 
@@ -64,9 +77,9 @@ extern NestingLevel * nestingLevelsPush(NestingLevels *nls, int corkIndex)
 
 	if (nls->n >= nls->allocated)
 	{
-		nls->allocated++;
+		nls->allocated = nls->allocated? nls->allocated * 2: NL_INITIAL_ALLOCATION;
 		nls->levels = eRealloc(nls->levels,
-				       nls->allocated * NL_SIZE (nls));
+				       nls->allocated * nls->stride);
 	}
 	nl = NL_NTH(nls, nls->n);
 	nls->n++;
@@ -82,6 +95,16 @@ extern NestingLevel *nestingLevelsTruncate(NestingLevels *nls, int depth, int co
 {
 	NestingLevel *nl;
 
+	/* The levels dropped have no user data to free in most parsers. */
+	if (nls->deleteUserData)
+	{
+		for (int i = nls->n - 1; i >= depth; i--)
+		{
+			nl = NL_NTH(nls, i);
+			nls->deleteUserData (nl, NULL);
+			nl->corkIndex = CORK_NIL;
+		}
+	}
 	nls->n = depth;
 	nl = nestingLevelsGetCurrent(nls);
 	nl->corkIndex = corkIndex;
@@ -119,3 +142,51 @@ extern void *nestingLevelGetUserData (const NestingLevel *nl)
 {
 	return (void *)nl->userData;
 }
+
+extern const vString *nestingLevelsGetScope (NestingLevels *nls, int separator)
+{
+	int i;
+
+	if (nls->scope == NULL)
+		nls->scope = vStringNew ();
+
+	if (nls->scopeSeparator != separator)
+	{
+		nls->scopeSeparator = separator;
+		nls->scopeDepth = 0;
+	}
+
+	/* Keep the part for the levels having the same tags as before. */
+	for (i = 0; i < nls->scopeDepth && i < nls->n; i++)
+	{
+		NestingLevel *nl = NL_NTH(nls, i);
+
+		if (nls->scopeLevels[i].corkIndex != nl->corkIndex)
+			break;
+	}
+	vStringTruncate (nls->scope, (i > 0)? nls->scopeLevels[i - 1].length: 0);
+
+	if (nls->scopeAllocated < nls->allocated)
+	{
+		nls->scopeAllocated = nls->allocated;
+		nls->scopeLevels = xRealloc (nls->scopeLevels, nls->scopeAllocated,
+									 struct nestingLevelScope);
+	}
+	for (; i < nls->n; i++)
+	{
+		NestingLevel *nl = NL_NTH(nls, i);
+		tagEntryInfo *e = getEntryOfNestingLevel (nl);
+
+		if (e && e->name[0] != '\0' && !e->placeholder)
+		{
+			if (vStringLength (nls->scope) > 0)
+				vStringPut (nls->scope, separator);
+			vStringCatS (nls->scope, e->name);
+		}
+		nls->scopeLevels[i].corkIndex = nl->corkIndex;
+		nls->scopeLevels[i].length = vStringLength (nls->scope);
+	}
+	nls->scopeDepth = nls->n;
+
+	return nls->scope;
+}
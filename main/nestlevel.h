@@ -23,10 +23,18 @@
 typedef struct NestingLevel NestingLevel;
 typedef struct NestingLevels NestingLevels;
 
+/* Aligns the user data for any type it may have. */
+typedef union {
+	void *p;
+	long l;
+	long long ll;
+	double d;
+} nestingLevelAlign;
+
 struct NestingLevel
 {
 	int corkIndex;
-	char userData [];
+	nestingLevelAlign userData [];
 };
 
 struct NestingLevels
@@ -35,9 +43,17 @@ struct NestingLevels
 	int n;					/* number of levels in use */
 	int allocated;
 	size_t userDataSize;
+	size_t stride;			/* bytes of a level and its user data */
 	/* The second argument is given via nestinglevelsPopFull
 	 * or nestinglevelFreeFull */
 	void (* deleteUserData) (NestingLevel *, void *);
+
+	/* See nestingLevelsGetScope () */
+	vString *scope;
+	struct nestingLevelScope *scopeLevels;
+	int scopeAllocated;
+	int scopeDepth;
+	int scopeSeparator;
 };
 
 /*
@@ -58,4 +74,10 @@ extern NestingLevel *nestingLevelsGetNthParent(const NestingLevels *nls, int n);
 
 extern void *nestingLevelGetUserData (const NestingLevel *nl);
 
+/* Returns the names of the tags of the levels from the root, joined
+ * with SEPARATOR. A level without a tag, or with a placeholder or a tag
+ * of an empty name is skipped. The string is kept in NLS, and only the
+ * part for the levels changed since the last call is made again. */
+extern const vString *nestingLevelsGetScope (NestingLevels *nls, int separator);
+
 #endif  /* CTAGS_MAIN_NESTLEVEL_H */
@@ -19,6 +19,13 @@
 #include <stdlib.h>
 #include <string.h>
 
+#define NUM_ARRAY_INITIAL_SIZE 8
+
+/* Arrays deleted are kept in a pool of each type and reused by
+ * xxxArrayNew () unless they have grown larger than NUM_ARRAY_POOLED_SIZE. */
+#define NUM_ARRAY_POOLED_SIZE 64
+#define NUM_ARRAY_POOL_SIZE 32
+
 #define impNumArray(prefix,Prefix,type)									\
 																		\
 	struct s##Prefix##Array {											\
@@ -27,15 +34,54 @@
 		type *array;													\
 	};																	\
 																		\
+	static prefix##Array *prefix##ArrayPool [NUM_ARRAY_POOL_SIZE];		\
+	static unsigned int prefix##ArrayPoolCount;							\
+																		\
 	extern prefix##Array *prefix##ArrayNew (void)						\
 	{																	\
-		prefix##Array* const result = xMalloc (1, prefix##Array);		\
-		result->max = 8;												\
+		prefix##Array* result;											\
+																		\
+		if (prefix##ArrayPoolCount > 0)									\
+			result = prefix##ArrayPool [--prefix##ArrayPoolCount];		\
+		else															\
+		{																\
+			result = xMalloc (1, prefix##Array);						\
+			result->max = NUM_ARRAY_INITIAL_SIZE;						\
+			result->array = xMalloc (result->max, type);				\
+		}																\
 		result->count = 0;												\
-		result->array = xMalloc (result->max, type);					\
 		return result;													\
 	}																	\
 																		\
+	extern void prefix##ArrayReserve (prefix##Array *const current, unsigned int count)	\
+	{																	\
+		unsigned int max;												\
+																		\
+		Assert (current != NULL);										\
+		if (current->max - current->count >= count)						\
+			return;														\
+																		\
+		max = current->max;												\
+		while (max - current->count < count)							\
+			max *= 2;													\
+		current->max = max;												\
+		current->array = xRealloc (current->array, current->max, type);	\
+	}																	\
+																		\
+	extern void prefix##ArrayShrink (prefix##Array *const current)		\
+	{																	\
+		unsigned int max = NUM_ARRAY_INITIAL_SIZE;						\
+																		\
+		Assert (current != NULL);										\
+		while (max < current->count)									\
+			max *= 2;													\
+		if (max < current->max)											\
+		{																\
+			current->max = max;											\
+			current->array = xRealloc (current->array, current->max, type);	\
+		}																\
+	}																	\
+																		\
 	extern unsigned int prefix##ArrayAdd (prefix##Array *const current, type num) \
 	{																	\
 		Assert (current != NULL);										\
@@ -48,6 +94,27 @@
 		return current->count++;										\
 	}																	\
 																		\
+	extern void prefix##ArrayAddItems (prefix##Array *const current, const type *nums, unsigned int count)	\
+	{																	\
+		prefix##ArrayReserve (current, count);							\
+		if (count > 0)													\
+			memcpy (current->array + current->count, nums, count * sizeof (type));	\
+		current->count += count;										\
+	}																	\
+																		\
+	extern void prefix##ArrayInsertItems (prefix##Array *const current, unsigned int indx,	\
+										  const type *nums, unsigned int count)	\
+	{																	\
+		Assert (current != NULL);										\
+		Assert (indx <= current->count);								\
+		prefix##ArrayReserve (current, count);							\
+		memmove (current->array + indx + count, current->array + indx,	\
+				 (current->count - indx) * sizeof (type));				\
+		if (count > 0)													\
+			memcpy (current->array + indx, nums, count * sizeof (type));	\
+		current->count += count;										\
+	}																	\
+																		\
 	extern void prefix##ArrayRemoveLast (prefix##Array *const current)	\
 	{																	\
 		Assert (current != NULL);										\
@@ -57,11 +124,9 @@
 																		\
 	extern void prefix##ArrayCombine (prefix##Array *const current, prefix##Array *const from) \
 	{																	\
-		unsigned int i;													\
 		Assert (current != NULL);										\
 		Assert (from != NULL);											\
-		for (i = 0  ;  i < from->count  ;  ++i)							\
-			prefix##ArrayAdd (current, from->array [i]);				\
+		prefix##ArrayAddItems (current, from->array, from->count);		\
 		from->count = 0;												\
 		prefix##ArrayDelete (from);										\
 	}																	\
@@ -101,8 +166,14 @@
 		if (current != NULL)											\
 		{																\
 			prefix##ArrayClear (current);								\
-			eFree (current->array);										\
-			eFree (current);											\
+			if (prefix##ArrayPoolCount < NUM_ARRAY_POOL_SIZE			\
+				&& current->max <= NUM_ARRAY_POOLED_SIZE)				\
+				prefix##ArrayPool [prefix##ArrayPoolCount++] = current;	\
+			else														\
+			{															\
+				eFree (current->array);									\
+				eFree (current);										\
+			}															\
 		}																\
 	}																	\
 																		\
@@ -22,6 +22,11 @@
 																		\
 	extern prefix##Array *prefix##ArrayNew (void);						\
 	extern unsigned int prefix##ArrayAdd (prefix##Array *const current, type num); \
+	extern void prefix##ArrayAddItems (prefix##Array *const current, const type *nums, unsigned int count); \
+	extern void prefix##ArrayInsertItems (prefix##Array *const current, unsigned int indx, \
+										  const type *nums, unsigned int count); \
+	extern void prefix##ArrayReserve (prefix##Array *const current, unsigned int count); \
+	extern void prefix##ArrayShrink (prefix##Array *const current);	\
 	extern void prefix##ArrayRemoveLast (prefix##Array *const current);	\
 	extern void prefix##ArrayCombine (prefix##Array *const current, prefix##Array *const from);	\
 	extern void prefix##ArrayClear (prefix##Array *const current);		\
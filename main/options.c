@@ -22,13 +22,18 @@
 #include <string.h>
 #include <stdio.h>
 #include <ctype.h>  /* to declare isspace () */
+#include <errno.h>
+#include <limits.h>
 
+#include "compress_p.h"
 #include "ctags.h"
 #include "debug.h"
 #include "entry_p.h"
 #include "field_p.h"
 #include "gvars.h"
+#include "htable.h"
 #include "keyword_p.h"
+#include "numarray.h"
 #include "parse_p.h"
 #include "ptag_p.h"
 #include "routines_p.h"
@@ -36,6 +41,7 @@
 #include "param_p.h"
 #include "error_p.h"
 #include "interactive_p.h"
+#include "server_p.h"
 #include "writer_p.h"
 #include "trace.h"
 
@@ -118,12 +124,32 @@ typedef const struct sBooleanOption {
 */
 
 static bool NonOptionEncountered = false;
+static vString *OptionFingerprint;
 static stringList *OptionFiles;
 
 typedef stringList searchPathList;
 static searchPathList *OptlibPathList;
 
 static stringList *Excluded, *ExcludedException;
+
+/* A compiled form of the patterns of --exclude or --exclude-exception.
+ * isExcludedFile() is called for every directory entry, so the patterns
+ * are classified when the list is used first after it is changed:
+ * - a pattern without wildcards is looked up in a hash table,
+ * - "*LITERAL" and "LITERAL*" are looked up in hash tables by the suffix
+ *   and the prefix of a file name having the length of a LITERAL, and
+ * - only the other patterns are tried with fnmatch() one by one. */
+typedef struct sExcludeMatcher {
+	bool compiled;
+	hashTable *literals;
+	hashTable *suffixes;
+	hashTable *prefixes;
+	intArray *suffixLengths;
+	intArray *prefixLengths;
+	stringList *globs;
+	vString *buffer;
+} excludeMatcher;
+static excludeMatcher ExcludedMatcher, ExcludedExceptionMatcher;
 static bool FilesRequired = true;
 static bool SkipConfiguration;
 
@@ -147,9 +173,31 @@ optionValues Option = {
 	,
 	.recurse = false,
 	.sorted = SO_SORTED,
+#ifdef EXTERNAL_SORT
+	.sortMethod = SORT_METHOD_EXTERNAL,
+#else
+	.sortMethod = SORT_METHOD_INTERNAL,
+#endif
+	.sortMemoryLimit = 64 * 1024 * 1024,
+	.sortInMemory = false,
+	.dedupHeaders = false,
+	.dedupTags = false,
+	.nameIndex = false,
+	.trigramIndex = false,
+	.fileIndex = false,
+	.shardBy = SHARD_BY_NONE,
+	.cacheFileName = NULL,
+	.cacheDirName = NULL,
+	.updateFileList = NULL,
+	.shardIndex = 0,
+	.shardCount = 0,
+	.mergeTags = false,
+	.languageCacheFileName = NULL,
 	.xref = false,
 	.customXfmt = NULL,
 	.fileList = NULL,
+	.inputOrder = INPUT_ORDER_GIVEN,
+	.mapInput = false,
 	.tagFileName = NULL,
 	.headerExt = NULL,
 	.etagsInclude = NULL,
@@ -160,10 +208,15 @@ optionValues Option = {
 #endif
 	.language = LANG_AUTO,
 	.followLinks = true,
+	.useIgnoreFiles = false,
 	.filter = false,
 	.filterTerminator = NULL,
 	.tagRelative = TREL_NO,
 	.printTotals = 0,
+	.slowestFiles = 0,
+	.fileStatsFileName = NULL,
+	.traceEventsFileName = NULL,
+	.samplingProfile = 0,
 	.lineDirectives = false,
 	.printLanguage =false,
 	.guessLanguageEagerly = false,
@@ -172,6 +225,10 @@ optionValues Option = {
 	.patternLengthLimit = 96,
 	.putFieldPrefix = false,
 	.maxRecursionDepth = 0xffffffff,
+	.jobs = 1,
+	.jobsOrder = JOBS_ORDER_INPUT,
+	.splitSize = 0,
+	.splitGuests = 0,
 	.interactive = false,
 	.fieldsReset = false,
 #ifdef WIN32
@@ -237,12 +294,34 @@ static optionDescription LongOptionDescription [] = {
  {1,0,"       Not supported on this platform."},
  {1,0,"  -R   Not supported on this platform."},
 #endif
+ {1,0,"  --use-ignore-files[=(yes|no)]"},
+ {1,0,"       Skip files and directories listed in .gitignore and .ignore files"},
+ {1,0,"       found during recursion [no]."},
  {1,0,"  -L <file>"},
  {1,0,"       A list of input file names is read from the specified <file>."},
  {1,0,"       If specified as \"-\", then standard input is read."},
+ {1,0,"  --input-order=(given|unique|directory|inode)"},
+ {1,0,"       Parse the input files in the given order, skipping duplicates, sorted"},
+ {1,0,"       by directory, or sorted by directory and inode number [given]."},
+ {1,0,"  --map-input[=(yes|no)]"},
+ {1,0,"       Read the input files through memory mapping [no]."},
  {1,0,"  --append[=(yes|no)]"},
  {1,0,"       Should tags should be appended to existing tag file [no]?"},
  {1,0,"  -a   Append the tags to an existing tag file."},
+ {1,0,"  --cache-dir=<dir>"},
+ {1,0,"       Reuse the tags of the input files having the same contents recorded in <dir>."},
+ {1,0,"  --cache-file=<file>"},
+ {1,0,"       Reuse the tags of unchanged input files recorded in <file>, and update it."},
+ {1,0,"  --update-from=(<file>|-)"},
+ {1,0,"       Update the tag file for the input files changed or removed listed in <file>."},
+ {1,0,"  --input-shard=<i>/<n>"},
+ {1,0,"       Parse only the input files in the <i>th of <n> shards chosen by their names."},
+ {1,0,"  --merge-tags[=(yes|no)]"},
+ {1,0,"       Merge the tag files given as input files into the tag file [no]."},
+ {1,0,"  --dedup-headers[=(yes|no)]"},
+ {1,0,"       Parse C/C++ headers and makefiles having the same contents only once [no]."},
+ {1,0,"  --dedup-tags[=(yes|no)]"},
+ {1,0,"       Drop the tags having been written with the same name, file, line, and kind [no]."},
  {1,0,"  -f <tagfile>"},
  {1,0,"       Write tags to specified <tagfile>. Value of \"-\" writes tags to stdout"},
  {1,0,"       [\"tags\"; or \"TAGS\" when -e supplied]."},
@@ -255,17 +334,32 @@ static optionDescription LongOptionDescription [] = {
 #else
  {0,0,"       Force output of specified tag file format [2]."},
 #endif
-#ifdef HAVE_JANSSON
- {0,0,"  --output-format=(u-ctags|e-ctags|etags|xref|json)"},
-#else
- {0,0,"  --output-format=(u-ctags|e-ctags|etags|xref)"},
-#endif
+ {0,0,"  --output-format=(u-ctags|e-ctags|etags|xref|json|binary)"},
  {0,0,"      Specify the output format. [u-ctags]"},
  {0,0,"  -e   Output tag file for use with Emacs."},
  {1,0,"  -x   Print a tabular cross reference file to standard output."},
  {0,0,"  --sort=(yes|no|foldcase)"},
  {0,0,"       Should tags be sorted (optionally ignoring case) [yes]?"},
  {0,0,"  -u   Equivalent to --sort=no."},
+#ifdef EXTERNAL_SORT
+ {1,0,"  --sort-method=(internal|external)"},
+ {1,0,"       Sort tags with the built-in merge sort or the sort command [external]."},
+#else
+ {1,0,"  --sort-method=internal"},
+ {1,0,"       Sort tags with the built-in merge sort [internal]."},
+#endif
+ {1,0,"  --sort-in-memory[=(yes|no)]"},
+ {1,0,"       Keep the tags in memory and write the tag file once after sorting [no]."},
+ {1,0,"  --sort-memory-limit=<size>[k|m|g]"},
+ {1,0,"       Spill sorted runs of the internal sort to temporary files above <size> bytes [64m]."},
+ {1,0,"  --name-index[=(yes|no)]"},
+ {1,0,"       Write an index of the names in the sorted tag file for fast lookups [no]."},
+ {1,0,"  --shard-by=(no|directory|language)"},
+ {1,0,"       Split the tag file into shards listed in the tag file [no]."},
+ {1,0,"  --trigram-index[=(yes|no)]"},
+ {1,0,"       Write an index of the trigrams in the names for substring lookups [no]."},
+ {1,0,"  --file-index[=(yes|no)]"},
+ {1,0,"       Write an index of the tags of each input file for outline lookups [no]."},
  {1,0,"  --etags-include=<file>"},
  {1,0,"       Include reference to <file> in Emacs-style tag file (requires -e)."},
 #ifdef HAVE_ICONV
@@ -277,6 +371,11 @@ static optionDescription LongOptionDescription [] = {
  {1,0,"       The <encoding> to write the tag file in. Defaults to UTF-8 if --input-encoding"},
  {1,0,"       is specified, otherwise no conversion is performed."},
 #endif
+ {1,0,"  --input-budget=[bytes=<N>][,lines=<N>][,msec=<N>][,linelen=<N>][,binary=(yes|no)][,action=(reduce|skip)]"},
+ {1,0,"       Parse an input file over the budget without patterns and signatures,"},
+ {1,0,"       or skip it. Stop parsing a file after <N> msec. Skip a binary file."},
+ {1,0,"  --input-budget-<LANG>=[bytes=<N>][,lines=<N>][,msec=<N>][,linelen=<N>][,binary=(yes|no)][,action=(reduce|skip)]"},
+ {1,0,"       Specify the budget of the <LANG> input files."},
  {1,1,"  --_xformat=<field_format>"},
  {1,1,"       Specify custom format for tabular cross reference (-x)."},
  {1,1,"       Fields can be specified with letter listed in --list-fields."},
@@ -299,6 +398,9 @@ static optionDescription LongOptionDescription [] = {
  {1,0,"       o emacs mode specification at the beginning and end of input file, and"},
  {1,0,"       o vim syntax specification at the end of input file."},
  {1,0,"  -G   Equivalent to --guess-language-eagerly."},
+ {1,0,"  --language-cache=<file>"},
+ {1,0,"       Reuse the languages guessed for unchanged input files recorded in <file>,"},
+ {1,0,"       and update it."},
  {1,0,"  --langmap=<map>[,<map>[...]]"},
  {1,0,"       Override default mapping of language to input file extension."},
  {1,0,"       e.g. --langmap=c:.c.x,java:+.j,make:([Mm]akefile).mak"},
@@ -471,11 +573,22 @@ static optionDescription LongOptionDescription [] = {
  {1,1,"       Output list of optscript operators."},
  {1,0,""},
  {1,0,"Miscellaneous Options"},
+ {1,0,"  --file-stats=<file>"},
+ {1,0,"       Write the parse time, size, and tags of each input file to <file>."},
  {1,0,"  --help"},
  {1,0,"       Print this option summary."},
  {1,0,"  -?   Print this option summary."},
  {1,0,"  --help-full"},
  {1,0,"       Print this option summary including experimental features."},
+ {1,0,"  --jobs=<N>"},
+#ifdef HAVE_FORK
+ {1,0,"       Parse input files with <N> worker processes [1]."},
+#else
+ {1,0,"       Not supported on this platform."},
+#endif
+ {1,0,"  --jobs-order=(input|ready)"},
+ {1,0,"       With --jobs, write the tags of the workers in the order of the input"},
+ {1,0,"       files, or as the workers finish if the tag file is sorted [input]."},
  {1,0,"  --license"},
  {1,0,"       Print details of software license."},
  {0,0,"  --print-language"},
@@ -483,8 +596,25 @@ static optionDescription LongOptionDescription [] = {
  {0,0,"       input file."},
  {1,0,"  --quiet[=(yes|no)]"},
  {0,0,"       Don't print NOTICE class messages [no]."},
+ {1,0,"  --sampling-profile=<N>"},
+#ifdef HAVE_SETITIMER
+ {1,0,"       Print the <N> regions of the input files taking the most CPU time"},
+ {1,0,"       for each parser [0]."},
+#else
+ {1,0,"       Not supported on this platform."},
+#endif
+ {1,0,"  --slowest-files=<N>"},
+ {1,0,"       Print the <N> input files taking the longest time to parse [0]."},
+ {1,0,"  --split-guests=<N>"},
+ {1,0,"       With --jobs, run the guest parsers for <N> or more regions in a file"},
+ {1,0,"       in worker processes [0]."},
+ {1,0,"  --split-size=<N>"},
+ {1,0,"       With --jobs, parse a C/C++ file of <N> bytes or more in chunks [0]."},
  {1,0,"  --totals[=(yes|no|extra)]"},
  {1,0,"       Print statistics about input and tag files [no]."},
+ {1,0,"  --trace-events=<file>"},
+ {1,0,"       Write the spans of the input files, parsers, and phases to <file>"},
+ {1,0,"       in the Trace Event Format of Chrome."},
  {1,0,"  --verbose[=(yes|no)]"},
  {1,0,"       Enable verbose messages describing actions on each input file."},
  {1,0,"  --version[=<language>]"},
@@ -500,6 +630,10 @@ static optionDescription LongOptionDescription [] = {
 
  {1,1,"  --_anonhash=<fname>"},
  {1,1,"       Used in u-ctags test harness"},
+#if defined (HAVE_SYS_SOCKET_H) && defined (HAVE_SYS_UN_H)
+ {1,1,"  --_client=<socket>"},
+ {1,1,"       Send the input files to the server listening on <socket> and print the tags."},
+#endif
  {1,1,"  --_dump-keywords"},
  {1,1,"       Dump keywords of initialized parser(s)."},
  {1,1,"  --_dump-options"},
@@ -521,6 +655,12 @@ static optionDescription LongOptionDescription [] = {
  {0,1,"       Enter file I/O limited interactive mode if sandbox is specified. [default]"},
 #endif
 #endif
+#if defined (HAVE_SYS_SOCKET_H) && defined (HAVE_SYS_UN_H)
+ {1,1,"  --_server=<socket>"},
+ {1,1,"       Listen on <socket> and make tags for the files sent by clients."},
+ {1,1,"  --_shutdown-server=<socket>"},
+ {1,1,"       Stop the server listening on <socket>."},
+#endif
 #ifdef DO_TRACING
  {1,1,"  --_trace=<list>"},
  {1,1,"       Trace parsers for the languages."},
@@ -585,8 +725,8 @@ static struct Feature {
 #ifdef HAVE_LIBXML
 	{"xpath", "linked with library for parsing xml input"},
 #endif
-#ifdef HAVE_JANSSON
 	{"json", "supports json format output"},
+#ifdef HAVE_JANSSON
 	{"interactive", "accepts source code from stdin"},
 #endif
 #ifdef HAVE_SECCOMP
@@ -595,6 +735,9 @@ static struct Feature {
 #ifdef HAVE_LIBYAML
 	{"yaml", "linked with library for parsing yaml input"},
 #endif
+#ifdef HAVE_ZLIB
+	{"zlib", "can write compressed tag files"},
+#endif
 #ifdef CASE_INSENSITIVE_FILENAMES
 	{"case-insensitive-filenames", "TO BE WRITTEN"},
 #endif
@@ -608,6 +751,18 @@ static struct Feature {
 	{"optscript", "can use the interpreter"},
 #ifdef HAVE_PCRE2
 	{"pcre2", "has pcre2 regex engine"},
+#endif
+#ifdef HAVE_FORK
+	{"jobs", "can parse input files in parallel worker processes"},
+#endif
+#if defined (HAVE_SYS_SOCKET_H) && defined (HAVE_SYS_UN_H)
+	{"server", "can keep parsers initialized in a server process"},
+#endif
+#ifdef HAVE_SETITIMER
+	{"sampling-profile", "can sample the regions of the input files parsed"},
+#endif
+#if defined (HAVE_JANSSON) && defined (HAVE_SYS_INOTIFY_H)
+	{"watch", "can watch directories in interactive mode"},
 #endif
 	{NULL,}
 };
@@ -724,7 +879,7 @@ extern void freeList (stringList** const pList)
 
 extern void setDefaultTagFileName (void)
 {
-	if (Option.filter || Option.interactive)
+	if (Option.filter || Option.interactive || Option.server)
 		return;
 
 	if (Option.tagFileName == NULL)
@@ -764,6 +919,28 @@ extern void checkOptions (void)
 		if (isDestinationStdout ())
 			error (FATAL, "%s tags to stdout", notice);
 	}
+	if (Option.updateFileList)
+	{
+		notice = "--update-from is not compatible with";
+		if (! Option.append)
+			error (FATAL, "%s --append=no", notice);
+		if (! writerIsCtags ())
+			error (FATAL, "%s the output format", notice);
+		if (Option.shardBy != SHARD_BY_NONE)
+			error (FATAL, "%s --shard-by", notice);
+	}
+	if (Option.mergeTags)
+	{
+		notice = "--merge-tags is not compatible with";
+		if (Option.filter)
+			error (FATAL, "%s filter mode", notice);
+		if (Option.append)
+			error (FATAL, "%s append mode", notice);
+		if (! writerIsCtags ())
+			error (FATAL, "%s the output format", notice);
+		if (Option.shardCount > 0)
+			error (FATAL, "%s --input-shard", notice);
+	}
 	if (Option.filter)
 	{
 		notice = "filter mode";
@@ -775,6 +952,126 @@ extern void checkOptions (void)
 		if (Option.tagFileName != NULL)
 			error (WARNING, "%s ignores output tag file name", notice);
 	}
+	if (Option.tagFileName && ! isDestinationStdout ()
+		&& isCompressedTagFileName (Option.tagFileName))
+	{
+#ifndef HAVE_ZLIB
+		error (FATAL, "cannot write compressed tag file \"%s\": ctags is built without zlib",
+			   Option.tagFileName);
+#endif
+		if (Option.append)
+			error (FATAL, "append mode is not compatible with compressed tag file");
+		notice = "compressed tag file";
+		if (Option.nameIndex)
+		{
+			error (WARNING, "%s disables the name index", notice);
+			Option.nameIndex = false;
+		}
+		if (Option.trigramIndex)
+		{
+			error (WARNING, "%s disables the trigram index", notice);
+			Option.trigramIndex = false;
+		}
+		if (Option.fileIndex)
+		{
+			error (WARNING, "%s disables the file index", notice);
+			Option.fileIndex = false;
+		}
+		if (Option.shardBy != SHARD_BY_NONE)
+		{
+			error (WARNING, "%s disables sharding", notice);
+			Option.shardBy = SHARD_BY_NONE;
+		}
+	}
+	if (Option.shardBy != SHARD_BY_NONE)
+	{
+		notice = "sharding is not available";
+		if (isDestinationStdout () || Option.filter)
+		{
+			error (WARNING, "%s for tags to stdout", notice);
+			Option.shardBy = SHARD_BY_NONE;
+		}
+		else if (! writerIsCtags ())
+		{
+			error (WARNING, "%s for the output format", notice);
+			Option.shardBy = SHARD_BY_NONE;
+		}
+		else
+		{
+			if (Option.nameIndex)
+			{
+				error (WARNING, "sharding disables the name index");
+				Option.nameIndex = false;
+			}
+			if (Option.trigramIndex)
+			{
+				error (WARNING, "sharding disables the trigram index");
+				Option.trigramIndex = false;
+			}
+			if (Option.fileIndex)
+			{
+				error (WARNING, "sharding disables the file index");
+				Option.fileIndex = false;
+			}
+			/* The shard of a tag line is chosen with the field. */
+			if (Option.shardBy == SHARD_BY_LANGUAGE
+				&& ! isFieldEnabled (FIELD_LANGUAGE))
+				enableField (FIELD_LANGUAGE, true);
+		}
+	}
+	if (Option.nameIndex)
+	{
+		notice = "name index is not available";
+		if (Option.sorted == SO_UNSORTED)
+		{
+			error (WARNING, "%s for unsorted tags", notice);
+			Option.nameIndex = false;
+		}
+		else if (isDestinationStdout () || Option.filter)
+		{
+			error (WARNING, "%s for tags to stdout", notice);
+			Option.nameIndex = false;
+		}
+		else if (! writerIsCtags ())
+		{
+			error (WARNING, "%s for the output format", notice);
+			Option.nameIndex = false;
+		}
+		else if (! isXtagEnabled (XTAG_PSEUDO_TAGS))
+			error (WARNING, "the tag file doesn't refer to the name index without pseudo tags");
+	}
+	if (Option.trigramIndex)
+	{
+		notice = "trigram index is not available";
+		if (isDestinationStdout () || Option.filter)
+		{
+			error (WARNING, "%s for tags to stdout", notice);
+			Option.trigramIndex = false;
+		}
+		else if (! writerIsCtags ())
+		{
+			error (WARNING, "%s for the output format", notice);
+			Option.trigramIndex = false;
+		}
+		else if (! isXtagEnabled (XTAG_PSEUDO_TAGS))
+			error (WARNING, "the tag file doesn't refer to the trigram index without pseudo tags");
+	}
+	if (Option.fileIndex)
+	{
+		notice = "file index is not available";
+		if (isDestinationStdout () || Option.filter)
+		{
+			error (WARNING, "%s for tags to stdout", notice);
+			Option.fileIndex = false;
+		}
+		else if (! writerIsCtags ())
+		{
+			error (WARNING, "%s for the output format", notice);
+			Option.fileIndex = false;
+		}
+		else if (! isXtagEnabled (XTAG_PSEUDO_TAGS))
+			error (WARNING, "the tag file doesn't refer to the file index without pseudo tags");
+	}
 	writerCheckOptions (Option.fieldsReset);
 }
 
@@ -862,7 +1159,6 @@ static void setXrefMode (void)
 	setTagWriter (WRITER_XREF, NULL);
 }
 
-#ifdef HAVE_JANSSON
 static void setJsonMode (void)
 {
 	enablePtag (PTAG_JSON_OUTPUT_VERSION, true);
@@ -870,7 +1166,6 @@ static void setJsonMode (void)
 	enablePtag (PTAG_FILE_FORMAT, false);
 	setTagWriter (WRITER_JSON, NULL);
 }
-#endif
 
 /*
  *  Cooked argument parsing
@@ -987,6 +1282,15 @@ extern cookedArgs* cArgNewFromLineFile (FILE* const fp)
 	return result;
 }
 
+extern cookedArgs* cArgNewFromListFile (FILE* const fp, inputOrder order)
+{
+	cookedArgs* const result = xMalloc (1, cookedArgs);
+	memset (result, 0, sizeof (cookedArgs));
+	result->args = argNewFromListFile (fp, order);
+	cArgRead (result);
+	return result;
+}
+
 extern void cArgDelete (cookedArgs* const current)
 {
 	Assert (current != NULL);
@@ -1164,10 +1468,146 @@ static void processEtagsInclude (
 	}
 }
 
+static void clearExcludeMatcher (excludeMatcher *m)
+{
+	if (! m->compiled)
+		return;
+
+	hashTableDelete (m->literals);
+	hashTableDelete (m->suffixes);
+	hashTableDelete (m->prefixes);
+	intArrayDelete (m->suffixLengths);
+	intArrayDelete (m->prefixLengths);
+	stringListDelete (m->globs);
+	vStringDelete (m->buffer);
+	memset (m, 0, sizeof (*m));
+}
+
+static bool hasWildcard (const char *pattern)
+{
+	return strpbrk (pattern, "*?[\\") != NULL;
+}
+
+static hashTable *newExcludeMatcherTable (void)
+{
+#ifdef CASE_INSENSITIVE_FILENAMES
+	return hashTableNew (64, hashCstrcasehash, hashCstrcaseeq, eFree, NULL);
+#else
+	return hashTableNew (64, hashCstrhash, hashCstreq, eFree, NULL);
+#endif
+}
+
+static void addToExcludeMatcherTable (hashTable *table, intArray *lengths,
+									  const char *literal, size_t len)
+{
+	char *key = eStrndup (literal, len);
+
+	if (hashTableHasItem (table, key))
+	{
+		eFree (key);
+		return;
+	}
+	/* A non-NULL value tells a hit. */
+	hashTablePutItem (table, key, key);
+	if (lengths && !intArrayHas (lengths, (int) len))
+		intArrayAdd (lengths, (int) len);
+}
+
+static void compileExcludeMatcher (excludeMatcher *m, const stringList *list)
+{
+	m->literals = newExcludeMatcherTable ();
+	m->suffixes = newExcludeMatcherTable ();
+	m->prefixes = newExcludeMatcherTable ();
+	m->suffixLengths = intArrayNew ();
+	m->prefixLengths = intArrayNew ();
+	m->globs = stringListNew ();
+	m->buffer = vStringNew ();
+
+	for (unsigned int i = 0; i < stringListCount (list); i++)
+	{
+		const vString *vpattern = stringListItem (list, i);
+		const char *pattern = vStringValue (vpattern);
+		size_t len = vStringLength (vpattern);
+
+		if (! hasWildcard (pattern))
+			addToExcludeMatcherTable (m->literals, NULL, pattern, len);
+		else if (pattern [0] == '*' && ! hasWildcard (pattern + 1))
+			addToExcludeMatcherTable (m->suffixes, m->suffixLengths,
+									  pattern + 1, len - 1);
+		else if (len > 1 && pattern [len - 1] == '*'
+				 && strpbrk (pattern, "?[\\") == NULL
+				 && strchr (pattern, '*') == pattern + len - 1)
+			addToExcludeMatcherTable (m->prefixes, m->prefixLengths,
+									  pattern, len - 1);
+		else
+			stringListAdd (m->globs, vStringNewCopy (vpattern));
+	}
+	m->compiled = true;
+}
+
+static bool excludeMatcherMatches (excludeMatcher *m, const char *fileName)
+{
+	size_t len = strlen (fileName);
+
+	if (hashTableHasItem (m->literals, fileName))
+		return true;
+
+	for (unsigned int i = 0; i < intArrayCount (m->suffixLengths); i++)
+	{
+		size_t l = (size_t) intArrayItem (m->suffixLengths, i);
+		if (l <= len && hashTableHasItem (m->suffixes, fileName + len - l))
+			return true;
+	}
+
+	for (unsigned int i = 0; i < intArrayCount (m->prefixLengths); i++)
+	{
+		size_t l = (size_t) intArrayItem (m->prefixLengths, i);
+		if (l <= len)
+		{
+			vStringNCopyS (m->buffer, fileName, l);
+			if (hashTableHasItem (m->prefixes, vStringValue (m->buffer)))
+				return true;
+		}
+	}
+
+	return stringListFileMatched (m->globs, fileName);
+}
+
+/* Same as trying stringListFileMatched() on BASE, and then on NAME. */
+static bool isExcludeListMatched (excludeMatcher *m, const stringList *list,
+								  const char *base, const char *name)
+{
+	bool r;
+	const char *nbase = base, *nname = name;
+
+	if (! m->compiled)
+		compileExcludeMatcher (m, list);
+
+#if defined (WIN32)
+	vString *tmp = vStringNewInit (name);
+	vStringTranslate (tmp, PATH_SEPARATOR, OUTPUT_PATH_SEPARATOR);
+	nname = vStringValue (tmp);
+	nbase = nname + (base - name);
+#endif
+
+	r = excludeMatcherMatches (m, nbase);
+	if (! r && name != base)
+		r = excludeMatcherMatches (m, nname);
+
+#if defined (WIN32)
+	vStringDelete (tmp);
+#endif
+	return r;
+}
+
 static void processExcludeOptionCommon (
 	stringList** list, const char *const optname, const char *const parameter)
 {
 	const char *const fileName = parameter + 1;
+
+	clearExcludeMatcher ((list == &Excluded)
+						 ? &ExcludedMatcher
+						 : &ExcludedExceptionMatcher);
 	if (parameter [0] == '\0')
 		freeList (list);
 	else if (parameter [0] == '@')
@@ -1218,23 +1658,12 @@ extern bool isExcludedFile (const char* const name,
 		return false;
 
 	if (Excluded != NULL)
-	{
-		result = stringListFileMatched (Excluded, base);
-		if (! result  &&  name != base)
-			result = stringListFileMatched (Excluded, name);
-	}
+		result = isExcludeListMatched (&ExcludedMatcher, Excluded, base, name);
 
-	if (result && ExcludedException != NULL)
-	{
-		bool result_exception;
-
-		result_exception = stringListFileMatched (ExcludedException, base);
-		if (! result_exception && name != base)
-			result_exception = stringListFileMatched (ExcludedException, name);
-
-		if (result_exception)
-			result = false;
-	}
+	if (result && ExcludedException != NULL
+		&& isExcludeListMatched (&ExcludedExceptionMatcher, ExcludedException,
+								 base, name))
+		result = false;
 	return result;
 }
 
@@ -1433,6 +1862,80 @@ static void processFieldsOption (
 	}
 }
 
+static void processCacheDirOption (
+		const char *const option CTAGS_ATTR_UNUSED, const char *const parameter)
+{
+	freeString (&Option.cacheDirName);
+	if (parameter [0] != '\0')
+		Option.cacheDirName = stringCopy (parameter);
+}
+
+static void processCacheFileOption (
+		const char *const option CTAGS_ATTR_UNUSED, const char *const parameter)
+{
+	freeString (&Option.cacheFileName);
+	if (parameter [0] != '\0')
+		Option.cacheFileName = stringCopy (parameter);
+}
+
+static void processUpdateFromOption (
+		const char *const option CTAGS_ATTR_UNUSED, const char *const parameter)
+{
+	freeString (&Option.updateFileList);
+	if (parameter [0] != '\0')
+	{
+		Option.updateFileList = stringCopy (parameter);
+		Option.append = true;
+	}
+}
+
+static void processInputShardOption (
+		const char *const option, const char *const parameter)
+{
+	unsigned long i, n;
+	char *end;
+
+	if (strcmp (parameter, "no") == 0)
+	{
+		Option.shardIndex = 0;
+		Option.shardCount = 0;
+		return;
+	}
+
+	i = strtoul (parameter, &end, 10);
+	if (end == parameter || *end != '/')
+		error (FATAL, "Invalid value for \"%s\" option: %s", option, parameter);
+	n = strtoul (end + 1, &end, 10);
+	if (*end != '\0' || i < 1 || n < i || n > UINT_MAX)
+		error (FATAL, "Invalid value for \"%s\" option: %s", option, parameter);
+	Option.shardIndex = (unsigned int) i;
+	Option.shardCount = (unsigned int) n;
+}
+
+static void processFileStatsOption (
+		const char *const option CTAGS_ATTR_UNUSED, const char *const parameter)
+{
+	freeString (&Option.fileStatsFileName);
+	if (parameter [0] != '\0')
+		Option.fileStatsFileName = stringCopy (parameter);
+}
+
+static void processTraceEventsOption (
+		const char *const option CTAGS_ATTR_UNUSED, const char *const parameter)
+{
+	freeString (&Option.traceEventsFileName);
+	if (parameter [0] != '\0')
+		Option.traceEventsFileName = stringCopy (parameter);
+}
+
+static void processLanguageCacheOption (
+		const char *const option CTAGS_ATTR_UNUSED, const char *const parameter)
+{
+	freeString (&Option.languageCacheFileName);
+	if (parameter [0] != '\0')
+		Option.languageCacheFileName = stringCopy (parameter);
+}
+
 static void processFilterTerminatorOption (
 		const char *const option CTAGS_ATTR_UNUSED, const char *const parameter)
 {
@@ -1657,6 +2160,28 @@ static void processHelpFullOption (
 	exit (0);
 }
 
+#if defined (HAVE_SYS_SOCKET_H) && defined (HAVE_SYS_UN_H)
+static void processServerOption (
+		const char *const option, const char *const parameter)
+{
+	if (parameter == NULL || *parameter == '\0')
+		error (FATAL, "A socket path must be specified for --%s option", option);
+
+	Option.server = true;
+	setMainLoop (serverLoop, eStrdup (parameter));
+}
+
+static void processClientOption (
+		const char *const option, const char *const parameter)
+{
+	if (parameter == NULL || *parameter == '\0')
+		error (FATAL, "A socket path must be specified for --%s option", option);
+
+	Option.serverShutdown = (strcmp (option, "_shutdown-server") == 0);
+	setMainLoop (clientLoop, eStrdup (parameter));
+}
+#endif
+
 #ifdef HAVE_JANSSON
 static void processInteractiveOption (
 		const char *const option CTAGS_ATTR_UNUSED,
@@ -2402,10 +2927,10 @@ static void processOutputFormat (const char *const option CTAGS_ATTR_UNUSED,
 		setEtagsMode ();
 	else if (strcmp (parameter, "xref") == 0)
 		setXrefMode ();
-#ifdef HAVE_JANSSON
 	else if (strcmp (parameter, "json") == 0)
 		setJsonMode ();
-#endif
+	else if (strcmp (parameter, "binary") == 0)
+		setTagWriter (WRITER_BINARY, NULL);
 	else
 		error (FATAL, "unknown output format name supplied for \"%s=%s\"", option, parameter);
 }
@@ -2495,6 +3020,58 @@ static void processSortOption (
 		error (FATAL, "Invalid value for \"%s\" option", option);
 }
 
+static void processSortMethodOption (
+		const char *const option, const char *const parameter)
+{
+	if (strcmp (parameter, "internal") == 0)
+		Option.sortMethod = SORT_METHOD_INTERNAL;
+	else if (strcmp (parameter, "external") == 0)
+	{
+#ifdef EXTERNAL_SORT
+		Option.sortMethod = SORT_METHOD_EXTERNAL;
+#else
+		error (WARNING, "-%s: external sort is not available; the internal sort is used", option);
+		Option.sortMethod = SORT_METHOD_INTERNAL;
+#endif
+	}
+	else
+		error (FATAL, "Invalid value for \"%s\" option", option);
+}
+
+static void processSortMemoryLimitOption (
+		const char *const option, const char *const parameter)
+{
+	unsigned long limit;
+	unsigned long unit = 1;
+	char *end;
+
+	if (parameter == NULL || parameter[0] == '\0')
+		error (FATAL, "A parameter is needed after \"%s\" option", option);
+
+	errno = 0;
+	limit = strtoul (parameter, &end, 10);
+	if (end == parameter || errno != 0)
+		error (FATAL, "-%s: Invalid memory size: %s", option, parameter);
+
+	switch (*end)
+	{
+	case 'g': case 'G':
+		unit *= 1024;
+		/* Fall through */
+	case 'm': case 'M':
+		unit *= 1024;
+		/* Fall through */
+	case 'k': case 'K':
+		unit *= 1024;
+		end++;
+		break;
+	}
+	if (*end != '\0' || limit == 0 || limit > ((size_t)-1) / unit)
+		error (FATAL, "-%s: Invalid memory size: %s", option, parameter);
+
+	Option.sortMemoryLimit = limit * unit;
+}
+
 static void processTagRelative (
 		const char *const option, const char *const parameter)
 {
@@ -2787,6 +3364,95 @@ static void processMaxRecursionDepthOption (const char *const option, const char
 	Option.maxRecursionDepth = atol(parameter);
 }
 
+static void processInputOrderOption (const char *const option, const char *const parameter)
+{
+	if (strcmp (parameter, "given") == 0)
+		Option.inputOrder = INPUT_ORDER_GIVEN;
+	else if (strcmp (parameter, "unique") == 0)
+		Option.inputOrder = INPUT_ORDER_UNIQUE;
+	else if (strcmp (parameter, "directory") == 0)
+		Option.inputOrder = INPUT_ORDER_DIRECTORY;
+	else if (strcmp (parameter, "inode") == 0)
+		Option.inputOrder = INPUT_ORDER_INODE;
+	else
+		error (FATAL, "Invalid value for \"%s\" option: %s", option, parameter);
+}
+
+static void processShardByOption (const char *const option, const char *const parameter)
+{
+	if (strcmp (parameter, "no") == 0)
+		Option.shardBy = SHARD_BY_NONE;
+	else if (strcmp (parameter, "directory") == 0)
+		Option.shardBy = SHARD_BY_DIRECTORY;
+	else if (strcmp (parameter, "language") == 0)
+		Option.shardBy = SHARD_BY_LANGUAGE;
+	else
+		error (FATAL, "Invalid value for \"%s\" option: %s", option, parameter);
+}
+
+static void processJobsOrderOption (const char *const option, const char *const parameter)
+{
+	if (strcmp (parameter, "input") == 0)
+		Option.jobsOrder = JOBS_ORDER_INPUT;
+	else if (strcmp (parameter, "ready") == 0)
+		Option.jobsOrder = JOBS_ORDER_READY;
+	else
+		error (FATAL, "Invalid value for \"%s\" option: %s", option, parameter);
+}
+
+static void processJobsOption (const char *const option, const char *const parameter)
+{
+	if (parameter == NULL || parameter[0] == '\0')
+		error (FATAL, "A parameter is needed after \"%s\" option", option);
+
+	if (!strToUInt(parameter, 0, &Option.jobs) || Option.jobs < 1)
+		error (FATAL, "-%s: Invalid number of jobs", option);
+
+#ifndef HAVE_FORK
+	if (Option.jobs > 1)
+	{
+		error (WARNING, "-%s: not supported on this platform; ignored", option);
+		Option.jobs = 1;
+	}
+#endif
+}
+
+static void processSamplingProfileOption (const char *const option, const char *const parameter)
+{
+	if (parameter == NULL || parameter[0] == '\0')
+		error (FATAL, "A parameter is needed after \"%s\" option", option);
+
+	if (!strToUInt(parameter, 0, &Option.samplingProfile))
+		error (FATAL, "-%s: Invalid number of regions", option);
+}
+
+static void processSlowestFilesOption (const char *const option, const char *const parameter)
+{
+	if (parameter == NULL || parameter[0] == '\0')
+		error (FATAL, "A parameter is needed after \"%s\" option", option);
+
+	if (!strToUInt(parameter, 0, &Option.slowestFiles))
+		error (FATAL, "-%s: Invalid number of files", option);
+}
+
+static void processSplitSizeOption (const char *const option, const char *const parameter)
+{
+	if (parameter == NULL || parameter[0] == '\0')
+		error (FATAL, "A parameter is needed after \"%s\" option", option);
+
+	if (!strToUInt(parameter, 0, &Option.splitSize))
+		error (FATAL, "-%s: Invalid split size", option);
+}
+
+static void processSplitGuestsOption (const char *const option, const char *const parameter)
+{
+	if (parameter == NULL || parameter[0] == '\0')
+		error (FATAL, "A parameter is needed after \"%s\" option", option);
+
+	if (!strToUInt(parameter, 0, &Option.splitGuests))
+		error (FATAL, "-%s: Invalid number of guest regions", option);
+}
+
 static void processPatternLengthLimit(const char *const option, const char *const parameter)
 {
 	if (parameter == NULL || parameter[0] == '\0')
@@ -2834,6 +3500,9 @@ static void processDumpOptionsOption (const char *const option, const char *cons
 static void processDumpPreludeOption (const char *const option, const char *const parameter);
 
 static parametricOption ParametricOptions [] = {
+	{ "cache-dir",              processCacheDirOption,          true,   STAGE_ANY },
+	{ "cache-file",             processCacheFileOption,         true,   STAGE_ANY },
+	{ "language-cache",         processLanguageCacheOption,     true,   STAGE_ANY },
 	{ "etags-include",          processEtagsInclude,            false,  STAGE_ANY },
 	{ "exclude",                processExcludeOption,           false,  STAGE_ANY },
 	{ "exclude-exception",      processExcludeExceptionOption,  false,  STAGE_ANY },
@@ -2841,15 +3510,22 @@ static parametricOption ParametricOptions [] = {
 	{ "extra",                  processExtraTagsOption,         false,  STAGE_ANY },
 	{ "extras",                 processExtraTagsOption,         false,  STAGE_ANY },
 	{ "fields",                 processFieldsOption,            false,  STAGE_ANY },
+	{ "file-stats",             processFileStatsOption,         true,   STAGE_ANY },
 	{ "filter-terminator",      processFilterTerminatorOption,  true,   STAGE_ANY },
 	{ "format",                 processFormatOption,            true,   STAGE_ANY },
 	{ "help",                   processHelpOption,              true,   STAGE_ANY },
 	{ "help-full",              processHelpFullOption,          true,   STAGE_ANY },
 	{ "if0",                    processIf0Option,               false,  STAGE_ANY },
+	{ "input-order",            processInputOrderOption,        true,   STAGE_ANY },
+	{ "input-shard",            processInputShardOption,        true,   STAGE_ANY },
 #ifdef HAVE_ICONV
 	{ "input-encoding",         processInputEncodingOption,     false,  STAGE_ANY },
 	{ "output-encoding",        processOutputEncodingOption,    false,  STAGE_ANY },
 #endif
+	{ "jobs",                   processJobsOption,              true,   STAGE_ANY },
+	{ "jobs-order",             processJobsOrderOption,         true,   STAGE_ANY },
+	{ "split-size",             processSplitSizeOption,         true,   STAGE_ANY },
+	{ "split-guests",           processSplitGuestsOption,       true,   STAGE_ANY },
 	{ "lang",                   processLanguageForceOption,     false,  STAGE_ANY },
 	{ "language",               processLanguageForceOption,     false,  STAGE_ANY },
 	{ "language-force",         processLanguageForceOption,     false,  STAGE_ANY },
@@ -2881,11 +3557,21 @@ static parametricOption ParametricOptions [] = {
 	{ "output-format",          processOutputFormat,            true,   STAGE_ANY },
 	{ "pattern-length-limit",   processPatternLengthLimit,      true,   STAGE_ANY },
 	{ "pseudo-tags",            processPseudoTags,              false,  STAGE_ANY },
+	{ "shard-by",               processShardByOption,           true,   STAGE_ANY },
+	{ "sampling-profile",       processSamplingProfileOption,   true,   STAGE_ANY },
+	{ "slowest-files",          processSlowestFilesOption,      true,   STAGE_ANY },
 	{ "sort",                   processSortOption,              true,   STAGE_ANY },
+	{ "sort-memory-limit",      processSortMemoryLimitOption,   true,   STAGE_ANY },
+	{ "sort-method",            processSortMethodOption,        true,   STAGE_ANY },
 	{ "tag-relative",           processTagRelative,             true,   STAGE_ANY },
 	{ "totals",                 processTotals,                  true,   STAGE_ANY },
+	{ "update-from",            processUpdateFromOption,        true,   STAGE_ANY },
+	{ "trace-events",           processTraceEventsOption,       true,   STAGE_ANY },
 	{ "version",                processVersionOption,           true,   STAGE_ANY },
 	{ "_anonhash",              processAnonHashOption,          false,  STAGE_ANY },
+#if defined (HAVE_SYS_SOCKET_H) && defined (HAVE_SYS_UN_H)
+	{ "_client",                processClientOption,            true,   STAGE_ANY },
+#endif
 	{ "_dump-keywords",         processDumpKeywordsOption,      false,  STAGE_ANY },
 	{ "_dump-options",          processDumpOptionsOption,       false,  STAGE_ANY },
 	{ "_dump-prelude",          processDumpPreludeOption,       false,  STAGE_ANY },
@@ -2899,6 +3585,10 @@ static parametricOption ParametricOptions [] = {
 	{ "_list-langdef-flags",    processListLangdefFlagsOptions, true,   STAGE_ANY },
 	{ "_list-mtable-regex-flags", processListMultitableRegexFlagsOptions, true, STAGE_ANY },
 	{ "_list-operators",        processListOperators,           true,   STAGE_ANY },
+#if defined (HAVE_SYS_SOCKET_H) && defined (HAVE_SYS_UN_H)
+	{ "_server",                processServerOption,            true,   STAGE_ANY },
+	{ "_shutdown-server",       processClientOption,            true,   STAGE_ANY },
+#endif
 #ifdef DO_TRACING
 	{ "_trace",                 processTraceOption,             false,  STAGE_ANY },
 #endif
@@ -2907,6 +3597,9 @@ static parametricOption ParametricOptions [] = {
 
 static booleanOption BooleanOptions [] = {
 	{ "append",         &Option.append,                 true,  STAGE_ANY },
+	{ "dedup-headers",  &Option.dedupHeaders,           true,  STAGE_ANY },
+	{ "dedup-tags",     &Option.dedupTags,              true,  STAGE_ANY },
+	{ "file-index",     &Option.fileIndex,              true,  STAGE_ANY },
 	{ "file-scope",     ((bool *)XTAG_FILE_SCOPE),      false, STAGE_ANY, setBooleanToXtagWithWarning },
 	{ "file-tags",      ((bool *)XTAG_FILE_NAMES),      false, STAGE_ANY, setBooleanToXtagWithWarning },
 	{ "filter",         &Option.filter,                 true,  STAGE_ANY },
@@ -2914,12 +3607,18 @@ static booleanOption BooleanOptions [] = {
 	{ "line-directives",&Option.lineDirectives,         false, STAGE_ANY },
 	{ "links",          &Option.followLinks,            false, STAGE_ANY },
 	{ "machinable",     &localOption.machinable,        true,  STAGE_ANY },
+	{ "map-input",      &Option.mapInput,               true,  STAGE_ANY },
+	{ "merge-tags",     &Option.mergeTags,              true,  STAGE_ANY },
+	{ "name-index",     &Option.nameIndex,              true,  STAGE_ANY },
 	{ "put-field-prefix", &Option.putFieldPrefix,       false, STAGE_ANY },
 	{ "print-language", &Option.printLanguage,          true,  STAGE_ANY },
 	{ "quiet",          &Option.quiet,                  false, STAGE_ANY },
 #ifdef RECURSE_SUPPORTED
 	{ "recurse",        &Option.recurse,                false, STAGE_ANY },
 #endif
+	{ "sort-in-memory", &Option.sortInMemory,           true,  STAGE_ANY },
+	{ "trigram-index",  &Option.trigramIndex,           true,  STAGE_ANY },
+	{ "use-ignore-files", &Option.useIgnoreFiles,       false, STAGE_ANY },
 	{ "verbose",        &ctags_verbose,                 false, STAGE_ANY },
 #ifdef WIN32
 	{ "use-slash-as-filename-separator", (bool *)&Option.useSlashAsFilenameSeparator, false, STAGE_ANY },
@@ -3343,6 +4042,8 @@ static void processLongOption (
 	else if (processLanguageEncodingOption (option, parameter))
 		;
 #endif
+	else if (processInputBudgetOption (option, parameter))
+		;
 #ifndef RECURSE_SUPPORTED
 	else if (strcmp (option, "recurse") == 0)
 		error (WARNING, "%s option not supported on this host", option);
@@ -3480,11 +4181,49 @@ static void processShortOption (
 	}
 }
 
+/* Records the options processed so far. --cache-file uses this to
+ * know whether a cached entry was made with the same options. */
+static void addOptionFingerprint (cookedArgs* const args)
+{
+	/* These don't change the tags. The tag file name changes only the
+	 * paths written to them, which the cache checks by itself. */
+	static const char *const ignored [] = {
+		"V", "verbose", "quiet", "totals", "jobs", "jobs-order", "cache-file",
+		"cache-dir", "L", "update-from", "f", "o", "language-cache",
+		"input-shard", "merge-tags",
+		"input-order", "name-index", "dedup-headers", "split-size",
+		"split-guests", "trigram-index", "file-index", "slowest-files",
+		"file-stats", "trace-events", "sampling-profile", "map-input",
+	};
+
+	for (unsigned int i = 0; i < ARRAY_SIZE (ignored); i++)
+		if (strcmp (args->item, ignored [i]) == 0)
+			return;
+
+	if (OptionFingerprint == NULL)
+		OptionFingerprint = vStringNew ();
+
+	vStringCatS (OptionFingerprint, args->longOption? "--": "-");
+	vStringCatS (OptionFingerprint, args->item);
+	if (args->parameter)
+	{
+		vStringPut (OptionFingerprint, '=');
+		vStringCatS (OptionFingerprint, args->parameter);
+	}
+	vStringPut (OptionFingerprint, '\n');
+}
+
+extern const char *getOptionFingerprint (void)
+{
+	return OptionFingerprint? vStringValue (OptionFingerprint): "";
+}
+
 static void parseOption (cookedArgs* const args)
 {
 	Assert (! cArgOff (args));
 	if (args->isOption)
 	{
+		addOptionFingerprint (args);
 		if (args->longOption)
 			processLongOption (args->item, args->parameter);
 		else
@@ -3931,7 +4670,18 @@ extern void freeOptionResources (void)
 	freeString (&Option.tagFileName);
 	freeString (&Option.fileList);
 	freeString (&Option.filterTerminator);
-
+	freeString (&Option.cacheFileName);
+	freeString (&Option.cacheDirName);
+	freeString (&Option.updateFileList);
+	freeString (&Option.languageCacheFileName);
+	freeString (&Option.fileStatsFileName);
+	freeString (&Option.traceEventsFileName);
+
+	vStringDelete (OptionFingerprint);
+	OptionFingerprint = NULL;
+
+	clearExcludeMatcher (&ExcludedMatcher);
+	clearExcludeMatcher (&ExcludedExceptionMatcher);
 	freeList (&Excluded);
 	freeList (&ExcludedException);
 	freeList (&Option.headerExt);
@@ -3974,7 +4724,7 @@ extern bool isDestinationStdout (void)
 {
 	bool toStdout = false;
 
-	if (Option.filter || Option.interactive ||
+	if (Option.filter || Option.interactive || Option.server ||
 		(Option.tagFileName != NULL  &&  (strcmp (Option.tagFileName, "-") == 0
 						  || strcmp (Option.tagFileName, "/dev/stdout") == 0
 		)))
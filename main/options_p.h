@@ -63,6 +63,22 @@ typedef enum sortType {
 	SO_FOLDSORTED
 } sortType;
 
+typedef enum eSortMethod {
+	SORT_METHOD_INTERNAL,
+	SORT_METHOD_EXTERNAL,
+} sortMethod;
+
+typedef enum eShardBy {
+	SHARD_BY_NONE,
+	SHARD_BY_DIRECTORY,	/* the directory of the input file */
+	SHARD_BY_LANGUAGE,	/* the language of the tag */
+} shardBy;
+
+typedef enum eJobsOrder {
+	JOBS_ORDER_INPUT,	/* the order of the input files */
+	JOBS_ORDER_READY,	/* the order the workers exit in, if sorted */
+} jobsOrder;
+
 typedef enum eTagRelative {
 	TREL_NO,
 	TREL_YES,
@@ -79,9 +95,27 @@ typedef struct sOptionValues {
 	exCmd locate;           /* --excmd  EX command used to locate tag */
 	bool recurse;        /* -R  recurse into directories */
 	sortType sorted;        /* -u,--sort  sort tags */
+	sortMethod sortMethod;  /* --sort-method  how the tags are sorted */
+	size_t sortMemoryLimit; /* --sort-memory-limit  bytes kept in memory by the internal sort */
+	bool sortInMemory;   /* --sort-in-memory  sort the tags before writing the tag file */
+	bool nameIndex;      /* --name-index  write the name index of the sorted tag file */
+	bool trigramIndex;   /* --trigram-index  write the index of the trigrams in the names */
+	bool fileIndex;      /* --file-index  write the index of the tags of each input file */
+	shardBy shardBy;        /* --shard-by  split the tag file into shards */
+	char *cacheFileName;    /* --cache-file  name of the cache for incremental tagging */
+	char *cacheDirName;     /* --cache-dir  directory of the cache shared by the runs */
+	char *updateFileList;   /* --update-from  name of the list of the files changed or removed */
+	unsigned int shardIndex; /* --input-shard  the shard of the input files parsed, from 1 */
+	unsigned int shardCount; /* --input-shard  number of the shards, or 0 */
+	bool mergeTags;      /* --merge-tags  merge the tag files given as input files */
+	char *languageCacheFileName; /* --language-cache  name of the cache of guessed languages */
+	bool dedupHeaders;   /* --dedup-headers  parse C/C++ headers and makefiles having the same contents once */
+	bool dedupTags;      /* --dedup-tags  drop the tags written before */
 	bool xref;           /* -x  generate xref output instead */
 	fmtElement *customXfmt;	/* compiled code for --xformat=XFMT */
 	char *fileList;         /* -L  name of file containing names of files */
+	inputOrder inputOrder;  /* --input-order  how the input file names are ordered */
+	bool mapInput;       /* --map-input  read the input files through memory mapping */
 	char *tagFileName;      /* -o  name of tags file */
 	stringList* headerExt;  /* -h  header extensions */
 	stringList* etagsInclude;/* --etags-include  list of TAGS files to include*/
@@ -92,10 +126,15 @@ typedef struct sOptionValues {
 #endif
 	langType language;      /* --lang specified language override */
 	bool followLinks;    /* --link  follow symbolic links? */
+	bool useIgnoreFiles; /* --use-ignore-files  prune entries listed in .gitignore and .ignore */
 	bool filter;         /* --filter  behave as filter: files in, tags out */
 	char* filterTerminator; /* --filter-terminator  string to output */
 	tagRelative tagRelative;    /* --tag-relative file paths relative to tag file */
 	int  printTotals;    /* --totals  print cumulative statistics */
+	unsigned int slowestFiles; /* --slowest-files=<N>  print the N files parsed slowest */
+	char *fileStatsFileName;   /* --file-stats=<file>  write the statistics of each input file */
+	char *traceEventsFileName; /* --trace-events=<file>  write the spans of a run for a timeline viewer */
+	unsigned int samplingProfile; /* --sampling-profile=<N>  print the N hottest regions for each parser */
 	bool lineDirectives; /* --linedirectives  process #line directives */
 	bool printLanguage;  /* --print-language */
 	bool guessLanguageEagerly; /* --guess-language-eagerly|-G */
@@ -104,10 +143,16 @@ typedef struct sOptionValues {
 	unsigned int patternLengthLimit; /* --pattern-length-limit=N */
 	bool putFieldPrefix;		 /* --put-field-prefix */
 	unsigned int maxRecursionDepth; /* --maxdepth=<max-recursion-depth> */
+	unsigned int jobs;		/* --jobs=<N> */
+	jobsOrder jobsOrder;	/* --jobs-order=(input|ready) */
+	unsigned int splitSize;	/* --split-size=<N> */
+	unsigned int splitGuests;	/* --split-guests=<N> */
 	bool fieldsReset;				/* --fields=[^+-] */
 	enum interactiveMode { INTERACTIVE_NONE = 0,
 						   INTERACTIVE_DEFAULT,
 						   INTERACTIVE_SANDBOX, } interactive; /* --interactive */
+	bool server;			/* --_server */
+	bool serverShutdown;	/* --_shutdown-server */
 #ifdef WIN32
 	enum filenameSepOp { FILENAME_SEP_NO_REPLACE = false,
 						 FILENAME_SEP_USE_SLASH  = true,
@@ -141,6 +186,7 @@ extern cookedArgs* cArgNewFromString (const char* string);
 extern cookedArgs* cArgNewFromArgv (char* const* const argv);
 extern cookedArgs* cArgNewFromFile (FILE* const fp);
 extern cookedArgs* cArgNewFromLineFile (FILE* const fp);
+extern cookedArgs* cArgNewFromListFile (FILE* const fp, inputOrder order);
 extern void cArgDelete (cookedArgs* const current);
 extern bool cArgOff (cookedArgs* const current);
 extern bool cArgIsOption (cookedArgs* const current);
@@ -172,6 +218,7 @@ extern bool processAliasOption (const char *const option, const char *const para
 extern bool processTabledefOption (const char *const option, const char *const parameter);
 #ifdef HAVE_ICONV
 extern bool processLanguageEncodingOption (const char *const option, const char *const parameter);
+extern bool processInputBudgetOption (const char *const option, const char *const parameter);
 #endif
 extern bool processRoledefOption (const char *const option, const char *const parameter);
 extern bool processScopesepOption (const char *const option, const char *const parameter);
@@ -181,6 +228,7 @@ extern bool processPretendOption (const char *const option, const char *const pa
 extern bool processRolesOption (const char *const option, const char *const parameter);
 
 extern bool isDestinationStdout (void);
+extern const char *getOptionFingerprint (void);
 
 extern void setMainLoop (mainLoopFunc func, void *data);
 
@@ -17,15 +17,20 @@
 #define OPTION_WRITE
 #include "options_p.h"
 
+#include <limits.h>
 #include <string.h>
 
 #include "ctags.h"
 #include "debug.h"
+#include "dedup_p.h"
 #include "entry_p.h"
 #include "field_p.h"
 #include "flags_p.h"
 #include "htable.h"
+#include "jobs_p.h"
 #include "keyword.h"
+#include "langcache_p.h"
+#include "numarray.h"
 #include "lxpath_p.h"
 #include "param.h"
 #include "param_p.h"
@@ -39,10 +44,12 @@
 #include "read_p.h"
 #include "routines.h"
 #include "routines_p.h"
+#include "sampler_p.h"
 #include "stats_p.h"
 #include "subparser.h"
 #include "subparser_p.h"
 #include "trace.h"
+#include "traceevent_p.h"
 #include "trashbox.h"
 #include "trashbox_p.h"
 #include "vstring.h"
@@ -72,6 +79,25 @@ typedef struct {
 	enum specType specType;
 }  parserCandidate;
 
+/* --input-budget[-<LANG>] */
+typedef enum {
+	BUDGET_REDUCE,	/* parse with neither patterns nor signatures */
+	BUDGET_SKIP,
+} budgetAction;
+
+typedef struct sInputBudget {
+	bool set;
+	/* 0 for no limit */
+	unsigned long bytes;
+	unsigned long lines;
+	unsigned long msec;
+	unsigned long lineLength;	/* in the first INPUT_SAMPLE_SIZE bytes */
+	bool binary;	/* skip the input with a NUL byte in the sample */
+	budgetAction action;
+} inputBudget;
+
+#define INPUT_SAMPLE_SIZE (64 * 1024)
+
 typedef struct sParserObject {
 	parserDefinition *def;
 
@@ -92,6 +118,10 @@ typedef struct sParserObject {
 
 	unsigned int anonymousIdentiferId; /* managed by anon* functions */
 
+	unsigned int rescanCount;		/* Used for printing statistics. */
+	unsigned int resumedRescanCount;
+	unsigned long rescanSkippedLines;
+
 	struct slaveControlBlock *slaveControlBlock;
 	struct kindControlBlock  *kindControlBlock;
 	struct lregexControlBlock *lregexControlBlock;
@@ -104,8 +134,30 @@ typedef struct sParserObject {
 									  is set here if this parser is OLDLANG.
 									  LANG_IGNORE is set if no being pretended. */
 
+	inputBudget inputBudget;	/* --input-budget-<LANG>; DefaultInputBudget
+								   is used if not set */
 } parserObject;
 
+typedef struct sRescanCheckpoint {
+	bool enabled;
+	/* The checkpoint set in the current pass; lineNumber is 0 if none. */
+	unsigned long lineNumber;
+	size_t corkCount;
+	int lastPromise;
+	int parserState;
+	/* The checkpoint the current pass started at */
+	unsigned long resumeLineNumber;
+	int resumeParserState;
+} rescanCheckpoint;
+
+typedef struct sInputChunk {
+	unsigned long startLine;
+	/* Set when the parser reaches the end of the chunk clean */
+	bool endClean;
+	/* Set for the region of an edited buffer parsed in this process */
+	bool region;
+} inputChunk;
+
 /*
  * FUNCTION PROTOTYPES
  */
@@ -116,6 +168,7 @@ static void installKeywordTable (const langType language);
 static void installTagRegexTable (const langType language);
 static void installTagXpathTable (const langType language);
 static void anonResetMaybe (parserObject *parser);
+static bool anonUsedExcept (parserObject *parser);
 static void setupAnon (void);
 static void teardownAnon (void);
 static void uninstallTagXpathTable (const langType language);
@@ -154,6 +207,7 @@ static parserDefinitionFunc* BuiltInParsers[] = {
 #endif	/* EXTERNAL_PARSER_LIST */
 };
 static parserObject* LanguageTable = NULL;
+static inputBudget DefaultInputBudget;	/* --input-budget */
 static unsigned int LanguageCount = 0;
 static hashTable* LanguageHTable = NULL;
 static kindDefinition defaultFileKind = {
@@ -164,6 +218,9 @@ static kindDefinition defaultFileKind = {
 };
 
 static langType ctagsSelfTestLang;
+static rescanCheckpoint RescanCheckpoint;
+/* The chunk of the input file parsed, or NULL if the whole file is */
+static inputChunk *InputChunk;
 
 /*
 *   FUNCTION DEFINITIONS
@@ -186,6 +243,17 @@ extern unsigned int countParsers (void)
 	return LanguageCount;
 }
 
+/* Most parsers have no regex pattern, and most of the parsers are not
+ * used in a run. The control block is allocated when it is used first. */
+static struct lregexControlBlock *getLregexControlBlock (const langType language)
+{
+	parserObject *const parser = LanguageTable + language;
+
+	if (parser->lregexControlBlock == NULL)
+		parser->lregexControlBlock = allocLregexControlBlock (parser->def);
+	return parser->lregexControlBlock;
+}
+
 extern int makeSimpleTag (
 		const vString* const name, const int kindIndex)
 {
@@ -466,53 +534,192 @@ extern langType getLanguageForCommand (const char *const command, langType start
 											&tmp_specType);
 }
 
-static langType getPatternLanguageAndSpec (const char *const baseName, langType start_index,
-					   const char **const spec, enum specType *specType)
+/* Index of the language maps for choosing the parser for a file name.
+ * Each index maps a key to the languages, in the ascending order,
+ * having a mapping for the key. The indexes are rebuilt after
+ * modifying the maps. */
+static bool LanguageMapIndexStale = true;
+static hashTable *ExtensionIndex;		/* extension -> intArray */
+static hashTable *PatternNameIndex;		/* pattern without wildcards -> intArray */
+static intArray  *GlobPatternLanguages;	/* languages having a pattern with wildcards */
+
+/* Incremented whenever the maps, the aliases, or the enabled state of a
+ * language are changed. */
+static unsigned int LanguageMapGeneration;
+
+static void invalidateLanguageMapIndex (void)
 {
-	langType result = LANG_IGNORE;
-	unsigned int i;
+	LanguageMapIndexStale = true;
+	LanguageMapGeneration++;
+}
 
-	if (start_index == LANG_AUTO)
-	        start_index = 0;
-	else if (start_index == LANG_IGNORE || start_index >= (int) LanguageCount)
-		return result;
+static void freeLanguageMapIndex (void)
+{
+	if (ExtensionIndex)
+	{
+		hashTableDelete (ExtensionIndex);
+		ExtensionIndex = NULL;
+	}
+	if (PatternNameIndex)
+	{
+		hashTableDelete (PatternNameIndex);
+		PatternNameIndex = NULL;
+	}
+	if (GlobPatternLanguages)
+	{
+		intArrayDelete (GlobPatternLanguages);
+		GlobPatternLanguages = NULL;
+	}
+	invalidateLanguageMapIndex ();
+}
 
-	*spec = NULL;
-	for (i = start_index  ;  i < LanguageCount  &&  result == LANG_IGNORE  ;  ++i)
+static bool isGlobPattern (const char *pattern)
+{
+	/* fnmatch () is called without flags. */
+	return strpbrk (pattern, "*?[\\") != NULL;
+}
+
+static void addToLanguageMapIndex (hashTable *index, const char *key, langType language)
+{
+	intArray *langs = hashTableGetItem (index, key);
+
+	if (langs == NULL)
 	{
-		if (! isLanguageEnabled (i))
-			continue;
+		langs = intArrayNew ();
+		hashTablePutItem (index, eStrdup (key), langs);
+	}
+	if (intArrayIsEmpty (langs) || intArrayLast (langs) != language)
+		intArrayAdd (langs, language);
+}
+
+static hashTable *newLanguageMapIndex (void)
+{
+#ifdef CASE_INSENSITIVE_FILENAMES
+	return hashTableNew (1024, hashCstrcasehash, hashCstrcaseeq,
+						 eFree, (hashTableDeleteFunc)intArrayDelete);
+#else
+	return hashTableNew (1024, hashCstrhash, hashCstreq,
+						 eFree, (hashTableDeleteFunc)intArrayDelete);
+#endif
+}
+
+static void buildLanguageMapIndex (void)
+{
+	if (ExtensionIndex)
+		hashTableClear (ExtensionIndex);
+	else
+		ExtensionIndex = newLanguageMapIndex ();
+
+	if (PatternNameIndex)
+		hashTableClear (PatternNameIndex);
+	else
+		PatternNameIndex = newLanguageMapIndex ();
+
+	if (GlobPatternLanguages)
+		intArrayClear (GlobPatternLanguages);
+	else
+		GlobPatternLanguages = intArrayNew ();
 
+	for (unsigned int i = 0; i < LanguageCount; i++)
+	{
 		parserObject *parser = LanguageTable + i;
-		stringList* const ptrns = parser->currentPatterns;
-		vString* tmp;
+		stringList *ptrns = parser->currentPatterns;
+		stringList *exts = parser->currentExtensions;
 
-		if (ptrns != NULL && (tmp = stringListFileFinds (ptrns, baseName)))
+		for (unsigned int j = 0; ptrns && j < stringListCount (ptrns); j++)
 		{
-			result = i;
-			*spec = vStringValue(tmp);
-			*specType = SPEC_PATTERN;
-			goto found;
+			const char *ptrn = vStringValue (stringListItem (ptrns, j));
+
+			if (! isGlobPattern (ptrn))
+				addToLanguageMapIndex (PatternNameIndex, ptrn, i);
+			else if (intArrayIsEmpty (GlobPatternLanguages)
+					 || intArrayLast (GlobPatternLanguages) != (int) i)
+				intArrayAdd (GlobPatternLanguages, i);
 		}
+
+		for (unsigned int j = 0; exts && j < stringListCount (exts); j++)
+			addToLanguageMapIndex (ExtensionIndex,
+								   vStringValue (stringListItem (exts, j)), i);
 	}
 
-	for (i = start_index  ;  i < LanguageCount  &&  result == LANG_IGNORE  ;  ++i)
+	LanguageMapIndexStale = false;
+}
+
+/* Return the first language in LANGS at START_INDEX or after it
+ * accepted by FINDS. */
+static langType findInLanguageMapIndex (const intArray *langs, langType start_index,
+										vString * (* finds) (parserObject *, const char *),
+										const char *key, vString **found)
+{
+	for (unsigned int i = 0; langs && i < intArrayCount (langs); i++)
 	{
-		if (! isLanguageEnabled (i))
+		langType lang = intArrayItem (langs, i);
+
+		if (lang < start_index || ! isLanguageEnabled (lang))
 			continue;
 
-		parserObject *parser = LanguageTable + i;
-		stringList* const exts = parser->currentExtensions;
-		vString* tmp;
+		if ((*found = finds (LanguageTable + lang, key)))
+			return lang;
+	}
+	return LANG_IGNORE;
+}
 
-		if (exts != NULL && (tmp = stringListExtensionFinds (exts,
-								     fileExtension (baseName))))
-		{
-			result = i;
-			*spec = vStringValue(tmp);
-			*specType = SPEC_EXTENSION;
-			goto found;
-		}
+static vString *findPattern (parserObject *parser, const char *baseName)
+{
+	return parser->currentPatterns
+		? stringListFileFinds (parser->currentPatterns, baseName)
+		: NULL;
+}
+
+static vString *findExtension (parserObject *parser, const char *extension)
+{
+	return parser->currentExtensions
+		? stringListExtensionFinds (parser->currentExtensions, extension)
+		: NULL;
+}
+
+static langType getPatternLanguageAndSpec (const char *const baseName, langType start_index,
+					   const char **const spec, enum specType *specType)
+{
+	langType result = LANG_IGNORE;
+	vString *tmp = NULL;
+
+	if (start_index == LANG_AUTO)
+	        start_index = 0;
+	else if (start_index == LANG_IGNORE || start_index >= (int) LanguageCount)
+		return result;
+
+	if (LanguageMapIndexStale)
+		buildLanguageMapIndex ();
+
+	*spec = NULL;
+
+	/* A language may have both kinds of patterns; take the smaller. */
+	vString *tmpGlob = NULL;
+	langType byName = findInLanguageMapIndex (hashTableGetItem (PatternNameIndex, baseName),
+											  start_index, findPattern, baseName, &tmp);
+	langType byGlob = findInLanguageMapIndex (GlobPatternLanguages,
+											  start_index, findPattern, baseName, &tmpGlob);
+	if (byGlob != LANG_IGNORE && (byName == LANG_IGNORE || byGlob < byName))
+	{
+		byName = byGlob;
+		tmp = tmpGlob;
+	}
+	if (byName != LANG_IGNORE)
+	{
+		result = byName;
+		*spec = vStringValue(tmp);
+		*specType = SPEC_PATTERN;
+		goto found;
+	}
+
+	const char *extension = fileExtension (baseName);
+	result = findInLanguageMapIndex (hashTableGetItem (ExtensionIndex, extension),
+									 start_index, findExtension, extension, &tmp);
+	if (result != LANG_IGNORE)
+	{
+		*spec = vStringValue(tmp);
+		*specType = SPEC_EXTENSION;
 	}
 found:
 	return result;
@@ -997,6 +1204,9 @@ static vString* extractVimFileTypeCommon(MIO* input, bool eof)
 				break;
 			}
 		}
+	/* The last readLineRaw() may fill the last slot of the ring. */
+	if (i == RING_SIZE)
+		i = 0;
 
 	j = i;
 	do
@@ -1016,7 +1226,7 @@ static vString* extractVimFileTypeCommon(MIO* input, bool eof)
 				filetype = determineVimFileType(p);
 				break;
 			}
-	} while (((i == RING_SIZE)? (j != RING_SIZE - 1): (j != i)) && (!filetype));
+	} while ((j != i) && (!filetype));
 
 	for (i = RING_SIZE - 1; i >= 0; i--)
 		vStringDelete (ring[i]);
@@ -1097,12 +1307,15 @@ static vString* extractPHPMark(MIO* input)
 struct getLangCtx {
     const char *fileName;
     MIO        *input;
+    MIO        *head;			/* sniffing windows of input; see prepareSniffWindows() */
+    MIO        *tail;
+    time_t      mtime;			/* valid if input is opened by GLC_FOPEN_IF_NECESSARY0 */
     bool     err;
 };
 
 #define GLC_FOPEN_IF_NECESSARY0(_glc_, _label_) do {        \
     if (!(_glc_)->input) {                                  \
-	    (_glc_)->input = getMio((_glc_)->fileName, "rb", false);	\
+	    (_glc_)->input = getMioFull((_glc_)->fileName, "rb", false, &(_glc_)->mtime); \
         if (!(_glc_)->input) {                              \
             (_glc_)->err = true;                            \
             goto _label_;                                   \
@@ -1128,15 +1341,95 @@ struct getLangCtx {
 	} while (0)
 
 #define GLC_FCLOSE(_glc_) do {                              \
+    if ((_glc_)->head) {                                    \
+        mio_unref((_glc_)->head);                           \
+        mio_unref((_glc_)->tail);                           \
+        (_glc_)->head = (_glc_)->tail = NULL;               \
+    }                                                       \
     if ((_glc_)->input) {                                   \
         mio_unref((_glc_)->input);                             \
         (_glc_)->input = NULL;                              \
     }                                                       \
 } while (0)
 
+/* Tasters look only at the first few lines or at the last few lines of
+ * the input. Instead of rewinding and seeking the input for each taster,
+ * the head and the tail of the input are read once into memory, and the
+ * tasters run against these windows. Guessing reads at most
+ * SNIFF_HEAD_SIZE + SNIFF_TAIL_SIZE bytes however many tasters run.
+ *
+ * Emacs looks for a local variables list in the last 3000 characters,
+ * and vim looks for modelines in the last 5 lines. SNIFF_TAIL_SIZE
+ * covers the both. */
+#define SNIFF_HEAD_SIZE 4096
+#define SNIFF_TAIL_SIZE 3000
+
+static MIO *newSniffWindow (MIO *input, long start, long size)
+{
+	unsigned char *data = mio_memory_get_data (input, NULL);
+
+	/* A memory (or mapped) input can be shared without copying. */
+	if (data)
+		return mio_new_memory (data + start, size, NULL, NULL);
+	return mio_new_mio (input, start, size);
+}
+
+static void prepareSniffWindows (struct getLangCtx *glc)
+{
+	size_t len;
+	long size;
+
+	if (glc->head)
+		return;
+
+	if (mio_memory_get_data (glc->input, &len))
+		size = (long)len;
+	else
+	{
+		long original_pos = mio_tell (glc->input);
+
+		if (mio_seek (glc->input, 0, SEEK_END) == 0)
+			size = mio_tell (glc->input);
+		else
+			size = -1;
+		mio_seek (glc->input, original_pos, SEEK_SET);
+	}
+
+	if (size <= 0)
+		;
+	else if (size <= SNIFF_HEAD_SIZE + SNIFF_TAIL_SIZE)
+	{
+		glc->head = newSniffWindow (glc->input, 0, size);
+		if (glc->head)
+			glc->tail = mio_ref (glc->head);
+	}
+	else
+	{
+		glc->head = newSniffWindow (glc->input, 0, SNIFF_HEAD_SIZE);
+		if (glc->head)
+		{
+			glc->tail = newSniffWindow (glc->input, size - SNIFF_TAIL_SIZE,
+										SNIFF_TAIL_SIZE);
+			if (!glc->tail)
+			{
+				mio_unref (glc->head);
+				glc->head = NULL;
+			}
+		}
+	}
+
+	/* Fall back to reading the input itself. */
+	if (!glc->head)
+	{
+		glc->head = mio_ref (glc->input);
+		glc->tail = mio_ref (glc->input);
+	}
+}
+
 static const struct taster {
 	vString* (* taste) (MIO *);
 	const char     *msg;
+	bool     atEOF;
 } eager_tasters[] = {
 	{
 		.taste  = extractInterpreter,
@@ -1153,6 +1446,7 @@ static const struct taster {
 	{
 		.taste  = extractEmacsModeLanguageAtEOF,
 		.msg    = "emacs mode at the EOF",
+		.atEOF  = true,
 	},
 	{
 		.taste  = extractVimFileTypeAtBOF,
@@ -1161,6 +1455,7 @@ static const struct taster {
 	{
 		.taste  = extractVimFileTypeAtEOF,
 		.msg    = "vim modeline at the EOF",
+		.atEOF  = true,
 	},
 	{
 		.taste  = extractPHPMark,
@@ -1401,12 +1696,14 @@ tasteLanguage (struct getLangCtx *glc, const struct taster *const tasters, int n
 
     if (fallback)
 	    *fallback = LANG_IGNORE;
+    prepareSniffWindows (glc);
     for (i = 0; i < n_tasters; ++i) {
         langType language;
         vString* spec;
+        MIO *window = tasters[i].atEOF? glc->tail: glc->head;
 
-        mio_rewind(glc->input);
-	spec = tasters[i].taste(glc->input);
+        mio_rewind(window);
+	spec = tasters[i].taste(window);
 
         if (NULL != spec) {
             verbose ("	%s: %s\n", tasters[i].msg, vStringValue (spec));
@@ -1467,6 +1764,9 @@ getFileLanguageForRequestInternal (struct GetLanguageRequest *req)
     struct getLangCtx glc = {
         .fileName = fileName,
         .input    = (req->type == GLR_REUSE)? mio_ref (req->mio): NULL,
+        .head     = NULL,
+        .tail     = NULL,
+        .mtime    = (time_t)0,
         .err      = false,
     };
     const char* const baseName = baseFilename (fileName);
@@ -1526,10 +1826,9 @@ getFileLanguageForRequestInternal (struct GetLanguageRequest *req)
 	if (req->type == GLR_OPEN && glc.input)
 	{
 		req->mio = mio_ref (glc.input);
-		if (!fstatus)
-			fstatus = eStat (fileName);
-		if (fstatus)
-			req->mtime = fstatus->mtime;
+		/* Don't stat the file again; the stat cache is dropped when
+		 * the file is opened. */
+		req->mtime = glc.mtime;
 	}
     GLC_FCLOSE(&glc);
     if (fstatus)
@@ -1561,7 +1860,20 @@ static langType getFileLanguageForRequest (struct GetLanguageRequest *req)
 	langType l = Option.language;
 
 	if (l == LANG_AUTO)
-		return getFileLanguageForRequestInternal(req);
+	{
+		/* The contents of a reused stream may not be the ones of the file. */
+		bool useCache = (req->type != GLR_REUSE);
+
+		if (useCache && (l = getCachedLanguage (req->fileName)) != LANG_AUTO)
+			return l;
+
+		const timingPhase phase = enterTimingPhase (PHASE_GUESS);
+		l = getFileLanguageForRequestInternal(req);
+		leaveTimingPhase (phase);
+		if (useCache)
+			cacheLanguage (req->fileName, l);
+		return l;
+	}
 	else if (! isLanguageEnabled (l))
 	{
 		error (FATAL,
@@ -1630,6 +1942,7 @@ extern void installLanguageMapDefault (const langType language)
 		stringListDelete (parser->currentPatterns);
 	if (parser->currentExtensions != NULL)
 		stringListDelete (parser->currentExtensions);
+	invalidateLanguageMapIndex ();
 
 	if (parser->def->patterns == NULL)
 		parser->currentPatterns = stringListNew ();
@@ -1670,6 +1983,7 @@ extern void installLanguageAliasesDefault (const langType language)
 	parser = LanguageTable + language;
 	if (parser->currentAliases != NULL)
 		stringListDelete (parser->currentAliases);
+	LanguageMapGeneration++;
 
 	if (parser->def->aliases == NULL)
 		parser->currentAliases = stringListNew ();
@@ -1702,6 +2016,7 @@ extern void clearLanguageMap (const langType language)
 	Assert (0 <= language  &&  language < (int) LanguageCount);
 	stringListClear ((LanguageTable + language)->currentPatterns);
 	stringListClear ((LanguageTable + language)->currentExtensions);
+	invalidateLanguageMapIndex ();
 }
 
 extern void clearLanguageAliases (const langType language)
@@ -1711,6 +2026,7 @@ extern void clearLanguageAliases (const langType language)
 	parserObject* parser = (LanguageTable + language);
 	if (parser->currentAliases)
 		stringListClear (parser->currentAliases);
+	LanguageMapGeneration++;
 }
 
 static bool removeLanguagePatternMap1(const langType language, const char *const pattern)
@@ -1721,6 +2037,7 @@ static bool removeLanguagePatternMap1(const langType language, const char *const
 	if (ptrn != NULL && stringListDeleteItemExtension (ptrn, pattern))
 	{
 		verbose (" (removed from %s)", getLanguageName (language));
+		invalidateLanguageMapIndex ();
 		result = true;
 	}
 	return result;
@@ -1751,6 +2068,7 @@ extern void addLanguagePatternMap (const langType language, const char* ptrn,
 	if (exclusiveInAllLanguages)
 		removeLanguagePatternMap (LANG_AUTO, ptrn);
 	stringListAdd (parser->currentPatterns, str);
+	invalidateLanguageMapIndex ();
 }
 
 static bool removeLanguageExtensionMap1 (const langType language, const char *const extension)
@@ -1761,6 +2079,7 @@ static bool removeLanguageExtensionMap1 (const langType language, const char *co
 	if (exts != NULL  &&  stringListDeleteItemExtension (exts, extension))
 	{
 		verbose (" (removed from %s)", getLanguageName (language));
+		invalidateLanguageMapIndex ();
 		result = true;
 	}
 	return result;
@@ -1790,6 +2109,7 @@ extern void addLanguageExtensionMap (
 	if (exclusiveInAllLanguages)
 		removeLanguageExtensionMap (LANG_AUTO, extension);
 	stringListAdd ((LanguageTable + language)->currentExtensions, str);
+	invalidateLanguageMapIndex ();
 }
 
 extern void addLanguageAlias (const langType language, const char* alias)
@@ -1801,12 +2121,44 @@ extern void addLanguageAlias (const langType language, const char* alias)
 	if (parser->currentAliases == NULL)
 		parser->currentAliases = stringListNew ();
 	stringListAdd (parser->currentAliases, str);
+	LanguageMapGeneration++;
 }
 
 extern void enableLanguage (const langType language, const bool state)
 {
 	Assert (0 <= language  &&  language < (int) LanguageCount);
 	LanguageTable [language].def->enabled = state;
+	LanguageMapGeneration++;
+}
+
+extern unsigned int getLanguageMapGeneration (void)
+{
+	return LanguageMapGeneration;
+}
+
+static void catLanguageMapFingerprint1 (vString *fp, char type, stringList *list)
+{
+	for (unsigned int i = 0; list && i < stringListCount (list); i++)
+	{
+		vStringPut (fp, type);
+		vStringCat (fp, stringListItem (list, i));
+		vStringPut (fp, '\n');
+	}
+}
+
+extern void catLanguageMapFingerprint (vString *fp)
+{
+	for (unsigned int i = 0; i < LanguageCount; i++)
+	{
+		parserObject *parser = LanguageTable + i;
+
+		vStringPut (fp, parser->def->enabled? '+': '-');
+		vStringCatS (fp, parser->def->name);
+		vStringPut (fp, '\n');
+		catLanguageMapFingerprint1 (fp, 'a', parser->currentAliases);
+		catLanguageMapFingerprint1 (fp, 'e', parser->currentExtensions);
+		catLanguageMapFingerprint1 (fp, 'p', parser->currentPatterns);
+	}
 }
 
 #ifdef DO_TRACING
@@ -1874,6 +2226,10 @@ static void initializeParserOne (langType lang)
 	installFieldDefinition     (lang);
 	installXtagDefinition      (lang);
 
+	/* The regex patterns of built-in parsers are compiled when
+	   they are used first. */
+	deferRegexCompilation (true);
+
 	/* regex definitions refers xtag definitions.
 	   So installing RegexTable must be after installing
 	   xtag definitions. */
@@ -1882,6 +2238,8 @@ static void initializeParserOne (langType lang)
 	if (parser->def->initialize != NULL)
 		parser->def->initialize (lang);
 
+	deferRegexCompilation (false);
+
 	initializeDependencies (parser->def, parser->slaveControlBlock);
 
 	Assert (parser->fileKind != NULL);
@@ -1983,7 +2341,7 @@ static void initializeParsingCommon (parserDefinition *def, bool is_builtin)
 
 	parser->kindControlBlock  = allocKindControlBlock (def);
 	parser->slaveControlBlock = allocSlaveControlBlock (def);
-	parser->lregexControlBlock = allocLregexControlBlock (def);
+	parser->lregexControlBlock = NULL;
 	parser->paramControlBlock = allocParamControlBlock (def);
 }
 
@@ -2060,7 +2418,8 @@ extern void freeParserResources (void)
 
 		uninstallTagXpathTable (i);
 
-		freeLregexControlBlock (parser->lregexControlBlock);
+		if (parser->lregexControlBlock)
+			freeLregexControlBlock (parser->lregexControlBlock);
 		freeKindControlBlock (parser->kindControlBlock);
 		parser->kindControlBlock = NULL;
 
@@ -2083,6 +2442,8 @@ extern void freeParserResources (void)
 		eFree (LanguageTable);
 	LanguageTable = NULL;
 	LanguageCount = 0;
+
+	freeLanguageMapIndex ();
 }
 
 static void doNothing (void)
@@ -2362,6 +2723,7 @@ extern void processLanguageDefineOption (
 
 	LanguageTable [def->id].currentPatterns = stringListNew ();
 	LanguageTable [def->id].currentExtensions = stringListNew ();
+	invalidateLanguageMapIndex ();
 	LanguageTable [def->id].pretendingAsLanguage = LANG_IGNORE;
 	LanguageTable [def->id].pretendedAsLanguage = LANG_IGNORE;
 
@@ -2380,6 +2742,12 @@ extern bool isLanguageRoleEnabled (const langType language, int kindIndex, int r
 						 kindIndex, roleIndex);
 }
 
+extern roleBitsType getLanguageEnabledRoleBits (const langType language, int kindIndex)
+{
+	return getEnabledRoleBits (LanguageTable [language].kindControlBlock,
+							   kindIndex);
+}
+
 extern bool isLanguageKindRefOnly (const langType language, int kindIndex)
 {
 	kindDefinition * def =  getLanguageKind(language, kindIndex);
@@ -3394,7 +3762,7 @@ extern bool processParamOption (
 		error (FATAL, "no value is given for %s", option);
 
 	if (applyLanguageParam (language, name, value))
-		propagateParamToOptscript (LanguageTable [language].lregexControlBlock,
+		propagateParamToOptscript (getLregexControlBlock (language),
 								   name, value);
 	return true;
 }
@@ -3953,15 +4321,25 @@ static rescanReason createTagsForFile (const langType language,
 	rescanReason rescan = RESCAN_NONE;
 
 	resetInputFile (language);
+	if (RescanCheckpoint.resumeLineNumber > 0)
+		skipInputFileLines (RescanCheckpoint.resumeLineNumber);
+	else if (InputChunk)
+	{
+		skipInputFileLines (InputChunk->startLine - 1);
+		InputChunk->endClean = false;
+	}
+	RescanCheckpoint.lineNumber = 0;
 
 	Assert (lang->parser || lang->parser2);
 
 	notifyInputStart ();
 
+	beginTraceEvent (TRACE_PARSER, lang->name);
 	if (lang->parser != NULL)
 		lang->parser ();
 	else if (lang->parser2 != NULL)
 		rescan = lang->parser2 (passCount);
+	endTraceEvent (TRACE_PARSER);
 
 	notifyInputEnd ();
 
@@ -3973,7 +4351,7 @@ extern void notifyLanguageRegexInputStart (langType language)
 	parserObject *pobj = LanguageTable + language;
 	parserDefinition *pdef = pobj->def;
 
-	notifyRegexInputStart(pobj->lregexControlBlock);
+	notifyRegexInputStart(getLregexControlBlock (language));
 	for (unsigned int i = 0; i < pdef->dependencyCount; i++)
 	{
 		parserDependency *d = pdef->dependencies + i;
@@ -4003,7 +4381,7 @@ extern void notifyLanguageRegexInputEnd (langType language)
 
 		notifyLanguageRegexInputEnd (foreigner);
 	}
-	notifyRegexInputEnd((LanguageTable + language)->lregexControlBlock);
+	notifyRegexInputEnd(getLregexControlBlock (language));
 }
 
 static unsigned int parserCorkFlags (parserDefinition *parser)
@@ -4055,6 +4433,52 @@ static subparser* teardownLanguageSubparsersInUse (const langType language)
 	return teardownSubparsersInUse ((LanguageTable + language)->slaveControlBlock);
 }
 
+extern void setRescanCheckpoint (int parserState)
+{
+	unsigned long lineNumber;
+
+	if (! RescanCheckpoint.enabled)
+		return;
+
+	lineNumber = getInputLineNumberAtNewline ();
+	if (lineNumber == 0)
+		return;
+
+	RescanCheckpoint.lineNumber = lineNumber;
+	RescanCheckpoint.corkCount = countEntryInCorkQueue ();
+	RescanCheckpoint.lastPromise = getLastPromise ();
+	RescanCheckpoint.parserState = parserState;
+}
+
+extern bool getRescanCheckpoint (int *parserState)
+{
+	if (RescanCheckpoint.resumeLineNumber == 0)
+		return false;
+
+	*parserState = RescanCheckpoint.resumeParserState;
+	return true;
+}
+
+/* Drops the tags made after the checkpoint of the failed pass, and lets
+ * the next pass start at the checkpoint. */
+static bool resumeAtRescanCheckpoint (parserObject *parser)
+{
+	rescanCheckpoint *c = &RescanCheckpoint;
+
+	if (c->lineNumber == 0 || ! truncateCorkQueue (c->corkCount))
+		return false;
+
+	breakPromisesAfter (c->lastPromise);
+	c->resumeLineNumber = c->lineNumber;
+	c->resumeParserState = c->parserState;
+
+	parser->resumedRescanCount++;
+	parser->rescanSkippedLines += c->lineNumber;
+	verbose ("%s: resuming the scan after line %lu\n",
+			 getInputFileName (), c->lineNumber);
+	return true;
+}
+
 static void	initializeParserStats (parserObject *parser)
 {
 	if (Option.printTotals > 1 && parser->used == 0 && parser->def->initStats)
@@ -4074,12 +4498,60 @@ extern void printParserStatisticsIfUsed (langType language)
 			fputs("==============================================\n", stderr);
 			parser->def->printStats (language);
 		}
+		if (parser->rescanCount > 0)
+		{
+			fprintf(stderr, "\nRESCANS of %s\n", getLanguageName (language));
+			fputs("==============================================\n", stderr);
+			fprintf(stderr, "rescanned files: %u\n", parser->rescanCount);
+			fprintf(stderr, "resumed at a checkpoint: %u\n", parser->resumedRescanCount);
+			fprintf(stderr, "lines not rescanned: %lu\n", parser->rescanSkippedLines);
+		}
+		printLanguageRegexProfile (language);
 		printLanguageMultitableStatistics (language);
 	}
 }
 
+extern void setInputChunkEndClean (void)
+{
+	if (InputChunk)
+		InputChunk->endClean = true;
+}
+
+/* Tells jobs.c how the chunk ended, and renumbers the anonymous names
+ * of the chunk after the ones of the chunks before it. */
+static void endInputChunk (parserObject *parser, bool useCork,
+						   unsigned int passCount, int lastPromise)
+{
+	/* Without the cork queue, the tags are written already. */
+	bool clean = (useCork && InputChunk->endClean && passCount == 1
+				  && getLastPromise () == lastPromise);
+	unsigned int offset;
+
+	/* Only the anonymous names of PARSER are renumbered. */
+	if (anonUsedExcept (parser))
+		clean = false;
+
+	/* The anonymous names of a region cannot be renumbered: the ones
+	 * made before the region are not counted. */
+	if (InputChunk->region)
+	{
+		InputChunk->endClean = clean && parser->anonymousIdentiferId == 0;
+		return;
+	}
+
+	offset = reportInputChunk (clean, parser->anonymousIdentiferId);
+	if (offset > 0 && parser->anonymousIdentiferId > 0)
+	{
+		char hash [9];
+
+		anonHashString (getInputFileName (), hash);
+		renumberAnonInCorkQueue (hash, parser->anonymousIdentiferId, offset);
+	}
+}
+
 static bool createTagsWithFallback1 (const langType language,
-									 langType *exclusive_subparser)
+									 langType *exclusive_subparser,
+									 inputChunk *chunk)
 {
 	bool tagFileResized = false;
 	unsigned long numTags	= numTagsAdded ();
@@ -4090,6 +4562,8 @@ static bool createTagsWithFallback1 (const langType language,
 	parserObject *parser;
 	unsigned int corkFlags;
 	bool useCork = false;
+	rescanCheckpoint outerCheckpoint = RescanCheckpoint;
+	inputChunk *outerChunk = InputChunk;
 
 	initializeParser (language);
 	parser = &(LanguageTable [language]);
@@ -4108,10 +4582,24 @@ static bool createTagsWithFallback1 (const langType language,
 
 	anonResetMaybe (parser);
 
+	/* The tags made before a checkpoint are kept in the cork queue. */
+	RescanCheckpoint.enabled = useCork && ! hasLanguageLineRegexPatterns (language)
+		&& chunk == NULL;
+	RescanCheckpoint.resumeLineNumber = 0;
+	InputChunk = chunk;
+
 	while ( ( whyRescan =
 		  createTagsForFile (language, ++passCount) )
 		!= RESCAN_NONE)
 	{
+		RescanCheckpoint.resumeLineNumber = 0;
+		if (whyRescan == RESCAN_FAILED)
+		{
+			parser->rescanCount++;
+			if (resumeAtRescanCheckpoint (parser))
+				continue;
+		}
+
 		if (useCork)
 		{
 			uncorkTagFile();
@@ -4137,13 +4625,19 @@ static bool createTagsWithFallback1 (const langType language,
 		}
 	}
 
+	addFileStatisticsRescans (passCount - 1);
+
 	/* Force filling allLines buffer and kick the multiline regex parser */
 	if (hasLanguageMultilineRegexPatterns (language))
 		while (readLineFromInputFile () != NULL)
 			; /* Do nothing */
 
+	if (chunk)
+		endInputChunk (parser, useCork, passCount, lastPromise);
 	if (useCork)
 		uncorkTagFile();
+	RescanCheckpoint = outerCheckpoint;
+	InputChunk = outerChunk;
 
 	{
 		subparser *s = teardownLanguageSubparsersInUse (language);
@@ -4178,7 +4672,9 @@ extern bool runParserInNarrowedInputStream (const langType language,
 				 endLine, endCharOffset,
 				 sourceLineOffset,
 				 promise);
-	tagFileResized = createTagsWithFallback1 (language, NULL);
+	const timingPhase phase = enterTimingPhase (PHASE_GUEST);
+	tagFileResized = createTagsWithFallback1 (language, NULL, NULL);
+	leaveTimingPhase (phase);
 	popNarrowedInputStream  ();
 	return tagFileResized;
 
@@ -4200,9 +4696,19 @@ static bool createTagsWithFallback (
 	}
 	*failureInOpenning = false;
 
-	tagFileResized = createTagsWithFallback1 (language,
-											  &exclusive_subparser);
-	tagFileResized = forcePromises()? true: tagFileResized;
+	if (parseInputInChunks (language))
+	{
+		/* Count the lines not read in this process. */
+		if (Option.printTotals)
+			skipInputFileLines (ULONG_MAX);
+	}
+	else if (! writeTagsOfDuplicatedHeader (language, &exclusive_subparser))
+	{
+		tagFileResized = createTagsWithFallback1 (language,
+												  &exclusive_subparser, NULL);
+		tagFileResized = forcePromises()? true: tagFileResized;
+		endHeaderRecording (!tagFileResized, exclusive_subparser);
+	}
 
 	pushLanguage ((exclusive_subparser == LANG_IGNORE)
 				  ? language
@@ -4214,6 +4720,53 @@ static bool createTagsWithFallback (
 	return tagFileResized;
 }
 
+extern bool doesParserSplitInput (const langType language)
+{
+	return LanguageTable [language].def->splitInput != NULL;
+}
+
+static bool canSplitInput (const langType language)
+{
+	/* The patterns are matched against the whole input file. */
+	return (doesParserSplitInput (language)
+			&& ! Option.lineDirectives
+			&& ! hasLanguageLineRegexPatterns (language)
+			&& ! hasLanguageMultilineRegexPatterns (language));
+}
+
+extern bool splitInputFile (const langType language, size_t chunkSize,
+							ulongArray *lines)
+{
+	parserDefinition *const lang = LanguageTable [language].def;
+	const unsigned char *data;
+	size_t size;
+
+	if (! canSplitInput (language))
+		return false;
+
+	data = getInputFileData (&size);
+	if (data == NULL)
+		return false;
+
+	lang->splitInput (data, size, chunkSize, lines);
+	return ulongArrayCount (lines) > 0;
+}
+
+extern void parseInputChunk (const langType language,
+							 unsigned long startLine, unsigned long endLine)
+{
+	inputChunk chunk = {
+		.startLine = startLine,
+		.endClean = false,
+		.region = false,
+	};
+
+	/* No tag is written before the anonymous names are renumbered. */
+	holdCorkQueue ();
+	setInputFileLastLine (endLine);
+	createTagsWithFallback1 (language, NULL, &chunk);
+}
+
 static void printGuessedParser (const char* const fileName, langType language)
 {
 	const char *parserName;
@@ -4256,6 +4809,85 @@ static void addLanguageEncoding (const langType language,
 		Option.outputEncoding = eStrdup("UTF-8");
 }
 
+static void parseInputBudget (const char *const option, const char *const parameter,
+							  inputBudget *budget)
+{
+	char *spec;
+	char *item;
+
+	/* An empty parameter sets no limit, overriding --input-budget in
+	 * --input-budget-<LANG>. */
+	memset (budget, 0, sizeof (*budget));
+	budget->set = true;
+	budget->action = BUDGET_REDUCE;
+	if (parameter [0] == '\0')
+		return;
+
+	spec = eStrdup (parameter);
+	for (item = strtok (spec, ","); item; item = strtok (NULL, ","))
+	{
+		char *value = strchr (item, '=');
+		unsigned long *n = NULL;
+
+		if (value == NULL)
+			error (FATAL, "--%s: no value for \"%s\"", option, item);
+		*value++ = '\0';
+
+		if (strcmp (item, "bytes") == 0)
+			n = &budget->bytes;
+		else if (strcmp (item, "lines") == 0)
+			n = &budget->lines;
+		else if (strcmp (item, "msec") == 0)
+			n = &budget->msec;
+		else if (strcmp (item, "linelen") == 0)
+			n = &budget->lineLength;
+		else if (strcmp (item, "binary") == 0)
+		{
+			if (strcmp (value, "yes") == 0)
+				budget->binary = true;
+			else if (strcmp (value, "no") == 0)
+				budget->binary = false;
+			else
+				error (FATAL, "--%s: \"binary\" takes yes or no: %s", option, value);
+			continue;
+		}
+		else if (strcmp (item, "action") == 0)
+		{
+			if (strcmp (value, "reduce") == 0)
+				budget->action = BUDGET_REDUCE;
+			else if (strcmp (value, "skip") == 0)
+				budget->action = BUDGET_SKIP;
+			else
+				error (FATAL, "--%s: unknown action \"%s\"", option, value);
+			continue;
+		}
+		else
+			error (FATAL, "--%s: unknown budget \"%s\"", option, item);
+
+		if (! strToULong (value, 10, n))
+			error (FATAL, "--%s: invalid number for \"%s\": %s", option, item, value);
+	}
+	eFree (spec);
+}
+
+extern bool processInputBudgetOption (const char *const option, const char *const parameter)
+{
+	langType language;
+
+	if (strcmp (option, "input-budget") == 0)
+	{
+		parseInputBudget (option, parameter, &DefaultInputBudget);
+		return true;
+	}
+
+	language = getLanguageComponentInOption (option, "input-budget-");
+	if (language == LANG_IGNORE)
+		return false;
+
+	parseInputBudget (option, parameter, &LanguageTable [language].inputBudget);
+	return true;
+}
+
 extern bool processLanguageEncodingOption (const char *const option, const char *const parameter)
 {
 	langType language;
@@ -4309,9 +4941,15 @@ static void addParserPseudoTags (langType language)
 	}
 }
 
-extern bool doesParserRequireMemoryStream (const langType language)
+extern void forgetParserPseudoTags (void)
 {
-	Assert (0 <= language  &&  language < (int) LanguageCount);
+	for (unsigned int i = 0; i < LanguageCount; i++)
+		LanguageTable [i].pseudoTagPrinted = 0;
+}
+
+extern bool doesParserRequireMemoryStream (const langType language)
+{
+	Assert (0 <= language  &&  language < (int) LanguageCount);
 	parserDefinition *const lang = LanguageTable [language].def;
 	unsigned int i;
 
@@ -4361,8 +4999,11 @@ static bool parseMio (const char *const fileName, langType language, MIO* mio, t
 	setupAnon ();
 
 	initParserTrashBox ();
+	beginMemoryAccountingForFile ();
 
+	const timingPhase phase = enterTimingPhase (PHASE_PARSE);
 	tagFileResized = createTagsWithFallback (fileName, language, mio, mtime, &failureInOpenning);
+	leaveTimingPhase (phase);
 
 	finiParserTrashBox ();
 
@@ -4374,6 +5015,158 @@ static bool parseMio (const char *const fileName, langType language, MIO* mio, t
 		return teardownWriter(fileName);
 }
 
+static unsigned long countLines (const unsigned char *data, size_t size)
+{
+	unsigned long count = 0;
+
+	for (size_t i = 0; i < size; i++)
+		if (data [i] == '\n')
+			count++;
+	if (size > 0 && data [size - 1] != '\n')
+		count++;
+	return count;
+}
+
+static const inputBudget *getInputBudget (const langType language)
+{
+	const inputBudget *budget = &LanguageTable [language].inputBudget;
+
+	return budget->set? budget: &DefaultInputBudget;
+}
+
+static unsigned long countInputLines (MIO *mio)
+{
+	size_t size;
+	const unsigned char *data = mio_memory_get_data (mio, &size);
+	unsigned long count = 0;
+	int c, last = '\n';
+
+	if (data)
+		return countLines (data, size);
+
+	while ((c = mio_getc (mio)) != EOF)
+	{
+		if (c == '\n')
+			count++;
+		last = c;
+	}
+	if (last != '\n')
+		count++;
+	mio_rewind (mio);
+	return count;
+}
+
+/* Looks for a NUL byte and the lines longer than the budget in the
+ * first block of MIO. */
+static const char *checkInputSample (const inputBudget *budget, MIO *mio,
+									 budgetAction *action)
+{
+	static unsigned char sample [INPUT_SAMPLE_SIZE];
+	size_t size;
+	const unsigned char *data = mio_memory_get_data (mio, &size);
+
+	if (data)
+	{
+		if (size > sizeof (sample))
+			size = sizeof (sample);
+	}
+	else
+	{
+		size = mio_read (mio, sample, 1, sizeof (sample));
+		mio_rewind (mio);
+		data = sample;
+	}
+
+	if (budget->binary && memchr (data, '\0', size))
+	{
+		*action = BUDGET_SKIP;
+		return "binary contents";
+	}
+
+	if (budget->lineLength > 0)
+	{
+		const unsigned char *p = data;
+		const unsigned char *end = data + size;
+
+		while (p < end)
+		{
+			const unsigned char *nl = memchr (p, '\n', end - p);
+
+			if ((unsigned long) ((nl? nl: end) - p) > budget->lineLength)
+				return "over the budget of line length";
+			if (nl == NULL)
+				break;
+			p = nl + 1;
+		}
+	}
+	return NULL;
+}
+
+/* Returns a message telling how the input file exceeds the size in
+ * BUDGET, or NULL, and stores what to do with the file to ACTION. The
+ * file is opened if it is not yet to count its lines or to read its
+ * first block. */
+static const char *checkInputBudget (const inputBudget *budget,
+								  struct GetLanguageRequest *req,
+								  budgetAction *action)
+{
+	unsigned long bytes;
+	size_t size;
+
+	*action = budget->action;
+
+	if (budget->binary || budget->lineLength > 0)
+	{
+		if (req->mio == NULL && req->type == GLR_OPEN)
+			req->mio = mio_new_file (req->fileName, "rb");
+		if (req->mio)
+		{
+			const char *over = checkInputSample (budget, req->mio, action);
+			if (over)
+				return over;
+		}
+	}
+
+	if (budget->bytes > 0)
+	{
+		if (req->mio && mio_memory_get_data (req->mio, &size))
+			bytes = (unsigned long) size;
+		else
+			bytes = (unsigned long) eStat (req->fileName)->size;
+		if (bytes > budget->bytes)
+			return "over the budget of bytes";
+	}
+
+	if (budget->lines > 0)
+	{
+		if (req->mio == NULL && req->type == GLR_OPEN)
+			req->mio = mio_new_file (req->fileName, "rb");
+		if (req->mio && countInputLines (req->mio) > budget->lines)
+			return "over the budget of lines";
+	}
+	return NULL;
+}
+
+typedef struct sReducedParsing {
+	exCmd locate;
+	bool signature;
+} reducedParsing;
+
+/* The patterns and the signatures are the costs depending on the length
+ * of the lines, which a generated or minified file makes long. */
+static void beginReducedParsing (reducedParsing *saved)
+{
+	saved->locate = Option.locate;
+	saved->signature = enableField (FIELD_SIGNATURE, false);
+	Option.locate = EX_LINENUM;
+}
+
+static void endReducedParsing (const reducedParsing *saved)
+{
+	Option.locate = saved->locate;
+	enableField (FIELD_SIGNATURE, saved->signature);
+}
+
 extern bool parseFileWithMio (const char *const fileName, MIO *mio,
 							  void *clientData)
 {
@@ -4386,12 +5179,19 @@ extern bool parseFileWithMio (const char *const fileName, MIO *mio,
 	};
 	memset (&req.mtime, 0, sizeof (req.mtime));
 
+	beginFileStatistics (fileName);
+	beginTraceEvent (TRACE_FILE, fileName);
+	beginSamplingFile (fileName);
 	language = getFileLanguageForRequest (&req);
 	Assert (language != LANG_AUTO);
 
 	if (Option.printLanguage)
 	{
 		printGuessedParser (fileName, language);
+		endSamplingFile ();
+		endSamplingFile ();
+	endTraceEvent (TRACE_FILE);
+		endFileStatistics (LANG_IGNORE);
 		return tagFileResized;
 	}
 
@@ -4405,19 +5205,51 @@ extern bool parseFileWithMio (const char *const fileName, MIO *mio,
 		if (Option.filter && ! Option.interactive)
 			openTagFile ();
 
+		const inputBudget *budget = getInputBudget (language);
+		budgetAction action = budget->action;
+		const char *over = budget->set? checkInputBudget (budget, &req, &action): NULL;
+
+		if (over && action == BUDGET_SKIP)
+		{
+			error (WARNING, "skipping %s: %s", fileName, over);
+			setFileStatisticsBudget ("skipped");
+		}
+		else
+		{
+			reducedParsing saved;
+
+			if (over)
+			{
+				notice ("parsing %s without patterns and signatures: %s", fileName, over);
+				setFileStatisticsBudget ("reduced");
+				beginReducedParsing (&saved);
+			}
+			setInputTimeLimit (budget->msec);
 #ifdef HAVE_ICONV
-		/* TODO: checkUTF8BOM can be used to update the encodings. */
-		openConverter (getLanguageEncoding (language), Option.outputEncoding);
+			/* TODO: checkUTF8BOM can be used to update the encodings. */
+			openConverter (getLanguageEncoding (language), Option.outputEncoding);
 #endif
-		tagFileResized = parseMio (fileName, language, req.mio, req.mtime, true, clientData);
-		if (Option.filter && ! Option.interactive)
-			closeTagFile (tagFileResized);
-		addTotals (1, 0L, 0L);
+			tagFileResized = parseMio (fileName, language, req.mio, req.mtime, true, clientData);
+			addTotals (1, 0L, 0L);
 
 #ifdef HAVE_ICONV
-		closeConverter ();
+			closeConverter ();
 #endif
+			if (isInputTimeLimitReached ())
+			{
+				error (WARNING, "stopped parsing %s: over the budget of %lu msec",
+					   fileName, budget->msec);
+				setFileStatisticsBudget ("truncated");
+			}
+			setInputTimeLimit (0);
+			if (over)
+				endReducedParsing (&saved);
+		}
+		if (Option.filter && ! Option.interactive)
+			closeTagFile (tagFileResized);
 	}
+	endTraceEvent (TRACE_FILE);
+	endFileStatistics (language);
 
 	if (req.type == GLR_OPEN && req.mio)
 		mio_unref (req.mio);
@@ -4442,32 +5274,355 @@ extern bool parseRawBuffer(const char *fileName, unsigned char *buffer,
 	return r;
 }
 
+struct sParseSnapshot {
+	langType language;
+	/* The lines of the contents parsed last a region can start at, in
+	 * increasing order; empty if the parser cannot parse a region. */
+	ulongArray *startLines;
+	unsigned long lineCount;
+	bool anonymous;
+};
+
+extern parseSnapshot *parseSnapshotNew (void)
+{
+	parseSnapshot *snapshot = xMalloc (1, parseSnapshot);
+
+	snapshot->language = LANG_IGNORE;
+	snapshot->startLines = ulongArrayNew ();
+	snapshot->lineCount = 0;
+	snapshot->anonymous = false;
+	return snapshot;
+}
+
+extern void parseSnapshotDelete (parseSnapshot *snapshot)
+{
+	ulongArrayDelete (snapshot->startLines);
+	eFree (snapshot);
+}
+
+static bool hasStartLine (const ulongArray *lines, unsigned long line)
+{
+	unsigned int low = 0, high = ulongArrayCount (lines);
+
+	/* A region can always start at the first line. */
+	if (line == 1)
+		return true;
+
+	while (low < high)
+	{
+		const unsigned int mid = low + (high - low) / 2;
+		const unsigned long l = ulongArrayItem (lines, mid);
+
+		if (l == line)
+			return true;
+		else if (l < line)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+	return false;
+}
+
+/* Finds the region of the contents having STARTLINES, enclosing the lines
+ * changed by EDIT, whose start and end are the ones of a region in the
+ * contents parsed last too. */
+static bool findEditedRegion (const parseSnapshot *snapshot, const ulongArray *startLines,
+							  unsigned long lineCount, const lineEdit *edit,
+							  tagDelta *delta)
+{
+	const long shift = (long) edit->added - (long) edit->removed;
+	const unsigned long editEnd = edit->line + edit->added;
+	unsigned long start = 1, end = 0;
+
+	if (edit->line == 0
+		|| edit->line + edit->removed > snapshot->lineCount + 1
+		|| lineCount != snapshot->lineCount - edit->removed + edit->added)
+		return false;
+
+	for (unsigned int i = 0; i < ulongArrayCount (startLines); i++)
+	{
+		const unsigned long l = ulongArrayItem (startLines, i);
+
+		if (l <= edit->line)
+		{
+			if (hasStartLine (snapshot->startLines, l))
+				start = l;
+		}
+		else if (l >= editEnd && l > start
+				 && hasStartLine (snapshot->startLines, l - shift))
+		{
+			end = l;
+			break;
+		}
+	}
+
+	delta->startLine = start;
+	delta->endLine = end? end - 1: 0;
+	delta->previousEndLine = end? end - 1 - shift: 0;
+	delta->lineShift = shift;
+	return true;
+}
+
+/* Parses the region of the current input file found by findEditedRegion ().
+ * If the region doesn't end clean, its tags are dropped. */
+static bool parseInputRegion (const langType language, const tagDelta *delta,
+							  bool *clean)
+{
+	inputChunk region = {
+		.startLine = delta->startLine,
+		.endClean = false,
+		.region = true,
+	};
+	unsigned long numTags = numTagsAdded ();
+	MIOPos tagfpos;
+	bool tagFileResized;
+
+	verbose ("parsing lines %lu-%lu of %s\n", delta->startLine,
+			 delta->endLine, getInputFileName ());
+
+	tagFilePosition (&tagfpos);
+	setInputFileLastLine (delta->endLine);
+	tagFileResized = createTagsWithFallback1 (language, NULL, &region);
+	tagFileResized = forcePromises()? true: tagFileResized;
+	setInputFileLastLine (0);
+
+	if (! region.endClean)
+	{
+		verbose ("parsing %s again as a whole\n", getInputFileName ());
+		setTagFilePosition (&tagfpos, true);
+		setNumTagsAdded (numTags);
+		writerRescanFailed (numTags);
+		tagFileResized = true;
+	}
+	*clean = region.endClean;
+	return tagFileResized;
+}
+
+static bool parseMioIncrementally (const char *const fileName, langType language,
+								   MIO *mio, parseSnapshot *snapshot,
+								   const lineEdit *edit, tagDelta *delta,
+								   void *clientData)
+{
+	ulongArray *startLines = ulongArrayNew ();
+	langType exclusive_subparser = LANG_IGNORE;
+	bool tagFileResized = false;
+	bool clean = false;
+	size_t size;
+	const unsigned char *data = mio_memory_get_data (mio, &size);
+	const unsigned long lineCount = countLines (data, size);
+
+	delta->startLine = 1;
+	delta->endLine = 0;
+	delta->previousEndLine = 0;
+	delta->lineShift = 0;
+
+	setupWriter (clientData);
+
+	setupAnon ();
+
+	initParserTrashBox ();
+	beginMemoryAccountingForFile ();
+
+	if (openInputFile (fileName, language, mio, (time_t)0))
+	{
+		splitInputFile (language, 1, startLines);
+
+		if (edit && snapshot->language == language && ! snapshot->anonymous
+			&& ! ulongArrayIsEmpty (snapshot->startLines)
+			&& ! ulongArrayIsEmpty (startLines)
+			&& findEditedRegion (snapshot, startLines, lineCount, edit, delta))
+			tagFileResized = parseInputRegion (language, delta, &clean);
+
+		if (! clean)
+		{
+			delta->startLine = 1;
+			delta->endLine = 0;
+			delta->previousEndLine = 0;
+			delta->lineShift = 0;
+			tagFileResized = createTagsWithFallback1 (language,
+													  &exclusive_subparser, NULL)
+				|| tagFileResized;
+			tagFileResized = forcePromises()? true: tagFileResized;
+		}
+
+		if (delta->startLine == 1)
+		{
+			pushLanguage ((exclusive_subparser == LANG_IGNORE)
+						  ? language
+						  : exclusive_subparser);
+			makeFileTag (fileName);
+			popLanguage ();
+		}
+		snapshot->anonymous = (countAnonNamesInCurrentInput () > 0);
+		closeInputFile ();
+	}
+
+	ulongArrayDelete (snapshot->startLines);
+	snapshot->startLines = startLines;
+	snapshot->language = language;
+	snapshot->lineCount = lineCount;
+
+	finiParserTrashBox ();
+
+	teardownAnon ();
+
+	return teardownWriter (fileName)? true: tagFileResized;
+}
+
+extern bool parseFileWithMioIncrementally (const char *const fileName, MIO *mio,
+										   parseSnapshot *snapshot,
+										   const lineEdit *edit, tagDelta *delta)
+{
+	bool tagFileResized = false;
+	langType language = snapshot->language;
+	size_t size;
+
+	delta->startLine = 1;
+	delta->endLine = 0;
+	delta->previousEndLine = 0;
+	delta->lineShift = 0;
+
+	if (mio_memory_get_data (mio, &size) == NULL)
+		return parseFileWithMio (fileName, mio, NULL);
+
+	/* The language of the buffer is detected only at the first parse. */
+	if (language == LANG_IGNORE || edit == NULL)
+	{
+		struct GetLanguageRequest req = {
+			.type = GLR_REUSE,
+			.fileName = fileName,
+			.mio = mio,
+		};
+		memset (&req.mtime, 0, sizeof (req.mtime));
+
+		language = getFileLanguageForRequest (&req);
+	}
+
+	if (language == LANG_IGNORE)
+		verbose ("ignoring %s (unknown language/language disabled)\n",
+			 fileName);
+	else
+	{
+#ifdef HAVE_ICONV
+		openConverter (getLanguageEncoding (language), Option.outputEncoding);
+#endif
+		tagFileResized = parseMioIncrementally (fileName, language, mio,
+												snapshot, edit, delta, NULL);
+		addTotals (1, 0L, 0L);
+#ifdef HAVE_ICONV
+		closeConverter ();
+#endif
+	}
+
+	return tagFileResized;
+}
+
+struct sParserSession {
+	vString *fileName;
+	langType language;
+	void *clientData;
+	parseSnapshot *snapshot;
+};
+
+extern parserSession *parserSessionNew (const char *fileName, const langType language,
+										void *clientData)
+{
+	parserSession *session = xMalloc (1, parserSession);
+
+	session->fileName = vStringNewInit (fileName);
+	session->language = language;
+	session->clientData = clientData;
+	session->snapshot = parseSnapshotNew ();
+
+	if (language != LANG_AUTO)
+		initializeParser (language);
+
+	return session;
+}
+
+extern bool parserSessionParse (parserSession *session,
+								unsigned char *buffer, size_t bufferSize)
+{
+	tagDelta delta;
+
+	return parserSessionParseEdit (session, buffer, bufferSize, NULL, &delta);
+}
+
+extern bool parserSessionParseEdit (parserSession *session,
+									unsigned char *buffer, size_t bufferSize,
+									const lineEdit *edit, tagDelta *delta)
+{
+	MIO *mio = mio_new_memory (buffer, bufferSize, NULL, NULL);
+	bool r = false;
+
+	delta->startLine = 1;
+	delta->endLine = 0;
+	delta->previousEndLine = 0;
+	delta->lineShift = 0;
+
+	if (session->language == LANG_AUTO)
+	{
+		struct GetLanguageRequest req = {
+			.type = GLR_REUSE,
+			.fileName = vStringValue (session->fileName),
+			.mio = mio,
+		};
+		memset (&req.mtime, 0, sizeof (req.mtime));
+
+		session->language = getFileLanguageForRequest (&req);
+		if (session->language != LANG_IGNORE)
+			initializeParser (session->language);
+	}
+
+	if (session->language != LANG_IGNORE)
+		r = parseMioIncrementally (vStringValue (session->fileName), session->language,
+								   mio, session->snapshot, edit, delta,
+								   session->clientData);
+
+	mio_unref (mio);
+	return r;
+}
+
+extern langType parserSessionGetLanguage (const parserSession *session)
+{
+	return session->language;
+}
+
+extern void parserSessionDelete (parserSession *session)
+{
+	parseSnapshotDelete (session->snapshot);
+	vStringDelete (session->fileName);
+	eFree (session);
+}
+
 static void matchLanguageMultilineRegexCommon (const langType language,
-											   bool (* func) (struct lregexControlBlock *, const vString* const),
-											   const vString* const allLines)
+											   bool (* func) (struct lregexControlBlock *, const char *, size_t),
+											   const char *input, size_t size)
 {
 	subparser *tmp;
+	memorySubsystem m = enterMemorySubsystem (MEMORY_REGEX);
 
-	func ((LanguageTable + language)->lregexControlBlock, allLines);
+	func (getLregexControlBlock (language), input, size);
+	leaveMemorySubsystem (m);
 	foreachSubparser(tmp, true)
 	{
 		langType t = getSubparserLanguage (tmp);
 		enterSubparser (tmp);
-		matchLanguageMultilineRegexCommon (t, func, allLines);
+		matchLanguageMultilineRegexCommon (t, func, input, size);
 		leaveSubparser ();
 	}
 }
 
 extern void matchLanguageMultilineRegex (const langType language,
-										 const vString* const allLines)
+										 const char *input, size_t size)
 {
-	matchLanguageMultilineRegexCommon(language, matchMultilineRegex, allLines);
+	matchLanguageMultilineRegexCommon(language, matchMultilineRegex, input, size);
 }
 
 extern void matchLanguageMultitableRegex (const langType language,
-										  const vString* const allLines)
+										  const char *input, size_t size)
 {
-	matchLanguageMultilineRegexCommon(language, matchMultitableRegex, allLines);
+	matchLanguageMultilineRegexCommon(language, matchMultitableRegex, input, size);
 }
 
 extern void processLanguageMultitableExtendingOption (langType language, const char *const parameter)
@@ -4489,7 +5644,7 @@ extern void processLanguageMultitableExtendingOption (langType language, const c
 		error (FATAL, "the name of dist table is empty in table extending: %s", parameter);
 
 	dist = eStrndup(parameter, tmp  - parameter);
-	extendRegexTable(((LanguageTable + language)->lregexControlBlock), src, dist);
+	extendRegexTable(getLregexControlBlock (language), src, dist);
 	eFree (dist);
 }
 
@@ -4498,7 +5653,7 @@ static bool lregexQueryParserAndSubparsers (const langType language, bool (* pre
 	bool r;
 	subparser *tmp;
 
-	r = predicate ((LanguageTable + language)->lregexControlBlock);
+	r = predicate (getLregexControlBlock (language));
 	if (!r)
 	{
 		foreachSubparser(tmp, true)
@@ -4521,11 +5676,22 @@ extern bool hasLanguageMultilineRegexPatterns (const langType language)
 	return lregexQueryParserAndSubparsers (language, regexNeedsMultilineBuffer);
 }
 
+extern bool hasLanguageLineRegexPatterns (const langType language)
+{
+	return lregexQueryParserAndSubparsers (language, regexHasLinePatterns);
+}
+
+extern bool doesLanguageStreamRegexInput (const langType language)
+{
+	return (regexHasWindowedTables (getLregexControlBlock (language))
+			&& !lregexQueryParserAndSubparsers (language, regexNeedsWholeInput));
+}
+
 
 extern void addLanguageCallbackRegex (const langType language, const char *const regex, const char *const flags,
 									  const regexCallback callback, bool *disabled, void *userData)
 {
-	addCallbackRegex ((LanguageTable +language)->lregexControlBlock, regex, flags, callback, disabled, userData);
+	addCallbackRegex (getLregexControlBlock (language), regex, flags, callback, disabled, userData);
 }
 
 extern bool doesLanguageExpectCorkInRegex (const langType language)
@@ -4542,8 +5708,10 @@ extern bool doesLanguageExpectCorkInRegex (const langType language)
 extern void matchLanguageRegex (const langType language, const vString* const line)
 {
 	subparser *tmp;
+	memorySubsystem m = enterMemorySubsystem (MEMORY_REGEX);
 
-	matchRegex ((LanguageTable + language)->lregexControlBlock, line);
+	matchRegex (getLregexControlBlock (language), line);
+	leaveMemorySubsystem (m);
 	foreachSubparser(tmp, true)
 	{
 		langType t = getSubparserLanguage (tmp);
@@ -4557,7 +5725,7 @@ extern bool processLanguageRegexOption (langType language,
 										enum regexParserType regptype,
 										const char *const parameter)
 {
-	processTagRegexOption ((LanguageTable +language)->lregexControlBlock,
+	processTagRegexOption (getLregexControlBlock (language),
 						   regptype, parameter);
 
 	return true;
@@ -4574,7 +5742,7 @@ extern bool processTabledefOption (const char *const option, const char *const p
 	if (parameter == NULL || parameter[0] == '\0')
 		error (FATAL, "A parameter is needed after \"%s\" option", option);
 
-	addRegexTable((LanguageTable +language)->lregexControlBlock, parameter);
+	addRegexTable(getLregexControlBlock (language), parameter);
 	return true;
 }
 
@@ -4618,14 +5786,14 @@ static void installTagRegexTable (const langType language)
 	    for (i = 0; i < lang->tagRegexCount; ++i)
 		{
 			if (lang->tagRegexTable [i].mline)
-				addTagMultiLineRegex (parser->lregexControlBlock,
+				addTagMultiLineRegex (getLregexControlBlock (language),
 									  lang->tagRegexTable [i].regex,
 									  lang->tagRegexTable [i].name,
 									  lang->tagRegexTable [i].kinds,
 									  lang->tagRegexTable [i].flags,
 									  (lang->tagRegexTable [i].disabled));
 			else
-				addTagRegex (parser->lregexControlBlock,
+				addTagRegex (getLregexControlBlock (language),
 							 lang->tagRegexTable [i].regex,
 							 lang->tagRegexTable [i].name,
 							 lang->tagRegexTable [i].kinds,
@@ -4996,9 +6164,14 @@ extern unsigned int getLanguageVersionAge (const langType language)
 */
 static ptrArray *parsersUsedInCurrentInput;
 
+/* The hash of the name of the current input file, made at the first
+ * anonymous name for the file. */
+static char anonHashOfCurrentInput [9];
+
 static void setupAnon (void)
 {
 	parsersUsedInCurrentInput = ptrArrayNew (NULL);
+	anonHashOfCurrentInput [0] = '\0';
 }
 
 static void teardownAnon (void)
@@ -5015,6 +6188,31 @@ static void anonResetMaybe (parserObject *parser)
 	ptrArrayAdd (parsersUsedInCurrentInput, parser);
 }
 
+/* Returns true if a parser other than PARSER has made anonymous names
+ * for the current input file. */
+static bool anonUsedExcept (parserObject *parser)
+{
+	for (unsigned int i = 0; i < ptrArrayCount (parsersUsedInCurrentInput); i++)
+	{
+		parserObject *p = ptrArrayItem (parsersUsedInCurrentInput, i);
+		if (p != parser && p->anonymousIdentiferId > 0)
+			return true;
+	}
+	return false;
+}
+
+extern unsigned int countAnonNamesInCurrentInput (void)
+{
+	unsigned int count = 0;
+
+	for (unsigned int i = 0; i < ptrArrayCount (parsersUsedInCurrentInput); i++)
+	{
+		parserObject *p = ptrArrayItem (parsersUsedInCurrentInput, i);
+		count += p->anonymousIdentiferId;
+	}
+	return count;
+}
+
 static unsigned int anonHash(const unsigned char *str)
 {
 	unsigned int hash = 5381;
@@ -5037,20 +6235,35 @@ extern void anonConcat (vString *buffer, int kind)
 	anonGenerate (buffer, NULL, kind);
 }
 
+/* Appends N in hex with two digits at least, like "%02x" does. */
+static void anonCatHex (vString *buffer, unsigned int n)
+{
+	static const char digits[] = "0123456789abcdef";
+	char b [sizeof (n) * 2];
+	size_t i = sizeof (b);
+
+	do
+	{
+		b [--i] = digits [n & 0xf];
+		n >>= 4;
+	}
+	while (n > 0 || i > sizeof (b) - 2);
+	vStringNCatSUnsafe (buffer, b + i, sizeof (b) - i);
+}
+
 extern void anonGenerate (vString *buffer, const char *prefix, int kind)
 {
 	parserObject* parser = LanguageTable + getInputLanguage ();
 	parser -> anonymousIdentiferId ++;
 
-	char szNum[32];
-	char buf [9];
-
 	if (prefix)
 		vStringCopyS(buffer, prefix);
 
-	anonHashString (getInputFileName(), buf);
-	sprintf(szNum,"%s%02x%02x",buf,parser -> anonymousIdentiferId, kind);
-	vStringCatS(buffer,szNum);
+	if (anonHashOfCurrentInput [0] == '\0')
+		anonHashString (getInputFileName(), anonHashOfCurrentInput);
+	vStringNCatSUnsafe (buffer, anonHashOfCurrentInput, 8);
+	anonCatHex (buffer, parser -> anonymousIdentiferId);
+	anonCatHex (buffer, (unsigned int) kind);
 }
 
 extern vString *anonGenerateNew (const char *prefix, int kind)
@@ -5095,6 +6308,11 @@ extern subparser *getNextSubparser(subparser *last,
 		return getNextSubparser (r, includingNoneCraftedParser);
 }
 
+extern struct slaveControlBlock *getInputLanguageSlaveControlBlock (void)
+{
+	return LanguageTable [getInputLanguage ()].slaveControlBlock;
+}
+
 extern slaveParser *getNextSlaveParser(slaveParser *last)
 {
 	langType lang = getInputLanguage ();
@@ -5246,14 +6464,23 @@ extern void printKinddefFlags (bool withListHeader, bool machinable, FILE *fp)
 
 extern void printLanguageMultitableStatistics (langType language)
 {
-	parserObject* const parser = LanguageTable + language;
-	printMultitableStatistics (parser->lregexControlBlock);
+	printMultitableStatistics (getLregexControlBlock (language));
+}
+
+extern void printLanguageRegexProfile (langType language)
+{
+	printRegexProfile (getLregexControlBlock (language));
+}
+
+extern void countLanguageRegexMatches (langType language,
+									   unsigned long *attempts, unsigned long *matches)
+{
+	countRegexMatches (getLregexControlBlock (language), attempts, matches);
 }
 
 extern void addLanguageRegexTable (const langType language, const char *name)
 {
-	parserObject* const parser = LanguageTable + language;
-	addRegexTable (parser->lregexControlBlock, name);
+	addRegexTable (getLregexControlBlock (language), name);
 }
 
 extern void addLanguageTagMultiTableRegex(const langType language,
@@ -5262,14 +6489,13 @@ extern void addLanguageTagMultiTableRegex(const langType language,
 										  const char* const name, const char* const kinds, const char* const flags,
 										  bool *disabled)
 {
-	parserObject* const parser = LanguageTable + language;
-	addTagMultiTableRegex (parser->lregexControlBlock, table_name, regex,
+	addTagMultiTableRegex (getLregexControlBlock (language), table_name, regex,
 						   name, kinds, flags, disabled);
 }
 
 extern void addLanguageOptscriptToHook (langType language, enum scriptHook hook, const char *const src)
 {
-	addOptscriptToHook (LanguageTable [language].lregexControlBlock, hook, src);
+	addOptscriptToHook (getLregexControlBlock (language), hook, src);
 }
 
 static bool processHookOption (const char *const option, const char *const parameter, const char *prefix,
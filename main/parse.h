@@ -18,6 +18,7 @@
 #include "kind.h"
 #include "lregex.h"
 #include "lxpath.h"
+#include "numarray.h"
 #include "vstring.h"
 
 /*
@@ -41,6 +42,9 @@ typedef rescanReason (*rescanParser) (const unsigned int passCount);
 typedef void (*parserInitialize) (langType language);
 typedef void (*initStatistics) (langType language);
 typedef void (*printStatistics) (langType langType);
+/* See "Input chunk interface" below. */
+typedef void (*splitInput) (const unsigned char *data, size_t size,
+							size_t chunkSize, ulongArray *lines);
 
 /* Per language finalizer is called anytime when ctags exits.
    (Exceptions are a kind of options are given when invoked. Here
@@ -112,6 +116,11 @@ struct sParserDefinition {
 	unsigned int method;           /* See METHOD_ definitions above */
 	unsigned int useCork;		   /* bit fields of corkUsage */
 	bool useMemoryStreamInput;
+	/* The parser keeps its state for an input in the local variables of
+	 * its functions; it writes no file scope variable but the tables
+	 * given to parserDefinition and the langType set in initialize.
+	 * "make codecheck" verifies it. */
+	bool reentrant;
 	bool allowNullTag;
 	bool requestAutomaticFQTag;
 	tagRegexTable *tagRegexTable;
@@ -142,6 +151,8 @@ struct sParserDefinition {
 	initStatistics initStats;
 	printStatistics printStats;
 
+	splitInput splitInput;
+
 	/* used internally */
 	langType id;		    /* id assigned to language */
 	unsigned int enabled:1;	       /* currently enabled? */
@@ -206,4 +217,37 @@ extern void anonConcat   (vString *buffer, int kind);
 extern vString *anonGenerateNew (const char *prefix, int kind);
 extern void anonHashString (const char *filename, char buf[9]);
 
+/* Rescan checkpoint interface
+ *
+ * When a rescanParser returns RESCAN_FAILED, the tags made in the pass are
+ * dropped and the parser parses the input file again from the start.
+ * A parser can tell with setRescanCheckpoint (), just after reading a
+ * newline, that the next pass would reach the next line in the same state
+ * and with the same tags. Then the tags made before the last checkpoint
+ * are kept, and the next pass starts reading the input file after the
+ * line of the checkpoint. PARSERSTATE is for the state the parser must
+ * restore itself; the parser gets it with getRescanCheckpoint ().
+ *
+ * setRescanCheckpoint () does nothing if the input file is not just after
+ * a newline, or if the parser or its subparsers have line regex patterns.
+ * getRescanCheckpoint () returns false if the current pass starts at the
+ * start of the input file. */
+extern void setRescanCheckpoint (int parserState);
+extern bool getRescanCheckpoint (int *parserState);
+
+/* Input chunk interface
+ *
+ * With --split-size option, a large input file may be split into chunks
+ * parsed in parallel worker processes. splitInput gets the contents of
+ * the input file, and adds to LINES, in increasing order, the numbers of
+ * the lines a chunk starts at, about CHUNKSIZE bytes apart. The parser
+ * parses a chunk as an input file of its own, with the anonymous names
+ * numbered from 1. When the parser reaches the end of the input in the
+ * state it starts an input file in, it calls setInputChunkEndClean ().
+ * Then the tags of the chunk are the ones made for the lines of the
+ * chunk while parsing the whole input file; the anonymous names are
+ * renumbered as such. If a chunk does not end clean, or the parser
+ * rescans a chunk, the input file is parsed again as a whole. */
+extern void setInputChunkEndClean (void);
+
 #endif  /* CTAGS_MAIN_PARSE_H */
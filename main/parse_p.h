@@ -79,6 +79,7 @@ extern int defineLanguageKind (const langType language, kindDefinition *def,
 
 extern unsigned int countLanguageKinds (const langType language);
 extern unsigned int countLanguageRoles (const langType language, int kindIndex);
+extern roleBitsType getLanguageEnabledRoleBits (const langType language, int kindIndex);
 
 extern bool isLanguageKindRefOnly (const langType language, int kindIndex);
 
@@ -104,6 +105,11 @@ extern void printLanguageMaps (const langType language, langmapType type,
 							   bool withListHeader, bool machinable, FILE *fp);
 extern void enableLanguages (const bool state);
 extern void enableLanguage (const langType language, const bool state);
+
+/* The generation is incremented whenever the result of
+ * catLanguageMapFingerprint() may change. */
+extern unsigned int getLanguageMapGeneration (void);
+extern void catLanguageMapFingerprint (vString *fp);
 extern void initializeParsing (void);
 
 extern unsigned int countParsers (void);
@@ -128,12 +134,90 @@ extern bool parseFileWithMio (const char *const fileName, MIO *mio, void *client
 extern bool parseRawBuffer(const char *fileName, unsigned char *buffer,
 			    size_t bufferSize, const langType language, void *clientData);
 
+/* Incremental parse interface
+ *
+ * An editor parsing a buffer again after an edit tells the lines changed
+ * with a lineEdit: REMOVED lines at LINE of the contents parsed last
+ * were replaced with ADDED lines. A parseSnapshot keeps what is needed of
+ * the contents parsed last: the lines the parser can start a region at,
+ * as the chunks of --split-size option. If the parser supports chunks,
+ * only the region enclosing the changed lines is parsed, and the tagDelta
+ * tells the tags of the lines from STARTLINE to PREVIOUSENDLINE of the
+ * contents parsed last are replaced with the tags made for the lines from
+ * STARTLINE to ENDLINE. The lines after the region are moved by
+ * LINESHIFT. An end line of 0 stands for the last line; so the delta of
+ * a parse of the whole contents has STARTLINE 1 and the end lines 0.
+ *
+ * parseFileWithMioIncrementally () takes a memory stream as MIO. Without
+ * EDIT, the whole contents are parsed. In any case, SNAPSHOT is updated
+ * for the next parse. */
+typedef struct sParseSnapshot parseSnapshot;
+typedef struct sLineEdit {
+	unsigned long line;
+	unsigned long removed;
+	unsigned long added;
+} lineEdit;
+typedef struct sTagDelta {
+	unsigned long startLine;
+	unsigned long endLine;
+	unsigned long previousEndLine;
+	long lineShift;
+} tagDelta;
+extern parseSnapshot *parseSnapshotNew (void);
+extern void parseSnapshotDelete (parseSnapshot *snapshot);
+extern bool parseFileWithMioIncrementally (const char *const fileName, MIO *mio,
+										   parseSnapshot *snapshot,
+										   const lineEdit *edit, tagDelta *delta);
+
+/* Parser session interface for the applications embedding ctags
+ *
+ * A session is made for an editor buffer, and parses its contents again
+ * and again. parserSessionNew () takes the file name of the buffer, the
+ * language, and CLIENTDATA passed to the writer as parseRawBuffer ()
+ * does. The parser and its keyword tables are initialized when the
+ * session is made. If LANGUAGE is LANG_AUTO, the language is detected
+ * from the file name and the contents at the first parse, and the
+ * session keeps it for the later parses. parserSessionParse () parses
+ * BUFFER of BUFFERSIZE bytes. It returns true if the tag file is
+ * resized, like parseRawBuffer (). */
+typedef struct sParserSession parserSession;
+extern parserSession *parserSessionNew (const char *fileName, const langType language,
+										void *clientData);
+extern bool parserSessionParse (parserSession *session,
+								unsigned char *buffer, size_t bufferSize);
+/* Parses BUFFER after EDIT incrementally (see parseFileWithMioIncrementally ()). */
+extern bool parserSessionParseEdit (parserSession *session,
+									unsigned char *buffer, size_t bufferSize,
+									const lineEdit *edit, tagDelta *delta);
+extern langType parserSessionGetLanguage (const parserSession *session);
+extern void parserSessionDelete (parserSession *session);
+
 extern bool runParserInNarrowedInputStream (const langType language,
 					       unsigned long startLine, long startCharOffset,
 					       unsigned long endLine, long endCharOffset,
 					       unsigned long sourceLineOffset,
 					       int promise);
 
+/* Input chunk interface (see setInputChunkEndClean ())
+ *
+ * doesParserSplitInput () tells whether the parser for LANGUAGE may
+ * split an input file; it can be called before the file is opened.
+ * splitInputFile () adds to LINES the first lines of the chunks but the
+ * first one, for splitting the current input file into chunks of about
+ * CHUNKSIZE bytes. It returns false if the file cannot be split.
+ * parseInputChunk () parses the chunk from STARTLINE to ENDLINE, or to
+ * the end of the input file if ENDLINE is 0, of the current input file.
+ * Before writing the tags, it calls reportInputChunk () of jobs.c. */
+extern bool doesParserSplitInput (const langType language);
+extern bool splitInputFile (const langType language, size_t chunkSize,
+							ulongArray *lines);
+extern void parseInputChunk (const langType language,
+							 unsigned long startLine, unsigned long endLine);
+
+/* Returns the number of the anonymous names made by the parsers for the
+ * current input file. */
+extern unsigned int countAnonNamesInCurrentInput (void);
+
 #ifdef HAVE_ICONV
 extern void freeEncodingResources (void);
 #endif
@@ -154,8 +238,12 @@ extern bool doesLanguageExpectCorkInRegex (const langType language);
 
 /* Multiline Regex Interface */
 extern bool hasLanguageMultilineRegexPatterns (const langType language);
-extern void matchLanguageMultilineRegex (const langType language, const vString* const allLines);
-extern void matchLanguageMultitableRegex (const langType language, const vString* const allLines);
+extern bool hasLanguageLineRegexPatterns (const langType language);
+/* True if the regex patterns of LANGUAGE and its subparsers are in the
+   tables having windows only; see --_tabledef-<LANG>. */
+extern bool doesLanguageStreamRegexInput (const langType language);
+extern void matchLanguageMultilineRegex (const langType language, const char *input, size_t size);
+extern void matchLanguageMultitableRegex (const langType language, const char *input, size_t size);
 
 extern void processLanguageMultitableExtendingOption (langType language, const char *const parameter);
 
@@ -176,8 +264,14 @@ extern bool makeRoleDescriptionsPseudoTags (const langType language,
 					       const ptagDesc *pdesc);
 extern bool makeParserVersionPseudoTags (const langType language,
 										 const ptagDesc *pdesc);
+/* The parser specific pseudo tags are written again when the parsers
+ * run next. */
+extern void forgetParserPseudoTags (void);
 
 extern void printLanguageMultitableStatistics (langType language);
+extern void printLanguageRegexProfile (langType language);
+extern void countLanguageRegexMatches (langType language,
+									   unsigned long *attempts, unsigned long *matches);
 extern void printParserStatisticsIfUsed (langType lang);
 
 /* For keeping the API compatibility with Geany, we use a macro here. */
@@ -11,12 +11,14 @@
  */
 
 #include "general.h"
+#include "jobs_p.h"
 #include "parse_p.h"
 #include "promise.h"
 #include "promise_p.h"
 #include "ptrarray.h"
 #include "debug.h"
 #include "read_p.h"
+#include "traceevent_p.h"
 #include "trashbox.h"
 #include "xtag.h"
 #include "numarray.h"
@@ -42,9 +44,15 @@ typedef void ( *promiseInputModifier) (unsigned char * input,
 									   unsigned long endLine, long endCharOffset,
 									   void *data);
 typedef void ( *promiseDestroyAttachedData) (void *data);
+/* Return false if the modifier leaves the lines from startLine to
+ * endLine as they are. */
+typedef bool ( *promiseInputModifierTest) (unsigned long startLine,
+										   unsigned long endLine,
+										   void *data);
 
 struct modifier {
 	promiseInputModifier modifier;
+	promiseInputModifierTest affects;
 	promiseDestroyAttachedData destroyData;
 	void *data;
 };
@@ -58,6 +66,7 @@ static int current_promise = NO_PROMISE;
 
 static void attachPromiseModifier (int promise,
 								   promiseInputModifier modifier,
+								   promiseInputModifierTest affects,
 								   promiseDestroyAttachedData destroyData,
 								   void *data);
 
@@ -130,12 +139,14 @@ static void freeModifier (void *data)
 
 static void attachPromiseModifier (int promise,
 								   promiseInputModifier modifier,
+								   promiseInputModifierTest affects,
 								   promiseDestroyAttachedData destroyData,
 								   void *data)
 {
 	struct modifier *m = xMalloc (1, struct modifier);
 
 	m->modifier = modifier;
+	m->affects = affects;
 	m->destroyData = destroyData;
 	m->data = data;
 
@@ -169,26 +180,50 @@ void breakPromisesAfter (int promise)
 	promise_count = promise;
 }
 
+static bool forcePromise (int i)
+{
+	struct promise *p = promises + i;
+
+	current_promise = i;
+	if (p->lang != LANG_IGNORE && isLanguageEnabled (p->lang))
+	{
+		bool r;
+
+		beginTraceEvent (TRACE_PROMISE, getLanguageName (p->lang));
+		r = runParserInNarrowedInputStream (p->lang,
+											p->startLine,
+											p->startCharOffset,
+											p->endLine,
+											p->endCharOffset,
+											p->sourceLineOffset,
+											i);
+		endTraceEvent (TRACE_PROMISE);
+		return r;
+	}
+	return false;
+}
+
+bool forcePromisesInRange (int from, int to)
+{
+	bool tagFileResized = false;
+
+	for (int i = from; i < to; ++i)
+		tagFileResized = forcePromise (i)? true: tagFileResized;
+
+	current_promise = NO_PROMISE;
+	return tagFileResized;
+}
+
 bool forcePromises (void)
 {
 	int i;
 	bool tagFileResized = false;
 
-	for (i = 0; i < promise_count; ++i)
+	if (!forcePromisesInWorkers (promise_count, &tagFileResized))
 	{
-		current_promise = i;
-		struct promise *p = promises + i;
-
-		if (p->lang != LANG_IGNORE && isLanguageEnabled (p->lang))
-			tagFileResized = runParserInNarrowedInputStream (p->lang,
-															 p->startLine,
-															 p->startCharOffset,
-															 p->endLine,
-															 p->endCharOffset,
-															 p->sourceLineOffset,
-															 i)
-				? true
-				: tagFileResized;
+		/* A guest parser may make promises while running. */
+		for (i = 0; i < promise_count; ++i)
+			tagFileResized = forcePromise (i)? true: tagFileResized;
 	}
 
 	freeModifiers (0);
@@ -284,9 +319,25 @@ static void line_filler (unsigned char *input, size_t const size,
 	}
 }
 
+static bool line_filler_affects (unsigned long const startLine,
+								 unsigned long const endLine,
+								 void *data)
+{
+	const ulongArray *lines = data;
+	const size_t count = ulongArrayCount (lines);
+
+	for (unsigned int i = 0; i < count; i++)
+	{
+		const unsigned long line = ulongArrayItem (lines, i);
+		if (line >= startLine)
+			return line <= endLine;
+	}
+	return false;
+}
+
 void promiseAttachLineFiller (int promise, ulongArray *lines)
 {
-	attachPromiseModifier (promise, line_filler,
+	attachPromiseModifier (promise, line_filler, line_filler_affects,
 						   (promiseDestroyAttachedData)ulongArrayDelete,
 						   lines);
 }
@@ -309,6 +360,26 @@ static void collectModifiers(int promise, ptrArray *modifiers)
 	}
 }
 
+bool doesPromiseModifyInput (int promise,
+							  unsigned long startLine, unsigned long endLine)
+{
+	ptrArray *modifiers = ptrArrayNew (NULL);
+	bool r = false;
+
+	collectModifiers (promise, modifiers);
+	for (unsigned int i = 0; i < ptrArrayCount (modifiers); i++)
+	{
+		struct modifier *m = ptrArrayItem (modifiers, i);
+		if (m->affects == NULL || m->affects (startLine, endLine, m->data))
+		{
+			r = true;
+			break;
+		}
+	}
+	ptrArrayDelete (modifiers);
+	return r;
+}
+
 void runModifiers (int promise,
 				   unsigned long startLine, long startCharOffset,
 				   unsigned long endLine, long endCharOffset,
@@ -15,8 +15,17 @@
 #include "general.h"
 
 bool forcePromises (void);
+/* Run the guest parsers for the promises from FROM to TO - 1 without
+ * forcing the promises made by them. */
+bool forcePromisesInRange (int from, int to);
 void breakPromisesAfter (int promise);
 int getLastPromise (void);
+/* Return true if the modifiers attached to PROMISE and its parents
+ * rewrite the input lines from STARTLINE to ENDLINE. A narrowed input
+ * stream is a copy of the input then; otherwise it reads the memory of
+ * the input stream as it is. */
+bool doesPromiseModifyInput (int promise,
+							  unsigned long startLine, unsigned long endLine);
 void runModifiers (int promise,
 				   unsigned long startLine, long startCharOffset,
 				   unsigned long endLine, long endCharOffset,
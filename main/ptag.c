@@ -17,10 +17,13 @@
 #include "ctags.h"
 #include "debug.h"
 #include "entry_p.h"
+#include "fileindex_p.h"
+#include "nameindex_p.h"
 #include "options_p.h"
 #include "parse_p.h"
 #include "ptag_p.h"
 #include "routines_p.h"
+#include "trigramindex_p.h"
 #include "writer_p.h"
 #include <string.h>
 
@@ -235,6 +238,18 @@ static ptagDesc ptagDescs [] = {
 	  "the version of the output interface (current.age)",
 	  ptagMakeOutputVersion,
 	  PTAGF_COMMON },
+	{ true, "TAG_NAME_INDEX",
+	  "the name index file of the tag file (--name-index)",
+	  ptagMakeNameIndex,
+	  PTAGF_COMMON },
+	{ true, "TAG_TRIGRAM_INDEX",
+	  "the trigram index file of the tag file (--trigram-index)",
+	  ptagMakeTrigramIndex,
+	  PTAGF_COMMON },
+	{ true, "TAG_FILE_INDEX",
+	  "the file index file of the tag file (--file-index)",
+	  ptagMakeFileIndex,
+	  PTAGF_COMMON },
 };
 
 extern bool makePtagIfEnabled (ptagType type, langType language, const void *data)
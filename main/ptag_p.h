@@ -45,6 +45,9 @@ typedef enum ePtagType { /* pseudo tag content control */
 	PTAG_OUTPUT_EXCMD,
 	PTAG_PARSER_VERSION,
 	PTAG_OUTPUT_VERSION,
+	PTAG_NAME_INDEX,
+	PTAG_TRIGRAM_INDEX,
+	PTAG_FILE_INDEX,
 	PTAG_COUNT
 } ptagType;
 
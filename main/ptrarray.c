@@ -19,6 +19,16 @@
 #include "ptrarray.h"
 #include "routines.h"
 
+/*
+*   MACROS
+*/
+#define PTR_ARRAY_INITIAL_SIZE 8
+
+/* Arrays deleted are kept in a pool and reused by ptrArrayNew ()
+ * unless they have grown larger than PTR_ARRAY_POOLED_SIZE. */
+#define PTR_ARRAY_POOLED_SIZE 64
+#define PTR_ARRAY_POOL_SIZE 32
+
 /*
 *   DATA DECLARATIONS
 */
@@ -31,21 +41,62 @@ struct sPtrArray {
 	ptrArrayDeleteFunc deleteFunc;
 };
 
+/*
+*   DATA DEFINITIONS
+*/
+static ptrArray *ArrayPool [PTR_ARRAY_POOL_SIZE];
+static unsigned int ArrayPoolCount;
+
 /*
 *   FUNCTION DEFINITIONS
 */
 
 extern ptrArray *ptrArrayNew (ptrArrayDeleteFunc deleteFunc)
 {
-	ptrArray* const result = xMalloc (1, ptrArray);
-	result->max = 8;
+	ptrArray* result;
+
+	if (ArrayPoolCount > 0)
+		result = ArrayPool [--ArrayPoolCount];
+	else
+	{
+		result = xMalloc (1, ptrArray);
+		result->max = PTR_ARRAY_INITIAL_SIZE;
+		result->array = xMalloc (result->max, void*);
+	}
 	result->count = 0;
-	result->array = xMalloc (result->max, void*);
 	result->refcount = 1;
 	result->deleteFunc = deleteFunc;
 	return result;
 }
 
+extern void ptrArrayReserve (ptrArray *const current, unsigned int count)
+{
+	Assert (current != NULL);
+	if (current->max - current->count >= count)
+		return;
+
+	unsigned int max = current->max;
+	while (max - current->count < count)
+		max *= 2;
+	current->max = max;
+	current->array = xRealloc (current->array, current->max, void*);
+}
+
+extern void ptrArrayShrink (ptrArray *const current)
+{
+	unsigned int max;
+
+	Assert (current != NULL);
+	max = PTR_ARRAY_INITIAL_SIZE;
+	while (max < current->count)
+		max *= 2;
+	if (max < current->max)
+	{
+		current->max = max;
+		current->array = xRealloc (current->array, current->max, void*);
+	}
+}
+
 extern unsigned int ptrArrayAdd (ptrArray *const current, void *ptr)
 {
 	Assert (current != NULL);
@@ -58,6 +109,14 @@ extern unsigned int ptrArrayAdd (ptrArray *const current, void *ptr)
 	return current->count++;
 }
 
+extern void ptrArrayAddItems (ptrArray *const current, void *const *ptrs, unsigned int count)
+{
+	ptrArrayReserve (current, count);
+	if (count > 0)
+		memcpy (current->array + current->count, ptrs, count * sizeof (*ptrs));
+	current->count += count;
+}
+
 extern bool ptrArrayUpdate (ptrArray *const current,
 							unsigned int indx, void *ptr, void *padding)
 {
@@ -106,11 +165,9 @@ extern void  ptrArrayDeleteLastInBatch (ptrArray *const current, unsigned int co
 /* Combine array `from' into `current', deleting `from' */
 extern void ptrArrayCombine (ptrArray *const current, ptrArray *const from)
 {
-	unsigned int i;
 	Assert (current != NULL);
 	Assert (from != NULL);
-	for (i = 0  ;  i < from->count  ;  ++i)
-		ptrArrayAdd (current, from->array [i]);
+	ptrArrayAddItems (current, from->array, from->count);
 	from->count = 0;
 	ptrArrayDelete (from);
 }
@@ -162,8 +219,14 @@ extern void ptrArrayUnref (ptrArray *const current)
 		Assert(current->refcount == 0);
 
 		ptrArrayClear (current);
-		eFree (current->array);
-		eFree (current);
+		if (ArrayPoolCount < PTR_ARRAY_POOL_SIZE
+			&& current->max <= PTR_ARRAY_POOLED_SIZE)
+			ArrayPool [ArrayPoolCount++] = current;
+		else
+		{
+			eFree (current->array);
+			eFree (current);
+		}
 	}
 }
 
@@ -241,6 +304,20 @@ extern void ptrArrayInsertItem (ptrArray* const current, unsigned int indx, void
 	++current->count;
 }
 
+extern void ptrArrayInsertItems (ptrArray* const current, unsigned int indx,
+								 void *const *ptrs, unsigned int count)
+{
+	Assert (current != NULL);
+	Assert (indx <= current->count);
+	ptrArrayReserve (current, count);
+
+	memmove (current->array + indx + count, current->array + indx,
+			 (current->count - indx) * sizeof (*current->array));
+	if (count > 0)
+		memcpy (current->array + indx, ptrs, count * sizeof (*ptrs));
+	current->count += count;
+}
+
 static int (*ptrArraySortCompareVar)(const void *, const void *);
 
 static int ptrArraySortCompare(const void *a0, const void *b0)
@@ -30,12 +30,25 @@ typedef void (*ptrArrayDeleteFunc) (void *data);
 
 extern ptrArray *ptrArrayNew (ptrArrayDeleteFunc deleteFunc);
 extern unsigned int ptrArrayAdd (ptrArray *const current, void *ptr);
+
+/* Appends COUNT pointers at PTRS with one copy. */
+extern void ptrArrayAddItems (ptrArray *const current, void *const *ptrs, unsigned int count);
 extern bool ptrArrayUpdate (ptrArray *const current, unsigned int indx, void *ptr, void *padding);
 extern void *ptrArrayRemoveLast (ptrArray *const current);
 #define ptrArrayDeleteLast(A) ptrArrayDeleteLastInBatch(A, 1)
 extern void  ptrArrayDeleteLastInBatch (ptrArray *const current, unsigned int count);
 extern void ptrArrayCombine (ptrArray *const current, ptrArray *const from);
+
+/* Deletes the items but keeps the storage, so an array refilled in a
+ * loop doesn't allocate again. Call ptrArrayShrink () after clearing an
+ * array that grew large once to release the storage not used. */
 extern void ptrArrayClear (ptrArray *const current);
+
+/* Makes room for COUNT more items without reallocation. */
+extern void ptrArrayReserve (ptrArray *const current, unsigned int count);
+
+/* Releases the storage not used by the items. */
+extern void ptrArrayShrink (ptrArray *const current);
 extern unsigned int ptrArrayCount (const ptrArray *const current);
 #define ptrArrayIsEmpty(A) (ptrArrayCount(A) == 0)
 extern void* ptrArrayItem (const ptrArray *const current, const unsigned int indx);
@@ -52,6 +65,8 @@ extern void ptrArrayReverse (const ptrArray *const current);
 extern void ptrArrayDeleteItem (ptrArray* const current, unsigned int indx);
 extern void*ptrArrayRemoveItem (ptrArray* const current, unsigned int indx);
 extern void ptrArrayInsertItem (ptrArray* const current, unsigned int indx, void *ptr);
+extern void ptrArrayInsertItems (ptrArray* const current, unsigned int indx,
+								 void *const *ptrs, unsigned int count);
 
 extern void ptrArraySort (ptrArray *const current, int (*compare)(const void *, const void *));
 
@@ -15,22 +15,26 @@
 
 #include <string.h>
 #include <ctype.h>
+#include <limits.h>
 #include <stdlib.h>
+#include <time.h>
 
 #define FILE_WRITE
 #include "read.h"
 #include "read_p.h"
 #include "debug.h"
 #include "entry_p.h"
+#include "htable.h"
+#include "jobs_p.h"
 #include "routines.h"
 #include "routines_p.h"
 #include "options_p.h"
+#include "sampler_p.h"
 #include "parse_p.h"
 #include "promise.h"
 #include "promise_p.h"
 #include "stats_p.h"
 #include "trace.h"
-#include "trashbox.h"
 #ifdef HAVE_ICONV
 # include "mbcs.h"
 # include "mbcs_p.h"
@@ -55,7 +59,8 @@ typedef union sInputLangInfo {
 
 typedef struct sInputFileInfo {
 	vString *name;           /* name to report for input file */
-	vString *tagPath;        /* path of input file relative to tag file */
+	const char *tagPath;     /* path of input file relative to tag file;
+				    see getTagPath () */
 	unsigned long lineNumber;/* line number in the input file */
 	unsigned long lineNumberOrigin; /* The value set to `lineNumber'
 					   when `resetInputFile' is called
@@ -71,10 +76,29 @@ typedef struct sComputPos {
 	int crAdjustment;
 } compoundPos;
 
+/* A run of lines sharing the same kind of line ending. Each line of
+ * a CR LF run has a crAdjustment one larger than the line before it. */
+typedef struct sCrAdjustmentRun {
+	unsigned int start;	/* index of the first line in the run */
+	int crAdjustment;	/* crAdjustment of the first line */
+	bool crlf;
+} crAdjustmentRun;
+
+/* For a memory stream, only the offsets of lines are recorded; the MIOPos
+ * of a line is made from its offset, and crAdjustment is derived from
+ * crRuns. A file stream records a compoundPos for each line. */
 typedef struct sInputLineFposMap {
 	compoundPos *pos;
+	unsigned int *offsets;
+	MIO *mio;		/* the memory stream OFFSETS belong to */
+	crAdjustmentRun *crRuns;
+	unsigned int crRunCount;
+	unsigned int crRunSize;
 	unsigned int count;
 	unsigned int size;
+	/* The index of the line found last for an offset. The offsets are
+	 * asked in the order of the input usually. */
+	unsigned int lastFound;
 } inputLineFposMap;
 
 typedef struct sNestedInputStreamInfo {
@@ -82,16 +106,16 @@ typedef struct sNestedInputStreamInfo {
 	long startCharOffset;
 	unsigned long endLine;
 	long endCharOffset;
+	/* The offset of the stream in the input file */
+	long startOffset;
 } nestedInputStreamInfo;
 
 typedef struct sInputFile {
 	vString    *path;          /* path of input file (if any) */
 	vString    *line;          /* last line read from file */
-	const unsigned char* currentLine;  /* current line being worked on */
 	MIO        *mio;           /* MIO stream used for reading the file */
 	compoundPos    filePosition;  /* file position of current line */
-	unsigned int ungetchIdx;
-	int         ungetchBuf[8]; /* characters that were ungotten */
+	inputFileCursor cursor;    /* InputFileCursor while the file is not current */
 
 	bool bomFound;
 	/*  Contains data pertaining to the original `source' file in which the tag
@@ -103,22 +127,24 @@ typedef struct sInputFile {
 
 	nestedInputStreamInfo nestedInputStreamInfo;
 
-	/* sourceTagPathHolder is a kind of trash box.
-	   The buffer pointed by tagPath field of source field can
-	   be referred from tagsEntryInfo instances. sourceTagPathHolder
-	   is used keeping the buffer till all processing about the current
-	   input file is done. After all processing is done, the buffers
-	   in sourceTagPathHolder are destroyed. */
-	stringList  * sourceTagPathHolder;
 	inputLineFposMap lineFposMap;
+
+	/* The input for multiline regex patterns. If the lines read from
+	   the stream are the same as the bytes of the stream, the bytes
+	   are used directly, and allLines is not made. */
+	bool multilineRegexPending;
 	vString *allLines;
+	/* The patterns of the language look at the input through windows
+	   only: the mapped data behind the lines read can be released.
+	   releasedOffset is where it is released up to. */
+	bool releaseInput;
+	long releasedOffset;
 	int thinDepth;
 	time_t mtime;
+	/* The input ends after this line if it is not 0. */
+	unsigned long lastLineNumber;
 } inputFile;
 
-static inputLangInfo inputLang;
-static langType sourceLang;
-
 /*
 *   FUNCTION DECLARATIONS
 */
@@ -130,12 +156,39 @@ static langType langStackPop  (langStack *langStack);
 static void     langStackClear(langStack *langStack);
 
 
+/*  Everything needed for reading input files. The functions of this module
+ *  all work on the current context.
+ */
+struct sInputContext {
+	inputFile file;         /* static read through functions */
+	inputFile backupFile;   /* file is copied here when a nested parser is pushed */
+	compoundPos startOfLine;  /* holds deferred position of start of line */
+	inputLangInfo inputLang;
+	langType sourceLang;
+};
+
 /*
 *   DATA DEFINITIONS
 */
-static inputFile File;  /* static read through functions */
-static inputFile BackupFile;	/* File is copied here when a nested parser is pushed */
-static compoundPos StartOfLine;  /* holds deferred position of start of line */
+static inputContext DefaultContext;
+static inputContext *Context = &DefaultContext;
+
+/* The cursor of Context->file; see read.h */
+inputFileCursor InputFileCursor;
+
+/* The paths written to tag entries, keyed by --tag-relative mode and
+ * the name of the input file; see getTagPath () */
+static hashTable *TagPathTable;
+static vString *TagPathKey;
+
+/* See setInputDeadline () */
+static bool InputDeadlineSet;
+static clock_t InputDeadline;
+static bool InputCancelled;
+/* See setInputTimeLimit () */
+static bool InputTimeLimitSet;
+static clock_t InputTimeLimit;
+static bool InputTimeLimitReached;
 
 /*
 *   FUNCTION DEFINITIONS
@@ -143,28 +196,28 @@ static compoundPos StartOfLine;  /* holds deferred position of start of line */
 
 extern unsigned long getInputLineNumber (void)
 {
-	return File.input.lineNumber;
+	return Context->file.input.lineNumber;
 }
 
 extern int getInputLineOffset (void)
 {
-	unsigned char *base = (unsigned char *) vStringValue (File.line);
+	unsigned char *base = (unsigned char *) vStringValue (Context->file.line);
 	int ret;
 
-	if (File.currentLine)
-		ret = File.currentLine - base - File.ungetchIdx;
-	else if (File.input.lineNumber)
+	if (InputFileCursor.currentLine)
+		ret = InputFileCursor.currentLine - base - InputFileCursor.ungetchIdx;
+	else if (Context->file.input.lineNumber)
 	{
 		/* When EOF is saw, currentLine is set to NULL.
 		 * So the way to calculate the offset at the end of file is tricky.
 		 */
-		ret = (mio_tell (File.mio) - (File.bomFound? 3: 0))
-			- getInputFileOffsetForLine(File.input.lineNumber);
+		ret = (mio_tell (Context->file.mio) - (Context->file.bomFound? 3: 0))
+			- getInputFileOffsetForLine(Context->file.input.lineNumber);
 	}
 	else
 	{
 		/* At the first line of file. */
-		ret = mio_tell (File.mio) - (File.bomFound? 3: 0);
+		ret = mio_tell (Context->file.mio) - (Context->file.bomFound? 3: 0);
 	}
 
 	return ret >= 0 ? ret : 0;
@@ -172,51 +225,96 @@ extern int getInputLineOffset (void)
 
 extern const char *getInputFileName (void)
 {
-	if (!File.input.name)
+	if (!Context->file.input.name)
 		return NULL;
-	return vStringValue (File.input.name);
+	return vStringValue (Context->file.input.name);
 }
 
 extern MIOPos getInputFilePosition (void)
 {
-	return File.filePosition.pos;
+	return Context->file.filePosition.pos;
 }
 
-static compoundPos* getInputFileCompoundPosForLine (unsigned int line)
+static unsigned int getLineFposMapIndex (unsigned int line)
 {
-	int index;
+	unsigned int index;
 	if (line > 0)
 	{
-		if (File.lineFposMap.count > (line - 1))
+		if (Context->file.lineFposMap.count > (line - 1))
 			index = line - 1;
-		else if (File.lineFposMap.count != 0)
-			index = File.lineFposMap.count - 1;
+		else if (Context->file.lineFposMap.count != 0)
+			index = Context->file.lineFposMap.count - 1;
 		else
 			index = 0;
 	}
 	else
 		index = 0;
 
-	return File.lineFposMap.pos + index;
+	return index;
+}
+
+static int getLineFposMapCrAdjustment (inputLineFposMap *lineFposMap,
+									   unsigned int index)
+{
+	unsigned int lo = 0, hi = lineFposMap->crRunCount;
+
+	if (hi == 0)
+		return 0;
+
+	/* Find the last run starting at or before INDEX. */
+	while (hi - lo > 1)
+	{
+		unsigned int mid = lo + (hi - lo) / 2;
+		if (lineFposMap->crRuns [mid].start <= index)
+			lo = mid;
+		else
+			hi = mid;
+	}
+
+	crAdjustmentRun *run = lineFposMap->crRuns + lo;
+	return run->crAdjustment + (run->crlf? (int)(index - run->start): 0);
+}
+
+static compoundPos getInputFileCompoundPosForLine (unsigned int line)
+{
+	inputLineFposMap *lineFposMap = &Context->file.lineFposMap;
+	unsigned int index = getLineFposMapIndex (line);
+	compoundPos cpos;
+
+	if (lineFposMap->pos)
+		return lineFposMap->pos [index];
+
+	cpos.offset = lineFposMap->offsets [index];
+	mio_memory_getpos_at (lineFposMap->mio, cpos.offset, &cpos.pos);
+	cpos.open = (index + 1 >= lineFposMap->count);
+	cpos.crAdjustment = getLineFposMapCrAdjustment (lineFposMap, index);
+	return cpos;
 }
 
 extern MIOPos getInputFilePositionForLine (unsigned int line)
 {
-	compoundPos *cpos = getInputFileCompoundPosForLine (line);
-	return cpos->pos;
+	compoundPos cpos = getInputFileCompoundPosForLine (line);
+	return cpos.pos;
 }
 
 extern long getInputFileOffsetForLine (unsigned int line)
 {
-	compoundPos *cpos = getInputFileCompoundPosForLine (line);
-	long r = cpos->offset - (File.bomFound? 3: 0) - cpos->crAdjustment;
+	compoundPos cpos = getInputFileCompoundPosForLine (line);
+	long r = cpos.offset - (Context->file.bomFound? 3: 0) - cpos.crAdjustment;
 	Assert (r >= 0);
 	return r;
 }
 
 extern langType getInputLanguage (void)
 {
-	return langStackTop (&inputLang.stack);
+	return langStackTop (&Context->inputLang.stack);
+}
+
+extern langType getInputLanguageIfAny (void)
+{
+	if (Context->inputLang.stack.count == 0)
+		return LANG_IGNORE;
+	return langStackTop (&Context->inputLang.stack);
 }
 
 extern const char *getInputLanguageName (void)
@@ -226,7 +324,7 @@ extern const char *getInputLanguageName (void)
 
 extern const char *getInputFileTagPath (void)
 {
-	return vStringValue (File.input.tagPath);
+	return Context->file.input.tagPath;
 }
 
 extern bool isInputLanguage (langType lang)
@@ -236,7 +334,7 @@ extern bool isInputLanguage (langType lang)
 
 extern bool isInputHeaderFile (void)
 {
-	return File.input.isHeader;
+	return Context->file.input.isHeader;
 }
 
 extern bool isInputLanguageKindEnabled (int kindIndex)
@@ -272,17 +370,17 @@ extern bool doesInputLanguageRequestAutomaticFQTag (const tagEntryInfo *e)
 
 extern const char *getSourceFileTagPath (void)
 {
-	return vStringValue (File.source.tagPath);
+	return Context->file.source.tagPath;
 }
 
 extern langType getSourceLanguage (void)
 {
-	return sourceLang;
+	return Context->sourceLang;
 }
 
 extern unsigned long getSourceLineNumber (void)
 {
-	return File.source.lineNumber;
+	return Context->file.source.lineNumber;
 }
 
 static void freeInputFileInfo (inputFileInfo *finfo)
@@ -292,26 +390,96 @@ static void freeInputFileInfo (inputFileInfo *finfo)
 		vStringDelete (finfo->name);
 		finfo->name = NULL;
 	}
-	if (finfo->tagPath)
+	finfo->tagPath = NULL;
+}
+
+static void freeInputContextResources (inputContext *ctx)
+{
+	if (ctx->file.path != NULL)
+		vStringDelete (ctx->file.path);
+	if (ctx->file.line != NULL)
+		vStringDelete (ctx->file.line);
+	freeInputFileInfo (&ctx->file.input);
+	freeInputFileInfo (&ctx->file.source);
+	if (ctx->inputLang.stack.languages != NULL)
+		eFree (ctx->inputLang.stack.languages);
+}
+
+extern void freeInputFileResources (void)
+{
+	freeInputContextResources (&DefaultContext);
+	if (TagPathTable)
 	{
-		vStringDelete (finfo->tagPath);
-		finfo->tagPath = NULL;
+		hashTableDelete (TagPathTable);
+		TagPathTable = NULL;
+		vStringDelete (TagPathKey);
+		TagPathKey = NULL;
 	}
 }
 
-extern void freeInputFileResources (void)
+/*
+ * Input context management
+ *
+ * An embedder reading several inputs at once makes a context for each
+ * input, and switches the current context with setInputContext before
+ * calling functions of this module.
+ */
+extern inputContext *inputContextNew (void)
 {
-	if (File.path != NULL)
-		vStringDelete (File.path);
-	if (File.line != NULL)
-		vStringDelete (File.line);
-	freeInputFileInfo (&File.input);
-	freeInputFileInfo (&File.source);
+	return xCalloc (1, inputContext);
+}
+
+extern void inputContextDelete (inputContext *ctx)
+{
+	Assert (ctx != &DefaultContext);
+	Assert (ctx != Context);
+	Assert (ctx->file.mio == NULL);
+
+	freeInputContextResources (ctx);
+	eFree (ctx);
+}
+
+/* Returns the context which was current. Passing NULL selects the
+ * default context used by ctags itself. */
+extern inputContext *setInputContext (inputContext *ctx)
+{
+	inputContext *previous = Context;
+
+	previous->file.cursor = InputFileCursor;
+	Context = (ctx == NULL)? &DefaultContext: ctx;
+	InputFileCursor = Context->file.cursor;
+	return previous;
 }
 
 extern const unsigned char *getInputFileData (size_t *size)
 {
-	return mio_memory_get_data (File.mio, size);
+	return mio_memory_get_data (Context->file.mio, size);
+}
+
+extern void releaseInputFileData (const char *end)
+{
+	size_t size;
+	const char *data;
+
+	if (!Context->file.releaseInput)
+		return;
+
+	data = (const char *) mio_memory_get_data (Context->file.mio, &size);
+	if (data && data <= end && end <= data + size)
+		mio_memory_release (Context->file.mio, end - data);
+}
+
+extern size_t readInputFileBytes (long offset, void *buf, size_t size)
+{
+	MIOPos originalPosition;
+	size_t n = 0;
+
+	mio_getpos (Context->file.mio, &originalPosition);
+	if (mio_seek (Context->file.mio, offset, SEEK_SET) == 0)
+		n = mio_read (Context->file.mio, buf, 1, size);
+	mio_setpos (Context->file.mio, &originalPosition);
+	mio_clearerr (Context->file.mio);
+	return n;
 }
 
 /*
@@ -320,20 +488,56 @@ extern const unsigned char *getInputFileData (size_t *size)
 static void freeLineFposMap (inputLineFposMap *lineFposMap)
 {
 	if (lineFposMap->pos)
-	{
 		eFree (lineFposMap->pos);
-		lineFposMap->pos = NULL;
-		lineFposMap->count = 0;
-		lineFposMap->size = 0;
-	}
+	if (lineFposMap->offsets)
+		eFree (lineFposMap->offsets);
+	if (lineFposMap->crRuns)
+		eFree (lineFposMap->crRuns);
+	memset (lineFposMap, 0, sizeof (*lineFposMap));
 }
 
-static void allocLineFposMap (inputLineFposMap *lineFposMap)
+static void allocLineFposMap (inputLineFposMap *lineFposMap, MIO *mio)
 {
 #define INITIAL_lineFposMap_LEN 256
-	lineFposMap->pos = xCalloc (INITIAL_lineFposMap_LEN, compoundPos);
+	size_t size;
+
+	memset (lineFposMap, 0, sizeof (*lineFposMap));
+	if (mio_memory_get_data (mio, &size) && size < UINT_MAX)
+	{
+		lineFposMap->offsets = xMalloc (INITIAL_lineFposMap_LEN, unsigned int);
+		lineFposMap->mio = mio;
+	}
+	else
+		lineFposMap->pos = xCalloc (INITIAL_lineFposMap_LEN, compoundPos);
 	lineFposMap->size = INITIAL_lineFposMap_LEN;
-	lineFposMap->count = 0;
+}
+
+static void appendLineFposMapCrAdjustment (inputLineFposMap *lineFposMap,
+										   bool crAdjustment)
+{
+	unsigned int index = lineFposMap->count;
+	int lastCrAdjustment = 0;
+
+	if (lineFposMap->crRunCount != 0)
+	{
+		crAdjustmentRun *last = lineFposMap->crRuns + lineFposMap->crRunCount - 1;
+		if (last->crlf == crAdjustment)
+			return;
+		lastCrAdjustment = getLineFposMapCrAdjustment (lineFposMap, index - 1);
+	}
+
+	if (lineFposMap->crRunSize == lineFposMap->crRunCount)
+	{
+		lineFposMap->crRunSize = lineFposMap->crRunSize? lineFposMap->crRunSize * 2: 4;
+		lineFposMap->crRuns = xRealloc (lineFposMap->crRuns,
+										lineFposMap->crRunSize,
+										crAdjustmentRun);
+	}
+
+	crAdjustmentRun *run = lineFposMap->crRuns + lineFposMap->crRunCount++;
+	run->start = index;
+	run->crAdjustment = lastCrAdjustment + ((crAdjustment)? 1: 0);
+	run->crlf = crAdjustment;
 }
 
 static void appendLineFposMap (inputLineFposMap *lineFposMap, compoundPos *pos,
@@ -344,9 +548,21 @@ static void appendLineFposMap (inputLineFposMap *lineFposMap, compoundPos *pos,
 	if (lineFposMap->size == lineFposMap->count)
 	{
 		lineFposMap->size *= 2;
-		lineFposMap->pos = xRealloc (lineFposMap->pos,
-					     lineFposMap->size,
-					     compoundPos);
+		if (lineFposMap->pos)
+			lineFposMap->pos = xRealloc (lineFposMap->pos,
+										 lineFposMap->size,
+										 compoundPos);
+		else
+			lineFposMap->offsets = xRealloc (lineFposMap->offsets,
+											 lineFposMap->size,
+											 unsigned int);
+	}
+
+	if (lineFposMap->offsets)
+	{
+		appendLineFposMapCrAdjustment (lineFposMap, crAdjustment);
+		lineFposMap->offsets [lineFposMap->count++] = (unsigned int)pos->offset;
+		return;
 	}
 
 	if (lineFposMap->count != 0)
@@ -362,35 +578,57 @@ static void appendLineFposMap (inputLineFposMap *lineFposMap, compoundPos *pos,
 	lineFposMap->count++;
 }
 
-static int compoundPosForOffset (const void* oft, const void *p)
+static long getLineFposMapAdjustedOffset (inputLineFposMap *lineFposMap,
+										  unsigned int index)
 {
-	long offset = *(long *)oft;
-	const compoundPos *pos = p;
-	const compoundPos *next = (compoundPos *)(((char *)pos) + sizeof (compoundPos));
-
-	if (offset < (pos->offset - pos->crAdjustment))
-		return -1;
-	else if (((pos->offset - pos->crAdjustment) <= offset)
-		 && (pos->open
-		     || (offset < (next->offset - next->crAdjustment))))
-		return 0;
-	else
-		return 1;
+	if (lineFposMap->pos)
+		return lineFposMap->pos [index].offset - lineFposMap->pos [index].crAdjustment;
+	return (long)lineFposMap->offsets [index]
+		- getLineFposMapCrAdjustment (lineFposMap, index);
 }
 
+/* How many lines after the line found last are tried one by one
+ * before searching */
+#define LINE_FPOS_MAP_LINEAR_STEPS 8
+
 extern unsigned long getInputLineNumberForFileOffset(long offset)
 {
-	compoundPos *p;
+	inputLineFposMap *lineFposMap = &Context->file.lineFposMap;
+	unsigned int lo = 0, hi = lineFposMap->count;
 
-	if (File.bomFound)
+	if (Context->file.bomFound)
 		offset += 3;
 
-	p = bsearch (&offset, File.lineFposMap.pos, File.lineFposMap.count, sizeof (compoundPos),
-		     compoundPosForOffset);
-	if (p == NULL)
+	if (hi == 0 || offset < getLineFposMapAdjustedOffset (lineFposMap, 0))
 		return 1;	/* TODO: 0? */
-	else
-		return 1 + (p - File.lineFposMap.pos);
+
+	/* Find the last line starting at or before OFFSET. */
+	if (lineFposMap->lastFound < hi
+		&& getLineFposMapAdjustedOffset (lineFposMap, lineFposMap->lastFound) <= offset)
+	{
+		lo = lineFposMap->lastFound;
+		for (unsigned int i = 0; i < LINE_FPOS_MAP_LINEAR_STEPS; i++)
+		{
+			if (lo + 1 == hi
+				|| offset < getLineFposMapAdjustedOffset (lineFposMap, lo + 1))
+			{
+				hi = lo + 1;
+				break;
+			}
+			lo++;
+		}
+	}
+
+	while (hi - lo > 1)
+	{
+		unsigned int mid = lo + (hi - lo) / 2;
+		if (getLineFposMapAdjustedOffset (lineFposMap, mid) <= offset)
+			lo = mid;
+		else
+			hi = mid;
+	}
+	lineFposMap->lastFound = lo;
+	return 1 + lo;
 }
 
 /*
@@ -402,58 +640,82 @@ static void setOwnerDirectoryOfInputFile (const char *const fileName)
 	const char *const head = fileName;
 	const char *const tail = baseFilename (head);
 
-	if (File.path != NULL)
-		vStringDelete (File.path);
+	if (Context->file.path != NULL)
+		vStringDelete (Context->file.path);
 	if (tail == head)
-		File.path = NULL;
+		Context->file.path = NULL;
 	else
 	{
 		const size_t length = tail - head - 1;
-		File.path = vStringNew ();
-		vStringNCopyS (File.path, fileName, length);
+		Context->file.path = vStringNew ();
+		vStringNCopyS (Context->file.path, fileName, length);
 	}
 }
 
-static void setInputFileParametersCommon (inputFileInfo *finfo, vString *const fileName,
-					  const langType language,
-					  stringList *holder)
+/*  Return the path of FILENAME written to tag entries. The path is
+ *  computed once for a file name, and kept until the end of the run, so
+ *  tag entries can refer to it without copying.
+ */
+extern const char *getTagPath (const char *const fileName)
 {
-	if (finfo->name != NULL)
-		vStringDelete (finfo->name);
-	finfo->name = fileName;
+	char *tagPath;
 
-	if (finfo->tagPath != NULL)
+	if (TagPathTable == NULL)
 	{
-		if (holder)
-			stringListAdd (holder, finfo->tagPath);
-		else
-			vStringDelete (finfo->tagPath);
+		TagPathTable = hashTableNew (1024, hashCstrhash, hashCstreq, eFree, eFree);
+		TagPathKey = vStringNew ();
 	}
 
-	if (0)
-		;
-	else if (  Option.tagRelative == TREL_ALWAYS )
-		finfo->tagPath =
-			vStringNewOwn (relativeFilename (vStringValue (fileName),
-							 getTagFileDirectory ()));
+	/* --tag-relative can be changed in the middle of a -L list. */
+	vStringClear (TagPathKey);
+	vStringPut (TagPathKey, '0' + Option.tagRelative);
+	vStringCatS (TagPathKey, fileName);
+
+	tagPath = hashTableGetItem (TagPathTable, vStringValue (TagPathKey));
+	if (tagPath)
+		return tagPath;
+
+	if (  Option.tagRelative == TREL_ALWAYS )
+		tagPath = relativeFilename (fileName, getTagFileDirectory ());
 	else if ( Option.tagRelative == TREL_NEVER )
-		finfo->tagPath =
-			vStringNewOwn (absoluteFilename (vStringValue (fileName)));
-	else if ( Option.tagRelative == TREL_NO || isAbsolutePath (vStringValue (fileName)) )
-		finfo->tagPath = vStringNewCopy (fileName);
+		tagPath = absoluteFilename (fileName);
+	else if ( Option.tagRelative == TREL_NO || isAbsolutePath (fileName) )
+		tagPath = eStrdup (fileName);
 	else
-		finfo->tagPath =
-			vStringNewOwn (relativeFilename (vStringValue (fileName),
-							 getTagFileDirectory ()));
+		tagPath = relativeFilename (fileName, getTagFileDirectory ());
 
+	hashTablePutItem (TagPathTable, eStrdup (vStringValue (TagPathKey)), tagPath);
+	return tagPath;
+}
+
+static void setInputFileParametersCommon (inputFileInfo *finfo, vString *const fileName,
+					  const langType language)
+{
+	if (finfo->name != NULL)
+		vStringDelete (finfo->name);
+	finfo->name = fileName;
+
+	finfo->tagPath = getTagPath (vStringValue (fileName));
 	finfo->isHeader = isIncludeFile (vStringValue (fileName));
 }
 
+static void notifyLangOnStack (inputLangInfo *langInfo)
+{
+	const langType language = (langInfo->stack.count > 0)
+		? langStackTop (&langInfo->stack)
+		: LANG_IGNORE;
+
+	switchTimingLanguage (language);
+	switchMemoryLanguage (language);
+	switchSamplingLanguage (language);
+}
+
 static void resetLangOnStack (inputLangInfo *langInfo, langType lang)
 {
 	Assert (langInfo->stack.count > 0);
 	langStackClear  (& (langInfo->stack));
 	langStackPush (& (langInfo->stack), lang);
+	notifyLangOnStack (langInfo);
 }
 
 extern langType baseLangOnStack (inputLangInfo *langInfo)
@@ -465,30 +727,35 @@ extern langType baseLangOnStack (inputLangInfo *langInfo)
 static void pushLangOnStack (inputLangInfo *langInfo, langType lang)
 {
 	langStackPush (& langInfo->stack, lang);
+	notifyLangOnStack (langInfo);
 }
 
 static langType popLangOnStack (inputLangInfo *langInfo)
 {
-	return langStackPop (& langInfo->stack);
+	langType lang = langStackPop (& langInfo->stack);
+
+	notifyLangOnStack (langInfo);
+	return lang;
 }
 
 static void clearLangOnStack (inputLangInfo *langInfo)
 {
 	langStackClear (& langInfo->stack);
+	notifyLangOnStack (langInfo);
 }
 
 static void setInputFileParameters (vString *const fileName, const langType language)
 {
-	setInputFileParametersCommon (&File.input, fileName,
-				      language, NULL);
-	pushLangOnStack(&inputLang, language);
+	setInputFileParametersCommon (&Context->file.input, fileName,
+				      language);
+	pushLangOnStack(&Context->inputLang, language);
 }
 
 static void setSourceFileParameters (vString *const fileName, const langType language)
 {
-	setInputFileParametersCommon (&File.source, fileName,
-				      language, File.sourceTagPathHolder);
-	sourceLang = language;
+	setInputFileParametersCommon (&Context->file.source, fileName,
+				      language);
+	Context->sourceLang = language;
 }
 
 static bool setSourceFileName (vString *const fileName)
@@ -498,12 +765,12 @@ static bool setSourceFileName (vString *const fileName)
 	if (language != LANG_IGNORE)
 	{
 		vString *pathName;
-		if (isAbsolutePath (vStringValue (fileName)) || File.path == NULL)
+		if (isAbsolutePath (vStringValue (fileName)) || Context->file.path == NULL)
 			pathName = vStringNewCopy (fileName);
 		else
 		{
 			char *tmp = combinePathAndFile (
-				vStringValue (File.path), vStringValue (fileName));
+				vStringValue (Context->file.path), vStringValue (fileName));
 			pathName = vStringNewOwn (tmp);
 		}
 		setSourceFileParameters (pathName, language);
@@ -599,12 +866,12 @@ static bool parseLineDirective (char *s)
 			vString *const fileName = readFileName (s);
 			if (vStringLength (fileName) == 0)
 			{
-				File.source.lineNumber = lNum - 1;  /* applies to NEXT line */
+				Context->file.source.lineNumber = lNum - 1;  /* applies to NEXT line */
 				DebugStatement ( debugPrintf (DEBUG_RAW, "#%s %ld", lineStr, lNum); )
 			}
 			else if (setSourceFileName (fileName))
 			{
-				File.source.lineNumber = lNum - 1;  /* applies to NEXT line */
+				Context->file.source.lineNumber = lNum - 1;  /* applies to NEXT line */
 				DebugStatement ( debugPrintf (DEBUG_RAW, "#%s %ld \"%s\"",
 								lineStr, lNum, vStringValue (fileName)); )
 			}
@@ -628,7 +895,7 @@ static bool parseLineDirective (char *s)
 #define MAX_IN_MEMORY_FILE_SIZE (1024*1024)
 #endif
 
-static MIO *getMioFull (const char *const fileName, const char *const openMode,
+extern MIO *getMioFull (const char *const fileName, const char *const openMode,
 		    bool memStreamRequired, time_t *mtime)
 {
 	FILE *src;
@@ -641,6 +908,18 @@ static MIO *getMioFull (const char *const fileName, const char *const openMode,
 	if (mtime)
 		*mtime = st->mtime;
 	eStatFree (st);
+
+	/* Mapping doesn't copy the data, and the pages are shared with the
+	 * page cache. So use it for files of any size when it is asked for.
+	 * It is not the default: if a mapped file gets shorter while it is
+	 * parsed, reading the lost pages kills the process with SIGBUS. */
+	if (Option.mapInput && size > 0)
+	{
+		MIO *mio = mio_new_mmap (fileName);
+		if (mio)
+			return mio;
+	}
+
 	if ((!memStreamRequired)
 	    && (size > MAX_IN_MEMORY_FILE_SIZE || size == 0))
 		return mio_new_file (fileName, openMode);
@@ -683,6 +962,48 @@ static bool checkUTF8BOM (MIO *mio, bool skipIfFound)
 	return r;
 }
 
+/* readLine () turns CR LF into LF, and drops the rest of a line after
+ * NUL. If the stream has neither of them, the concatenation of the
+ * lines read from it is the same as its bytes after the BOM. */
+static bool hasCrOrNul (const char *data, size_t len)
+{
+	const char *end = data + len;
+
+	while (data < end)
+	{
+		size_t n = end - data;
+		if (Context->file.releaseInput && n > INPUT_RELEASE_STEP)
+			n = INPUT_RELEASE_STEP;
+
+		if (memchr (data, '\r', n) || memchr (data, '\0', n))
+			return true;
+		data += n;
+		releaseInputFileData (data);
+	}
+	return false;
+}
+
+static const char *getInputDataAfterBOM (size_t *size)
+{
+	const char *data = (const char *)mio_memory_get_data (Context->file.mio, size);
+
+	if (data && Context->file.bomFound)
+	{
+		Assert (*size >= 3);
+		data += 3;
+		*size -= 3;
+	}
+	return data;
+}
+
+static bool getMultilineRegexInputInPlace (void)
+{
+	size_t len;
+	const char *data = getInputDataAfterBOM (&len);
+
+	return (data && !hasCrOrNul (data, len));
+}
+
 static void rewindInputFile (inputFile *f)
 {
 	mio_rewind (f->mio);
@@ -700,7 +1021,7 @@ static void rewindInputFile (inputFile *f)
 }
 
 /*  This function opens an input file, and resets the line counter.  If it
- *  fails, it will display an error message and leave the File.mio set to NULL.
+ *  fails, it will display an error message and leave the Context->file.mio set to NULL.
  */
 extern bool openInputFile (const char *const fileName, const langType language,
 			      MIO *mio, time_t mtime)
@@ -711,10 +1032,10 @@ extern bool openInputFile (const char *const fileName, const langType language,
 
 	/*	If another file was already open, then close it.
 	 */
-	if (File.mio != NULL)
+	if (Context->file.mio != NULL)
 	{
-		mio_unref (File.mio);  /* close any open input file */
-		File.mio = NULL;
+		mio_unref (Context->file.mio);  /* close any open input file */
+		Context->file.mio = NULL;
 	}
 
 	/* File position is used as key for checking the availability of
@@ -722,14 +1043,9 @@ extern bool openInputFile (const char *const fileName, const langType language,
 	   key is meaningless. So notifying the changing here. */
 	invalidatePatternCache();
 
-	if (File.sourceTagPathHolder == NULL)
-	{
-		File.sourceTagPathHolder = stringListNew ();
-		DEFAULT_TRASH_BOX(File.sourceTagPathHolder, stringListDelete);
-	}
-	stringListClear (File.sourceTagPathHolder);
 
-	memStreamRequired = doesParserRequireMemoryStream (language);
+	memStreamRequired = (doesParserRequireMemoryStream (language)
+						 || doesInputFileRequireMemoryStream (fileName, language));
 
 	if (mio)
 	{
@@ -740,42 +1056,45 @@ extern bool openInputFile (const char *const fileName, const langType language,
 			mio_rewind (mio);
 	}
 
-	File.mio = mio? mio_ref (mio): getMioFull (fileName, openMode, memStreamRequired, &File.mtime);
+	const timingPhase phase = enterTimingPhase (PHASE_READ);
+	Context->file.mio = mio? mio_ref (mio): getMioFull (fileName, openMode, memStreamRequired, &Context->file.mtime);
+	leaveTimingPhase (phase);
 
-	if (File.mio == NULL)
+	if (Context->file.mio == NULL)
 		error (WARNING | PERROR, "cannot open \"%s\"", fileName);
 	else
 	{
 		opened = true;
 
-		if (File.mio == mio)
-			File.mtime = mtime;
+		if (Context->file.mio == mio)
+			Context->file.mtime = mtime;
 
-		File.bomFound = checkUTF8BOM (File.mio, true);
+		Context->file.bomFound = checkUTF8BOM (Context->file.mio, true);
 
 		setOwnerDirectoryOfInputFile (fileName);
-		mio_getpos (File.mio, &StartOfLine.pos);
-		mio_getpos (File.mio, &File.filePosition.pos);
-		File.filePosition.offset = StartOfLine.offset = mio_tell (File.mio);
-		File.currentLine  = NULL;
+		mio_getpos (Context->file.mio, &Context->startOfLine.pos);
+		mio_getpos (Context->file.mio, &Context->file.filePosition.pos);
+		Context->file.filePosition.offset = Context->startOfLine.offset = mio_tell (Context->file.mio);
+		InputFileCursor.currentLine  = NULL;
 
-		File.line = vStringNewOrClear (File.line);
-		File.ungetchIdx = 0;
+		Context->file.line = vStringNewOrClear (Context->file.line);
+		InputFileCursor.ungetchIdx = 0;
 
 		setInputFileParameters  (vStringNewInit (fileName), language);
-		File.input.lineNumberOrigin = 0L;
-		File.input.lineNumber = File.input.lineNumberOrigin;
+		Context->file.input.lineNumberOrigin = 0L;
+		Context->file.input.lineNumber = Context->file.input.lineNumberOrigin;
 		setSourceFileParameters (vStringNewInit (fileName), language);
-		File.source.lineNumberOrigin = 0L;
-		File.source.lineNumber = File.source.lineNumberOrigin;
-		allocLineFposMap (&File.lineFposMap);
+		Context->file.source.lineNumberOrigin = 0L;
+		Context->file.source.lineNumber = Context->file.source.lineNumberOrigin;
+		allocLineFposMap (&Context->file.lineFposMap, Context->file.mio);
 
-		File.thinDepth = 0;
+		Context->file.thinDepth = 0;
+		Context->file.lastLineNumber = 0;
 		verbose ("OPENING%s %s as %s language %sfile [%s%s]\n",
-				 (File.bomFound? "(skipping utf-8 bom)": ""),
+				 (Context->file.bomFound? "(skipping utf-8 bom)": ""),
 				 fileName,
 				 getLanguageName (language),
-				 File.input.isHeader ? "include " : "",
+				 Context->file.input.isHeader ? "include " : "",
 				 mio? "reused": "new",
 				 memStreamRequired? ",required": "");
 	}
@@ -784,81 +1103,93 @@ extern bool openInputFile (const char *const fileName, const langType language,
 
 extern time_t getInputFileMtime (void)
 {
-	return File.mtime;
+	return Context->file.mtime;
 }
 
 extern void resetInputFile (const langType language)
 {
-	Assert (File.mio);
+	Assert (Context->file.mio);
 
-	rewindInputFile  (&File);
-	mio_getpos (File.mio, &StartOfLine.pos);
-	mio_getpos (File.mio, &File.filePosition.pos);
-	File.filePosition.offset = StartOfLine.offset = mio_tell (File.mio);
-	File.currentLine  = NULL;
+	rewindInputFile  (&Context->file);
+	mio_getpos (Context->file.mio, &Context->startOfLine.pos);
+	mio_getpos (Context->file.mio, &Context->file.filePosition.pos);
+	Context->file.filePosition.offset = Context->startOfLine.offset = mio_tell (Context->file.mio);
+	InputFileCursor.currentLine  = NULL;
 
-	Assert (File.line);
-	vStringClear (File.line);
-	File.ungetchIdx = 0;
+	Assert (Context->file.line);
+	vStringClear (Context->file.line);
+	InputFileCursor.ungetchIdx = 0;
 
-	if (hasLanguageMultilineRegexPatterns (language))
-		File.allLines = vStringNew ();
+	Context->file.multilineRegexPending = hasLanguageMultilineRegexPatterns (language);
+	Context->file.releaseInput = (Context->file.multilineRegexPending
+								  && doesLanguageStreamRegexInput (language));
+	Context->file.releasedOffset = 0;
+	if (Context->file.multilineRegexPending
+		&& !getMultilineRegexInputInPlace ())
+		Context->file.allLines = vStringNew ();
 
-	resetLangOnStack (& inputLang, language);
-	File.input.lineNumber = File.input.lineNumberOrigin;
-	sourceLang = language;
-	File.source.lineNumber = File.source.lineNumberOrigin;
+	resetLangOnStack (&Context->inputLang, language);
+	Context->file.input.lineNumber = Context->file.input.lineNumberOrigin;
+	Context->sourceLang = language;
+	Context->file.source.lineNumber = Context->file.source.lineNumberOrigin;
 }
 
 extern void closeInputFile (void)
 {
-	if (File.mio != NULL)
+	if (Context->file.mio != NULL)
 	{
-		clearLangOnStack (& inputLang);
+		clearLangOnStack (&Context->inputLang);
 
 		/*  The line count of the file is 1 too big, since it is one-based
 		 *  and is incremented upon each newline.
 		 */
-		if (Option.printTotals)
+		if (Option.printTotals || isRecordingFileStatistics ())
 		{
-			fileStatus *status = eStat (vStringValue (File.input.name));
-			addTotals (0, File.input.lineNumber - 1L, status->size);
+			size_t size;
+
+			/* The contents given in interactive mode may not be on disk. */
+			if (mio_memory_get_data (Context->file.mio, &size) == NULL)
+			{
+				fileStatus *status = eStat (vStringValue (Context->file.input.name));
+				size = status->size;
+			}
+			addTotals (0, Context->file.input.lineNumber - 1L, size);
 		}
-		mio_unref (File.mio);
-		File.mio = NULL;
-		freeLineFposMap (&File.lineFposMap);
+		mio_unref (Context->file.mio);
+		Context->file.mio = NULL;
+		freeLineFposMap (&Context->file.lineFposMap);
 	}
 }
 
 extern void *getInputFileUserData(void)
 {
-	return mio_get_user_data (File.mio);
+	return mio_get_user_data (Context->file.mio);
 }
 
 /*  Action to take for each encountered input newline.
  */
 static void fileNewline (bool crAdjustment)
 {
-	File.filePosition = StartOfLine;
+	Context->file.filePosition = Context->startOfLine;
 
-	if (BackupFile.mio == NULL)
-		appendLineFposMap (&File.lineFposMap, &File.filePosition,
+	if (Context->backupFile.mio == NULL)
+		appendLineFposMap (&Context->file.lineFposMap, &Context->file.filePosition,
 						   crAdjustment);
 
-	File.input.lineNumber++;
-	File.source.lineNumber++;
-	DebugStatement ( if (Option.breakLine == File.input.lineNumber) lineBreak (); )
-	DebugStatement ( debugPrintf (DEBUG_RAW, "%6ld: ", File.input.lineNumber); )
+	Context->file.input.lineNumber++;
+	Context->file.source.lineNumber++;
+	DebugStatement ( if (Option.breakLine == Context->file.input.lineNumber) lineBreak (); )
+	DebugStatement ( debugPrintf (DEBUG_RAW, "%6ld: ", Context->file.input.lineNumber); )
 }
 
 extern void ungetcToInputFile (int c)
 {
-	const size_t len = ARRAY_SIZE (File.ungetchBuf);
+	const size_t len = ARRAY_SIZE (InputFileCursor.ungetchBuf);
 
-	Assert (File.ungetchIdx < len);
+	Assert (InputFileCursor.ungetchIdx < len);
 	/* we cannot rely on the assertion that might be disabled in non-debug mode */
-	if (File.ungetchIdx < len)
-		File.ungetchBuf[File.ungetchIdx++] = c;
+	if (InputFileCursor.ungetchIdx < len)
+		InputFileCursor.ungetchBuf[InputFileCursor.ungetchIdx++] = c;
 }
 
 typedef enum eEolType {
@@ -872,9 +1203,27 @@ static eolType readLine (vString *const vLine, MIO *const mio)
 	char *str;
 	size_t size;
 	eolType r = eol_nl;
+	const unsigned char *line;
 
 	vStringClear (vLine);
 
+	/* Fast path for memory streams: the end of line is found with memchr
+	 * and the line is copied at once. A line including NUL is left to
+	 * the loop below not to change how such a line is handled. */
+	line = mio_memory_peek_line (mio, &size);
+	if (line && memchr (line, '\0', size) == NULL)
+	{
+		vStringNCatSUnsafe (vLine, (const char *) line, size);
+		mio_seek (mio, (long) size, SEEK_CUR);
+		if (size > 1 && line [size - 2] == '\r')
+		{
+			vStringChar (vLine, size - 2) = '\n';
+			vStringChop (vLine);
+			r = eol_cr_nl;
+		}
+		return r;
+	}
+
 	str = vStringValue (vLine);
 	size = vStringSize (vLine);
 
@@ -916,48 +1265,99 @@ static eolType readLine (vString *const vLine, MIO *const mio)
 	return r;
 }
 
+/* Returns false if no more line can be read: the last line of the
+ * narrowed input is read, or the time given for the input is over. */
+static bool isNextLineReadable (void)
+{
+	if (Context->file.lastLineNumber > 0
+		&& Context->file.input.lineNumber >= Context->file.lastLineNumber)
+		return false;
+	/* Look at the clock only once in a while to keep reading lines cheap. */
+	if ((InputDeadlineSet || InputTimeLimitSet)
+		&& (Context->file.input.lineNumber & 0x3f) == 0)
+	{
+		const clock_t now = clock ();
+
+		if (InputDeadlineSet && now >= InputDeadline)
+			InputCancelled = true;
+		if (InputTimeLimitSet && now >= InputTimeLimit)
+			InputTimeLimitReached = true;
+	}
+	return !(InputCancelled || InputTimeLimitReached);
+}
+
 static vString *iFileGetLine (bool chop_newline)
 {
 	eolType eol;
 	langType lang = getInputLanguage();
 
-	Assert (File.line);
-	eol = readLine (File.line, File.mio);
+	Assert (Context->file.line);
+	if (!isNextLineReadable ())
+		return NULL;
+	eol = readLine (Context->file.line, Context->file.mio);
 
-	if (vStringLength (File.line) > 0)
+	if (vStringLength (Context->file.line) > 0)
 	{
-		/* Use StartOfLine from previous iFileGetLine() call */
+		/* Use Context->startOfLine from previous iFileGetLine() call */
 		fileNewline (eol == eol_cr_nl);
-		/* Store StartOfLine for the next iFileGetLine() call */
-		mio_getpos (File.mio, &StartOfLine.pos);
-		StartOfLine.offset = mio_tell (File.mio);
+		/* Store Context->startOfLine for the next iFileGetLine() call */
+		mio_getpos (Context->file.mio, &Context->startOfLine.pos);
+		Context->startOfLine.offset = mio_tell (Context->file.mio);
 
-		if (Option.lineDirectives && vStringChar (File.line, 0) == '#')
-			parseLineDirective (vStringValue (File.line) + 1);
+		if (Context->file.releaseInput
+			&& (Context->startOfLine.offset - Context->file.releasedOffset
+				>= INPUT_RELEASE_STEP))
+		{
+			mio_memory_release (Context->file.mio, Context->startOfLine.offset);
+			Context->file.releasedOffset = Context->startOfLine.offset;
+		}
 
-		if (File.allLines)
-			vStringCat (File.allLines, File.line);
+		if (Option.lineDirectives && vStringChar (Context->file.line, 0) == '#')
+			parseLineDirective (vStringValue (Context->file.line) + 1);
 
-		bool chopped = vStringStripNewline (File.line);
+		if (Context->file.allLines)
+			vStringCat (Context->file.allLines, Context->file.line);
 
-		matchLanguageRegex (lang, File.line);
+		bool chopped = vStringStripNewline (Context->file.line);
+
+		matchLanguageRegex (lang, Context->file.line);
 
 		if (chopped && !chop_newline)
-			vStringPutNewlinAgainUnsafe (File.line);
+			vStringPutNewlinAgainUnsafe (Context->file.line);
 
-		return File.line;
+		return Context->file.line;
 	}
 	else
 	{
-		if (File.allLines)
+		if (Context->file.multilineRegexPending)
 		{
-			matchLanguageMultilineRegex (lang, File.allLines);
-			matchLanguageMultitableRegex (lang, File.allLines);
+			const char *input = NULL;
+			size_t size = 0;
 
 			/* To limit the execution of multiline/multitable parser(s) only
-			   ONCE, clear File.allLines field. */
-			vStringDelete (File.allLines);
-			File.allLines = NULL;
+			   ONCE, clear Context->file.multilineRegexPending field. */
+			Context->file.multilineRegexPending = false;
+
+			if (Context->file.allLines)
+			{
+				input = vStringValue (Context->file.allLines);
+				size = vStringLength (Context->file.allLines);
+			}
+			else
+			{
+				/* resetInputFile () found the bytes usable in place. */
+				input = getInputDataAfterBOM (&size);
+				Assert (input);
+			}
+
+			matchLanguageMultilineRegex (lang, input, size);
+			matchLanguageMultitableRegex (lang, input, size);
+
+			if (Context->file.allLines)
+			{
+				vStringDelete (Context->file.allLines);
+				Context->file.allLines = NULL;
+			}
 		}
 		return NULL;
 	}
@@ -965,7 +1365,7 @@ static vString *iFileGetLine (bool chop_newline)
 
 /*  Do not mix use of readLineFromInputFile () and getcFromInputFile () for the same file.
  */
-extern int getcFromInputFile (void)
+extern int getcFromInputFileFull (void)
 {
 	int c;
 
@@ -973,25 +1373,25 @@ extern int getcFromInputFile (void)
 	 *  other processing on it, though, because we already did that the
 	 *  first time it was read through getcFromInputFile ().
 	 */
-	if (File.ungetchIdx > 0)
+	if (InputFileCursor.ungetchIdx > 0)
 	{
-		c = File.ungetchBuf[--File.ungetchIdx];
+		c = InputFileCursor.ungetchBuf[--InputFileCursor.ungetchIdx];
 		return c;  /* return here to avoid re-calling debugPutc () */
 	}
 	do
 	{
-		if (File.currentLine != NULL)
+		if (InputFileCursor.currentLine != NULL)
 		{
-			c = *File.currentLine++;
+			c = *InputFileCursor.currentLine++;
 			if (c == '\0')
-				File.currentLine = NULL;
+				InputFileCursor.currentLine = NULL;
 		}
 		else
 		{
 			vString* const line = iFileGetLine (false);
 			if (line != NULL)
-				File.currentLine = (unsigned char*) vStringValue (line);
-			if (File.currentLine == NULL)
+				InputFileCursor.currentLine = (unsigned char*) vStringValue (line);
+			if (InputFileCursor.currentLine == NULL)
 				c = EOF;
 			else
 				c = '\0';
@@ -1001,22 +1401,177 @@ extern int getcFromInputFile (void)
 	return c;
 }
 
+extern unsigned long getInputLineNumberAtNewline (void)
+{
+	const unsigned char *line = (unsigned char *) vStringValue (Context->file.line);
+
+	if (InputFileCursor.ungetchIdx > 0
+		|| InputFileCursor.currentLine == NULL
+		|| *InputFileCursor.currentLine != '\0'
+		|| InputFileCursor.currentLine == line
+		|| InputFileCursor.currentLine [-1] != '\n')
+		return 0;
+	return Context->file.input.lineNumber;
+}
+
+extern void skipInputFileLines (unsigned long lineNumber)
+{
+	Assert (InputFileCursor.ungetchIdx == 0);
+	Assert (InputFileCursor.currentLine == NULL);
+
+	while (Context->file.input.lineNumber < lineNumber)
+		if (iFileGetLine (false) == NULL)
+			break;
+}
+
+extern void setInputDeadline (unsigned long msec)
+{
+	InputDeadlineSet = (msec > 0);
+	InputDeadline = clock () + (clock_t) (msec * (CLOCKS_PER_SEC / 1000.0));
+	InputCancelled = false;
+}
+
+extern bool isInputCancelled (void)
+{
+	return InputCancelled;
+}
+
+extern void setInputTimeLimit (unsigned long msec)
+{
+	InputTimeLimitSet = (msec > 0);
+	InputTimeLimit = clock () + (clock_t) (msec * (CLOCKS_PER_SEC / 1000.0));
+	InputTimeLimitReached = false;
+}
+
+extern bool isInputTimeLimitReached (void)
+{
+	return InputTimeLimitReached;
+}
+
+extern void setInputFileLastLine (unsigned long lineNumber)
+{
+	Context->file.lastLineNumber = lineNumber;
+}
+
+extern const unsigned char *peekCharsInInputFile (void)
+{
+	if (InputFileCursor.ungetchIdx > 0)
+		return NULL;
+	return InputFileCursor.currentLine;
+}
+
+extern void skipCharsInInputFile (size_t count)
+{
+	Assert (InputFileCursor.ungetchIdx == 0);
+	Assert (InputFileCursor.currentLine != NULL);
+	Assert (strlen ((const char *) InputFileCursor.currentLine) >= count);
+
+	DebugStatement (
+		for (size_t i = 0; i < count; i++)
+			debugPutc (DEBUG_READ, InputFileCursor.currentLine [i]);
+		)
+	InputFileCursor.currentLine += count;
+}
+
+/* returns the nth next character (0 meaning the one getcFromInputFile ()
+ * returns next) without reading it, or def if nth cannot be accessed.
+ * Note that this can't access next line data. */
+extern int peekNthCFromInputFile (unsigned int nth, int def)
+{
+	if (nth < InputFileCursor.ungetchIdx)
+		return InputFileCursor.ungetchBuf[InputFileCursor.ungetchIdx - 1 - nth];
+	nth -= InputFileCursor.ungetchIdx;
+
+	if (InputFileCursor.currentLine == NULL)
+		return def;
+	for (const unsigned char *p = InputFileCursor.currentLine; *p != '\0'; p++)
+	{
+		if (nth-- == 0)
+			return *p;
+	}
+	return def;
+}
+
+extern bool matchStringInInputFile (const char *str)
+{
+	const unsigned char *rest = peekCharsInInputFile ();
+	size_t i;
+
+	if (rest)
+	{
+		for (i = 0; str[i] != '\0' && rest[i] == (unsigned char) str[i]; i++)
+			;
+		if (str[i] == '\0')
+		{
+			skipCharsInInputFile (i);
+			return true;
+		}
+		/* The string may continue on the next line. */
+		if (rest[i] != '\0')
+			return false;
+	}
+
+	/* Take the characters one by one, and put them back on mismatch. */
+	int c[ARRAY_SIZE (InputFileCursor.ungetchBuf)];
+	size_t n = 0;
+	bool matched = true;
+
+	for (i = 0; str[i] != '\0'; i++)
+	{
+		Assert (n < ARRAY_SIZE (c));
+		if (n == ARRAY_SIZE (c)
+			|| (c[n++] = getcFromInputFile ()) != (unsigned char) str[i])
+		{
+			matched = false;
+			break;
+		}
+	}
+
+	if (!matched)
+	{
+		while (n > 0)
+			ungetcToInputFile (c[--n]);
+	}
+	return matched;
+}
+
 /* returns the nth previous character (0 meaning current), or def if nth cannot
  * be accessed.  Note that this can't access previous line data. */
 extern int getNthPrevCFromInputFile (unsigned int nth, int def)
 {
-	const unsigned char *base = (unsigned char *) vStringValue (File.line);
-	const unsigned int offset = File.ungetchIdx + 1 + nth;
+	const unsigned char *base = (unsigned char *) vStringValue (Context->file.line);
+	const unsigned int offset = InputFileCursor.ungetchIdx + 1 + nth;
 
-	if (File.currentLine != NULL && File.currentLine >= base + offset)
-		return (int) *(File.currentLine - offset);
+	if (InputFileCursor.currentLine != NULL &&InputFileCursor.currentLine >= base + offset)
+		return (int) *(InputFileCursor.currentLine - offset);
 	else
 		return def;
 }
 
+extern int skipToCharactersInInputFile (const char *stops)
+{
+	int d;
+	do
+	{
+		/* Skip the characters of the current line up to one of STOPS in bulk. */
+		const unsigned char *line = peekCharsInInputFile ();
+		if (line)
+			skipCharsInInputFile (strcspn ((const char *) line, stops));
+		d = getcFromInputFile ();
+	} while (d != EOF && (d == '\0' || strchr (stops, d) == NULL));
+	return d;
+}
+
 extern int skipToCharacterInInputFile (int c)
 {
 	int d;
+
+	if (0 < c && c <= UCHAR_MAX)
+	{
+		const char stops[] = { (char) c, '\0' };
+		return skipToCharactersInInputFile (stops);
+	}
+
 	do
 	{
 		d = getcFromInputFile ();
@@ -1054,6 +1609,48 @@ extern const unsigned char *readLineFromInputFile (void)
 	return result;
 }
 
+/* Consumes the LINE of SIZE bytes, ending with a newline, peeked from the
+ * memory stream, as iFileGetLine () would without copying it. */
+static void iFileSkipLineInPlace (const unsigned char *line, size_t size)
+{
+	fileNewline (size > 1 && line [size - 2] == '\r');
+	mio_seek (Context->file.mio, (long) size, SEEK_CUR);
+	mio_getpos (Context->file.mio, &Context->startOfLine.pos);
+	Context->startOfLine.offset = mio_tell (Context->file.mio);
+}
+
+static bool hasLinePrefix (const unsigned char *line, const char *const *prefixes)
+{
+	for (; *prefixes; prefixes++)
+		if (strncmp ((const char *) line, *prefixes, strlen (*prefixes)) == 0)
+			return true;
+	return false;
+}
+
+extern const unsigned char *readLineFromInputFileWithPrefix (const char *const *prefixes)
+{
+	const unsigned char *line;
+
+	/* A line can be skipped without being read if nothing else looks
+	 * at it on the way. */
+	if (Context->file.allLines == NULL
+		&& !Option.lineDirectives
+		&& !hasLanguageLineRegexPatterns (getInputLanguage ()))
+	{
+		size_t size;
+
+		while (isNextLineReadable ()
+			   && (line = mio_memory_peek_line (Context->file.mio, &size)) != NULL
+			   && !hasLinePrefix (line, prefixes))
+			iFileSkipLineInPlace (line, size);
+	}
+
+	while ((line = readLineFromInputFile ()) != NULL
+		   && !hasLinePrefix (line, prefixes))
+		;
+	return line;
+}
+
 /*
  *   Raw file line reading with automatic buffer sizing
  */
@@ -1082,19 +1679,54 @@ extern char *readLineFromBypass (
 	MIOPos orignalPosition;
 	char *result;
 
-	mio_getpos (File.mio, &orignalPosition);
-	mio_setpos (File.mio, &location);
-	mio_clearerr (File.mio);
+	mio_getpos (Context->file.mio, &orignalPosition);
+	mio_setpos (Context->file.mio, &location);
+	mio_clearerr (Context->file.mio);
 	if (pSeekValue != NULL)
-		*pSeekValue = mio_tell (File.mio);
-	result = readLineRaw (vLine, File.mio);
-	mio_setpos (File.mio, &orignalPosition);
+		*pSeekValue = mio_tell (Context->file.mio);
+	result = readLineRaw (vLine, Context->file.mio);
+	mio_setpos (Context->file.mio, &orignalPosition);
 	/* If the file is empty, we can't get the line
 	   for location 0. readLineFromBypass doesn't know
 	   what itself should do; just report it to the caller. */
 	return result;
 }
 
+extern bool scanInputFileLines (vString *const vLine, unsigned int maxLines,
+								bool (* fn) (const vString *const, void *),
+								void *data)
+{
+	MIOPos originalPosition;
+	bool r = true;
+
+	mio_getpos (Context->file.mio, &originalPosition);
+	mio_rewind (Context->file.mio);
+	for (unsigned int i = 0; r && i < maxLines; i++)
+	{
+		if (readLineRaw (vLine, Context->file.mio) == NULL)
+			break;
+		r = fn (vLine, data);
+	}
+	mio_setpos (Context->file.mio, &originalPosition);
+	mio_clearerr (Context->file.mio);
+	return r;
+}
+
+/* Returns the byte offset of LOCATION in the input file without reading
+ * anything; -1 if it is unknown. */
+extern long getInputFileOffsetForPosition (MIOPos location)
+{
+	MIOPos orignalPosition;
+	long offset;
+
+	mio_getpos (Context->file.mio, &orignalPosition);
+	if (mio_setpos (Context->file.mio, &location) != 0)
+		return -1;
+	offset = mio_tell (Context->file.mio);
+	mio_setpos (Context->file.mio, &orignalPosition);
+	return offset + Context->file.nestedInputStreamInfo.startOffset;
+}
+
 extern void   pushNarrowedInputStream (
 				       bool useMemoryStreamInput,
 				       unsigned long startLine, long startCharOffset,
@@ -1112,75 +1744,90 @@ extern void   pushNarrowedInputStream (
 						  sourceLineOffset))
 	{
 		if ((!useMemoryStreamInput
-			 || mio_memory_get_data (File.mio, NULL)))
+			 || mio_memory_get_data (Context->file.mio, NULL)))
 		{
-			File.thinDepth++;
-			verbose ("push thin stream (%d)\n", File.thinDepth);
+			Context->file.thinDepth++;
+			verbose ("push thin stream (%d)\n", Context->file.thinDepth);
 			return;
 		}
 		error(WARNING, "INTERNAL ERROR: though pushing thin MEMORY stream, "
 			  "underlying input stream is a FILE stream: %s@%s",
-			  vStringValue (File.input.name), vStringValue (File.input.tagPath));
+			  vStringValue (Context->file.input.name), Context->file.input.tagPath);
 		AssertNotReached ();
 	}
-	Assert (File.thinDepth == 0);
+	Assert (Context->file.thinDepth == 0);
 
 	original = getInputFilePosition ();
 
 	tmp = getInputFilePositionForLine (startLine);
-	mio_setpos (File.mio, &tmp);
-	mio_seek (File.mio, startCharOffset, SEEK_CUR);
-	p = mio_tell (File.mio);
+	mio_setpos (Context->file.mio, &tmp);
+	mio_seek (Context->file.mio, startCharOffset, SEEK_CUR);
+	p = mio_tell (Context->file.mio);
 
 	tmp = getInputFilePositionForLine (endLine);
-	mio_setpos (File.mio, &tmp);
+	mio_setpos (Context->file.mio, &tmp);
 	if (endCharOffset == EOL_CHAR_OFFSET)
 	{
-		long line_start = mio_tell (File.mio);
+		long line_start = mio_tell (Context->file.mio);
 		vString *tmpstr = vStringNew ();
-		readLine (tmpstr, File.mio);
-		endCharOffset = mio_tell (File.mio) - line_start;
+		readLine (tmpstr, Context->file.mio);
+		endCharOffset = mio_tell (Context->file.mio) - line_start;
 		vStringDelete (tmpstr);
 		Assert (endCharOffset >= 0);
 	}
 	else
-		mio_seek (File.mio, endCharOffset, SEEK_CUR);
-	q = mio_tell (File.mio);
+		mio_seek (Context->file.mio, endCharOffset, SEEK_CUR);
+	q = mio_tell (Context->file.mio);
 
-	mio_setpos (File.mio, &original);
+	mio_setpos (Context->file.mio, &original);
 
 	invalidatePatternCache();
 
 	size_t size = q - p;
-	subio = mio_new_mio (File.mio, p, size);
-	if (subio == NULL)
-		error (FATAL, "memory for mio may be exhausted");
-
-	runModifiers (promise,
-				  startLine, startCharOffset,
-				  endLine, endCharOffset,
-				  mio_memory_get_data (subio, NULL),
-				  size);
+	unsigned char *data = mio_memory_get_data (Context->file.mio, NULL);
+	if (data && ! doesPromiseModifyInput (promise, startLine, endLine))
+	{
+		/* The region is read from the memory of the input stream
+		 * without copying. The input stream lives in backupFile until
+		 * popNarrowedInputStream () is called. */
+		subio = mio_new_memory (data + p, size, NULL, NULL);
+		if (subio == NULL)
+			error (FATAL, "memory for mio may be exhausted");
+	}
+	else
+	{
+		subio = mio_new_mio (Context->file.mio, p, size);
+		if (subio == NULL)
+			error (FATAL, "memory for mio may be exhausted");
+
+		runModifiers (promise,
+					  startLine, startCharOffset,
+					  endLine, endCharOffset,
+					  mio_memory_get_data (subio, NULL),
+					  size);
+	}
 
-	BackupFile = File;
+	Context->file.cursor = InputFileCursor;
+	Context->backupFile = Context->file;
 
-	File.mio = subio;
-	File.bomFound = false;
-	File.nestedInputStreamInfo.startLine = startLine;
-	File.nestedInputStreamInfo.startCharOffset = startCharOffset;
-	File.nestedInputStreamInfo.endLine = endLine;
-	File.nestedInputStreamInfo.endCharOffset = endCharOffset;
+	Context->file.mio = subio;
+	Context->file.bomFound = false;
+	Context->file.nestedInputStreamInfo.startLine = startLine;
+	Context->file.nestedInputStreamInfo.startCharOffset = startCharOffset;
+	Context->file.nestedInputStreamInfo.endLine = endLine;
+	Context->file.nestedInputStreamInfo.endCharOffset = endCharOffset;
+	Context->file.nestedInputStreamInfo.startOffset = p;
 
-	File.input.lineNumberOrigin = ((startLine == 0)? 0: startLine - 1);
-	File.source.lineNumberOrigin = ((sourceLineOffset == 0)? 0: sourceLineOffset - 1);
+	Context->file.input.lineNumberOrigin = ((startLine == 0)? 0: startLine - 1);
+	Context->file.source.lineNumberOrigin = ((sourceLineOffset == 0)? 0: sourceLineOffset - 1);
 }
 
 extern bool doesParserRunAsGuest (void)
 {
-	return !(File.nestedInputStreamInfo.startLine == 0
-			 && File.nestedInputStreamInfo.startCharOffset == 0
-			 && File.nestedInputStreamInfo.endLine == 0
-			 && File.nestedInputStreamInfo.endCharOffset == 0);
+	return !(Context->file.nestedInputStreamInfo.startLine == 0
+			 &&Context->file.nestedInputStreamInfo.startCharOffset == 0
+			 &&Context->file.nestedInputStreamInfo.endLine == 0
+			 &&Context->file.nestedInputStreamInfo.endCharOffset == 0);
 }
 
 extern unsigned int getNestedInputBoundaryInfo (unsigned long lineNumber)
@@ -1192,41 +1839,42 @@ extern unsigned int getNestedInputBoundaryInfo (unsigned long lineNumber)
 		return 0;
 
 	info = 0;
-	if (File.nestedInputStreamInfo.startLine == lineNumber
-	    && File.nestedInputStreamInfo.startCharOffset != 0)
+	if (Context->file.nestedInputStreamInfo.startLine == lineNumber
+	    &&Context->file.nestedInputStreamInfo.startCharOffset != 0)
 		info |= BOUNDARY_START;
-	if (File.nestedInputStreamInfo.endLine == lineNumber
-	    && File.nestedInputStreamInfo.endCharOffset != 0)
+	if (Context->file.nestedInputStreamInfo.endLine == lineNumber
+	    &&Context->file.nestedInputStreamInfo.endCharOffset != 0)
 		info |= BOUNDARY_END;
 
 	return info;
 }
 extern void   popNarrowedInputStream  (void)
 {
-	if (File.thinDepth)
+	if (Context->file.thinDepth)
 	{
-		File.thinDepth--;
-		verbose ("CLEARING thin flag(%d)\n", File.thinDepth);
+		Context->file.thinDepth--;
+		verbose ("CLEARING thin flag(%d)\n", Context->file.thinDepth);
 		return;
 	}
-	mio_unref (File.mio);
-	File = BackupFile;
-	memset (&BackupFile, 0, sizeof (BackupFile));
+	mio_unref (Context->file.mio);
+	Context->file = Context->backupFile;
+	InputFileCursor = Context->file.cursor;
+	memset (&Context->backupFile, 0, sizeof (Context->backupFile));
 }
 
 extern void pushLanguage (const langType language)
 {
-	pushLangOnStack (& inputLang, language);
+	pushLangOnStack (&Context->inputLang, language);
 }
 
 extern langType popLanguage (void)
 {
-	return popLangOnStack (& inputLang);
+	return popLangOnStack (&Context->inputLang);
 }
 
 extern langType getLanguageForBaseParser (void)
 {
-	return baseLangOnStack (& inputLang);
+	return baseLangOnStack (&Context->inputLang);
 }
 
 static void langStackInit (langStack *langStack)
@@ -1234,7 +1882,6 @@ static void langStackInit (langStack *langStack)
 	langStack->count = 0;
 	langStack->size  = 1;
 	langStack->languages = xCalloc (langStack->size, langType);
-	DEFAULT_TRASH_BOX(&(langStack->languages), eFreeIndirect);
 }
 
 static langType langStackTop (langStack *langStack)
@@ -1284,7 +1931,7 @@ extern bool isThinStreamSpec(unsigned long startLine, long startCharOffset,
 #ifdef DO_TRACING
 extern bool isTraced (void)
 {
-	if (File.mio == NULL)
+	if (Context->file.mio == NULL)
 		/* A parser is not given. In that case, just check whether --_trace option
 		   is given or not. */
 		return isMainTraced ();
@@ -20,6 +20,7 @@
 #include "types.h"
 #include "vstring.h"
 #include "mio.h"
+#include "inline.h"
 
 /*
 *   MACROS
@@ -48,6 +49,16 @@ enum eCharacters {
 	CHAR_SYMBOL   = ('C' + 0xff)
 };
 
+/* The part of the input state read for each character; it lives here
+ * for getcFromInputFile () to be inlined. Parsers must not touch it. */
+typedef struct sInputFileCursor {
+	const unsigned char* currentLine;  /* current line being worked on */
+	unsigned int ungetchIdx;
+	int         ungetchBuf[8]; /* characters that were ungotten */
+} inputFileCursor;
+
+extern inputFileCursor InputFileCursor;
+
 
 /*
 *   FUNCTION PROTOTYPES
@@ -66,20 +77,71 @@ extern bool isInputHeaderFile (void);
 extern bool isInputLanguageKindEnabled (int kindIndex);
 extern bool isInputLanguageRoleEnabled (int kindIndex, int roleIndex);
 
+/* Returns the contents of the input file when it is read through a memory
+ * stream, or NULL. Only the parsers requiring a memory stream (see
+ * useMemoryStreamInput) can count on them: a file larger than 1 MiB, or
+ * any file in a build with --enable-debugging, is read through a file
+ * stream unless --map-input is given. */
 extern const unsigned char *getInputFileData (size_t *size);
 
-extern int getcFromInputFile (void);
+extern int getcFromInputFileFull (void);
 extern int getNthPrevCFromInputFile (unsigned int nth, int def);
+extern int peekNthCFromInputFile (unsigned int nth, int def);
+/* Reads STR if the input continues with it, and returns true; otherwise
+ * reads nothing. Unless STR is found in the current line, its characters
+ * are read and put back one by one: STR must fit in the ungetc buffer
+ * (8 characters) then. */
+extern bool matchStringInInputFile (const char *str);
+/* Skips to one of the characters of STOPS and returns it; the lines are
+ * scanned in bulk. */
+extern int skipToCharactersInInputFile (const char *stops);
 extern int skipToCharacterInInputFile (int c);
 extern int skipToCharacterInInputFile2 (int c0, int c1);
 extern void ungetcToInputFile (int c);
+
+/* Scanning the current line in bulk: peekCharsInInputFile () returns the
+ * characters of the current line not read with getcFromInputFile () yet,
+ * terminated with '\0'. It returns NULL when the next character must be
+ * taken with getcFromInputFile (), at the start of a line or after
+ * ungetcToInputFile (). skipCharsInInputFile () consumes COUNT characters
+ * of the string returned. */
+extern const unsigned char *peekCharsInInputFile (void);
+extern void skipCharsInInputFile (size_t count);
 extern const unsigned char *readLineFromInputFile (void);
 
+/* Takes the next character of the current line in place; at the end of
+ * the line or with ungotten characters, getcFromInputFileFull () does
+ * the rest of the work. DEBUG builds always take the full path to trace
+ * each character. */
+CTAGS_INLINE int getcFromInputFile (void)
+{
+#ifndef DEBUG
+	if (InputFileCursor.ungetchIdx == 0
+		&& InputFileCursor.currentLine != NULL
+		&& *InputFileCursor.currentLine != '\0')
+		return *InputFileCursor.currentLine++;
+#endif
+	return getcFromInputFileFull ();
+}
+
+/* Skips the lines starting with none of PREFIXES, a NULL terminated
+ * array, and returns the next line as readLineFromInputFile () does.
+ * When the input is in memory, the lines skipped are not copied. */
+extern const unsigned char *readLineFromInputFileWithPrefix (const char *const *prefixes);
+
 extern unsigned long getSourceLineNumber (void);
 
 /* Raw: reading from given a parameter, mio */
 extern char *readLineRaw (vString *const vLine, MIO *const mio);
 
+/* Reads the lines of the current input file from its start into VLINE
+ * as readLineRaw () does, and passes each of them to FN with DATA, until
+ * FN returns false or MAXLINES lines are read. The reading position of
+ * the input file is not moved. Returns false if FN returned false. */
+extern bool scanInputFileLines (vString *const vLine, unsigned int maxLines,
+								bool (* fn) (const vString *const, void *),
+								void *data);
+
 extern void     pushLanguage(const langType language);
 extern langType popLanguage (void);
 
@@ -22,6 +22,9 @@
 *   DATA DECLARATIONS
 */
 
+/* State of reading input; see setInputContext(). */
+typedef struct sInputContext inputContext;
+
 enum nestedInputBoundaryFlag {
 	BOUNDARY_START = 1UL << 0,
 	BOUNDARY_END   = 1UL << 1,
@@ -33,6 +36,8 @@ enum nestedInputBoundaryFlag {
 
 extern const char *getInputLanguageName (void);
 extern const char *getInputFileTagPath (void);
+/* The path of fileName written to the input field of tag entries. */
+extern const char *getTagPath (const char *const fileName);
 
 extern long getInputFileOffsetForLine (unsigned int line);
 
@@ -45,9 +50,17 @@ extern bool doesParserRunAsGuest (void);
 extern bool doesSubparserRun (void);
 extern langType getLanguageForBaseParser (void);
 
+/* Unlike getInputLanguage (), this can be called when no input file is open.
+ * It returns LANG_IGNORE then. */
+extern langType getInputLanguageIfAny (void);
+
 extern bool isParserMarkedNoEmission (void);
 extern void freeInputFileResources (void);
 
+extern inputContext *inputContextNew (void);
+extern void inputContextDelete (inputContext *ctx);
+extern inputContext *setInputContext (inputContext *ctx);
+
 /* Stream opened by getMio can be passed to openInputFile as the 3rd
    argument. If the 3rd argument is NULL, openInputFile calls getMio
    internally. The 3rd argument is introduced for reusing mio object
@@ -55,7 +68,42 @@ extern void freeInputFileResources (void);
 extern bool openInputFile (const char *const fileName, const langType language, MIO *mio, time_t mtime);
 extern MIO *getMio (const char *const fileName, const char *const openMode,
 				    bool memStreamRequired);
+/* Same as getMio but the modification time of the file is stored to MTIME
+   if it is not NULL. */
+extern MIO *getMioFull (const char *const fileName, const char *const openMode,
+						bool memStreamRequired, time_t *mtime);
+/* How much input is read between the releases of the data behind. */
+#define INPUT_RELEASE_STEP (16 * 1024 * 1024)
+
+/* Tells that the data of the input file before END, a pointer in the
+   data returned by getInputFileData (), is not read soon. The pages of a
+   mapped input file are dropped from the memory then if the patterns of
+   the language look at the input through windows only. */
+extern void releaseInputFileData (const char *end);
+/* Reads up to SIZE bytes of the input file at OFFSET into BUF, without
+   moving the reading position, for a stream with no data in memory.
+   Returns the number of the bytes read. */
+extern size_t readInputFileBytes (long offset, void *buf, size_t size);
 extern void resetInputFile (const langType language);
+/* Returns the number of the current line if the last character read is
+ * the newline of the line, or 0. */
+extern unsigned long getInputLineNumberAtNewline (void);
+/* Reads the lines until the end of line LINENUMBER, as if they were read
+ * with getcFromInputFile (). */
+extern void skipInputFileLines (unsigned long lineNumber);
+/* Makes the input end after line LINENUMBER, or at the end of the input
+ * file if LINENUMBER is 0, until the input file is closed. */
+extern void setInputFileLastLine (unsigned long lineNumber);
+/* Makes the input files end at the next line read once MSEC milliseconds
+ * of processor time pass, or removes the deadline if MSEC is 0. A parser
+ * meeting the deadline stops as it does at the end of an input file.
+ * isInputCancelled () tells whether the deadline has passed. */
+extern void setInputDeadline (unsigned long msec);
+extern bool isInputCancelled (void);
+/* Works like setInputDeadline (), but for the time budget of an input
+ * file: the tags made before the limit are kept. */
+extern void setInputTimeLimit (unsigned long msec);
+extern bool isInputTimeLimitReached (void);
 extern void closeInputFile (void);
 extern void *getInputFileUserData(void);
 
@@ -68,6 +116,7 @@ extern time_t getInputFileMtime (void);
 
 /* Bypass: reading from fp in inputFile WITHOUT updating fields in input fields */
 extern char *readLineFromBypass (vString *const vLine, MIOPos location, long *const pSeekValue);
+extern long getInputFileOffsetForPosition (MIOPos location);
 extern void   pushNarrowedInputStream (
 				       bool useMemoryStreamInput,
 				       unsigned long startLine, long startCharOffset,
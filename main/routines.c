@@ -15,6 +15,7 @@
 #include <stdlib.h>  /* to declare malloc (), realloc (), mbcs() */
 #include <ctype.h>
 #include <string.h>
+#include <stdint.h>
 #include <stdio.h>  /* to declare tempnam(), and SEEK_SET (hopefully) */
 
 #ifdef HAVE_FCNTL_H
@@ -52,6 +53,20 @@
 #ifdef HAVE_IO_H
 # include <io.h>  /* to declare open() */
 #endif
+#ifdef HAVE_MALLOC_USABLE_SIZE
+# include <malloc.h>  /* to declare malloc_usable_size () */
+#endif
+#if defined (HAVE_SENDFILE) && defined (HAVE_SYS_SENDFILE_H)
+# include <sys/sendfile.h>  /* to declare sendfile () */
+# define USE_SENDFILE
+#endif
+#ifdef WIN32
+# ifndef WIN32_LEAN_AND_MEAN
+#  define WIN32_LEAN_AND_MEAN
+# endif
+# include <windows.h>  /* to read files ahead in threads */
+#endif
+
 #include "debug.h"
 #include "routines.h"
 #include "routines_p.h"
@@ -154,6 +169,35 @@ char *CurrentDirectory;
 static const char *ExecutableProgram;
 static const char *ExecutableName;
 
+static memoryAccountingHook MemoryAccountingHook;
+
+#if defined (HAVE_STAT_ST_INO)
+/*  The directories being read in recursion, and the ancestors of the
+ *  outermost one. isRecursiveLink () looks up them for the directory a
+ *  symbolic link points to instead of stat'ing the parent paths of each
+ *  link.
+ */
+typedef struct sRecursionDirectory {
+	const char *name;
+	int fd;			/* -1 if unknown */
+	bool known;		/* dev and ino are valid */
+	unsigned long long dev;
+	unsigned long long ino;
+} recursionDirectory;
+
+static recursionDirectory *RecursionDirectories;
+static unsigned int RecursionDirectoryCount;
+static unsigned int RecursionDirectorySize;
+
+static struct {
+	bool known;
+	unsigned int count;
+	unsigned int size;
+	unsigned long long *devs;
+	unsigned long long *inos;
+} RecursionRootAncestors;
+#endif
+
 /*
 *   FUNCTION PROTOTYPES
 */
@@ -181,6 +225,15 @@ extern void freeRoutineResources (void)
 {
 	if (CurrentDirectory != NULL)
 		eFree (CurrentDirectory);
+#if defined (HAVE_STAT_ST_INO)
+	if (RecursionDirectories != NULL)
+		eFree (RecursionDirectories);
+	if (RecursionRootAncestors.devs != NULL)
+	{
+		eFree (RecursionRootAncestors.devs);
+		eFree (RecursionRootAncestors.inos);
+	}
+#endif
 }
 
 extern void setExecutableName (const char *const path)
@@ -215,6 +268,22 @@ static bool fnmChEq (int c1, int c2)
  *  Memory allocation functions
  */
 
+#ifdef HAVE_MALLOC_USABLE_SIZE
+# define blockSize(ptr) malloc_usable_size (ptr)
+#else
+# define blockSize(ptr) ((size_t) 0)
+#endif
+
+extern bool setMemoryAccountingHook (memoryAccountingHook hook)
+{
+#ifdef HAVE_MALLOC_USABLE_SIZE
+	MemoryAccountingHook = hook;
+	return true;
+#else
+	return (hook == NULL);
+#endif
+}
+
 extern void *eMalloc (const size_t size)
 {
 	void *buffer = malloc (size);
@@ -222,6 +291,8 @@ extern void *eMalloc (const size_t size)
 	if (buffer == NULL && size != 0)
 		error (FATAL, "out of memory");
 
+	if (MemoryAccountingHook && buffer)
+		MemoryAccountingHook (blockSize (buffer), 0);
 	return buffer;
 }
 
@@ -232,6 +303,8 @@ extern void *eCalloc (const size_t count, const size_t size)
 	if (buffer == NULL && count != 0 && size != 0)
 		error (FATAL, "out of memory");
 
+	if (MemoryAccountingHook && buffer)
+		MemoryAccountingHook (blockSize (buffer), 0);
 	return buffer;
 }
 
@@ -242,9 +315,13 @@ extern void *eRealloc (void *const ptr, const size_t size)
 		buffer = eMalloc (size);
 	else
 	{
+		const size_t oldSize = MemoryAccountingHook? blockSize (ptr): 0;
+
 		buffer = realloc (ptr, size);
 		if (buffer == NULL && size != 0)
 			error (FATAL, "out of memory");
+		if (MemoryAccountingHook)
+			MemoryAccountingHook (buffer? blockSize (buffer): 0, oldSize);
 	}
 	return buffer;
 }
@@ -252,11 +329,15 @@ extern void *eRealloc (void *const ptr, const size_t size)
 extern void eFree (void *const ptr)
 {
 	Assert (ptr != NULL);
+	if (MemoryAccountingHook)
+		MemoryAccountingHook (0, blockSize (ptr));
 	free (ptr);
 }
 
 extern void eFreeNoNullCheck (void *const ptr)
 {
+	if (MemoryAccountingHook && ptr)
+		MemoryAccountingHook (0, blockSize (ptr));
 	free (ptr);
 }
 
@@ -418,6 +499,51 @@ extern bool strToInt(const char *const str, int base, int *value)
 	return true;
 }
 
+/* FNV-1a */
+extern unsigned long long hashBytes (unsigned long long h, const void *p, size_t len)
+{
+	const unsigned char *b = p;
+
+	for (size_t i = 0; i < len; i++)
+	{
+		h ^= b [i];
+		h *= 1099511628211ULL;
+	}
+	return h;
+}
+
+#define BYTES_OF(c) (0x0101010101010101ULL * (c))
+#define HAS_ZERO_BYTE(x) (((x) - BYTES_OF (0x01)) & ~(x) & BYTES_OF (0x80))
+#define HAS_BYTE_LESS(x,n) (((x) - BYTES_OF (n)) & ~(x) & BYTES_OF (0x80))
+
+static bool isPlainByte (unsigned char c)
+{
+	return (0x20 <= c && c < 0x7f && c != '"' && c != '\\');
+}
+
+/* Eight bytes are tested at once; most of the fields have no byte
+ * to escape at all. */
+extern size_t countPlainBytes (const char *s, size_t length)
+{
+	size_t n = 0;
+
+	for (; n + sizeof (uint64_t) <= length; n += sizeof (uint64_t))
+	{
+		uint64_t x;
+
+		memcpy (&x, s + n, sizeof (x));
+		if (HAS_BYTE_LESS (x, 0x20)
+			|| HAS_ZERO_BYTE (x ^ BYTES_OF ('"'))
+			|| HAS_ZERO_BYTE (x ^ BYTES_OF ('\\'))
+			|| HAS_ZERO_BYTE (x ^ BYTES_OF (0x7f))
+			|| (x & BYTES_OF (0x80)))
+			break;
+	}
+	while (n < length && isPlainByte ((unsigned char) s [n]))
+		n++;
+	return n;
+}
+
 /*
  * File system functions
  */
@@ -439,36 +565,86 @@ extern void setCurrentDirectory (void) /* TODO */
 }
 
 /* For caching of stat() calls */
+static fileStatus StatCache;
+
+static void fillFileStatus (fileStatus *const file, const struct stat *const status)
+{
+	file->exists = true;
+	file->isDirectory = (bool) S_ISDIR (status->st_mode);
+	file->isNormalFile = (bool) (S_ISREG (status->st_mode));
+	file->isExecutable = (bool) ((status->st_mode &
+		(S_IXUSR | S_IXGRP | S_IXOTH)) != 0);
+	file->isSetuid = (bool) ((status->st_mode & S_ISUID) != 0);
+	file->isSetgid = (bool) ((status->st_mode & S_ISGID) != 0);
+	file->size = status->st_size;
+	file->mtime = status->st_mtime;
+#if defined (HAVE_STAT_ST_INO)
+	file->dev = (unsigned long long) status->st_dev;
+	file->ino = (unsigned long long) status->st_ino;
+#endif
+}
+
 extern fileStatus *eStat (const char *const fileName)
 {
 	struct stat status;
-	static fileStatus file;
-	if (file.name == NULL  ||  strcmp (fileName, file.name) != 0)
+	fileStatus *const file = &StatCache;
+	if (file->name == NULL  ||  strcmp (fileName, file->name) != 0)
 	{
-		eStatFree (&file);
-		file.name = eStrdup (fileName);
-		if (lstat (file.name, &status) != 0)
-			file.exists = false;
+		eStatFree (file);
+		file->name = eStrdup (fileName);
+		if (lstat (file->name, &status) != 0)
+			file->exists = false;
 		else
 		{
-			file.isSymbolicLink = (bool) S_ISLNK (status.st_mode);
-			if (file.isSymbolicLink  &&  stat (file.name, &status) != 0)
-				file.exists = false;
+			file->isSymbolicLink = (bool) S_ISLNK (status.st_mode);
+			if (file->isSymbolicLink  &&  stat (file->name, &status) != 0)
+				file->exists = false;
 			else
-			{
-				file.exists = true;
-				file.isDirectory = (bool) S_ISDIR (status.st_mode);
-				file.isNormalFile = (bool) (S_ISREG (status.st_mode));
-				file.isExecutable = (bool) ((status.st_mode &
-					(S_IXUSR | S_IXGRP | S_IXOTH)) != 0);
-				file.isSetuid = (bool) ((status.st_mode & S_ISUID) != 0);
-				file.isSetgid = (bool) ((status.st_mode & S_ISGID) != 0);
-				file.size = status.st_size;
-				file.mtime = status.st_mtime;
-			}
+				fillFileStatus (file, &status);
 		}
 	}
-	return &file;
+	return file;
+}
+
+/*  Same as eStat () but NAME is looked up relative to the directory
+ *  opened as DIRFD. FILENAME is the path used as the key of the cache.
+ *  If ISDIRECTORY is true, the caller knows the entry is a directory
+ *  that is not a symbolic link (e.g. from d_type of readdir(3)), and
+ *  no system call is made; the size and the modification time are not
+ *  filled then.
+ */
+extern fileStatus *eStatAt (int dirfd, const char *const name,
+							const char *const fileName, bool isDirectory)
+{
+#if defined (HAVE_FSTATAT) && defined (AT_SYMLINK_NOFOLLOW)
+	struct stat status;
+	fileStatus *const file = &StatCache;
+	if (file->name != NULL  &&  strcmp (fileName, file->name) == 0)
+		return file;
+
+	eStatFree (file);
+	file->name = eStrdup (fileName);
+	file->isSymbolicLink = false;
+	if (isDirectory)
+	{
+		memset (&status, 0, sizeof (status));
+		status.st_mode = S_IFDIR;
+		fillFileStatus (file, &status);
+	}
+	else if (fstatat (dirfd, name, &status, AT_SYMLINK_NOFOLLOW) != 0)
+		file->exists = false;
+	else
+	{
+		file->isSymbolicLink = (bool) S_ISLNK (status.st_mode);
+		if (file->isSymbolicLink  &&  fstatat (dirfd, name, &status, 0) != 0)
+			file->exists = false;
+		else
+			fillFileStatus (file, &status);
+	}
+	return file;
+#else
+	return eStat (fileName);
+#endif
 }
 
 extern void eStatFree (fileStatus *status)
@@ -486,12 +662,280 @@ extern bool doesFileExist (const char *const fileName)
 	return status->exists;
 }
 
+#ifdef WIN32
+/*  Opening a file is slow on Windows, where the filters of the file
+ *  system, like virus scanners, look at it. A few threads open and read
+ *  the files to be parsed soon, so these costs are paid while the
+ *  current file is parsed. The names of the files wait for the threads
+ *  in a queue; a request is dropped when the queue is full.
+ */
+#define PREFETCH_THREADS 2
+#define PREFETCH_QUEUE_SIZE 16
+/* The bytes of a file read ahead at most */
+#define PREFETCH_READ_MAX (4 * 1024 * 1024)
+
+static struct {
+	bool started;
+	bool failed;
+	CRITICAL_SECTION lock;
+	HANDLE queued;				/* A semaphore counting the names queued */
+	char *queue [PREFETCH_QUEUE_SIZE];
+	unsigned int head;
+	unsigned int count;
+} Prefetcher;
+
+static void readFileAhead (const char *const fileName)
+{
+	char buffer [64 * 1024];
+	HANDLE h = CreateFileA (fileName, GENERIC_READ,
+							FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+							NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	DWORD n;
+	size_t total = 0;
+
+	if (h == INVALID_HANDLE_VALUE)
+		return;
+
+	/* Not for blocking on a pipe or a device */
+	if (GetFileType (h) == FILE_TYPE_DISK)
+	{
+		while (total < PREFETCH_READ_MAX
+			   && ReadFile (h, buffer, sizeof (buffer), &n, NULL) && n > 0)
+			total += n;
+	}
+	CloseHandle (h);
+}
+
+static DWORD WINAPI prefetchThread (LPVOID data CTAGS_ATTR_UNUSED)
+{
+	while (WaitForSingleObject (Prefetcher.queued, INFINITE) == WAIT_OBJECT_0)
+	{
+		char *fileName;
+
+		EnterCriticalSection (&Prefetcher.lock);
+		fileName = Prefetcher.queue [Prefetcher.head];
+		Prefetcher.head = (Prefetcher.head + 1) % PREFETCH_QUEUE_SIZE;
+		Prefetcher.count--;
+		LeaveCriticalSection (&Prefetcher.lock);
+
+		readFileAhead (fileName);
+		eFree (fileName);
+	}
+	return 0;
+}
+
+static bool startPrefetchThreads (void)
+{
+	unsigned int started = 0;
+
+	InitializeCriticalSection (&Prefetcher.lock);
+	Prefetcher.queued = CreateSemaphore (NULL, 0, PREFETCH_QUEUE_SIZE, NULL);
+	if (Prefetcher.queued == NULL)
+		return false;
+
+	/* The threads are never joined. They wait for the names until
+	 * the process exits. */
+	for (unsigned int i = 0; i < PREFETCH_THREADS; i++)
+	{
+		HANDLE thread = CreateThread (NULL, 0, prefetchThread, NULL, 0, NULL);
+
+		if (thread != NULL)
+		{
+			CloseHandle (thread);
+			started++;
+		}
+	}
+	return (started > 0);
+}
+
+static void queuePrefetch (const char *const fileName)
+{
+	char *name;
+
+	if (! Prefetcher.started)
+	{
+		Prefetcher.started = true;
+		Prefetcher.failed = ! startPrefetchThreads ();
+	}
+	if (Prefetcher.failed)
+		return;
+
+	name = eStrdup (fileName);
+	EnterCriticalSection (&Prefetcher.lock);
+	if (Prefetcher.count < PREFETCH_QUEUE_SIZE)
+	{
+		Prefetcher.queue [(Prefetcher.head + Prefetcher.count) % PREFETCH_QUEUE_SIZE] = name;
+		Prefetcher.count++;
+		name = NULL;
+	}
+	LeaveCriticalSection (&Prefetcher.lock);
+
+	if (name)
+		eFree (name);
+	else
+		ReleaseSemaphore (Prefetcher.queued, 1, NULL);
+}
+#endif
+
+/*  Tell the system that the contents of FILENAME will be read soon, so
+ *  that reading them from the disk starts before the file is opened for
+ *  parsing.
+ */
+extern void prefetchFile (const char *const fileName CTAGS_ATTR_UNUSED)
+{
+#if defined (WIN32)
+	queuePrefetch (fileName);
+#elif defined (HAVE_POSIX_FADVISE) && defined (POSIX_FADV_WILLNEED) && defined (O_NONBLOCK)
+	/* O_NONBLOCK for not blocking on a FIFO */
+	int fd = open (fileName, O_RDONLY | O_NONBLOCK);
+
+	if (fd >= 0)
+	{
+		posix_fadvise (fd, 0, 0, POSIX_FADV_WILLNEED);
+		close (fd);
+	}
+#endif
+}
+
 extern bool doesExecutableExist (const char *const fileName)
 {
 	fileStatus *status = eStat (fileName);
 	return status->exists && status->isExecutable;
 }
 
+#if defined (HAVE_STAT_ST_INO)
+extern void pushRecursionDirectory (const char *const dirName)
+{
+	recursionDirectory *d;
+
+	if (RecursionDirectoryCount == RecursionDirectorySize)
+	{
+		RecursionDirectorySize = RecursionDirectorySize? RecursionDirectorySize * 2: 16;
+		RecursionDirectories = xRealloc (RecursionDirectories,
+										 RecursionDirectorySize, recursionDirectory);
+	}
+	d = RecursionDirectories + RecursionDirectoryCount++;
+	d->name = dirName;
+	d->fd = -1;
+	d->known = false;
+}
+
+/*  Tell the directory pushed last is opened as FD. */
+extern void setRecursionDirectoryFd (int fd)
+{
+	Assert (RecursionDirectoryCount > 0);
+	RecursionDirectories [RecursionDirectoryCount - 1].fd = fd;
+}
+
+extern void popRecursionDirectory (void)
+{
+	Assert (RecursionDirectoryCount > 0);
+	if (--RecursionDirectoryCount == 0)
+		RecursionRootAncestors.known = false;
+}
+
+static bool getRecursionDirectoryId (recursionDirectory *const d)
+{
+	struct stat status;
+
+	if (! d->known)
+	{
+		if ((d->fd >= 0 ? fstat (d->fd, &status) : stat (d->name, &status)) != 0)
+			return false;
+		d->dev = (unsigned long long) status.st_dev;
+		d->ino = (unsigned long long) status.st_ino;
+		d->known = true;
+	}
+	return true;
+}
+
+static void addRecursionRootAncestor (const struct stat *const status)
+{
+	if (RecursionRootAncestors.count == RecursionRootAncestors.size)
+	{
+		RecursionRootAncestors.size = RecursionRootAncestors.size? RecursionRootAncestors.size * 2: 16;
+		RecursionRootAncestors.devs = xRealloc (RecursionRootAncestors.devs,
+												RecursionRootAncestors.size, unsigned long long);
+		RecursionRootAncestors.inos = xRealloc (RecursionRootAncestors.inos,
+												RecursionRootAncestors.size, unsigned long long);
+	}
+	RecursionRootAncestors.devs [RecursionRootAncestors.count] = (unsigned long long) status->st_dev;
+	RecursionRootAncestors.inos [RecursionRootAncestors.count] = (unsigned long long) status->st_ino;
+	RecursionRootAncestors.count++;
+}
+
+/*  Stat the parent paths of ROOT once. They are the ancestors of every
+ *  directory found in the recursion from ROOT.
+ */
+static void prepareRecursionRootAncestors (const char *const root)
+{
+	char *const path = absoluteFilename (root);
+
+	RecursionRootAncestors.count = 0;
+	while (isPathSeparator (path [strlen (path) - 1]))
+		path [strlen (path) - 1] = '\0';
+	while (strlen (path) > (size_t) 1)
+	{
+		struct stat status;
+		char *const separator = strRSeparator (path);
+		if (separator == NULL)
+			break;
+		else if (separator == path)  /* backed up to root directory */
+			*(separator + 1) = '\0';
+		else
+			*separator = '\0';
+		if (stat (path, &status) == 0)
+			addRecursionRootAncestor (&status);
+	}
+	eFree (path);
+	RecursionRootAncestors.known = true;
+}
+
+/*  Return true if DIRNAME is a symbolic link pointing to one of its
+ *  parent directories. DIRNAME must be the directory to be pushed next
+ *  with pushRecursionDirectory ().
+ */
+extern bool isRecursiveLink (const char* const dirName)
+{
+	fileStatus *status = eStat (dirName);
+	unsigned int i;
+
+	if (! status->isSymbolicLink || ! status->exists)
+		return false;
+
+	for (i = 0; i < RecursionDirectoryCount; i++)
+	{
+		recursionDirectory *const d = RecursionDirectories + i;
+		if (getRecursionDirectoryId (d)
+			&& d->dev == status->dev && d->ino == status->ino)
+			return true;
+	}
+
+	if (! RecursionRootAncestors.known)
+		prepareRecursionRootAncestors (RecursionDirectoryCount > 0
+									   ? RecursionDirectories [0].name
+									   : dirName);
+	for (i = 0; i < RecursionRootAncestors.count; i++)
+	{
+		if (RecursionRootAncestors.devs [i] == status->dev
+			&& RecursionRootAncestors.inos [i] == status->ino)
+			return true;
+	}
+	return false;
+}
+#else
+extern void pushRecursionDirectory (const char *const dirName CTAGS_ATTR_UNUSED)
+{
+}
+
+extern void setRecursionDirectoryFd (int fd CTAGS_ATTR_UNUSED)
+{
+}
+
+extern void popRecursionDirectory (void)
+{
+}
+
 extern bool isRecursiveLink (const char* const dirName)
 {
 	bool result = false;
@@ -517,6 +961,8 @@ extern bool isRecursiveLink (const char* const dirName)
 	return result;
 }
 
+#endif
+
 /*
  *  Pathname manipulation (O/S dependent!!!)
  */
@@ -947,3 +1393,104 @@ extern MIO *tempFile (const char *const mode, char **const pName)
 	FILE *fp = tempFileFP (mode, pName);
 	return mio_new_fp (fp, fclose);
 }
+
+/*  Let the kernel copy SIZE bytes from the current position of FROMFP to
+ *  TOFP, without passing them through user space. Both streams are left
+ *  positioned after the bytes copied. Returns the number of bytes copied,
+ *  which is fewer than SIZE when the system cannot copy between the two
+ *  files (i.e. a pipe as input, an output opened for appending, or files
+ *  on different file systems).
+ */
+static long copyFileBytesInKernel (FILE *const fromFp, FILE *const toFp,
+								   const long size)
+{
+	long copied = 0;
+#if defined (HAVE_COPY_FILE_RANGE) || defined (USE_SENDFILE)
+	const long start = ftell (fromFp);
+	const int fromFd = fileno (fromFp);
+	const int toFd = fileno (toFp);
+	off_t offset = (off_t) start;
+
+	if (start < 0 || fflush (toFp) != 0)
+		return 0;
+
+# ifdef HAVE_COPY_FILE_RANGE
+	/* Can share the extents on the file systems supporting reflinks. */
+	while (copied < size)
+	{
+		ssize_t n = copy_file_range (fromFd, &offset, toFd, NULL,
+									 (size_t) (size - copied), 0);
+		if (n <= 0)
+			break;
+		copied += n;
+	}
+# endif
+# ifdef USE_SENDFILE
+	while (copied < size)
+	{
+		ssize_t n = sendfile (toFd, fromFd, &offset, (size_t) (size - copied));
+		if (n <= 0)
+			break;
+		copied += n;
+	}
+# endif
+
+	if (copied > 0)
+	{
+		/* The file offset of TOFD moved behind the back of stdio.
+		 * A pipe has no offset to catch up with. */
+		const off_t end = lseek (toFd, 0, SEEK_CUR);
+		if (end != (off_t) -1 && fseek (toFp, (long) end, SEEK_SET) != 0)
+			error (FATAL | PERROR, "cannot seek in output file");
+	}
+	if (fseek (fromFp, start + copied, SEEK_SET) != 0)
+		error (FATAL | PERROR, "cannot seek in input file");
+#endif
+	return copied;
+}
+
+extern long copyMioBytes (MIO *const fromMio, MIO *const toMio, const long size)
+{
+	enum { BufferSize = 64 * 1024 };
+	FILE *const fromFp = mio_file_get_fp (fromMio);
+	FILE *const toFp = mio_file_get_fp (toMio);
+	long copied = 0;
+	size_t dataSize;
+	unsigned char *data = mio_memory_get_data (fromMio, &dataSize);
+	char *buffer;
+
+	if (data != NULL)
+	{
+		/* Write the bytes in place instead of copying them out first. */
+		const long start = mio_tell (fromMio);
+		long available = (long) dataSize - start;
+
+		if (available > size)
+			available = size;
+		if (available <= 0)
+			return 0;
+		if (mio_write (toMio, data + start, 1, (size_t) available) < (size_t) available)
+			error (FATAL | PERROR, "cannot complete write");
+		mio_seek (fromMio, available, SEEK_CUR);
+		return available;
+	}
+
+	if (fromFp != NULL && toFp != NULL)
+		copied = copyFileBytesInKernel (fromFp, toFp, size);
+
+	buffer = xMalloc (BufferSize, char);
+	while (copied < size)
+	{
+		const long toRead = (size - copied < BufferSize) ?
+			size - copied : (long) BufferSize;
+		const size_t numRead = mio_read (fromMio, buffer, 1, (size_t) toRead);
+
+		if (numRead == 0)
+			break;
+		if (mio_write (toMio, buffer, 1, numRead) < numRead)
+			error (FATAL | PERROR, "cannot complete write");
+		copied += (long) numRead;
+	}
+	eFree (buffer);
+	return copied;
+}
@@ -71,23 +71,51 @@ typedef struct {
 
 		/* The last modified time */
 	time_t mtime;
+
+		/* Device and inode number of file (pointed to) if the platform
+		 * has them */
+	unsigned long long dev;
+	unsigned long long ino;
 } fileStatus;
 
+/* Called with the size of a block when eMalloc () or one of its friends
+ * allocates it, frees it, or both in the case of eRealloc (). */
+typedef void (* memoryAccountingHook) (size_t allocated, size_t freed);
+
 /*
 *   FUNCTION PROTOTYPES
 */
 extern void freeRoutineResources (void);
 extern void setExecutableName (const char *const path);
 
+/* Returns false if the size of a block cannot be known on the platform. */
+extern bool setMemoryAccountingHook (memoryAccountingHook hook);
+
+/* Hashes LEN bytes at P, continuing from H, for telling whether the
+ * contents of files are the same. Start with HASH_BYTES_INIT. */
+#define HASH_BYTES_INIT 14695981039346656037ULL
+extern unsigned long long hashBytes (unsigned long long h, const void *p, size_t len);
+
+/* Returns the length of the run of printable ASCII characters other
+ * than '"' and '\\' at the head of LENGTH bytes at S. The writers copy
+ * such a run as is, and look at the byte after it one by one. */
+extern size_t countPlainBytes (const char *s, size_t length);
+
 /* File system functions */
 extern const char *getExecutableName (void);
 extern const char *getExecutablePath (void);
 extern void setCurrentDirectory (void);
 extern fileStatus *eStat (const char *const fileName);
+extern fileStatus *eStatAt (int dirfd, const char *const name,
+							const char *const fileName, bool isDirectory);
 extern void eStatFree (fileStatus *status);
 extern bool doesFileExist (const char *const fileName);
+extern void prefetchFile (const char *const fileName);
 extern bool doesExecutableExist (const char *const fileName);
 extern bool isRecursiveLink (const char* const dirName);
+extern void pushRecursionDirectory (const char *const dirName);
+extern void setRecursionDirectoryFd (int fd);
+extern void popRecursionDirectory (void);
 extern bool isSameFile (const char *const name1, const char *const name2);
 extern bool isAbsolutePath (const char *const path);
 extern char *combinePathAndFile (const char *const path, const char *const file);
@@ -95,6 +123,7 @@ extern char* absoluteFilename (const char *file);
 extern char* absoluteDirname (char *file);
 extern char* relativeFilename (const char *file, const char *dir);
 extern MIO *tempFile (const char *const mode, char **const pName);
+extern long copyMioBytes (MIO *const fromMio, MIO *const toMio, const long size);
 
 extern char* baseFilenameSansExtensionNew (const char *const fileName, const char *const templateExt);
 
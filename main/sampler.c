@@ -0,0 +1,299 @@
+/*
+*   Copyright (c) 2026, Universal Ctags Team
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License version 2 or (at your option) any later version.
+*
+*   This module implements --sampling-profile option: finding the regions
+*   of the input files where the parsers spend their time.
+*
+*   A SIGPROF timer interrupts the process for each SAMPLING_INTERVAL_USEC
+*   microseconds of the CPU time; the system may round it up to its clock
+*   tick. The handler records the language on the top of the
+*   language stack, the input file, and the line the parser is reading.
+*   At the end, the samples are counted for each region of REGION_LINES
+*   lines, and the hottest regions are printed for each parser.
+*
+*   The handler only stores the values noted by this process into a
+*   buffer allocated in advance; it never allocates memory or calls a
+*   function which is not async-signal-safe.
+*/
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"  /* must always come first */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef HAVE_SETITIMER
+# include <signal.h>
+# include <sys/time.h>
+#endif
+
+#include "debug.h"
+#include "options_p.h"
+#include "parse.h"
+#include "ptrarray.h"
+#include "read.h"
+#include "routines.h"
+#include "sampler_p.h"
+
+/*
+*   MACROS
+*/
+#define SAMPLING_INTERVAL_USEC 1000
+#define MAX_SAMPLES (1 << 18)
+#define REGION_LINES 10
+
+/*
+*   DATA DECLARATIONS
+*/
+typedef struct {
+	int language;
+	int file;
+	unsigned long line;
+} sample;
+
+typedef struct {
+	int language;
+	int file;
+	unsigned long region;
+	unsigned long count;
+} regionCount;
+
+/*
+*   DATA DEFINITIONS
+*/
+static struct {
+	bool started;
+	sample *samples;
+	volatile unsigned long count;
+	volatile unsigned long dropped;
+	/* Noted by the main part, read by the handler */
+	volatile int language;
+	volatile int file;
+	/* The names of the input files; the index of a name is the file
+	 * of the samples. */
+	ptrArray *fileNames;
+} Sampler = {
+	.language = LANG_IGNORE,
+	.file = -1,
+};
+
+/*
+*   FUNCTION DEFINITIONS
+*/
+
+#ifdef HAVE_SETITIMER
+static void takeSample (int signum CTAGS_ATTR_UNUSED)
+{
+	const unsigned long n = Sampler.count;
+
+	if (n >= MAX_SAMPLES)
+	{
+		Sampler.dropped++;
+		return;
+	}
+
+	Sampler.samples [n].language = Sampler.language;
+	Sampler.samples [n].file = Sampler.file;
+	Sampler.samples [n].line = (Sampler.file < 0)? 0: getInputLineNumber ();
+	Sampler.count = n + 1;
+}
+
+static void setSamplingTimer (long usec)
+{
+	struct itimerval timer;
+
+	timer.it_interval.tv_sec = 0;
+	timer.it_interval.tv_usec = usec;
+	timer.it_value = timer.it_interval;
+	setitimer (ITIMER_PROF, &timer, NULL);
+}
+#endif
+
+extern void startSampling (void)
+{
+	if (Option.samplingProfile == 0)
+		return;
+
+#ifdef HAVE_SETITIMER
+	struct sigaction act;
+
+	Assert (! Sampler.started);
+
+	Sampler.samples = xMalloc (MAX_SAMPLES, sample);
+	Sampler.fileNames = ptrArrayNew (eFree);
+	Sampler.count = 0;
+	Sampler.dropped = 0;
+
+	memset (&act, 0, sizeof (act));
+	act.sa_handler = takeSample;
+	sigemptyset (&act.sa_mask);
+	/* Don't break the reads of the input files. */
+	act.sa_flags = SA_RESTART;
+	if (sigaction (SIGPROF, &act, NULL) != 0)
+	{
+		error (WARNING | PERROR, "cannot set the handler of the sampling profiler");
+		eFree (Sampler.samples);
+		ptrArrayDelete (Sampler.fileNames);
+		return;
+	}
+
+	Sampler.started = true;
+	setSamplingTimer (SAMPLING_INTERVAL_USEC);
+#else
+	error (WARNING, "--sampling-profile is not supported on this platform");
+#endif
+}
+
+extern bool isSampling (void)
+{
+	return Sampler.started;
+}
+
+extern void switchSamplingLanguage (langType language)
+{
+	Sampler.language = language;
+}
+
+extern void beginSamplingFile (const char *const fileName)
+{
+	if (! Sampler.started)
+		return;
+
+	ptrArrayAdd (Sampler.fileNames, eStrdup (fileName));
+	Sampler.file = (int) ptrArrayCount (Sampler.fileNames) - 1;
+}
+
+extern void endSamplingFile (void)
+{
+	Sampler.file = -1;
+}
+
+static int compareSamples (const void *a, const void *b)
+{
+	const sample *sa = a;
+	const sample *sb = b;
+
+	if (sa->language != sb->language)
+		return (sa->language > sb->language) - (sa->language < sb->language);
+	if (sa->file != sb->file)
+		return (sa->file > sb->file) - (sa->file < sb->file);
+	return (sa->line > sb->line) - (sa->line < sb->line);
+}
+
+static int compareRegionCounts (const void *a, const void *b)
+{
+	const regionCount *ra = a;
+	const regionCount *rb = b;
+
+	/* The hottest first; in the order of the input for the same counts */
+	if (ra->count != rb->count)
+		return (ra->count < rb->count) - (ra->count > rb->count);
+	if (ra->file != rb->file)
+		return (ra->file > rb->file) - (ra->file < rb->file);
+	return (ra->region > rb->region) - (ra->region < rb->region);
+}
+
+static unsigned long regionOf (unsigned long line)
+{
+	return (line > 0)? (line - 1) / REGION_LINES: 0;
+}
+
+/* Prints the regions of a language in REGIONS, which is sorted
+ * destructively here. */
+static void printLanguageRegions (regionCount *regions, unsigned long count,
+								  unsigned long samples, unsigned long total)
+{
+	const langType language = regions [0].language;
+
+	qsort (regions, count, sizeof (regionCount), compareRegionCounts);
+
+	fprintf (stderr, "%s: %lu sample%s (%.1f%%)\n", getLanguageName (language),
+			 samples, samples == 1? "": "s", samples * 100.0 / total);
+	fprintf (stderr, "%10s %7s  %s\n", "samples", "%", "region");
+	for (unsigned long i = 0; i < count && i < Option.samplingProfile; i++)
+	{
+		const regionCount *r = regions + i;
+
+		fprintf (stderr, "%10lu %6.1f%%  %s:%lu-%lu\n", r->count,
+				 r->count * 100.0 / samples,
+				 (const char *) ptrArrayItem (Sampler.fileNames, r->file),
+				 r->region * REGION_LINES + 1, (r->region + 1) * REGION_LINES);
+	}
+}
+
+extern void printSamplingProfile (void)
+{
+	if (! Sampler.started)
+		return;
+
+#ifdef HAVE_SETITIMER
+	setSamplingTimer (0);
+	signal (SIGPROF, SIG_DFL);
+#endif
+	Sampler.started = false;
+
+	const unsigned long total = Sampler.count;
+	unsigned long outside = 0;
+	regionCount *regions = xMalloc (total + 1, regionCount);
+
+	qsort (Sampler.samples, total, sizeof (sample), compareSamples);
+
+	fputs ("\nSAMPLED PROFILE\n", stderr);
+	fputs ("==============================================\n", stderr);
+	fprintf (stderr, "%lu sample%s of the CPU time", total, total == 1? "": "s");
+	if (Sampler.dropped)
+		fprintf (stderr, ", %lu dropped", Sampler.dropped);
+	fputc ('\n', stderr);
+
+	for (unsigned long i = 0; i < total; )
+	{
+		const int language = Sampler.samples [i].language;
+		unsigned long samples = 0;
+		unsigned long count = 0;
+
+		/* Guessing languages, writing the tag file, and so on. The
+		 * samples out of the input files come first in a language. */
+		if (language == LANG_IGNORE || Sampler.samples [i].file < 0)
+		{
+			outside++;
+			i++;
+			continue;
+		}
+
+		for (; i < total && Sampler.samples [i].language == language; i++)
+		{
+			const sample *s = Sampler.samples + i;
+
+			if (count == 0
+				|| regions [count - 1].file != s->file
+				|| regions [count - 1].region != regionOf (s->line))
+			{
+				regions [count].language = language;
+				regions [count].file = s->file;
+				regions [count].region = regionOf (s->line);
+				regions [count].count = 0;
+				count++;
+			}
+			regions [count - 1].count++;
+			samples++;
+		}
+
+		fputc ('\n', stderr);
+		printLanguageRegions (regions, count, samples, total);
+	}
+	if (outside)
+		fprintf (stderr, "\nout of the parsers: %lu sample%s (%.1f%%)\n",
+				 outside, outside == 1? "": "s", outside * 100.0 / total);
+
+	eFree (regions);
+	eFree (Sampler.samples);
+	Sampler.samples = NULL;
+	ptrArrayDelete (Sampler.fileNames);
+	Sampler.fileNames = NULL;
+}
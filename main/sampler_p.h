@@ -0,0 +1,33 @@
+/*
+*   Copyright (c) 2026, Universal Ctags Team
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License version 2 or (at your option) any later version.
+*
+*   Main part private interface to sampler.c
+*/
+#ifndef CTAGS_MAIN_SAMPLER_PRIVATE_H
+#define CTAGS_MAIN_SAMPLER_PRIVATE_H
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"  /* must always come first */
+
+#include "types.h"
+
+/*
+*   FUNCTION PROTOTYPES
+*/
+
+/* --sampling-profile=<N> */
+extern void startSampling (void);
+extern bool isSampling (void);
+extern void printSamplingProfile (void);
+
+/* What the samples taken from now are attributed to */
+extern void switchSamplingLanguage (langType language);
+extern void beginSamplingFile (const char *const fileName);
+extern void endSamplingFile (void);
+
+#endif  /* CTAGS_MAIN_SAMPLER_PRIVATE_H */
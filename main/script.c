@@ -327,29 +327,9 @@ extern EsObject *optscriptRead (OptVM *vm, const char *src, size_t len)
 
 extern EsObject* optscriptEval (OptVM *vm, EsObject *code)
 {
-	static EsObject *exec = es_nil;
-
-	if (es_null (exec))
-	{
-		MIO *mio = mio_new_memory ((unsigned char*)"//exec", 6, NULL, NULL);
-		exec = opt_vm_read (vm, mio);
-		if (es_error_p (exec))
-		{
-			opt_vm_report_error (vm, exec, NULL);
-			error (FATAL, "failed in converting //exec to an optscript object");
-		}
-		mio_unref (mio);
-	}
-
-	EsObject *o = opt_vm_eval (vm, code);
-	if (es_error_p (o))
-	{
-		opt_vm_report_error (vm, o, NULL);
-		error (FATAL, "failed to push the proc representing the script");
-	}
-	es_object_unref (o);
-
-	EsObject *r = opt_vm_eval (vm, exec);
+	/* Run the proc directly instead of pushing it and evaluating
+	 * //exec; this is called for each match. */
+	EsObject *r = opt_vm_exec (vm, code);
 	if (es_error_p (r))
 		opt_vm_report_error (vm, r, NULL);
 	return r;
@@ -14,6 +14,7 @@
 #include <string.h>
 
 #include "debug.h"
+#include "lxpath_p.h"
 #include "parse_p.h"
 #include "options.h"
 #include "selectors.h"
@@ -342,10 +343,6 @@ selectLispOrLEXByLEXMarker (MIO *input,
 #include <libxml/xpath.h>
 #include <libxml/tree.h>
 
-static void suppressWarning (void *ctx CTAGS_ATTR_UNUSED, const char *msg CTAGS_ATTR_UNUSED, ...)
-{
-}
-
 static xmlDocPtr
 xmlParseMIO (MIO *input)
 {
@@ -355,9 +352,7 @@ xmlParseMIO (MIO *input)
 	buf = mio_memory_get_data (input, &len);
 	Assert (buf);
 
-	xmlSetGenericErrorFunc (NULL, suppressWarning);
-	xmlLineNumbersDefault (1);
-	return xmlParseMemory((const char *)buf, len);
+	return makeXMLDocFromMemory (buf, len);
 }
 
 static bool
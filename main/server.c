@@ -0,0 +1,353 @@
+/*
+*   Copyright (c) 2026, Universal Ctags Team
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License version 2 or (at your option) any later version.
+*
+*   This module implements --_server and --_client options.
+*
+*   A server initializes itself once, then listens on a unix domain
+*   socket and makes tags for the files named in each request. Parsers,
+*   keyword tables, and compiled regular expressions stay initialized
+*   across requests. The tags are written back to the connection as if
+*   "-o -" were given.
+*
+*   A request is a sequence of lines; the client closes its side of the
+*   connection (or sends "end") when the request is complete:
+*
+*	cwd<TAB>/directory/where/the/paths/are/relative/to
+*	file<TAB>path
+*	file<TAB>...
+*	end
+*
+*   A request made of "shutdown" line stops the server.
+*/
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"  /* must always come first */
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+
+#if defined (HAVE_SYS_SOCKET_H) && defined (HAVE_SYS_UN_H)
+# include <sys/types.h>
+# include <sys/socket.h>
+# include <sys/stat.h>
+# include <sys/un.h>
+# include <signal.h>
+# include <unistd.h>
+#endif
+
+#include "debug.h"
+#include "entry_p.h"
+#include "main_p.h"
+#include "mio.h"
+#include "options_p.h"
+#include "read.h"
+#include "routines.h"
+#include "routines_p.h"
+#include "server_p.h"
+#include "strlist.h"
+#include "vstring.h"
+
+#if defined (HAVE_SYS_SOCKET_H) && defined (HAVE_SYS_UN_H)
+
+/*
+*   DATA DEFINITIONS
+*/
+static volatile sig_atomic_t ServerQuit = 0;
+
+/*
+*   FUNCTION DEFINITIONS
+*/
+
+static void fillSocketAddress (struct sockaddr_un *addr, const char *const path)
+{
+	if (strlen (path) >= sizeof (addr->sun_path))
+		error (FATAL, "too long socket path: %s", path);
+
+	memset (addr, 0, sizeof (*addr));
+	addr->sun_family = AF_UNIX;
+	strcpy (addr->sun_path, path);
+}
+
+static bool writeFully (int fd, const char *buf, size_t size)
+{
+	while (size > 0)
+	{
+		ssize_t n = write (fd, buf, size);
+
+		if (n < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			return false;
+		}
+		buf += n;
+		size -= n;
+	}
+	return true;
+}
+
+static void handleQuitSignal (int signum CTAGS_ATTR_UNUSED)
+{
+	ServerQuit = 1;
+}
+
+static void installSignalHandlers (void)
+{
+	struct sigaction act;
+
+	memset (&act, 0, sizeof (act));
+	sigemptyset (&act.sa_mask);
+
+	/* A client going away must not kill the server. */
+	act.sa_handler = SIG_IGN;
+	sigaction (SIGPIPE, &act, NULL);
+
+	/* No SA_RESTART: accept() must return to see ServerQuit. */
+	act.sa_handler = handleQuitSignal;
+	sigaction (SIGINT, &act, NULL);
+	sigaction (SIGTERM, &act, NULL);
+}
+
+static int openServerSocket (const char *const path)
+{
+	struct sockaddr_un addr;
+	struct stat st;
+	int fd;
+
+	fillSocketAddress (&addr, path);
+
+	/* Remove the socket left by a server died before. Don't remove
+	 * anything other than a socket. */
+	if (lstat (path, &st) == 0)
+	{
+		if (! S_ISSOCK (st.st_mode))
+			error (FATAL, "\"%s\" exists and is not a socket", path);
+		remove (path);
+	}
+
+	fd = socket (AF_UNIX, SOCK_STREAM, 0);
+	if (fd < 0)
+		error (FATAL | PERROR, "cannot make a socket");
+
+	if (bind (fd, (struct sockaddr *) &addr, sizeof (addr)) < 0
+		|| listen (fd, SOMAXCONN) < 0)
+		error (FATAL | PERROR, "cannot listen on \"%s\"", path);
+
+	return fd;
+}
+
+typedef struct sServerRequest {
+	vString *cwd;
+	stringList *files;
+	bool shutdown;
+} serverRequest;
+
+static void readRequest (int fd, serverRequest *req)
+{
+	FILE *fp;
+	MIO *mio;
+	vString *vLine;
+
+	fd = dup (fd);
+	if (fd < 0 || (fp = fdopen (fd, "r")) == NULL)
+	{
+		if (fd >= 0)
+			close (fd);
+		error (WARNING | PERROR, "cannot read a request");
+		return;
+	}
+
+	mio = mio_new_fp (fp, fclose);
+	vLine = vStringNew ();
+	while (readLineRaw (vLine, mio) != NULL)
+	{
+		const char *line;
+
+		vStringStripNewline (vLine);
+		line = vStringValue (vLine);
+
+		if (strcmp (line, "end") == 0)
+			break;
+		else if (strcmp (line, "shutdown") == 0)
+			req->shutdown = true;
+		else if (strncmp (line, "cwd\t", 4) == 0)
+			vStringCopyS (req->cwd, line + 4);
+		else if (strncmp (line, "file\t", 5) == 0)
+			stringListAdd (req->files, vStringNewInit (line + 5));
+		else if (*line != '\0')
+			error (WARNING, "unknown request line: %s", line);
+	}
+	vStringDelete (vLine);
+	mio_unref (mio);
+}
+
+static void serveRequest (int fd, serverRequest *req, const char *const home)
+{
+	bool resize = false;
+	int savedStdout;
+
+	if (vStringLength (req->cwd) > 0 && chdir (vStringValue (req->cwd)) != 0)
+	{
+		error (WARNING | PERROR, "cannot change directory to \"%s\"",
+			   vStringValue (req->cwd));
+		return;
+	}
+	setCurrentDirectory ();
+
+	/* The tag writer and the external sort command write to stdout. */
+	fflush (stdout);
+	savedStdout = dup (STDOUT_FILENO);
+	dup2 (fd, STDOUT_FILENO);
+
+	openTagFile ();
+	for (unsigned int i = 0; i < stringListCount (req->files); i++)
+		resize |= createTagsForEntry (vStringValue (stringListItem (req->files, i)));
+	closeTagFile (resize);
+
+	fflush (stdout);
+	dup2 (savedStdout, STDOUT_FILENO);
+	close (savedStdout);
+
+	if (chdir (home) != 0)
+		error (FATAL | PERROR, "cannot change directory to \"%s\"", home);
+	setCurrentDirectory ();
+}
+
+extern void serverLoop (cookedArgs *args, void *data)
+{
+	const char *const path = data;
+	char *home;
+	int fd;
+
+	if (! cArgOff (args))
+		error (WARNING, "input files are ignored in server mode");
+	if (Option.cacheFileName)
+		error (WARNING, "--cache-file is ignored in server mode");
+	if (Option.cacheDirName)
+		error (WARNING, "--cache-dir is ignored in server mode");
+
+	installSignalHandlers ();
+	fd = openServerSocket (path);
+	home = eStrdup (CurrentDirectory);
+	verbose ("listening on \"%s\"\n", path);
+
+	while (! ServerQuit)
+	{
+		serverRequest req;
+		int cfd = accept (fd, NULL, NULL);
+
+		if (cfd < 0)
+		{
+			if (errno == EINTR || errno == ECONNABORTED)
+				continue;
+			error (FATAL | PERROR, "cannot accept a connection");
+		}
+
+		req.cwd = vStringNew ();
+		req.files = stringListNew ();
+		req.shutdown = false;
+
+		readRequest (cfd, &req);
+		if (req.shutdown)
+			ServerQuit = 1;
+		else
+			serveRequest (cfd, &req, home);
+
+		vStringDelete (req.cwd);
+		stringListDelete (req.files);
+		close (cfd);
+	}
+
+	verbose ("shutting down the server on \"%s\"\n", path);
+	close (fd);
+	remove (path);
+	eFree (home);
+}
+
+static bool writeRequestLine (int fd, const char *const key, const char *const value)
+{
+	vString *line = vStringNewInit (key);
+	bool ok;
+
+	if (value)
+	{
+		vStringPut (line, '\t');
+		vStringCatS (line, value);
+	}
+	vStringPut (line, '\n');
+	ok = writeFully (fd, vStringValue (line), vStringLength (line));
+	vStringDelete (line);
+	return ok;
+}
+
+extern void clientLoop (cookedArgs *args, void *data)
+{
+	const char *const path = data;
+	struct sockaddr_un addr;
+	char buf [BUFSIZ];
+	bool ok;
+	ssize_t n;
+	int fd;
+
+	fillSocketAddress (&addr, path);
+	fd = socket (AF_UNIX, SOCK_STREAM, 0);
+	if (fd < 0)
+		error (FATAL | PERROR, "cannot make a socket");
+	if (connect (fd, (struct sockaddr *) &addr, sizeof (addr)) < 0)
+		error (FATAL | PERROR, "cannot connect to \"%s\"", path);
+
+	if (Option.serverShutdown)
+		ok = writeRequestLine (fd, "shutdown", NULL);
+	else
+	{
+		ok = writeRequestLine (fd, "cwd", CurrentDirectory);
+		while (ok && ! cArgOff (args))
+		{
+			if (cArgIsOption (args))
+				error (WARNING,
+					   "\"%s\" is not sent to the server; give options before --_client",
+					   cArgItem (args));
+			else
+				ok = writeRequestLine (fd, "file", cArgItem (args));
+			cArgForth (args);
+		}
+	}
+	if (! ok || shutdown (fd, SHUT_WR) < 0)
+		error (FATAL | PERROR, "cannot send a request to \"%s\"", path);
+
+	while ((n = read (fd, buf, sizeof (buf))) != 0)
+	{
+		if (n < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			error (FATAL | PERROR, "cannot receive tags from \"%s\"", path);
+		}
+		if (fwrite (buf, 1, n, stdout) != (size_t) n)
+			error (FATAL | PERROR, "cannot write tags");
+	}
+	fflush (stdout);
+	close (fd);
+}
+
+#else
+
+extern void serverLoop (cookedArgs *args CTAGS_ATTR_UNUSED,
+						void *data CTAGS_ATTR_UNUSED)
+{
+	error (FATAL, "server mode is not supported on this platform");
+}
+
+extern void clientLoop (cookedArgs *args CTAGS_ATTR_UNUSED,
+						void *data CTAGS_ATTR_UNUSED)
+{
+	error (FATAL, "server mode is not supported on this platform");
+}
+
+#endif
@@ -0,0 +1,28 @@
+/*
+*   Copyright (c) 2026, Universal Ctags Team
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License version 2 or (at your option) any later version.
+*
+*   Main part private interface to server.c
+*/
+#ifndef CTAGS_MAIN_SERVER_PRIVATE_H
+#define CTAGS_MAIN_SERVER_PRIVATE_H
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"  /* must always come first */
+
+#include "options_p.h"
+
+/*
+*   FUNCTION PROTOTYPES
+*/
+
+/* Main loops for --_server and --_client. DATA is the path of the
+ * unix domain socket. */
+extern void serverLoop (cookedArgs *args, void *data);
+extern void clientLoop (cookedArgs *args, void *data);
+
+#endif  /* CTAGS_MAIN_SERVER_PRIVATE_H */
@@ -0,0 +1,442 @@
+/*
+*   Copyright (c) 2026, Universal Ctags Team
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License version 2 or (at your option) any later version.
+*
+*   This module implements --shard-by option: splitting the tag file into
+*   shards by the directory or the language of the tags.
+*
+*   After the tag file is written and sorted, the tag lines are split into
+*   shards, keeping their order, so each shard is sorted as the tag file
+*   was. Each shard has the pseudo tags of the tag file. A shard is written
+*   to the file made by appending "-" and the encoded key to the tag file
+*   name; the characters other than alphanumerics, '_', and '-' in the key
+*   are encoded as "%XX".
+*
+*   The tag file is then replaced with the manifest: its pseudo tags, and
+*   a TAG_SHARD pseudo tag for each shard:
+*
+*	!_TAG_SHARD<TAB>tags-main<TAB>/main/
+*
+*   The input field is the file name of the shard, relative to the
+*   directory of the manifest. The pattern field is the key.
+*
+*   In append mode, a shard made in the run replaces the one having the
+*   same key, and the other shards in the manifest are kept. Otherwise,
+*   the shards listed in the old manifest and not made in the run are
+*   removed.
+*/
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"  /* must always come first */
+
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "debug.h"
+#include "htable.h"
+#include "mio.h"
+#include "options_p.h"
+#include "ptag_p.h"
+#include "ptrarray.h"
+#include "read.h"
+#include "routines.h"
+#include "routines_p.h"
+#include "shard_p.h"
+#include "strlist.h"
+#include "vstring.h"
+
+/*
+*   DATA DECLARATIONS
+*/
+#define SHARD_PTAG PSEUDO_TAG_PREFIX "TAG_SHARD"
+#define SHARD_KEY_NONE "NONE"
+
+typedef struct sShard {
+	char *key;
+	char *fileName;		/* relative to the directory of the manifest */
+	vString *lines;
+} shard;
+
+/*
+*   DATA DEFINITIONS
+*/
+
+/* The file names of the shards listed in the old manifest */
+static stringList *OldShardFiles = NULL;
+
+/*
+*   FUNCTION DEFINITIONS
+*/
+
+static void deleteShard (void *data)
+{
+	shard *s = data;
+
+	eFree (s->key);
+	eFree (s->fileName);
+	if (s->lines)
+		vStringDelete (s->lines);
+	eFree (s);
+}
+
+static void encodeKey (vString *const buf, const char *const key)
+{
+	for (const char *p = key; *p; p++)
+	{
+		const unsigned char c = (unsigned char) *p;
+
+		if (isalnum (c) || c == '_' || c == '-')
+			vStringPut (buf, c);
+		else
+		{
+			char hex [4];
+
+			snprintf (hex, sizeof (hex), "%%%02X", c);
+			vStringCatS (buf, hex);
+		}
+	}
+}
+
+static bool decodeKey (vString *const buf, const char *const encoded)
+{
+	for (const char *p = encoded; *p; p++)
+	{
+		if (*p == '%')
+		{
+			unsigned int c;
+
+			if (! isxdigit ((unsigned char) p [1])
+				|| ! isxdigit ((unsigned char) p [2])
+				|| sscanf (p + 1, "%2x", &c) != 1)
+				return false;
+			vStringPut (buf, (int) c);
+			p += 2;
+		}
+		else
+			vStringPut (buf, *p);
+	}
+	return true;
+}
+
+static bool isShardPathSeparator (int c)
+{
+#if defined (WIN32)
+	if (c == PATH_SEPARATOR)
+		return true;
+#endif
+	return c == OUTPUT_PATH_SEPARATOR || c == '/';
+}
+
+/* The directory part of the input field */
+static void getDirectoryKey (const char *const line, vString *const key)
+{
+	const char *input = strchr (line, '\t');
+	const char *end;
+	const char *sep = NULL;
+
+	if (input == NULL)
+		return;
+	input++;
+	end = strchr (input, '\t');
+	if (end == NULL)
+		return;
+
+	for (const char *p = input; p < end; p++)
+		if (isShardPathSeparator (*p))
+			sep = p;
+
+	if (sep == NULL)
+		vStringPut (key, '.');
+	else if (sep == input)
+		vStringPut (key, *sep);
+	else
+		vStringNCatSUnsafe (key, input, sep - input);
+}
+
+/* The value of the language field. The last one is taken because the
+ * pattern before the fields can contain anything. */
+static void getLanguageKey (const char *const line, vString *const key)
+{
+	static const char needle [] = "\tlanguage:";
+	const char *field = NULL;
+	const char *end;
+
+	for (const char *p = strstr (line, needle); p; p = strstr (p + 1, needle))
+		field = p;
+	if (field == NULL)
+		return;
+
+	field += strlen (needle);
+	end = strpbrk (field, "\t\r\n");
+	vStringNCatSUnsafe (key, field, end? (size_t) (end - field): strlen (field));
+}
+
+static void getShardKey (const char *const line, vString *const key)
+{
+	vStringClear (key);
+	if (Option.shardBy == SHARD_BY_DIRECTORY)
+		getDirectoryKey (line, key);
+	else if (Option.shardBy == SHARD_BY_LANGUAGE)
+		getLanguageKey (line, key);
+
+	if (vStringIsEmpty (key))
+		vStringCatS (key, SHARD_KEY_NONE);
+}
+
+extern void loadShardManifest (const char *const tagFileName)
+{
+	MIO *mio;
+	vString *line;
+
+	Assert (OldShardFiles == NULL);
+	OldShardFiles = stringListNew ();
+
+	mio = mio_new_file (tagFileName, "rb");
+	if (mio == NULL)
+		return;
+
+	line = vStringNew ();
+	while (readLineRaw (line, mio) != NULL)
+	{
+		const char *l = vStringValue (line);
+		const char *end;
+
+		if (strncmp (l, SHARD_PTAG "\t", strlen (SHARD_PTAG "\t")) != 0)
+			continue;
+		l += strlen (SHARD_PTAG "\t");
+		end = strchr (l, '\t');
+		if (end && end != l)
+			stringListAdd (OldShardFiles, vStringNewNInit (l, end - l));
+	}
+	vStringDelete (line);
+	mio_unref (mio);
+}
+
+static void writeFileSafely (const char *const fileName,
+							 const vString *const header, const vString *const lines)
+{
+	vString *tmp = vStringNewInit (fileName);
+	MIO *mio;
+	bool ok;
+
+	/* Write to a temporary file first not to leave a broken file. */
+	vStringCatS (tmp, ".tmp");
+	mio = mio_new_file (vStringValue (tmp), "wb");
+	if (mio == NULL)
+		error (FATAL | PERROR, "cannot open \"%s\"", vStringValue (tmp));
+
+	ok = (mio_write (mio, vStringValue (header), 1, vStringLength (header))
+		  == vStringLength (header));
+	if (ok && lines)
+		ok = (mio_write (mio, vStringValue (lines), 1, vStringLength (lines))
+			  == vStringLength (lines));
+	if (mio_unref (mio) != 0)
+		ok = false;
+	if (! ok || rename (vStringValue (tmp), fileName) != 0)
+	{
+		remove (vStringValue (tmp));
+		error (FATAL | PERROR, "cannot write \"%s\"", fileName);
+	}
+	vStringDelete (tmp);
+}
+
+static int compareShards (const void *a, const void *b)
+{
+	const shard *sa = a;
+	const shard *sb = b;
+
+	return strcmp (sa->fileName, sb->fileName);
+}
+
+static void makeShardPtag (vString *const buf, const shard *const s)
+{
+	vStringCatS (buf, SHARD_PTAG "\t");
+	vStringCatS (buf, s->fileName);
+	vStringCatS (buf, "\t/");
+	for (const char *p = s->key; *p; p++)
+	{
+		if (*p == '/' || *p == '\\')
+			vStringPut (buf, '\\');
+		vStringPut (buf, *p);
+	}
+	vStringCatS (buf, "/\n");
+}
+
+/* Put the TAG_SHARD pseudo tags among the pseudo tags of the tag file. */
+static vString *makeManifest (const vString *const header, ptrArray *const shards)
+{
+	vString *manifest = vStringNew ();
+	vString *ptag = vStringNew ();
+	const char *l = vStringValue (header);
+	unsigned int i = 0;
+
+	while (*l)
+	{
+		const char *next = strchr (l, '\n');
+
+		next = next? next + 1: l + strlen (l);
+		if (Option.sorted != SO_UNSORTED)
+		{
+			for (; i < ptrArrayCount (shards); i++)
+			{
+				vStringClear (ptag);
+				makeShardPtag (ptag, ptrArrayItem (shards, i));
+				if (strcmp (vStringValue (ptag), l) > 0)
+					break;
+				vStringCat (manifest, ptag);
+			}
+		}
+		vStringNCatSUnsafe (manifest, l, next - l);
+		l = next;
+	}
+	for (; i < ptrArrayCount (shards); i++)
+		makeShardPtag (manifest, ptrArrayItem (shards, i));
+
+	vStringDelete (ptag);
+	return manifest;
+}
+
+/* Keep the old shards not made in this run in append mode, and remove
+ * them otherwise. */
+static void handleOldShards (const char *const tagFileName,
+							 ptrArray *const shards, hashTable *const made)
+{
+	const char *const base = baseFilename (tagFileName);
+	const size_t dirLength = base - tagFileName;
+	const size_t prefixLength = strlen (base) + 1;
+
+	for (unsigned int i = 0; i < stringListCount (OldShardFiles); i++)
+	{
+		const char *fileName = vStringValue (stringListItem (OldShardFiles, i));
+		vString *path;
+		vString *key;
+
+		if (hashTableHasItem (made, fileName))
+			continue;
+		if (strncmp (fileName, base, prefixLength - 1) != 0
+			|| fileName [prefixLength - 1] != '-'
+			|| strpbrk (fileName, "/\\"))
+			continue;
+
+		path = vStringNewNInit (tagFileName, dirLength);
+		vStringCatS (path, fileName);
+		key = vStringNew ();
+		if (Option.append)
+		{
+			if (doesFileExist (vStringValue (path))
+				&& decodeKey (key, fileName + prefixLength))
+			{
+				shard *s = xCalloc (1, shard);
+
+				s->key = vStringDeleteUnwrap (key);
+				key = NULL;
+				s->fileName = eStrdup (fileName);
+				ptrArrayAdd (shards, s);
+				hashTablePutItem (made, s->fileName, s);
+			}
+		}
+		else
+		{
+			verbose ("removing shard \"%s\"\n", vStringValue (path));
+			remove (vStringValue (path));
+		}
+		if (key)
+			vStringDelete (key);
+		vStringDelete (path);
+	}
+}
+
+extern void writeShards (const char *const tagFileName)
+{
+	MIO *in = mio_new_file (tagFileName, "rb");
+	vString *line;
+	vString *key;
+	vString *header;
+	vString *manifest;
+	hashTable *byKey;
+	hashTable *byFileName;
+	ptrArray *shards;
+
+	if (in == NULL)
+		error (FATAL | PERROR, "cannot read tag file \"%s\" for sharding",
+			   tagFileName);
+
+	line = vStringNew ();
+	key = vStringNew ();
+	header = vStringNew ();
+	byKey = hashTableNew (64, hashCstrhash, hashCstreq, NULL, NULL);
+	byFileName = hashTableNew (64, hashCstrhash, hashCstreq, NULL, NULL);
+	shards = ptrArrayNew (deleteShard);
+
+	while (readLineRaw (line, in) != NULL)
+	{
+		const char *l = vStringValue (line);
+		shard *s;
+
+		if (strncmp (l, PSEUDO_TAG_PREFIX, strlen (PSEUDO_TAG_PREFIX)) == 0)
+		{
+			/* The TAG_SHARD pseudo tags of the old manifest in append mode */
+			if (strncmp (l, SHARD_PTAG "\t", strlen (SHARD_PTAG "\t")) != 0)
+				vStringCat (header, line);
+			continue;
+		}
+
+		getShardKey (l, key);
+		s = hashTableGetItem (byKey, vStringValue (key));
+		if (s == NULL)
+		{
+			vString *fileName = vStringNewInit (baseFilename (tagFileName));
+
+			vStringPut (fileName, '-');
+			encodeKey (fileName, vStringValue (key));
+
+			s = xCalloc (1, shard);
+			s->key = vStringStrdup (key);
+			s->fileName = vStringDeleteUnwrap (fileName);
+			s->lines = vStringNew ();
+			ptrArrayAdd (shards, s);
+			hashTablePutItem (byKey, s->key, s);
+			hashTablePutItem (byFileName, s->fileName, s);
+		}
+		vStringCat (s->lines, line);
+	}
+	mio_unref (in);
+
+	for (unsigned int i = 0; i < ptrArrayCount (shards); i++)
+	{
+		shard *s = ptrArrayItem (shards, i);
+		vString *path = vStringNewInit (tagFileName);
+
+		vStringPut (path, '-');
+		encodeKey (path, s->key);
+		verbose ("writing shard \"%s\"\n", vStringValue (path));
+		writeFileSafely (vStringValue (path), header, s->lines);
+		vStringDelete (path);
+	}
+
+	if (OldShardFiles)
+		handleOldShards (tagFileName, shards, byFileName);
+	ptrArraySort (shards, compareShards);
+
+	manifest = makeManifest (header, shards);
+	writeFileSafely (tagFileName, manifest, NULL);
+
+	vStringDelete (manifest);
+	hashTableDelete (byFileName);
+	hashTableDelete (byKey);
+	ptrArrayDelete (shards);
+	vStringDelete (header);
+	vStringDelete (key);
+	vStringDelete (line);
+
+	if (OldShardFiles)
+	{
+		stringListDelete (OldShardFiles);
+		OldShardFiles = NULL;
+	}
+}
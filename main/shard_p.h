@@ -0,0 +1,27 @@
+/*
+*   Copyright (c) 2026, Universal Ctags Team
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License version 2 or (at your option) any later version.
+*
+*   Main part private interface to shard.c
+*/
+#ifndef CTAGS_MAIN_SHARD_PRIVATE_H
+#define CTAGS_MAIN_SHARD_PRIVATE_H
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"  /* must always come first */
+
+/*
+*   FUNCTION PROTOTYPES
+*/
+
+/* Remembers the shards listed in the manifest before it is overwritten. */
+extern void loadShardManifest (const char *const tagFileName);
+
+/* Splits the tag file into shards, and replaces it with the manifest. */
+extern void writeShards (const char *const tagFileName);
+
+#endif  /* CTAGS_MAIN_SHARD_PRIVATE_H */
@@ -27,7 +27,9 @@
 #include "options_p.h"
 #include "read.h"
 #include "routines.h"
+#include "routines_p.h"
 #include "sort_p.h"
+#include "vstring.h"
 
 /*
 *   FUNCTION DEFINITIONS
@@ -37,10 +39,15 @@ extern void catFile (MIO *mio)
 {
 	if (mio != NULL)
 	{
-		int c;
+		MIO *out = mio_new_fp (stdout, NULL);
+		long size;
+
+		mio_seek (mio, 0, SEEK_END);
+		size = mio_tell (mio);
 		mio_seek (mio, 0, SEEK_SET);
-		while ((c = mio_getc (mio)) != EOF)
-			putchar (c);
+		if (copyMioBytes (mio, out, size) < size)
+			error (FATAL | PERROR, "cannot read tag file");
+		mio_unref (out);
 		fflush (stdout);
 	}
 }
@@ -155,13 +162,124 @@ extern void externalSortTags (const bool toStdout, MIO *tagFile)
 		error (FATAL | PERROR, "cannot sort tag file");
 }
 
-#else
+#endif
 
 /*
- *  These functions provide a basic internal sort. No great memory
- *  optimization is performed (e.g. recursive subdivided sorts),
- *  so have lots of memory if you have large tag files.
+ *  The internal sort is an external merge sort. Lines of the tag file
+ *  are copied into an arena until Option.sortMemoryLimit bytes are
+ *  stored. A full run is sorted and written to a temporary file, and the
+ *  arena is reused for the next run. At the end, the runs are merged,
+ *  removing identical lines on the fly. When all the lines fit in one
+ *  run, no temporary file is made.
  */
+#define SORT_ARENA_BLOCK_SIZE (1024 * 1024)
+#define SORT_MERGE_FAN_IN 64
+
+typedef struct sSortArenaBlock {
+	char *mem;
+	size_t size;
+} sortArenaBlock;
+
+/* Blocks are kept when the arena is reset so that the next run reuses them. */
+typedef struct sSortArena {
+	sortArenaBlock *blocks;
+	size_t count;
+	size_t current;
+	size_t used;		/* bytes used in the current block */
+} sortArena;
+
+/* Lines of the run being collected. */
+typedef struct sSortBuffer {
+	sortArena arena;
+	char **table;
+	size_t count;
+	size_t size;
+	size_t bytes;		/* memory accounted against the limit */
+} sortBuffer;
+
+/* One sorted run, either spilled to a temporary file or kept in memory. */
+typedef struct sSortRun {
+	MIO *mio;			/* NULL if the lines are in table */
+	char *name;
+	vString *buf;
+	char **table;
+	size_t count;
+	size_t index;
+	long end;			/* offset where the lines of mio end; 0 for its end */
+	hashTable *droppedInputs;	/* skip the lines of these input files */
+	vString *input;		/* the input field of line, with droppedInputs */
+	const char *line;	/* current line without newline; NULL at the end */
+} sortRun;
+
+/* The files sorted by the worker processes of --jobs; they are merged
+ * with the tag file when it is sorted. */
+static sortRun *SortedFileRuns = NULL;
+static size_t SortedFileRunCount = 0;
+
+static char *sortArenaStore (sortArena *arena, const char *str, size_t len)
+{
+	sortArenaBlock *block = arena->count? arena->blocks + arena->current: NULL;
+	char *dst;
+
+	if (block == NULL || block->size - arena->used < len + 1)
+	{
+		if (block)
+			arena->current++;
+		if (arena->current == arena->count)
+		{
+			arena->blocks = xRealloc (arena->blocks, arena->count + 1, sortArenaBlock);
+			arena->blocks [arena->count].mem = NULL;
+			arena->blocks [arena->count].size = 0;
+			arena->count++;
+		}
+		block = arena->blocks + arena->current;
+		if (block->size < len + 1)
+		{
+			/* The block is not referred from anywhere; no need to keep it. */
+			block->size = (len + 1 > SORT_ARENA_BLOCK_SIZE)? len + 1: SORT_ARENA_BLOCK_SIZE;
+			block->mem = xRealloc (block->mem, block->size, char);
+		}
+		arena->used = 0;
+	}
+
+	dst = block->mem + arena->used;
+	memcpy (dst, str, len);
+	dst [len] = '\0';
+	arena->used += len + 1;
+	return dst;
+}
+
+static void sortArenaReset (sortArena *arena)
+{
+	arena->current = 0;
+	arena->used = 0;
+}
+
+static void sortArenaDelete (sortArena *arena)
+{
+	for (size_t i = 0; i < arena->count; i++)
+		eFree (arena->blocks [i].mem);
+	if (arena->blocks)
+		eFree (arena->blocks);
+}
+
+static void sortBufferAdd (sortBuffer *buffer, const char *str, size_t len)
+{
+	if (buffer->count == buffer->size)
+	{
+		buffer->size = buffer->size? buffer->size * 2: 1024;
+		buffer->table = xRealloc (buffer->table, buffer->size, char *);
+	}
+	buffer->table [buffer->count++] = sortArenaStore (&buffer->arena, str, len);
+	buffer->bytes += len + 1 + sizeof (char *);
+}
+
+static void sortBufferReset (sortBuffer *buffer)
+{
+	sortArenaReset (&buffer->arena);
+	buffer->count = 0;
+	buffer->bytes = 0;
+}
 
 extern void failedSort (MIO *const mio, const char* msg)
 {
@@ -174,116 +292,506 @@ extern void failedSort (MIO *const mio, const char* msg)
 		error (FATAL, "%s: %s", msg, cannotSort);
 }
 
+static int compareTagLinesFolded (const char *const line1, const char *const line2)
+{
+	int r = struppercmp (line1, line2);
+
+	/* Make identical lines adjacent so that they are removed. */
+	return r? r: strcmp (line1, line2);
+}
+
 static int compareTagsFolded(const void *const one, const void *const two)
 {
 	const char *const line1 = *(const char* const*) one;
 	const char *const line2 = *(const char* const*) two;
 
-	return struppercmp (line1, line2);
+	return compareTagLinesFolded (line1, line2);
 }
 
-static int compareTags (const void *const one, const void *const two)
+/*
+ *  Multikey quicksort (Bentley and Sedgewick) for the byte order of
+ *  strcmp (). Lines are partitioned on their character at depth, so
+ *  the common prefixes of tag names are not compared again and again.
+ */
+#define SORT_INSERTION_THRESHOLD 16
+
+static void insertionSortTagLines (char **a, size_t n, size_t depth)
 {
-	const char *const line1 = *(const char* const*) one;
-	const char *const line2 = *(const char* const*) two;
+	for (size_t i = 1; i < n; i++)
+	{
+		char *t = a [i];
+		size_t j = i;
 
-	return strcmp (line1, line2);
+		for (; j > 0 && strcmp (a [j - 1] + depth, t + depth) > 0; j--)
+			a [j] = a [j - 1];
+		a [j] = t;
+	}
 }
 
-static void writeSortedTags (
-		char **const table, const size_t numTags, const bool toStdout, bool newlineReplaced)
+static void multikeySortTagLines (char **a, size_t n, size_t depth)
 {
-	MIO *mio;
-	size_t i;
+	while (n > SORT_INSERTION_THRESHOLD)
+	{
+		size_t lt = 0, i = 0, gt = n;
+		unsigned char v, c0, c1, c2;
+		char *t;
+
+		/* median of three */
+		c0 = (unsigned char) a [0][depth];
+		c1 = (unsigned char) a [n / 2][depth];
+		c2 = (unsigned char) a [n - 1][depth];
+		if ((c0 <= c1 && c1 <= c2) || (c2 <= c1 && c1 <= c0))
+			v = c1;
+		else if ((c1 <= c0 && c0 <= c2) || (c2 <= c0 && c0 <= c1))
+			v = c0;
+		else
+			v = c2;
 
-	/*  Write the sorted lines back into the tag file.
-	 */
-	if (toStdout)
-		mio = mio_new_fp (stdout, NULL);
+		while (i < gt)
+		{
+			unsigned char c = (unsigned char) a [i][depth];
+
+			if (c < v)
+			{
+				t = a [lt]; a [lt++] = a [i]; a [i++] = t;
+			}
+			else if (c > v)
+			{
+				t = a [--gt]; a [gt] = a [i]; a [i] = t;
+			}
+			else
+				i++;
+		}
+
+		multikeySortTagLines (a, lt, depth);
+		multikeySortTagLines (a + gt, n - gt, depth);
+		if (v == '\0')
+			return;			/* identical lines */
+		a += lt;
+		n = gt - lt;
+		depth++;
+	}
+	insertionSortTagLines (a, n, depth);
+}
+
+static void sortTagLines (char **table, size_t count)
+{
+	if (Option.sorted == SO_FOLDSORTED)
+		qsort (table, count, sizeof (*table), compareTagsFolded);
 	else
+		multikeySortTagLines (table, count, 0);
+}
+
+extern bool isTagLineOfInputs (const char *const line, hashTable *inputs,
+							   vString *buf)
+{
+	const char *input, *end;
+
+	/* The second field of a pseudo tag is not an input file. */
+	if (line [0] == '!' && line [1] == '_')
+		return false;
+
+	input = strchr (line, '\t');
+	if (input == NULL)
+		return false;
+	input++;
+	end = strchr (input, '\t');
+	if (end == NULL)
+		return false;
+
+	vStringNCopyS (buf, input, end - input);
+	return hashTableHasItem (inputs, vStringValue (buf));
+}
+
+static void sortRunForth (sortRun *run)
+{
+	if (run->mio == NULL)
+	{
+		run->line = (run->index < run->count)? run->table [run->index++]: NULL;
+		return;
+	}
+
+	do
+	{
+		if ((run->end > 0 && mio_tell (run->mio) >= run->end)
+			|| readLineRaw (run->buf, run->mio) == NULL)
+		{
+			run->line = NULL;
+			return;
+		}
+		vStringStripNewline (run->buf);
+		run->line = vStringValue (run->buf);
+	}
+	while (run->droppedInputs
+		   && isTagLineOfInputs (run->line, run->droppedInputs, run->input));
+}
+
+static void spillSortRun (sortRun *run, sortBuffer *buffer)
+{
+	run->mio = tempFile ("w+", &run->name);
+	for (size_t i = 0; i < buffer->count; i++)
 	{
-		mio = mio_new_file (tagFileName (), "w");
-		if (mio == NULL)
-			failedSort (mio, NULL);
+		if (mio_puts (run->mio, buffer->table [i]) == EOF
+			|| mio_putc (run->mio, '\n') == EOF)
+			failedSort (NULL, NULL);
 	}
-	for (i = 0 ; i < numTags ; ++i)
+	sortBufferReset (buffer);
+
+	mio_rewind (run->mio);
+	run->buf = vStringNew ();
+}
+
+static void deleteSortRun (sortRun *run)
+{
+	if (run->mio)
 	{
+		mio_unref (run->mio);
+		/* A run without name is a part of a file not owned by the sort. */
+		if (run->name)
+		{
+			remove (run->name);
+			eFree (run->name);
+		}
+		vStringDelete (run->buf);
+		vStringDelete (run->input);
+	}
+}
+
+/* A binary heap of runs ordered by their current lines. */
+static void siftDownSortRun (sortRun **heap, size_t count, size_t i,
+							 int (*cmpFunc) (const char *, const char *))
+{
+	for (;;)
+	{
+		size_t smallest = i;
+		const size_t l = 2 * i + 1;
+		const size_t r = l + 1;
+
+		if (l < count && cmpFunc (heap [l]->line, heap [smallest]->line) < 0)
+			smallest = l;
+		if (r < count && cmpFunc (heap [r]->line, heap [smallest]->line) < 0)
+			smallest = r;
+		if (smallest == i)
+			break;
+
+		sortRun *tmp = heap [i];
+		heap [i] = heap [smallest];
+		heap [smallest] = tmp;
+		i = smallest;
+	}
+}
+
+/* Sets *ORDERED to false if the lines written are not in order, which
+ * happens only when a run merged is not sorted. */
+static void mergeSortRuns (sortRun *runs, size_t numRuns, MIO *mio,
+						   bool *ordered)
+{
+	int (*cmpFunc) (const char *, const char *) =
+		Option.sorted == SO_FOLDSORTED ? compareTagLinesFolded : strcmp;
+	sortRun **heap = xMalloc (numRuns, sortRun *);
+	vString *last = vStringNew ();
+	bool first = true;
+	size_t count = 0;
+
+	for (size_t i = 0; i < numRuns; i++)
+	{
+		sortRunForth (runs + i);
+		if (runs [i].line)
+			heap [count++] = runs + i;
+	}
+	for (size_t i = count; i > 0; i--)
+		siftDownSortRun (heap, count, i - 1, cmpFunc);
+
+	while (count > 0)
+	{
+		sortRun *run = heap [0];
+
+		if (ordered && !first && cmpFunc (run->line, vStringValue (last)) < 0)
+			*ordered = false;
+
 		/*  Here we filter out identical tag *lines* (including search
 		 *  pattern) if this is not an xref file.
 		 */
-		if (i == 0  ||  Option.xref  ||  strcmp (table [i], table [i-1]) != 0)
+		if (first || Option.xref || strcmp (run->line, vStringValue (last)) != 0)
 		{
-			if (mio_puts (mio, table [i]) == EOF)
+			if (mio_puts (mio, run->line) == EOF
+				|| mio_putc (mio, '\n') == EOF)
 				failedSort (mio, NULL);
-			else if (newlineReplaced)
-				mio_putc (mio, '\n');
+			vStringCopyS (last, run->line);
+			first = false;
 		}
+
+		sortRunForth (run);
+		if (run->line == NULL)
+			heap [0] = heap [--count];
+		siftDownSortRun (heap, count, 0, cmpFunc);
+	}
+
+	vStringDelete (last);
+	eFree (heap);
+}
+
+/* Merge the spilled runs into one so that the number of open temporary
+ * files stays below SORT_MERGE_FAN_IN. */
+static void mergeSpilledSortRuns (sortRun *runs, size_t numRuns)
+{
+	sortRun merged = { .mio = NULL, };
+
+	verbose ("merging %lu sorted runs\n", (unsigned long) numRuns);
+	merged.mio = tempFile ("w+", &merged.name);
+	mergeSortRuns (runs, numRuns, merged.mio, NULL);
+	for (size_t i = 0; i < numRuns; i++)
+		deleteSortRun (runs + i);
+
+	mio_rewind (merged.mio);
+	merged.buf = vStringNew ();
+	runs [0] = merged;
+}
+
+/* Merges RUNS and the files registered with addSortedTagFile () into
+ * OUT. */
+static void mergeSortRunsWithFiles (sortRun *runs, size_t numRuns, MIO *out,
+									bool *ordered)
+{
+	sortRun *all = runs;
+
+	if (SortedFileRunCount > 0)
+	{
+		verbose ("merging %lu files sorted by worker processes\n",
+				 (unsigned long) SortedFileRunCount);
+		all = xMalloc (numRuns + SortedFileRunCount, sortRun);
+		memcpy (all, runs, numRuns * sizeof (*runs));
+		memcpy (all + numRuns, SortedFileRuns, SortedFileRunCount * sizeof (*runs));
 	}
+	mergeSortRuns (all, numRuns + SortedFileRunCount, out, ordered);
+	if (all != runs)
+	{
+		eFree (all);
+		discardSortedTagFiles ();
+	}
+}
+
+static void writeSortRuns (sortRun *runs, size_t numRuns, const bool toStdout)
+{
+	MIO *out;
+
 	if (toStdout)
-		mio_flush (mio);
-	mio_unref (mio);
+		out = mio_new_fp (stdout, NULL);
+	else
+	{
+		out = newTagFileOutput (tagFileName (), "w");
+		if (out == NULL)
+			failedSort (out, NULL);
+	}
+
+	mergeSortRunsWithFiles (runs, numRuns, out, NULL);
+
+	if (toStdout)
+		mio_flush (out);
+	mio_unref (out);
+}
+
+extern void addSortedTagFile (const char *const fileName, long offset,
+							  bool owned)
+{
+	sortRun *run;
+
+	SortedFileRuns = xRealloc (SortedFileRuns, SortedFileRunCount + 1, sortRun);
+	run = SortedFileRuns + SortedFileRunCount++;
+	memset (run, 0, sizeof (*run));
+	run->mio = mio_new_file (fileName, "r");
+	if (run->mio == NULL || mio_seek (run->mio, offset, SEEK_SET) != 0)
+		failedSort (run->mio, NULL);
+	if (owned)
+		run->name = eStrdup (fileName);
+	run->buf = vStringNew ();
+
+	/* Keep the number of the open files small. */
+	if (SortedFileRunCount == SORT_MERGE_FAN_IN)
+	{
+		mergeSpilledSortRuns (SortedFileRuns, SortedFileRunCount);
+		SortedFileRunCount = 1;
+	}
 }
 
-extern void internalSortTags (const bool toStdout, MIO* mio, size_t numTags)
+extern void discardSortedTagFiles (void)
+{
+	for (size_t i = 0; i < SortedFileRunCount; i++)
+		deleteSortRun (SortedFileRuns + i);
+	if (SortedFileRuns)
+		eFree (SortedFileRuns);
+	SortedFileRuns = NULL;
+	SortedFileRunCount = 0;
+}
+
+/* Collects the lines of MIO into sorted runs. The last run is kept in
+ * BUFFER. */
+static sortRun *makeSortRuns (MIO *mio, sortBuffer *buffer, size_t *numRunsOut)
 {
 	vString *vLine = vStringNew ();
 	const char *line;
-	size_t i;
-	int (*cmpFunc)(const void *, const void *);
-	bool newlineReplaced = false;
+	sortRun *runs = NULL;
+	size_t numRuns = 0;
 
-	/*  Allocate a table of line pointers to be sorted.
-	 */
-	const size_t tableSize = numTags * sizeof (char *);
-	char **table = (char **) malloc (tableSize);  /* line pointers */
-	DebugStatement ( size_t mallocSize = tableSize; )  /* cumulative total */
+	while ((line = readLineRaw (vLine, mio)) != NULL)
+	{
+		if (*line == '\0'  ||  strcmp (line, "\n") == 0)
+			continue;  /* ignore blank lines */
 
+		if (buffer->count > 0 && buffer->bytes >= Option.sortMemoryLimit)
+		{
+			sortTagLines (buffer->table, buffer->count);
+			verbose ("writing sorted run %lu (%lu lines)\n",
+					 (unsigned long) numRuns + 1, (unsigned long) buffer->count);
+			runs = xRealloc (runs, numRuns + 1, sortRun);
+			memset (runs + numRuns, 0, sizeof (*runs));
+			spillSortRun (runs + numRuns++, buffer);
+			if (numRuns == SORT_MERGE_FAN_IN)
+			{
+				mergeSpilledSortRuns (runs, numRuns);
+				numRuns = 1;
+			}
+		}
 
-	cmpFunc = Option.sorted == SO_FOLDSORTED ? compareTagsFolded : compareTags;
-	if (table == NULL)
-		failedSort (mio, "out of memory");
+		vStringStripNewline (vLine);
+		sortBufferAdd (buffer, vStringValue (vLine), vStringLength (vLine));
+	}
+	if (! mio_eof (mio))
+		failedSort (mio, NULL);
+	vStringDelete (vLine);
 
-	for (i = 0  ;  i < numTags  &&  ! mio_eof (mio)  ;  )
+	/* The last run stays in the memory. */
+	sortTagLines (buffer->table, buffer->count);
+	runs = xRealloc (runs, numRuns + 1, sortRun);
+	memset (runs + numRuns, 0, sizeof (*runs));
+	runs [numRuns].table = buffer->table;
+	runs [numRuns].count = buffer->count;
+	numRuns++;
+
+	*numRunsOut = numRuns;
+	return runs;
+}
+
+static void deleteSortRuns (sortRun *runs, size_t numRuns, sortBuffer *buffer)
+{
+	for (size_t i = 0; i < numRuns; i++)
+		deleteSortRun (runs + i);
+	eFree (runs);
+	if (buffer->table)
+		eFree (buffer->table);
+	sortArenaDelete (&buffer->arena);
+}
+
+extern void internalSortTags (const bool toStdout, MIO* mio)
+{
+	sortBuffer buffer = { .table = NULL, };
+	size_t numRuns;
+	sortRun *runs = makeSortRuns (mio, &buffer, &numRuns);
+
+	writeSortRuns (runs, numRuns, toStdout);
+	deleteSortRuns (runs, numRuns, &buffer);
+}
+
+extern bool internalMergeTags (MIO *mio, const char *const sortedFileName,
+							   long sortedSize, hashTable *droppedInputs,
+							   const char *const outputName)
+{
+	sortBuffer buffer = { .table = NULL, };
+	size_t numRuns;
+	sortRun *runs = makeSortRuns (mio, &buffer, &numRuns);
+	bool ordered = true;
+	MIO *out;
+
+	/* The sorted part is one more run; it is not removed after the merge. */
+	runs = xRealloc (runs, numRuns + 1, sortRun);
+	memset (runs + numRuns, 0, sizeof (*runs));
+	runs [numRuns].mio = mio_new_file (sortedFileName, "r");
+	if (runs [numRuns].mio == NULL)
+		failedSort (NULL, NULL);
+	runs [numRuns].buf = vStringNew ();
+	runs [numRuns].end = sortedSize;
+	if (droppedInputs)
 	{
-		line = readLineRaw (vLine, mio);
-		if (line == NULL)
+		runs [numRuns].droppedInputs = droppedInputs;
+		runs [numRuns].input = vStringNew ();
+	}
+	numRuns++;
+
+	out = newTagFileOutput (outputName, "w");
+	if (out == NULL)
+		failedSort (out, NULL);
+	verbose ("merging the tags added with %ld bytes sorted already\n", sortedSize);
+	mergeSortRunsWithFiles (runs, numRuns, out, &ordered);
+	if (mio_unref (out) != 0)
+		failedSort (NULL, NULL);
+
+	deleteSortRuns (runs, numRuns, &buffer);
+	return ordered;
+}
+
+/* Makes a run of the lines in BUFFER, terminating them in place.
+ * LASTLINE is set to the last line copied if it is not terminated. */
+static void makeSortRunOfBuffer (sortRun *run, char *buffer, size_t size,
+								 char **lastLine)
+{
+	size_t tableSize = 0;
+	char *end = buffer + size;
+
+	*lastLine = NULL;
+	while (buffer < end)
+	{
+		char *line = buffer;
+		char *eol = memchr (buffer, '\n', end - buffer);
+
+		if (eol)
 		{
-			if (! mio_eof (mio))
-				failedSort (mio, NULL);
-			break;
+			*eol = '\0';
+			buffer = eol + 1;
 		}
-		else if (*line == '\0'  ||  strcmp (line, "\n") == 0)
-			;  /* ignore blank lines */
 		else
 		{
-			const size_t stringSize = strlen (line) + 1;
-
-			table [i] = (char *) malloc (stringSize);
-			if (table [i] == NULL)
-				failedSort (mio, "out of memory");
-			DebugStatement ( mallocSize += stringSize; )
-			strcpy (table [i], line);
-			if (table[i][stringSize - 2] == '\n')
-			{
-				table[i][stringSize - 2] = '\0';
-				newlineReplaced = true;
-			}
-			++i;
+			line = *lastLine = eStrndup (buffer, end - buffer);
+			buffer = end;
+		}
+
+		if (*line == '\0')
+			continue;  /* ignore blank lines */
+
+		if (run->count == tableSize)
+		{
+			tableSize = tableSize? tableSize * 2: 1024;
+			run->table = xRealloc (run->table, tableSize, char *);
 		}
+		run->table [run->count++] = line;
 	}
-	numTags = i;
-	vStringDelete (vLine);
 
-	/*  Sort the lines.
-	 */
-	qsort (table, numTags, sizeof (*table), cmpFunc);
+	sortTagLines (run->table, run->count);
+}
+
+extern void internalSortTagBuffer (const bool toStdout, char *buffer, size_t size)
+{
+	sortRun run = { .table = NULL, };
+	char *lastLine;
 
-	writeSortedTags (table, numTags, toStdout, newlineReplaced);
+	makeSortRunOfBuffer (&run, buffer, size, &lastLine);
+	writeSortRuns (&run, 1, toStdout);
 
-	PrintStatus (("sort memory: %ld bytes\n", (long) mallocSize));
-	for (i = 0 ; i < numTags ; ++i)
-		free (table [i]);
-	free (table);
+	if (run.table)
+		eFree (run.table);
+	if (lastLine)
+		eFree (lastLine);
 }
 
-#endif
+extern void internalSortTagBufferToMIO (MIO *mio, char *buffer, size_t size)
+{
+	sortRun run = { .table = NULL, };
+	char *lastLine;
+
+	makeSortRunOfBuffer (&run, buffer, size, &lastLine);
+	mergeSortRuns (&run, 1, mio, NULL);
+
+	if (run.table)
+		eFree (run.table);
+	if (lastLine)
+		eFree (lastLine);
+}
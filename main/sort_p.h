@@ -16,7 +16,9 @@
 
 #include <stdio.h>
 
+#include "htable.h"
 #include "mio.h"
+#include "vstring.h"
 
 /*
 *   FUNCTION PROTOTYPES
@@ -25,11 +27,33 @@ extern void catFile (MIO *mio);
 
 #ifdef EXTERNAL_SORT
 extern void externalSortTags (const bool toStdout, MIO *tagFile);
-#else
-extern void internalSortTags (const bool toStdout,
-			      MIO *mio,
-			      size_t numTags);
 #endif
+extern void internalSortTags (const bool toStdout, MIO *mio);
+/* Sorts the lines of mio, and merges them with the first sortedSize
+ * bytes of the file sortedFileName, sorted already, into the file
+ * outputName. The lines of sortedFileName whose input field is in
+ * droppedInputs, if not NULL, are left out. Returns false if the lines
+ * written are not in order because sortedFileName was not sorted. */
+extern bool internalMergeTags (MIO *mio, const char *const sortedFileName,
+							   long sortedSize, hashTable *droppedInputs,
+							   const char *const outputName);
+/* Returns true if the input field of the tag line is in inputs.
+ * buf is used to hold the field. */
+extern bool isTagLineOfInputs (const char *const line, hashTable *inputs,
+							   vString *buf);
+
+/* The lines in buffer are modified. */
+extern void internalSortTagBuffer (const bool toStdout, char *buffer, size_t size);
+extern void internalSortTagBufferToMIO (MIO *mio, char *buffer, size_t size);
+
+/* Registers the file of tag lines sorted already from offset. The
+ * internal sort merges them with the tag file, and removes the file if
+ * OWNED is true. */
+extern void addSortedTagFile (const char *const fileName, long offset,
+							  bool owned);
+/* Removes the files registered and not merged yet, if they are to be
+ * removed. */
+extern void discardSortedTagFiles (void);
 
 /* mio is closed in this function. */
 extern void failedSort (MIO *const mio, const char* msg);
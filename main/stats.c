@@ -16,9 +16,19 @@
 #include "general.h"  /* must always come first */
 
 #include <stdio.h>
+#include <time.h>
+#if defined (HAVE_SYS_RESOURCE_H) && defined (HAVE_GETRUSAGE)
+#include <sys/resource.h>
+#endif
 
 #include "entry_p.h"
+#include "mio.h"
 #include "options_p.h"
+#include "parse_p.h"
+#include "ptrarray.h"
+#include "read_p.h"
+#include "routines.h"
+#include "routines_p.h"
 #include "stats_p.h"
 
 /*
@@ -31,6 +41,103 @@
 */
 static struct { long files, lines, bytes; } Totals = { 0, 0, 0 };
 
+typedef struct sMemoryUsage {
+	/* A block reallocated is counted as allocated again. */
+	unsigned long long allocated [COUNT_MEMORY_SUBSYSTEM];
+	/* The largest growth of the memory in use while the parser
+	 * ran for an input file */
+	long long peak;
+} memoryUsage;
+
+static struct {
+	bool started;
+	bool available;
+	memoryUsage *languages;
+	unsigned int count;
+	memorySubsystem subsystem;
+	/* The language on the top of the language stack of the input.
+	 * The hook must not look at the stack itself: it runs while the
+	 * stack is reallocated. */
+	langType language;
+	/* The memory in use, counted from when the accounting started */
+	long long inUse;
+	/* inUse when the current input file was opened */
+	long long base;
+} Memory;
+
+typedef struct sTimeUsage {
+	double wall;
+	double cpu;
+} timeUsage;
+
+typedef struct sLanguageTimeUsage {
+	timeUsage time;
+	unsigned long tags;
+} languageTimeUsage;
+
+static struct {
+	bool started;
+	timingPhase phase;
+	/* The language on the top of the language stack of the input */
+	langType language;
+	/* When the current phase or language was entered */
+	timeUsage last;
+	timeUsage phases [COUNT_TIMING_PHASE];
+	languageTimeUsage *languages;
+	unsigned int count;
+} Timing;
+
+typedef struct sFileRecord {
+	char *name;
+	langType language;
+	timeUsage time;
+	unsigned long bytes;
+	unsigned long lines;
+	unsigned long tags;
+	unsigned int rescans;
+	/* How --input-budget changed the parsing, or NULL */
+	const char *budget;
+} fileRecord;
+
+/* The sums of the records of the input files of a language */
+typedef struct sLanguageFileCounts {
+	unsigned long files;
+	unsigned long long bytes;
+	unsigned long tags;
+	timeUsage time;
+} languageFileCounts;
+
+static struct {
+	bool started;
+	languageFileCounts *languages;
+	unsigned int count;
+	/* The records kept for --slowest-files */
+	ptrArray *records;
+	/* --file-stats */
+	MIO *out;
+	fileRecord *current;
+	/* numTagsAdded () when the current file was begun */
+	unsigned long tags;
+} Files;
+
+static const char *const TimingPhaseNames [COUNT_TIMING_PHASE] = {
+	[PHASE_OTHER] = "other",
+	[PHASE_WALK]  = "walk",
+	[PHASE_GUESS] = "guess",
+	[PHASE_READ]  = "read",
+	[PHASE_PARSE] = "parse",
+	[PHASE_GUEST] = "guest",
+	[PHASE_WRITE] = "write",
+	[PHASE_SORT]  = "sort",
+};
+
+static const char *const MemorySubsystemNames [COUNT_MEMORY_SUBSYSTEM] = {
+	[MEMORY_PARSER] = "parser",
+	[MEMORY_CORK]   = "cork",
+	[MEMORY_REGEX]  = "regex",
+	[MEMORY_TOKEN]  = "token",
+};
+
 
 /*
 *   FUNCTION DEFINITIONS
@@ -42,9 +149,34 @@ extern void addTotals (
 	Totals.files += files;
 	Totals.lines += lines;
 	Totals.bytes += bytes;
+
+	if (Files.current)
+	{
+		Files.current->lines += lines;
+		Files.current->bytes += bytes;
+	}
+}
+
+extern void getTotals (unsigned long *files, unsigned long *lines,
+					   unsigned long *bytes)
+{
+	*files = Totals.files;
+	*lines = Totals.lines;
+	*bytes = Totals.bytes;
+}
+
+extern double getWallClock (void)
+{
+#ifdef CLOCK_MONOTONIC
+	struct timespec ts;
+
+	if (clock_gettime (CLOCK_MONOTONIC, &ts) == 0)
+		return (double) ts.tv_sec + (double) ts.tv_nsec / 1e9;
+#endif
+	return (double) time (NULL);
 }
 
-extern void printTotals (const clock_t *const timeStamps, bool append, sortType sorted)
+extern void printTotals (const double *const timeStamps, bool append, sortType sorted)
 {
 	const unsigned long totalTags = numTagsTotal();
 	const unsigned long addedTags = numTagsAdded();
@@ -54,8 +186,7 @@ extern void printTotals (const clock_t *const timeStamps, bool append, sortType
 			Totals.lines, plural (Totals.lines),
 			Totals.bytes/1024L);
 
-	const double interval = ((double) (timeStamps [1] - timeStamps [0])) /
-							CLOCKS_PER_SEC;
+	const double interval = timeStamps [1] - timeStamps [0];
 
 	fprintf (stderr, " in %.01f seconds", interval);
 	if (interval != (double) 0.0)
@@ -74,7 +205,7 @@ extern void printTotals (const clock_t *const timeStamps, bool append, sortType
 	{
 		fprintf (stderr, "%lu tag%s sorted", totalTags, plural (totalTags));
 		fprintf (stderr, " in %.02f seconds",
-				((double) (timeStamps [2] - timeStamps [1])) / CLOCKS_PER_SEC);
+				timeStamps [2] - timeStamps [1]);
 		fputc ('\n', stderr);
 	}
 
@@ -83,3 +214,422 @@ extern void printTotals (const clock_t *const timeStamps, bool append, sortType
 		 (unsigned long) maxTagsLine ());
 #endif
 }
+
+static void accountMemory (size_t allocated, size_t freed)
+{
+	const langType language = Memory.language;
+	memoryUsage *usage;
+
+	Memory.inUse += (long long) allocated - (long long) freed;
+
+	if (language == LANG_IGNORE || (unsigned int) language >= Memory.count)
+		return;
+
+	usage = Memory.languages + language;
+	usage->allocated [Memory.subsystem] += allocated;
+	if (Memory.inUse - Memory.base > usage->peak)
+		usage->peak = Memory.inUse - Memory.base;
+}
+
+extern void startMemoryAccounting (void)
+{
+	if (Memory.started)
+		return;
+
+	Memory.started = true;
+	Memory.count = countParsers ();
+	Memory.languages = xCalloc (Memory.count, memoryUsage);
+	Memory.subsystem = MEMORY_PARSER;
+	Memory.language = LANG_IGNORE;
+	Memory.available = setMemoryAccountingHook (accountMemory);
+}
+
+extern void beginMemoryAccountingForFile (void)
+{
+	Memory.base = Memory.inUse;
+}
+
+extern void switchMemoryLanguage (langType language)
+{
+	Memory.language = language;
+}
+
+extern memorySubsystem enterMemorySubsystem (memorySubsystem subsystem)
+{
+	const memorySubsystem previous = Memory.subsystem;
+
+	Memory.subsystem = subsystem;
+	return previous;
+}
+
+extern void leaveMemorySubsystem (memorySubsystem previous)
+{
+	Memory.subsystem = previous;
+}
+
+extern void printMemoryStatistics (void)
+{
+	if (! Memory.started)
+		return;
+
+	fputs ("\nMEMORY USAGE (kB)\n", stderr);
+	fputs ("==============================================\n", stderr);
+	if (! Memory.available)
+	{
+		fputs ("not available on this platform\n", stderr);
+		return;
+	}
+
+	fprintf (stderr, "%-16s %10s", "language", "peak");
+	for (unsigned int i = 0; i < COUNT_MEMORY_SUBSYSTEM; i++)
+		fprintf (stderr, " %10s", MemorySubsystemNames [i]);
+	fputc ('\n', stderr);
+
+	for (unsigned int l = 0; l < Memory.count; l++)
+	{
+		const memoryUsage *usage = Memory.languages + l;
+		unsigned long long total = 0;
+
+		for (unsigned int i = 0; i < COUNT_MEMORY_SUBSYSTEM; i++)
+			total += usage->allocated [i];
+		if (total == 0)
+			continue;
+
+		fprintf (stderr, "%-16s %10lld", getLanguageName (l), usage->peak / 1024);
+		for (unsigned int i = 0; i < COUNT_MEMORY_SUBSYSTEM; i++)
+			fprintf (stderr, " %10llu", usage->allocated [i] / 1024);
+		fputc ('\n', stderr);
+	}
+}
+
+/* Returns the peak resident set size of this process in kB, or -1. */
+static long getMaxResidentSetSize (void)
+{
+#if defined (HAVE_SYS_RESOURCE_H) && defined (HAVE_GETRUSAGE)
+	struct rusage usage;
+
+	if (getrusage (RUSAGE_SELF, &usage) == 0)
+# ifdef __APPLE__
+		return (long) (usage.ru_maxrss / 1024);	/* in bytes */
+# else
+		return (long) usage.ru_maxrss;
+# endif
+#endif
+	return -1;
+}
+
+static void readClocks (timeUsage *usage)
+{
+	usage->wall = getWallClock ();
+	usage->cpu = (double) clock () / CLOCKS_PER_SEC;
+}
+
+static void accountTime (void)
+{
+	timeUsage now;
+
+	readClocks (&now);
+	Timing.phases [Timing.phase].wall += now.wall - Timing.last.wall;
+	Timing.phases [Timing.phase].cpu += now.cpu - Timing.last.cpu;
+	if (Timing.language != LANG_IGNORE
+		&& (unsigned int) Timing.language < Timing.count)
+	{
+		languageTimeUsage *usage = Timing.languages + Timing.language;
+		usage->time.wall += now.wall - Timing.last.wall;
+		usage->time.cpu += now.cpu - Timing.last.cpu;
+	}
+	Timing.last = now;
+}
+
+extern void startTiming (void)
+{
+	if (Timing.started)
+		return;
+
+	Timing.started = true;
+	Timing.phase = PHASE_OTHER;
+	Timing.language = LANG_IGNORE;
+	Timing.count = countParsers ();
+	Timing.languages = xCalloc (Timing.count, languageTimeUsage);
+	readClocks (&Timing.last);
+}
+
+extern timingPhase enterTimingPhase (timingPhase phase)
+{
+	const timingPhase previous = Timing.phase;
+
+	if (Timing.started)
+		accountTime ();
+	Timing.phase = phase;
+	return previous;
+}
+
+extern void leaveTimingPhase (timingPhase previous)
+{
+	if (Timing.started)
+		accountTime ();
+	Timing.phase = previous;
+}
+
+extern void switchTimingLanguage (langType language)
+{
+	if (! Timing.started || language == Timing.language)
+		return;
+
+	accountTime ();
+	Timing.language = language;
+}
+
+extern void accountTimingTag (langType language)
+{
+	if (Timing.started && language != LANG_IGNORE
+		&& (unsigned int) language < Timing.count)
+		Timing.languages [language].tags++;
+}
+
+extern void printTimingStatistics (void)
+{
+	timeUsage total = { 0.0, 0.0 };
+
+	if (! Timing.started)
+		return;
+
+	accountTime ();
+
+	/* A line of JSON for scripts collecting the numbers */
+	fputs ("\nTIMING (seconds)\n", stderr);
+	fputs ("==============================================\n", stderr);
+	fputs ("{\"_type\": \"timing\", \"phases\": {", stderr);
+	for (unsigned int i = 0; i < COUNT_TIMING_PHASE; i++)
+	{
+		fprintf (stderr, "%s\"%s\": {\"wall\": %.6f, \"cpu\": %.6f}",
+				 (i == 0)? "": ", ", TimingPhaseNames [i],
+				 Timing.phases [i].wall, Timing.phases [i].cpu);
+		total.wall += Timing.phases [i].wall;
+		total.cpu += Timing.phases [i].cpu;
+	}
+	fputs ("}, \"languages\": {", stderr);
+	for (unsigned int l = 0, n = 0; l < Timing.count; l++)
+	{
+		const languageTimeUsage *usage = Timing.languages + l;
+
+		if (usage->tags == 0 && usage->time.cpu == 0.0 && usage->time.wall == 0.0)
+			continue;
+		fprintf (stderr, "%s\"%s\": {\"wall\": %.6f, \"cpu\": %.6f, \"tags\": %lu}",
+				 (n++ == 0)? "": ", ", getLanguageName (l),
+				 usage->time.wall, usage->time.cpu, usage->tags);
+	}
+	fprintf (stderr, "}, \"total\": {\"wall\": %.6f, \"cpu\": %.6f}",
+			 total.wall, total.cpu);
+	fprintf (stderr, ", \"maxrss\": %ld}\n", getMaxResidentSetSize ());
+}
+
+static void deleteFileRecord (void *data)
+{
+	fileRecord *record = data;
+
+	eFree (record->name);
+	eFree (record);
+}
+
+extern void startFileStatistics (bool counting)
+{
+	if (Files.started
+		|| (! counting && Option.slowestFiles == 0 && Option.fileStatsFileName == NULL))
+		return;
+
+	Files.started = true;
+	Files.count = countParsers ();
+	Files.languages = xCalloc (Files.count, languageFileCounts);
+	if (Option.slowestFiles > 0)
+		Files.records = ptrArrayNew (deleteFileRecord);
+	if (Option.fileStatsFileName)
+	{
+		Files.out = mio_new_file (Option.fileStatsFileName, "w");
+		if (Files.out == NULL)
+			error (FATAL | PERROR, "cannot open \"%s\"", Option.fileStatsFileName);
+	}
+}
+
+extern bool isRecordingFileStatistics (void)
+{
+	return Files.started;
+}
+
+extern void beginFileStatistics (const char *const fileName)
+{
+	if (! Files.started || Files.current)
+		return;
+
+	Files.current = xCalloc (1, fileRecord);
+	Files.current->name = eStrdup (fileName);
+	Files.tags = numTagsAdded ();
+	readClocks (&Files.current->time);
+}
+
+extern void addFileStatisticsRescans (unsigned int count)
+{
+	if (Files.current)
+		Files.current->rescans += count;
+}
+
+extern void setFileStatisticsBudget (const char *const budget)
+{
+	if (Files.current)
+		Files.current->budget = budget;
+}
+
+static void putJsonString (MIO *out, const char *s)
+{
+	mio_putc (out, '"');
+	for (; *s; s++)
+	{
+		const unsigned char c = (unsigned char) *s;
+
+		if (c == '"' || c == '\\')
+			mio_printf (out, "\\%c", c);
+		else if (c < 0x20)
+			mio_printf (out, "\\u%04x", c);
+		else
+			mio_putc (out, c);
+	}
+	mio_putc (out, '"');
+}
+
+static void writeFileRecord (MIO *out, const fileRecord *record)
+{
+	mio_puts (out, "{\"name\": ");
+	putJsonString (out, record->name);
+	mio_puts (out, ", \"language\": ");
+	putJsonString (out, getLanguageName (record->language));
+	mio_printf (out, ", \"wall\": %.6f, \"cpu\": %.6f, \"bytes\": %lu, \"lines\": %lu,"
+				" \"tags\": %lu, \"rescans\": %u",
+				record->time.wall, record->time.cpu, record->bytes, record->lines,
+				record->tags, record->rescans);
+	if (record->budget)
+		mio_printf (out, ", \"budget\": \"%s\"", record->budget);
+	mio_puts (out, "}\n");
+}
+
+extern void endFileStatistics (langType language)
+{
+	fileRecord *record = Files.current;
+	timeUsage now;
+
+	if (record == NULL)
+		return;
+	Files.current = NULL;
+
+	/* An input file no parser parses is not recorded. */
+	if (language == LANG_IGNORE)
+	{
+		deleteFileRecord (record);
+		return;
+	}
+
+	readClocks (&now);
+	record->language = language;
+	record->time.wall = now.wall - record->time.wall;
+	record->time.cpu = now.cpu - record->time.cpu;
+	record->tags = numTagsAdded () - Files.tags;
+
+	if ((unsigned int) language < Files.count)
+	{
+		languageFileCounts *counts = Files.languages + language;
+		counts->files++;
+		counts->bytes += record->bytes;
+		counts->tags += record->tags;
+		counts->time.wall += record->time.wall;
+		counts->time.cpu += record->time.cpu;
+	}
+
+	if (Files.out)
+		writeFileRecord (Files.out, record);
+	if (Files.records)
+		ptrArrayAdd (Files.records, record);
+	else
+		deleteFileRecord (record);
+}
+
+static int compareFileRecords (const void *a, const void *b)
+{
+	const fileRecord *ra = a;
+	const fileRecord *rb = b;
+
+	/* The slowest first */
+	return (ra->time.wall < rb->time.wall) - (ra->time.wall > rb->time.wall);
+}
+
+extern void printFileStatistics (void)
+{
+	if (! Files.started)
+		return;
+
+	if (Files.records)
+	{
+		const unsigned int count = ptrArrayCount (Files.records);
+
+		ptrArraySort (Files.records, compareFileRecords);
+
+		fputs ("\nSLOWEST FILES\n", stderr);
+		fputs ("==============================================\n", stderr);
+		fprintf (stderr, "%10s %10s %10s %10s %10s %7s %s\n",
+				 "wall(s)", "cpu(s)", "kB", "lines", "tags", "rescans", "name");
+		for (unsigned int i = 0; i < count && i < Option.slowestFiles; i++)
+		{
+			const fileRecord *record = ptrArrayItem (Files.records, i);
+			fprintf (stderr, "%10.3f %10.3f %10lu %10lu %10lu %7u %s\n",
+					 record->time.wall, record->time.cpu, record->bytes / 1024,
+					 record->lines, record->tags, record->rescans, record->name);
+		}
+		ptrArrayDelete (Files.records);
+		Files.records = NULL;
+	}
+
+	if (Files.out)
+	{
+		if (mio_unref (Files.out) != 0)
+			error (WARNING | PERROR, "cannot write \"%s\"", Option.fileStatsFileName);
+		Files.out = NULL;
+	}
+	Files.started = false;
+}
+
+extern void printStatisticsCounters (FILE *fp)
+{
+	languageFileCounts total = { 0, 0, 0, { 0.0, 0.0 } };
+	unsigned long attempts = 0, matches = 0;
+	unsigned long hits, misses;
+
+	fputs ("{\"_type\": \"completed\", \"command\": \"stats\", \"languages\": {", fp);
+	for (unsigned int l = 0, n = 0; l < Files.count; l++)
+	{
+		const languageFileCounts *counts = Files.languages + l;
+		unsigned long a, m;
+
+		countLanguageRegexMatches (l, &a, &m);
+		attempts += a;
+		matches += m;
+		if (counts->files == 0 && a == 0)
+			continue;
+
+		fprintf (fp, "%s\"%s\": {\"files\": %lu, \"bytes\": %llu, \"tags\": %lu,"
+				 " \"wall\": %.6f, \"cpu\": %.6f, \"regex-attempts\": %lu, \"regex-matches\": %lu}",
+				 (n++ == 0)? "": ", ", getLanguageName (l),
+				 counts->files, counts->bytes, counts->tags,
+				 counts->time.wall, counts->time.cpu, a, m);
+		total.files += counts->files;
+		total.bytes += counts->bytes;
+		total.tags += counts->tags;
+		total.time.wall += counts->time.wall;
+		total.time.cpu += counts->time.cpu;
+	}
+
+	getPatternCacheCounts (&hits, &misses);
+	fprintf (fp, "}, \"total\": {\"files\": %lu, \"bytes\": %llu, \"tags\": %lu,"
+			 " \"wall\": %.6f, \"cpu\": %.6f, \"regex-attempts\": %lu, \"regex-matches\": %lu}",
+			 total.files, total.bytes, total.tags, total.time.wall, total.time.cpu,
+			 attempts, matches);
+	fprintf (fp, ", \"pattern-cache\": {\"hits\": %lu, \"misses\": %lu}", hits, misses);
+	fprintf (fp, ", \"maxrss\": %ld}\n", getMaxResidentSetSize ());
+}
@@ -17,12 +17,84 @@
 *   INCLUDE FILES
 */
 #include "general.h"  /* must always come first */
+
+#include <stdio.h>
+
 #include "options_p.h"
 
+/*
+*   DATA DECLARATIONS
+*/
+
+/* While --totals=extra is given, the memory allocated by parsers is
+ * accounted to the subsystem entered last. */
+typedef enum {
+	MEMORY_PARSER,	/* none of the below */
+	MEMORY_CORK,
+	MEMORY_REGEX,
+	MEMORY_TOKEN,
+	COUNT_MEMORY_SUBSYSTEM
+} memorySubsystem;
+
+/* While --totals=extra is given, the time is accounted to the phase
+ * entered last. */
+typedef enum {
+	PHASE_OTHER,	/* none of the below */
+	PHASE_WALK,		/* walking the directories and the input file list */
+	PHASE_GUESS,	/* guessing the languages of input files */
+	PHASE_READ,		/* opening and loading input files */
+	PHASE_PARSE,
+	PHASE_GUEST,	/* running guest parsers for promises */
+	PHASE_WRITE,
+	PHASE_SORT,
+	COUNT_TIMING_PHASE
+} timingPhase;
+
 /*
 *   FUNCTION PROTOTYPES
 */
 extern void addTotals (const unsigned int files, const long unsigned int lines, const long unsigned int bytes);
-extern void printTotals (const clock_t *const timeStamps, bool append, sortType sorted);
+extern void getTotals (unsigned long *files, unsigned long *lines, unsigned long *bytes);
+/* Returns the seconds of a monotonic clock. */
+extern double getWallClock (void);
+extern void printTotals (const double *const timeStamps, bool append, sortType sorted);
+
+extern void startMemoryAccounting (void);
+extern void beginMemoryAccountingForFile (void);
+/* The memory is accounted to the language on the top of the language
+ * stack of the input. */
+extern void switchMemoryLanguage (langType language);
+/* Returns the subsystem to pass to leaveMemorySubsystem (). */
+extern memorySubsystem enterMemorySubsystem (memorySubsystem subsystem);
+extern void leaveMemorySubsystem (memorySubsystem previous);
+extern void printMemoryStatistics (void);
+
+extern void startTiming (void);
+/* Returns the phase to pass to leaveTimingPhase (). */
+extern timingPhase enterTimingPhase (timingPhase phase);
+extern void leaveTimingPhase (timingPhase previous);
+/* The time is also accounted to the language on the top of the
+ * language stack of the input, a subparser or a guest parser if it
+ * runs. */
+extern void switchTimingLanguage (langType language);
+extern void accountTimingTag (langType language);
+extern void printTimingStatistics (void);
+
+/* --slowest-files, --file-stats, and the stats command of the
+ * interactive mode. With COUNTING, the counters of each language are
+ * started without the options. */
+extern void startFileStatistics (bool counting);
+extern bool isRecordingFileStatistics (void);
+extern void beginFileStatistics (const char *const fileName);
+extern void addFileStatisticsRescans (unsigned int count);
+/* Records BUDGET, a static string, telling how --input-budget changed
+ * the parsing of the current file. */
+extern void setFileStatisticsBudget (const char *const budget);
+/* LANG_IGNORE discards the record of the file. */
+extern void endFileStatistics (langType language);
+extern void printFileStatistics (void);
+/* Prints the counters of each language as the response of the stats
+ * command. */
+extern void printStatisticsCounters (FILE *fp);
 
 #endif  /* CTAGS_MAIN_STATS_PRIVATE_H */
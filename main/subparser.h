@@ -48,6 +48,9 @@ struct sSubparser {
 	void (* inputEnd) (subparser *s);
 	void (* exclusiveSubparserChosenNotify) (subparser *s, void *data);
 	void (* makeTagEntryNotify) (subparser *s, const tagEntryInfo *tag, int corkIndex);
+	/* The kinds of the base parser makeTagEntryNotify wants to know
+	 * about, terminated with KIND_GHOST_INDEX. NULL for all kinds. */
+	const int *makeTagEntryNotifyKinds;
 };
 
 /*
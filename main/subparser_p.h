@@ -25,6 +25,7 @@
 *   FUNCTION PROTOTYPES
 */
 extern subparser *getFirstSubparser(struct slaveControlBlock *controlBlock);
+extern struct slaveControlBlock *getInputLanguageSlaveControlBlock (void);
 extern langType getSubparserLanguage (subparser *s);
 
 /* A base parser doesn't have to call the following three functions.
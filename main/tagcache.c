@@ -0,0 +1,617 @@
+/*
+*   Copyright (c) 2026, Universal Ctags Team
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License version 2 or (at your option) any later version.
+*
+*   This module implements --cache-file option: incremental tagging.
+*
+*   For each input file, the cache file records the modification time,
+*   the size, and a hash of the contents of the file together with the
+*   tag lines made from it. When ctags runs again with the same cache
+*   file, the tag lines of an input file that has not changed are copied
+*   from the cache instead of parsing the file. The tag lines are sorted
+*   with the others when the tag file is closed.
+*
+*   The format of the cache file is:
+*
+*	!_CTAGS_CACHE<TAB>1
+*	F<TAB>mtime<TAB>size<TAB>hash<TAB>options<TAB>bytes<TAB>count<TAB>name
+*	<bytes of tag lines>
+*	F<TAB>...
+*
+*   "options" is a hash of the options in effect when the file was
+*   parsed. An entry made with different options is not used.
+*
+*   This module also implements --cache-dir option: a cache shared by
+*   runs tagging the same file contents, i.e. on different machines
+*   checking out the same tree. An entry is a file in the directory
+*   named after a hash of the contents of the input file, the path
+*   written to its tags, the version of ctags, and the options. The
+*   format of an entry is:
+*
+*	!_CTAGS_CACHE_ENTRY<TAB>1<TAB>size<TAB>hash<TAB>count<TAB>path
+*	<tag lines>
+*
+*   An entry is written to a temporary file in the directory first and
+*   renamed, so runs sharing the directory never see a partial entry.
+*/
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"  /* must always come first */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#ifdef HAVE_UNISTD_H
+# include <unistd.h>
+#endif
+
+#include "ctags.h"
+#include "debug.h"
+#include "entry_p.h"
+#include "field.h"
+#include "htable.h"
+#include "options_p.h"
+#include "parse_p.h"
+#include "ptrarray.h"
+#include "read.h"
+#include "read_p.h"
+#include "routines.h"
+#include "routines_p.h"
+#include "stats_p.h"
+#include "tagcache_p.h"
+#include "vstring.h"
+
+/*
+*   DATA DECLARATIONS
+*/
+#define CACHE_MAGIC "!_CTAGS_CACHE"
+#define CACHE_VERSION 1
+
+#define CACHE_ENTRY_MAGIC "!_CTAGS_CACHE_ENTRY"
+#define CACHE_ENTRY_VERSION 1
+
+typedef unsigned long long cacheHash;
+
+typedef struct sCacheEntry {
+	char *name;
+	long long mtime;
+	unsigned long size;
+	cacheHash hash;
+	cacheHash options;
+	char *lines;
+	size_t bytes;
+	unsigned long count;	/* number of tag lines except pseudo tags */
+} cacheEntry;
+
+/*
+*   DATA DEFINITIONS
+*/
+static bool CacheEnabled = false;
+
+/* Entries loaded from the cache file. An entry used in this run is
+ * moved to NewEntries. */
+static hashTable *OldEntries = NULL;
+
+/* Entries to be written to the cache file, in the order of input files */
+static ptrArray *NewEntries = NULL;
+static hashTable *NewEntryTable = NULL;
+
+/* The entry for the file being parsed */
+static cacheEntry *CurrentEntry = NULL;
+static long CurrentOffset = 0;
+
+/* --cache-dir is given and usable. */
+static bool CacheDirEnabled = false;
+
+/* The hash of the contents of the file looked up in the cache
+ * directory last, reused when the file is parsed after a miss. */
+static vString *LastHashedName = NULL;
+static cacheHash LastHash;
+
+/*
+*   FUNCTION DEFINITIONS
+*/
+
+static bool hashFileContents (const char *const fileName, cacheHash *hash)
+{
+	unsigned char buf [BUFSIZ];
+	FILE *fp = fopen (fileName, "rb");
+	cacheHash h = HASH_BYTES_INIT;
+	size_t n;
+
+	if (fp == NULL)
+		return false;
+
+	while ((n = fread (buf, 1, sizeof (buf), fp)) > 0)
+		h = hashBytes (h, buf, n);
+
+	bool ok = ! ferror (fp);
+	fclose (fp);
+	if (ok)
+		*hash = h;
+	return ok;
+}
+
+/* The tag lines of FILENAME depend on the options and on the path
+ * written to the input field, which is relative to the tag file with
+ * --tag-relative. */
+static cacheHash hashOptions (const char *const fileName)
+{
+	const char *fingerprint = getOptionFingerprint ();
+	const char *tagPath = getTagPath (fileName);
+	cacheHash h = HASH_BYTES_INIT;
+
+	h = hashBytes (h, (const unsigned char *) PROGRAM_VERSION, strlen (PROGRAM_VERSION));
+	h = hashBytes (h, (const unsigned char *) fingerprint, strlen (fingerprint) + 1);
+	return hashBytes (h, (const unsigned char *) tagPath, strlen (tagPath));
+}
+
+static void deleteCacheEntry (void *data)
+{
+	cacheEntry *entry = data;
+
+	eFree (entry->name);
+	if (entry->lines)
+		eFree (entry->lines);
+	eFree (entry);
+}
+
+static bool parseEntryHeader (const char *line, cacheEntry *entry, const char **name)
+{
+	int consumed = 0;
+
+	if (sscanf (line, "F\t%lld\t%lu\t%llx\t%llx\t%zu\t%lu\t%n",
+				&entry->mtime, &entry->size, &entry->hash, &entry->options,
+				&entry->bytes, &entry->count, &consumed) != 6
+		|| consumed == 0)
+		return false;
+
+	*name = line + consumed;
+	return (**name != '\0');
+}
+
+static bool loadCacheFile (const char *const fileName)
+{
+	MIO *mio = mio_new_file (fileName, "rb");
+	vString *vLine;
+	bool ok = true;
+
+	if (mio == NULL)
+	{
+		/* The first run */
+		verbose ("cache file \"%s\" is not found\n", fileName);
+		return true;
+	}
+
+	vLine = vStringNew ();
+	if (readLineRaw (vLine, mio) == NULL)
+		ok = false;
+	else
+	{
+		int version = 0;
+
+		vStringStripNewline (vLine);
+		if (sscanf (vStringValue (vLine), CACHE_MAGIC "\t%d", &version) != 1
+			|| version != CACHE_VERSION)
+			ok = false;
+	}
+
+	while (ok && readLineRaw (vLine, mio) != NULL)
+	{
+		cacheEntry *entry = xCalloc (1, cacheEntry);
+		const char *name;
+
+		vStringStripNewline (vLine);
+		if (! parseEntryHeader (vStringValue (vLine), entry, &name))
+		{
+			eFree (entry);
+			ok = false;
+			break;
+		}
+		entry->name = eStrdup (name);
+		entry->lines = xMalloc (entry->bytes + 1, char);
+		if (mio_read (mio, entry->lines, 1, entry->bytes) != entry->bytes)
+		{
+			deleteCacheEntry (entry);
+			ok = false;
+			break;
+		}
+		entry->lines [entry->bytes] = '\0';
+
+		if (hashTableHasItem (OldEntries, entry->name))
+			deleteCacheEntry (entry);
+		else
+			hashTablePutItem (OldEntries, entry->name, entry);
+	}
+
+	vStringDelete (vLine);
+	mio_unref (mio);
+	return ok;
+}
+
+static bool deleteOldEntry (const void *key CTAGS_ATTR_UNUSED, void *value,
+							void *user_data CTAGS_ATTR_UNUSED)
+{
+	deleteCacheEntry (value);
+	return true;
+}
+
+static void deleteOldEntries (void)
+{
+	hashTableForeachItem (OldEntries, deleteOldEntry, NULL);
+	hashTableClear (OldEntries);
+}
+
+static void openCacheDir (void)
+{
+	fileStatus *status;
+
+	Assert (! CacheDirEnabled);
+
+	if (Option.cacheDirName == NULL)
+		return;
+
+	if (Option.filter || Option.printLanguage || Option.interactive
+		|| Option.etags || Option.xref || Option.sorted == SO_UNSORTED)
+	{
+		error (WARNING, "--cache-dir cannot be used with --filter, --print-language, --interactive, -e, -x, or --sort=no; ignored");
+		return;
+	}
+
+	status = eStat (Option.cacheDirName);
+	CacheDirEnabled = status->isDirectory;
+	eStatFree (status);
+	if (! CacheDirEnabled)
+		error (WARNING, "cache directory \"%s\" is not found; ignored",
+			   Option.cacheDirName);
+}
+
+extern void openTagCache (void)
+{
+	Assert (! CacheEnabled);
+
+	openCacheDir ();
+
+	if (Option.cacheFileName == NULL)
+		return;
+
+	if (Option.filter || Option.printLanguage || Option.interactive
+		|| Option.append || Option.etags || Option.xref
+		|| Option.sorted == SO_UNSORTED)
+	{
+		error (WARNING, "--cache-file cannot be used with --filter, --print-language, --interactive, --append, -e, -x, or --sort=no; ignored");
+		return;
+	}
+
+	OldEntries = hashTableNew (1024, hashCstrhash, hashCstreq,
+							   NULL, NULL);
+	NewEntryTable = hashTableNew (1024, hashCstrhash, hashCstreq,
+								  NULL, NULL);
+	NewEntries = ptrArrayNew (deleteCacheEntry);
+
+	if (! loadCacheFile (Option.cacheFileName))
+	{
+		error (WARNING, "broken cache file \"%s\"; ignored", Option.cacheFileName);
+		deleteOldEntries ();
+	}
+	CacheEnabled = true;
+}
+
+static void addNewEntry (cacheEntry *entry)
+{
+	if (hashTableHasItem (NewEntryTable, entry->name))
+	{
+		/* The same file is given twice. */
+		deleteCacheEntry (entry);
+		return;
+	}
+	ptrArrayAdd (NewEntries, entry);
+	hashTablePutItem (NewEntryTable, entry->name, entry);
+}
+
+/* The name of the entry for the contents HASH of FILENAME, modified at
+ * MTIME, in the cache directory. */
+static vString *makeCacheDirEntryName (const char *const fileName,
+									   long long mtime, cacheHash hash)
+{
+	const char *repoinfo = ctags_repoinfo? ctags_repoinfo: "";
+	cacheHash key = hashOptions (fileName);
+	vString *name = vStringNewInit (Option.cacheDirName);
+
+	/* Builds of the same version may have different parsers. */
+	key = hashBytes (key, (const unsigned char *) repoinfo, strlen (repoinfo) + 1);
+	key = hashBytes (key, &hash, sizeof (hash));
+	/* The epoch field of the file tag tells the modification time. */
+	if (isFieldEnabled (FIELD_EPOCH))
+		key = hashBytes (key, &mtime, sizeof (mtime));
+
+	vStringPut (name, OUTPUT_PATH_SEPARATOR);
+	vStringCatS (name, "ct-");
+	for (int i = 60; i >= 0; i -= 4)
+		vStringPut (name, "0123456789abcdef" [(key >> i) & 0xf]);
+	return name;
+}
+
+/* Reads the entry for FILENAME from the cache directory. */
+static cacheEntry *loadCacheDirEntry (const char *const fileName,
+									  const fileStatus *const status)
+{
+	cacheEntry *entry;
+	vString *name;
+	vString *vLine;
+	MIO *mio;
+	cacheHash hash;
+	int version = 0, consumed = 0;
+
+	if (! hashFileContents (fileName, &hash))
+		return NULL;
+	if (LastHashedName == NULL)
+		LastHashedName = vStringNew ();
+	vStringCopyS (LastHashedName, fileName);
+	LastHash = hash;
+
+	name = makeCacheDirEntryName (fileName, (long long) status->mtime, hash);
+	mio = mio_new_file (vStringValue (name), "rb");
+	vStringDelete (name);
+	if (mio == NULL)
+		return NULL;
+
+	entry = xCalloc (1, cacheEntry);
+	vLine = vStringNew ();
+	if (readLineRaw (vLine, mio) == NULL)
+		goto broken;
+	vStringStripNewline (vLine);
+	if (sscanf (vStringValue (vLine),
+				CACHE_ENTRY_MAGIC "\t%d\t%lu\t%llx\t%zu\t%lu\t%n",
+				&version, &entry->size, &entry->hash, &entry->bytes,
+				&entry->count, &consumed) != 5
+		|| consumed == 0
+		|| version != CACHE_ENTRY_VERSION
+		|| entry->size != status->size
+		|| entry->hash != hash
+		/* Another entry may have the same name. */
+		|| strcmp (vStringValue (vLine) + consumed, getTagPath (fileName)) != 0)
+		goto broken;
+
+	entry->lines = xMalloc (entry->bytes + 1, char);
+	if (mio_read (mio, entry->lines, 1, entry->bytes) != entry->bytes)
+		goto broken;
+	entry->lines [entry->bytes] = '\0';
+	entry->name = eStrdup (fileName);
+	entry->mtime = (long long) status->mtime;
+	entry->options = hashOptions (fileName);
+
+	vStringDelete (vLine);
+	mio_unref (mio);
+	return entry;
+
+ broken:
+	error (WARNING, "broken cache entry for \"%s\"; ignored", fileName);
+	vStringDelete (vLine);
+	mio_unref (mio);
+	if (entry->lines)
+		eFree (entry->lines);
+	eFree (entry);
+	return NULL;
+}
+
+/* Writes ENTRY to the cache directory. */
+static void storeCacheDirEntry (const cacheEntry *const entry)
+{
+	vString *name = makeCacheDirEntryName (entry->name, entry->mtime, entry->hash);
+	vString *tmp = vStringNewCopy (name);
+	MIO *mio;
+	bool ok;
+
+#ifdef HAVE_MKSTEMP
+	int fd;
+	FILE *fp = NULL;
+
+	vStringCatS (tmp, ".XXXXXX");
+	fd = mkstemp (vStringValue (tmp));
+	if (fd >= 0 && (fp = fdopen (fd, "wb")) == NULL)
+	{
+		close (fd);
+		remove (vStringValue (tmp));
+	}
+	mio = fp? mio_new_fp (fp, fclose): NULL;
+#else
+	vStringCatS (tmp, ".tmp");
+	mio = mio_new_file (vStringValue (tmp), "wb");
+#endif
+	if (mio == NULL)
+	{
+		error (WARNING | PERROR, "cannot write cache entry \"%s\"", vStringValue (name));
+		goto out;
+	}
+
+	ok = (mio_printf (mio, "%s\t%d\t%lu\t%llx\t%zu\t%lu\t%s\n",
+					  CACHE_ENTRY_MAGIC, CACHE_ENTRY_VERSION,
+					  entry->size, entry->hash, entry->bytes, entry->count,
+					  getTagPath (entry->name)) >= 0
+		  && mio_write (mio, entry->lines, 1, entry->bytes) == entry->bytes);
+	if (mio_unref (mio) != 0)
+		ok = false;
+	if (! ok || rename (vStringValue (tmp), vStringValue (name)) != 0)
+	{
+		error (WARNING | PERROR, "cannot write cache entry \"%s\"", vStringValue (name));
+		remove (vStringValue (tmp));
+	}
+
+ out:
+	vStringDelete (tmp);
+	vStringDelete (name);
+}
+
+extern bool spliceCachedTags (const char *const fileName,
+							  const fileStatus *const status)
+{
+	cacheEntry *entry;
+	cacheHash hash;
+
+	entry = CacheEnabled? hashTableGetItem (OldEntries, fileName): NULL;
+	if (entry == NULL
+		|| entry->size != status->size
+		|| entry->options != hashOptions (fileName))
+		entry = NULL;
+	else if (entry->mtime != (long long) status->mtime)
+	{
+		/* Touched but may not be modified. */
+		if (! hashFileContents (fileName, &hash) || hash != entry->hash)
+			entry = NULL;
+		else
+			entry->mtime = (long long) status->mtime;
+	}
+
+	if (entry)
+		/* Move the entry to the new cache. */
+		hashTableDeleteItem (OldEntries, fileName);
+	else if (CacheDirEnabled)
+		entry = loadCacheDirEntry (fileName, status);
+	if (entry == NULL)
+		return false;
+
+	verbose ("using cached tags for \"%s\"\n", fileName);
+	writeTagFileLines (entry->lines, entry->bytes, entry->count);
+	addTotals (1, 0L, 0L);
+
+	if (CacheEnabled)
+		addNewEntry (entry);
+	else
+		deleteCacheEntry (entry);
+	return true;
+}
+
+extern void beginTagCacheEntry (const char *const fileName,
+								const fileStatus *const status)
+{
+	if (! CacheEnabled && ! CacheDirEnabled)
+		return;
+
+	Assert (CurrentEntry == NULL);
+
+	/* Let the entry have the pseudo tags of the parsers running for
+	 * the file, even if another file wrote them already; the sort drops
+	 * the duplicated lines. */
+	forgetParserPseudoTags ();
+
+	CurrentEntry = xCalloc (1, cacheEntry);
+	CurrentEntry->name = eStrdup (fileName);
+	CurrentEntry->mtime = (long long) status->mtime;
+	CurrentEntry->size = status->size;
+	CurrentEntry->options = hashOptions (fileName);
+	CurrentOffset = getTagFileOffset ();
+}
+
+static unsigned long countTagLines (const char *lines, size_t bytes)
+{
+	unsigned long count = 0;
+	const char *end = lines + bytes;
+
+	while (lines < end)
+	{
+		const char *eol = memchr (lines, '\n', end - lines);
+
+		if (strncmp (lines, "!_", 2) != 0)
+			count++;
+		lines = eol? eol + 1: end;
+	}
+	return count;
+}
+
+extern void endTagCacheEntry (void)
+{
+	cacheEntry *entry = CurrentEntry;
+	vString *lines;
+
+	if (entry == NULL)
+		return;
+	CurrentEntry = NULL;
+
+	if (LastHashedName && strcmp (vStringValue (LastHashedName), entry->name) == 0)
+		entry->hash = LastHash;
+	else if (! hashFileContents (entry->name, &entry->hash))
+	{
+		deleteCacheEntry (entry);
+		return;
+	}
+
+	lines = vStringNew ();
+	readTagFileRange (CurrentOffset, lines);
+	entry->bytes = vStringLength (lines);
+	entry->count = countTagLines (vStringValue (lines), entry->bytes);
+	entry->lines = vStringDeleteUnwrap (lines);
+
+	if (CacheDirEnabled)
+		storeCacheDirEntry (entry);
+	if (CacheEnabled)
+		addNewEntry (entry);
+	else
+		deleteCacheEntry (entry);
+}
+
+static bool writeCacheFile (const char *const fileName)
+{
+	MIO *mio = mio_new_file (fileName, "wb");
+	bool ok;
+
+	if (mio == NULL)
+		return false;
+
+	ok = (mio_printf (mio, "%s\t%d\n", CACHE_MAGIC, CACHE_VERSION) >= 0);
+	for (unsigned int i = 0; ok && i < ptrArrayCount (NewEntries); i++)
+	{
+		cacheEntry *entry = ptrArrayItem (NewEntries, i);
+
+		ok = (mio_printf (mio, "F\t%lld\t%lu\t%llx\t%llx\t%zu\t%lu\t%s\n",
+						  entry->mtime, entry->size, entry->hash, entry->options,
+						  entry->bytes, entry->count, entry->name) >= 0
+			  && mio_write (mio, entry->lines, 1, entry->bytes) == entry->bytes);
+	}
+
+	if (mio_unref (mio) != 0)
+		ok = false;
+	return ok;
+}
+
+extern void closeTagCache (void)
+{
+	CacheDirEnabled = false;
+	if (LastHashedName)
+	{
+		vStringDelete (LastHashedName);
+		LastHashedName = NULL;
+	}
+
+	if (! CacheEnabled)
+		return;
+
+	Assert (CurrentEntry == NULL);
+
+	/* Write to a temporary file first not to break the old cache
+	 * when something goes wrong. */
+	vString *tmp = vStringNewInit (Option.cacheFileName);
+	vStringCatS (tmp, ".tmp");
+
+	if (! writeCacheFile (vStringValue (tmp))
+		|| rename (vStringValue (tmp), Option.cacheFileName) != 0)
+	{
+		error (WARNING | PERROR, "cannot write cache file \"%s\"", Option.cacheFileName);
+		remove (vStringValue (tmp));
+	}
+	vStringDelete (tmp);
+
+	hashTableDelete (NewEntryTable);
+	NewEntryTable = NULL;
+	ptrArrayDelete (NewEntries);
+	NewEntries = NULL;
+	deleteOldEntries ();
+	hashTableDelete (OldEntries);
+	OldEntries = NULL;
+	CacheEnabled = false;
+}
@@ -0,0 +1,35 @@
+/*
+*   Copyright (c) 2026, Universal Ctags Team
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License version 2 or (at your option) any later version.
+*
+*   Main part private interface to tagcache.c
+*/
+#ifndef CTAGS_MAIN_TAGCACHE_PRIVATE_H
+#define CTAGS_MAIN_TAGCACHE_PRIVATE_H
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"  /* must always come first */
+
+#include "routines_p.h"
+
+/*
+*   FUNCTION PROTOTYPES
+*/
+extern void openTagCache (void);
+extern void closeTagCache (void);
+
+/* Writes the cached tags of fileName to the tag file if fileName is not
+ * changed since the last run. */
+extern bool spliceCachedTags (const char *const fileName,
+							  const fileStatus *const status);
+
+/* Records the tags written while parsing fileName. */
+extern void beginTagCacheEntry (const char *const fileName,
+								const fileStatus *const status);
+extern void endTagCacheEntry (void);
+
+#endif  /* CTAGS_MAIN_TAGCACHE_PRIVATE_H */
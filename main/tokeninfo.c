@@ -14,17 +14,20 @@
 
 #include "entry.h"
 #include "read.h"
+#include "stats_p.h"
 #include "routines.h"
 
 static void* createToken (void *createArg)
 {
 	struct tokenInfoClass *klass = createArg;
 	tokenInfo *token;
+	memorySubsystem m = enterMemorySubsystem (MEMORY_TOKEN);
 
 	token = eCalloc (1, sizeof (*token) + klass->extraSpace);
 	token->klass = klass;
 	token->string  = vStringNew ();
 
+	leaveMemorySubsystem (m);
 	return token;
 }
 
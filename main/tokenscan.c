@@ -0,0 +1,282 @@
+/*
+*   Copyright (c) 2026, Universal Ctags Team
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License version 2 or (at your option) any later version.
+*
+*   This module contains a table driven scanner for the parsers using
+*   tokenInfo objects.
+*/
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"  /* must always come first */
+#include "tokenscan.h"
+
+#include "keyword.h"
+#include "read.h"
+#include "vstring.h"
+
+#include <string.h>
+
+/*
+*   DATA DEFINITIONS
+*/
+enum scannerCharClass {
+	CC_SPACE            = 1 << 0,
+	CC_IDENTIFIER_START = 1 << 1,
+	CC_IDENTIFIER       = 1 << 2,
+	CC_COMMENT_START    = 1 << 3,
+	CC_STRING_START     = 1 << 4,
+	CC_OPERATOR_START   = 1 << 5,
+};
+
+/*
+*   FUNCTION DEFINITIONS
+*/
+static void addCharClass (unsigned char *classes, const char *set,
+						  unsigned char klass)
+{
+	const unsigned char *s = (const unsigned char *) set;
+
+	for (size_t i = 0; s && s[i] != '\0'; i++)
+	{
+		if (s[i + 1] == '-' && s[i + 2] != '\0')
+		{
+			for (unsigned int c = s[i]; c <= s[i + 2]; c++)
+				classes [c] |= klass;
+			i += 2;
+		}
+		else
+			classes [s[i]] |= klass;
+	}
+}
+
+static void prepareScanner (struct tokenScanner *scanner)
+{
+	unsigned char *classes = scanner->classes;
+
+	memset (classes, 0, sizeof (scanner->classes));
+	addCharClass (classes, scanner->spaces, CC_SPACE);
+	addCharClass (classes, scanner->identifier, CC_IDENTIFIER);
+	addCharClass (classes, (scanner->identifierStart
+							? scanner->identifierStart
+							: scanner->identifier),
+				  CC_IDENTIFIER_START);
+
+	for (unsigned int i = 0; i < scanner->commentCount; i++)
+		classes [(unsigned char) scanner->comments[i].start[0]] |= CC_COMMENT_START;
+	for (unsigned int i = 0; i < scanner->stringCount; i++)
+		classes [(unsigned char) scanner->strings[i].start[0]] |= CC_STRING_START;
+	for (unsigned int i = 0; i < scanner->operatorCount; i++)
+		classes [(unsigned char) scanner->operators[i].str[0]] |= CC_OPERATOR_START;
+
+	scanner->prepared = true;
+}
+
+/* Reads the characters of the class KLASS, and stores them to S if S
+ * is given. The characters are taken from the current line in bulk. */
+static void scanRun (const unsigned char *classes, unsigned char klass,
+					 vString *s)
+{
+	while (true)
+	{
+		const unsigned char *line = peekCharsInInputFile ();
+		if (line)
+		{
+			size_t n = 0;
+			while (line[n] != '\0' && (classes [line[n]] & klass))
+				n++;
+			if (s)
+				vStringNCatSUnsafe (s, (const char *) line, n);
+			skipCharsInInputFile (n);
+			if (line[n] != '\0')
+				return;
+		}
+
+		int c = getcFromInputFile ();
+		if (c == EOF || !(classes [c] & klass))
+		{
+			ungetcToInputFile (c);
+			return;
+		}
+		if (s)
+			vStringPut (s, c);
+	}
+}
+
+/* Reads the input until the first character of END is found, storing
+ * the characters to S if S is given. ESCAPE and the character after it
+ * are stored as they are. A newline stops the scanning if SINGLELINE
+ * is true. Returns the character found, or EOF. */
+static int scanUntil (const char *end, char escape, bool singleLine,
+					  vString *s)
+{
+	const char stops[] = { end[0], escape, singleLine? '\n': '\0', '\0' };
+	char set[sizeof (stops)];
+	size_t n = 0;
+
+	for (size_t i = 0; i < sizeof (stops) - 1; i++)
+		if (stops[i] != '\0')
+			set[n++] = stops[i];
+	set[n] = '\0';
+
+	while (true)
+	{
+		const unsigned char *line = peekCharsInInputFile ();
+		if (line)
+		{
+			size_t len = strcspn ((const char *) line, set);
+			if (s)
+				vStringNCatSUnsafe (s, (const char *) line, len);
+			skipCharsInInputFile (len);
+		}
+
+		int c = getcFromInputFile ();
+		if (c == EOF)
+			return EOF;
+		else if (escape != '\0' && c == escape)
+		{
+			int c0 = getcFromInputFile ();
+			if (s)
+				vStringPut (s, c);
+			if (c0 == EOF)
+				return EOF;
+			if (s)
+				vStringPut (s, c0);
+		}
+		else if (c == (unsigned char) end[0] || (singleLine && c == '\n'))
+			return c;
+		else if (s)
+			vStringPut (s, c);
+	}
+}
+
+/* Reads the input up to the end of END, or EOF. Returns false when the
+ * input ends before END. */
+static bool scanToEnd (const char *end, char escape, bool singleLine,
+					   vString *s)
+{
+	while (true)
+	{
+		int c = scanUntil (end, escape, singleLine, s);
+
+		if (c == EOF)
+			return false;
+		else if (c == (unsigned char) end[0]
+				 && (end[1] == '\0' || matchStringInInputFile (end + 1)))
+			return true;
+		else if (singleLine && c == '\n')
+		{
+			ungetcToInputFile (c);
+			return false;
+		}
+		else if (s)
+			vStringPut (s, c);
+	}
+}
+
+/* Returns true if C and the characters following it make STR;
+ * the characters are read then. */
+static bool matchRuleStart (int c, const char *str)
+{
+	return (c == (unsigned char) str[0]
+			&& (str[1] == '\0' || matchStringInInputFile (str + 1)));
+}
+
+static bool skipComment (const struct tokenScanner *scanner, int c)
+{
+	for (unsigned int i = 0; i < scanner->commentCount; i++)
+	{
+		const struct tokenScannerComment *comment = scanner->comments + i;
+
+		if (matchRuleStart (c, comment->start))
+		{
+			scanToEnd (comment->end, '\0', false, NULL);
+			return true;
+		}
+	}
+	return false;
+}
+
+static bool scanString (const struct tokenScanner *scanner, int c,
+						tokenInfo *const token)
+{
+	for (unsigned int i = 0; i < scanner->stringCount; i++)
+	{
+		const struct tokenScannerString *string = scanner->strings + i;
+
+		if (matchRuleStart (c, string->start))
+		{
+			token->type = string->type;
+			scanToEnd (string->end, string->escape, string->singleLine,
+					   token->string);
+			return true;
+		}
+	}
+	return false;
+}
+
+static bool scanOperator (const struct tokenScanner *scanner, int c,
+						  tokenInfo *const token)
+{
+	for (unsigned int i = 0; i < scanner->operatorCount; i++)
+	{
+		const struct tokenScannerOperator *op = scanner->operators + i;
+
+		if (matchRuleStart (c, op->str))
+		{
+			token->type = op->type;
+			return true;
+		}
+	}
+	return false;
+}
+
+extern void tokenScan (struct tokenScanner *scanner, tokenInfo *const token)
+{
+	const unsigned char *classes = scanner->classes;
+	int c;
+
+	if (!scanner->prepared)
+		prepareScanner (scanner);
+
+	token->type    = token->klass->typeForUndefined;
+	token->keyword = token->klass->keywordNone;
+	vStringClear (token->string);
+
+	while (true)
+	{
+		scanRun (classes, CC_SPACE, NULL);
+		c = getcFromInputFile ();
+		if (c == EOF || !(classes [c] & CC_COMMENT_START)
+			|| !skipComment (scanner, c))
+			break;
+	}
+
+	token->lineNumber   = getInputLineNumber ();
+	token->filePosition = getInputFilePosition ();
+
+	if (c == EOF)
+		token->type = token->klass->typeForEOF;
+	else if ((classes [c] & CC_STRING_START) && scanString (scanner, c, token))
+		;
+	else if ((classes [c] & CC_OPERATOR_START) && scanOperator (scanner, c, token))
+		;
+	else if (classes [c] & CC_IDENTIFIER_START)
+	{
+		tokenPutc (token, c);
+		scanRun (classes, CC_IDENTIFIER, token->string);
+		int keyword = lookupKeyword (tokenString (token), getInputLanguage ());
+		if (keyword == KEYWORD_NONE)
+			token->type = scanner->identifierType;
+		else
+		{
+			token->type = token->klass->typeForKeyword;
+			token->keyword = keyword;
+		}
+	}
+	else
+		token->type = c;
+}
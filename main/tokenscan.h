@@ -0,0 +1,87 @@
+/*
+*   Copyright (c) 2026, Universal Ctags Team
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License version 2 or (at your option) any later version.
+*
+*   A table driven scanner filling tokenInfo objects.
+*/
+#ifndef CTAGS_MAIN_TOKENSCAN_H
+#define CTAGS_MAIN_TOKENSCAN_H
+
+#include "general.h"  /* must always come first */
+#include "tokeninfo.h"
+
+/*
+*   DATA DECLARATIONS
+*/
+
+/* Comments are skipped like white spaces. END is "\n" for a comment
+ * running to the end of the line. */
+struct tokenScannerComment {
+	const char *start;
+	const char *end;
+};
+
+/* The characters between START and END make the string of the token;
+ * the delimiters are not stored. ESCAPE, if not '\0', is stored with
+ * the character following it, which cannot end the string then. A raw
+ * string is a string rule without ESCAPE. A SINGLELINE string ends at
+ * the end of the line if END is missing. */
+struct tokenScannerString {
+	const char *start;
+	const char *end;
+	char escape;
+	bool singleLine;
+	tokenType type;
+};
+
+/* Operators made of more than one character. Put the longer operator
+ * first when two operators share a prefix. */
+struct tokenScannerOperator {
+	const char *str;
+	tokenType type;
+};
+
+/* Character classes are given as sets of characters in which "a-z" stands
+ * for a range; put '-' at the end of the set for the character itself.
+ * IDENTIFIERSTART defaults to IDENTIFIER. A character starting no rule
+ * makes a token typed with its own value.
+ *
+ * The words matching an entry of the keyword table of the current input
+ * language are typed with typeForKeyword of the token's class; the other
+ * words with IDENTIFIERTYPE.
+ *
+ * The scanner reads runs of spaces, identifiers, comments, and strings
+ * from the current line in bulk. */
+struct tokenScanner {
+	const char *spaces;
+	const char *identifierStart;
+	const char *identifier;
+	tokenType identifierType;
+
+	struct tokenScannerComment *comments;
+	unsigned int commentCount;
+	struct tokenScannerString *strings;
+	unsigned int stringCount;
+	struct tokenScannerOperator *operators;
+	unsigned int operatorCount;
+
+	/* Built from the fields above at the first scan. */
+	bool prepared;
+	unsigned char classes [256];
+};
+
+#define ATTACH_SCANNER_COMMENTS(A) .comments = A, .commentCount = ARRAY_SIZE(A)
+#define ATTACH_SCANNER_STRINGS(A) .strings = A, .stringCount = ARRAY_SIZE(A)
+#define ATTACH_SCANNER_OPERATORS(A) .operators = A, .operatorCount = ARRAY_SIZE(A)
+
+/*
+*   FUNCTION PROTOTYPES
+*/
+
+/* Fills TOKEN with the next token of the input: use it as the read
+ * method of a tokenInfoClass. */
+extern void tokenScan (struct tokenScanner *scanner, tokenInfo *const token);
+
+#endif	/* CTAGS_MAIN_TOKENSCAN_H */
@@ -0,0 +1,142 @@
+/*
+*   Copyright (c) 2026, Universal Ctags Team
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License version 2 or (at your option) any later version.
+*
+*   This module implements --trace-events option: recording the spans of
+*   the input files, the parsers, the promises, and the phases of a run
+*   for a timeline viewer.
+*
+*   The spans are written in the Trace Event Format of Chrome; the file
+*   can be loaded into chrome://tracing, Perfetto, or speedscope. A span
+*   is a pair of "B" and "E" events of a thread. The closing bracket of
+*   the array is written at the end, but the viewers also accept a file
+*   cut by an interrupted run.
+*
+*   When <sys/sdt.h> of SystemTap is available, the same spans are also
+*   the USDT probes ctags:begin and ctags:end whether this option is
+*   given or not; perf, bpftrace, or SystemTap can attach them to a
+*   running process.
+*/
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"  /* must always come first */
+
+#ifdef HAVE_SYS_SDT_H
+#include <sys/sdt.h>
+#endif
+
+#include "debug.h"
+#include "mio.h"
+#include "routines.h"
+#include "stats_p.h"
+#include "traceevent_p.h"
+
+/*
+*   DATA DEFINITIONS
+*/
+static const char *const TraceCategoryNames [COUNT_TRACE_CATEGORY] = {
+	[TRACE_FILE]        = "file",
+	[TRACE_PARSER]      = "parser",
+	[TRACE_PROMISE]     = "promise",
+	[TRACE_PHASE]       = "phase",
+	[TRACE_REGEX_TABLE] = "regex-table",
+};
+
+static struct {
+	MIO *out;
+	char *fileName;
+	/* The timestamps are the microseconds from when the trace began. */
+	double start;
+} Trace;
+
+/*
+*   FUNCTION DEFINITIONS
+*/
+
+static void putJsonString (MIO *out, const char *s)
+{
+	mio_putc (out, '"');
+	for (; *s; s++)
+	{
+		const unsigned char c = (unsigned char) *s;
+
+		if (c == '"' || c == '\\')
+			mio_printf (out, "\\%c", c);
+		else if (c < 0x20)
+			mio_printf (out, "\\u%04x", c);
+		else
+			mio_putc (out, c);
+	}
+	mio_putc (out, '"');
+}
+
+static void putEvent (traceCategory category, char phase, const char *const name)
+{
+	mio_puts (Trace.out, ",\n{");
+	if (name)
+	{
+		mio_puts (Trace.out, "\"name\": ");
+		putJsonString (Trace.out, name);
+		mio_puts (Trace.out, ", ");
+	}
+	mio_printf (Trace.out, "\"cat\": \"%s\", \"ph\": \"%c\", \"ts\": %.3f, \"pid\": 1, \"tid\": 1}",
+				TraceCategoryNames [category], phase,
+				(getWallClock () - Trace.start) * 1e6);
+}
+
+extern void openEventTrace (const char *const fileName)
+{
+	Assert (Trace.out == NULL);
+
+	Trace.out = mio_new_file (fileName, "w");
+	if (Trace.out == NULL)
+		error (FATAL | PERROR, "cannot open \"%s\"", fileName);
+	Trace.fileName = eStrdup (fileName);
+	Trace.start = getWallClock ();
+
+	/* The name of the process in the viewers, which also saves
+	 * putEvent () from knowing whether an event is the first. */
+	mio_puts (Trace.out, "{\"traceEvents\": [\n"
+			  "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": 1,"
+			  " \"args\": {\"name\": \"ctags\"}}");
+}
+
+extern void closeEventTrace (void)
+{
+	if (Trace.out == NULL)
+		return;
+
+	mio_puts (Trace.out, "\n]}\n");
+	if (mio_unref (Trace.out) != 0)
+		error (WARNING | PERROR, "cannot write \"%s\"", Trace.fileName);
+	Trace.out = NULL;
+	eFree (Trace.fileName);
+	Trace.fileName = NULL;
+}
+
+extern bool isTracingEvents (void)
+{
+	return Trace.out != NULL;
+}
+
+extern void beginTraceEvent (traceCategory category, const char *const name)
+{
+#ifdef HAVE_SYS_SDT_H
+	DTRACE_PROBE2 (ctags, begin, TraceCategoryNames [category], name);
+#endif
+	if (Trace.out)
+		putEvent (category, 'B', name);
+}
+
+extern void endTraceEvent (traceCategory category)
+{
+#ifdef HAVE_SYS_SDT_H
+	DTRACE_PROBE1 (ctags, end, TraceCategoryNames [category]);
+#endif
+	if (Trace.out)
+		putEvent (category, 'E', NULL);
+}
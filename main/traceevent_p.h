@@ -0,0 +1,43 @@
+/*
+*   Copyright (c) 2026, Universal Ctags Team
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License version 2 or (at your option) any later version.
+*
+*   Main part private interface to traceevent.c
+*/
+#ifndef CTAGS_MAIN_TRACEEVENT_PRIVATE_H
+#define CTAGS_MAIN_TRACEEVENT_PRIVATE_H
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"  /* must always come first */
+
+/*
+*   DATA DECLARATIONS
+*/
+typedef enum {
+	TRACE_FILE,			/* parsing an input file */
+	TRACE_PARSER,		/* running the parser function of a language */
+	TRACE_PROMISE,		/* running a guest parser for a promise */
+	TRACE_PHASE,		/* writing the cork queue, sorting the tag file */
+	TRACE_REGEX_TABLE,	/* matching the patterns of a regex table */
+	COUNT_TRACE_CATEGORY
+} traceCategory;
+
+/*
+*   FUNCTION PROTOTYPES
+*/
+
+/* --trace-events=<file> */
+extern void openEventTrace (const char *const fileName);
+extern void closeEventTrace (void);
+extern bool isTracingEvents (void);
+
+/* A pair of these makes a span on the timeline. The spans must nest;
+ * endTraceEvent () ends the span begun last. */
+extern void beginTraceEvent (traceCategory category, const char *const name);
+extern void endTraceEvent (traceCategory category);
+
+#endif  /* CTAGS_MAIN_TRACEEVENT_PRIVATE_H */
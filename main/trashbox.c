@@ -10,6 +10,9 @@
 
 #include "general.h"
 
+#include <string.h>
+
+#include "arena_p.h"
 #include "debug.h"
 #include "routines.h"
 #include "trashbox.h"
@@ -27,6 +30,7 @@ struct sTrashBox {
 
 static TrashBox* defaultTrashBox;
 static TrashBox* parserTrashBox;
+static arena* parserArena;
 
 static Trash* trashPut (Trash* trash, void* item,
 			TrashDestroyItemProc destrctor);
@@ -186,6 +190,8 @@ extern void finiParserTrashBox  (void)
 {
 	trashBoxDelete (parserTrashBox);
 	parserTrashBox = NULL;
+	if (parserArena)
+		arenaReset (parserArena);
 }
 
 extern void* parserTrashBoxPut  (void* item, TrashBoxDestroyItemProc destroy)
@@ -198,6 +204,23 @@ extern TrashBoxDestroyItemProc parserTrashBoxTakeBack  (void* item)
 	return trashBoxTakeBack(parserTrashBox, item);
 }
 
+static void deleteParserArena (void *a)
+{
+	arenaDelete (a);
+	parserArena = NULL;
+}
+
+extern struct sArena* parserTrashBoxArena (void)
+{
+	if (parserArena == NULL)
+	{
+		/* The last chunk is kept for the next input file. */
+		parserArena = arenaNew (16 * 1024);
+		DEFAULT_TRASH_BOX (parserArena, deleteParserArena);
+	}
+	return parserArena;
+}
+
 #ifdef TRASH_TEST
 #include <stdio.h>
 
@@ -244,3 +267,11 @@ void eFree (void *ptr) { free(ptr); }
 void *eMalloc (const size_t size) { return malloc(size); }
 char *eStrdup (const char* str) { return strdup(str); }
 #endif
+
+extern void* parserTrashBoxAlloc (size_t size)
+{
+	void *p = arenaAlloc (parserTrashBoxArena (), size);
+
+	memset (p, 0, size);
+	return p;
+}
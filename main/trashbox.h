@@ -36,6 +36,7 @@ typedef struct sTrashBox TrashBox;
 
 #define PARSER_TRASH_BOX(PTR,PROC) parserTrashBoxPut(PTR,(TrashBoxDestroyItemProc)PROC)
 #define PARSER_TRASH_BOX_TAKE_BACK(PTR) parserTrashBoxTakeBack(PTR)
+#define PARSER_TRASH_BOX_ALLOC(N,TYPE) ((TYPE *) parserTrashBoxAlloc ((N) * sizeof (TYPE)))
 
 
 /*
@@ -63,4 +64,20 @@ extern void      trashBoxMakeEmpty (TrashBox* trash_box);
 extern void* parserTrashBoxPut  (void* item, TrashBoxDestroyItemProc destroy);
 extern TrashBoxDestroyItemProc parserTrashBoxTakeBack  (void* item);
 
+/* An arena is prepared together with the parser trash box. Objects allocated
+ * from it, like vStrings made with vStringNewInArena (), are released all
+ * together when the parser trash box is emptied. Use it for objects living
+ * until the end of the input file; an object made and deleted per token still
+ * should be allocated with malloc.
+ */
+struct sArena;
+extern struct sArena* parserTrashBoxArena (void);
+
+/* Allocates zero-filled memory from the arena of the parser trash box.
+ * Nothing is recorded for the memory, and no destructor is called on it;
+ * it is released when the parser trash box is emptied. Don't pass it to
+ * eFree ().
+ */
+extern void* parserTrashBoxAlloc (size_t size);
+
 #endif /* CTAGS_MAIN_TRASH_H */
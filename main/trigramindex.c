@@ -0,0 +1,284 @@
+/*
+*   Copyright (c) 2026, Universal Ctags Team
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License version 2 or (at your option) any later version.
+*
+*   This module implements --trigram-index option: writing an index of
+*   the trigrams in the names of a tag file.
+*
+*   A reader looking for the names containing a string can do neither
+*   a binary search nor a lookup in the name index; it must read all the
+*   tag lines. The trigram index records, for each sequence of three
+*   bytes in the names, the tag lines whose names contain it. A reader
+*   intersects the lists of the trigrams in the string, and reads only
+*   the tag lines in the intersection.
+*
+*   The index is written to the file made by appending TRIGRAM_INDEX_SUFFIX
+*   to the tag file name. The TAG_TRIGRAM_INDEX pseudo tag in the tag file
+*   refers to it. The format of the index file is:
+*
+*	!_CTAGS_TRIGRAM_INDEX<TAB>1<TAB>size<TAB>lines<TAB>trigrams<NL>
+*	the offsets of the tag lines
+*	the table of the trigrams
+*	the postings of the trigrams
+*
+*   "size" is the size of the tag file. A reader uses the index only if
+*   it matches the tag file. "lines" is the number of the tag lines; the
+*   pseudo tags are not counted. The offsets of the tag lines follow as
+*   the differences between adjacent offsets. "trigrams" is the number of
+*   the entries in the table of the trigrams. An entry is the difference
+*   between its trigram and the previous one, the number of the lines in
+*   the postings of the trigram, and the size in bytes of the postings.
+*   The postings of a trigram are the differences between adjacent
+*   numbers of the lines, in the order of the table.
+*
+*   All numbers after the first line are unsigned LEB128 varints. A
+*   trigram is the three bytes, in lower case for ASCII letters, of the
+*   name as it is written in the tag line, as a 24 bit big endian number.
+*/
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"  /* must always come first */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "entry_p.h"
+#include "htable.h"
+#include "mio.h"
+#include "numarray.h"
+#include "options_p.h"
+#include "ptag_p.h"
+#include "ptrarray.h"
+#include "read.h"
+#include "routines.h"
+#include "trigramindex_p.h"
+#include "vstring.h"
+
+/*
+*   DATA DECLARATIONS
+*/
+#define TRIGRAM_INDEX_MAGIC "!_CTAGS_TRIGRAM_INDEX"
+#define TRIGRAM_INDEX_VERSION 1
+#define TRIGRAM_INDEX_SUFFIX ".tri"
+
+typedef struct {
+	unsigned int trigram;
+	unsigned long lines;
+	unsigned long last;
+	ucharArray *postings;
+} trigramEntry;
+
+/*
+*   FUNCTION DEFINITIONS
+*/
+
+static void putVarint (MIO *mio, unsigned long n)
+{
+	while (n >= 0x80)
+	{
+		mio_putc (mio, (int) ((n & 0x7f) | 0x80));
+		n >>= 7;
+	}
+	mio_putc (mio, (int) n);
+}
+
+static void addVarint (ucharArray *a, unsigned long n)
+{
+	while (n >= 0x80)
+	{
+		ucharArrayAdd (a, (unsigned char) ((n & 0x7f) | 0x80));
+		n >>= 7;
+	}
+	ucharArrayAdd (a, (unsigned char) n);
+}
+
+static unsigned int foldByte (const char c)
+{
+	const unsigned char b = (unsigned char) c;
+	return (b >= 'A' && b <= 'Z')? b - 'A' + 'a': b;
+}
+
+static void deleteTrigramEntry (void *data)
+{
+	trigramEntry *e = data;
+
+	ucharArrayDelete (e->postings);
+	eFree (e);
+}
+
+static void addTrigrams (hashTable *table, const char *name, size_t length,
+						 unsigned long line)
+{
+	for (size_t i = 0; i + 3 <= length; i++)
+	{
+		unsigned int trigram = (foldByte (name [i]) << 16)
+			| (foldByte (name [i + 1]) << 8)
+			| foldByte (name [i + 2]);
+		trigramEntry *e = hashTableGetItem (table, &trigram);
+
+		if (e == NULL)
+		{
+			e = xMalloc (1, trigramEntry);
+			e->trigram = trigram;
+			e->lines = 0;
+			e->last = 0;
+			e->postings = ucharArrayNew ();
+			hashTablePutItem (table, &e->trigram, e);
+		}
+		else if (e->lines > 0 && e->last == line)
+			continue;   /* the trigram appears twice in the name */
+
+		addVarint (e->postings, line - e->last);
+		e->last = line;
+		e->lines++;
+	}
+}
+
+static bool collectTrigramEntry (const void *key CTAGS_ATTR_UNUSED,
+								 void *value, void *user_data)
+{
+	ptrArrayAdd (user_data, value);
+	return true;
+}
+
+static int compareTrigramEntries (const void *a, const void *b)
+{
+	const trigramEntry *ea = a;
+	const trigramEntry *eb = b;
+
+	return (ea->trigram > eb->trigram) - (ea->trigram < eb->trigram);
+}
+
+static bool writeIndexFile (MIO *const in, const char *const indexFileName)
+{
+	MIO *out;
+	vString *line = vStringNew ();
+	ulongArray *offsets = ulongArrayNew ();
+	hashTable *table = hashTableNew (4096, hashInthash, hashInteq,
+									 NULL, deleteTrigramEntry);
+	ptrArray *entries = ptrArrayNew (NULL);
+	long size;
+	unsigned long previous = 0;
+	unsigned int previousTrigram = 0;
+	bool ok;
+
+	mio_seek (in, 0L, SEEK_END);
+	size = mio_tell (in);
+	mio_seek (in, 0L, SEEK_SET);
+
+	while (true)
+	{
+		const long offset = mio_tell (in);
+		const char *l;
+		const char *tab;
+
+		if (readLineRaw (line, in) == NULL)
+			break;
+
+		l = vStringValue (line);
+		if (strncmp (l, PSEUDO_TAG_PREFIX, strlen (PSEUDO_TAG_PREFIX)) == 0)
+			continue;
+		tab = strchr (l, '\t');
+		if (tab == NULL)
+			continue;
+
+		addTrigrams (table, l, tab - l, ulongArrayCount (offsets));
+		ulongArrayAdd (offsets, (unsigned long) offset);
+	}
+	vStringDelete (line);
+
+	hashTableForeachItem (table, collectTrigramEntry, entries);
+	ptrArraySort (entries, compareTrigramEntries);
+
+	out = mio_new_file (indexFileName, "wb");
+	ok = (out != NULL);
+	if (ok)
+		ok = (mio_printf (out, "%s\t%d\t%ld\t%u\t%u\n", TRIGRAM_INDEX_MAGIC,
+						  TRIGRAM_INDEX_VERSION, size,
+						  ulongArrayCount (offsets),
+						  ptrArrayCount (entries)) >= 0);
+	for (unsigned int i = 0; ok && i < ulongArrayCount (offsets); i++)
+	{
+		const unsigned long offset = ulongArrayItem (offsets, i);
+		putVarint (out, offset - previous);
+		previous = offset;
+	}
+	for (unsigned int i = 0; ok && i < ptrArrayCount (entries); i++)
+	{
+		const trigramEntry *e = ptrArrayItem (entries, i);
+		putVarint (out, e->trigram - previousTrigram);
+		putVarint (out, e->lines);
+		putVarint (out, ucharArrayCount (e->postings));
+		previousTrigram = e->trigram;
+	}
+	for (unsigned int i = 0; ok && i < ptrArrayCount (entries); i++)
+	{
+		const trigramEntry *e = ptrArrayItem (entries, i);
+		const unsigned int count = ucharArrayCount (e->postings);
+		for (unsigned int j = 0; j < count; j++)
+			mio_putc (out, ucharArrayItem (e->postings, j));
+	}
+
+	if (out && mio_unref (out) != 0)
+		ok = false;
+	ptrArrayDelete (entries);
+	hashTableDelete (table);
+	ulongArrayDelete (offsets);
+	return ok;
+}
+
+extern void writeTrigramIndex (const char *const tagFileName)
+{
+	MIO *in = mio_new_file (tagFileName, "rb");
+	vString *indexFileName;
+	vString *tmp;
+
+	if (in == NULL)
+	{
+		error (WARNING | PERROR, "cannot read tag file \"%s\" for the trigram index",
+			   tagFileName);
+		return;
+	}
+
+	indexFileName = vStringNewInit (tagFileName);
+	vStringCatS (indexFileName, TRIGRAM_INDEX_SUFFIX);
+
+	/* Write to a temporary file first not to leave a broken index. */
+	tmp = vStringNewCopy (indexFileName);
+	vStringCatS (tmp, ".tmp");
+
+	verbose ("writing trigram index \"%s\"\n", vStringValue (indexFileName));
+	if (! writeIndexFile (in, vStringValue (tmp))
+		|| rename (vStringValue (tmp), vStringValue (indexFileName)) != 0)
+	{
+		error (WARNING | PERROR, "cannot write trigram index \"%s\"",
+			   vStringValue (indexFileName));
+		remove (vStringValue (tmp));
+	}
+
+	mio_unref (in);
+	vStringDelete (tmp);
+	vStringDelete (indexFileName);
+}
+
+extern bool ptagMakeTrigramIndex (ptagDesc *desc, langType language CTAGS_ATTR_UNUSED,
+								  const void *data)
+{
+	const optionValues *opt = data;
+	vString *name;
+	bool r;
+
+	if (! opt->trigramIndex)
+		return false;
+
+	name = vStringNewInit (baseFilename (opt->tagFileName));
+	vStringCatS (name, TRIGRAM_INDEX_SUFFIX);
+	r = writePseudoTag (desc, vStringValue (name),
+						"index of trigrams in names", NULL);
+	vStringDelete (name);
+	return r;
+}
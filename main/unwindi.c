@@ -22,8 +22,6 @@
 #include "gcc-attr.h"
 #include "inline.h"
 #include "mio.h"
-#include "objpool.h"
-#include "ptrarray.h"
 #include "read.h"
 #include "routines.h"
 #include "trashbox.h"
@@ -40,101 +38,92 @@ typedef struct sUugcChar {
 	unsigned long lineNumber;
 } uugcChar;
 
-
-static ptrArray *uugcInputFile;
-static uugcChar *uugcCurrentChar;
-static objPool  *uugcCharPool;
+/* The chars read since the first marker was set and the chars pushed
+ * back, held by value in one array: the input stream unwinds a char
+ * or reads it again for nearly every char of the input file.
+ *
+ * chars [0, pos) are the chars read under the markers, the one read
+ * last at pos - 1; while no marker is set, they are not used anymore.
+ * chars [pos, count) are the chars pushed back, in the order to read
+ * them again. Unwinding N chars is just moving pos back by N. */
+typedef struct sUugcBuffer {
+	uugcChar *chars;
+	unsigned int pos;
+	unsigned int count;
+	unsigned int size;
+} uugcBuffer;
+
+static uugcBuffer uwiBuffer;
+/* Whether the char read last is at pos - 1 of uwiBuffer. It is
+ * remembered only while a marker is set. */
+static bool uugcHasCurrentChar;
 
 static struct sUwiStats uwiStats;
 
-static void deleteChar (void *c)
-{
-	eFree (c);
-}
-
-static void* newChar (void *data CTAGS_ATTR_UNUSED)
-{
-	return xMalloc (1, uugcChar);
-}
+static unsigned int *uwiMarkerStack;
+static unsigned int uwiMarkerStackLength;
+static unsigned int *uwiCurrentMarker;
+static bool uwiStacksInTrashBox;
 
-CTAGS_INLINE void uugcDeleteC (uugcChar *c)
+static void uugcBufferReserve (unsigned int n)
 {
-	if (c == uugcCurrentChar)
-		uugcCurrentChar = NULL;
-
-	objPoolPut (uugcCharPool, c);
+	if (uwiBuffer.count + n > uwiBuffer.size)
+	{
+		while (uwiBuffer.count + n > uwiBuffer.size)
+			uwiBuffer.size = uwiBuffer.size? uwiBuffer.size * 2: 256;
+		uwiBuffer.chars = xRealloc (uwiBuffer.chars, uwiBuffer.size, uugcChar);
+	}
 }
 
-static void uugcActivate (void)
+/* Inserts the char C at pos, as the one to read next. */
+static void uugcBufferInsert (uugcChar c)
 {
-	Assert (!uugcInputFile);
-	Assert (!uugcCurrentChar);
-
-	if (uugcCharPool == NULL)
+	if (uwiBuffer.pos > 0 && !uwiCurrentMarker)
 	{
-		uugcCharPool = objPoolNew(256,
-								  newChar,
-								  deleteChar,
-								  NULL,
-								  NULL);
-		DEFAULT_TRASH_BOX(uugcCharPool, objPoolDelete);
+		/* The char there is not used anymore. */
+		uwiBuffer.chars [--uwiBuffer.pos] = c;
+		return;
 	}
 
-	uugcInputFile = ptrArrayNew ((ptrArrayDeleteFunc)uugcDeleteC);
+	uugcBufferReserve (1);
+	memmove (uwiBuffer.chars + uwiBuffer.pos + 1, uwiBuffer.chars + uwiBuffer.pos,
+			 (uwiBuffer.count - uwiBuffer.pos) * sizeof (uugcChar));
+	uwiBuffer.chars [uwiBuffer.pos] = c;
+	uwiBuffer.count++;
 }
 
-static void uugcDeactive(void)
+static void uugcActivate (void)
 {
-	Assert (uugcInputFile);
-	ptrArrayDelete (uugcInputFile);
-	uugcInputFile = NULL;
-	uugcCurrentChar = NULL;
+	Assert (uwiBuffer.count == 0);
+	Assert (!uugcHasCurrentChar);
 }
 
-CTAGS_INLINE uugcChar *uugcNewC (int chr, unsigned long ln)
+static void uugcDeactive(void)
 {
-	Assert (uugcCharPool);
-
-	uugcChar *c = objPoolGet (uugcCharPool);
-	c->c = chr;
-	c->lineNumber = ln;
-	return c;
+	uwiBuffer.pos = 0;
+	uwiBuffer.count = 0;
+	uugcHasCurrentChar = false;
 }
 
-CTAGS_INLINE uugcChar *uugciGetC (void)
+CTAGS_INLINE uugcChar uugciGetC (void)
 {
-	uugcChar *c;
-
-	Assert (uugcInputFile);
+	uugcChar c;
 
-	if (ptrArrayCount (uugcInputFile) > 0)
-	{
-		c = ptrArrayLast (uugcInputFile);
-		ptrArrayRemoveLast (uugcInputFile);
-	}
+	if (uwiBuffer.pos < uwiBuffer.count)
+		c = uwiBuffer.chars [uwiBuffer.pos++];
 	else
 	{
-		unsigned long lineNumber = getInputLineNumber ();
-		int chr = getcFromInputFile();
-		c = uugcNewC (chr, lineNumber);
+		c.lineNumber = getInputLineNumber ();
+		c.c = getcFromInputFile();
+		if (uwiCurrentMarker)
+		{
+			uugcBufferReserve (1);
+			uwiBuffer.chars [uwiBuffer.count++] = c;
+			uwiBuffer.pos = uwiBuffer.count;
+		}
 	}
 
-	uugcCurrentChar = c;
-	return uugcCurrentChar;
-}
-
-CTAGS_INLINE void uugcUngetC (uugcChar *c)
-{
-	uugcCurrentChar = NULL;
-
-	if (c->c == EOF)
-	{
-		ptrArrayClear (uugcInputFile);
-		uugcDeleteC (c);
-		return;
-	}
-
-	ptrArrayAdd (uugcInputFile, c);
+	return c;
 }
 
 CTAGS_INLINE void uugcInjectC (int chr)
@@ -142,9 +131,8 @@ CTAGS_INLINE void uugcInjectC (int chr)
 	if (chr == EOF)
 		return;
 
-	uugcChar *lastc = NULL;
-	if (ptrArrayCount (uugcInputFile) > 0)
-		lastc = ptrArrayLast (uugcInputFile);
+	uugcChar *lastc = (uwiBuffer.pos < uwiBuffer.count)
+		? uwiBuffer.chars + uwiBuffer.pos: NULL;
 
 	unsigned long lineNumber;
 	if (lastc)
@@ -161,63 +149,65 @@ CTAGS_INLINE void uugcInjectC (int chr)
 			lineNumber--;
 	}
 
-	uugcChar *c = uugcNewC(chr, lineNumber);
-	uugcUngetC (c);
+	uugcChar c = { .c = chr, .lineNumber = lineNumber };
+	uugcHasCurrentChar = false;
+	uugcBufferInsert (c);
 }
 
 CTAGS_INLINE long uugcGetLineNumber ()
 {
-	Assert (uugcInputFile);
-
-	if (uugcCurrentChar)
+	if (uugcHasCurrentChar)
 	{
+		uugcChar *c = uwiBuffer.chars + uwiBuffer.pos - 1;
 		unsigned long ln;
-		if (uugcCurrentChar->c == '\n')
-			ln = uugcCurrentChar->lineNumber + 1;
+		if (c->c == '\n')
+			ln = c->lineNumber + 1;
 		else
-			ln = uugcCurrentChar->lineNumber;
+			ln = c->lineNumber;
 		return ln;
 	}
-	else if (ptrArrayCount (uugcInputFile) > 0)
-	{
-		uugcChar *c = ptrArrayLast (uugcInputFile);
-		return c->lineNumber;
-	}
+	else if (uwiBuffer.pos < uwiBuffer.count)
+		return uwiBuffer.chars [uwiBuffer.pos].lineNumber;
 	else
 		return getInputLineNumber ();
 }
 
 CTAGS_INLINE MIOPos uugcGetFilePosition (void)
 {
-	if (uugcCurrentChar)
+	if (uugcHasCurrentChar)
 	{
+		uugcChar *c = uwiBuffer.chars + uwiBuffer.pos - 1;
 		unsigned long ln;
-		if (uugcCurrentChar->c == '\n')
-			ln = uugcCurrentChar->lineNumber + 1;
+		if (c->c == '\n')
+			ln = c->lineNumber + 1;
 		else
-			ln = uugcCurrentChar->lineNumber;
+			ln = c->lineNumber;
 		return getInputFilePositionForLine (ln);
 	}
-	else if (ptrArrayCount (uugcInputFile) > 0)
-	{
-		uugcChar *c = ptrArrayLast (uugcInputFile);
-		return getInputFilePositionForLine (c->lineNumber);
-	}
+	else if (uwiBuffer.pos < uwiBuffer.count)
+		return getInputFilePositionForLine (uwiBuffer.chars [uwiBuffer.pos].lineNumber);
 	else
 		return getInputFilePosition ();
 }
 
-static ptrArray *uwiBuffer;
-static unsigned int *uwiMarkerStack;
-static unsigned int uwiMarkerStackLength;
-static unsigned int *uwiCurrentMarker;
+static void deleteUwiStacks (void *data CTAGS_ATTR_UNUSED)
+{
+	if (uwiBuffer.chars)
+		eFree (uwiBuffer.chars);
+	memset (&uwiBuffer, 0, sizeof (uwiBuffer));
+}
 
 extern void uwiActivate (unsigned int stackLength)
 {
 	Assert (stackLength > 0);
 
+	if (!uwiStacksInTrashBox)
+	{
+		DEFAULT_TRASH_BOX (&uwiBuffer, deleteUwiStacks);
+		uwiStacksInTrashBox = true;
+	}
+
 	uugcActivate ();
-	uwiBuffer = ptrArrayNew ((ptrArrayDeleteFunc)uugcDeleteC);
 	uwiMarkerStackLength = stackLength;
 	uwiMarkerStack = xMalloc (stackLength, unsigned int);
 	uwiCurrentMarker = NULL;
@@ -227,7 +217,6 @@ extern void uwiActivate (unsigned int stackLength)
 
 extern void uwiDeactivate (struct sUwiStats *statsToBeUpdated)
 {
-	Assert (uwiBuffer);
 	Assert (uwiMarkerStack);
 
 	if (statsToBeUpdated)
@@ -240,9 +229,7 @@ extern void uwiDeactivate (struct sUwiStats *statsToBeUpdated)
 			statsToBeUpdated->underflow = uwiStats.underflow;
 	}
 
-	ptrArrayDelete (uwiBuffer);
 	eFree (uwiMarkerStack);
-	uwiBuffer = NULL;
 	uwiMarkerStack = NULL;
 	uwiMarkerStackLength = 0;
 	uugcDeactive();
@@ -250,23 +237,21 @@ extern void uwiDeactivate (struct sUwiStats *statsToBeUpdated)
 
 extern int uwiGetC ()
 {
-	int c;
-	uugcChar *chr = uugciGetC ();
-
-	c = chr->c;
+	uugcChar chr = uugciGetC ();
 
 	if (uwiCurrentMarker)
 	{
 		*uwiCurrentMarker += 1;
-		ptrArrayAdd (uwiBuffer, chr);
+		uugcHasCurrentChar = true;
 	}
 	else
 	{
-		uugcCurrentChar = NULL;
-		uugcDeleteC (chr);
+		uugcHasCurrentChar = false;
+		if (uwiBuffer.pos == uwiBuffer.count)
+			uwiBuffer.pos = uwiBuffer.count = 0;
 	}
 
-	return c;
+	return chr.c;
 }
 
 extern void uwiUngetC (int c)
@@ -275,6 +260,27 @@ extern void uwiUngetC (int c)
 	uugcInjectC (c);
 }
 
+extern int uwiPeekC (void)
+{
+	unsigned long lineNumber;
+	int c;
+
+	uugcHasCurrentChar = false;
+	if (uwiBuffer.pos < uwiBuffer.count)
+		return uwiBuffer.chars [uwiBuffer.pos].c;
+
+	lineNumber = getInputLineNumber ();
+	c = getcFromInputFile ();
+	if (c != EOF)
+	{
+		uugcChar chr = { .c = c, .lineNumber = lineNumber };
+
+		uugcBufferReserve (1);
+		uwiBuffer.chars [uwiBuffer.count++] = chr;
+	}
+	return c;
+}
+
 extern unsigned long uwiGetLineNumber (void)
 {
 	return uugcGetLineNumber ();
@@ -300,7 +306,18 @@ extern void uwiPushMarker (void)
 	}
 
 	if (uwiCurrentMarker) uwiCurrentMarker++;
-	else uwiCurrentMarker = uwiMarkerStack;
+	else
+	{
+		/* Drop the chars read under the markers popped already. */
+		if (uwiBuffer.pos > 0)
+		{
+			memmove (uwiBuffer.chars, uwiBuffer.chars + uwiBuffer.pos,
+					 (uwiBuffer.count - uwiBuffer.pos) * sizeof (uugcChar));
+			uwiBuffer.count -= uwiBuffer.pos;
+			uwiBuffer.pos = 0;
+		}
+		uwiCurrentMarker = uwiMarkerStack;
+	}
 
 	*uwiCurrentMarker = 0;
 }
@@ -327,13 +344,31 @@ extern void uwiClearMarker (const int upto, const bool revertChars)
 {
 	Assert (uwiCurrentMarker);
 	int count = (upto <= 0)? *uwiCurrentMarker : upto;
-	void (*charHandler)(uugcChar *) = revertChars ? uugcUngetC : uugcDeleteC;
 
-	while (count-- > 0)
+	if (count <= 0)
+		return;
+
+	Assert ((unsigned int) count <= uwiBuffer.pos);
+	uugcHasCurrentChar = false;
+	*uwiCurrentMarker -= count;
+	uwiBuffer.pos -= count;
+	if (revertChars)
+	{
+		/* EOF is not pushed back; nor the chars read after it. */
+		for (unsigned int i = uwiBuffer.pos; i < uwiBuffer.pos + count; i++)
+		{
+			if (uwiBuffer.chars [i].c == EOF)
+			{
+				uwiBuffer.count = i;
+				break;
+			}
+		}
+	}
+	else
 	{
-		charHandler (ptrArrayLast (uwiBuffer));
-		ptrArrayRemoveLast (uwiBuffer);
-		*uwiCurrentMarker -= 1;
+		memmove (uwiBuffer.chars + uwiBuffer.pos, uwiBuffer.chars + uwiBuffer.pos + count,
+				 (uwiBuffer.count - uwiBuffer.pos - count) * sizeof (uugcChar));
+		uwiBuffer.count -= count;
 	}
 }
 
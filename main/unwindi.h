@@ -74,6 +74,9 @@ extern void uwiStatsPrint (struct sUwiStats *stats);
 
 extern int uwiGetC (void);
 extern void uwiUngetC (int c);
+/* Returns the character uwiGetC () will return next, without reading it;
+   the same as reading it under a marker popped at once. */
+extern int uwiPeekC (void);
 extern unsigned long uwiGetLineNumber (void);
 extern MIOPos uwiGetFilePosition (void);
 
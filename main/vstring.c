@@ -16,15 +16,17 @@
 #include <string.h>
 #include <ctype.h>
 
+#include "arena_p.h"
 #include "debug.h"
 #include "routines.h"
+#include "routines_p.h"
 #include "vstring.h"
 #include "trashbox.h"
 
 /*
 *   DATA DEFINITIONS
 */
-static const size_t vStringInitialSize = 32;
+static const size_t vStringInitialSize = VSTRING_INLINE_SIZE;
 
 /*
 *   FUNCTION DEFINITIONS
@@ -43,8 +45,19 @@ extern void vStringResize (vString *const string, const size_t newSize)
 
 	if (size > string->size)
 	{
+		if (string->buffer == string->inlineBuffer || string->arena)
+		{
+			/* The old buffer is not released with eFree (). */
+			char *buffer = string->arena
+				? arenaAlloc (string->arena, size)
+				: xMalloc (size, char);
+
+			memcpy (buffer, string->buffer, string->size);
+			string->buffer = buffer;
+		}
+		else
+			string->buffer = xRealloc (string->buffer, size, char);
 		string->size = size;
-		string->buffer = xRealloc (string->buffer, size, char);
 	}
 }
 
@@ -59,27 +72,53 @@ extern void vStringTruncate (vString *const string, const size_t length)
 
 extern void vStringDelete (vString *const string)
 {
-	if (string != NULL)
+	if (string != NULL && string->arena == NULL)
 	{
-		if (string->buffer != NULL)
+		if (string->buffer != string->inlineBuffer)
 			eFree (string->buffer);
 		eFree (string);
 	}
 }
 
-extern vString *vStringNew (void)
+static void initString (vString *const string, struct sArena *arena)
 {
-	vString *const string = xMalloc (1, vString);
-
 	string->length = 0;
 	string->size   = vStringInitialSize;
-	string->buffer = xMalloc (string->size, char);
+	string->buffer = string->inlineBuffer;
+	string->arena  = arena;
 
 	vStringClear (string);
+}
+
+extern vString *vStringNew (void)
+{
+	vString *const string = xMalloc (1, vString);
 
+	initString (string, NULL);
 	return string;
 }
 
+extern vString *vStringNewInArena (struct sArena *arena)
+{
+	vString *const string = arenaAlloc (arena, sizeof (vString));
+
+	initString (string, arena);
+	return string;
+}
+
+extern void vStringInit (vString *const string)
+{
+	initString (string, NULL);
+}
+
+extern void vStringFini (vString *const string)
+{
+	Assert (string->arena == NULL);
+	if (string->buffer != string->inlineBuffer)
+		eFree (string->buffer);
+	initString (string, NULL);
+}
+
 extern vString *vStringNewCopy (const vString *const string)
 {
 	vString *vs = vStringNew ();
@@ -124,9 +163,10 @@ extern void vStringNCat (
 extern void vStringNCatS (
 		vString *const string, const char *const s, const size_t length)
 {
-	size_t len = strlen (s);
+	/* S may be a part of a mapped input not terminated with NUL. */
+	const char *nul = memchr (s, '\0', length);
+	size_t len = nul ? (size_t) (nul - s) : length;
 
-	len = len < length ? len : length;
 	stringCat (string, s, len);
 }
 
@@ -274,13 +314,14 @@ extern char    *vStringDeleteUnwrap       (vString *const string)
 
 	if (string != NULL)
 	{
-		buffer = string->buffer;
-		string->buffer = NULL;
-
-		string->size = 0;
-		string->length = 0;
-
-		eFree (string);
+		if (string->buffer == string->inlineBuffer || string->arena)
+			buffer = vStringStrdup (string);
+		else
+		{
+			buffer = string->buffer;
+			string->buffer = string->inlineBuffer;
+		}
+		vStringDelete (string);
 	}
 
 	return buffer;
@@ -306,8 +347,17 @@ static char valueToXDigit (int v)
 
 extern void vStringCatSWithEscaping (vString* b, const char *s)
 {
-	for(; *s; s++)
+	const char *const end = s + strlen (s);
+
+	for(; s < end; s++)
 	{
+		size_t n = countPlainBytes (s, end - s);
+
+		vStringNCatSUnsafe (b, s, n);
+		s += n;
+		if (s == end)
+			break;
+
 		int c = *s;
 
 		/* escape control characters (incl. \t) */
@@ -349,6 +399,10 @@ extern void vStringCatSWithEscapingAsPattern (vString *output, const char* input
 {
 	while (*input)
 	{
+		size_t n = strcspn (input, "\\/");
+
+		vStringNCatSUnsafe (output, input, n);
+		input += n;
 		switch (*input)
 		{
 		case '\\':
@@ -360,9 +414,7 @@ extern void vStringCatSWithEscapingAsPattern (vString *output, const char* input
 			vStringPut(output, '/');
 			break;
 		default:
-			vStringPut(output, *input);
-			break;
-
+			return;
 		}
 		input++;
 	}
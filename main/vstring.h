@@ -43,10 +43,17 @@
 *   DATA DECLARATIONS
 */
 
+/* A string shorter than this is stored in the vString itself. */
+#define VSTRING_INLINE_SIZE 32
+
+struct sArena;
+
 typedef struct sVString {
 	size_t  length;  /* size of buffer used */
 	size_t  size;    /* allocated size of buffer */
-	char   *buffer;  /* location of buffer */
+	char   *buffer;  /* location of buffer: inlineBuffer or a heap block */
+	struct sArena *arena;  /* the arena the vString is allocated from, or NULL */
+	char    inlineBuffer [VSTRING_INLINE_SIZE];
 } vString;
 
 /*
@@ -54,6 +61,17 @@ typedef struct sVString {
 */
 extern void vStringResize (vString *const string, const size_t newSize);
 extern vString *vStringNew (void);
+
+/* The vString and its buffer are allocated from ARENA, and are released
+ * together with the arena. vStringDelete () does nothing on the vString.
+ * See parserTrashBoxArena () in trashbox.h for an arena a parser can use. */
+extern vString *vStringNewInArena (struct sArena *arena);
+
+/* For a vString embedded in another object. vStringInit () makes STRING
+ * an empty string, and vStringFini () releases the buffer allocated for
+ * STRING, leaving it empty. */
+extern void vStringInit (vString *const string);
+extern void vStringFini (vString *const string);
 extern void vStringDelete (vString *const string);
 extern bool vStringStripNewline (vString *const string);
 extern void vStringStripLeading (vString *const string);
@@ -0,0 +1,424 @@
+/*
+*   Copyright (c) 2026, Universal Ctags Team
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License version 2 or (at your option) any later version.
+*
+*   This module implements the watch command of the interactive mode.
+*
+*   A directory tree is watched with inotify. Change notifications are
+*   collected for a while and handled as a batch: each touched file is
+*   parsed again, and the tags added to or removed from the file since
+*   the last batch are reported as a delta. The tags of the files are
+*   kept in memory to compute the deltas.
+*/
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"  /* must always come first */
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+
+#ifdef HAVE_SYS_INOTIFY_H
+# include <sys/inotify.h>
+# include <poll.h>
+# include <dirent.h>
+# include <unistd.h>
+#endif
+
+#include "debug.h"
+#include "entry_p.h"
+#include "htable.h"
+#include "numarray.h"
+#include "options_p.h"
+#include "parse_p.h"
+#include "routines.h"
+#include "routines_p.h"
+#include "strlist.h"
+#include "vstring.h"
+#include "watch_p.h"
+
+#ifdef HAVE_SYS_INOTIFY_H
+
+/*
+*   DATA DECLARATIONS
+*/
+#define WATCH_EVENTS (IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM	\
+					  | IN_CREATE | IN_DELETE)
+
+typedef struct sWatchState {
+	int fd;
+	hashTable *dirs;		/* watch descriptor -> directory name */
+	hashTable *tags;		/* file name -> stringList of tag lines */
+	stringList *touched;	/* files to be parsed in the next batch */
+	hashTable *touchedTable;
+	FILE *out;
+} watchState;
+
+/*
+*   FUNCTION DEFINITIONS
+*/
+
+static void catJsonString (vString *out, const char *s)
+{
+	vStringPut (out, '"');
+	for (; *s; s++)
+	{
+		unsigned char c = (unsigned char) *s;
+
+		if (c == '"' || c == '\\')
+		{
+			vStringPut (out, '\\');
+			vStringPut (out, c);
+		}
+		else if (c < 0x20)
+		{
+			char buf [7];
+			snprintf (buf, sizeof (buf), "\\u%04x", c);
+			vStringCatS (out, buf);
+		}
+		else
+			vStringPut (out, c);
+	}
+	vStringPut (out, '"');
+}
+
+static void markTouched (watchState *state, const char *const fileName)
+{
+	if (hashTableHasItem (state->touchedTable, fileName))
+		return;
+
+	vString *name = vStringNewInit (fileName);
+	stringListAdd (state->touched, name);
+	hashTablePutItem (state->touchedTable, vStringValue (name), name);
+}
+
+static void addWatchRecursively (watchState *state, const char *const dirName)
+{
+	int wd = inotify_add_watch (state->fd, dirName, WATCH_EVENTS);
+	DIR *dir;
+	struct dirent *entry;
+
+	if (wd < 0)
+	{
+		error (WARNING | PERROR, "cannot watch directory \"%s\"", dirName);
+		return;
+	}
+	if (! hashTableUpdateItem (state->dirs, &wd, eStrdup (dirName)))
+	{
+		int *key = xMalloc (1, int);
+		*key = wd;
+		hashTablePutItem (state->dirs, key, eStrdup (dirName));
+	}
+
+	dir = opendir (dirName);
+	if (dir == NULL)
+		return;
+
+	while ((entry = readdir (dir)) != NULL)
+	{
+		if (strcmp (entry->d_name, ".") == 0 || strcmp (entry->d_name, "..") == 0)
+			continue;
+
+		char *path = combinePathAndFile (dirName, entry->d_name);
+		fileStatus *status = eStat (path);
+
+		if (isExcludedFile (path, true)
+			|| (status->isSymbolicLink && ! Option.followLinks))
+			;
+		else if (status->isDirectory)
+			addWatchRecursively (state, path);
+		else if (status->isNormalFile)
+			markTouched (state, path);
+
+		eStatFree (status);
+		eFree (path);
+	}
+	closedir (dir);
+}
+
+static bool isUnder (const char *fileName, const char *dirName)
+{
+	size_t len = strlen (dirName);
+
+	return (strncmp (fileName, dirName, len) == 0
+			&& (fileName [len] == '\0' || fileName [len] == '/'));
+}
+
+/* A removed directory: all the files known under it are touched. */
+static bool markTouchedUnder (const void *key, void *value CTAGS_ATTR_UNUSED,
+							  void *user_data)
+{
+	void **args = user_data;
+	watchState *state = args [0];
+	const char *dirName = args [1];
+	const char *fileName = key;
+
+	if (isUnder (fileName, dirName))
+		markTouched (state, fileName);
+	return true;
+}
+
+static bool collectWatchesUnder (const void *key, void *value, void *user_data)
+{
+	void **args = user_data;
+
+	if (isUnder (value, args [1]))
+		intArrayAdd (args [0], *(const int *) key);
+	return true;
+}
+
+/* A directory moved away: its watches name the old paths. */
+static void removeWatchesUnder (watchState *state, const char *const dirName)
+{
+	intArray *wds = intArrayNew ();
+	void *args [2] = { wds, (void *) dirName };
+
+	hashTableForeachItem (state->dirs, collectWatchesUnder, args);
+	for (unsigned int i = 0; i < intArrayCount (wds); i++)
+	{
+		int wd = intArrayItem (wds, i);
+		inotify_rm_watch (state->fd, wd);
+		hashTableDeleteItem (state->dirs, &wd);
+	}
+	intArrayDelete (wds);
+}
+
+static void readEvents (watchState *state)
+{
+	/* The union aligns the buffer for struct inotify_event. */
+	union {
+		struct inotify_event event;
+		char buf [4096];
+	} u;
+	char *buf = u.buf;
+	ssize_t len = read (state->fd, buf, sizeof (u.buf));
+
+	for (char *p = buf; len > 0 && p < buf + len; )
+	{
+		const struct inotify_event *event = (const struct inotify_event *) p;
+		const char *dirName = hashTableGetItem (state->dirs, &event->wd);
+
+		p += sizeof (struct inotify_event) + event->len;
+
+		if (event->mask & IN_IGNORED)
+		{
+			hashTableDeleteItem (state->dirs, &event->wd);
+			continue;
+		}
+		if (dirName == NULL || event->len == 0)
+			continue;
+
+		char *path = combinePathAndFile (dirName, event->name);
+		if (event->mask & IN_ISDIR)
+		{
+			if (event->mask & (IN_CREATE | IN_MOVED_TO))
+				addWatchRecursively (state, path);
+			else if (event->mask & (IN_DELETE | IN_MOVED_FROM))
+			{
+				void *args [2] = { state, path };
+				hashTableForeachItem (state->tags, markTouchedUnder, args);
+				if (event->mask & IN_MOVED_FROM)
+					removeWatchesUnder (state, path);
+			}
+		}
+		else if (! (event->mask & IN_CREATE))
+			/* A created file is handled when it is closed. */
+			markTouched (state, path);
+		eFree (path);
+	}
+}
+
+static bool isPseudoTagLine (const char *line)
+{
+	return (strncmp (line, "!_", 2) == 0
+			|| strncmp (line, "{\"_type\": \"ptag\"", 16) == 0);
+}
+
+/* Parses fileName and returns the tag lines. The lines are removed from
+ * the tag file. */
+static stringList *captureTags (const char *const fileName)
+{
+	stringList *lines = stringListNew ();
+	vString *buf = vStringNew ();
+	MIOPos pos;
+	long offset;
+
+	tagFilePosition (&pos);
+	offset = getTagFileOffset ();
+	parseFile (fileName);
+	readTagFileRange (offset, buf);
+	setTagFilePosition (&pos, true);
+
+	const char *p = vStringValue (buf);
+	const char *end = p + vStringLength (buf);
+	while (p < end)
+	{
+		const char *eol = memchr (p, '\n', end - p);
+		size_t len = eol? (size_t) (eol - p): (size_t) (end - p);
+
+		if (len > 0 && ! isPseudoTagLine (p))
+		{
+			vString *line = vStringNew ();
+			vStringNCatS (line, p, len);
+			stringListAdd (lines, line);
+		}
+		p += len + 1;
+	}
+	vStringDelete (buf);
+	return lines;
+}
+
+/* Appends the lines of a that are not in b. */
+static unsigned int catDifference (vString *out, const stringList *a,
+								   const stringList *b)
+{
+	unsigned int count = 0;
+	hashTable *t = hashTableNew (64, hashCstrhash, hashCstreq, NULL, NULL);
+
+	for (unsigned int i = 0; b && i < stringListCount (b); i++)
+	{
+		char *line = vStringValue (stringListItem (b, i));
+		hashTablePutItem (t, line, line);
+	}
+
+	for (unsigned int i = 0; a && i < stringListCount (a); i++)
+	{
+		char *line = vStringValue (stringListItem (a, i));
+		if (hashTableHasItem (t, line))
+			continue;
+		vStringCatS (out, count++ == 0? "": ", ");
+		vStringCatS (out, line);
+		hashTablePutItem (t, line, line);
+	}
+
+	hashTableDelete (t);
+	return count;
+}
+
+static void processBatch (watchState *state)
+{
+	vString *delta = vStringNew ();
+
+	for (unsigned int i = 0; i < stringListCount (state->touched); i++)
+	{
+		const char *fileName = vStringValue (stringListItem (state->touched, i));
+		fileStatus *status = eStat (fileName);
+		stringList *oldTags = hashTableGetItem (state->tags, fileName);
+		stringList *newTags = NULL;
+
+		if (status->exists && status->isNormalFile
+			&& ! isExcludedFile (fileName, false))
+			newTags = captureTags (fileName);
+		eStatFree (status);
+
+		vStringClear (delta);
+		vStringCatS (delta, "{\"_type\": \"delta\", \"filename\": ");
+		catJsonString (delta, fileName);
+		vStringCatS (delta, ", \"added\": [");
+		unsigned int added = catDifference (delta, newTags, oldTags);
+		vStringCatS (delta, "], \"removed\": [");
+		unsigned int removed = catDifference (delta, oldTags, newTags);
+		vStringCatS (delta, "]}\n");
+		verbose ("watch: %s: %u added, %u removed\n", fileName, added, removed);
+		if (added > 0 || removed > 0)
+			fputs (vStringValue (delta), state->out);
+
+		if (oldTags)
+			hashTableDeleteItem (state->tags, fileName);
+		if (newTags)
+			hashTablePutItem (state->tags, eStrdup (fileName), newTags);
+	}
+
+	vStringDelete (delta);
+	fprintf (state->out, "{\"_type\": \"batch-completed\", \"command\": \"watch\", \"files\": %u}\n",
+			 stringListCount (state->touched));
+	fflush (state->out);
+
+	hashTableClear (state->touchedTable);
+	stringListClear (state->touched);
+}
+
+/* Returns true if input is readable on the any of the descriptors. */
+static bool waitEvents (watchState *state, int timeout, bool *stdinReady)
+{
+	struct pollfd fds [2] = {
+		{ .fd = state->fd, .events = POLLIN },
+		{ .fd = 0, .events = POLLIN },
+	};
+	int n;
+
+	do
+		n = poll (fds, stdinReady? 2: 1, timeout);
+	while (n < 0 && errno == EINTR);
+
+	if (n < 0)
+		error (FATAL | PERROR, "failed to wait for file system events");
+
+	if (stdinReady)
+		*stdinReady = (fds [1].revents != 0);
+	return (fds [0].revents & POLLIN);
+}
+
+static void deleteTagLines (void *lines)
+{
+	stringListDelete (lines);
+}
+
+extern bool watchDirectory (const char *const dirName, unsigned int delay,
+							FILE *const out)
+{
+	watchState state;
+	bool stdinReady = false;
+
+	state.fd = inotify_init1 (IN_CLOEXEC);
+	if (state.fd < 0)
+	{
+		error (WARNING | PERROR, "cannot initialize inotify");
+		return false;
+	}
+	state.dirs = hashTableNew (64, hashInthash, hashInteq, eFree, eFree);
+	state.tags = hashTableNew (1024, hashCstrhash, hashCstreq, eFree, deleteTagLines);
+	state.touched = stringListNew ();
+	state.touchedTable = hashTableNew (64, hashCstrhash, hashCstreq, NULL, NULL);
+	state.out = out;
+
+	/* The first batch reports all the tags in the tree. */
+	addWatchRecursively (&state, dirName);
+	processBatch (&state);
+
+	while (! stdinReady)
+	{
+		if (! waitEvents (&state, -1, &stdinReady))
+			continue;
+
+		/* Collect the events coming in a burst, e.g. from "git checkout". */
+		do
+			readEvents (&state);
+		while (waitEvents (&state, (int) delay, NULL));
+
+		if (stringListCount (state.touched) > 0)
+			processBatch (&state);
+	}
+
+	hashTableDelete (state.touchedTable);
+	stringListDelete (state.touched);
+	hashTableDelete (state.tags);
+	hashTableDelete (state.dirs);
+	close (state.fd);
+	return true;
+}
+
+#else
+
+extern bool watchDirectory (const char *const dirName CTAGS_ATTR_UNUSED,
+							unsigned int delay CTAGS_ATTR_UNUSED,
+							FILE *const out CTAGS_ATTR_UNUSED)
+{
+	return false;
+}
+
+#endif
@@ -0,0 +1,28 @@
+/*
+*   Copyright (c) 2026, Universal Ctags Team
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License version 2 or (at your option) any later version.
+*
+*   Main part private interface to watch.c
+*/
+#ifndef CTAGS_MAIN_WATCH_PRIVATE_H
+#define CTAGS_MAIN_WATCH_PRIVATE_H
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"  /* must always come first */
+
+#include <stdio.h>
+
+/*
+*   FUNCTION PROTOTYPES
+*/
+
+/* Watches the directory tree until input arrives on stdin. The tag file
+ * must be opened. Returns false if watching is not supported. */
+extern bool watchDirectory (const char *const dirName, unsigned int delay,
+							FILE *const out);
+
+#endif  /* CTAGS_MAIN_WATCH_PRIVATE_H */
@@ -0,0 +1,434 @@
+/*
+*   Copyright (c) 2026, Universal Ctags Team
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License version 2 or (at your option) any later version.
+*
+*   This module implements --output-format=binary: writing tags to a
+*   binary, column-oriented tag database.
+*
+*   The strings in the tags are interned, and a tag is recorded as a row
+*   of small integers referring to them. The rows are kept in memory
+*   during the run and written when the tag file is closed. They are
+*   sorted by name unless --sort=no is given, so a reader can find a name
+*   with a binary search.
+*
+*   The format of the database is:
+*
+*	!_CTAGS_BINARY_DB<TAB>1<TAB>/.../<LF>
+*	flags
+*	string table:   count, { length, bytes }...
+*	language table: count, { name }...
+*	kind table:     count, { language, letter, name }...
+*	file table:     count, { path }...
+*	scope table:    count, { kind name, scope name }...
+*	rows:           count
+*	columns:        name..., kind..., file..., line..., end..., pattern...,
+*	                scope..., flags...
+*
+*   All the numbers are unsigned LEB128 varints. The values of the
+*   tables and the columns of "name", "pattern", and the scope table are
+*   string ids. String 0 is the empty string. "pattern" is 0 for a tag
+*   located by its line number, "end" is 0 if the end line is unknown, and
+*   "scope" is 0 for a tag having no scope. Bit 0 of "flags" of a row is
+*   set for a file scoped tag. The flags of the header are the sort type
+*   as !_TAG_FILE_SORTED gives.
+*
+*   The other fields of tags are not recorded.
+*/
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"  /* must always come first */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "debug.h"
+#include "entry_p.h"
+#include "htable.h"
+#include "kind.h"
+#include "mio.h"
+#include "numarray.h"
+#include "options_p.h"
+#include "parse.h"
+#include "ptrarray.h"
+#include "routines.h"
+#include "vstring.h"
+#include "writer_p.h"
+
+/*
+*   DATA DECLARATIONS
+*/
+#define BINARY_FILE  "tags"
+#define BINARY_MAGIC "!_CTAGS_BINARY_DB"
+#define BINARY_VERSION 1
+
+#define BINARY_ROW_FILE_SCOPE 0x1
+
+/* Items interned by their keys. Each item has WIDTH numbers. */
+typedef struct sInternTable {
+	hashTable *ids;		/* key -> id + 1 */
+	ptrArray *keys;		/* id -> key */
+	uintArray *values;
+	unsigned int width;
+} internTable;
+
+typedef struct sBinaryRow {
+	unsigned int name;
+	unsigned int kind;
+	unsigned int file;
+	unsigned long line;
+	unsigned long end;
+	unsigned int pattern;
+	unsigned int scope;
+	unsigned int flags;
+} binaryRow;
+
+/*
+*   DATA DEFINITIONS
+*/
+static internTable Strings;
+static internTable Languages;
+static internTable Kinds;
+static internTable Files;
+static internTable Scopes;
+
+static binaryRow *Rows;
+static unsigned int RowCount;
+static unsigned int RowSize;
+
+/*
+*   FUNCTION DEFINITIONS
+*/
+
+static int writeBinaryEntry (tagWriter *writer CTAGS_ATTR_UNUSED,
+							 MIO * mio, const tagEntryInfo *const tag,
+							 void *clientData CTAGS_ATTR_UNUSED);
+static void finishBinaryOutput (tagWriter *writer CTAGS_ATTR_UNUSED,
+								MIO * mio, void *clientData CTAGS_ATTR_UNUSED);
+static void rescanFailedBinaryEntry (tagWriter *writer CTAGS_ATTR_UNUSED,
+									 unsigned long validTagNum,
+									 void *clientData CTAGS_ATTR_UNUSED);
+static void checkBinaryOptions (tagWriter *writer CTAGS_ATTR_UNUSED,
+								bool fieldsWereReset CTAGS_ATTR_UNUSED);
+
+tagWriter binaryWriter = {
+	.writeEntry = writeBinaryEntry,
+	.writePtagEntry = NULL,
+	.printPtagByDefault = false,
+	.preWriteEntry = NULL,
+	.postWriteEntry = NULL,
+	.rescanFailedEntry = rescanFailedBinaryEntry,
+	.finishOutput = finishBinaryOutput,
+	.sortsEntries = true,
+	.treatFieldAsFixed = NULL,
+	.checkOptions = checkBinaryOptions,
+	.defaultFileName = BINARY_FILE,
+};
+
+static void initInternTable (internTable *table, unsigned int width)
+{
+	table->ids = hashTableNew (1024, hashCstrhash, hashCstreq, NULL, NULL);
+	table->keys = ptrArrayNew (eFree);
+	table->values = uintArrayNew ();
+	table->width = width;
+}
+
+static void finiInternTable (internTable *table)
+{
+	hashTableDelete (table->ids);
+	ptrArrayDelete (table->keys);
+	uintArrayDelete (table->values);
+	memset (table, 0, sizeof (*table));
+}
+
+static unsigned int internItem (internTable *table, const char *key,
+								const unsigned int *values)
+{
+	unsigned int id = HT_PTR_TO_UINT (hashTableGetItem (table->ids, key));
+	char *k;
+
+	if (id > 0)
+		return id - 1;
+
+	k = eStrdup (key);
+	id = ptrArrayAdd (table->keys, k);
+	hashTablePutItem (table->ids, k, HT_UINT_TO_PTR (id + 1));
+	for (unsigned int i = 0; i < table->width; i++)
+		uintArrayAdd (table->values, values [i]);
+	return id;
+}
+
+static unsigned int internString (const char *str)
+{
+	return internItem (&Strings, str, NULL);
+}
+
+static void initTables (void)
+{
+	unsigned int none [2] = { 0, 0 };
+
+	initInternTable (&Strings, 0);
+	initInternTable (&Languages, 1);
+	initInternTable (&Kinds, 3);
+	initInternTable (&Files, 1);
+	initInternTable (&Scopes, 2);
+
+	internString ("");
+	internItem (&Scopes, "", none);
+}
+
+static void finiTables (void)
+{
+	finiInternTable (&Strings);
+	finiInternTable (&Languages);
+	finiInternTable (&Kinds);
+	finiInternTable (&Files);
+	finiInternTable (&Scopes);
+
+	if (Rows)
+		eFree (Rows);
+	Rows = NULL;
+	RowCount = 0;
+	RowSize = 0;
+}
+
+static unsigned int internFile (const char *path)
+{
+	unsigned int name = internString (path);
+	return internItem (&Files, path, &name);
+}
+
+static unsigned int internKind (const tagEntryInfo *const tag)
+{
+	const char *language = (tag->langType == LANG_IGNORE)
+		? "": getLanguageName (tag->langType);
+	const kindDefinition *kdef = getTagKind (tag);
+	unsigned int values [3];
+	vString *key = vStringNewInit (language);
+	unsigned int id;
+	unsigned int name = internString (language);
+
+	values [0] = internItem (&Languages, language, &name);
+	values [1] = (unsigned char) kdef->letter;
+	values [2] = internString (kdef->name);
+
+	vStringPut (key, '\t');
+	vStringCatS (key, kdef->name);
+	id = internItem (&Kinds, vStringValue (key), values);
+	vStringDelete (key);
+	return id;
+}
+
+static unsigned int internScope (const char *kind, const char *name)
+{
+	unsigned int values [2];
+	vString *key = vStringNewInit (kind);
+	unsigned int id;
+
+	values [0] = internString (kind);
+	values [1] = internString (name);
+
+	vStringPut (key, '\t');
+	vStringCatS (key, name);
+	id = internItem (&Scopes, vStringValue (key), values);
+	vStringDelete (key);
+	return id;
+}
+
+static binaryRow *newRow (void)
+{
+	if (Rows == NULL)
+		initTables ();
+
+	if (RowCount == RowSize)
+	{
+		RowSize = (RowSize == 0)? 1024: RowSize * 2;
+		Rows = xRealloc (Rows, RowSize, binaryRow);
+	}
+	return Rows + RowCount++;
+}
+
+static int writeBinaryEntry (tagWriter *writer CTAGS_ATTR_UNUSED,
+							 MIO * mio CTAGS_ATTR_UNUSED,
+							 const tagEntryInfo *const tag,
+							 void *clientData CTAGS_ATTR_UNUSED)
+{
+	binaryRow *row = newRow ();
+	const char *scopeKind = NULL;
+	const char *scopeName = NULL;
+
+	row->name = internString (tag->name);
+	row->kind = internKind (tag);
+	row->file = internFile (tag->inputFileName);
+	row->line = tag->lineNumber;
+	row->end = tag->extensionFields.endLine;
+
+	row->pattern = 0;
+	if (! tag->lineNumberEntry)
+	{
+		char *pattern = makePatternString (tag);
+		row->pattern = internString (pattern);
+		eFree (pattern);
+	}
+
+	/* const is discarded to fill the cache of the scope. */
+	getTagScopeInformation ((tagEntryInfo *const) tag, &scopeKind, &scopeName);
+	row->scope = (scopeKind && scopeName)? internScope (scopeKind, scopeName): 0;
+
+	row->flags = tag->isFileScope? BINARY_ROW_FILE_SCOPE: 0;
+
+	/* Nothing is written until the end. Report one row. */
+	return 1;
+}
+
+static void rescanFailedBinaryEntry (tagWriter *writer CTAGS_ATTR_UNUSED,
+									 unsigned long validTagNum,
+									 void *clientData CTAGS_ATTR_UNUSED)
+{
+	/* The rows are the only entries counted in the tag file. */
+	if (validTagNum < RowCount)
+		RowCount = (unsigned int) validTagNum;
+}
+
+static void putVarint (MIO *mio, unsigned long long n)
+{
+	while (n >= 0x80)
+	{
+		mio_putc (mio, (int) ((n & 0x7f) | 0x80));
+		n >>= 7;
+	}
+	mio_putc (mio, (int) n);
+}
+
+static const char *stringOf (unsigned int id)
+{
+	return ptrArrayItem (Strings.keys, id);
+}
+
+static int compareRowsWith (const binaryRow *a, const binaryRow *b,
+							int (*cmp) (const char *, const char *))
+{
+	int r;
+
+	if (a->name != b->name)
+	{
+		r = cmp (stringOf (a->name), stringOf (b->name));
+		if (r)
+			return r;
+	}
+	if (a->file != b->file)
+	{
+		r = strcmp (stringOf (uintArrayItem (Files.values, a->file)),
+					stringOf (uintArrayItem (Files.values, b->file)));
+		if (r)
+			return r;
+	}
+	/* The same order as the tag lines, in which the ex command is next */
+	if (a->pattern != b->pattern && a->pattern && b->pattern)
+	{
+		r = strcmp (stringOf (a->pattern), stringOf (b->pattern));
+		if (r)
+			return r;
+	}
+	if (a->line != b->line)
+		return (a->line < b->line)? -1: 1;
+	return 0;
+}
+
+static int compareFoldedNames (const char *a, const char *b)
+{
+	int r = struppercmp (a, b);
+	return r? r: strcmp (a, b);
+}
+
+static int compareRows (const void *a, const void *b)
+{
+	return compareRowsWith (a, b, strcmp);
+}
+
+static int compareRowsFolded (const void *a, const void *b)
+{
+	return compareRowsWith (a, b, compareFoldedNames);
+}
+
+static void putTable (MIO *mio, const internTable *table)
+{
+	unsigned int n = uintArrayCount (table->values);
+
+	putVarint (mio, ptrArrayCount (table->keys));
+	for (unsigned int i = 0; i < n; i++)
+		putVarint (mio, uintArrayItem (table->values, i));
+}
+
+static void finishBinaryOutput (tagWriter *writer CTAGS_ATTR_UNUSED,
+								MIO * mio, void *clientData CTAGS_ATTR_UNUSED)
+{
+	unsigned int i;
+
+	if (Rows == NULL)
+		initTables ();
+
+	if (Option.sorted != SO_UNSORTED && RowCount > 1)
+	{
+		verbose ("sorting binary tag database\n");
+		qsort (Rows, RowCount, sizeof (*Rows),
+			   Option.sorted == SO_FOLDSORTED? compareRowsFolded: compareRows);
+	}
+
+	mio_printf (mio, "%s\t%d\t/%s/\n", BINARY_MAGIC, BINARY_VERSION,
+				"column-oriented tag database");
+	putVarint (mio, Option.sorted);
+
+	putVarint (mio, ptrArrayCount (Strings.keys));
+	for (i = 0; i < ptrArrayCount (Strings.keys); i++)
+	{
+		const char *s = stringOf (i);
+		size_t len = strlen (s);
+
+		putVarint (mio, len);
+		mio_write (mio, s, 1, len);
+	}
+
+	putTable (mio, &Languages);
+	putTable (mio, &Kinds);
+	putTable (mio, &Files);
+	putTable (mio, &Scopes);
+
+	putVarint (mio, RowCount);
+#define putColumn(FIELD) \
+	for (i = 0; i < RowCount; i++) putVarint (mio, Rows [i].FIELD)
+	putColumn (name);
+	putColumn (kind);
+	putColumn (file);
+	putColumn (line);
+	putColumn (end);
+	putColumn (pattern);
+	putColumn (scope);
+	putColumn (flags);
+#undef putColumn
+
+	finiTables ();
+}
+
+static void checkBinaryOptions (tagWriter *writer CTAGS_ATTR_UNUSED,
+								bool fieldsWereReset CTAGS_ATTR_UNUSED)
+{
+	const char *notice = "binary output is not compatible with";
+
+	if (Option.append)
+		error (FATAL, "%s append mode", notice);
+	if (Option.filter)
+		error (FATAL, "%s filter mode", notice);
+	if (Option.cacheFileName)
+		error (FATAL, "%s --cache-file option", notice);
+	if (Option.cacheDirName)
+		error (FATAL, "%s --cache-dir option", notice);
+
+	/* The databases made by worker processes cannot be concatenated.
+	 * beginJobs() doesn't start them. */
+	if (Option.jobs > 1)
+		error (WARNING, "binary output disables --jobs option");
+}
@@ -17,6 +17,8 @@
 #include "parse_p.h"
 #include "ptag_p.h"
 #include "read.h"
+#include "trashbox.h"
+#include "vstring.h"
 #include "writer_p.h"
 #include "xtag.h"
 #include "xtag_p.h"
@@ -182,25 +184,86 @@ static const char* escapeFieldValue (tagWriter *writer, const tagEntryInfo * tag
 	return escapeFieldValueFull (writer, tag, ftype, NO_PARSER_FIELD);
 }
 
-static int renderExtensionFieldMaybe (tagWriter *writer, int xftype, const tagEntryInfo *const tag, char sep[2], MIO *mio)
+/* A tag line is assembled in this buffer, and written at once. */
+static vString *LineBuffer;
+
+/* The fields rendered in the loops at the end of addExtensionFields.
+ * They are looked up again only when the enabled fields are changed. */
+static struct fieldPlan {
+	bool valid;
+	unsigned int generation;
+	bool putFieldPrefix;
+	unsigned int count;
+	fieldType types [FIELD_BUILTIN_LAST + 1];
+	const char *names [FIELD_BUILTIN_LAST + 1];
+} FieldPlan;
+
+static const struct fieldPlan *getFieldPlan (void)
 {
-	if (isFieldEnabled (xftype) && doesFieldHaveValue (xftype, tag))
+	if (FieldPlan.valid
+		&& FieldPlan.generation == getFieldEnablementGeneration ()
+		&& FieldPlan.putFieldPrefix == Option.putFieldPrefix)
+		return &FieldPlan;
+
+	FieldPlan.count = 0;
+	for (int k = FIELD_ECTAGS_LOOP_START; k <= FIELD_BUILTIN_LAST; k++)
 	{
-		int len;
-		len = mio_printf (mio, "%s\t%s:%s", sep,
-				  getFieldName (xftype),
-				  escapeFieldValue (writer, tag, xftype));
-		sep[0] = '\0';
-		return len;
+		if (FIELD_ECTAGS_LOOP_LAST < k && k < FIELD_UCTAGS_LOOP_START)
+			continue;
+		if (! isFieldEnabled (k))
+			continue;
+		FieldPlan.types [FieldPlan.count] = k;
+		FieldPlan.names [FieldPlan.count] = getFieldName (k);
+		FieldPlan.count++;
 	}
-	else
-		return 0;
+	FieldPlan.generation = getFieldEnablementGeneration ();
+	FieldPlan.putFieldPrefix = Option.putFieldPrefix;
+	FieldPlan.valid = true;
+	return &FieldPlan;
+}
+
+static void catUnsignedLong (vString *buf, unsigned long n)
+{
+	char digits [3 * sizeof (unsigned long) + 1];
+	char *p = digits + sizeof (digits);
+
+	do
+	{
+		*--p = (char) ('0' + (n % 10));
+		n /= 10;
+	} while (n > 0);
+	vStringNCatSUnsafe (buf, p, digits + sizeof (digits) - p);
+}
+
+/* Put the separator of the extension fields before the first one. */
+static void catFieldSeparator (vString *buf, bool *first)
+{
+	if (*first)
+	{
+		vStringCatS (buf, ";\"");
+		*first = false;
+	}
+	vStringPut (buf, '\t');
+}
+
+static void catField (vString *buf, bool *first, const char *name, const char *value)
+{
+	catFieldSeparator (buf, first);
+	vStringCatS (buf, name);
+	vStringPut (buf, ':');
+	vStringCatS (buf, value);
+}
+
+static void renderExtensionFieldMaybe (tagWriter *writer, int xftype, const char *name,
+									   const tagEntryInfo *const tag, bool *first, vString *buf)
+{
+	if (doesFieldHaveValue (xftype, tag))
+		catField (buf, first, name, escapeFieldValue (writer, tag, xftype));
 }
 
-static int addParserFields (tagWriter *writer, MIO * mio, const tagEntryInfo *const tag)
+static void addParserFields (tagWriter *writer, vString *buf, const tagEntryInfo *const tag)
 {
 	unsigned int i;
-	int length = 0;
 
 	for (i = 0; i < tag->usedParserFields; i++)
 	{
@@ -209,41 +272,25 @@ static int addParserFields (tagWriter *writer, MIO * mio, const tagEntryInfo *co
 		if (! isFieldEnabled (ftype))
 			continue;
 
-		length += mio_printf(mio, "\t%s:%s",
-							 getFieldName (ftype),
-							 escapeFieldValueFull (writer, tag, ftype, i));
+		vStringPut (buf, '\t');
+		vStringCatS (buf, getFieldName (ftype));
+		vStringPut (buf, ':');
+		vStringCatS (buf, escapeFieldValueFull (writer, tag, ftype, i));
 	}
-	return length;
 }
 
-static int writeLineNumberEntry (tagWriter *writer, MIO * mio, const tagEntryInfo *const tag)
+static void writeLineNumberEntry (tagWriter *writer, vString *buf, const tagEntryInfo *const tag)
 {
 	if (Option.lineDirectives)
-		return mio_printf (mio, "%s", escapeFieldValue (writer, tag, FIELD_LINE_NUMBER));
+		vStringCatS (buf, escapeFieldValue (writer, tag, FIELD_LINE_NUMBER));
 	else
-		return mio_printf (mio, "%lu", tag->lineNumber);
+		catUnsignedLong (buf, tag->lineNumber);
 }
 
-static int addExtensionFields (tagWriter *writer, MIO *mio, const tagEntryInfo *const tag)
+static void addExtensionFields (tagWriter *writer, vString *buf, const tagEntryInfo *const tag)
 {
-	bool isKindKeyEnabled = isFieldEnabled (FIELD_KIND_KEY);
-	bool isScopeEnabled = isFieldEnabled   (FIELD_SCOPE_KEY);
-
-	const char* const kindKey = isKindKeyEnabled
-		?getFieldName (FIELD_KIND_KEY)
-		:"";
-	const char* const kindFmt = isKindKeyEnabled
-		?"%s\t%s:%s"
-		:"%s\t%s%s";
-	const char* const scopeKey = isScopeEnabled
-		?getFieldName (FIELD_SCOPE_KEY)
-		:"";
-	const char* const scopeFmt = isScopeEnabled
-		?"%s\t%s:%s:%s"
-		:"%s\t%s%s:%s";
-
-	char sep [] = {';', '"', '\0'};
-	int length = 0;
+	const struct fieldPlan *plan = getFieldPlan ();
+	bool first = true;
 
 	const char *str = NULL;
 	kindDefinition *kdef = getLanguageKind(tag->langType, tag->kindIndex);
@@ -264,19 +311,26 @@ static int addExtensionFields (tagWriter *writer, MIO *mio, const tagEntryInfo *
 
 	if (str)
 	{
-		length += mio_printf (mio, kindFmt, sep, kindKey, str);
-		sep [0] = '\0';
+		catFieldSeparator (buf, &first);
+		if (isFieldEnabled (FIELD_KIND_KEY))
+		{
+			vStringCatS (buf, getFieldName (FIELD_KIND_KEY));
+			vStringPut (buf, ':');
+		}
+		vStringCatS (buf, str);
 	}
 
 	if (isFieldEnabled (FIELD_LINE_NUMBER) &&  doesFieldHaveValue (FIELD_LINE_NUMBER, tag))
 	{
-		length += mio_printf (mio, "%s\t%s:%ld", sep,
-				   getFieldName (FIELD_LINE_NUMBER),
-				   tag->lineNumber);
-		sep [0] = '\0';
+		catFieldSeparator (buf, &first);
+		vStringCatS (buf, getFieldName (FIELD_LINE_NUMBER));
+		vStringPut (buf, ':');
+		catUnsignedLong (buf, tag->lineNumber);
 	}
 
-	length += renderExtensionFieldMaybe (writer, FIELD_LANGUAGE, tag, sep, mio);
+	if (isFieldEnabled (FIELD_LANGUAGE))
+		renderExtensionFieldMaybe (writer, FIELD_LANGUAGE, getFieldName (FIELD_LANGUAGE),
+								   tag, &first, buf);
 
 	if (isFieldEnabled (FIELD_SCOPE))
 	{
@@ -286,32 +340,28 @@ static int addExtensionFields (tagWriter *writer, MIO *mio, const tagEntryInfo *
 		v = escapeFieldValue (writer, tag, FIELD_SCOPE);
 		if (k && v)
 		{
-			length += mio_printf (mio, scopeFmt, sep, scopeKey, k, v);
-			sep [0] = '\0';
+			catFieldSeparator (buf, &first);
+			if (isFieldEnabled (FIELD_SCOPE_KEY))
+			{
+				vStringCatS (buf, getFieldName (FIELD_SCOPE_KEY));
+				vStringPut (buf, ':');
+			}
+			vStringCatS (buf, k);
+			vStringPut (buf, ':');
+			vStringCatS (buf, v);
 		}
 	}
 
 	if (isFieldEnabled (FIELD_TYPE_REF) && doesFieldHaveValue (FIELD_TYPE_REF, tag))
-	{
-		length += mio_printf (mio, "%s\t%s:%s", sep,
-				      getFieldName (FIELD_TYPE_REF),
-				      escapeFieldValue (writer, tag, FIELD_TYPE_REF));
-		sep [0] = '\0';
-	}
+		catField (buf, &first, getFieldName (FIELD_TYPE_REF),
+				  escapeFieldValue (writer, tag, FIELD_TYPE_REF));
 
 	if (isFieldEnabled (FIELD_FILE_SCOPE) &&  doesFieldHaveValue (FIELD_FILE_SCOPE, tag))
-	{
-		length += mio_printf (mio, "%s\t%s:", sep,
-				      getFieldName (FIELD_FILE_SCOPE));
-		sep [0] = '\0';
-	}
+		catField (buf, &first, getFieldName (FIELD_FILE_SCOPE), "");
 
-	for (int k = FIELD_ECTAGS_LOOP_START; k <= FIELD_ECTAGS_LOOP_LAST; k++)
-		length += renderExtensionFieldMaybe (writer, k, tag, sep, mio);
-	for (int k = FIELD_UCTAGS_LOOP_START; k <= FIELD_BUILTIN_LAST; k++)
-		length += renderExtensionFieldMaybe (writer, k, tag, sep, mio);
-
-	return length;
+	for (unsigned int i = 0; i < plan->count; i++)
+		renderExtensionFieldMaybe (writer, plan->types [i], plan->names [i],
+								   tag, &first, buf);
 }
 
 static int writeCtagsEntry (tagWriter *writer,
@@ -328,9 +378,18 @@ static int writeCtagsEntry (tagWriter *writer,
 		}
 	}
 
-	int length = mio_printf (mio, "%s\t%s\t",
-			      escapeFieldValue (writer, tag, FIELD_NAME),
-			      escapeFieldValue (writer, tag, FIELD_INPUT_FILE));
+	if (LineBuffer == NULL)
+	{
+		LineBuffer = vStringNew ();
+		DEFAULT_TRASH_BOX (LineBuffer, vStringDelete);
+	}
+	vString *buf = LineBuffer;
+
+	vStringClear (buf);
+	vStringCatS (buf, escapeFieldValue (writer, tag, FIELD_NAME));
+	vStringPut (buf, '\t');
+	vStringCatS (buf, escapeFieldValue (writer, tag, FIELD_INPUT_FILE));
+	vStringPut (buf, '\t');
 
 	/* This is for handling 'common' of 'fortran'.  See the
 	   description of --excmd=mixed in ctags.1.  In tags output, what
@@ -338,23 +397,27 @@ static int writeCtagsEntry (tagWriter *writer,
 
 	   However, in the other formats, pattern should be pattern as its name. */
 	if (tag->lineNumberEntry)
-		length += writeLineNumberEntry (writer, mio, tag);
+		writeLineNumberEntry (writer, buf, tag);
 	else
 	{
 		if (Option.locate == EX_COMBINE)
-			length += mio_printf(mio, "%lu;", tag->lineNumber);
-		length += mio_puts(mio, escapeFieldValue(writer, tag, FIELD_PATTERN));
+		{
+			catUnsignedLong (buf, tag->lineNumber);
+			vStringPut (buf, ';');
+		}
+		vStringCatS (buf, escapeFieldValue(writer, tag, FIELD_PATTERN));
 	}
 
 	if (includeExtensionFlags ())
 	{
-		length += addExtensionFields (writer, mio, tag);
-		length += addParserFields (writer, mio, tag);
+		addExtensionFields (writer, buf, tag);
+		addParserFields (writer, buf, tag);
 	}
 
-	length += mio_printf (mio, "\n");
+	vStringPut (buf, '\n');
+	mio_write (mio, vStringValue (buf), 1, vStringLength (buf));
 
-	return length;
+	return (int) vStringLength (buf);
 }
 
 static int writeCtagsPtagEntry (tagWriter *writer,
@@ -33,6 +33,8 @@ static void *beginEtagsFile (tagWriter *writer, MIO * mio,
 							 void *clientData CTAGS_ATTR_UNUSED);
 static bool  endEtagsFile   (tagWriter *writer, MIO * mio, const char* filename,
 							 void *clientData CTAGS_ATTR_UNUSED);
+static void finishEtagsOutput (tagWriter *writer, MIO * mio,
+							   void *clientData CTAGS_ATTR_UNUSED);
 
 tagWriter etagsWriter = {
 	.writeEntry = writeEtagsEntry,
@@ -40,27 +42,41 @@ tagWriter etagsWriter = {
 	.preWriteEntry = beginEtagsFile,
 	.postWriteEntry = endEtagsFile,
 	.rescanFailedEntry = NULL,
+	.finishOutput = finishEtagsOutput,
 	.treatFieldAsFixed = NULL,
 	.defaultFileName = ETAGS_FILE,
 };
 
 struct sEtags {
-	char *name;
+	/* The section of the current file is written here, and copied to
+	 * the tag file after the header telling its size. The buffer is
+	 * reused for all the input files. */
 	MIO *mio;
-	size_t byteCount;
 	vString *vLine;
-};
 
+	/* The line written for the last tag, already truncated. A line of
+	 * a minified input file bears many tags; reading the whole line for
+	 * each of them takes much time. */
+	vString *prevLine;
+	MIOPos prevPosition;
+	unsigned int prevGeneration;	/* 0 if prevLine is not set */
+	long prevSeekValue;
+};
 
+static struct sEtags etags;
 
 static void *beginEtagsFile (tagWriter *writer CTAGS_ATTR_UNUSED, MIO *mio CTAGS_ATTR_UNUSED,
 							 void *clientData CTAGS_ATTR_UNUSED)
 {
-	static struct sEtags etags = { NULL, NULL, 0, NULL };
-
-	etags.mio = tempFile ("w+b", &etags.name);
-	etags.byteCount = 0;
-	etags.vLine = vStringNew ();
+	if (etags.mio == NULL)
+	{
+		etags.mio = mio_new_memory (NULL, 0, eRealloc, eFreeNoNullCheck);
+		etags.vLine = vStringNew ();
+		etags.prevLine = vStringNew ();
+	}
+	else
+		mio_rewind (etags.mio);
+	etags.prevGeneration = 0;
 	return &etags;
 }
 
@@ -68,31 +84,36 @@ static bool endEtagsFile (tagWriter *writer,
 						  MIO *mainfp, const char *filename,
 						  void *clientData CTAGS_ATTR_UNUSED)
 {
-	const char *line;
 	struct sEtags *etags = writer->private;
+	/* The buffer may be longer than the section of this file; it is
+	 * rewound, not truncated. */
+	const long byteCount = mio_tell (etags->mio);
+	const unsigned char *data = mio_memory_get_data (etags->mio, NULL);
 
-	mio_printf (mainfp, "\f\n%s,%ld\n", filename, (long) etags->byteCount);
+	mio_printf (mainfp, "\f\n%s,%ld\n", filename, byteCount);
 	setNumTagsAdded (numTagsAdded () + 1);
+	if (byteCount > 0)
+		mio_write (mainfp, data, 1, byteCount);
 	abort_if_ferror (mainfp);
 
-	if (etags->mio != NULL)
-	{
-		mio_rewind (etags->mio);
-
-		while ((line = readLineRaw (etags->vLine, etags->mio)) != NULL)
-			mio_puts (mainfp, line);
-
-		vStringDelete (etags->vLine);
-		mio_unref (etags->mio);
-		remove (etags->name);
-		eFree (etags->name);
-		etags->vLine = NULL;
-		etags->mio = NULL;
-		etags->name = NULL;
-	}
 	return false;
 }
 
+static void finishEtagsOutput (tagWriter *writer CTAGS_ATTR_UNUSED,
+							   MIO *mio CTAGS_ATTR_UNUSED,
+							   void *clientData CTAGS_ATTR_UNUSED)
+{
+	if (etags.mio == NULL)
+		return;
+
+	mio_unref (etags.mio);
+	vStringDelete (etags.vLine);
+	vStringDelete (etags.prevLine);
+	etags.mio = NULL;
+	etags.vLine = NULL;
+	etags.prevLine = NULL;
+}
+
 static const char* ada_suffix (const tagEntryInfo *const tag, const char *const line)
 {
 	kindDefinition *kdef = getLanguageKind(tag->langType, tag->kindIndex);
@@ -143,6 +164,39 @@ static const char* ada_suffix (const tagEntryInfo *const tag, const char *const
 	}
 }
 
+/* Reads the line of TAG, and truncates it as written to the tag file. */
+static char *readEtagsLine (vString *const vLine, const tagEntryInfo *const tag,
+							long *const seekValue)
+{
+	size_t len;
+	char *const line = readLineFromBypassForTag (vLine, tag, seekValue);
+	if (line == NULL || line [0] == '\0')
+		return NULL;
+
+	len = strlen (line);
+
+	if (tag->truncateLineAfterTag)
+		truncateTagLineAfterTag (line, tag->name, true);
+	else if (line [len - 1] == '\n')
+		line [--len] = '\0';
+
+	if (Option.patternLengthLimit > 0 && Option.patternLengthLimit < len)
+	{
+		unsigned int truncationLength = Option.patternLengthLimit;
+
+		/* don't cut in the middle of a UTF-8 character, but don't allow
+		 * for more than one extra character in case it actually wasn't
+		 * UTF-8.  See also entry.c:appendInputLine() */
+		while (truncationLength < len &&
+		       truncationLength < Option.patternLengthLimit + 3 &&
+		       (((unsigned char) line[truncationLength]) & 0xc0) == 0x80)
+			truncationLength++;
+
+		line [truncationLength] = '\0';
+	}
+	return line;
+}
+
 static int writeEtagsEntry (tagWriter *writer,
 							MIO * mio, const tagEntryInfo *const tag,
 							void *clientData CTAGS_ATTR_UNUSED)
@@ -160,33 +214,29 @@ static int writeEtagsEntry (tagWriter *writer,
 				tag->name, tag->lineNumber);
 	else
 	{
-		size_t len;
 		long seekValue;
-		char *const line =
-				readLineFromBypassForTag (etags->vLine, tag, &seekValue);
-		if (line == NULL || line [0] == '\0')
-			return 0;
+		const char *line;
 
-		len = strlen (line);
-
-		if (tag->truncateLineAfterTag)
-			truncateTagLineAfterTag (line, tag->name, true);
-		else if (line [len - 1] == '\n')
-			line [--len] = '\0';
-
-		if (Option.patternLengthLimit > 0 && Option.patternLengthLimit < len)
+		if (! tag->truncateLineAfterTag
+			&& etags->prevGeneration == getPatternCacheGeneration ()
+			&& memcmp (&tag->filePosition, &etags->prevPosition, sizeof (MIOPos)) == 0)
 		{
-			unsigned int truncationLength = Option.patternLengthLimit;
-
-			/* don't cut in the middle of a UTF-8 character, but don't allow
-			 * for more than one extra character in case it actually wasn't
-			 * UTF-8.  See also entry.c:appendInputLine() */
-			while (truncationLength < len &&
-			       truncationLength < Option.patternLengthLimit + 3 &&
-			       (((unsigned char) line[truncationLength]) & 0xc0) == 0x80)
-				truncationLength++;
-
-			line [truncationLength] = '\0';
+			line = vStringValue (etags->prevLine);
+			seekValue = etags->prevSeekValue;
+		}
+		else
+		{
+			line = readEtagsLine (etags->vLine, tag, &seekValue);
+			if (line == NULL)
+				return 0;
+
+			if (! tag->truncateLineAfterTag)
+			{
+				vStringCopyS (etags->prevLine, line);
+				etags->prevPosition = tag->filePosition;
+				etags->prevGeneration = getPatternCacheGeneration ();
+				etags->prevSeekValue = seekValue;
+			}
 		}
 
 		length = mio_printf (mio, "%s\177%s%s\001%lu,%ld\n", line,
@@ -196,7 +246,6 @@ static int writeEtagsEntry (tagWriter *writer,
 							 : "",
 							 tag->lineNumber, seekValue);
 	}
-	etags->byteCount += length;
 
 	return length;
 }
@@ -16,15 +16,15 @@
 #include "options_p.h"
 #include "read.h"
 #include "routines.h"
+#include "routines_p.h"
 #include "ptag_p.h"
+#include "trashbox.h"
+#include "vstring.h"
 #include "writer_p.h"
 
 
 #include <string.h>
 
-#ifdef HAVE_JANSSON
-#include <jansson.h>
-
 /* The concept of CURRENT and AGE is taken from libtool.
  * However, we delete REVISION.
  * We will update more CURRENT frequently than the assumption
@@ -38,10 +38,6 @@
 #define JSON_WRITER_CURRENT 1
 #define JSON_WRITER_AGE 0
 
-#ifndef json_boolean /* compat with jansson < 2.4 */
-#define json_boolean(val)      ((val) ? json_true() : json_false())
-#endif
-
 
 static int writeJsonEntry  (tagWriter *writer CTAGS_ATTR_UNUSED,
 				MIO * mio, const tagEntryInfo *const tag,
@@ -65,6 +61,168 @@ tagWriter jsonWriter = {
 	.defaultFileName = NULL,
 };
 
+/* A JSON object is written into this buffer member by member, and
+ * the buffer is written at once. The output is the same as the one
+ * json_dumps() of jansson made with JSON_PRESERVE_ORDER. */
+static vString *ObjectBuffer;
+
+/* The builtin fields rendered in renderExtensionFieldMaybe. They are
+ * looked up again only when the enabled fields are changed. */
+static struct fieldPlan {
+	bool valid;
+	unsigned int generation;
+	unsigned int count;
+	fieldType types [FIELD_BUILTIN_LAST + 1];
+	const char *names [FIELD_BUILTIN_LAST + 1];
+} FieldPlan;
+
+/* Returns the length of the UTF-8 sequence at S, or 0 if it is
+ * invalid. The rules are the same as the ones of jansson. */
+static size_t utf8SequenceLength (const unsigned char *s, const unsigned char *end)
+{
+	size_t length;
+	unsigned long c;
+
+	if (s [0] < 0x80)
+		return 1;
+	else if (s [0] < 0xc2)
+		return 0;
+	else if (s [0] < 0xe0)
+	{
+		length = 2;
+		c = s [0] & 0x1f;
+	}
+	else if (s [0] < 0xf0)
+	{
+		length = 3;
+		c = s [0] & 0x0f;
+	}
+	else if (s [0] < 0xf5)
+	{
+		length = 4;
+		c = s [0] & 0x07;
+	}
+	else
+		return 0;
+
+	if ((size_t) (end - s) < length)
+		return 0;
+	for (size_t i = 1; i < length; i++)
+	{
+		if ((s [i] & 0xc0) != 0x80)
+			return 0;
+		c = (c << 6) | (s [i] & 0x3f);
+	}
+
+	if ((length == 3 && c < 0x800)
+		|| (length == 4 && c < 0x10000)
+		|| (0xd800 <= c && c <= 0xdfff)
+		|| c > 0x10ffff)
+		return 0;
+	return length;
+}
+
+/* Puts LENGTH bytes at STR as a JSON string. Returns false if they are
+ * not valid UTF-8; BUF is broken then. */
+static bool catJsonNString (vString *buf, const char *str, size_t length)
+{
+	const unsigned char *s = (const unsigned char *)str;
+	const unsigned char *const end = s + length;
+	const unsigned char *run = s;
+
+	vStringPut (buf, '"');
+	while (s < end)
+	{
+		const char *escape;
+		size_t n;
+
+		s += countPlainBytes ((const char *)s, end - s);
+		if (s == end)
+			break;
+
+		switch (*s)
+		{
+		case '\\': escape = "\\\\"; break;
+		case '"':  escape = "\\\""; break;
+		case '\b': escape = "\\b";  break;
+		case '\f': escape = "\\f";  break;
+		case '\n': escape = "\\n";  break;
+		case '\r': escape = "\\r";  break;
+		case '\t': escape = "\\t";  break;
+		default:
+			if (*s < 0x20)
+			{
+				static const char hex [] = "0123456789ABCDEF";
+
+				vStringNCatSUnsafe (buf, (const char *)run, s - run);
+				vStringCatS (buf, "\\u00");
+				vStringPut (buf, hex [*s >> 4]);
+				vStringPut (buf, hex [*s & 0xf]);
+				run = ++s;
+				continue;
+			}
+			n = utf8SequenceLength (s, end);
+			if (n == 0)
+				return false;
+			s += n;
+			continue;
+		}
+		vStringNCatSUnsafe (buf, (const char *)run, s - run);
+		vStringCatS (buf, escape);
+		run = ++s;
+	}
+	vStringNCatSUnsafe (buf, (const char *)run, s - run);
+	vStringPut (buf, '"');
+	return true;
+}
+
+static bool catJsonString (vString *buf, const char *str)
+{
+	return catJsonNString (buf, str, strlen (str));
+}
+
+static void catJsonInteger (vString *buf, long long n)
+{
+	char digits [3 * sizeof (long long) + 2];
+	char *p = digits + sizeof (digits);
+	unsigned long long u = (n < 0)? - (unsigned long long) n: (unsigned long long) n;
+
+	do
+	{
+		*--p = (char) ('0' + (u % 10));
+		u /= 10;
+	} while (u > 0);
+	if (n < 0)
+		*--p = '-';
+	vStringNCatSUnsafe (buf, p, digits + sizeof (digits) - p);
+}
+
+/* Puts the key of a member. The caller truncates BUF to the returned
+ * length if it fails to put the value. */
+static size_t catJsonKey (vString *buf, const char *key)
+{
+	size_t length = vStringLength (buf);
+
+	vStringCatS (buf, ", ");
+	catJsonString (buf, key);
+	vStringCatS (buf, ": ");
+	return length;
+}
+
+static void catJsonStringMember (vString *buf, const char *key, const char *value)
+{
+	size_t length = catJsonKey (buf, key);
+
+	if (! catJsonString (buf, value))
+		vStringTruncate (buf, length);
+}
+
+static void catJsonBoolMember (vString *buf, const char *key, bool value)
+{
+	catJsonKey (buf, key);
+	vStringCatS (buf, value? "true": "false");
+}
+
 static const char* escapeFieldValueRaw (const tagEntryInfo * tag, fieldType ftype, int fieldIndex)
 {
 	const char *v;
@@ -76,7 +234,8 @@ static const char* escapeFieldValueRaw (const tagEntryInfo * tag, fieldType ftyp
 	return v;
 }
 
-static json_t* escapeFieldValue (const tagEntryInfo * tag, fieldType ftype, bool returnEmptyStringAsNoValue)
+static void catFieldValue (vString *buf, const char *key,
+						   const tagEntryInfo * tag, fieldType ftype, bool returnEmptyStringAsNoValue)
 {
 	const char *str = escapeFieldValueRaw (tag, ftype, NO_PARSER_FIELD);
 
@@ -86,58 +245,93 @@ static json_t* escapeFieldValue (const tagEntryInfo * tag, fieldType ftype, bool
 		if (dt & FIELDTYPE_STRING)
 		{
 			if (dt & FIELDTYPE_BOOL && str[0] == '\0')
-				return json_false();
+				catJsonBoolMember (buf, key, false);
 			else
-				return json_string (str);
+				catJsonStringMember (buf, key, str);
 		}
 		else if (dt & FIELDTYPE_INTEGER)
 		{
 			long tmp;
 
 			if (strToLong (str, 10, &tmp))
-				return json_integer (tmp);
-			else
-				return NULL;
+			{
+				catJsonKey (buf, key);
+				catJsonInteger (buf, tmp);
+			}
 		}
 		else if (dt & FIELDTYPE_BOOL)
 		{
 			/* TODO: This must be fixed when new boolean field is added.
 			   Currently only `file:' field use this. */
-			return json_boolean (strcmp ("-", str)); /* "-" -> false */
+			catJsonBoolMember (buf, key, strcmp ("-", str)); /* "-" -> false */
 		}
-		AssertNotReached ();
-		return NULL;
+		else
+			AssertNotReached ();
 	}
 	else if (returnEmptyStringAsNoValue)
-		return json_false();
-	else
-		return NULL;
+		catJsonBoolMember (buf, key, false);
 }
 
-static void renderExtensionFieldMaybe (int xftype, const tagEntryInfo *const tag, json_t *response)
+static const struct fieldPlan *getFieldPlan (void)
 {
-	const char *fname = getFieldName (xftype);
+	if (FieldPlan.valid
+		&& FieldPlan.generation == getFieldEnablementGeneration ())
+		return &FieldPlan;
+
+	/* FIELD_KIND has no name; getFieldName (FIELD_KIND) returns NULL.
+	   FIELD_KIND_LONG does, too.
+	   That cannot be changed to keep the compatibility of tags file format.
+	   Use FIELD_KIND_KEY instead */
+	if (isFieldEnabled (FIELD_KIND) || isFieldEnabled (FIELD_KIND_LONG))
+		enableField (FIELD_KIND_KEY, true);
 
-	if (fname && doesFieldHaveRenderer (xftype, false) && isFieldEnabled (xftype) && doesFieldHaveValue (xftype, tag))
+	/* FIELD_SCOPE has no name; getFieldName (FIELD_KIND_KEY) returns NULL.
+	   That cannot be changed to keep the compatibility of tags file format.
+	   Use FIELD_SCOPE_KEY and FIELD_SCOPE_KIND_LONG instead. */
+	if (isFieldEnabled (FIELD_SCOPE))
+	{
+		enableField (FIELD_SCOPE_KEY, true);
+		enableField (FIELD_SCOPE_KIND_LONG, true);
+	}
+
+	FieldPlan.count = 0;
+	for (int k = FIELD_JSON_LOOP_START; k <= FIELD_BUILTIN_LAST; k++)
+	{
+		const char *fname = getFieldName (k);
+
+		if (fname && doesFieldHaveRenderer (k, false) && isFieldEnabled (k))
+		{
+			FieldPlan.types [FieldPlan.count] = k;
+			FieldPlan.names [FieldPlan.count] = fname;
+			FieldPlan.count++;
+		}
+	}
+	FieldPlan.generation = getFieldEnablementGeneration ();
+	FieldPlan.valid = true;
+	return &FieldPlan;
+}
+
+static void renderExtensionFieldMaybe (vString *buf, int xftype, const char *fname,
+									   const tagEntryInfo *const tag)
+{
+	if (doesFieldHaveValue (xftype, tag))
 	{
 		switch (xftype)
 		{
 		case FIELD_LINE_NUMBER:
-			json_object_set_new (response, fname,
-					     json_integer (tag->lineNumber));
+			catJsonKey (buf, fname);
+			catJsonInteger (buf, tag->lineNumber);
 			break;
 		case FIELD_FILE_SCOPE:
-			json_object_set_new (response, fname,
-					     json_boolean(1));
+			catJsonBoolMember (buf, fname, true);
 			break;
 		default:
-			json_object_set_new (response, fname,
-					     escapeFieldValue (tag, xftype, false));
+			catFieldValue (buf, fname, tag, xftype, false);
 		}
 	}
 }
 
-static void addParserFields (json_t *response, const tagEntryInfo *const tag)
+static void addParserFields (vString *buf, const tagEntryInfo *const tag)
 {
 	unsigned int i;
 
@@ -149,97 +343,91 @@ static void addParserFields (json_t *response, const tagEntryInfo *const tag)
 			continue;
 
 		unsigned int dt = getFieldDataType (ftype);
-		json_t *o;
+		const char *fname = getFieldName (ftype);
 		if (dt & FIELDTYPE_STRING)
 		{
 			const char *str = escapeFieldValueRaw (tag, ftype, i);
 			if (dt & FIELDTYPE_BOOL && str[0] == '\0')
-				o = json_false ();
+				catJsonBoolMember (buf, fname, false);
 			else
-				o = json_string (str);
+				catJsonStringMember (buf, fname, str);
 		}
 		else if (dt & FIELDTYPE_INTEGER)
 		{
 			/* NOT IMPLEMENTED YET */
 			AssertNotReached ();
-			o = json_null ();
+			catJsonKey (buf, fname);
+			vStringCatS (buf, "null");
 		}
 		else if (dt & FIELDTYPE_BOOL)
-			o = json_true ();
+			catJsonBoolMember (buf, fname, true);
 		else
 		{
 			AssertNotReached ();
-			o = json_null ();
+			catJsonKey (buf, fname);
+			vStringCatS (buf, "null");
 		}
-
-		json_object_set_new (response, getFieldName (ftype), o);
 	}
 }
 
-static void addExtensionFields (json_t *response, const tagEntryInfo *const tag)
+static void addExtensionFields (vString *buf, const tagEntryInfo *const tag)
 {
-	int k;
+	const struct fieldPlan *plan = getFieldPlan ();
 
-	/* FIELD_KIND has no name; getFieldName (FIELD_KIND) returns NULL.
-	   FIELD_KIND_LONG does, too.
-	   That cannot be changed to keep the compatibility of tags file format.
-	   Use FIELD_KIND_KEY instead */
-	if (isFieldEnabled (FIELD_KIND) || isFieldEnabled (FIELD_KIND_LONG))
-		enableField (FIELD_KIND_KEY, true);
+	for (unsigned int i = 0; i < plan->count; i++)
+		renderExtensionFieldMaybe (buf, plan->types [i], plan->names [i], tag);
+}
 
-	/* FIELD_SCOPE has no name; getFieldName (FIELD_KIND_KEY) returns NULL.
-	   That cannot be changed to keep the compatibility of tags file format.
-	   Use FIELD_SCOPE_KEY and FIELD_SCOPE_KIND_LONG instead. */
-	if (isFieldEnabled (FIELD_SCOPE))
+static vString *getObjectBuffer (void)
+{
+	if (ObjectBuffer == NULL)
 	{
-		enableField (FIELD_SCOPE_KEY, true);
-		enableField (FIELD_SCOPE_KIND_LONG, true);
+		ObjectBuffer = vStringNew ();
+		DEFAULT_TRASH_BOX (ObjectBuffer, vStringDelete);
 	}
+	else
+		vStringClear (ObjectBuffer);
+	return ObjectBuffer;
+}
 
-	for (k = FIELD_JSON_LOOP_START; k <= FIELD_BUILTIN_LAST; k++)
-		renderExtensionFieldMaybe (k, tag, response);
+static int writeObject (MIO *mio, vString *buf)
+{
+	vStringCatS (buf, "}\n");
+	return mio_write (mio, vStringValue (buf), 1, vStringLength (buf));
 }
 
 static int writeJsonEntry (tagWriter *writer CTAGS_ATTR_UNUSED,
 			       MIO * mio, const tagEntryInfo *const tag,
 				   void *clientData CTAGS_ATTR_UNUSED)
 {
-	int length = 0;
-	json_t *response = json_pack ("{ss}", "_type", "tag");
+	vString *buf = getObjectBuffer ();
+	size_t typeLength;
+
+	vStringCatS (buf, "{\"_type\": \"tag\"");
+	typeLength = vStringLength (buf);
 
 	if (isFieldEnabled (FIELD_NAME))
 	{
-		json_t *name = json_string (tag->name);
-		if (name == NULL)
-			goto out;
-		json_object_set_new (response, "name", name);
+		catJsonKey (buf, "name");
+		if (! catJsonString (buf, tag->name))
+			return 0;
 	}
 	if (isFieldEnabled (FIELD_INPUT_FILE))
-		json_object_set_new (response, "path", json_string (tag->sourceFileName));
+		catJsonStringMember (buf, "path", tag->sourceFileName);
 	if (isFieldEnabled (FIELD_PATTERN))
-	{
-		json_t *pat = escapeFieldValue(tag, FIELD_PATTERN, true);
-		json_object_set_new (response, "pattern", pat);
-	}
+		catFieldValue (buf, "pattern", tag, FIELD_PATTERN, true);
 
 	if (includeExtensionFlags ())
 	{
-		addExtensionFields (response, tag);
-		addParserFields (response, tag);
+		addExtensionFields (buf, tag);
+		addParserFields (buf, tag);
 	}
 
-	/* Print nothing if RESPONSE has only "_type" field. */
-	if (json_object_size (response) == 1)
-		goto out;
+	/* Print nothing if the object has only "_type" field. */
+	if (vStringLength (buf) == typeLength)
+		return 0;
 
-	char *buf = json_dumps (response, JSON_PRESERVE_ORDER);
-	length = mio_printf (mio, "%s\n", buf);
-
-	free (buf);
- out:
-	json_decref (response);
-
-	return length;
+	return writeObject (mio, buf);
 }
 
 static int writeJsonPtagEntry (tagWriter *writer CTAGS_ATTR_UNUSED,
@@ -250,49 +438,48 @@ static int writeJsonPtagEntry (tagWriter *writer CTAGS_ATTR_UNUSED,
 				   void *clientData CTAGS_ATTR_UNUSED)
 {
 #define OPT(X) ((X)?(X):"")
-	json_t *response;
-	char *parserName0 = NULL;
+	vString *buf = getObjectBuffer ();
+	bool ok;
 
 	const char *rest = ((JSON_WRITER_CURRENT > 0) && parserName && desc->jsonObjectKey)
 		? strchr(parserName, '!')
 		: NULL;
-	if (rest)
+
+	vStringCatS (buf, "{\"_type\": \"ptag\"");
+	catJsonKey (buf, "name");
+	ok = catJsonString (buf, desc->name);
+	if (ok && rest)
 	{
-		parserName0 = eStrndup(parserName, rest - parserName);
-		response = json_pack ("{ss ss ss ss ss ss}",
-				      "_type", "ptag",
-				      "name", desc->name,
-				      "parserName", parserName0,
-				      desc->jsonObjectKey, rest + 1,
-				      "path", OPT(fileName),
-				      "pattern", OPT(pattern));
+		catJsonKey (buf, "parserName");
+		ok = catJsonNString (buf, parserName, rest - parserName);
+		if (ok)
+		{
+			catJsonKey (buf, desc->jsonObjectKey);
+			ok = catJsonString (buf, rest + 1);
+		}
 	}
-	else if (parserName)
+	else if (ok && parserName)
 	{
-		response = json_pack ("{ss ss ss ss ss}",
-				      "_type", "ptag",
-				      "name", desc->name,
-				      "parserName", parserName,
-				      "path", OPT(fileName),
-				      "pattern", OPT(pattern));
+		catJsonKey (buf, "parserName");
+		ok = catJsonString (buf, parserName);
 	}
-	else
+	if (ok)
 	{
-		response = json_pack ("{ss ss ss ss}",
-				      "_type", "ptag",
-				      "name", desc->name,
-				      "path", OPT(fileName),
-				      "pattern", OPT(pattern));
+		catJsonKey (buf, "path");
+		ok = catJsonString (buf, OPT(fileName));
+	}
+	if (ok)
+	{
+		catJsonKey (buf, "pattern");
+		ok = catJsonString (buf, OPT(pattern));
 	}
 
-	char *buf = json_dumps (response, JSON_PRESERVE_ORDER);
-	int length = mio_printf (mio, "%s\n", buf);
-	free (buf);
-	json_decref (response);
-	if (parserName0)
-		eFree(parserName0);
+	/* Print nothing as json_pack() of jansson fails for a string
+	   that is not valid UTF-8. */
+	if (! ok)
+		return 0;
 
-	return length;
+	return writeObject (mio, buf);
 #undef OPT
 }
 
@@ -304,21 +491,3 @@ extern bool ptagMakeJsonOutputVersion (ptagDesc *desc, langType language CTAGS_A
 			       "in development",
 			       NULL);
 }
-
-#else /* HAVE_JANSSON */
-
-tagWriter jsonWriter = {
-	.writeEntry = NULL,
-	.writePtagEntry = NULL,
-	.preWriteEntry = NULL,
-	.postWriteEntry = NULL,
-	.defaultFileName = "-",
-};
-
-extern bool ptagMakeJsonOutputVersion (ptagDesc *desc, langType language CTAGS_ATTR_UNUSED,
-									   const void *data CTAGS_ATTR_UNUSED)
-{
-	return false;
-}
-
-#endif
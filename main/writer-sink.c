@@ -0,0 +1,358 @@
+/*
+*   Copyright (c) 2026, Universal Ctags Team
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License version 2 or (at your option) any later version.
+*
+*   This module implements the sink writer: a writer passing the tags of
+*   an input file to a callback of an application using ctags as a
+*   library, instead of rendering them as text.
+*
+*   The tags are copied to flat records while the input file is parsed,
+*   because a tagEntryInfo is valid only while it is written. When the
+*   parser finishes the input file, the records are handed to the
+*   callback at once. If the parser rescans the input file, the records
+*   made in the failed pass are dropped.
+*/
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"  /* must always come first */
+
+#include <string.h>
+
+#include "debug.h"
+#include "entry_p.h"
+#include "field_p.h"
+#include "parse_p.h"
+#include "routines.h"
+#include "trashbox.h"
+#include "vstring.h"
+#include "writer_p.h"
+#include "xtag.h"
+
+/*
+*   DATA DECLARATIONS
+*/
+
+/* A string in the arena; NO_STRING stands for NULL. */
+typedef size_t stringOffset;
+#define NO_STRING ((stringOffset) -1)
+
+typedef struct sSinkRecord {
+	stringOffset name;
+	stringOffset inputFile;
+	const char *language;
+	const char *kind;
+	char kindLetter;
+	stringOffset roles;
+	unsigned long lineNumber;
+	unsigned long endLine;
+	const char *scopeKind;
+	stringOffset scope;
+	stringOffset signature;
+	stringOffset typeRefKind;
+	stringOffset typeRefName;
+	stringOffset access;
+	stringOffset implementation;
+	stringOffset inheritance;
+	bool isFileScope;
+	bool isAnonymous;
+	unsigned int fieldStart;
+	unsigned int fieldCount;
+	size_t arenaStart;
+} sinkRecord;
+
+typedef struct sSinkFieldRecord {
+	const char *name;
+	stringOffset value;
+} sinkFieldRecord;
+
+/* The records of the input file being parsed */
+typedef struct sSinkBatch {
+	sinkRecord *records;
+	unsigned int count;
+	unsigned int allocated;
+
+	sinkFieldRecord *fields;
+	unsigned int fieldCount;
+	unsigned int fieldAllocated;
+
+	vString *arena;
+
+	/* The value of numTagsAdded () when the input file was opened */
+	unsigned long base;
+
+	/* Made from the records when they are passed to the callback */
+	tagSinkEntry *entries;
+	unsigned int entryAllocated;
+	tagSinkField *entryFields;
+	unsigned int entryFieldAllocated;
+} sinkBatch;
+
+/*
+*   FUNCTION PROTOTYPES
+*/
+static int writeSinkEntry (tagWriter *writer, MIO * mio, const tagEntryInfo *const tag,
+						   void *clientData);
+static void *beginSinkBatch (tagWriter *writer, MIO * mio, void *clientData);
+static bool endSinkBatch (tagWriter *writer, MIO * mio, const char* filename,
+						  void *clientData);
+static void rescanSinkFailed (tagWriter *writer, unsigned long validTagNum,
+							  void *clientData);
+
+/*
+*   DATA DEFINITIONS
+*/
+tagWriter sinkWriter = {
+	.writeEntry = writeSinkEntry,
+	.writePtagEntry = NULL,
+	.printPtagByDefault = false,
+	.preWriteEntry = beginSinkBatch,
+	.postWriteEntry = endSinkBatch,
+	.rescanFailedEntry = rescanSinkFailed,
+	.treatFieldAsFixed = NULL,
+	.defaultFileName = NULL,
+};
+
+static tagSinkFunc SinkFunc;
+static sinkBatch Batch;
+
+/*
+*   FUNCTION DEFINITIONS
+*/
+
+extern void setTagSink (tagSinkFunc func)
+{
+	SinkFunc = func;
+	setTagWriter (WRITER_SINK, NULL);
+}
+
+static void deleteBatch (void *data CTAGS_ATTR_UNUSED)
+{
+	eFree (Batch.records);
+	eFree (Batch.fields);
+	if (Batch.entries)
+		eFree (Batch.entries);
+	if (Batch.entryFields)
+		eFree (Batch.entryFields);
+	vStringDelete (Batch.arena);
+	memset (&Batch, 0, sizeof (Batch));
+}
+
+/* vStringPut () doesn't count '\0'. */
+static void terminateString (void)
+{
+	vStringNCatSUnsafe (Batch.arena, "", 1);
+}
+
+static stringOffset putString (const char *str)
+{
+	stringOffset offset;
+
+	if (str == NULL)
+		return NO_STRING;
+
+	offset = vStringLength (Batch.arena);
+	vStringCatS (Batch.arena, str);
+	terminateString ();
+	return offset;
+}
+
+static const char *getString (stringOffset offset)
+{
+	return (offset == NO_STRING)? NULL: vStringValue (Batch.arena) + offset;
+}
+
+static void *beginSinkBatch (tagWriter *writer CTAGS_ATTR_UNUSED,
+							 MIO * mio CTAGS_ATTR_UNUSED,
+							 void *clientData CTAGS_ATTR_UNUSED)
+{
+	if (Batch.arena == NULL)
+	{
+		Batch.allocated = 64;
+		Batch.records = xMalloc (Batch.allocated, sinkRecord);
+		Batch.fieldAllocated = 16;
+		Batch.fields = xMalloc (Batch.fieldAllocated, sinkFieldRecord);
+		Batch.arena = vStringNew ();
+		DEFAULT_TRASH_BOX (&Batch, deleteBatch);
+	}
+
+	Batch.count = 0;
+	Batch.fieldCount = 0;
+	vStringClear (Batch.arena);
+	Batch.base = numTagsAdded ();
+	return NULL;
+}
+
+static void putRoles (const tagEntryInfo *const tag, sinkRecord *r)
+{
+	bool first = true;
+
+	if (tag->extensionFields.roleBits == 0)
+	{
+		r->roles = NO_STRING;
+		return;
+	}
+
+	r->roles = vStringLength (Batch.arena);
+	for (unsigned int i = 0; i < ROLE_MAX_COUNT; i++)
+	{
+		if (! (tag->extensionFields.roleBits & ((roleBitsType)1 << i)))
+			continue;
+		if (! first)
+			vStringPut (Batch.arena, ',');
+		vStringCatS (Batch.arena,
+					 getLanguageRole (tag->langType, tag->kindIndex, (int) i)->name);
+		first = false;
+	}
+	terminateString ();
+}
+
+static void putParserFields (const tagEntryInfo *const tag, sinkRecord *r)
+{
+	r->fieldStart = Batch.fieldCount;
+	r->fieldCount = 0;
+
+	for (unsigned int i = 0; i < tag->usedParserFields; i++)
+	{
+		const tagField *f = getParserFieldForIndex (tag, i);
+
+		if (Batch.fieldCount == Batch.fieldAllocated)
+		{
+			Batch.fieldAllocated *= 2;
+			Batch.fields = xRealloc (Batch.fields, Batch.fieldAllocated, sinkFieldRecord);
+		}
+		Batch.fields [Batch.fieldCount].name = getFieldName (f->ftype);
+		Batch.fields [Batch.fieldCount].value = putString (f->value);
+		Batch.fieldCount++;
+		r->fieldCount++;
+	}
+}
+
+static int writeSinkEntry (tagWriter *writer CTAGS_ATTR_UNUSED,
+						   MIO * mio CTAGS_ATTR_UNUSED,
+						   const tagEntryInfo *const tag,
+						   void *clientData CTAGS_ATTR_UNUSED)
+{
+	const kindDefinition *kdef;
+	const char *scopeKind;
+	const char *scope;
+	sinkRecord *r;
+
+	if (Batch.count == Batch.allocated)
+	{
+		Batch.allocated *= 2;
+		Batch.records = xRealloc (Batch.records, Batch.allocated, sinkRecord);
+	}
+	r = Batch.records + Batch.count++;
+
+	/* const is discarded to resolve the scope in the cork queue. */
+	getTagScopeInformation ((tagEntryInfo *)tag, &scopeKind, &scope);
+
+	kdef = getLanguageKind (tag->langType, tag->kindIndex);
+
+	r->arenaStart = vStringLength (Batch.arena);
+	r->name = putString (tag->name);
+	r->inputFile = putString (tag->inputFileName);
+	r->language = getLanguageName (tag->langType);
+	r->kind = kdef->name;
+	r->kindLetter = kdef->letter;
+	putRoles (tag, r);
+	r->lineNumber = tag->lineNumber;
+	r->endLine = tag->extensionFields.endLine;
+	r->scopeKind = scopeKind;
+	r->scope = putString (scope);
+	r->signature = putString (tag->extensionFields.signature);
+	r->typeRefKind = putString (tag->extensionFields.typeRef [0]);
+	r->typeRefName = putString (tag->extensionFields.typeRef [1]);
+	r->access = putString (tag->extensionFields.access);
+	r->implementation = putString (tag->extensionFields.implementation);
+	r->inheritance = putString (tag->extensionFields.inheritance);
+	r->isFileScope = tag->isFileScope;
+	r->isAnonymous = isTagExtraBitMarked (tag, XTAG_ANONYMOUS);
+	putParserFields (tag, r);
+
+	/* Nothing is written, but the tag must be counted for rescanning. */
+	return 1;
+}
+
+static void rescanSinkFailed (tagWriter *writer CTAGS_ATTR_UNUSED,
+							  unsigned long validTagNum,
+							  void *clientData CTAGS_ATTR_UNUSED)
+{
+	unsigned int valid;
+
+	Assert (validTagNum >= Batch.base);
+	valid = (unsigned int) (validTagNum - Batch.base);
+	if (valid >= Batch.count)
+		return;
+
+	vStringTruncate (Batch.arena, Batch.records [valid].arenaStart);
+	Batch.fieldCount = Batch.records [valid].fieldStart;
+	Batch.count = valid;
+}
+
+static void makeEntries (void)
+{
+	if (Batch.entryAllocated < Batch.count)
+	{
+		Batch.entryAllocated = Batch.allocated;
+		Batch.entries = xRealloc (Batch.entries, Batch.entryAllocated, tagSinkEntry);
+	}
+	if (Batch.entryFieldAllocated < Batch.fieldCount)
+	{
+		Batch.entryFieldAllocated = Batch.fieldAllocated;
+		Batch.entryFields = xRealloc (Batch.entryFields, Batch.entryFieldAllocated,
+									  tagSinkField);
+	}
+
+	for (unsigned int i = 0; i < Batch.fieldCount; i++)
+	{
+		Batch.entryFields [i].name = Batch.fields [i].name;
+		Batch.entryFields [i].value = getString (Batch.fields [i].value);
+	}
+
+	for (unsigned int i = 0; i < Batch.count; i++)
+	{
+		const sinkRecord *r = Batch.records + i;
+		tagSinkEntry *e = Batch.entries + i;
+
+		e->name = getString (r->name);
+		e->inputFile = getString (r->inputFile);
+		e->language = r->language;
+		e->kind = r->kind;
+		e->kindLetter = r->kindLetter;
+		e->roles = getString (r->roles);
+		e->lineNumber = r->lineNumber;
+		e->endLine = r->endLine;
+		e->scopeKind = r->scopeKind;
+		e->scope = getString (r->scope);
+		e->signature = getString (r->signature);
+		e->typeRefKind = getString (r->typeRefKind);
+		e->typeRefName = getString (r->typeRefName);
+		e->access = getString (r->access);
+		e->implementation = getString (r->implementation);
+		e->inheritance = getString (r->inheritance);
+		e->isFileScope = r->isFileScope;
+		e->isAnonymous = r->isAnonymous;
+		e->fields = r->fieldCount? Batch.entryFields + r->fieldStart: NULL;
+		e->fieldCount = r->fieldCount;
+	}
+}
+
+static bool endSinkBatch (tagWriter *writer CTAGS_ATTR_UNUSED,
+						  MIO * mio CTAGS_ATTR_UNUSED,
+						  const char* filename,
+						  void *clientData)
+{
+	makeEntries ();
+	if (SinkFunc)
+		SinkFunc (filename, Batch.entries, Batch.count, clientData);
+
+	Batch.count = 0;
+	Batch.fieldCount = 0;
+	vStringClear (Batch.arena);
+	return false;
+}
@@ -19,6 +19,8 @@ extern tagWriter eCtagsWriter;
 extern tagWriter etagsWriter;
 extern tagWriter xrefWriter;
 extern tagWriter jsonWriter;
+extern tagWriter binaryWriter;
+extern tagWriter sinkWriter;
 
 static tagWriter *writerTable [WRITER_COUNT] = {
 	[WRITER_U_CTAGS] = &uCtagsWriter,
@@ -26,6 +28,8 @@ static tagWriter *writerTable [WRITER_COUNT] = {
 	[WRITER_ETAGS] = &etagsWriter,
 	[WRITER_XREF]  = &xrefWriter,
 	[WRITER_JSON]  = &jsonWriter,
+	[WRITER_BINARY] = &binaryWriter,
+	[WRITER_SINK] = &sinkWriter,
 	[WRITER_CUSTOM] = NULL,
 };
 
@@ -91,6 +95,22 @@ extern void writerRescanFailed (unsigned long validTagNum)
 		writer->rescanFailedEntry(writer, validTagNum, writer->clientData);
 }
 
+extern void writerFinishOutput (MIO *mio)
+{
+	if (writer->finishOutput)
+		writer->finishOutput (writer, mio, writer->clientData);
+}
+
+extern bool writerSortsEntries (void)
+{
+	return writer->sortsEntries;
+}
+
+extern bool writerIsCtags (void)
+{
+	return (writer == &uCtagsWriter || writer == &eCtagsWriter);
+}
+
 extern bool ptagMakeCtagsOutputMode (ptagDesc *desc, langType langType CTAGS_ATTR_UNUSED,
 									 const void *data CTAGS_ATTR_UNUSED)
 {
@@ -26,6 +26,8 @@ typedef enum eWriterType {
 	WRITER_ETAGS,
 	WRITER_XREF,
 	WRITER_JSON,
+	WRITER_BINARY,
+	WRITER_SINK,
 	WRITER_CUSTOM,
 	WRITER_COUNT,
 } writerType;
@@ -50,6 +52,15 @@ struct sTagWriter {
 							  void *clientData);
 	void (* rescanFailedEntry) (tagWriter *writer, unsigned long validTagNum,
 								void *clientData);
+
+	/* Called once before the tag file is closed. A writer keeping
+	   entries in memory writes them here. */
+	void (* finishOutput) (tagWriter *writer, MIO * mio, void *clientData);
+
+	/* TRUE means the writer sorts entries by itself in finishOutput.
+	   The tag file is not sorted as text lines. */
+	bool sortsEntries;
+
 	bool (* treatFieldAsFixed) (int fieldType);
 
 	void (* checkOptions) (tagWriter *writer, bool fieldsWereReset);
@@ -82,9 +93,54 @@ int writerWritePtag (MIO * mio,
 					 const char *const parserName);
 
 void writerRescanFailed (unsigned long validTagNum);
+extern void writerFinishOutput (MIO *mio);
+extern bool writerSortsEntries (void);
+extern bool writerIsCtags (void);
 
 extern const char *outputDefaultFileName (void);
 
+/* A tag passed to a tag sink. The pointers are valid only while the
+   sink function runs. A string member is NULL if the tag has no value
+   for it. */
+typedef struct sTagSinkField {
+	const char *name;
+	const char *value;
+} tagSinkField;
+
+typedef struct sTagSinkEntry {
+	const char *name;
+	const char *inputFile;
+	const char *language;
+	const char *kind;
+	char kindLetter;
+	const char *roles;			/* comma separated; NULL for a definition tag */
+	unsigned long lineNumber;
+	unsigned long endLine;		/* 0 if unknown */
+	const char *scopeKind;
+	const char *scope;
+	const char *signature;
+	const char *typeRefKind;
+	const char *typeRefName;
+	const char *access;
+	const char *implementation;
+	const char *inheritance;
+	bool isFileScope;
+	bool isAnonymous;
+	const tagSinkField *fields;	/* parser own fields */
+	unsigned int fieldCount;
+} tagSinkEntry;
+
+/* Called once for each input file after the file is parsed, even if
+   no tag is made. CLIENTDATA is the value passed to parseRawBuffer()
+   or parseFileWithMio(). */
+typedef void (* tagSinkFunc) (const char *inputFile,
+							  const tagSinkEntry *entries, unsigned int count,
+							  void *clientData);
+
+/* Makes FUNC receive the tags directly instead of rendering them with
+   a writer. This is for applications using ctags as a library. */
+extern void setTagSink (tagSinkFunc func);
+
 extern size_t truncateTagLineAfterTag (char *const line, const char *const token,
 			     const bool discardNewline);
 extern void abort_if_ferror(MIO *const fp);
@@ -26,6 +26,7 @@ help:
 	@echo "make chop                         - Verify the behavior of parsers for broken input: randomly truncated from tail"
 	@echo "make slap                         - Verify the behavior of parsers for broken input: randomly truncated from head"
 	@echo "make roundtrip                    - Verify the behavior of readtags command"
+	@echo "make bench                        - Measure the throughput of $(CTAGS_PROG) with generated inputs"
 	@echo
 	@echo "Arguments that can be used in testing targets:"
 	@echo
@@ -36,6 +37,8 @@ help:
 	@echo "UNITS=<case>[,<case>]             - Only run tests named Units/[category.r/]/<case>.d in units target"
 	@echo "                                                         Tmain/<case>.d in tmain target"
 	@echo "PMAP=<newlang>/<oldlang>[,...]    - Make <newlang> parser pretend <oldlang> (units target only)"
+	@echo "BENCH_SAVE=<file>                 - Record the throughput to <file> (bench target only)"
+	@echo "BENCH_BASELINE=<file>             - Fail when slower than <file> by more than BENCH_TOLERANCE percent [10]"
 	@echo ""
 	@echo "Input validation target:"
 	@echo ""
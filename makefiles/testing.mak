@@ -1,14 +1,15 @@
 # -*- makefile -*-
-.PHONY: check units fuzz noise tmain tinst tlib man-test clean-units clean-tlib clean-tmain clean-gcov clean-man-test run-gcov codecheck cppcheck dicts validate-input check-genfile tutil
+.PHONY: check units fuzz noise tmain tinst tlib man-test clean-units clean-tlib clean-tmain clean-gcov clean-man-test run-gcov codecheck cppcheck dicts validate-input check-genfile tutil bench clean-bench
 
 EXTRA_DIST += misc/units misc/units.py misc/man-test.py
 EXTRA_DIST += misc/tlib misc/mini-geany.expected
+EXTRA_DIST += misc/bench
 MAN_TEST_TMPDIR = ManTest
 
 check: tmain units tlib man-test check-genfile tutil
 
 # We may use CLEANFILES, DISTCLEANFILES, or etc.
-clean-local: clean-units clean-tmain clean-man-test clean-tlib clean-gcov
+clean-local: clean-units clean-tmain clean-man-test clean-tlib clean-gcov clean-bench
 
 CTAGS_TEST = ./ctags$(EXEEXT)
 READTAGS_TEST = ./readtags$(EXEEXT)
@@ -110,9 +111,54 @@ slap: $(CTAGS_DEP)
 		--with-timeout=$(TIMEOUT)"; \
 	$(SHELL) $${c} $(srcdir)/Units
 
+#
+# BENCH Target
+#
+# Measure the throughput with generated inputs.
+#
+#    $ make bench BENCH_SAVE=baseline.tsv
+#    $ make bench BENCH_BASELINE=baseline.tsv
+#
+BENCH_BASELINE=
+BENCH_SAVE=
+BENCH_TOLERANCE=10
+BENCH_REPEAT=3
+BENCH_SCALE=1
+bench: $(CTAGS_DEP)
+	$(V_RUN) \
+	if ! test x$(LANGUAGES) = x; then	\
+		BENCH_LANGUAGES=--languages=$(LANGUAGES);	\
+	fi;					\
+	if ! test x$(BENCH_BASELINE) = x; then	\
+		BENCH_BASELINE_OPT=--baseline=$(BENCH_BASELINE);	\
+	fi;					\
+	if ! test x$(BENCH_SAVE) = x; then	\
+		BENCH_SAVE_OPT=--save=$(BENCH_SAVE);	\
+	fi;					\
+	$(SHELL) $(srcdir)/misc/bench $(CTAGS_TEST) $$(pwd)/Bench \
+		--tolerance=$(BENCH_TOLERANCE) \
+		--repeat=$(BENCH_REPEAT) \
+		--scale=$(BENCH_SCALE) \
+		$${BENCH_LANGUAGES} $${BENCH_BASELINE_OPT} $${BENCH_SAVE_OPT}
+
+clean-bench:
+	$(SILENT) echo Cleaning benchmark files
+	$(SILENT) rm -rf $$(pwd)/Bench
+
 #
 # UNITS Target
 #
+# With UNITS_TIMING=<N>, each passed test case runs <N> more times for
+# recording its runtime; this needs PYTHON.
+#
+#    $ make units PYTHON=python3 UNITS_TIMING=5 UNITS_TIMING_SAVE=baseline.tsv
+#    $ make units PYTHON=python3 UNITS_TIMING=5 UNITS_TIMING_BASELINE=baseline.tsv
+#
+UNITS_TIMING=
+UNITS_TIMING_BASELINE=
+UNITS_TIMING_SAVE=
+UNITS_TIMING_TOLERANCE=25
+UNITS_THREADS=4
 units: $(CTAGS_DEP)
 	$(V_RUN) \
 	if test -n "$${ZSH_VERSION+set}"; then set -o SH_WORD_SPLIT; fi; \
@@ -136,7 +182,21 @@ units: $(CTAGS_DEP)
 				SHELL_OPT=--shell=$(SHELL);	\
 			fi;	\
 		fi;	\
+		THREADS_OPT=--threads=$(UNITS_THREADS);	\
+		if ! test x$(UNITS_TIMING) = x; then	\
+			TIMING_OPT="--with-timing=$(UNITS_TIMING) --timing-tolerance=$(UNITS_TIMING_TOLERANCE)";	\
+			if ! test x$(UNITS_TIMING_BASELINE) = x; then	\
+				TIMING_OPT="$${TIMING_OPT} --timing-baseline=$(UNITS_TIMING_BASELINE)";	\
+			fi;	\
+			if ! test x$(UNITS_TIMING_SAVE) = x; then	\
+				TIMING_OPT="$${TIMING_OPT} --save-timing=$(UNITS_TIMING_SAVE)";	\
+			fi;	\
+		fi;	\
 	else	\
+		if ! test x$(UNITS_TIMING) = x; then	\
+			echo "UNITS_TIMING needs PYTHON" 1>&2;	\
+			exit 1;	\
+		fi;	\
 		PROG=$(SHELL);		\
 		SCRIPT=$(srcdir)/misc/units;	\
 	fi;	\
@@ -150,7 +210,7 @@ units: $(CTAGS_DEP)
 		--with-pretense-map=$(PMAP) \
 		$${VALGRIND} --run-shrink \
 		--with-timeout=`expr $(TIMEOUT) '*' 10`\
-		$${SHELL_OPT} \
+		$${SHELL_OPT} $${THREADS_OPT} $${TIMING_OPT} \
 		$${SHOW_DIFF_OUTPUT}"; \
 		 $${PROG} $${c} $(srcdir)/Units $${builddir}/Units
 
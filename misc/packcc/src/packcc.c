@@ -4445,9 +4445,10 @@ static bool_t generate(context_t *ctx) {
             "    static pcc_value_t null;\n"
             "    pcc_thunk_chunk_t *c = NULL;\n"
             "    const size_t p = ctx->pos + ctx->cur;\n"
+            "    const size_t q = ctx->cur; /* the index in the memo table, which is shifted on commit */\n"
             "    pcc_bool_t b = PCC_TRUE;\n"
-            "    pcc_lr_answer_t *a = pcc_lr_table__get_answer(ctx, &ctx->lrtable, p, rule);\n"
-            "    pcc_lr_head_t *h = pcc_lr_table__get_head(ctx, &ctx->lrtable, p);\n"
+            "    pcc_lr_answer_t *a = pcc_lr_table__get_answer(ctx, &ctx->lrtable, q, rule);\n"
+            "    pcc_lr_head_t *h = pcc_lr_table__get_head(ctx, &ctx->lrtable, q);\n"
             "    if (h != NULL) {\n"
             "        if (a == NULL && rule != h->rule && pcc_rule_set__index(ctx->auxil, &h->invol, rule) == PCC_VOID_VALUE) {\n"
             "            b = PCC_FALSE;\n"
@@ -4458,7 +4459,7 @@ static bool_t generate(context_t *ctx) {
             "            c = rule(ctx);\n"
             "            a = pcc_lr_answer__create(ctx, PCC_LR_ANSWER_CHUNK, ctx->pos + ctx->cur);\n"
             "            a->data.chunk = c;\n"
-            "            pcc_lr_table__hold_answer(ctx, &ctx->lrtable, p, a);\n"
+            "            pcc_lr_table__hold_answer(ctx, &ctx->lrtable, q, a);\n"
             "        }\n"
             "    }\n"
             "    if (b) {\n"
@@ -4468,7 +4469,7 @@ static bool_t generate(context_t *ctx) {
             "            case PCC_LR_ANSWER_LR:\n"
             "                if (a->data.lr->head == NULL) {\n"
             "                    a->data.lr->head = pcc_lr_head__create(ctx, rule);\n"
-            "                    pcc_lr_table__hold_head(ctx, &ctx->lrtable, p, a->data.lr->head);\n"
+            "                    pcc_lr_table__hold_head(ctx, &ctx->lrtable, q, a->data.lr->head);\n"
             "                }\n"
             "                {\n"
             "                    size_t i = ctx->lrstack.len;\n"
@@ -4493,7 +4494,7 @@ static bool_t generate(context_t *ctx) {
             "            pcc_lr_stack__push(ctx->auxil, &ctx->lrstack, e);\n"
             "            a = pcc_lr_answer__create(ctx, PCC_LR_ANSWER_LR, p);\n"
             "            a->data.lr = e;\n"
-            "            pcc_lr_table__set_answer(ctx, &ctx->lrtable, p, rule, a);\n"
+            "            pcc_lr_table__set_answer(ctx, &ctx->lrtable, q, rule, a);\n"
             "            c = rule(ctx);\n"
             "            pcc_lr_stack__pop(ctx->auxil, &ctx->lrstack);\n"
             "            a->pos = ctx->pos + ctx->cur;\n"
@@ -4507,7 +4508,7 @@ static bool_t generate(context_t *ctx) {
             "                    c = a->data.lr->seed;\n"
             "                    a = pcc_lr_answer__create(ctx, PCC_LR_ANSWER_CHUNK, ctx->pos + ctx->cur);\n"
             "                    a->data.chunk = c;\n"
-            "                    pcc_lr_table__hold_answer(ctx, &ctx->lrtable, p, a);\n"
+            "                    pcc_lr_table__hold_answer(ctx, &ctx->lrtable, q, a);\n"
             "                }\n"
             "                else {\n"
             "                    pcc_lr_answer__set_chunk(ctx, a, a->data.lr->seed);\n"
@@ -4515,7 +4516,7 @@ static bool_t generate(context_t *ctx) {
             "                        c = NULL;\n"
             "                    }\n"
             "                    else {\n"
-            "                        pcc_lr_table__set_head(ctx, &ctx->lrtable, p, h);\n"
+            "                        pcc_lr_table__set_head(ctx, &ctx->lrtable, q, h);\n"
             "                        for (;;) {\n"
             "                            ctx->cur = p - ctx->pos;\n"
             "                            pcc_rule_set__copy(ctx->auxil, &h->eval, &h->invol);\n"
@@ -4525,7 +4526,7 @@ static bool_t generate(context_t *ctx) {
             "                            a->pos = ctx->pos + ctx->cur;\n"
             "                        }\n"
             "                        pcc_thunk_chunk__destroy(ctx, c);\n"
-            "                        pcc_lr_table__set_head(ctx, &ctx->lrtable, p, NULL);\n"
+            "                        pcc_lr_table__set_head(ctx, &ctx->lrtable, q, NULL);\n"
             "                        ctx->cur = a->pos - ctx->pos;\n"
             "                        c = a->data.chunk;\n"
             "                    }\n"
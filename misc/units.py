@@ -59,6 +59,9 @@ RUN_SHRINK = False
 SHOW_DIFF_OUTPUT = False
 NUM_WORKER_THREADS = 4
 DIFF_U_NUM = 0
+TIMING_REPEAT = 0
+TIMING_BASELINE = None
+TIMING_TOLERANCE = 25
 
 #
 # Internal variables and constants
@@ -72,6 +75,8 @@ _VALGRIND_EXIT = 58
 _STDERR_OUTPUT_NAME = 'STDERR.tmp'
 _DIFF_OUTPUT_NAME = 'DIFF.tmp'
 _VALGRIND_OUTPUT_NAME = 'VALGRIND.tmp'
+# Changes of the runtime smaller than this (in seconds) are noise.
+_TIMING_NOISE = 0.005
 
 #
 # Results
@@ -90,6 +95,14 @@ L_VALGRIND = []
 TMAIN_STATUS = True
 TMAIN_FAILED = []
 
+#
+# Timing mode (--with-timing)
+# test case => (language, the best runtime, the median runtime)
+#
+TIMINGS = {}
+L_TIMING_SLOWER = []
+L_TIMING_FASTER = []
+
 def remove_prefix(string, prefix):
     if string.startswith(prefix):
         return string[len(prefix):]
@@ -414,6 +427,21 @@ def guess_lang_from_log(log):
                 return ret.group(1)
     return ''
 
+def run_timing(tcase, cmdline, lang, timeout_value):
+    # The messages for guessing the language are not needed here.
+    cmdline = [x for x in cmdline if x != '--verbose']
+    runtimes = []
+    for i in range(TIMING_REPEAT):
+        start = time.perf_counter()
+        try:
+            subprocess.run(cmdline, stdout=subprocess.DEVNULL,
+                    stderr=subprocess.DEVNULL, timeout=timeout_value)
+        except subprocess.TimeoutExpired:
+            return
+        runtimes.append(time.perf_counter() - start)
+    runtimes.sort()
+    TIMINGS[tcase] = (lang, runtimes[0], runtimes[len(runtimes) // 2])
+
 def run_tcase(finput, t, name, tclass, category, build_t, extra_inputs):
     global L_PASSED
     global L_FIXED
@@ -634,6 +662,8 @@ def run_tcase(finput, t, name, tclass, category, build_t, extra_inputs):
             L_FIXED += [category + '/' + name]
 
         L_PASSED += [category + '/' + name]
+        if TIMING_REPEAT > 0:
+            run_timing(category + '/' + name, cmdline, guessed_lang, timeout_value)
         run_result('ok', msg, None, '"expected.tags*" not found')
         return True
 
@@ -671,6 +701,8 @@ def run_tcase(finput, t, name, tclass, category, build_t, extra_inputs):
             L_FIXED += [category + '/' + name]
 
         L_PASSED += [category + '/' + name]
+        if TIMING_REPEAT > 0:
+            run_timing(category + '/' + name, cmdline, guessed_lang, timeout_value)
         run_result('ok', msg, None)
         return True
     else:
@@ -856,6 +888,69 @@ def run_summary(build_dir):
                 print("\t" + remove_prefix(t, _DEFAULT_CATEGORY + '/'))
                 run_show_valgrind_output(build_dir, remove_prefix(t, _DEFAULT_CATEGORY + '/'))
 
+def load_timing(fname):
+    r = {}
+    with open(fname, 'r') as f:
+        for l in f:
+            if l.startswith('#'):
+                continue
+            fields = l.rstrip('\n').split('\t')
+            if len(fields) != 4:
+                continue
+            r[fields[0]] = (fields[1], float(fields[2]), float(fields[3]))
+    return r
+
+def save_timing(fname):
+    with open(fname, 'w') as f:
+        print('# test case, language, the best and the median runtime (s) of %d runs'
+              % TIMING_REPEAT, file=f)
+        for t in sorted(TIMINGS):
+            (lang, best, median) = TIMINGS[t]
+            print('%s\t%s\t%.6f\t%.6f' % (t, lang, best, median), file=f)
+
+def compare_timing(baseline):
+    global L_TIMING_SLOWER
+    global L_TIMING_FASTER
+
+    # The best runtimes are compared; they are the least disturbed by
+    # the other processes.
+    for t in sorted(TIMINGS):
+        if not t in baseline:
+            continue
+        now = TIMINGS[t][1]
+        base = baseline[t][1]
+        if abs(now - base) < _TIMING_NOISE or base <= 0:
+            continue
+        d = (now - base) * 100 / base
+        if d > TIMING_TOLERANCE:
+            L_TIMING_SLOWER += [(t, base, now, d)]
+        elif d < -TIMING_TOLERANCE:
+            L_TIMING_FASTER += [(t, base, now, d)]
+
+def run_timing_summary():
+    fmt = '  %-40s%d'
+    tfmt = '\t%-50s %8.3f -> %8.3f (%+.1f%%)'
+
+    print()
+    print('Timing (the best of %d runs in seconds)' % TIMING_REPEAT)
+    line()
+
+    print(fmt % ('#timed:', len(TIMINGS)))
+    print('  slowest:')
+    slowest = sorted(TIMINGS.items(), key=lambda x: x[1][1], reverse=True)
+    for (t, (lang, best, median)) in slowest[:10]:
+        print('\t%-50s %8.3f (%s)' % (remove_prefix(t, _DEFAULT_CATEGORY + '/'), best, lang))
+
+    if TIMING_BASELINE is None:
+        return
+
+    print(fmt % ('#SLOWER (> ' + str(TIMING_TOLERANCE) + '%):', len(L_TIMING_SLOWER)))
+    for (t, base, now, d) in L_TIMING_SLOWER:
+        print(tfmt % (remove_prefix(t, _DEFAULT_CATEGORY + '/'), base, now, d))
+    print(fmt % ('#faster (> ' + str(TIMING_TOLERANCE) + '%):', len(L_TIMING_FASTER)))
+    for (t, base, now, d) in L_TIMING_FASTER:
+        print(tfmt % (remove_prefix(t, _DEFAULT_CATEGORY + '/'), base, now, d))
+
 def make_pretense_map(arg):
     r = ''
     for p in arg.split(','):
@@ -886,6 +981,9 @@ def action_run(parser, action, *args):
     global PRETENSE_OPTS
     global NUM_WORKER_THREADS
     global SHELL
+    global TIMING_REPEAT
+    global TIMING_BASELINE
+    global TIMING_TOLERANCE
 
     parser.add_argument('--categories', metavar='CATEGORY1[,CATEGORY2,...]',
             help='run only CATEGORY* related cases.')
@@ -910,7 +1008,17 @@ def action_run(parser, action, *args):
             metavar='NEWLANG0/OLDLANG0[,...]',
             help='make NEWLANG parser pretend OLDLANG.')
     parser.add_argument('--threads', type=int, default=NUM_WORKER_THREADS,
-            help='number of worker threads')
+            help='number of worker threads. 0 means the number of CPUs.')
+    parser.add_argument('--with-timing', type=int, default=0,
+            metavar='REPEAT',
+            help='run each passed test case REPEAT more times and record its runtime.')
+    parser.add_argument('--save-timing', metavar='FILE',
+            help='save the runtimes recorded with --with-timing to FILE as a baseline.')
+    parser.add_argument('--timing-baseline', metavar='FILE',
+            help='compare the runtimes recorded with --with-timing with the ones in FILE, and fail if a test case gets slower.')
+    parser.add_argument('--timing-tolerance', type=int, default=TIMING_TOLERANCE,
+            metavar='PERCENT',
+            help='changes of the runtime within PERCENT are not reported (default: %(default)s).')
     parser.add_argument('--shell',
             help='shell to be used.')
     parser.add_argument('units_dir',
@@ -936,10 +1044,22 @@ def action_run(parser, action, *args):
     if res.with_pretense_map:
         PRETENSE_OPTS = make_pretense_map(res.with_pretense_map)
     NUM_WORKER_THREADS = res.threads
+    if NUM_WORKER_THREADS == 0:
+        NUM_WORKER_THREADS = os.cpu_count() or 1
     if res.shell:
         SHELL = res.shell
     if res.build_dir == '':
         res.build_dir = res.units_dir
+    TIMING_REPEAT = res.with_timing
+    TIMING_TOLERANCE = res.timing_tolerance
+    if (res.save_timing or res.timing_baseline) and TIMING_REPEAT == 0:
+        error_exit(1, '--save-timing and --timing-baseline need --with-timing')
+    if TIMING_REPEAT > 0 and WITH_VALGRIND:
+        error_exit(1, '--with-timing cannot be used with --with-valgrind')
+    if res.timing_baseline:
+        if not os.path.isfile(res.timing_baseline):
+            error_exit(1, 'No such file: ' + res.timing_baseline)
+        TIMING_BASELINE = load_timing(res.timing_baseline)
 
     if WITH_VALGRIND:
         check_availability('valgrind')
@@ -965,9 +1085,17 @@ def action_run(parser, action, *args):
 
     run_summary(build_dir)
 
+    if TIMING_REPEAT > 0:
+        if TIMING_BASELINE is not None:
+            compare_timing(TIMING_BASELINE)
+        run_timing_summary()
+        if res.save_timing:
+            save_timing(res.save_timing)
+            print('Saved the runtimes to ' + res.save_timing)
+
     if L_FAILED_BY_STATUS or L_FAILED_BY_DIFF or \
             L_FAILED_BY_TIMEED_OUT or L_BROKEN_ARGS_CTAGS or \
-            L_VALGRIND:
+            L_VALGRIND or L_TIMING_SLOWER:
         return 1
     else:
         return 0
@@ -35,7 +35,7 @@ static void initializeSCSSParser (const langType language)
 	                               "^\"",
 	                               "", "", "{tenter=strd}", NULL);
 	addLanguageTagMultiTableRegex (language, "toplevel",
-	                               "^[ \t]([A-Za-z0-9_-]+)[ \t]*:[^\n]*\n?",
+	                               "^[ \t]([A-Za-z0-9_-]+)[ \t]*:([^\n;'\"]|'([^'\\\\\n]|\\\\.)*'|\"([^\"\\\\\n]|\\\\.)*\"|['\"])*;?\n?",
 	                               "", "", "", NULL);
 	addLanguageTagMultiTableRegex (language, "toplevel",
 	                               "^@mixin[ \t]+([A-Za-z0-9_-]+)",
@@ -47,28 +47,28 @@ static void initializeSCSSParser (const langType language)
 	                               "^@each[ \t]+\\$([A-Za-z0-9_-]+)[ \t]in[ \t]+",
 	                               "\\1", "v", "", NULL);
 	addLanguageTagMultiTableRegex (language, "toplevel",
-	                               "^@for[ \t]+\\$([A-Za-z0-9_-]+)[ \t]from[ \t]+.*[ \t]+(to|through)[ \t]+[^{]+",
+	                               "^@for[ \t]+\\$([A-Za-z0-9_-]+)[ \t]from[ \t]+[^{]*[ \t]+(to|through)[ \t]+[^{]+",
 	                               "\\1", "v", "", NULL);
 	addLanguageTagMultiTableRegex (language, "toplevel",
-	                               "^@[^\n]+\n?",
+	                               "^@[^\n;{]+[;{]?\n?",
 	                               "", "", "", NULL);
 	addLanguageTagMultiTableRegex (language, "toplevel",
-	                               "^:[^{;]+;\n?",
+	                               "^:[^{};]+;\n?",
 	                               "", "", "", NULL);
 	addLanguageTagMultiTableRegex (language, "toplevel",
-	                               "^:[^\n;{]+\n",
+	                               "^:[^\n;{}]+\n",
 	                               "", "", "", NULL);
 	addLanguageTagMultiTableRegex (language, "toplevel",
 	                               "^::?([A-Za-z0-9_-]+)[ \t]*[,({]",
 	                               "", "", "", NULL);
 	addLanguageTagMultiTableRegex (language, "toplevel",
-	                               "^:[^\n{]+[;{]\n?",
+	                               "^:[^\n{}]+[;{]\n?",
 	                               "", "", "", NULL);
 	addLanguageTagMultiTableRegex (language, "toplevel",
 	                               "^\\$([A-Za-z0-9_-]+)[ \t]*:[ \t]*\\(",
 	                               "\\1", "v", "{tenter=map}", NULL);
 	addLanguageTagMultiTableRegex (language, "toplevel",
-	                               "^\\$([A-Za-z0-9_-]+)[ \t]*:[^\n]*\n?",
+	                               "^\\$([A-Za-z0-9_-]+)[ \t]*:([^\n;'\"]|'([^'\\\\\n]|\\\\.)*'|\"([^\"\\\\\n]|\\\\.)*\"|['\"])*;?\n?",
 	                               "\\1", "v", "", NULL);
 	addLanguageTagMultiTableRegex (language, "toplevel",
 	                               "^[.]([A-Za-z0-9_-]+)",
@@ -79,18 +79,27 @@ static void initializeSCSSParser (const langType language)
 	addLanguageTagMultiTableRegex (language, "toplevel",
 	                               "^#([A-Za-z0-9_-]+)",
 	                               "\\1", "i", "", NULL);
+	addLanguageTagMultiTableRegex (language, "toplevel",
+	                               "^[^/#'\"@:$.% \t]+",
+	                               "", "", "", NULL);
 	addLanguageTagMultiTableRegex (language, "toplevel",
 	                               "^.",
 	                               "", "", "", NULL);
 	addLanguageTagMultiTableRegex (language, "comment",
 	                               "^\\*/",
 	                               "", "", "{tleave}", NULL);
+	addLanguageTagMultiTableRegex (language, "comment",
+	                               "^[^*]+",
+	                               "", "", "", NULL);
 	addLanguageTagMultiTableRegex (language, "comment",
 	                               "^.",
 	                               "", "", "", NULL);
 	addLanguageTagMultiTableRegex (language, "interp",
 	                               "^\\}",
 	                               "", "", "{tleave}", NULL);
+	addLanguageTagMultiTableRegex (language, "interp",
+	                               "^[^}]+",
+	                               "", "", "", NULL);
 	addLanguageTagMultiTableRegex (language, "interp",
 	                               "^.",
 	                               "", "", "", NULL);
@@ -103,6 +112,9 @@ static void initializeSCSSParser (const langType language)
 	addLanguageTagMultiTableRegex (language, "args",
 	                               "^\\$([A-Za-z0-9_-]+)[ \t]*(:([ \t]*\\$)?|[,)])",
 	                               "\\1", "z", "", NULL);
+	addLanguageTagMultiTableRegex (language, "args",
+	                               "^[^{#$]+",
+	                               "", "", "", NULL);
 	addLanguageTagMultiTableRegex (language, "args",
 	                               "^.",
 	                               "", "", "", NULL);
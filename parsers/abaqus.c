@@ -124,5 +124,6 @@ extern parserDefinition* AbaqusParser (void)
 	def->kindCount  = ARRAY_SIZE (AbaqusKinds);
 	def->extensions = extensions;
 	def->parser     = findAbaqusTags;
+	def->reentrant  = true;
 	return def;
 }
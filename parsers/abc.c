@@ -72,6 +72,7 @@ extern parserDefinition* AbcParser (void)
 	def->patterns = patterns;
 	def->extensions = extensions;
 	def->parser = findAbcTags;
+	def->reentrant = true;
 	return def;
 }
 
@@ -168,7 +168,14 @@ static void newTokenCallback (yamlSubparser *s, yaml_token_t *token)
 {
 	if (token->type == YAML_BLOCK_SEQUENCE_START_TOKEN
 		|| token->type == YAML_BLOCK_MAPPING_START_TOKEN)
-		pushBlockType ((struct sAnsiblePlaybookSubparser *)s, token->type);
+	{
+		struct sAnsiblePlaybookSubparser *ansible = (struct sAnsiblePlaybookSubparser *)s;
+
+		pushBlockType (ansible, token->type);
+		/* A play is in a mapping in the top level sequence. */
+		if (ansible->type_stack->next && ansible->type_stack->next->next)
+			yamlSkipBlock (s);
+	}
 
 	ansiblePlaybookPlayStateMachine ((struct sAnsiblePlaybookSubparser *)s, token);
 
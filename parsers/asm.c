@@ -157,29 +157,31 @@ static const char *extraLinesepChars = defaultExtraLinesepChars;
 
 static bool useCPreProcessor = true;
 
+/* The characters readLineViaCppInBulk () takes with cppGetcSpan (): the
+ * ones ending neither the line nor the part of it before a comment. */
+static bool lineSpanChars [256];
+
 /*
 *   FUNCTION DEFINITIONS
 */
 static opKeyword analyzeOperator (const vString *const op)
 {
-	vString *keyword = vStringNew ();
-	opKeyword result;
+	static vString *keyword;
 
+	keyword = vStringNewOrClearWithAutoRelease (keyword);
 	vStringCopyToLower (keyword, op);
-	result = (opKeyword) lookupKeyword (vStringValue (keyword), Lang_asm);
-	vStringDelete (keyword);
-	return result;
+	return (opKeyword) lookupKeyword (vStringValue (keyword), Lang_asm);
 }
 
 static bool isInitialSymbolCharacter (int c)
 {
-	return (bool) (c != '\0' && (isalpha (c) || strchr ("_$", c) != NULL));
+	return (bool) (isalpha (c) || c == '_' || c == '$');
 }
 
 static bool isSymbolCharacter (int c)
 {
 	/* '?' character is allowed in AMD 29K family */
-	return (bool) (c != '\0' && (isalnum (c) || strchr ("_$?", c) != NULL));
+	return (bool) (isalnum (c) || c == '_' || c == '$' || c == '?');
 }
 
 static AsmKind operatorKind (
@@ -450,6 +452,51 @@ static bool processCppMacroX (vString *identifier, int lastChar, vString *line)
 	return r;
 }
 
+static bool isLineSeparator (int c)
+{
+	return (c == '\n' || (extraLinesepChars[0] != '\0'
+						  && strchr (extraLinesepChars, c) != NULL));
+}
+
+static void prepareLineSpanChars (const char *commentChars)
+{
+	for (unsigned int i = 0; i < ARRAY_SIZE (lineSpanChars); i++)
+		lineSpanChars [i] = true;
+
+	lineSpanChars ['\n'] = false;
+	for (const char *p = extraLinesepChars; *p != '\0'; p++)
+		lineSpanChars [(unsigned char) *p] = false;
+	for (const char *p = commentChars; *p != '\0'; p++)
+		lineSpanChars [(unsigned char) *p] = false;
+}
+
+/* readLineViaCpp () for the input in which no macro can be expanded:
+ * the identifiers need not be looked at, and the characters are taken
+ * from the input line in bulk. */
+static const unsigned char *readLineViaCppInBulk (vString *line)
+{
+	int c;
+	bool truncation = false;
+
+	while ((c = cppGetcSpan (truncation? NULL: line, lineSpanChars)) != EOF)
+	{
+		if (c == STRING_SYMBOL || c == CHAR_SYMBOL)
+		{
+			if (!truncation)
+				vStringPut (line, ' ');
+		}
+		else if (isLineSeparator (c))
+			break;
+		else
+			truncation = true;	/* one of the comment characters */
+	}
+
+	if ((vStringLength (line) == 0) && (c == EOF))
+		return NULL;
+	else
+		return (unsigned char *)vStringValue (line);
+}
+
 static const unsigned char *readLineViaCpp (const char *commentChars)
 {
 	static vString *line;
@@ -458,6 +505,9 @@ static const unsigned char *readLineViaCpp (const char *commentChars)
 
 	line = vStringNewOrClear (line);
 
+	if (!cppHasMacros ())
+		return readLineViaCppInBulk (line);
+
 	vString *identifier = vStringNew ();
 
  cont:
@@ -480,8 +530,7 @@ static const unsigned char *readLineViaCpp (const char *commentChars)
 			if (!truncation)
 				vStringPut (line, ' ');
 		}
-		else if (c == '\n' || (extraLinesepChars[0] != '\0'
-							   && strchr (extraLinesepChars, c) != NULL))
+		else if (isLineSeparator (c))
 		{
 			if (!vStringIsEmpty (identifier)
 				&& processCppMacroX (identifier, c, line))
@@ -534,8 +583,7 @@ static const unsigned char *readLineNoCpp (const char *commentChars)
 
 	while ((c = getcFromInputFile ()) != EOF)
 	{
-		if (c == '\n' || (extraLinesepChars[0] != '\0'
-						  && strchr (extraLinesepChars, c) != NULL))
+		if (isLineSeparator (c))
 			break;
 		else
 		{
@@ -655,9 +703,12 @@ static void findAsmTagsCommon (bool useCpp)
 	const unsigned char *line;
 
 	if (useCpp)
+	{
 		cppInit (false, false, false, false,
 				 KIND_GHOST_INDEX, 0, 0, KIND_GHOST_INDEX, KIND_GHOST_INDEX, 0, 0,
 				 FIELD_UNKNOWN);
+		prepareLineSpanChars (commentCharsInMOL);
+	}
 
 	int macroScope = CORK_NIL;
 
@@ -309,5 +309,6 @@ extern parserDefinition* AspParser (void)
 	def->kindCount  = ARRAY_SIZE (AspKinds);
 	def->extensions = extensions;
 	def->parser     = findAspTags;
+	def->reentrant  = true;
 	return def;
 }
@@ -78,5 +78,6 @@ extern parserDefinition *AwkParser (void)
 	def->extensions = extensions;
 	def->aliases    = aliases;
 	def->parser     = findAwkTags;
+	def->reentrant  = true;
 	return def;
 }
@@ -189,6 +189,7 @@ static struct sBatsSubparser batsSubparser = {
 			.direction = SUBPARSER_SUB_RUNS_BASE,
 			.inputStart = inputStart,
 		},
+		.lineStartChars = "@l",
 		.lineNotify  = lineNotify,
 		.extractName = extractName,
 		.makeTag     = makeTag,
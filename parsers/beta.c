@@ -309,5 +309,6 @@ extern parserDefinition* BetaParser (void)
 	def->kindCount  = ARRAY_SIZE (BetaKinds);
 	def->extensions = extensions;
 	def->parser     = findBetaTags;
+	def->reentrant  = true;
 	return def;
 }
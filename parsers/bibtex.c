@@ -427,5 +427,6 @@ extern parserDefinition* BibtexParser (void)
 	def->initialize		= initialize;
 	def->keywordTable	= BibKeywordTable;
 	def->keywordCount	= ARRAY_SIZE (BibKeywordTable);
+	def->reentrant = true;
 	return def;
 }
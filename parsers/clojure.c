@@ -27,6 +27,11 @@ static kindDefinition ClojureKinds[] = {
 	{true, 'n', "namespace", "namespaces"}
 };
 
+/* A form can be indented. */
+static const char *const FormPrefixes[] = {
+	"(", " ", "\t", "\f", "\v", "\r", NULL
+};
+
 static int isNamespace (const char *strp)
 {
 	return strncmp (++strp, "ns", 2) == 0 && isspace (strp[2]);
@@ -151,7 +156,8 @@ static void findClojureTags (void)
 	const char *p;
 	int scope_index = CORK_NIL;
 
-	while ((p = (char *)readLineFromInputFile ()) != NULL)
+	/* Only a line starting a form can have a definition. */
+	while ((p = (char *)readLineFromInputFileWithPrefix (FormPrefixes)) != NULL)
 	{
 		vStringClear (name);
 
@@ -191,5 +197,6 @@ extern parserDefinition *ClojureParser (void)
 	def->aliases = aliases;
 	def->parser = findClojureTags;
 	def->useCork = CORK_QUEUE;
+	def->reentrant = true;
 	return def;
 }
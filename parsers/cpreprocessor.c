@@ -13,6 +13,7 @@
 */
 #include "general.h"  /* must always come first */
 
+#include <limits.h>
 #include <string.h>
 
 #include "debug.h"
@@ -132,7 +133,14 @@ typedef struct sCppState {
 
 	cppMacroInfo * macroInUse;
 	hashTable * fileMacroTable;
-
+	bool fileHasMacros;          /* a macro of the input is registered */
+	unsigned char plainChars [256]; /* for cppGetcSpan (); see isPlainChar () */
+
+	struct sCheckpoint {
+		bool armed;              /* only blanks read since the client armed it */
+		bool disabled;           /* the next pass may read the input differently */
+		int parserState;
+	} checkpoint;
 } cppState;
 
 
@@ -188,6 +196,11 @@ static fieldDefinition CPreProFields[COUNT_FIELD] = {
 static bool doesExaminCodeWithInIf0Branch;
 static bool doesExpandMacros;
 
+/* Cpp.fileMacroTable points this table while an input file is
+ * preprocessed with expanding macros. The table is emptied at the end
+ * of each input file but kept allocated for the next one. */
+static hashTable *reusableFileMacroTable;
+
 /*
 * CXX parser state. This is stored at the beginning of a conditional.
 * If at the exit of the conditional the state is changed then we assume
@@ -256,6 +269,7 @@ static cppState Cpp = {
 
 static hashTable *makeMacroTable (void);
 static cppMacroInfo * saveMacro(hashTable *table, const char * macro);
+static void preparePlainChars (void);
 
 /*
 *   FUNCTION DEFINITIONS
@@ -271,6 +285,15 @@ extern unsigned int cppGetDirectiveNestLevel (void)
 	return Cpp.directive.nestLevel;
 }
 
+extern bool cppIsInInitialState (void)
+{
+	return (! BraceFormat
+			&& Cpp.directive.state == DRCTV_NONE
+			&& Cpp.directive.nestLevel == 0
+			&& Cpp.ungetPointer == NULL
+			&& Cpp.fileMacroTable == NULL);
+}
+
 static void cppInitCommon(langType clientLang,
 		     const bool state, const bool hasAtLiteralStrings,
 		     const bool hasCxxRawLiteralStrings,
@@ -305,9 +328,12 @@ static void cppInitCommon(langType clientLang,
 	Cpp.charOrStringContents = vStringNew();
 
 	Cpp.resolveRequired = false;
+	Cpp.checkpoint.armed = false;
+	Cpp.checkpoint.disabled = false;
 	Cpp.hasAtLiteralStrings = hasAtLiteralStrings;
 	Cpp.hasCxxRawLiteralStrings = hasCxxRawLiteralStrings;
 	Cpp.hasSingleQuoteLiteralNumbers = hasSingleQuoteLiteralNumbers;
+	preparePlainChars ();
 
 	if (defineMacroKindIndex != KIND_GHOST_INDEX)
 	{
@@ -368,15 +394,20 @@ static void cppInitCommon(langType clientLang,
 	Cpp.directive.name = vStringNewOrClear (Cpp.directive.name);
 
 	Cpp.macroInUse = NULL;
-	Cpp.fileMacroTable =
-		(doesExpandMacros
-		 && isFieldEnabled (FIELD_SIGNATURE)
-		 && isFieldEnabled (Cpp.macrodefFieldIndex)
-		 && (getLanguageCorkUsage ((clientLang == LANG_IGNORE)
-								   ? Cpp.lang
-								   : clientLang) & CORK_SYMTAB))
-		? makeMacroTable ()
-		: NULL;
+	Cpp.fileHasMacros = false;
+	if (doesExpandMacros
+		&& isFieldEnabled (FIELD_SIGNATURE)
+		&& isFieldEnabled (Cpp.macrodefFieldIndex)
+		&& (getLanguageCorkUsage ((clientLang == LANG_IGNORE)
+								  ? Cpp.lang
+								  : clientLang) & CORK_SYMTAB))
+	{
+		if (reusableFileMacroTable == NULL)
+			reusableFileMacroTable = makeMacroTable ();
+		Cpp.fileMacroTable = reusableFileMacroTable;
+	}
+	else
+		Cpp.fileMacroTable = NULL;
 }
 
 extern void cppInit (const bool state, const bool hasAtLiteralStrings,
@@ -436,7 +467,7 @@ extern void cppTerminate (void)
 
 	if (Cpp.fileMacroTable)
 	{
-		hashTableDelete (Cpp.fileMacroTable);
+		hashTableClear (Cpp.fileMacroTable);
 		Cpp.fileMacroTable = NULL;
 	}
 }
@@ -446,6 +477,33 @@ extern void cppBeginStatement (void)
 	Cpp.resolveRequired = true;
 }
 
+extern void cppArmRescanCheckpoint (int parserState)
+{
+	Cpp.checkpoint.armed = true;
+	Cpp.checkpoint.parserState = parserState;
+}
+
+extern void cppDisableRescanCheckpoints (void)
+{
+	Cpp.checkpoint.disabled = true;
+}
+
+/*  The next pass reads the input in brace format: all the branches of the
+ *  conditionals are followed. The checkpoints are valid only while the
+ *  current pass reads the same characters. Without the macros defined in
+ *  the input file, the macros are not expanded in the same way either.
+ */
+static void setRescanCheckpointMaybe (const int c)
+{
+	if (c != NEWLINE)
+		Cpp.checkpoint.armed = false;
+	else if (! Cpp.checkpoint.disabled
+			 && Cpp.directive.nestLevel == 0
+			 && Cpp.ungetPointer == NULL
+			 && Cpp.fileMacroTable == NULL)
+		setRescanCheckpoint (Cpp.checkpoint.parserState);
+}
+
 extern void cppEndStatement (void)
 {
 	Cpp.resolveRequired = false;
@@ -749,6 +807,8 @@ static bool pushConditional (const bool firstBranchChosen)
 		ifdef->enterExternalParserBlockNestLevel = externalParserBlockNestLevel;
 		ifdef->asmArea.line = 0;
 		ignoreBranch = ifdef->ignoring;
+		if (ignoreBranch)
+			Cpp.checkpoint.disabled = true;
 	}
 	return ignoreBranch;
 }
@@ -990,7 +1050,10 @@ static int directiveDefine (const int c, bool undef)
 	Cpp.directive.state = DRCTV_NONE;
 
 	if (r != CORK_NIL && Cpp.fileMacroTable)
+	{
 		registerEntry (r);
+		Cpp.fileHasMacros = true;
+	}
 	return r;
 }
 
@@ -1170,6 +1233,8 @@ static bool directiveHash (const int c)
 
 		ignore = setIgnore (isIgnoreBranch ());
 		CXX_DEBUG_PRINT("Found #elif or #else: ignore is %d",ignore);
+		if (ignore)
+			Cpp.checkpoint.disabled = true;
 		if (! ignore  &&  s == IF_ELSE)
 			chooseBranch ();
 		Cpp.directive.state = (s == IF_ELIF)? DRCTV_ELIF: DRCTV_NONE;
@@ -1520,6 +1585,59 @@ static void conditionMayPut (vString *condition, int c)
  *  quoted strings. In short, strip anything which places a burden upon
  *  the tokenizer.
  */
+/* Whether cppGetc () ignores the character at P, in an ignored branch
+ * where no directive is being processed, without changing any state but
+ * Cpp.directive.accept. The other characters are read one at a time: the
+ * ones starting a string, a comment, a directive, a trigraph, a digraph,
+ * or a digit separator, the backslashes, and the newlines. */
+static bool isIgnoredChar (const unsigned char *p)
+{
+	switch (*p)
+	{
+		case '\0': case NEWLINE: case DOUBLE_QUOTE: case SINGLE_QUOTE:
+		case '#': case '/': case BACKSLASH: case '?':
+		case '<': case ':': case '%':
+			return false;
+		case '@':
+			return ! Cpp.hasAtLiteralStrings;
+		case 'R':
+			if (Cpp.hasCxxRawLiteralStrings && p[1] == DOUBLE_QUOTE)
+				return false;
+			break;
+	}
+	/* See the default branch of cppGetc (). */
+	return ! (isxdigit (*p) && p[1] == SINGLE_QUOTE);
+}
+
+/* Skips the characters of the current line ignored in an ignored branch
+ * at once. */
+static void skipIgnoredChars (void)
+{
+	const unsigned char *line = Cpp.ungetPointer? NULL: peekCharsInInputFile ();
+	size_t n = 0;
+
+	if (line == NULL)
+		return;
+
+	while (isIgnoredChar (line + n))
+	{
+		/* A directive must start a line. */
+		if (line [n] != ' ' && line [n] != '\t')
+			Cpp.directive.accept = false;
+		n++;
+	}
+	if (n > 0)
+	{
+		if (Cpp.macroInUse)
+			cppClearMacroInUse (&Cpp.macroInUse);
+		DebugStatement (
+			for (size_t i = 0; i < n; i++)
+				debugPutc (DEBUG_CPP, line [i]);
+			)
+		skipCharsInInputFile (n);
+	}
+}
+
 extern int cppGetc (void)
 {
 	bool directive = false;
@@ -1532,6 +1650,9 @@ extern int cppGetc (void)
 
 	do {
 start_loop:
+		if (ignore && Cpp.directive.state == DRCTV_NONE
+			&& macroCorkIndex == CORK_NIL && condition == NULL)
+			skipIgnoredChars ();
 		c = cppGetcFromUngetBufferOrFile ();
 process:
 		switch (c)
@@ -1912,6 +2033,9 @@ process:
 	if (condition)
 		vStringDelete (condition);
 
+	if (Cpp.checkpoint.armed && c != SPACE && c != TAB)
+		setRescanCheckpointMaybe (c);
+
 	DebugStatement ( debugPutc (DEBUG_CPP, c); )
 	DebugStatement ( if (c == NEWLINE)
 				debugPrintf (DEBUG_CPP, "%6ld: ", getInputLineNumber () + 1); )
@@ -1919,6 +2043,101 @@ process:
 	return c;
 }
 
+enum ePlainChar {
+	PLAIN_NOT,
+	PLAIN_ALWAYS,
+	PLAIN_UNLESS_BEFORE_SINGLE_QUOTE,
+	PLAIN_UNLESS_BEFORE_DOUBLE_QUOTE,
+};
+
+static void preparePlainChars (void)
+{
+	for (unsigned int c = 0; c < ARRAY_SIZE (Cpp.plainChars); c++)
+	{
+		unsigned char p = PLAIN_NOT;
+
+		/* See the default branch of cppGetc (). */
+		if (c == ' ' || c == '\t' || c == '_' || c == '$')
+			p = PLAIN_ALWAYS;
+		else if (isxdigit (c))
+			p = PLAIN_UNLESS_BEFORE_SINGLE_QUOTE;
+		else if (c == 'R' && Cpp.hasCxxRawLiteralStrings)
+			p = PLAIN_UNLESS_BEFORE_DOUBLE_QUOTE;
+		else if (cppIsalnum (c))
+			p = PLAIN_ALWAYS;
+		else if (c == '@')
+			p = Cpp.hasAtLiteralStrings? PLAIN_NOT: PLAIN_ALWAYS;
+		/* The punctuation starting neither a comment, a literal, a
+		 * directive, a digraph, nor a trigraph. */
+		else if (c != '\0' && strchr (".,;()[]{}+-*=!&|^~>", c))
+			p = PLAIN_ALWAYS;
+		Cpp.plainChars [c] = p;
+	}
+}
+
+/* Whether cppGetc () returns the character at P as it is, without
+ * side effects, when no directive is being processed. */
+static bool isPlainChar (const unsigned char *p)
+{
+	switch (Cpp.plainChars [*p])
+	{
+	case PLAIN_ALWAYS:
+		return true;
+	case PLAIN_UNLESS_BEFORE_SINGLE_QUOTE:
+		return p[1] != SINGLE_QUOTE;
+	case PLAIN_UNLESS_BEFORE_DOUBLE_QUOTE:
+		return p[1] != DOUBLE_QUOTE;
+	default:
+		return false;
+	}
+}
+
+extern int cppGetcSpan (vString *buffer, const bool accept [256])
+{
+	int c;
+
+	for (;;)
+	{
+		const unsigned char *line = Cpp.ungetPointer? NULL: peekCharsInInputFile ();
+
+		if (line)
+		{
+			size_t n = 0;
+
+			if (Cpp.macroInUse)
+				cppClearMacroInUse (&Cpp.macroInUse);
+
+			while (accept [line [n]] && isPlainChar (line + n))
+			{
+				/* A directive must start a line. */
+				if (line [n] != ' ' && line [n] != '\t')
+				{
+					Cpp.directive.accept = false;
+					Cpp.checkpoint.armed = false;
+				}
+				n++;
+			}
+			if (n > 0)
+			{
+				if (buffer)
+					vStringNCatSUnsafe (buffer, (const char *) line, n);
+				DebugStatement (
+					for (size_t i = 0; i < n; i++)
+						debugPutc (DEBUG_CPP, line [i]);
+					)
+				skipCharsInInputFile (n);
+			}
+		}
+
+		/* A character needing the preprocessing, or the end of the line */
+		c = cppGetc ();
+		if (c < 0 || c > UCHAR_MAX || ! accept [c])
+			return c;
+		if (buffer)
+			vStringPut (buffer, c);
+	}
+}
+
 static void findCppTags (void)
 {
 	cppInitCommon (Cpp.lang, 0, false, false, false,
@@ -1933,6 +2152,334 @@ static void findCppTags (void)
 }
 
 
+/*
+ *  Splitting an input file (see setInputChunkEndClean ())
+ *
+ *  The input file is split at the start of a line at the top level, after
+ *  a declaration or a function definition ends, and outside the
+ *  conditionals. Comments, strings, and directives are read as cppGetc ()
+ *  reads them, and the braces in the branches cppGetc () ignores in the
+ *  first pass are not counted. Whether a chunk really starts at the top
+ *  level is checked by the parser at the end of the chunk before it.
+ */
+
+#define SPLIT_MAX_NESTING_LEVEL 64
+
+typedef struct sSplitState {
+	const unsigned char *end;
+	unsigned long lineNumber;
+	unsigned int nestLevel;
+	unsigned int ignoredLevels;	/* in the branches ignored */
+	struct {
+		bool ignoring;
+		bool taken;
+	} ifdef [SPLIT_MAX_NESTING_LEVEL];
+} splitState;
+
+static const unsigned char *splitSkipLineContinuation (splitState *s,
+													   const unsigned char *p)
+{
+	if (*p == BACKSLASH && p + 1 < s->end && p [1] == NEWLINE)
+	{
+		s->lineNumber++;
+		return p + 2;
+	}
+	if (*p == BACKSLASH && p + 2 < s->end && p [1] == '\r' && p [2] == NEWLINE)
+	{
+		s->lineNumber++;
+		return p + 3;
+	}
+	return p;
+}
+
+/* Returns the character after the comment, the string, or the character
+ * literal starting at P, or P if none starts there. A comment or a
+ * character literal ends before the newline ending it. */
+static const unsigned char *splitSkipLiteral (splitState *s,
+											  const unsigned char *p)
+{
+	const unsigned char *const end = s->end;
+	const unsigned char *q;
+
+	if (*p == '/' && p + 1 < end && p [1] == '*')
+	{
+		for (p += 2; p < end; p++)
+		{
+			if (*p == NEWLINE)
+				s->lineNumber++;
+			else if (*p == '*' && p + 1 < end && p [1] == '/')
+				return p + 2;
+		}
+		return end;
+	}
+	else if (*p == '/' && p + 1 < end && p [1] == '/')
+	{
+		for (p += 2; p < end && *p != NEWLINE; p++)
+			if ((q = splitSkipLineContinuation (s, p)) != p)
+				p = q - 1;
+		return p;
+	}
+	else if (*p == DOUBLE_QUOTE || *p == SINGLE_QUOTE)
+	{
+		const unsigned char quote = *p;
+
+		for (p++; p < end; p++)
+		{
+			if (*p == quote)
+				return p + 1;
+			else if (*p == NEWLINE)
+			{
+				if (quote == SINGLE_QUOTE)
+					return p;
+				s->lineNumber++;
+			}
+			else if (*p == BACKSLASH && p + 1 < end)
+			{
+				if (p [1] == NEWLINE)
+					s->lineNumber++;
+				p++;
+			}
+		}
+		return end;
+	}
+	return p;
+}
+
+/* Returns the character after the raw string literal whose quote is at
+ * P. See skipToEndOfCxxRawLiteralString (). */
+static const unsigned char *splitSkipRawString (splitState *s,
+												const unsigned char *p)
+{
+	const unsigned char *const end = s->end;
+	const unsigned char *delim = p + 1;
+	size_t delimLen = 0;
+
+	while (delim + delimLen < end && delimLen < 16
+		   && isCxxRawLiteralDelimiterChar (delim [delimLen]))
+		delimLen++;
+	if (delim + delimLen >= end || delim [delimLen] != '(')
+		return splitSkipLiteral (s, p);
+
+	for (p = delim + delimLen + 1; p < end; p++)
+	{
+		if (*p == NEWLINE)
+			s->lineNumber++;
+		else if (*p == ')'
+				 && p + delimLen + 1 < end
+				 && memcmp (p + 1, delim, delimLen) == 0
+				 && p [delimLen + 1] == DOUBLE_QUOTE)
+			return p + delimLen + 2;
+	}
+	return end;
+}
+
+static bool splitDirectiveIs (const unsigned char *p, const unsigned char *end,
+							  const char *name)
+{
+	const size_t len = strlen (name);
+
+	return ((size_t) (end - p) >= len && memcmp (p, name, len) == 0
+			&& (p + len == end || ! cppIsident (p [len])));
+}
+
+/* Handles the directive whose name is at P, and returns the newline ending
+ * it. Returns NULL if the conditionals are nested too deeply. */
+static const unsigned char *splitSkipDirective (splitState *s,
+												const unsigned char *p)
+{
+	const unsigned char *const end = s->end;
+	const unsigned char *q;
+
+	while (p < end && isspacetab (*p))
+		p++;
+
+	if (splitDirectiveIs (p, end, "if")
+		|| splitDirectiveIs (p, end, "ifdef")
+		|| splitDirectiveIs (p, end, "ifndef"))
+	{
+		bool zero = false;
+
+		if (s->nestLevel == SPLIT_MAX_NESTING_LEVEL)
+			return NULL;
+		if (splitDirectiveIs (p, end, "if"))
+		{
+			for (q = p + 2; q < end && isspacetab (*q); q++)
+				;
+			zero = (q < end && *q == '0'
+					&& (q + 1 == end || ! cppIsident (q [1])));
+		}
+		s->ifdef [s->nestLevel].ignoring = zero;
+		s->ifdef [s->nestLevel].taken = ! zero;
+		s->nestLevel++;
+		if (zero)
+			s->ignoredLevels++;
+	}
+	else if ((splitDirectiveIs (p, end, "elif") || splitDirectiveIs (p, end, "else"))
+			 && s->nestLevel > 0)
+	{
+		bool *ignoring = &s->ifdef [s->nestLevel - 1].ignoring;
+		bool *taken = &s->ifdef [s->nestLevel - 1].taken;
+
+		if (*ignoring)
+			s->ignoredLevels--;
+		*ignoring = *taken;
+		*taken = true;
+		if (*ignoring)
+			s->ignoredLevels++;
+	}
+	else if (splitDirectiveIs (p, end, "endif") && s->nestLevel > 0)
+	{
+		s->nestLevel--;
+		if (s->ifdef [s->nestLevel].ignoring)
+			s->ignoredLevels--;
+	}
+
+	while (p < end && *p != NEWLINE)
+	{
+		if ((q = splitSkipLineContinuation (s, p)) != p
+			|| (q = splitSkipLiteral (s, p)) != p)
+			p = q;
+		else
+			p++;
+	}
+	return p;
+}
+
+static bool isSplitLineStart (const unsigned char *p, const unsigned char *end)
+{
+	while (p < end && (isspacetab (*p) || *p == '\r'))
+		p++;
+	return p < end && (cppIsident1 (*p) || *p == '#') && *p != '~';
+}
+
+extern void cppSplitInput (const unsigned char *data, size_t size,
+						   size_t chunkSize, ulongArray *lines)
+{
+	splitState s = {
+		.end = data + size,
+		.lineNumber = 1,
+		.nestLevel = 0,
+		.ignoredLevels = 0,
+	};
+	const unsigned char *p = data;
+	const unsigned char *chunkStart = data;
+	const unsigned char *q;
+	int braces = 0, parens = 0;
+	bool lineStart = true;		/* only blanks since the start of line */
+	int last = 0;				/* the last character at the top level */
+	int lastEnd = 0;			/* ';' or '}' if a declaration ends there */
+	bool bodyAfterParen = false;	/* the top level '{' follows ')' */
+	bool oldStyle = false;		/* ')' followed by a name at the top level */
+
+	while (p < s.end)
+	{
+		const unsigned char c = *p;
+
+		if (c == NEWLINE)
+		{
+			p++;
+			s.lineNumber++;
+			lineStart = true;
+			if ((size_t) (p - chunkStart) >= chunkSize
+				&& braces == 0 && parens == 0 && s.nestLevel == 0
+				&& lastEnd != 0 && isSplitLineStart (p, s.end))
+			{
+				ulongArrayAdd (lines, s.lineNumber);
+				chunkStart = p;
+			}
+			continue;
+		}
+		else if (cppIsspace (c))
+		{
+			p++;
+			continue;
+		}
+		else if ((q = splitSkipLineContinuation (&s, p)) != p)
+		{
+			p = q;
+			continue;
+		}
+		else if (c == '#' && lineStart)
+		{
+			p = splitSkipDirective (&s, p + 1);
+			if (p == NULL)
+				return;
+			continue;
+		}
+
+		lineStart = false;
+		if ((q = splitSkipLiteral (&s, p)) != p)
+		{
+			/* A comment is not significant. */
+			if (c == DOUBLE_QUOTE || c == SINGLE_QUOTE)
+				last = lastEnd = 0;
+			p = q;
+			continue;
+		}
+		else if (cppIsident (c))
+		{
+			const unsigned char *start = p;
+
+			/* A quote after a hex digit is a digit separator for
+			 * cppGetc (). */
+			while (p < s.end && (cppIsident (*p)
+								 || (*p == SINGLE_QUOTE && isxdigit (p [-1]))))
+				p++;
+			if (p < s.end && *p == DOUBLE_QUOTE && p [-1] == 'R'
+				&& (p - start == 1
+					|| (p - start == 2 && strchr ("LuU", *start))
+					|| (p - start == 3 && start [0] == 'u' && start [1] == '8')))
+				p = splitSkipRawString (&s, p);
+
+			if (s.ignoredLevels == 0)
+			{
+				if (last == ')' && braces == 0 && parens == 0)
+					oldStyle = true;
+				last = 'a';
+				lastEnd = 0;
+			}
+			continue;
+		}
+
+		p++;
+		if (s.ignoredLevels > 0)
+			continue;
+
+		lastEnd = 0;
+		switch (c)
+		{
+			case '{':
+				if (braces == 0 && parens == 0)
+				{
+					bodyAfterParen = (last == ')');
+					oldStyle = false;
+				}
+				braces++;
+				break;
+			case '}':
+				if (braces > 0)
+					braces--;
+				if (braces == 0 && parens == 0 && bodyAfterParen)
+					lastEnd = '}';
+				break;
+			case '(':
+			case '[':
+				parens++;
+				break;
+			case ')':
+			case ']':
+				if (parens > 0)
+					parens--;
+				break;
+			case ';':
+				if (braces == 0 && parens == 0 && ! oldStyle)
+					lastEnd = ';';
+				break;
+		}
+		last = c;
+	}
+}
+
 /*
  *  Token ignore processing
  */
@@ -2001,6 +2548,12 @@ extern cppMacroInfo * cppFindMacro (const char *const name)
 	return NULL;
 }
 
+extern bool cppHasMacros (void)
+{
+	return ((cmdlineMacroTable && hashTableCountItem (cmdlineMacroTable) > 0)
+			|| Cpp.fileHasMacros);
+}
+
 extern vString * cppBuildMacroReplacement(
 		const cppMacroInfo * macro,
 		const char ** parameters, /* may be NULL */
@@ -2505,6 +3058,12 @@ static void finalizeCpp (const langType language, bool initialized)
 		hashTableDelete (cmdlineMacroTable);
 		cmdlineMacroTable = NULL;
 	}
+
+	if (reusableFileMacroTable)
+	{
+		hashTableDelete (reusableFileMacroTable);
+		reusableFileMacroTable = NULL;
+	}
 }
 
 static bool CpreProExpandMacrosInInput (const langType language CTAGS_ATTR_UNUSED, const char *name, const char *arg)
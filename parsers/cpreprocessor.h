@@ -13,6 +13,7 @@
 *   INCLUDE FILES
 */
 #include "general.h"  /* must always come first */
+#include "numarray.h"
 #include "ptrarray.h"
 #include "types.h"
 #include "vstring.h"
@@ -75,6 +76,10 @@
 */
 extern bool cppIsBraceFormat (void);
 extern unsigned int cppGetDirectiveNestLevel (void);
+/* Returns true if no conditional is open, no character is pushed back,
+ * and no macro defined in the input file is expanded, as when cppInit ()
+ * is called in the first pass. */
+extern bool cppIsInInitialState (void);
 
 /* Don't forget to set useCort true in your parser.
  * The corkQueue is needed to capture macro parameters.
@@ -94,10 +99,41 @@ extern void cppInit (const bool state,
 extern void cppTerminate (void);
 extern void cppBeginStatement (void);
 extern void cppEndStatement (void);
+
+/* Rescan checkpoints (see setRescanCheckpoint ())
+ *
+ * The client parser calls cppArmRescanCheckpoint () at the end of a
+ * statement at the top level. If only blanks are read until the next
+ * newline, no conditional is open there, and no branch has been ignored
+ * since cppInit (), the checkpoint is set after the newline with
+ * PARSERSTATE. The client parser calls cppDisableRescanCheckpoints ()
+ * when the next pass may parse what has been read differently; no
+ * checkpoint is set until cppInit () is called again. */
+extern void cppArmRescanCheckpoint (int parserState);
+extern void cppDisableRescanCheckpoints (void);
 extern void cppUngetc (const int c);
 extern int cppUngetBufferSize();
 extern void cppUngetString(const char * string,int len);
 extern int cppGetc (void);
+
+/* A splitInput for the C family (see setInputChunkEndClean ()) */
+extern void cppSplitInput (const unsigned char *data, size_t size,
+						   size_t chunkSize, ulongArray *lines);
+
+/* Same as
+ *
+ *	c = cppGetc ();
+ *	while (c is in range of unsigned char && accept [c])
+ *	{
+ *		if (buffer)
+ *			vStringPut (buffer, c);
+ *		c = cppGetc ();
+ *	}
+ *	return c;
+ *
+ * but the characters needing no preprocessing, identifier characters
+ * and blanks, are taken from the input line in bulk. */
+extern int cppGetcSpan (vString *buffer, const bool accept [256]);
 extern const vString * cppGetLastCharOrStringContents (void);
 
 /* Notify the external parser state for the purpose of conditional
@@ -124,6 +160,9 @@ typedef struct sCppMacroInfo {
 } cppMacroInfo;
 
 extern cppMacroInfo * cppFindMacro (const char *const name);
+/* Returns false if cppFindMacro () finds no macro for any name: no macro
+ * is given with the parameters, nor defined in the input so far. */
+extern bool cppHasMacros (void);
 extern void cppUngetStringBuiltByMacro (const char * string,int len, cppMacroInfo *macro);
 
 /*
@@ -58,7 +58,18 @@ static void parseSelector (vString *const string, const int firstChar)
 	int c = firstChar;
 	do
 	{
+		const unsigned char *line;
+
 		vStringPut (string, (char) c);
+		line = peekCharsInInputFile ();
+		if (line)
+		{
+			size_t n = 0;
+			while (line[n] != '\0' && isSelectorChar (line[n]))
+				n++;
+			vStringNCatS (string, (const char *) line, n);
+			skipCharsInInputFile (n);
+		}
 		c = getcFromInputFile ();
 	} while (isSelectorChar (c));
 	ungetcToInputFile (c);
@@ -110,13 +121,7 @@ getNextChar:
 			}
 			else
 			{
-				d = getcFromInputFile ();
-				do
-				{
-					c = d;
-					d = getcFromInputFile ();
-				}
-				while (d != EOF && ! (c == '*' && d == '/'));
+				skipToCharacterInInputFile2 ('*', '/');
 				goto getNextChar;
 			}
 			break;
@@ -137,6 +142,50 @@ getNextChar:
 	}
 }
 
+static void skipString (const int delimiter)
+{
+	const char stops [] = { (char) delimiter, '\\', '\0' };
+	int c;
+
+	do
+	{
+		c = skipToCharactersInInputFile (stops);
+		if (c == '\\')
+			c = getcFromInputFile ();
+	}
+	while (c != EOF && c != delimiter);
+}
+
+/* Skips the declarations of a block up to its closing '}'. They are not
+ * tokenized: the lines are scanned in bulk for the braces, the strings,
+ * and the comments, as a minified stylesheet is a single long line. */
+static void skipBlock (void)
+{
+	int depth = 1;
+
+	while (depth > 0)
+	{
+		int c = skipToCharactersInInputFile ("{}'\"/");
+
+		switch (c)
+		{
+			case EOF: return;
+			case '{': depth++; break;
+			case '}': depth--; break;
+			case '/':
+			{
+				int d = getcFromInputFile ();
+				if (d == '*')
+					skipToCharacterInInputFile2 ('*', '/');
+				else
+					ungetcToInputFile (d);
+				break;
+			}
+			default: skipString (c); break;
+		}
+	}
+}
+
 /* sets selector kind in @p kind if found, otherwise don't touches @p kind */
 static cssKind classifySelector (const vString *const selector)
 {
@@ -236,15 +285,8 @@ static void findCssTags (void)
 		}
 		else if (token.type == '{')
 		{ /* skip over { ... } */
-			int depth = 1;
-			while (depth > 0 && token.type != TOKEN_EOF)
-			{
-				readToken (&token);
-				if (token.type == '{')
-					depth++;
-				else if (token.type == '}')
-					depth--;
-			}
+			skipBlock ();
+			token.type = '}';
 		}
 	}
 	while (token.type != TOKEN_EOF);
@@ -261,5 +303,6 @@ extern parserDefinition* CssParser (void)
 	def->kindCount  = ARRAY_SIZE (CssKinds);
 	def->extensions = extensions;
 	def->parser     = findCssTags;
+	def->reentrant  = true;
 	return def;
 }
@@ -18,6 +18,7 @@
 #include "cxx_tag.h"
 
 #include "dependency.h"
+#include "../cpreprocessor.h"
 #include "selectors.h"
 
 //
@@ -92,6 +93,8 @@ parserDefinition * CParser (void)
 	def->parser2 = cxxCParserMain;
 	def->initialize = cxxCParserInitialize;
 	def->finalize = cxxParserCleanup;
+	def->printStats = cxxParserPrintStats;
+	def->splitInput = cppSplitInput;
 	def->selectLanguage = selectors;
 	def->useCork = CORK_QUEUE|CORK_SYMTAB; // We use corking to block output until the end of file
 
@@ -127,6 +130,8 @@ parserDefinition * CppParser (void)
 	def->parser2 = cxxCppParserMain;
 	def->initialize = cxxCppParserInitialize;
 	def->finalize = cxxParserCleanup;
+	def->printStats = cxxParserPrintStats;
+	def->splitInput = cppSplitInput;
 	def->selectLanguage = selectors;
 	def->useCork = CORK_QUEUE|CORK_SYMTAB; // We use corking to block output until the end of file
 
@@ -156,6 +161,8 @@ parserDefinition * CUDAParser (void)
 	def->parser2 = cxxCUDAParserMain;
 	def->initialize = cxxCUDAParserInitialize;
 	def->finalize = cxxParserCleanup;
+	def->printStats = cxxParserPrintStats;
+	def->splitInput = cppSplitInput;
 	def->selectLanguage = NULL;
 	def->useCork = CORK_QUEUE|CORK_SYMTAB; // We use corking to block output until the end of file
 
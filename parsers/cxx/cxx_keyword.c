@@ -324,7 +324,7 @@ static CXXKeywordDescriptor g_aCXXKeywordTable[] = {
 	{
 		"final",
 		CXXLanguageCPP,
-		0
+		CXXKeywordIsDisabled
 	},
 	{
 		"float",
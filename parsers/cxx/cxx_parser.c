@@ -1022,7 +1022,10 @@ static bool cxxParserParseClassStructOrUnionInternal(
 			/* The statement declears or defines an operator,
 			 * not a class, struct not union. */
 			if(g_cxx.pToken->eKeyword == CXXKeywordOPERATOR)
+			{
+				cxxKeywordEnableFinal(false);
 				return true;
+			}
 			continue;
 		}
 
@@ -1892,9 +1895,16 @@ bool cxxParserParseIfForWhileSwitchCatchParenthesis(void)
 static rescanReason cxxParserMain(const unsigned int passCount)
 {
 	cxxScopeClear();
-	cxxTokenAPINewFile();
+	cxxTokenAPINewFile(g_cxx.eLanguage);
 	cxxParserNewStatement();
 
+	// Lambdas and the other tags a function body may contain are
+	// looked for while skipping it.
+	g_cxx.bSkipFunctionBodies =
+		(!cxxTagKindEnabled(CXXTagKindLOCAL)) &&
+		(!cxxTagKindEnabled(CXXTagKindLABEL)) &&
+		(!cxxTagKindEnabled(CXXTagKindEXTERNVAR));
+
 	int kind_for_define = CXXTagKindMACRO;
 	int kind_for_header = CXXTagKindINCLUDE;
 	int kind_for_macro_param = CXXTagKindMACROPARAM;
@@ -1997,8 +2007,10 @@ static void cxxParserFirstInit(void)
 	g_cxx.eCUDALangType = -1;
 
 	cxxTokenAPIInit();
+	cxxParserInitTokenizer();
 
 	g_cxx.pTokenChain = cxxTokenChainCreate();
+	g_cxx.pSkippedStatement = vStringNew();
 
 	cxxScopeInit();
 
@@ -2038,6 +2050,16 @@ void cxxCParserInitialize(const langType language)
 	cxxBuildKeywordHash(language,CXXLanguageC);
 }
 
+void cxxParserPrintStats(const langType language)
+{
+	if(language == g_cxx.eCLangType)
+		cxxTokenAPIPrintStats(CXXLanguageC);
+	else if(language == g_cxx.eCPPLangType)
+		cxxTokenAPIPrintStats(CXXLanguageCPP);
+	else if(language == g_cxx.eCUDALangType)
+		cxxTokenAPIPrintStats(CXXLanguageCUDA);
+}
+
 void cxxParserCleanup(langType language CTAGS_ATTR_UNUSED,bool initialized CTAGS_ATTR_UNUSED)
 {
 	if(g_bFirstRun)
@@ -2058,6 +2080,8 @@ void cxxParserCleanup(langType language CTAGS_ATTR_UNUSED,bool initialized CTAGS
 		cxxTokenChainDestroy(g_cxx.pTemplateSpecializationTokenChain);
 	// Restart coveralls: LCOV_EXCL_END
 
+	vStringDelete(g_cxx.pSkippedStatement);
+
 	cxxScopeDone();
 
 	cxxTokenAPIDone();
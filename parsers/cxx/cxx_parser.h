@@ -24,4 +24,7 @@ void cxxCUDAParserInitialize(const langType language);
 
 void cxxParserCleanup(langType language, bool initialized);
 
+// Prints the token allocation statistics (--totals=extra)
+void cxxParserPrintStats(const langType language);
+
 #endif //!ctags_cxx_parser_h_
\ No newline at end of file
@@ -253,6 +253,35 @@ bool cxxParserParseBlockHandleOpeningBracket(void)
 	return true;
 }
 
+//
+// Check that nothing read so far is pending at the end of the input,
+// in the main block: the state an input file starts in.
+// See setInputChunkEndClean().
+//
+static bool cxxParserIsInInitialState(void)
+{
+	if(!cxxScopeIsGlobal())
+		return false;
+	if(g_cxx.pUngetToken || g_cxx.pTemplateTokenChain)
+		return false;
+	if(
+		(g_cxx.pTokenChain->iCount > 1) ||
+		(
+			(g_cxx.pTokenChain->iCount == 1) &&
+			!cxxTokenTypeIs(g_cxx.pTokenChain->pTail,CXXTokenTypeEOF)
+		)
+	)
+		return false;
+	// Finding C++ constructs changes how the rest is parsed.
+	if(g_cxx.bConfirmedCPPLanguage !=
+			(cxxParserCurrentLanguageIsCPP() && !isInputHeaderFile()))
+		return false;
+	if(!cxxKeywordIsDisabled(CXXKeywordFINAL) ||
+			(cxxKeywordIsDisabled(CXXKeywordPUBLIC) == g_cxx.bConfirmedCPPLanguage))
+		return false;
+	return cppIsInInitialState();
+}
+
 static bool cxxParserParseBlockInternal(bool bExpectClosingBracket)
 {
 	CXX_DEBUG_ENTER();
@@ -284,6 +313,9 @@ found_eof:
 				return false;
 			}
 
+			if(cxxParserIsInInitialState())
+				setInputChunkEndClean();
+
 			CXX_DEBUG_LEAVE_TEXT("EOF in main block");
 			return true; // EOF
 		}
@@ -805,12 +837,455 @@ process_token:
 // When the statement ends without finding any characteristic token the chain
 // is passed to an analysis routine which does a second scan pass.
 //
+//
+// Function body skipping.
+//
+// When no tag can be made in a function body by itself (locals, labels or
+// extern variables) the body is only scanned for its closing bracket:
+// cxxParserSkipNextToken() reads the tokens without making them and
+// no statement is analyzed. The input still goes through the preprocessor,
+// which handles comments, strings, character literals and raw strings,
+// and which sees the same statement boundaries and nested blocks it sees
+// when the body is parsed.
+//
+// A body may contain things that make tags (classes, enums, lambdas...)
+// or that are handled by the tokenizer (macros, attributes). When one
+// is found the statement skipped so far is put back into the input, like
+// cxxParserUngetCurrentToken() does, and the rest of the block is parsed.
+//
+
+typedef enum _CXXSkipResult
+{
+	// The input is broken: the block would not be parsed either
+	CXXSkipResultFailed,
+	// Found the closing bracket
+	CXXSkipResultDone,
+	// The rest of the block must be parsed
+	CXXSkipResultParse
+} CXXSkipResult;
+
+// What the rules of cxxParserParseBlockHandleOpeningBracket() need to know
+// about the token chain of the statement skipped.
+typedef struct _CXXSkipStatement
+{
+	// Types of the last two tokens in the chain, 0 if there are none
+	unsigned int uLast;
+	unsigned int uBeforeLast;
+	// Type of the last token that is not a [] chain
+	unsigned int uLastNotSquare;
+	// The last token is the "override" identifier
+	bool bLastIsOverride;
+	// The chain contains a () chain
+	bool bSeenParenthesis;
+	// The chain contains a [] chain: a { may start a lambda
+	bool bSeenSquare;
+	// The statement starts with "return" (C++ only)
+	bool bSeenReturn;
+} CXXSkipStatement;
+
+static void cxxParserSkipNewStatement(CXXSkipStatement * pStatement)
+{
+	memset(pStatement,0,sizeof(CXXSkipStatement));
+	vStringClear(g_cxx.pSkippedStatement);
+}
+
+// Looks up the identifier that starts at iStart in g_cxx.pSkippedStatement
+// (and ends it). *piKeyword is set to the keyword or KEYWORD_NONE. Returns
+// true if cxxParserParseNextToken() would do more than making a token with
+// it: expanding a macro or condensing an attribute. Within subchains only
+// the keywords of the attributes matter.
+static bool cxxParserSkipIdentifierNeedsParser(
+		size_t iStart,
+		bool bLookupKeyword,
+		int * piKeyword
+	)
+{
+	const char * szName = vStringValue(g_cxx.pSkippedStatement) + iStart;
+	if(*szName == ' ')
+		szName++;
+
+	*piKeyword = KEYWORD_NONE;
+
+	if(bLookupKeyword || ((szName[0] == '_') && (szName[1] == '_')))
+	{
+		int iKeyword = lookupKeyword(szName,g_cxx.eLangType);
+		if(iKeyword >= 0)
+		{
+			if(cxxKeywordIsDisabled((CXXKeyword)iKeyword))
+				return false;
+			*piKeyword = iKeyword;
+			return (iKeyword == CXXKeyword__ATTRIBUTE__) ||
+				(iKeyword == CXXKeyword__DECLSPEC);
+		}
+	}
+
+	return cppFindMacro(szName) != NULL;
+}
+
+// Skips input up to one of uTokenTypes as cxxParserParseUpToOneOf() does.
+// *pbSeenSquare is set when a [] chain is found, as it is part of the token
+// chain the caller tracks.
+static CXXSkipResult cxxParserSkipUpToOneOf(unsigned int uTokenTypes,bool * pbSeenSquare)
+{
+	for(;;)
+	{
+		size_t iStart = vStringLength(g_cxx.pSkippedStatement);
+		enum CXXTokenType eType = cxxParserSkipNextToken(g_cxx.pSkippedStatement);
+		int iKeyword;
+
+		if(eType & uTokenTypes)
+			return CXXSkipResultDone;
+
+		switch(eType)
+		{
+			case CXXTokenTypeEOF:
+				return CXXSkipResultFailed;
+			case CXXTokenTypeIdentifier:
+				if(cxxParserSkipIdentifierNeedsParser(iStart,false,&iKeyword))
+					return CXXSkipResultParse;
+			break;
+			case CXXTokenTypeOpeningSquareParenthesis:
+				if(g_cxx.iChar == '[')
+					return CXXSkipResultParse; // [[ attribute ]]
+				*pbSeenSquare = true;
+				// fall through
+			case CXXTokenTypeOpeningBracket:
+			case CXXTokenTypeOpeningParenthesis:
+			{
+				if(
+					(eType == CXXTokenTypeOpeningBracket) &&
+					cxxParserCurrentLanguageIsCPP() &&
+					*pbSeenSquare
+				)
+					return CXXSkipResultParse; // maybe a lambda
+
+				g_cxx.iNestingLevels++;
+
+				if(g_cxx.iNestingLevels > CXX_PARSER_MAXIMUM_NESTING_LEVELS)
+					return CXXSkipResultFailed;
+
+				bool bSeenSquare = false;
+				// see the declaration of CXXTokenType enum.
+				// Shifting by 4 gives the corresponding closing token type
+				CXXSkipResult eResult = cxxParserSkipUpToOneOf(eType << 4,&bSeenSquare);
+
+				g_cxx.iNestingLevels--;
+
+				if(eResult != CXXSkipResultDone)
+					return eResult;
+
+				// Shifting by 8 gives the corresponding chain marker
+				if(uTokenTypes & (eType << 8))
+					return CXXSkipResultDone;
+			}
+			break;
+			case CXXTokenTypeClosingBracket:
+			case CXXTokenTypeClosingParenthesis:
+			case CXXTokenTypeClosingSquareParenthesis:
+				return CXXSkipResultFailed; // unmatched: syntax error
+			default:
+				// nothing interesting here
+			break;
+		}
+	}
+}
+
+static bool cxxParserSkipIsListInitialization(
+		const CXXSkipStatement * pStatement,
+		bool bIsCPP
+	)
+{
+	// something = {...}
+	if(pStatement->uLast == CXXTokenTypeAssignment)
+		return true;
+
+	// return { }
+	if(!pStatement->uLast)
+		return pStatement->bSeenReturn;
+
+	if(!bIsCPP)
+		return false;
+
+	if(pStatement->uLast == CXXTokenTypeIdentifier)
+	{
+		// T { arg1, arg2, ... }
+		// T object { arg1, arg2, ... }
+		// new T { arg1, arg2, ... }
+		// Class::Class() : member { arg1, arg2, ... } {
+		if(pStatement->bLastIsOverride)
+			return false;
+		if(!pStatement->uBeforeLast)
+			return true;
+		if(pStatement->uBeforeLast & (CXXTokenTypeSingleColon | CXXTokenTypeComma))
+			return true;
+		return (pStatement->uBeforeLast & (
+					CXXTokenTypeIdentifier | CXXTokenTypeStar | CXXTokenTypeAnd |
+					CXXTokenTypeGreaterThanSign | CXXTokenTypeKeyword
+				)) && !pStatement->bSeenParenthesis;
+	}
+
+	// type var[][][]..[] { ... }
+	return (pStatement->uLast == CXXTokenTypeSquareParenthesisChain) &&
+		(pStatement->uLastNotSquare == CXXTokenTypeIdentifier);
+}
+
+// Skips the rest of the block as cxxParserParseBlockInternal() parses it.
+static CXXSkipResult cxxParserSkipBlock(void)
+{
+	CXXSkipStatement oStatement;
+	bool bIsCPP = cxxParserCurrentLanguageIsCPP();
+	bool bAfterExtern = false;
+	CXXSkipResult eResult;
+
+	cxxParserSkipNewStatement(&oStatement);
+
+	for(;;)
+	{
+		size_t iStart = vStringLength(g_cxx.pSkippedStatement);
+		enum CXXTokenType eType = cxxParserSkipNextToken(g_cxx.pSkippedStatement);
+		int iKeyword;
+
+		if(bAfterExtern)
+		{
+			bAfterExtern = false;
+			// extern "language": not in the chain
+			if(eType == CXXTokenTypeStringConstant)
+				continue;
+		}
+
+		switch(eType)
+		{
+			case CXXTokenTypeEOF:
+				return CXXSkipResultFailed;
+			case CXXTokenTypeIdentifier:
+				if(cxxParserSkipIdentifierNeedsParser(iStart,true,&iKeyword))
+					return CXXSkipResultParse;
+
+				if(iKeyword == KEYWORD_NONE)
+				{
+					const char * szName = vStringValue(g_cxx.pSkippedStatement) + iStart;
+					if(*szName == ' ')
+						szName++;
+					oStatement.bLastIsOverride = (strcmp(szName,"override") == 0);
+					break;
+				}
+
+				eType = CXXTokenTypeKeyword;
+
+				switch(iKeyword)
+				{
+					case CXXKeywordNAMESPACE:
+					case CXXKeywordTEMPLATE:
+					case CXXKeywordTYPEDEF:
+					case CXXKeywordENUM:
+					case CXXKeywordCLASS:
+					case CXXKeywordSTRUCT:
+					case CXXKeywordUNION:
+					case CXXKeywordPUBLIC:
+					case CXXKeywordPROTECTED:
+					case CXXKeywordPRIVATE:
+					case CXXKeywordUSING:
+						return CXXSkipResultParse;
+					case CXXKeywordIF:
+					case CXXKeywordFOR:
+					case CXXKeywordWHILE:
+					case CXXKeywordSWITCH:
+					case CXXKeywordCATCH:
+						eResult = cxxParserSkipUpToOneOf(
+								CXXTokenTypeParenthesisChain | CXXTokenTypeSemicolon |
+									CXXTokenTypeOpeningBracket,
+								&oStatement.bSeenSquare
+							);
+						if(eResult != CXXSkipResultDone)
+							return eResult;
+						cppEndStatement();
+						cppBeginStatement();
+						cxxParserSkipNewStatement(&oStatement);
+					continue;
+					case CXXKeywordTRY:
+						// maybe a lambda expressed as function-try-block
+						if(oStatement.uLast)
+							break;
+						// fall through
+					case CXXKeywordELSE:
+					case CXXKeywordDO:
+						cppEndStatement();
+						cppBeginStatement();
+						cxxParserSkipNewStatement(&oStatement);
+					continue;
+					case CXXKeywordRETURN:
+						if(bIsCPP)
+						{
+							// may be followed by { } or a lambda: the statement
+							// is kept for parsing it again.
+							cppEndStatement();
+							oStatement.uLast = 0;
+							oStatement.uBeforeLast = 0;
+							oStatement.uLastNotSquare = 0;
+							oStatement.bSeenParenthesis = false;
+							oStatement.bSeenSquare = false;
+							oStatement.bSeenReturn = true;
+							continue;
+						}
+						// fall through
+					case CXXKeywordCONTINUE:
+					case CXXKeywordBREAK:
+					case CXXKeywordGOTO:
+					case CXXKeywordTHROW:
+						eResult = cxxParserSkipUpToOneOf(
+								CXXTokenTypeSemicolon,
+								&oStatement.bSeenSquare
+							);
+						if(eResult != CXXSkipResultDone)
+							return eResult;
+						cppEndStatement();
+						cxxParserSkipNewStatement(&oStatement);
+					continue;
+					case CXXKeywordCASE:
+						eResult = cxxParserSkipUpToOneOf(
+								CXXTokenTypeSemicolon | CXXTokenTypeSingleColon,
+								&oStatement.bSeenSquare
+							);
+						if(eResult != CXXSkipResultDone)
+							return eResult;
+						cppEndStatement();
+						cxxParserSkipNewStatement(&oStatement);
+					continue;
+					case CXXKeywordEXTERN:
+						bAfterExtern = true;
+					continue; // not in the chain
+					case CXXKeywordSTATIC:
+					case CXXKeywordINLINE:
+					case CXXKeyword__INLINE:
+					case CXXKeyword__INLINE__:
+					case CXXKeyword__FORCEINLINE:
+					case CXXKeyword__FORCEINLINE__:
+					case CXXKeywordEXPLICIT:
+					case CXXKeywordVIRTUAL:
+					case CXXKeywordMUTABLE:
+					continue; // not in the chain
+					default:
+					break;
+				}
+			break;
+			case CXXTokenTypeSemicolon:
+				cppEndStatement();
+				cxxParserSkipNewStatement(&oStatement);
+			continue;
+			case CXXTokenTypeOpeningBracket:
+				if(cxxParserSkipIsListInitialization(&oStatement,bIsCPP))
+				{
+					bool bSeenSquare = false;
+					eResult = cxxParserSkipUpToOneOf(CXXTokenTypeClosingBracket,&bSeenSquare);
+					if(eResult != CXXSkipResultDone)
+						return eResult;
+					eType = CXXTokenTypeBracketChain;
+					break;
+				}
+
+				if(bIsCPP && oStatement.bSeenSquare)
+					return CXXSkipResultParse; // maybe a lambda
+
+				cxxParserNewStatement();
+
+				if(!cxxParserParseBlock(true))
+					return CXXSkipResultFailed;
+
+				cxxParserSkipNewStatement(&oStatement);
+			continue;
+			case CXXTokenTypeClosingBracket:
+			return CXXSkipResultDone;
+			case CXXTokenTypeOpeningSquareParenthesis:
+				if(g_cxx.iChar == '[')
+					return CXXSkipResultParse; // [[ attribute ]]
+				oStatement.bSeenSquare = true;
+				// fall through
+			case CXXTokenTypeOpeningParenthesis:
+			{
+				bool bSeenSquare = false;
+				// see the declaration of CXXTokenType enum.
+				// Shifting by 4 gives the corresponding closing token type
+				eResult = cxxParserSkipUpToOneOf(eType << 4,&bSeenSquare);
+				if(eResult != CXXSkipResultDone)
+					return eResult;
+				// Shifting by 8 gives the corresponding chain marker
+				eType <<= 8;
+				if(eType == CXXTokenTypeParenthesisChain)
+					oStatement.bSeenParenthesis = true;
+			}
+			break;
+			default:
+				// something else we didn't handle
+			break;
+		}
+
+		if(eType != CXXTokenTypeIdentifier)
+			oStatement.bLastIsOverride = false;
+		oStatement.uBeforeLast = oStatement.uLast;
+		oStatement.uLast = eType;
+		if(eType != CXXTokenTypeSquareParenthesisChain)
+			oStatement.uLastNotSquare = eType;
+	}
+}
+
+// Skips the function body that starts after the current opening bracket.
+// Returns the value cxxParserParseBlockInternal() would return.
+static bool cxxParserSkipFunctionBody(void)
+{
+	CXX_DEBUG_ENTER();
+
+	int iNestingLevels = g_cxx.iNestingLevels;
+
+	cxxParserNewStatement();
+	cppBeginStatement();
+
+	switch(cxxParserSkipBlock())
+	{
+		case CXXSkipResultDone:
+			cxxParserNewStatement();
+			CXX_DEBUG_LEAVE_TEXT("Skipped the block");
+			return true;
+		case CXXSkipResultFailed:
+			g_cxx.iNestingLevels = iNestingLevels;
+			CXX_DEBUG_LEAVE_TEXT("Syntax error while skipping the block");
+			return false;
+		default:
+		break;
+	}
+
+	g_cxx.iNestingLevels = iNestingLevels;
+
+	CXX_DEBUG_PRINT(
+			"Parsing the block from '%s'",
+			vStringValue(g_cxx.pSkippedStatement)
+		);
+
+	if(g_cxx.iChar != EOF)
+		cppUngetc(g_cxx.iChar);
+	cppUngetString(
+			vStringValue(g_cxx.pSkippedStatement),
+			vStringLength(g_cxx.pSkippedStatement)
+		);
+	g_cxx.iChar = ' ';
+
+	bool bRet = cxxParserParseBlockInternal(true);
+	CXX_DEBUG_LEAVE();
+	return bRet;
+}
+
 bool cxxParserParseBlock(bool bExpectClosingBracket)
 {
 	cxxSubparserNotifyEnterBlock ();
 
 	cppPushExternalParserBlock();
-	bool bRet = cxxParserParseBlockInternal(bExpectClosingBracket);
+	bool bRet = (
+			bExpectClosingBracket &&
+			g_cxx.bSkipFunctionBodies &&
+			(!g_cxx.pUngetToken) &&
+			(cxxScopeGetType() == CXXScopeTypeFunction)
+		) ?
+		cxxParserSkipFunctionBody() :
+		cxxParserParseBlockInternal(bExpectClosingBracket);
 	cppPopExternalParserBlock();
 
 	cxxSubparserNotifyLeaveBlock ();
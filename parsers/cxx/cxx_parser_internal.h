@@ -35,6 +35,8 @@ typedef enum _CXXLanguage
 
 // cxx_parser_tokenizer.c
 bool cxxParserParseNextToken(void);
+enum CXXTokenType cxxParserSkipNextToken(vString * pText);
+void cxxParserInitTokenizer(void);
 void cxxParserUngetCurrentToken(void);
 
 // cxx_parser_lambda.c
@@ -372,6 +374,14 @@ typedef struct _CXXParserState
 	// This usually happens only with erroneous macro usage or broken input.
 	int iNestingLevels;
 
+	// This is set to true when no tag can be made in a function body
+	// by itself: the bodies are then skipped without making tokens
+	// (see cxxParserParseBlock()).
+	bool bSkipFunctionBodies;
+
+	// The text of the function body statement being skipped.
+	vString * pSkippedStatement;
+
 } CXXParserState;
 
 
@@ -26,10 +26,17 @@
 
 #define UINFO(c) (((c) < 0x80 && (c) >= 0) ? g_aCharTable[c].uType : 0)
 
+// The character classes passed to cppGetcSpan(), built from g_aCharTable
+// by cxxParserInitTokenizer(). Runs of these characters are taken from
+// the input in bulk.
+static bool g_aSpaceSpan[256];
+static bool g_aIdentifierSpan[256];
+static bool g_aNumberSpan[256];
+
 static void cxxParserSkipToNonWhiteSpace(void)
 {
-	while(cppIsspace(g_cxx.iChar))
-		g_cxx.iChar = cppGetc();
+	if(cppIsspace(g_cxx.iChar))
+		g_cxx.iChar = cppGetcSpan(NULL,g_aSpaceSpan);
 }
 
 enum CXXCharType
@@ -861,6 +868,16 @@ static CXXCharTypeData g_aCharTable[128] =
 	{ 0, 0, 0 }
 };
 
+void cxxParserInitTokenizer(void)
+{
+	for(int c = 0;c < 128;c++)
+	{
+		g_aSpaceSpan[c] = cppIsspace(c);
+		g_aIdentifierSpan[c] = (g_aCharTable[c].uType & CXXCharTypePartOfIdentifier) != 0;
+		g_aNumberSpan[c] = (g_aCharTable[c].uType & CXXCharTypeValidInNumber) != 0;
+	}
+}
+
 // Parse the contents of an attribute chain.
 // The input is the innermost chain of __attribute__((...)) or [[...]]
 static void cxxParserAnalyzeAttributeChain(CXXTokenChain * pChain)
@@ -1210,58 +1227,12 @@ void cxxParserUngetCurrentToken(void)
 // times in a recursive macro expansion.
 #define CXX_PARSER_MAXIMUM_MACRO_USE_COUNT 8
 
-// Returns false if it finds an EOF. Returns true otherwise.
-//
-// In some special cases this function may parse more than one token,
-// however only a single token will always be returned.
-bool cxxParserParseNextToken(void)
+// Scans the token that starts at g_cxx.iChar, which must not be a blank
+// nor EOF, appending its text to pWord. On exit g_cxx.iChar is the first
+// character after the token. Identifiers are neither looked up in
+// the keyword table nor expanded as macros here.
+static enum CXXTokenType cxxParserScanToken(vString * pWord,bool * pbFollowedBySpace)
 {
-	// The token chain should not be allowed to grow arbitrarily large.
-	// The token structures are quite big and it's easy to grow up to
-	// 5-6GB or memory usage. However this limit should be large enough
-	// to accommodate all the reasonable statements that could have some
-	// information in them. This includes multiple function prototypes
-	// in a single statement (ImageMagick has some examples) but probably
-	// does NOT include large data tables.
-	int iInitialTokenChainSize = g_cxx.pTokenChain->iCount;
-	if(iInitialTokenChainSize >= CXX_PARSER_MAXIMUM_TOKEN_CHAIN_SIZE)
-		cxxTokenChainDestroyLast(g_cxx.pTokenChain);
-
-	if(g_cxx.pUngetToken)
-	{
-		// got some tokens in the unget chain.
-		cxxTokenChainAppend(g_cxx.pTokenChain,g_cxx.pUngetToken);
-
-		g_cxx.pToken = g_cxx.pUngetToken;
-
-		g_cxx.pUngetToken = NULL;
-
-		return !cxxTokenTypeIs(g_cxx.pToken,CXXTokenTypeEOF);
-	}
-
-	CXXToken * t = cxxTokenCreate();
-
-	cxxTokenChainAppend(g_cxx.pTokenChain,t);
-
-	g_cxx.pToken = t;
-
-	cxxParserSkipToNonWhiteSpace();
-
-	// FIXME: this cpp handling is kind of broken:
-	// it works only because the moon is in the correct phase.
-	cppBeginStatement();
-
-	// This must be done after getting char from input
-	t->iLineNumber = getInputLineNumber();
-	t->oFilePosition = getInputFilePosition();
-
-	if(g_cxx.iChar == EOF)
-	{
-		t->eType = CXXTokenTypeEOF;
-		t->bFollowedBySpace = false;
-		return false;
-	}
-
 	unsigned int uInfo = UINFO(g_cxx.iChar);
 
 	//fprintf(stderr,"Char %c %02x info %u\n",g_cxx.iChar,g_cxx.iChar,uInfo);
@@ -1269,10 +1240,7 @@ bool cxxParserParseNextToken(void)
 	if(uInfo & CXXCharTypeStartOfIdentifier)
 	{
 		// word
-		t->eType = CXXTokenTypeIdentifier;
-		t->bFollowedBySpace = false;
-
-		vStringPut(t->pszWord,g_cxx.iChar);
+		vStringPut(pWord,g_cxx.iChar);
 
 		// special case for tile, which may actually be an operator
 		if(g_cxx.iChar == '~')
@@ -1281,10 +1249,12 @@ bool cxxParserParseNextToken(void)
 			g_cxx.iChar = cppGetc();
 			if(cppIsspace(g_cxx.iChar))
 			{
-				t->bFollowedBySpace = true;
+				*pbFollowedBySpace = true;
 				g_cxx.iChar = cppGetc();
 				while(cppIsspace(g_cxx.iChar))
 					g_cxx.iChar = cppGetc();
+			} else {
+				*pbFollowedBySpace = false;
 			}
 
 			// non space
@@ -1292,16 +1262,15 @@ bool cxxParserParseNextToken(void)
 			if(!(uInfo & CXXCharTypeStartOfIdentifier))
 			{
 				// this is not an identifier after all
-				t->eType = CXXTokenTypeOperator;
-				if((!t->bFollowedBySpace) && g_cxx.iChar == '=')
+				if((!*pbFollowedBySpace) && g_cxx.iChar == '=')
 				{
 					// make ~= single token so it's not handled as
 					// a separate assignment
-					vStringPut(t->pszWord,g_cxx.iChar);
+					vStringPut(pWord,g_cxx.iChar);
 					g_cxx.iChar = cppGetc();
-					t->bFollowedBySpace = cppIsspace(g_cxx.iChar);
+					*pbFollowedBySpace = cppIsspace(g_cxx.iChar);
 				}
-				return true;
+				return CXXTokenTypeOperator;
 			}
 		} else {
 			g_cxx.iChar = cppGetc();
@@ -1312,287 +1281,98 @@ bool cxxParserParseNextToken(void)
 			uInfo = UINFO(g_cxx.iChar);
 			if(!(uInfo & CXXCharTypePartOfIdentifier))
 				break;
-			vStringPut(t->pszWord,g_cxx.iChar);
-			g_cxx.iChar = cppGetc();
+			vStringPut(pWord,g_cxx.iChar);
+			g_cxx.iChar = cppGetcSpan(pWord,g_aIdentifierSpan);
 		}
 
-		int iCXXKeyword = lookupKeyword(t->pszWord->buffer,g_cxx.eLangType);
-		if(iCXXKeyword >= 0)
-		{
-			if(cxxKeywordIsDisabled((CXXKeyword)iCXXKeyword))
-			{
-				t->eType = CXXTokenTypeIdentifier;
-			} else {
-
-				t->eType = CXXTokenTypeKeyword;
-				t->eKeyword = (CXXKeyword)iCXXKeyword;
-
-				if(iCXXKeyword == CXXKeyword__ATTRIBUTE__
-					|| iCXXKeyword == CXXKeyword__DECLSPEC)
-				{
-					// special handling for __attribute__ and __declspec
-					return cxxParserParseNextTokenCondenseAttribute();
-				}
-			}
-		} else {
-
-			cppMacroInfo * pMacro = cppFindMacro(vStringValue(t->pszWord));
-
-#ifdef DEBUG
-			if(pMacro && (pMacro->useCount >= CXX_PARSER_MAXIMUM_MACRO_USE_COUNT))
-			{
-				/* If the macro is overly used, report it here. */
-				CXX_DEBUG_PRINT("Overly uesd macro %s <%p> useCount: %d (> %d)",
-								pMacro->name,
-								pMacro, pMacro->useCount,
-								CXX_PARSER_MAXIMUM_MACRO_USE_COUNT);
-			}
-#endif
-
-			if(pMacro && (pMacro->useCount < CXX_PARSER_MAXIMUM_MACRO_USE_COUNT))
-			{
-				CXX_DEBUG_PRINT("Macro %s <%p> useCount: %d", pMacro->name,
-								pMacro, pMacro->useCount);
-
-				cxxTokenChainDestroyLast(g_cxx.pTokenChain);
-
-				CXXToken * pParameterChain = NULL;
-
-				if(pMacro->hasParameterList)
-				{
-					CXX_DEBUG_PRINT("Macro has parameter list");
-					if(!cxxParserParseNextTokenSkipMacroParenthesis(&pParameterChain))
-						return false;
-				}
-
-				// This is used to avoid infinite recursion in substitution
-				// (things like -D foo=foo or similar)
-
-				if(pMacro->replacements)
-				{
-					CXX_DEBUG_PRINT("The token has replacements: applying");
-
-					if(
-						// Exclude possible cases of recursive macro expansion that
-						// causes level nesting
-						//    -D'x=y(x)'
-						(g_cxx.iNestingLevels < CXX_PARSER_MAXIMUM_NESTING_LEVELS) &&
-						// Exclude possible cases of recursive macro expansion that
-						// causes a single token chain to grow too big
-						//    -D'x=y.x'
-						(iInitialTokenChainSize < CXX_PARSER_MAXIMUM_TOKEN_CHAIN_SIZE) &&
-						// Detect other cases of nasty macro expansion that cause
-						// the unget buffer to grow fast (but the token chain to grow slowly)
-						//    -D'p=a' -D'a=p+p'
-						(cppUngetBufferSize() < CXX_PARSER_MAXIMUM_UNGET_BUFFER_SIZE_FOR_MACRO_REPLACEMENTS)
-					)
-					{
-						// unget last char
-						cppUngetc(g_cxx.iChar);
-						// unget the replacement
-						cxxParserParseNextTokenApplyReplacement(
-								pMacro,
-								pParameterChain
-							);
-
-						g_cxx.iChar = cppGetc();
-					} else {
-						// Possibly a recursive macro
-						CXX_DEBUG_PRINT(
-								"Token has replacement but either nesting level is too "
-								"big (%d), the token chain (%d) or the unget buffer (%d) "
-								"have grown too large",
-								g_cxx.iNestingLevels,
-								g_cxx.pTokenChain->iCount,
-								cppUngetBufferSize()
-							);
-					}
-				}
-
-				if(pParameterChain)
-					cxxTokenDestroy(pParameterChain);
-
-				g_cxx.iNestingLevels++;
-				// Have no token to return: parse it
-				CXX_DEBUG_PRINT("Parse inner token");
-				bool bRet = cxxParserParseNextToken();
-				CXX_DEBUG_PRINT("Parsed inner token: %s type %d",g_cxx.pToken->pszWord->buffer,g_cxx.pToken->eType);
-				g_cxx.iNestingLevels--;
-				return bRet;
-			}
-		}
-
-		t->bFollowedBySpace = cppIsspace(g_cxx.iChar);
-
-		return true;
+		*pbFollowedBySpace = cppIsspace(g_cxx.iChar);
+		return CXXTokenTypeIdentifier;
 	}
 
+	enum CXXTokenType eType;
+
 	if(g_cxx.iChar == '-')
 	{
 		// special case for pointer
-		vStringPut(t->pszWord,g_cxx.iChar);
+		vStringPut(pWord,g_cxx.iChar);
 		g_cxx.iChar = cppGetc();
 		if(g_cxx.iChar == '>')
 		{
-			t->eType = CXXTokenTypePointerOperator;
-			vStringPut(t->pszWord,g_cxx.iChar);
+			eType = CXXTokenTypePointerOperator;
+			vStringPut(pWord,g_cxx.iChar);
 			g_cxx.iChar = cppGetc();
 		} else {
-			t->eType = CXXTokenTypeOperator;
+			eType = CXXTokenTypeOperator;
 			if(g_cxx.iChar == '-')
 			{
-				vStringPut(t->pszWord,g_cxx.iChar);
+				vStringPut(pWord,g_cxx.iChar);
 				g_cxx.iChar = cppGetc();
 			}
 		}
-		t->bFollowedBySpace = cppIsspace(g_cxx.iChar);
-		return true;
+		*pbFollowedBySpace = cppIsspace(g_cxx.iChar);
+		return eType;
 	}
 
-#if 0
-	// As long as we use cppGetc() we don't need this
+	// As long as we use cppGetc() strings and character constants come
+	// as single symbols with the contents stored in the preprocessor.
 
-	if(g_cxx.iChar == '"')
-	{
-		// special case for strings
-		t->eType = CXXTokenTypeStringConstant;
-		vStringPut(t->pszWord,g_cxx.iChar);
-		// We don't even care of storing the other chars: we don't need
-		// them for parsing
-		// FIXME: We might need them in signature:() tag.. maybe add
-		// them up to a certain length only?
-		for(;;)
-		{
-			g_cxx.iChar = cppGetc();
-			if(g_cxx.iChar == EOF)
-			{
-				t->bFollowedBySpace = false;
-				return true;
-			}
-			if(g_cxx.iChar == '\\')
-			{
-				// escape
-				g_cxx.iChar = cppGetc();
-				if(g_cxx.iChar == EOF)
-				{
-					t->bFollowedBySpace = false;
-					return true;
-				}
-			} else if(g_cxx.iChar == '"')
-			{
-				g_cxx.iChar = cppGetc();
-				break;
-			}
-		}
-		t->bFollowedBySpace = cppIsspace(g_cxx.iChar);
-		return true;
-	}
-#else
 	if(g_cxx.iChar == STRING_SYMBOL)
 	{
-		t->eType = CXXTokenTypeStringConstant;
-		vStringPut(t->pszWord,'"');
-		vStringCat(t->pszWord,cppGetLastCharOrStringContents());
-		vStringPut(t->pszWord,'"');
+		vStringPut(pWord,'"');
+		vStringCat(pWord,cppGetLastCharOrStringContents());
+		vStringPut(pWord,'"');
 		g_cxx.iChar = cppGetc();
-		t->bFollowedBySpace = cppIsspace(g_cxx.iChar);
-		return true;
+		*pbFollowedBySpace = cppIsspace(g_cxx.iChar);
+		return CXXTokenTypeStringConstant;
 	}
-#endif
 
-#if 0
-	// As long as we use cppGetc() we don't need this
-	if(g_cxx.iChar == '\'')
-	{
-		// special case for strings
-		t->eType = CXXTokenTypeCharacterConstant;
-		vStringPut(t->pszWord,g_cxx.iChar);
-		// We don't even care storing the other chars: we don't
-		// need them for parsing
-		for(;;)
-		{
-			g_cxx.iChar = cppGetc();
-			if(g_cxx.iChar == EOF)
-			{
-				t->bFollowedBySpace = false;
-				return true;
-			}
-			if(g_cxx.iChar == '\\')
-			{
-				// escape
-				g_cxx.iChar = cppGetc();
-				if(g_cxx.iChar == EOF)
-				{
-					t->bFollowedBySpace = false;
-					return true;
-				}
-			} else if(g_cxx.iChar == '\'')
-			{
-				g_cxx.iChar = cppGetc();
-				break;
-			}
-		}
-		t->bFollowedBySpace = cppIsspace(g_cxx.iChar);
-		return true;
-	}
-#else
 	if(g_cxx.iChar == CHAR_SYMBOL)
 	{
-		t->eType = CXXTokenTypeCharacterConstant;
-		vStringPut(t->pszWord,'\'');
-		vStringCat(t->pszWord,cppGetLastCharOrStringContents());
-		vStringPut(t->pszWord,'\'');
+		vStringPut(pWord,'\'');
+		vStringCat(pWord,cppGetLastCharOrStringContents());
+		vStringPut(pWord,'\'');
 		g_cxx.iChar = cppGetc();
-		t->bFollowedBySpace = cppIsspace(g_cxx.iChar);
-		return true;
+		*pbFollowedBySpace = cppIsspace(g_cxx.iChar);
+		return CXXTokenTypeCharacterConstant;
 	}
-#endif
 
 	if(uInfo & CXXCharTypeDecimalDigit)
 	{
 		// number
-		t->eType = CXXTokenTypeNumber;
-		vStringPut(t->pszWord,g_cxx.iChar);
+		vStringPut(pWord,g_cxx.iChar);
 
-		for(;;)
-		{
-			g_cxx.iChar = cppGetc();
-			uInfo = UINFO(g_cxx.iChar);
-			if(!(uInfo & CXXCharTypeValidInNumber))
-				break;
-			vStringPut(t->pszWord,g_cxx.iChar);
-		}
+		g_cxx.iChar = cppGetcSpan(pWord,g_aNumberSpan);
 
-		t->bFollowedBySpace = cppIsspace(g_cxx.iChar);
-		return true;
+		*pbFollowedBySpace = cppIsspace(g_cxx.iChar);
+		return CXXTokenTypeNumber;
 	}
 
 	if(uInfo & CXXCharTypeNamedSingleOrRepeatedCharToken)
 	{
-		t->eType = g_aCharTable[g_cxx.iChar].uSingleTokenType;
-		vStringPut(t->pszWord,g_cxx.iChar);
+		eType = g_aCharTable[g_cxx.iChar].uSingleTokenType;
+		vStringPut(pWord,g_cxx.iChar);
 		int iChar = g_cxx.iChar;
 		g_cxx.iChar = cppGetc();
 		if(g_cxx.iChar == iChar)
 		{
-			t->eType = g_aCharTable[g_cxx.iChar].uMultiTokenType;
+			eType = g_aCharTable[g_cxx.iChar].uMultiTokenType;
 			// We could signal a syntax error with more than two colons
 			// or equal signs...but we're tolerant
 			do {
-				vStringPut(t->pszWord,g_cxx.iChar);
+				vStringPut(pWord,g_cxx.iChar);
 				g_cxx.iChar = cppGetc();
 			} while(g_cxx.iChar == iChar);
 		}
-		t->bFollowedBySpace = cppIsspace(g_cxx.iChar);
-		return true;
+		*pbFollowedBySpace = cppIsspace(g_cxx.iChar);
+		return eType;
 	}
 
 	if(uInfo & CXXCharTypeCustomHandling)
 	{
-		t->eType = g_aCharTable[g_cxx.iChar].uSingleTokenType;
-		vStringPut(t->pszWord,g_cxx.iChar);
+		eType = g_aCharTable[g_cxx.iChar].uSingleTokenType;
+		vStringPut(pWord,g_cxx.iChar);
 		g_cxx.iChar = cppGetc();
-		switch(t->eType)
+		switch(eType)
 		{
 			case CXXTokenTypeSmallerThanSign:
 				// The < sign is used in templates and is problematic if parsed incorrectly.
@@ -1601,25 +1381,25 @@ bool cxxParserParseNextToken(void)
 				{
 					case '<':
 						// <<
-						t->eType = CXXTokenTypeOperator;
-						vStringPut(t->pszWord,g_cxx.iChar);
+						eType = CXXTokenTypeOperator;
+						vStringPut(pWord,g_cxx.iChar);
 						g_cxx.iChar = cppGetc();
 						if(g_cxx.iChar == '=')
 						{
 							// <<=
-							vStringPut(t->pszWord,g_cxx.iChar);
+							vStringPut(pWord,g_cxx.iChar);
 							g_cxx.iChar = cppGetc();
 						}
 					break;
 					case '=':
 						// <=
-						t->eType = CXXTokenTypeOperator;
-						vStringPut(t->pszWord,g_cxx.iChar);
+						eType = CXXTokenTypeOperator;
+						vStringPut(pWord,g_cxx.iChar);
 						g_cxx.iChar = cppGetc();
 						if(g_cxx.iChar == '>')
 						{
 							// <=>
-							vStringPut(t->pszWord,g_cxx.iChar);
+							vStringPut(pWord,g_cxx.iChar);
 							g_cxx.iChar = cppGetc();
 						}
 					break;
@@ -1628,64 +1408,264 @@ bool cxxParserParseNextToken(void)
 					break;
 				}
 
-				t->bFollowedBySpace = cppIsspace(g_cxx.iChar);
+				*pbFollowedBySpace = cppIsspace(g_cxx.iChar);
 			break;
 			case CXXTokenTypeOpeningSquareParenthesis:
-				// special handling for [[ attribute ]] which can appear almost anywhere
-				// in the source code and is kind of annoying for the parser.
+				// The tokens of [[ attribute ]] can be separated by a space,
+				// at least according to gcc: skip it so the caller can
+				// look for the second square parenthesis.
 
-				t->bFollowedBySpace = cppIsspace(g_cxx.iChar);
+				*pbFollowedBySpace = cppIsspace(g_cxx.iChar);
 
-				if(t->bFollowedBySpace)
+				if(*pbFollowedBySpace)
 				{
-					// The tokens can be separated by a space, at least according to gcc.
 					do {
 						g_cxx.iChar = cppGetc();
 					} while(cppIsspace(g_cxx.iChar));
 				}
-
-				if(g_cxx.iChar == '[')
-					return cxxParserParseNextTokenCondenseCXX11Attribute();
 			break;
 			default:
 				CXX_DEBUG_ASSERT(false,"There should be a custom handler for this token type");
 				// treat as single token type in non debug builds
-				t->bFollowedBySpace = cppIsspace(g_cxx.iChar);
+				*pbFollowedBySpace = cppIsspace(g_cxx.iChar);
 			break;
 		}
 
-		return true;
+		return eType;
 	}
 
 	if(uInfo & CXXCharTypeNamedSingleCharToken)
 	{
-		t->eType = g_aCharTable[g_cxx.iChar].uSingleTokenType;
-		vStringPut(t->pszWord,g_cxx.iChar);
+		eType = g_aCharTable[g_cxx.iChar].uSingleTokenType;
+		vStringPut(pWord,g_cxx.iChar);
 		g_cxx.iChar = cppGetc();
-		t->bFollowedBySpace = cppIsspace(g_cxx.iChar);
-		return true;
+		*pbFollowedBySpace = cppIsspace(g_cxx.iChar);
+		return eType;
 	}
 
 	if(uInfo & CXXCharTypeOperator)
 	{
-		t->eType = CXXTokenTypeOperator;
-		vStringPut(t->pszWord,g_cxx.iChar);
+		vStringPut(pWord,g_cxx.iChar);
 		g_cxx.iChar = cppGetc();
 		uInfo = UINFO(g_cxx.iChar);
 		while(uInfo & CXXCharTypeOperator)
 		{
-			vStringPut(t->pszWord,g_cxx.iChar);
+			vStringPut(pWord,g_cxx.iChar);
 			g_cxx.iChar = cppGetc();
 			uInfo = UINFO(g_cxx.iChar);
 		}
-		t->bFollowedBySpace = cppIsspace(g_cxx.iChar);
-		return true;
+		*pbFollowedBySpace = cppIsspace(g_cxx.iChar);
+		return CXXTokenTypeOperator;
 	}
 
-	t->eType = CXXTokenTypeUnknown;
-	vStringPut(t->pszWord,g_cxx.iChar);
+	vStringPut(pWord,g_cxx.iChar);
 	g_cxx.iChar = cppGetc();
-	t->bFollowedBySpace = cppIsspace(g_cxx.iChar);
+	*pbFollowedBySpace = cppIsspace(g_cxx.iChar);
+	return CXXTokenTypeUnknown;
+}
+
+// Scans the next token as cxxParserParseNextToken() does, without making
+// it: the text of the token is appended to pText, after a space if blanks
+// come before it. Identifiers are neither looked up nor expanded and
+// [[ is not condensed: this is left to the caller.
+enum CXXTokenType cxxParserSkipNextToken(vString * pText)
+{
+	if(cppIsspace(g_cxx.iChar))
+	{
+		g_cxx.iChar = cppGetcSpan(NULL,g_aSpaceSpan);
+		vStringPut(pText,' ');
+	}
+
+	cppBeginStatement();
+
+	if(g_cxx.iChar == EOF)
+		return CXXTokenTypeEOF;
+
+	bool bFollowedBySpace;
+
+	enum CXXTokenType eType = cxxParserScanToken(pText,&bFollowedBySpace);
+
+	// Blanks skipped within the token (after [ or ~) are kept as well
+	if(bFollowedBySpace && !cppIsspace(g_cxx.iChar))
+		vStringPut(pText,' ');
+
+	return eType;
+}
+
+// Returns false if it finds an EOF. Returns true otherwise.
+//
+// In some special cases this function may parse more than one token,
+// however only a single token will always be returned.
+bool cxxParserParseNextToken(void)
+{
+	// The token chain should not be allowed to grow arbitrarily large.
+	// The token structures are quite big and it's easy to grow up to
+	// 5-6GB or memory usage. However this limit should be large enough
+	// to accommodate all the reasonable statements that could have some
+	// information in them. This includes multiple function prototypes
+	// in a single statement (ImageMagick has some examples) but probably
+	// does NOT include large data tables.
+	int iInitialTokenChainSize = g_cxx.pTokenChain->iCount;
+	if(iInitialTokenChainSize >= CXX_PARSER_MAXIMUM_TOKEN_CHAIN_SIZE)
+		cxxTokenChainDestroyLast(g_cxx.pTokenChain);
+
+	if(g_cxx.pUngetToken)
+	{
+		// got some tokens in the unget chain.
+		cxxTokenChainAppend(g_cxx.pTokenChain,g_cxx.pUngetToken);
+
+		g_cxx.pToken = g_cxx.pUngetToken;
+
+		g_cxx.pUngetToken = NULL;
+
+		return !cxxTokenTypeIs(g_cxx.pToken,CXXTokenTypeEOF);
+	}
+
+	CXXToken * t = cxxTokenCreate();
+
+	cxxTokenChainAppend(g_cxx.pTokenChain,t);
+
+	g_cxx.pToken = t;
+
+	cxxParserSkipToNonWhiteSpace();
+
+	// FIXME: this cpp handling is kind of broken:
+	// it works only because the moon is in the correct phase.
+	cppBeginStatement();
+
+	// This must be done after getting char from input
+	t->iLineNumber = getInputLineNumber();
+	t->oFilePosition = getInputFilePosition();
+
+	if(g_cxx.iChar == EOF)
+	{
+		t->eType = CXXTokenTypeEOF;
+		t->bFollowedBySpace = false;
+		return false;
+	}
+
+	bool bFollowedBySpace;
+
+	t->eType = cxxParserScanToken(t->pszWord,&bFollowedBySpace);
+	t->bFollowedBySpace = bFollowedBySpace;
+
+	if(t->eType == CXXTokenTypeOpeningSquareParenthesis)
+	{
+		// special handling for [[ attribute ]] which can appear almost anywhere
+		// in the source code and is kind of annoying for the parser.
+		if(g_cxx.iChar == '[')
+			return cxxParserParseNextTokenCondenseCXX11Attribute();
+		return true;
+	}
+
+	if(t->eType != CXXTokenTypeIdentifier)
+		return true;
+
+	int iCXXKeyword = lookupKeyword(t->pszWord->buffer,g_cxx.eLangType);
+	if(iCXXKeyword >= 0)
+	{
+		if(cxxKeywordIsDisabled((CXXKeyword)iCXXKeyword))
+		{
+			t->eType = CXXTokenTypeIdentifier;
+		} else {
+
+			t->eType = CXXTokenTypeKeyword;
+			t->eKeyword = (CXXKeyword)iCXXKeyword;
+
+			if(iCXXKeyword == CXXKeyword__ATTRIBUTE__
+				|| iCXXKeyword == CXXKeyword__DECLSPEC)
+			{
+				// special handling for __attribute__ and __declspec
+				return cxxParserParseNextTokenCondenseAttribute();
+			}
+		}
+	} else {
+
+		cppMacroInfo * pMacro = cppFindMacro(vStringValue(t->pszWord));
+
+#ifdef DEBUG
+		if(pMacro && (pMacro->useCount >= CXX_PARSER_MAXIMUM_MACRO_USE_COUNT))
+		{
+			/* If the macro is overly used, report it here. */
+			CXX_DEBUG_PRINT("Overly uesd macro %s <%p> useCount: %d (> %d)",
+							pMacro->name,
+							pMacro, pMacro->useCount,
+							CXX_PARSER_MAXIMUM_MACRO_USE_COUNT);
+		}
+#endif
+
+		if(pMacro && (pMacro->useCount < CXX_PARSER_MAXIMUM_MACRO_USE_COUNT))
+		{
+			CXX_DEBUG_PRINT("Macro %s <%p> useCount: %d", pMacro->name,
+							pMacro, pMacro->useCount);
+
+			cxxTokenChainDestroyLast(g_cxx.pTokenChain);
+
+			CXXToken * pParameterChain = NULL;
+
+			if(pMacro->hasParameterList)
+			{
+				CXX_DEBUG_PRINT("Macro has parameter list");
+				if(!cxxParserParseNextTokenSkipMacroParenthesis(&pParameterChain))
+					return false;
+			}
+
+			// This is used to avoid infinite recursion in substitution
+			// (things like -D foo=foo or similar)
+
+			if(pMacro->replacements)
+			{
+				CXX_DEBUG_PRINT("The token has replacements: applying");
+
+				if(
+					// Exclude possible cases of recursive macro expansion that
+					// causes level nesting
+					//    -D'x=y(x)'
+					(g_cxx.iNestingLevels < CXX_PARSER_MAXIMUM_NESTING_LEVELS) &&
+					// Exclude possible cases of recursive macro expansion that
+					// causes a single token chain to grow too big
+					//    -D'x=y.x'
+					(iInitialTokenChainSize < CXX_PARSER_MAXIMUM_TOKEN_CHAIN_SIZE) &&
+					// Detect other cases of nasty macro expansion that cause
+					// the unget buffer to grow fast (but the token chain to grow slowly)
+					//    -D'p=a' -D'a=p+p'
+					(cppUngetBufferSize() < CXX_PARSER_MAXIMUM_UNGET_BUFFER_SIZE_FOR_MACRO_REPLACEMENTS)
+				)
+				{
+					// unget last char
+					cppUngetc(g_cxx.iChar);
+					// unget the replacement
+					cxxParserParseNextTokenApplyReplacement(
+							pMacro,
+							pParameterChain
+						);
+
+					g_cxx.iChar = cppGetc();
+				} else {
+					// Possibly a recursive macro
+					CXX_DEBUG_PRINT(
+							"Token has replacement but either nesting level is too "
+							"big (%d), the token chain (%d) or the unget buffer (%d) "
+							"have grown too large",
+							g_cxx.iNestingLevels,
+							g_cxx.pTokenChain->iCount,
+							cppUngetBufferSize()
+						);
+				}
+			}
+
+			if(pParameterChain)
+				cxxTokenDestroy(pParameterChain);
+
+			g_cxx.iNestingLevels++;
+			// Have no token to return: parse it
+			CXX_DEBUG_PRINT("Parse inner token");
+			bool bRet = cxxParserParseNextToken();
+			CXX_DEBUG_PRINT("Parsed inner token: %s type %d",g_cxx.pToken->pszWord->buffer,g_cxx.pToken->eType);
+			g_cxx.iNestingLevels--;
+			return bRet;
+		}
+	}
 
 	return true;
 }
@@ -305,12 +305,14 @@ extern parserDefinition* QtMocParser (void)
 {
 	parserDefinition* const def = parserNew("QtMoc");
 
+	static const int notifyKinds [] = { CXXTagKindPROTOTYPE, KIND_GHOST_INDEX };
 	static struct sQtMocSubparser qtMocSubparser = {
 		.cxx = {
 			.subparser = {
 				.direction = SUBPARSER_BI_DIRECTION,
 				.inputStart = inputStart,
 				.makeTagEntryNotify = makeTagEntryNotify,
+				.makeTagEntryNotifyKinds = notifyKinds,
 			},
 			.enterBlockNotify = enterBlockNotify,
 			.leaveBlockNotify = leaveBlockNotify,
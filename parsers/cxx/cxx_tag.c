@@ -14,6 +14,7 @@
 #include "cxx_parser_internal.h"
 
 #include "entry.h"
+#include "htable.h"
 #include "../cpreprocessor.h"
 #include "routines.h"
 #include "trashbox.h"
@@ -90,6 +91,14 @@ static const char * g_aCXXAccessStrings [] = {
 	"protected",
 };
 
+// The number of the tags of each kind registered in each scope, for the
+// nth field. Counting the members of the scope at each new member made
+// the classes with many members slow.
+static hashTable * g_pScopeKindCounts = NULL;
+
+#define CXX_SCOPE_KIND_KEY(iScope,uKind) \
+	((void *)((((uintptr_t)(iScope)) << 8) | (uintptr_t)(uKind)))
+
 #define CXX_COMMON_FIELDS \
 	{ \
 		.name = "properties", \
@@ -161,6 +170,15 @@ void cxxTagInitForLanguage(langType eLangType)
 	} else {
 		CXX_DEBUG_ASSERT(false,"Invalid language passed to cxxTagInitForLanguage()");
 	}
+
+	if(g_pScopeKindCounts)
+	{
+		hashTableClear(g_pScopeKindCounts);
+	} else {
+		g_pScopeKindCounts = hashTableNew(1031,hashPtrhash,hashPtreq,NULL,NULL);
+		hashTableSetValueForUnknownKey(g_pScopeKindCounts,HT_INT_TO_PTR(0),NULL);
+		DEFAULT_TRASH_BOX(g_pScopeKindCounts,hashTableDelete);
+	}
 }
 
 kindDefinition * cxxTagGetCKindDefinitions(void)
@@ -275,14 +293,6 @@ void cxxTagUseTokensInRangeAsPartOfDefTags(int iCorkIndex, CXXToken * pFrom, CXX
 	}
 }
 
-static bool countSameKindEntry(int corkIndex,
-							   tagEntryInfo * entry,
-							   void * data)
-{
-	unsigned int *uKind = data;
-	return (entry->kindIndex == *uKind);
-}
-
 tagEntryInfo * cxxTagBegin(unsigned int uKind,CXXToken * pToken)
 {
 	kindDefinition * pKindDefinitions = g_cxx.pKindDefinitions;
@@ -316,9 +326,8 @@ tagEntryInfo * cxxTagBegin(unsigned int uKind,CXXToken * pToken)
 			if (uKind == CXXTagKindMEMBER || uKind == CXXTagKindENUMERATOR
 				|| uKind == CXXTagKindPARAMETER || CXXTagCPPKindTEMPLATEPARAM)
 				g_oCXXTag.extensionFields.nth =
-					(short) countEntriesInScope(g_oCXXTag.extensionFields.scopeIndex,
-												true,
-												countSameKindEntry, &uKind);
+					(short) HT_PTR_TO_INT(hashTableGetItem(g_pScopeKindCounts,
+							CXX_SCOPE_KIND_KEY(g_oCXXTag.extensionFields.scopeIndex,uKind)));
 		}
 	}
 
@@ -693,8 +702,18 @@ int cxxTagCommit(int *piCorkQueueIndexFQ)
 
 	int iCorkQueueIndex = makeTagEntry(&g_oCXXTag);
 	if (iCorkQueueIndex != CORK_NIL)
+	{
 		registerEntry(iCorkQueueIndex);
 
+		int iScope = g_oCXXTag.extensionFields.scopeIndex;
+		if(iScope != CORK_NIL)
+		{
+			void * pKey = CXX_SCOPE_KIND_KEY(iScope,g_oCXXTag.kindIndex);
+			int iCount = HT_PTR_TO_INT(hashTableGetItem(g_pScopeKindCounts,pKey));
+			hashTableUpdateOrPutItem(g_pScopeKindCounts,pKey,HT_INT_TO_PTR(iCount + 1));
+		}
+	}
+
 	// Handle --extra=+q
 	if(!isXtagEnabled(XTAG_QUALIFIED_TAGS))
 		return iCorkQueueIndex;
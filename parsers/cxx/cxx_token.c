@@ -12,39 +12,60 @@
 #include "routines.h"
 #include "vstring.h"
 #include "read.h"
-#include "objpool.h"
 
 #include "cxx_token_chain.h"
 #include "cxx_debug.h"
 #include "cxx_keyword.h"
 #include "cxx_tag.h"
 
-#define CXX_TOKEN_POOL_MAXIMUM_SIZE 8192
+#include <stdio.h>
 
-static objPool * g_pTokenPool = NULL;
+// Tokens are allocated in slabs of this many tokens. A destroyed token goes
+// to a free list and is reused with its string buffer, so there is no
+// allocation at all once the peak number of live tokens has been reached.
+#define CXX_TOKEN_SLAB_SIZE 256
 
-void cxxTokenForceDestroy(CXXToken * t);
+// The slabs beyond this number are released between files: a huge file
+// should not keep its peak memory for the rest of the run.
+#define CXX_TOKEN_SLAB_MAXIMUM_KEPT (8192 / CXX_TOKEN_SLAB_SIZE)
 
-static CXXToken *createToken(void *createArg CTAGS_ATTR_UNUSED)
+typedef struct _CXXTokenSlab
 {
-	CXXToken *t = xMalloc(1, CXXToken);
-	// we almost always want a string, and since this token
-	// is being reused..well.. we always want it
-	t->pszWord = vStringNew();
-	t->iCorkIndex = CORK_NIL;
-	return t;
-}
+	struct _CXXTokenSlab * pNext; // the slab allocated before this one
+	CXXToken aTokens[CXX_TOKEN_SLAB_SIZE];
+} CXXTokenSlab;
 
-static void deleteToken(CXXToken *token)
+typedef struct _CXXTokenStats
 {
-	vStringDelete(token->pszWord);
-	eFree(token);
+	unsigned long uFiles;
+	unsigned long uHits; // tokens taken from the free list
+	unsigned long uMisses; // tokens taken from a slab for the first time
+	unsigned int uPeakTokens; // the maximum number of live tokens
+	unsigned int uPeakSlabs;
+	unsigned int uTrims; // the number of times slabs were released
+} CXXTokenStats;
+
+// The slab allocated last. Its tokens after g_iSlabUsed have never been used.
+static CXXTokenSlab * g_pSlabs = NULL;
+static unsigned int g_uSlabCount = 0;
+static unsigned int g_iSlabUsed = CXX_TOKEN_SLAB_SIZE;
+
+// The destroyed tokens, linked with pNext
+static CXXToken * g_pFreeTokens = NULL;
+static unsigned int g_uLiveTokens = 0;
+
+// One for each of C, C++ and CUDA
+static CXXTokenStats g_aStats[3];
+static CXXTokenStats * g_pStats = &g_aStats[0];
+
+static CXXTokenStats * getStats(unsigned int uLanguage)
+{
+	// CXXLanguageC, CXXLanguageCPP and CXXLanguageCUDA are 1, 2 and 4
+	return &g_aStats[(uLanguage <= 2) ? (uLanguage - 1) : 2];
 }
 
 static void clearToken(CXXToken *t)
 {
-	CXX_DEBUG_ASSERT(t->pszWord,"The string shouldn't have been destroyed");
-
 	// this won't actually release memory (but we're taking care
 	// to do not create very large strings)
 	vStringClear(t->pszWord);
@@ -58,44 +79,139 @@ static void clearToken(CXXToken *t)
 	t->iCorkIndex = CORK_NIL;
 }
 
+static void releaseSlabs(CXXTokenSlab * pSlab,unsigned int iUsed)
+{
+	while(pSlab)
+	{
+		CXXTokenSlab * pNext = pSlab->pNext;
+
+		for(unsigned int i = 0;i < iUsed;i++)
+			vStringFini(&(pSlab->aTokens[i].oWord));
+		eFree(pSlab);
+
+		pSlab = pNext;
+		// only the first slab may be partially used
+		iUsed = CXX_TOKEN_SLAB_SIZE;
+	}
+}
+
+// Releases the slabs allocated last, keeping CXX_TOKEN_SLAB_MAXIMUM_KEPT
+// slabs. All the tokens must be destroyed.
+static void trimSlabs(void)
+{
+	CXXTokenSlab * pSlab = g_pSlabs;
+	CXXTokenSlab * pLast;
+	unsigned int iUsed = g_iSlabUsed;
+
+	CXX_DEBUG_ASSERT(g_uLiveTokens == 0,"There should be no live tokens");
+
+	while(g_uSlabCount > CXX_TOKEN_SLAB_MAXIMUM_KEPT)
+	{
+		pLast = pSlab;
+		pSlab = pSlab->pNext;
+		pLast->pNext = NULL;
+		releaseSlabs(pLast,iUsed);
+		iUsed = CXX_TOKEN_SLAB_SIZE;
+		g_uSlabCount--;
+	}
+
+	g_pSlabs = pSlab;
+	g_iSlabUsed = iUsed;
+
+	// The free list pointed into the slabs released: make it again.
+	g_pFreeTokens = NULL;
+	for(;pSlab;pSlab = pSlab->pNext)
+	{
+		for(unsigned int i = 0;i < iUsed;i++)
+		{
+			pSlab->aTokens[i].pNext = g_pFreeTokens;
+			g_pFreeTokens = &(pSlab->aTokens[i]);
+		}
+		iUsed = CXX_TOKEN_SLAB_SIZE;
+	}
+
+	g_pStats->uTrims++;
+}
+
 void cxxTokenAPIInit(void)
 {
-	g_pTokenPool = objPoolNew(CXX_TOKEN_POOL_MAXIMUM_SIZE,
-		(objPoolCreateFunc)createToken, (objPoolDeleteFunc)deleteToken,
-		(objPoolClearFunc)clearToken,
-		NULL);
+	g_pSlabs = NULL;
+	g_uSlabCount = 0;
+	g_iSlabUsed = CXX_TOKEN_SLAB_SIZE;
+	g_pFreeTokens = NULL;
+	g_uLiveTokens = 0;
 }
 
-void cxxTokenAPINewFile(void)
+void cxxTokenAPINewFile(unsigned int uLanguage)
 {
-	/* Stub */
+	g_pStats = getStats(uLanguage);
+	g_pStats->uFiles++;
+
+	// Tokens may still be live on a rescan or for an unget token.
+	if((g_uSlabCount > CXX_TOKEN_SLAB_MAXIMUM_KEPT) && (g_uLiveTokens == 0))
+		trimSlabs();
 }
 
 void cxxTokenAPIDone(void)
 {
-	objPoolDelete (g_pTokenPool);
+	releaseSlabs(g_pSlabs,g_iSlabUsed);
+	cxxTokenAPIInit();
 }
 
-CXXToken * cxxTokenCreate(void)
+void cxxTokenAPIPrintStats(unsigned int uLanguage)
 {
-	return objPoolGet (g_pTokenPool);
+	const CXXTokenStats * s = getStats(uLanguage);
+
+	fprintf(stderr,"files: %lu\n",s->uFiles);
+	fprintf(stderr,"tokens reused: %lu\n",s->uHits);
+	fprintf(stderr,"tokens allocated: %lu\n",s->uMisses);
+	fprintf(stderr,"peak live tokens: %u\n",s->uPeakTokens);
+	fprintf(stderr,"peak token slabs: %u (%u tokens each)\n",
+			s->uPeakSlabs,CXX_TOKEN_SLAB_SIZE);
+	fprintf(stderr,"token slab trims: %u\n",s->uTrims);
 }
 
-void cxxTokenDestroy(CXXToken * t)
+CXXToken * cxxTokenCreate(void)
 {
-	if(!t)
-		return;
+	CXXToken * t;
 
-	if(t->pChain)
+	if(g_pFreeTokens)
 	{
-		cxxTokenChainDestroy(t->pChain);
-		t->pChain = NULL;
+		t = g_pFreeTokens;
+		g_pFreeTokens = t->pNext;
+		g_pStats->uHits++;
+	} else {
+		if(g_iSlabUsed == CXX_TOKEN_SLAB_SIZE)
+		{
+			CXXTokenSlab * pSlab = xMalloc(1,CXXTokenSlab);
+			pSlab->pNext = g_pSlabs;
+			g_pSlabs = pSlab;
+			g_iSlabUsed = 0;
+			g_uSlabCount++;
+		}
+
+		t = &(g_pSlabs->aTokens[g_iSlabUsed++]);
+		// we almost always want a string, and since this token
+		// is being reused..well.. we always want it
+		vStringInit(&(t->oWord));
+		t->pszWord = &(t->oWord);
+		g_pStats->uMisses++;
+	}
+
+	clearToken(t);
+
+	g_uLiveTokens++;
+	if(g_uLiveTokens > g_pStats->uPeakTokens)
+	{
+		g_pStats->uPeakTokens = g_uLiveTokens;
+		if(g_uSlabCount > g_pStats->uPeakSlabs)
+			g_pStats->uPeakSlabs = g_uSlabCount;
 	}
 
-	objPoolPut (g_pTokenPool, t);
+	return t;
 }
 
-void cxxTokenForceDestroy(CXXToken * t)
+void cxxTokenDestroy(CXXToken * t)
 {
 	if(!t)
 		return;
@@ -106,11 +222,12 @@ void cxxTokenForceDestroy(CXXToken * t)
 		t->pChain = NULL;
 	}
 
-	CXX_DEBUG_ASSERT(t->pszWord,"There should be a word here");
-
-	vStringDelete(t->pszWord);
+	CXX_DEBUG_ASSERT(t->pszWord == &(t->oWord),"The string shouldn't have been replaced");
+	CXX_DEBUG_ASSERT(g_uLiveTokens > 0,"Destroying more tokens than created");
 
-	eFree(t);
+	t->pNext = g_pFreeTokens;
+	g_pFreeTokens = t;
+	g_uLiveTokens--;
 }
 
 CXXToken * cxxTokenCopy(CXXToken * pToken)
@@ -70,7 +70,7 @@ typedef struct _CXXTokenChain CXXTokenChain;
 typedef struct _CXXToken
 {
 	enum CXXTokenType eType;
-	vString * pszWord;
+	vString * pszWord; // always points to oWord
 	CXXKeyword eKeyword;
 	CXXTokenChain * pChain; // this is NOT the parent chain!
 	unsigned int bFollowedBySpace: 1;
@@ -89,6 +89,9 @@ typedef struct _CXXToken
 	unsigned char uInternalScopeAccess;
 
 	int iCorkIndex;
+
+	// The storage of pszWord: short words are kept in the token itself.
+	vString oWord;
 } CXXToken;
 
 CXXToken * cxxTokenCreate(void);
@@ -119,8 +122,10 @@ CXXToken * cxxTokenCreateAnonymousIdentifier(unsigned int uTagKind);
 void cxxTokenAppendToString(vString * s,CXXToken * t);
 
 void cxxTokenAPIInit(void);
-void cxxTokenAPINewFile(void);
+// uLanguage is really CXXLanguage: the token statistics are kept per language.
+void cxxTokenAPINewFile(unsigned int uLanguage);
 void cxxTokenAPIDone(void);
+void cxxTokenAPIPrintStats(unsigned int uLanguage);
 
 void cxxTokenReduceBackward (CXXToken *pStart);
 
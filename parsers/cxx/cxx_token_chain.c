@@ -581,18 +581,18 @@ CXXToken * cxxTokenChainSkipToEndOfTemplateAngleBracket(CXXToken * t)
 			"This function must be called when pointing to a <"
 		);
 
+	// Bracket pairs are single tokens here, so only the < and > tokens
+	// are looked at and a single test is made for the others.
 	int iLevel = 1;
 	t = t->pNext;
 	while(t)
 	{
-		if(cxxTokenTypeIs(t,CXXTokenTypeSmallerThanSign))
+		if(t->eType & (CXXTokenTypeSmallerThanSign | CXXTokenTypeGreaterThanSign))
 		{
-			iLevel++;
-		} else if(cxxTokenTypeIs(t,CXXTokenTypeGreaterThanSign))
-		{
-			if(iLevel == 1)
+			if(t->eType == CXXTokenTypeSmallerThanSign)
+				iLevel++;
+			else if(!(--iLevel))
 				return t;
-			iLevel--;
 		}
 		t = t->pNext;
 	}
@@ -612,14 +612,12 @@ CXXToken * cxxTokenChainSkipBackToStartOfTemplateAngleBracket(CXXToken * t)
 	t = t->pPrev;
 	while(t)
 	{
-		if(cxxTokenTypeIs(t,CXXTokenTypeGreaterThanSign))
-		{
-			iLevel++;
-		} else if(cxxTokenTypeIs(t,CXXTokenTypeSmallerThanSign))
+		if(t->eType & (CXXTokenTypeSmallerThanSign | CXXTokenTypeGreaterThanSign))
 		{
-			if(iLevel == 1)
+			if(t->eType == CXXTokenTypeGreaterThanSign)
+				iLevel++;
+			else if(!(--iLevel))
 				return t;
-			iLevel--;
 		}
 		t = t->pPrev;
 	}
@@ -116,6 +116,11 @@ CXXToken * cxxTokenChainLastTokenNotOfType(
 // templates). Nested <> pairs are skipped properly.
 // Parenthesis chains are assumed to be condensed.
 // Note that the function stops at the ending > and not past it.
+//
+// There is no index of the matching brackets for these functions: (),
+// [] and {} pairs are condensed into single tokens when the chain is
+// built, so a pair is always skipped in one step. Only the tokens
+// between the angle brackets are walked.
 CXXToken * cxxTokenChainSkipToEndOfTemplateAngleBracket(
 		CXXToken * t
 	);
@@ -54,6 +54,14 @@ static const char *HunkDelim[2] = {
 	" @@",
 };
 
+/* The lines starting with none of them are skipped. */
+static const char *const HeaderPrefixes[] = {
+	"--- ",
+	"+++ ",
+	"@@ ",
+	NULL
+};
+
 /*
 *   FUNCTION DEFINITIONS
 */
@@ -141,7 +149,7 @@ static void findDiffTags (void)
 	diffKind kind;
 	int scope_index = CORK_NIL;
 
-	while ((line = readLineFromInputFile ()) != NULL)
+	while ((line = readLineFromInputFileWithPrefix (HeaderPrefixes)) != NULL)
 	{
 		const unsigned char* cp = line;
 
@@ -209,5 +217,6 @@ extern parserDefinition* DiffParser (void)
 	def->extensions = extensions;
 	def->parser     = findDiffTags;
 	def->useCork    = CORK_QUEUE;
+	def->reentrant  = true;
 	return def;
 }
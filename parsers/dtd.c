@@ -18,6 +18,7 @@
 #include "keyword.h"
 #include "parse.h"
 #include "read.h"
+#include "tokenscan.h"
 #include "xtag.h"
 
 
@@ -146,10 +147,28 @@ static struct tokenInfoClass dtdTokenInfoClass = {
 	.copy             = copyToken,
 };
 
-static langType Lang_dtd;
+static struct tokenScannerComment dtdComments [] = {
+	{ "--", "--" },
+};
+
+static struct tokenScannerString dtdStrings [] = {
+	{ "\"", "\"", .type = TOKEN_STRING },
+	{ "'",  "'",  .type = TOKEN_STRING },
+};
 
-#define isIdentifierChar(c) (isalnum (c) || c == '-' || c == '_' || c == '.' \
-							 || c == ':')
+static struct tokenScannerOperator dtdOperators [] = {
+	{ "<!", TOKEN_OPEN },
+};
+
+static struct tokenScanner dtdScanner = {
+	.spaces          = " \t\f\n",
+	.identifierStart = "A-Za-z0-9_.:",
+	.identifier      = "A-Za-z0-9_.:-",
+	.identifierType  = TOKEN_IDENTIFIER,
+	ATTACH_SCANNER_COMMENTS (dtdComments),
+	ATTACH_SCANNER_STRINGS (dtdStrings),
+	ATTACH_SCANNER_OPERATORS (dtdOperators),
+};
 
 static tokenInfo *newDtdToken (void)
 {
@@ -168,112 +187,7 @@ static void copyToken (tokenInfo *dest, tokenInfo *src, void *data CTAGS_ATTR_UN
 
 static void readToken (tokenInfo *const token, void *data CTAGS_ATTR_UNUSED)
 {
-	int c, c0;
-
-	token->type		= TOKEN_UNDEFINED;
-	token->keyword	= KEYWORD_NONE;
-	vStringClear (token->string);
-
- retry:
-	do {
-		c = getcFromInputFile ();
-	} while (c == ' ' || c == '\t' || c == '\f' || c == '\n');
-
-	token->lineNumber   = getInputLineNumber ();
-	token->filePosition = getInputFilePosition ();
-
-	switch (c)
-	{
-	case EOF:
-		token->type = TOKEN_EOF;
-		break;
-	case ';':
-	case '&':
-	case '%':
-	case '>':
-	case '#':
-	case '?':
-	case '[':
-	case ']':
-	case '|':
-	case ',':
-	case '(':
-	case ')':
-	case '+':
-		token->type = c;
-		break;
-	case '<':
-		c0 = getcFromInputFile();
-		if (c0 == '!')
-		{
-			token->type = TOKEN_OPEN;
-			break;
-		}
-		else
-		{
-			ungetcToInputFile (c0);
-			token->type = c;
-			break;
-		}
-	case '-':
-		c0 = getcFromInputFile();
-		if (c0 == '-')
-		{
-			int c1, c2;
-
-			while ( (c1 = getcFromInputFile()) != EOF )
-			{
-				if (c1 == '-')
-				{
-					c2 = getcFromInputFile();
-					if (c2 == '-' || c2 == EOF)
-						goto retry;
-				}
-			}
-		}
-		else
-		{
-			ungetcToInputFile (c0);
-			token->type = c;
-		}
-		break;
-	case '"':
-	case '\'':
-		token->type = TOKEN_STRING;
-		while ((c0 = getcFromInputFile ()))
-		{
-			if (c0 == EOF || c0 == c)
-				break;
-			else
-				tokenPutc(token, c0);
-		}
-		break;
-	default:
-		if (isIdentifierChar(c))
-		{
-			tokenPutc(token, c);
-			while ((c = getcFromInputFile ()))
-			{
-				if (isIdentifierChar(c))
-					tokenPutc(token, c);
-				else
-				{
-					ungetcToInputFile (c);
-					break;
-				}
-			}
-			token->keyword = lookupKeyword (vStringValue (token->string),
-											Lang_dtd);
-			if (token->keyword == KEYWORD_NONE)
-				token->type = TOKEN_IDENTIFIER;
-			else
-				token->type = TOKEN_KEYWORD;
-
-		}
-		else
-			token->type = c;
-		break;
-	}
+	tokenScan (&dtdScanner, token);
 }
 
 static int makeDtdTagMaybe (tagEntryInfo *const e, tokenInfo *const token,
@@ -593,11 +507,6 @@ static void findDtdTags (void)
 	flashTokenBacklog (&dtdTokenInfoClass);
 }
 
-static void initialize (const langType language)
-{
-	Lang_dtd = language;
-}
-
 extern parserDefinition* DtdParser (void)
 {
 	parserDefinition* def = parserNew ("DTD");
@@ -609,7 +518,6 @@ extern parserDefinition* DtdParser (void)
 		NULL
 	};
 
-	def->initialize = initialize;
 	def->parser     = findDtdTags;
 
 	def->kindTable      = DtdKinds;
@@ -59,5 +59,6 @@ extern parserDefinition* DTSParser (void)
 	def->tagRegexCount = ARRAY_SIZE (dtsTagRegexTable);
 	def->method     = METHOD_REGEX;
 	def->requestAutomaticFQTag = true;
+	def->reentrant = true;
 	return def;
 }
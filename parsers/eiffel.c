@@ -1116,5 +1116,6 @@ extern parserDefinition* EiffelParser (void)
 	def->initialize = initialize;
 	def->keywordTable = EiffelKeywordTable;
 	def->keywordCount = ARRAY_SIZE (EiffelKeywordTable);
+	def->reentrant = true;
 	return def;
 }
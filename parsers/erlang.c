@@ -185,5 +185,6 @@ extern parserDefinition *ErlangParser (void)
 	def->kindCount = ARRAY_SIZE (ErlangKinds);
 	def->extensions = extensions;
 	def->parser = findErlangTags;
+	def->reentrant = true;
 	return def;
 }
@@ -143,5 +143,6 @@ extern parserDefinition* FalconParser (void)
     def->kindCount  = ARRAY_SIZE (FalconKinds);
     def->extensions = extensions;
     def->parser     = findFalconTags;
+    def->reentrant  = true;
     return def;
 }
@@ -37,6 +37,9 @@
 #define isSecondaryKeyword(token,k)  (bool) ((token)->secondary == NULL ? \
 	false : (token)->secondary->keyword == (k))
 
+/* The lines looked at before parsing, for a line not in fixed source form */
+#define FREE_FORM_SCAN_LINES    1000
+
 /*
 *   DATA DECLARATIONS
 */
@@ -609,13 +612,7 @@ static void makeFortranTag (tokenInfo *const token, tagType tag)
 
 static int skipLine (void)
 {
-	int c;
-
-	do
-		c = getcFromInputFile ();
-	while (c != EOF  &&  c != '\n');
-
-	return c;
+	return skipToCharacterInInputFile ('\n');
 }
 
 static void makeLabelTag (vString *const label)
@@ -698,6 +695,100 @@ static lineType getLineType (void)
 	return type;
 }
 
+/*  Classifies the line at LINE, ending at END (without the newline), as
+ *  getLineType () does. NEWLINE tells whether a newline follows the line.
+ */
+static lineType getLineTypeInBuffer (const unsigned char *line,
+									 const unsigned char *end, bool newline)
+{
+	bool labeled = false;
+	int column;
+
+	for (column = 0; column < 6; column++)
+	{
+		int c = (line + column < end)? line [column]: (newline? '\n': EOF);
+
+		if (column == 0  &&  c != EOF  &&  strchr ("*Cc!#$Dd", c) != NULL)
+			return LTYPE_COMMENT;
+		else if (c == '\t')
+			return LTYPE_INITIAL;
+		else if (column == 5)
+		{
+			if (c == ' '  ||  c == '0')
+				return LTYPE_INITIAL;
+			return labeled? LTYPE_INVALID: LTYPE_CONTINUATION;
+		}
+		else if (c == ' ')
+			;
+		else if (c == EOF)
+			return LTYPE_EOF;
+		else if (c == '\n')
+			return LTYPE_SHORT;
+		else if (isdigit (c))
+			labeled = true;
+		else
+			return LTYPE_INVALID;
+	}
+	AssertNotReached ();
+	return LTYPE_INVALID;
+}
+
+/*  Returns false if the fixed source form pass would find LINE, a line of
+ *  the input file, is not in fixed source form: it has a margin invalid
+ *  in fixed source form, or it ends with '&' after the margin. FIRST
+ *  points a flag telling whether LINE is the first line.
+ */
+static bool isLineInFixedSourceForm (const vString *const line, void *first)
+{
+	const unsigned char *data = (const unsigned char *) vStringValue (line);
+	const unsigned char *last = data + vStringLength (line);
+	const bool newline = (last > data && last [-1] == '\n');
+	lineType type;
+
+	if (*(bool *) first)
+	{
+		*(bool *) first = false;
+		if (last - data >= 3
+			&& data [0] == 0xEF && data [1] == 0xBB && data [2] == 0xBF)
+			data += 3;
+	}
+	if (newline)
+		last--;
+
+	type = getLineTypeInBuffer (data, last, newline);
+	if (type == LTYPE_INVALID)
+		return false;
+
+	/* getFixedFormChar () checks '&' just before a newline after the
+	 * first character of the statement part. A line with '!' is not
+	 * looked at: the rest of the line is a comment unless '!' is in a
+	 * string. */
+	if ((type == LTYPE_INITIAL || type == LTYPE_CONTINUATION)
+		&& newline && last - data >= 8 && last [-1] == '&'
+		&& memchr (data, '\t', 6) == NULL
+		&& memchr (data + 6, '!', last - data - 6) == NULL)
+		return false;
+
+	return true;
+}
+
+/*  Returns true if the fixed source form pass would find the input is not
+ *  in fixed source form, looking at the first lines of the input file, so
+ *  the pass is not run for free source form input at all. Returns false
+ *  when no such line is found; the fixed source form pass decides then.
+ */
+static bool isInputInFreeSourceForm (void)
+{
+	vString *line = vStringNew ();
+	bool first = true;
+	bool r;
+
+	r = !scanInputFileLines (line, FREE_FORM_SCAN_LINES,
+							 isLineInFixedSourceForm, &first);
+	vStringDelete (line);
+	return r;
+}
+
 static int getFixedFormChar (bool parsingString, bool *freeSourceFormFound)
 {
 	bool newline = false;
@@ -2676,7 +2767,15 @@ static rescanReason findFortranTags (const unsigned int passCount)
 
 	currentPass = (fortranPass)passCount;
 	if (currentPass == INIT_PASS)
+	{
 		Ungetc = '\0';
+		if (isInputInFreeSourceForm ())
+		{
+			verbose ("%s: not fixed source form; parse as free source form\n",
+					 getInputFileName ());
+			currentPass = PASS_FREE_FORM;
+		}
+	}
 	if (inFreeSourceForm)
 		Free.newline = true;
 	if (inFixedSourceForm)
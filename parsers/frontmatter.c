@@ -71,5 +71,6 @@ extern parserDefinition* FrontMatterParser (void)
 
 	def->parser     = findFrontMatterTags;
 
+	def->reentrant = true;
 	return def;
 }
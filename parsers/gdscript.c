@@ -582,11 +582,7 @@ getNextChar:
 			do
 			{
 				if (c == '#')
-				{
-					do
-						c = getcFromInputFile ();
-					while (c != EOF && c != '\r' && c != '\n');
-				}
+					c = skipToCharactersInInputFile ("\r\n");
 				if (c == '\r')
 				{
 					int d = getcFromInputFile ();
@@ -1027,7 +1023,7 @@ static bool parseClassName (tokenInfo *const token)
 
 		if (klass)
 		{
-			eFree ((void *)klass->name);
+			freeTagEntryMemory (klass->name);
 			klass->name = name;
 			name = NULL;
 			unmarkTagExtraBit(klass, XTAG_ANONYMOUS);
@@ -1050,7 +1046,7 @@ static bool parseClassName (tokenInfo *const token)
 				if (klass)
 				{
 					if (klass->extensionFields.inheritance)
-						eFree ((void *)klass->extensionFields.inheritance);
+						freeTagEntryMemory (klass->extensionFields.inheritance);
 					klass->extensionFields.inheritance = vStringStrdup (token->string);
 				}
 				else
@@ -1088,7 +1084,7 @@ static bool parseExtends (tokenInfo *const token)
 				if (klass)
 				{
 					if (klass->extensionFields.inheritance)
-						eFree ((void *)klass->extensionFields.inheritance);
+						freeTagEntryMemory (klass->extensionFields.inheritance);
 					klass->extensionFields.inheritance = vStringStrdup(token->string);
 				}
 			}
@@ -99,6 +99,8 @@ typedef struct sCollector {
 
 static int Lang_go;
 static objPool *TokenPool = NULL;
+/* The type of the last token read, for the semicolon injection */
+static tokenType LastTokenType = TOKEN_NONE;
 
 typedef enum {
 	GOTAG_UNDEFINED = -1,
@@ -248,36 +250,80 @@ static void finalize (const langType language, bool initialized)
  *   Parsing functions
  */
 
+/* Consumes the characters of the current line which are in ACCEPT, or
+ * which are not in STOPS when ACCEPT is NULL, at once as getcFromInputFile ()
+ * would one by one. They are appended to STRING if it is not NULL. */
+static void readCharsInSpan (vString *const string,
+							 const char *const accept, const char *const stops)
+{
+	const unsigned char *line = peekCharsInInputFile ();
+	size_t n;
+
+	if (line == NULL)
+		return;
+
+	n = accept? strspn ((const char *) line, accept): strcspn ((const char *) line, stops);
+	if (n == 0)
+		return;
+	if (string)
+		vStringNCatSUnsafe (string, (const char *) line, n);
+	skipCharsInInputFile (n);
+}
+
+/* The string is not collected when STRING is NULL. */
 static void parseString (vString *const string, const int delimiter)
 {
+	const char stops [] = { (char) delimiter, (delimiter == '`')? '\0': '\\', '\0' };
 	bool end = false;
 	while (!end)
 	{
+		readCharsInSpan (string, NULL, stops);
+
 		int c = getcFromInputFile ();
 		if (c == EOF)
 			end = true;
 		else if (c == '\\' && delimiter != '`')
 		{
 			c = getcFromInputFile ();
-			if (c != '\'' && c != '\"')
-				vStringPut (string, '\\');
-			vStringPut (string, c);
+			if (string == NULL)
+				end = (c == EOF);
+			else
+			{
+				if (c != '\'' && c != '\"')
+					vStringPut (string, '\\');
+				vStringPut (string, c);
+			}
 		}
 		else if (c == delimiter)
 			end = true;
-		else
+		else if (string)
 			vStringPut (string, c);
 	}
 }
 
 static void parseIdentifier (vString *const string, const int firstChar)
 {
+	const unsigned char *line;
 	int c = firstChar;
-	do
+
+	vStringPut (string, c);
+	line = peekCharsInInputFile ();
+	if (line)
+	{
+		size_t n = 0;
+
+		while (isIdentChar (line [n]))
+			n++;
+		vStringNCatSUnsafe (string, (const char *) line, n);
+		skipCharsInInputFile (n);
+	}
+
+	c = getcFromInputFile ();
+	while (isIdentChar (c))
 	{
 		vStringPut (string, c);
 		c = getcFromInputFile ();
-	} while (isIdentChar (c));
+	}
 	ungetcToInputFile (c);		/* always unget, LF might add a semicolon */
 }
 
@@ -355,7 +401,6 @@ static void collectorTruncate (collector *collector, bool dropLast)
 static void readTokenFull (tokenInfo *const token, collector *collector)
 {
 	int c;
-	static tokenType lastTokenType = TOKEN_NONE;
 	bool firstWhitespace = true;
 	bool whitespace;
 
@@ -368,14 +413,12 @@ getNextChar:
 	do
 	{
 		c = getcFromInputFile ();
-		token->lineNumber = getInputLineNumber ();
-		token->filePosition = getInputFilePosition ();
-		if (c == '\n' && (lastTokenType == TOKEN_IDENTIFIER ||
-						  lastTokenType == TOKEN_STRING ||
-						  lastTokenType == TOKEN_OTHER ||
-						  lastTokenType == TOKEN_CLOSE_PAREN ||
-						  lastTokenType == TOKEN_CLOSE_CURLY ||
-						  lastTokenType == TOKEN_CLOSE_SQUARE))
+		if (c == '\n' && (LastTokenType == TOKEN_IDENTIFIER ||
+						  LastTokenType == TOKEN_STRING ||
+						  LastTokenType == TOKEN_OTHER ||
+						  LastTokenType == TOKEN_CLOSE_PAREN ||
+						  LastTokenType == TOKEN_CLOSE_CURLY ||
+						  LastTokenType == TOKEN_CLOSE_SQUARE))
 		{
 			c = ';';  // semicolon injection
 		}
@@ -385,8 +428,13 @@ getNextChar:
 			firstWhitespace = false;
 			collectorPut (collector, ' ');
 		}
+		/* The rest of the blanks change nothing. */
+		if (whitespace)
+			readCharsInSpan (NULL, " \t\r", NULL);
 	}
 	while (whitespace);
+	token->lineNumber = getInputLineNumber ();
+	token->filePosition = getInputFilePosition ();
 
 	switch (c)
 	{
@@ -405,6 +453,7 @@ getNextChar:
 				switch (d)
 				{
 					case '/':
+						readCharsInSpan (NULL, NULL, "\n");
 						skipToCharacterInInputFile ('\n');
 						/* Line comments start with the
 						 * character sequence // and
@@ -418,6 +467,7 @@ getNextChar:
 						{
 							do
 							{
+								readCharsInSpan (NULL, NULL, "*\n");
 								d = getcFromInputFile ();
 								if (d == '\n')
 								{
@@ -546,7 +596,7 @@ getNextChar:
 	if (collector && vStringLength (collector->str) < MAX_COLLECTOR_LENGTH)
 		collectorAppendToken (collector, token);
 
-	lastTokenType = token->type;
+	LastTokenType = token->type;
 }
 
 static void readToken (tokenInfo *const token)
@@ -592,6 +642,65 @@ static bool skipToMatchedNoRead (tokenInfo *const token, collector *collector)
 	return true;
 }
 
+/* Skips to the close curly bracket matching the open one in TOKEN as
+ * skipToMatchedNoRead () does without a collector, but scanning the
+ * characters instead of reading the tokens between them. */
+static void skipBlockInBulk (tokenInfo *const token)
+{
+	int nest_level = 1;
+	int c;
+
+	Assert (isType (token, TOKEN_OPEN_CURLY));
+
+	while (nest_level > 0)
+	{
+		readCharsInSpan (NULL, NULL, "{}\"'`/");
+		c = getcFromInputFile ();
+		switch (c)
+		{
+			case EOF:
+				readToken (token);
+				return;
+			case '{':
+				nest_level++;
+				break;
+			case '}':
+				nest_level--;
+				break;
+			case '"':
+			case '\'':
+			case '`':
+				parseString (NULL, c);
+				break;
+			case '/':
+				c = getcFromInputFile ();
+				if (c == '/')
+					skipToCharacterInInputFile ('\n');
+				else if (c == '*')
+				{
+					do
+					{
+						readCharsInSpan (NULL, NULL, "*");
+						c = getcFromInputFile ();
+						while (c == '*')
+							c = getcFromInputFile ();
+					} while (c != '/' && c != EOF);
+				}
+				else
+					ungetcToInputFile (c);
+				break;
+		}
+	}
+
+	token->type = TOKEN_CLOSE_CURLY;
+	token->keyword = KEYWORD_NONE;
+	token->c = '}';
+	vStringClear (token->string);
+	token->lineNumber = getInputLineNumber ();
+	token->filePosition = getInputFilePosition ();
+	LastTokenType = TOKEN_CLOSE_CURLY;
+}
+
 static void skipToMatched (tokenInfo *const token, collector *collector)
 {
 	if (skipToMatchedNoRead (token, collector))
@@ -860,7 +969,8 @@ static void parseFunctionOrMethod (tokenInfo *const token, const int scope)
 		// Skip over function body.
 		if (isType (token, TOKEN_OPEN_CURLY))
 		{
-			skipToMatched (token, NULL);
+			skipBlockInBulk (token);
+			readToken (token);
 			if (e)
 				e->extensionFields.endLine = getInputLineNumber ();
 		}
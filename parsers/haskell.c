@@ -51,10 +51,7 @@ typedef const unsigned char *custr;
 
 static void skip_rest_of_line(void)
 {
-	int c;
-	do {
-		c = getcFromInputFile();
-	} while (c != EOF && c != '\n');
+	skipToCharacterInInputFile ('\n');
 }
 
 static int get_line(char *buf)
@@ -338,6 +335,7 @@ extern parserDefinition* HaskellParser (void)
 	def->kindCount  = ARRAY_SIZE(HaskellKinds);
 	def->extensions = extensions;
 	def->parser     = findNormalHaskellTags;
+	def->reentrant  = true;
 	return def;
 }
 
@@ -349,5 +347,6 @@ extern parserDefinition* LiterateHaskellParser (void)
 	def->kindCount  = ARRAY_SIZE(HaskellKinds);
 	def->extensions = extensions;
 	def->parser     = findLiterateHaskellTags;
+	def->reentrant  = true;
 	return def;
 }
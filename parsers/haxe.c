@@ -212,5 +212,6 @@ extern parserDefinition* HaxeParser (void)
 	def->kindCount  = ARRAY_SIZE (HxKinds);
 	def->parser             = findHxTags;
 	/*def->initialize = initialize;*/
+	def->reentrant = true;
 	return def;
 }
@@ -205,6 +205,20 @@ static void readTokenText (tokenInfo *const token, bool collectText)
 
 	vStringClear (token->string);
 
+	if (!collectText)
+	{
+		/* Outside headings, the text is not used: search the next tag
+		 * in bulk. */
+		if (skipToCharacterInInputFile ('<') == EOF)
+			token->type = TOKEN_EOF;
+		else
+		{
+			ungetcToInputFile ('<');
+			token->type = TOKEN_TEXT;
+		}
+		return;
+	}
+
 getNextChar:
 
 	c = getcFromInputFile ();
@@ -221,15 +235,12 @@ getNextChar:
 			break;
 
 		default:
-			if (collectText)
+			if (isspace (c))
+				c = ' ';
+			if (c != ' ' || lastC != ' ')
 			{
-				if (isspace (c))
-					c = ' ';
-				if (c != ' ' || lastC != ' ')
-				{
-					vStringPut (token->string, c);
-					lastC = c;
-				}
+				vStringPut (token->string, c);
+				lastC = c;
 			}
 
 			goto getNextChar;
@@ -406,6 +417,21 @@ getNextChar:
 	TRACE_PRINT("token: %s (%s)", tokenTypes[token->type], vStringValue (token->string));
 }
 
+/* Skips the quoted value following the '=' of an attribute making no
+ * tag without storing it. */
+static void skipAttributeValue (void)
+{
+	int c = getcFromInputFile ();
+
+	while (isspace (c))
+		c = getcFromInputFile ();
+
+	if (c == '"' || c == '\'')
+		skipToCharacterInInputFile (c);
+	else
+		ungetcToInputFile (c);
+}
+
 static void appendText (vString *text, vString *appendedText)
 {
 	if (text != NULL && vStringLength (appendedText) > 0)
@@ -595,6 +621,8 @@ static void readTag (tokenInfo *token, vString *text, int depth)
 			readToken (token, true);
 			if (token->type == TOKEN_NAME)
 				attribute = lookupKeyword (vStringValue (token->string), Lang_html);
+			else if (token->type == TOKEN_EQUAL)
+				skipAttributeValue ();
 
 			if (attribute == KEYWORD_class)
 			{
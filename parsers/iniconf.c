@@ -234,5 +234,6 @@ extern parserDefinition* IniconfParser (void)
 	def->parser     = findIniconfTags;
 	def->useCork   = CORK_QUEUE;
 
+	def->reentrant = true;
 	return def;
 }
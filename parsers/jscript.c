@@ -1035,20 +1035,8 @@ getNextChar:
 		{
 			token->type = TOKEN_PERIOD;
 
-			int d = getcFromInputFile ();
-			if (d != '.')
-			{
-				ungetcToInputFile (d);
+			if (! matchStringInInputFile (".."))
 				break;
-			}
-
-			d = getcFromInputFile ();
-			if (d != '.')
-			{
-				ungetcToInputFile (d);
-				ungetcToInputFile ('.');
-				break;
-			}
 
 			token->type = TOKEN_DOTS;
 			if (repr)
@@ -1069,28 +1057,20 @@ getNextChar:
 
 		case '=':
 		{
-			int d = getcFromInputFile ();
-			if (d == '>')
+			if (matchStringInInputFile (">"))
 				token->type = TOKEN_ARROW;
 			else
-			{
-				ungetcToInputFile (d);
 				token->type = TOKEN_EQUAL_SIGN;
-			}
 			break;
 		}
 
 		case '+':
 		case '-':
 		{
-			int d = getcFromInputFile ();
-			if (d == c) /* ++ or -- */
+			if (matchStringInInputFile (c == '+'? "+": "-")) /* ++ or -- */
 				token->type = TOKEN_POSTFIX_OPERATOR;
 			else
-			{
-				ungetcToInputFile (d);
 				token->type = TOKEN_BINARY_OPERATOR;
-			}
 			break;
 		}
 
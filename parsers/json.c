@@ -21,6 +21,7 @@
 #include "entry.h"
 #include "keyword.h"
 #include "options.h"
+#include "param.h"
 #include "parse.h"
 #include "read.h"
 #include "routines.h"
@@ -145,6 +146,12 @@ static void makeJsonTag (tokenInfo *const token, const jsonKind kind)
 #define DEPTH_LIMIT 512
 static int depth_counter;
 
+/* Parameters: the members of containers nested deeper than maxDepth
+ * (0 for no limit), and the elements of arrays if skipArrays, are not
+ * tagged; the containers are skipped without making tokens. */
+static unsigned long maxDepth;
+static bool skipArrays;
+
 static void readTokenFull (tokenInfo *const token,
 						   bool includeStringRepr)
 {
@@ -287,6 +294,66 @@ static void skipToOneOf3 (tokenInfo *const token,
 	}
 }
 
+typedef struct {
+	unsigned long level;
+	bool inString;
+	bool escaped;
+} skipState;
+
+static void skipChar (skipState *const state, const int c)
+{
+	if (state->inString)
+	{
+		if (state->escaped)
+			state->escaped = false;
+		else if (c == '\\')
+			state->escaped = true;
+		else if (c == '"' || (c >= 0x00 && c <= 0x1F))
+			state->inString = false;
+	}
+	else if (c == '"')
+		state->inString = true;
+	else if (c == '[' || c == '{')
+		state->level++;
+	else if (c == ']' || c == '}')
+		state->level--;
+}
+
+/* Skips the contents of the container opened by the current token up to
+ * the bracket closing it, and reads the token after it. Only the strings
+ * and the brackets are looked at, in the lines in memory. */
+static void skipContainer (tokenInfo *const token)
+{
+	skipState state = { .level = 1, .inString = false, .escaped = false };
+
+	while (state.level > 0)
+	{
+		const unsigned char *rest = peekCharsInInputFile ();
+
+		if (rest == NULL || *rest == '\0')
+		{
+			/* The first character of a line is read as usual. */
+			int c = getcFromInputFile ();
+
+			if (c == EOF)
+				break;
+			skipChar (&state, c);
+		}
+		else
+		{
+			const unsigned char *p = rest;
+
+			while (*p != '\0' && state.level > 0)
+				skipChar (&state, *p++);
+			skipCharsInInputFile (p - rest);
+		}
+	}
+
+	/* The bracket opening the container has been counted by readToken(). */
+	depth_counter--;
+	readToken (token);
+}
+
 static jsonKind tokenToKind (const tokenType type)
 {
 	switch (type)
@@ -301,9 +368,21 @@ static jsonKind tokenToKind (const tokenType type)
 	}
 }
 
-static void parseValue (tokenInfo *const token)
+static bool isSkippedContainer (tokenInfo *const token, unsigned long depth)
 {
-	if (token->type == TOKEN_OPEN_CURLY)
+	if (token->type != TOKEN_OPEN_CURLY && token->type != TOKEN_OPEN_SQUARE)
+		return false;
+	if (maxDepth > 0 && depth >= maxDepth)
+		return true;
+	return (skipArrays && token->type == TOKEN_OPEN_SQUARE);
+}
+
+/* DEPTH is the number of the containers around the value of TOKEN. */
+static void parseValue (tokenInfo *const token, unsigned long depth)
+{
+	if (isSkippedContainer (token, depth))
+		skipContainer (token);
+	else if (token->type == TOKEN_OPEN_CURLY)
 	{
 		tokenInfo *name = newToken ();
 
@@ -325,7 +404,7 @@ static void parseValue (tokenInfo *const token)
 					tagKind = tokenToKind (token->type);
 
 					pushScope (token, name, tagKind);
-					parseValue (token);
+					parseValue (token, depth + 1);
 					popScope (token, name);
 				}
 
@@ -362,7 +441,7 @@ static void parseValue (tokenInfo *const token)
 
 			makeJsonTag (name, tagKind);
 			pushScope (token, name, tagKind);
-			parseValue (token);
+			parseValue (token, depth + 1);
 			popScope (token, name);
 
 			/* skip to the end of the construct */
@@ -390,7 +469,7 @@ static void findJsonTags (void)
 	do
 	{
 		readToken (token);
-		parseValue (token);
+		parseValue (token, 0);
 	}
 	while (token->type != TOKEN_EOF);
 
@@ -402,6 +481,34 @@ static void initialize (const langType language)
 	Lang_json = language;
 }
 
+static bool jsonSetMaxDepth (const langType language CTAGS_ATTR_UNUSED,
+							 const char *name, const char *arg)
+{
+	if (!strToULong (arg, 10, &maxDepth))
+		error (FATAL, "%s: Invalid depth: %s", name, arg);
+	return true;
+}
+
+static bool jsonSetSkipArrays (const langType language CTAGS_ATTR_UNUSED,
+							   const char *name, const char *arg)
+{
+	skipArrays = paramParserBool (arg, skipArrays, name, "parameter");
+	return true;
+}
+
+static paramDefinition JsonParams [] = {
+	{
+		.name = "maxDepth",
+		.desc = "tag the members of the containers nested up to this depth ([0] for no limit)",
+		.handleParam = jsonSetMaxDepth,
+	},
+	{
+		.name = "skipArrays",
+		.desc = "tag arrays but not their elements (true or [false])",
+		.handleParam = jsonSetSkipArrays,
+	},
+};
+
 /* Create parser definition structure */
 extern parserDefinition* JsonParser (void)
 {
@@ -415,6 +522,8 @@ extern parserDefinition* JsonParser (void)
 	def->keywordTable = JsonKeywordTable;
 	def->keywordCount = ARRAY_SIZE (JsonKeywordTable);
 	def->allowNullTag = true;
+	def->paramTable = JsonParams;
+	def->paramCount = ARRAY_SIZE (JsonParams);
 
 	return def;
 }
@@ -86,6 +86,8 @@ static kindDefinition EmacsLispKinds [] = {
 	{ true, 'T', "theme", "custom themes" },
 };
 
+static const char *const FormPrefixes [] = { "(", NULL };
+
 /*
 *   FUNCTION DEFINITIONS
 */
@@ -289,7 +291,8 @@ static void findLispTagsCommon (bool case_insensitive,
 	const unsigned char* p;
 
 
-	while ((p = readLineFromInputFile ()) != NULL)
+	/* Only a line starting a form can have a definition. */
+	while ((p = readLineFromInputFileWithPrefix (FormPrefixes)) != NULL)
 	{
 		if (*p == '(')
 		{
@@ -254,5 +254,6 @@ extern parserDefinition* LuaParser (void)
 	def->parser     = findLuaTags;
 	def->useCork    = CORK_QUEUE;
 	def->requestAutomaticFQTag = true;
+	def->reentrant = true;
 	return def;
 }
@@ -73,7 +73,14 @@ static void skipLine (void)
 {
 	int c;
 	do
+	{
+		/* Only a backslash or a newline can end the line or continue
+		 * it; the characters before them are skipped at once. */
+		const unsigned char *rest = peekCharsInInputFile ();
+		if (rest)
+			skipCharsInInputFile (strcspn ((const char *) rest, "\\\n"));
 		c = nextChar ();
+	}
 	while (c != EOF  &&  c != '\n');
 	if (c == '\n')
 		ungetcToInputFile (c);
@@ -155,6 +162,18 @@ static int newMacro (vString *const name, bool with_define_directive, bool appen
 	return r;
 }
 
+static bool isValueNotified (void)
+{
+	subparser *s;
+	foreachSubparser(s, false)
+	{
+		makeSubparser *m = (makeSubparser *)s;
+		if (m->valueNotify)
+			return true;
+	}
+	return false;
+}
+
 static void valueFound (vString *const name)
 {
 	subparser *s;
@@ -232,12 +251,14 @@ static void findMakeTags (void)
 	intArray *current_targets = intArrayNew ();
 	bool variable_possible = true;
 	bool appending = false;
+	bool value_notified;
 	int c;
 	subparser *sub;
 
 	sub = getSubparserRunningBaseparser();
 	if (sub)
 		chooseExclusiveSubparser (sub, NULL);
+	value_notified = isValueNotified ();
 
 	while ((c = nextChar ()) != EOF)
 	{
@@ -304,6 +325,11 @@ static void findMakeTags (void)
 			in_value = true;
 			endTargets (current_targets, getInputLineNumber () - 1);
 			appending = false;
+
+			/* Nothing is tagged in the value; if no subparser looks at
+			 * it, skip it up to the end of the (continued) line. */
+			if (!value_notified)
+				skipLine ();
 		}
 		else if (variable_possible && isIdentifier (c))
 		{
@@ -405,5 +431,6 @@ extern parserDefinition* MakefileParser (void)
 	def->aliases = aliases;
 	def->parser     = findMakeTags;
 	def->useCork = CORK_QUEUE;
+	def->reentrant = true;
 	return def;
 }
@@ -47,5 +47,6 @@ extern parserDefinition *MyrddinParser (void)
 	def->tagRegexTable = myrddinTagRegexTable;
 	def->tagRegexCount = ARRAY_SIZE (myrddinTagRegexTable);
 	def->method     = METHOD_NOT_CRAFTED|METHOD_REGEX;
+	def->reentrant  = true;
 	return def;
 }
@@ -390,5 +390,6 @@ extern parserDefinition* NsisParser (void)
 	def->fieldCount = ARRAY_SIZE (NsisFields);
 	def->parser     = findNsisTags;
 	def->useCork    = CORK_QUEUE;
+	def->reentrant  = true;
 	return def;
 }
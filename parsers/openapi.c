@@ -127,7 +127,10 @@ static void newTokenCallback (yamlSubparser *s, yaml_token_t *token)
 {
 	if (token->type == YAML_BLOCK_SEQUENCE_START_TOKEN
 		|| token->type == YAML_BLOCK_MAPPING_START_TOKEN)
+	{
 		ypathPushType (s, token);
+		ypathSkipBlockMaybe (s, ypathTables, ARRAY_SIZE (ypathTables));
+	}
 
 	openapiStateMachine ((struct sOpenAPISubparser *)s, token);
 
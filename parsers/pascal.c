@@ -338,5 +338,6 @@ extern parserDefinition* PascalParser (void)
 	def->kindTable      = PascalKinds;
 	def->kindCount  = ARRAY_SIZE (PascalKinds);
 	def->parser     = findPascalTags;
+	def->reentrant  = true;
 	return def;
 }
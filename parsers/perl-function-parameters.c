@@ -58,12 +58,15 @@ static void leavingPodNotify  (perlSubparser *perl);
  *   DATA DEFINITIONS
  */
 
+static const int notifyKinds [] = { KIND_PERL_MODULE, KIND_GHOST_INDEX };
+
 static struct FParamsSubparser fparamsSubparser = {
 	.perl = {
 		.subparser = {
 			.direction  = SUBPARSER_BI_DIRECTION,
 			.inputStart = inputStart,
 			.makeTagEntryNotify = makeTagEntryNotify,
+			.makeTagEntryNotifyKinds = notifyKinds,
 		},
 		.enteringPodNotify = enteringPodNotify,
 		.leavingPodNotify  = leavingPodNotify,
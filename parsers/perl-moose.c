@@ -146,6 +146,11 @@ static void findingQuotedWordNotify (perlSubparser *perl, int moduleIndex, const
  *   DATA DEFINITIONS
  */
 
+static const int notifyKinds [] = {
+	KIND_PERL_PACKAGE, KIND_PERL_SUBROUTINE, KIND_PERL_MODULE,
+	KIND_GHOST_INDEX,
+};
+
 static struct mooseSubparser mooseSubparser = {
 	.perl = {
 		.subparser = {
@@ -153,6 +158,7 @@ static struct mooseSubparser mooseSubparser = {
 			.inputStart = inputStart,
 			.inputEnd   = inputEnd,
 			.makeTagEntryNotify = makeTagEntryNotify,
+			.makeTagEntryNotifyKinds = notifyKinds,
 		},
 		.enteringPodNotify = enteringPodNotify,
 		.leavingPodNotify  = leavingPodNotify,
@@ -355,7 +361,7 @@ static bool findExtendsClass (const char *line,
 		&& vStringLength (str) > 0)
 	{
 		if (e->extensionFields.inheritance)
-			eFree ((void *)e->extensionFields.inheritance);
+			freeTagEntryMemory (e->extensionFields.inheritance);
 		e->extensionFields.inheritance = vStringStrdup (str);
 	}
 
@@ -384,7 +390,7 @@ static bool findExtendsClassContinuation (const char *line,
 		&& vStringLength (str) > 0)
 	{
 		if (e->extensionFields.inheritance)
-			eFree ((void *)e->extensionFields.inheritance);
+			freeTagEntryMemory (e->extensionFields.inheritance);
 		e->extensionFields.inheritance = vStringStrdup (str);
 	}
 
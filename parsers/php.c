@@ -27,6 +27,7 @@
 #include "objpool.h"
 #include "promise.h"
 #include "trace.h"
+#include "xtag.h"
 
 #define isIdentChar(c) (isalnum (c) || (c) == '_' || (c) >= 0x80)
 #define newToken() (objPoolGet (TokenPool))
@@ -284,6 +285,11 @@ static langType Lang_php;
 static langType Lang_zephir;
 
 static bool InPhp = false; /* whether we are between <? ?> */
+/* whether the inline HTML is given to the HTML parser */
+static bool HtmlPromised = false;
+/* whether the next segment is given to the HTML parser even without
+ * markup, for the pseudo tags it writes when it runs */
+static bool HtmlPtagsWanted = false;
 /* whether the next token may be a keyword, e.g. not after "::" or "->" */
 static bool MayBeKeyword = true;
 
@@ -863,11 +869,21 @@ static bool isOpenScriptLanguagePhp (int c)
 	return true;
 }
 
-static int findPhpStart (void)
+/* Sets *MARKUP if a '<' not starting PHP is found. */
+static int findPhpStart (bool *markup)
 {
 	int c;
 	do
 	{
+		/* Only a '<' can start PHP; the other characters of the line are
+		 * skipped at once. */
+		const unsigned char *rest = peekCharsInInputFile ();
+		if (rest)
+		{
+			const char *lt = strchr ((const char *) rest, '<');
+			skipCharsInInputFile (lt? (size_t) (lt - (const char *) rest): strlen ((const char *) rest));
+		}
+
 		if ((c = getcFromInputFile ()) == '<')
 		{
 			c = getcFromInputFile ();
@@ -893,6 +909,7 @@ static int findPhpStart (void)
 				if (isOpenScriptLanguagePhp ('<'))
 					break;
 			}
+			*markup = true;
 		}
 	}
 	while (c != EOF);
@@ -935,16 +952,22 @@ getNextChar:
 		unsigned long startSourceLineNumber = getSourceLineNumber ();
 		unsigned long startLineNumber = getInputLineNumber ();
 		int startLineOffset = getInputLineOffset ();
+		bool markup = false;
 
-		c = findPhpStart ();
+		c = findPhpStart (&markup);
 		if (c != EOF)
 			InPhp = true;
 
 		unsigned long endLineNumber = getInputLineNumber ();
 		int endLineOffset = getInputLineOffset ();
 
-		makePromise ("HTML", startLineNumber, startLineOffset,
-					 endLineNumber, endLineOffset, startSourceLineNumber);
+		/* The HTML parser finds nothing in a text without markup. */
+		if (HtmlPromised && (markup || HtmlPtagsWanted))
+		{
+			makePromise ("HTML", startLineNumber, startLineOffset,
+						 endLineNumber, endLineOffset, startSourceLineNumber);
+			HtmlPtagsWanted = false;
+		}
 	}
 	else
 		c = getcFromInputFile ();
@@ -1856,6 +1879,10 @@ static void findTags (bool startsInPhpMode)
 	tokenInfo *const token = newToken ();
 
 	InPhp = startsInPhpMode;
+	langType html = getNamedLanguage ("HTML", 0);
+	HtmlPromised = (isXtagEnabled (XTAG_GUEST)
+					&& html != LANG_IGNORE && isLanguageEnabled (html));
+	HtmlPtagsWanted = HtmlPromised && isXtagEnabled (XTAG_PSEUDO_TAGS);
 	MayBeKeyword = true;
 	CurrentStatement.access = ACCESS_UNDEFINED;
 	CurrentStatement.impl = IMPL_UNDEFINED;
@@ -771,5 +771,6 @@ extern parserDefinition* PowerShellParser (void)
 	def->parser     = findPowerShellTags;
 	def->keywordTable = PowerShellKeywordTable;
 	def->keywordCount = ARRAY_SIZE (PowerShellKeywordTable);
+	def->reentrant = true;
 	return def;
 }
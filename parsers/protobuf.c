@@ -300,6 +300,7 @@ static void parseEnumConstants (int scopeCorkIndex)
 	tagEntryInfo *e = getEntryInCorkQueue (scopeCorkIndex);
 	if (e)
 		e->extensionFields.endLine = getInputLineNumber ();
+	closeCorkScope (scopeCorkIndex);
 }
 
 static void parseOneofField (int scopeCorkIndex)
@@ -350,6 +351,7 @@ static void parseOneofFields (int scopeCorkIndex)
 	tagEntryInfo *e = getEntryInCorkQueue (scopeCorkIndex);
 	if (e)
 		e->extensionFields.endLine = getInputLineNumber ();
+	closeCorkScope (scopeCorkIndex);
 }
 
 #define gatherTypeinfo(VSTRING,CONDITION)			\
@@ -526,6 +528,7 @@ static void parseMap (int scopeCorkIndex)
 		e->extensionFields.typeRef [1] = vStringDeleteUnwrap (typeref);
 		typeref = NULL;
 	}
+	closeCorkScope (corkIndex);
 
  out:
 	vStringDelete (typeref);
@@ -589,6 +592,9 @@ static void findProtobufTags0 (bool oneshot, int originalScopeCorkIndex)
 		{
 			corkIndex = parsePackage ();
 			scopeCorkIndex = corkIndex;
+			/* The package is the scope of the tags after it. */
+			closeCorkEntry (corkIndex);
+			corkIndex = CORK_NIL;
 		}
 		else if (tokenIsKeyword (KEYWORD_MESSAGE))
 			corkIndex = parseStatement (PK_MESSAGE, scopeCorkIndex);
@@ -641,10 +647,18 @@ static void findProtobufTags0 (bool oneshot, int originalScopeCorkIndex)
 			tagEntryInfo *e = getEntryInCorkQueue (scopeCorkIndex);
 			if (e)
 			{
+				int closedCorkIndex = scopeCorkIndex;
+
 				scopeCorkIndex = e->extensionFields.scopeIndex;
 				e->extensionFields.endLine = getInputLineNumber ();
+				closeCorkScope (closedCorkIndex);
 			}
 		}
+		else
+		{
+			/* The statement doesn't make a scope. */
+			closeCorkScope (corkIndex);
+		}
 		nextToken ();
 
 		if (oneshot && scopeCorkIndex == originalScopeCorkIndex)
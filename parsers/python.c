@@ -347,7 +347,8 @@ static int makeSimplePythonTag (const tokenInfo *const token, pythonKind const k
 static int makeSimplePythonRefTag (const tokenInfo *const token,
                                    const vString *const altName,
                                    pythonKind const kind,
-                                   int roleIndex, xtagType xtag)
+                                   int roleIndex, xtagType xtag,
+                                   int scopeIndex)
 {
 	if (isXtagEnabled (XTAG_REFERENCE_TAGS) &&
 	    PythonKinds[kind].roles[roleIndex].enabled)
@@ -359,6 +360,7 @@ static int makeSimplePythonRefTag (const tokenInfo *const token,
 
 		e.lineNumber	= token->lineNumber;
 		e.filePosition	= token->filePosition;
+		e.extensionFields.scopeIndex = scopeIndex;
 
 		if (xtag != XTAG_UNKNOWN)
 			markTagExtraBit (&e, xtag);
@@ -460,6 +462,78 @@ static void readTripleString (vString *const string, const int delimiter)
 	}
 }
 
+/* Skips the characters of the current line up to one of STOPS, or to the
+ * end of the line, at once. */
+static void skipCharsUpTo (const char *const stops)
+{
+	const unsigned char *line = peekCharsInInputFile ();
+
+	if (line)
+		skipCharsInInputFile (strcspn ((const char *) line, stops));
+}
+
+/* Skip a single or double quoted string as readString () does, without
+ * collecting it. */
+static void skipString (const int delimiter)
+{
+	const char stops[] = { '\\', '\r', '\n', (char) delimiter, '\0' };
+	int c;
+
+	for (;;)
+	{
+		skipCharsUpTo (stops);
+		c = getcFromInputFile ();
+		if (c == EOF)
+			break;
+		else if (c == '\\')
+		{
+			if (getcFromInputFile () == EOF)
+				break;
+		}
+		else if (c == delimiter || c == '\n' || c == '\r')
+		{
+			if (c != delimiter)
+				ungetcToInputFile (c);
+			break;
+		}
+	}
+}
+
+/* Skip a single or double triple quoted string as readTripleString ()
+ * does, without collecting it. */
+static void skipTripleString (const int delimiter)
+{
+	const char stops[] = { '\\', (char) delimiter, '\0' };
+	int c;
+	int n = 0;
+
+	for (;;)
+	{
+		if (n == 0)
+			skipCharsUpTo (stops);
+		c = getcFromInputFile ();
+		if (c == EOF)
+			break;
+		else if (c == delimiter)
+		{
+			if (++n >= 3)
+				break;
+		}
+		else
+		{
+			n = 0;
+			if (c == '\\' && getcFromInputFile () == EOF)
+				break;
+		}
+	}
+}
+
+/* Skip a comment up to the end of the line, and return the newline or EOF. */
+static int skipComment (void)
+{
+	return skipToCharactersInInputFile ("\r\n");
+}
+
 static void readIdentifier (vString *const string, const int firstChar)
 {
 	int c = firstChar;
@@ -479,7 +553,10 @@ static void ungetToken (tokenInfo *const token)
 	copyToken (NextToken, token);
 }
 
-static void readTokenFull (tokenInfo *const token, bool inclWhitespaces)
+/* Reads a token. With KEEPSTRING false, the value of a string token is
+ * its quotes only; use it where the contents of a string are not used. */
+static void readTokenWithString (tokenInfo *const token, bool inclWhitespaces,
+								 bool keepString)
 {
 	int c;
 	int n;
@@ -533,10 +610,18 @@ getNextChar:
 			if (d != c)
 			{
 				ungetcToInputFile (d);
-				readString (token->string, c);
+				if (keepString)
+					readString (token->string, c);
+				else
+					skipString (c);
 			}
 			else if ((d = getcFromInputFile ()) == c)
-				readTripleString (token->string, c);
+			{
+				if (keepString)
+					readTripleString (token->string, c);
+				else
+					skipTripleString (c);
+			}
 			else /* empty string */
 				ungetcToInputFile (d);
 			vStringPut (token->string, c);
@@ -616,11 +701,7 @@ getNextChar:
 			do
 			{
 				if (c == '#')
-				{
-					do
-						c = getcFromInputFile ();
-					while (c != EOF && c != '\r' && c != '\n');
-				}
+					c = skipComment ();
 				if (c == '\r')
 				{
 					int d = getcFromInputFile ();
@@ -694,11 +775,22 @@ getNextChar:
 	}
 }
 
+static void readTokenFull (tokenInfo *const token, bool inclWhitespaces)
+{
+	readTokenWithString (token, inclWhitespaces, true);
+}
+
 static void readToken (tokenInfo *const token)
 {
 	readTokenFull (token, false);
 }
 
+/* Reads a token whose contents are not used if it is a string. */
+static void skipToken (tokenInfo *const token)
+{
+	readTokenWithString (token, false, false);
+}
+
 /*================================= parsing =================================*/
 
 
@@ -726,7 +818,7 @@ static bool skipOverPair (tokenInfo *const token, int tOpen, int tClose,
 			reprCat (repr, token);
 		do
 		{
-			readTokenFull (token, true);
+			readTokenWithString (token, true, repr != NULL);
 			if (repr && (reprOuterPair || token->type != tClose || depth > 1))
 			{
 				reprCat (repr, token);
@@ -1252,7 +1344,7 @@ static bool parseImport (tokenInfo *const token)
 			 * X = (kind:module, role:namespace) */
 			moduleIndex = makeSimplePythonRefTag (fromModule, NULL, K_MODULE,
 												  PYTHON_MODULE_NAMESPACE,
-												  XTAG_UNKNOWN);
+												  XTAG_UNKNOWN, CORK_NIL);
 		}
 
 		do
@@ -1288,13 +1380,9 @@ static bool parseImport (tokenInfo *const token)
 							int index;
 
 							/* Y */
-							index = makeSimplePythonRefTag (name, NULL, K_UNKNOWN,
-															PYTHON_UNKNOWN_INDIRECTLY_IMPORTED,
-															XTAG_UNKNOWN);
-							/* fill the scope field for Y */
-							tagEntryInfo *e = getEntryInCorkQueue (index);
-							if (e)
-								e->extensionFields.scopeIndex = moduleIndex;
+							makeSimplePythonRefTag (name, NULL, K_UNKNOWN,
+													PYTHON_UNKNOWN_INDIRECTLY_IMPORTED,
+													XTAG_UNKNOWN, moduleIndex);
 
 							/* Z */
 							index = makeSimplePythonTag (token, K_UNKNOWN);
@@ -1318,7 +1406,7 @@ static bool parseImport (tokenInfo *const token)
 							/* x */
 							makeSimplePythonRefTag (name, NULL, K_MODULE,
 							                        PYTHON_MODULE_INDIRECTLY_IMPORTED,
-							                        XTAG_UNKNOWN);
+							                        XTAG_UNKNOWN, CORK_NIL);
 							/* Y */
 							int index = makeSimplePythonTag (token, K_NAMESPACE);
 							/* fill the nameref filed for Y */
@@ -1346,13 +1434,9 @@ static bool parseImport (tokenInfo *const token)
 						   x = (kind:module,  role:namespace),
 						   Y = (kind:unknown, role:imported, scope:module:x) */
 						/* Y */
-						int index = makeSimplePythonRefTag (name, NULL, K_UNKNOWN,
-															PYTHON_UNKNOWN_IMPORTED,
-															XTAG_UNKNOWN);
-						/* fill the scope field for Y */
-						tagEntryInfo *e = getEntryInCorkQueue (index);
-						if (e)
-							e->extensionFields.scopeIndex = moduleIndex;
+						makeSimplePythonRefTag (name, NULL, K_UNKNOWN,
+												PYTHON_UNKNOWN_IMPORTED,
+												XTAG_UNKNOWN, moduleIndex);
 					}
 					else
 					{
@@ -1361,7 +1445,7 @@ static bool parseImport (tokenInfo *const token)
 						   X = (kind:module, role:imported) */
 						makeSimplePythonRefTag (name, NULL, K_MODULE,
 						                        PYTHON_MODULE_IMPORTED,
-						                        XTAG_UNKNOWN);
+						                        XTAG_UNKNOWN, CORK_NIL);
 					}
 				}
 
@@ -1493,7 +1577,7 @@ static bool parseVariable (tokenInfo *const token, const pythonKind kind)
 			const tokenInfo *const nameToken = nameTokens[i];
 			vString **type = &(nameTypes[i++]);
 
-			readToken (token);
+			skipToken (token);
 
 			if (! nameToken)
 				/* nothing */;
@@ -1597,7 +1681,7 @@ static bool parseVariable (tokenInfo *const token, const pythonKind kind)
 			       token->type != ';' &&
 			       token->type != TOKEN_INDENT)
 			{
-				readToken (token);
+				skipToken (token);
 			}
 		}
 		while (token->type == ',' && i < nameCount);
@@ -1721,7 +1805,7 @@ static void findPythonTags (void)
 		atStatementStart = (token->type == TOKEN_INDENT || token->type == ';');
 
 		if (readNext)
-			readToken (token);
+			skipToken (token);
 	}
 
 	nestingLevelsFree (PythonNestingLevels);
@@ -488,44 +488,50 @@ static void findRstTags (void)
 
 		int line_len = strlen((const char*) line);
 		int name_len_bytes = vStringLength(name);
-		/* FIXME: this isn't right, actually we need the real display width,
-		 * taking into account double-width characters and stuff like that.
-		 * But duh. */
-		int name_len = utf8_strlen(vStringValue(name), name_len_bytes);
-
-		/* if the name doesn't look like UTF-8, assume one-byte charset */
-		if (name_len < 0)
-			name_len = name_len_bytes;
+		/* A line of the same punctuation characters is an overline or
+		 * an underline. The width of the title is computed only for
+		 * such a line. */
+		bool punct_line = (ispunct(line[0]) && issame((const char*) line));
 
 		/* overline may come after an empty line (or begging of file). */
-		if (name_len_bytes == 0 && line_len > 0 &&
-			ispunct(line[0]) && issame((const char*) line))
+		if (name_len_bytes == 0 && line_len > 0 && punct_line)
 		{
 			overline_set(&overline, *line, line_len);
 			continue;
 		}
 
-		/* underlines must be the same length or more */
-		if (line_len >= name_len && name_len > 0 &&
-			ispunct(line[0]) && issame((const char*) line))
+		if (name_len_bytes > 0 && punct_line)
 		{
-			char c = line[0];
-			bool o = (overline.c == c && overline.len == line_len);
-			int kind = get_kind(c, o, section_tracker);
+			/* FIXME: this isn't right, actually we need the real display width,
+			 * taking into account double-width characters and stuff like that.
+			 * But duh. */
+			int name_len = utf8_strlen(vStringValue(name), name_len_bytes);
 
-			overline_clear(&overline);
+			/* if the name doesn't look like UTF-8, assume one-byte charset */
+			if (name_len < 0)
+				name_len = name_len_bytes;
 
-			if (kind >= 0)
+			/* underlines must be the same length or more */
+			if (line_len >= name_len)
 			{
-				makeSectionRstTag(name, kind, filepos, c, o);
-				vStringClear(name);
-				continue;
+				char c = line[0];
+				bool o = (overline.c == c && overline.len == line_len);
+				int kind = get_kind(c, o, section_tracker);
+
+				overline_clear(&overline);
+
+				if (kind >= 0)
+				{
+					makeSectionRstTag(name, kind, filepos, c, o);
+					vStringClear(name);
+					continue;
+				}
 			}
 		}
 
 		if (has_overline(&overline))
 		{
-			if (name_len > 0)
+			if (name_len_bytes > 0)
 			{
 				/*
 				 * Though we saw an overline and a section title text,
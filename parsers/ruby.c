@@ -100,33 +100,6 @@ static NestingLevels* nesting = NULL;
 
 static void enterUnnamedScope (void);
 
-/*
-* Returns a string describing the scope in 'nls'.
-* We record the current scope as a list of entered scopes.
-* Scopes corresponding to 'if' statements and the like are
-* represented by empty strings. Scopes corresponding to
-* modules and classes are represented by the name of the
-* module or class.
-*/
-static vString* nestingLevelsToScope (const NestingLevels* nls)
-{
-	int i;
-	unsigned int chunks_output = 0;
-	vString* result = vStringNew ();
-	for (i = 0; i < nls->n; ++i)
-	{
-	    NestingLevel *nl = nestingLevelsGetNthFromRoot (nls, i);
-	    tagEntryInfo *e = getEntryOfNestingLevel (nl);
-	    if (e && (*e->name != '\0') && (!e->placeholder))
-	    {
-	        if (chunks_output++ > 0)
-	            vStringPut (result, SCOPE_SEPARATOR);
-	        vStringCatS (result, e->name);
-	    }
-	}
-	return result;
-}
-
 /*
 * Attempts to advance 's' past 'literal'.
 * Returns true if it did, false (and leaves 's' where
@@ -301,7 +274,7 @@ static bool parseRubyOperator (vString* name, const unsigned char** cp)
 static int emitRubyTagFull (vString* name, rubyKind kind, bool pushLevel, bool clearName)
 {
 	tagEntryInfo tag;
-	vString* scope;
+	static vString* scope;
 	tagEntryInfo *parent;
 	rubyKind parent_kind = K_UNDEFINED;
 	NestingLevel *lvl;
@@ -320,7 +293,13 @@ static int emitRubyTagFull (vString* name, rubyKind kind, bool pushLevel, bool c
 		return CORK_NIL;
 	}
 
-	scope = nestingLevelsToScope (nesting);
+	/* We record the current scope as a list of entered scopes.
+	 * Scopes corresponding to 'if' statements and the like are
+	 * represented by empty strings. Scopes corresponding to
+	 * modules and classes are represented by the name of the
+	 * module or class. */
+	scope = vStringNewOrClearWithAutoRelease (scope);
+	vStringCat (scope, nestingLevelsGetScope (nesting, SCOPE_SEPARATOR));
 	lvl = nestingLevelsGetCurrent (nesting);
 	parent = getEntryOfNestingLevel (lvl);
 	if (parent)
@@ -371,8 +350,6 @@ static int emitRubyTagFull (vString* name, rubyKind kind, bool pushLevel, bool c
 	if (anonymous)
 		vStringDelete (name);
 
-	vStringDelete (scope);
-
 	return r;
 }
 
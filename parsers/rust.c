@@ -78,6 +78,10 @@ typedef struct {
 	int cur_c;
 	int next_c;
 
+	/* The rest of the current line, lent by read.c (see readChar ()) */
+	const unsigned char *chars;
+	const unsigned char *chars_start;
+
 	/* Tokens */
 	int cur_token;
 	vString* token_str;
@@ -137,11 +141,39 @@ static void writeCurTokenToStr (lexerState *lexer, vString *out_str)
 	}
 }
 
+/* Returns the characters taken from LEXER::chars to the input, and reads
+ * the next character with getcFromInputFile (). The rest of the new line
+ * is then taken with peekCharsInInputFile (). */
+static int refillChars (lexerState *lexer)
+{
+	int c;
+
+	if (lexer->chars)
+	{
+		skipCharsInInputFile(lexer->chars - lexer->chars_start);
+		lexer->chars = NULL;
+	}
+
+	c = getcFromInputFile();
+	if (c != EOF)
+		lexer->chars = lexer->chars_start = peekCharsInInputFile();
+	return c;
+}
+
+/* Reads a character as getcFromInputFile () does, but from the line in
+ * the memory as long as it lasts */
+static int readChar (lexerState *lexer)
+{
+	if (lexer->chars && *lexer->chars != '\0')
+		return *lexer->chars++;
+	return refillChars(lexer);
+}
+
 /* Reads a character from the file */
 static void advanceChar (lexerState *lexer)
 {
 	lexer->cur_c = lexer->next_c;
-	lexer->next_c = getcFromInputFile();
+	lexer->next_c = readChar(lexer);
 }
 
 /* Reads N characters from the file */
@@ -182,10 +214,80 @@ static bool isIdentifierContinue (int c)
 	return (isAscii(c) && (isalnum(c) || c == '_')) || !isAscii(c);
 }
 
+static bool isIdentifierChar (int c)
+{
+	return c != EOF && isIdentifierContinue(c);
+}
+
+static bool isNotNewline (int c)
+{
+	return c != EOF && c != '\n';
+}
+
+static bool isNotCommentDelimiter (int c)
+{
+	return c != EOF && c != '*' && c != '/';
+}
+
+static bool isPlainStringChar (int c)
+{
+	return c != EOF && c != '"' && c != '\\';
+}
+
+/* Advances while the current character is in the class ACCEPT, as
+ * repeated advanceChar () or, if STORE, advanceAndStoreChar () would.
+ * The characters of a run in the current line are taken at once. */
+static void advanceWhile (lexerState *lexer, bool (* accept) (int), bool store)
+{
+	while (accept(lexer->cur_c))
+	{
+		const unsigned char *run = lexer->chars;
+		const unsigned char *end = run;
+
+		if (run && accept(lexer->next_c))
+		{
+			while (*end != '\0' && accept(*end))
+				end++;
+		}
+		if (end == run)
+		{
+			if (store)
+				advanceAndStoreChar(lexer);
+			else
+				advanceChar(lexer);
+			continue;
+		}
+
+		/* cur_c, next_c, and the characters up to END are all in the run;
+		 * the last of them becomes cur_c. */
+		if (store)
+		{
+			size_t len = vStringLength(lexer->token_str);
+			size_t room = (len < MAX_STRING_LENGTH)? MAX_STRING_LENGTH - len: 0;
+			size_t n = end - run - 1;
+
+			if (room > 0)
+			{
+				vStringPut(lexer->token_str, (char) lexer->cur_c);
+				room--;
+			}
+			if (room > 0)
+			{
+				vStringPut(lexer->token_str, (char) lexer->next_c);
+				room--;
+			}
+			vStringNCatSUnsafe(lexer->token_str, (const char *) run,
+							   (n < room)? n: room);
+		}
+		lexer->cur_c = end[-1];
+		lexer->chars = end;
+		lexer->next_c = readChar(lexer);
+	}
+}
+
 static void scanWhitespace (lexerState *lexer)
 {
-	while (isWhitespace(lexer->cur_c))
-		advanceChar(lexer);
+	advanceWhile(lexer, isWhitespace, false);
 }
 
 /* Normal line comments start with two /'s and continue until the next \n
@@ -199,8 +301,7 @@ static void scanComments (lexerState *lexer)
 	if (lexer->next_c == '/')
 	{
 		advanceNChar(lexer, 2);
-		while (lexer->cur_c != EOF && lexer->cur_c != '\n')
-			advanceChar(lexer);
+		advanceWhile(lexer, isNotNewline, false);
 	}
 	/* #! */
 	else if (lexer->next_c == '!')
@@ -232,6 +333,7 @@ static void scanComments (lexerState *lexer)
 			else
 			{
 				advanceChar(lexer);
+				advanceWhile(lexer, isNotCommentDelimiter, false);
 			}
 		}
 	}
@@ -240,10 +342,8 @@ static void scanComments (lexerState *lexer)
 static void scanIdentifier (lexerState *lexer)
 {
 	vStringClear(lexer->token_str);
-	do
-	{
-		advanceAndStoreChar(lexer);
-	} while(lexer->cur_c != EOF && isIdentifierContinue(lexer->cur_c));
+	advanceAndStoreChar(lexer);
+	advanceWhile(lexer, isIdentifierChar, true);
 }
 
 /* Double-quoted strings, we only care about the \" escape. These
@@ -260,6 +360,7 @@ static void scanString (lexerState *lexer)
 		if (lexer->cur_c == '\\' && lexer->next_c == '"')
 			advanceAndStoreChar(lexer);
 		advanceAndStoreChar(lexer);
+		advanceWhile(lexer, isPlainStringChar, true);
 	}
 	advanceAndStoreChar(lexer);
 }
@@ -430,6 +531,11 @@ static void initLexer (lexerState *lexer)
 
 static void deInitLexer (lexerState *lexer)
 {
+	if (lexer->chars)
+	{
+		skipCharsInInputFile(lexer->chars - lexer->chars_start);
+		lexer->chars = NULL;
+	}
 	vStringDelete(lexer->token_str);
 	lexer->token_str = NULL;
 }
@@ -841,12 +947,52 @@ static void parseStructOrEnum (lexerState *lexer, vString *scope, int parent_kin
 	}
 }
 
+/* Skips the characters up to the CLOSE character matching the OPEN
+ * character of the current token, and reads the token after it. This is
+ * what the loop of skipMacro () does with the tokens, but the characters
+ * out of the strings, the character literals, and the comments are
+ * not made tokens. */
+static void skipBalancedInBulk (lexerState *lexer, int open, int close)
+{
+	int level = 1;
+
+	while (lexer->cur_c != EOF)
+	{
+		if (lexer->cur_c == '"')
+			scanString(lexer);
+		else if (lexer->cur_c == 'r' && (lexer->next_c == '#' || lexer->next_c == '"'))
+			scanRawString(lexer);
+		else if (lexer->cur_c == '\'')
+			scanCharacterOrLifetime(lexer);
+		else if (lexer->cur_c == '/' && (lexer->next_c == '/' || lexer->next_c == '*'))
+			scanComments(lexer);
+		else if (isWhitespace(lexer->cur_c))
+			scanWhitespace(lexer);
+		else if (isIdentifierStart(lexer->cur_c))
+		{
+			/* Not to take the r of an identifier for a raw string */
+			advanceChar(lexer);
+			advanceWhile(lexer, isIdentifierChar, false);
+		}
+		else
+		{
+			if (lexer->cur_c == open)
+				level++;
+			else if (lexer->cur_c == close)
+				level--;
+			advanceChar(lexer);
+			if (level == 0)
+				break;
+		}
+	}
+	advanceToken(lexer, true);
+}
+
 /* Skip the body of the macro. Can't use skipUntil here as
  * the body of the macro may have arbitrary code which confuses it (e.g.
  * bitshift operators/function return arrows) */
 static void skipMacro (lexerState *lexer)
 {
-	int level = 0;
 	int plus_token = 0;
 	int minus_token = 0;
 
@@ -869,17 +1015,7 @@ static void skipMacro (lexerState *lexer)
 			return;
 	}
 
-	while (lexer->cur_token != TOKEN_EOF)
-	{
-		if (lexer->cur_token == plus_token)
-			level++;
-		else if (lexer->cur_token == minus_token)
-			level--;
-		if (level == 0)
-			break;
-		advanceToken(lexer, true);
-	}
-	advanceToken(lexer, true);
+	skipBalancedInBulk(lexer, plus_token, minus_token);
 }
 
 /*
@@ -980,6 +1116,17 @@ static void parseBlock (lexerState *lexer, bool delim, int kind, vString *scope)
 			level--;
 			advanceToken(lexer, true);
 		}
+		else if (lexer->cur_token == '#')
+		{
+			/* Skip attributes. Format:
+			 * #[..] or #![..]
+			 * */
+			advanceToken(lexer, true);
+			if (lexer->cur_token == '!')
+				advanceToken(lexer, true);
+			if (lexer->cur_token == '[')
+				skipBalancedInBulk(lexer, '[', ']');
+		}
 		else if (lexer->cur_token == '\'')
 		{
 			/* Skip over the 'static lifetime, as it confuses the static parser above */
@@ -1017,5 +1164,6 @@ extern parserDefinition *RustParser (void)
 	def->extensions = extensions;
 	def->parser = findRustTags;
 
+	def->reentrant = true;
 	return def;
 }
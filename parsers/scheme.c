@@ -32,6 +32,8 @@ static kindDefinition SchemeKinds [] = {
 	{ true, 's', "set",      "sets" }
 };
 
+static const char *const FormPrefixes [] = { "(", NULL };
+
 /*
 *   FUNCTION DEFINITIONS
 */
@@ -57,7 +59,8 @@ static void findSchemeTags (void)
 	vString *name = vStringNew ();
 	const unsigned char *line;
 
-	while ((line = readLineFromInputFile ()) != NULL)
+	/* Only a line starting a form can have a definition. */
+	while ((line = readLineFromInputFileWithPrefix (FormPrefixes)) != NULL)
 	{
 		const unsigned char *cp = line;
 
@@ -122,5 +125,6 @@ extern parserDefinition* SchemeParser (void)
 	def->extensions = extensions;
 	def->aliases    = aliases;
 	def->parser     = findSchemeTags;
+	def->reentrant  = true;
 	return def;
 }
@@ -13,6 +13,7 @@
 */
 #include "general.h"  /* must always come first */
 
+#include <limits.h>
 #include <string.h>
 
 #include "debug.h"
@@ -119,6 +120,7 @@ static const struct dialectalKeyword KeywordTable [] = {
 /*
 * FUNCTION DECLARATIONS
 */
+static void collectSubparserInterests (bool interests[UCHAR_MAX + 1]);
 static subparser *notifyLineToSubparsers (const unsigned char *cp,
 										  int *n);
 static int extractNameToSubparser (subparser *sub, const unsigned char *cp,
@@ -456,6 +458,25 @@ static size_t handleZshKeyword (int keyword,
 	return vStringLength(token);
 }
 
+static bool isHereDocEnd (const unsigned char *line,
+						  const vString *const hereDocDelimiter,
+						  bool hereDocIndented)
+{
+	const char *delim = vStringValue (hereDocDelimiter);
+	size_t len = vStringLength (hereDocDelimiter);
+
+	if (hereDocIndented)
+	{
+		while (*line == '\t')
+			line++;
+	}
+	/* Most lines of a body differ from the delimiter in the first character. */
+	if (len > 0 && *line != (unsigned char) delim[0])
+		return false;
+	return (strncmp ((const char *) line, delim, len) == 0)
+		&& (line [len] == '\0' || isspace (line [len]));
+}
+
 typedef bool (* checkCharFunc) (int);
 static void findShTagsCommon (size_t (* keyword_handler) (int,
 														  vString *,
@@ -470,10 +491,13 @@ static void findShTagsCommon (size_t (* keyword_handler) (int,
 	vString *hereDocDelimiter = NULL;
 	bool hereDocIndented = false;
 	checkCharFunc check_char;
+	bool subparserInterests [UCHAR_MAX + 1];
 
 	struct hereDocParsingState hstate;
 	hdocStateInit (&hstate);
 
+	collectSubparserInterests (subparserInterests);
+
 	while ((line = readLineFromInputFile ()) != NULL)
 	{
 		const unsigned char* cp = line;
@@ -482,23 +506,22 @@ static void findShTagsCommon (size_t (* keyword_handler) (int,
 
 		if (hereDocDelimiter)
 		{
-			if (hereDocIndented)
+			/* Skip the body up to the delimiter without going through
+			 * the scanner below. */
+			while (!isHereDocEnd (line, hereDocDelimiter, hereDocIndented))
 			{
-				while (*cp == '\t')
-					cp++;
+				line = readLineFromInputFile ();
+				if (line == NULL)
+					goto out;
 			}
-			if ((strncmp ((const char *) cp, vStringValue (hereDocDelimiter), vStringLength (hereDocDelimiter)) == 0)
-				&& ((*(cp + vStringLength (hereDocDelimiter)) == '\0')
-					|| isspace (*(cp + vStringLength (hereDocDelimiter)) )))
-			{
-				hdocStateUpdateTag (&hstate, getInputLineNumber ());
-				hdocStateMakePromiseMaybe (&hstate);
 
-				if (!vStringIsEmpty(hereDocDelimiter))
-					makeSimpleRefTag(hereDocDelimiter, K_HEREDOCLABEL, R_HEREDOC_ENDMARKER);
-				vStringDelete (hereDocDelimiter);
-				hereDocDelimiter = NULL;
-			}
+			hdocStateUpdateTag (&hstate, getInputLineNumber ());
+			hdocStateMakePromiseMaybe (&hstate);
+
+			if (!vStringIsEmpty(hereDocDelimiter))
+				makeSimpleRefTag(hereDocDelimiter, K_HEREDOCLABEL, R_HEREDOC_ENDMARKER);
+			vStringDelete (hereDocDelimiter);
+			hereDocDelimiter = NULL;
 			continue;
 		}
 
@@ -591,7 +614,8 @@ static void findShTagsCommon (size_t (* keyword_handler) (int,
 				++cp;
 				check_char = isFileChar;
 			}
-			else if ((sub = notifyLineToSubparsers (cp, &sub_n)))
+			else if (subparserInterests [*cp]
+					 && (sub = notifyLineToSubparsers (cp, &sub_n)))
 			{
 				found_kind = K_SUBPARSER;
 				cp += sub_n;
@@ -698,6 +722,7 @@ static void findShTagsCommon (size_t (* keyword_handler) (int,
 			vStringClear (name);
 		}
 	}
+ out:
 	hdocStateFini (&hstate);
 	vStringDelete (name);
 	if (hereDocDelimiter)
@@ -714,6 +739,30 @@ static void findZshTags (void)
 	findShTagsCommon (handleZshKeyword, makeZshTag);
 }
 
+/* Fills INTERESTS with the first characters of the words for which
+ * notifyLineToSubparsers () can find something. */
+static void collectSubparserInterests (bool interests[UCHAR_MAX + 1])
+{
+	subparser *sub;
+
+	memset (interests, 0, sizeof (bool) * (UCHAR_MAX + 1));
+	foreachSubparser (sub, false)
+	{
+		shSubparser *shsub = (shSubparser *)sub;
+
+		if (!shsub->lineNotify)
+			continue;
+		if (!shsub->lineStartChars)
+		{
+			memset (interests, 1, sizeof (bool) * (UCHAR_MAX + 1));
+			break;
+		}
+		for (const char *c = shsub->lineStartChars; *c; c++)
+			interests [(unsigned char) *c] = true;
+	}
+	interests ['\0'] = false;
+}
+
 static subparser *notifyLineToSubparsers (const unsigned char *cp,
 										  int *n)
 {
@@ -724,7 +773,9 @@ static subparser *notifyLineToSubparsers (const unsigned char *cp,
 	{
 		shSubparser *shsub = (shSubparser *)sub;
 
-		if(shsub->lineNotify)
+		if (shsub->lineNotify
+			&& (!shsub->lineStartChars
+				|| (*cp != '\0' && strchr (shsub->lineStartChars, *cp))))
 		{
 			enterSubparser(sub);
 			r = shsub->lineNotify (shsub, cp);
@@ -793,6 +844,7 @@ extern parserDefinition* ShParser (void)
 	def->parser     = findShTags;
 	def->initialize = initializeSh;
 	def->useCork    = CORK_QUEUE;
+	def->reentrant  = true;
 	return def;
 }
 
@@ -812,5 +864,6 @@ extern parserDefinition* ZshParser (void)
 	def->parser     = findZshTags;
 	def->initialize = initializeSh;
 	def->useCork    = CORK_QUEUE;
+	def->reentrant  = true;
 	return def;
 }
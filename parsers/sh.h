@@ -21,6 +21,12 @@ typedef struct sShSubparser shSubparser;
 struct sShSubparser {
 	subparser subparser;
 
+	/* The characters a word must start with for lineNotify to find
+	 * something interesting in it. lineNotify is not called for the
+	 * other words. NULL means lineNotify is called for all the words.
+	 */
+	const char *lineStartChars;
+
 	/* Scan the line pointed by CP and return the number of
 	 * consumed bytes if something interesting is found.
 	 * Return 0 if no interest.
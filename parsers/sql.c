@@ -3037,6 +3037,115 @@ static void parseDatabase (tokenInfo *const token, enum eKeywordId keyword)
 	findCmdTerm (token, true);
 }
 
+static bool isStatementOf (tokenInfo *const token, const char *const name)
+{
+	return (isType (token, TOKEN_IDENTIFIER)
+			&& strcasecmp (vStringValue (token->string), name) == 0);
+}
+
+/* Skip an INSERT statement to its terminator. A database dump is mostly
+ * made of the values of INSERT statements; they are scanned in bulk
+ * instead of being read as tokens. The strings, the comments, and the
+ * terminators are recognized as readToken () does. */
+static void skipInsert (tokenInfo *const token)
+{
+	static const char stops[] = "'\"-#/;~\\$gG";
+	int c, d;
+
+	for (;;)
+	{
+		c = skipToCharactersInInputFile (stops);
+		switch (c)
+		{
+			case '\'':
+			case '"':
+				skipToCharacterInInputFile (c);
+				break;
+			case '#':
+				skipToCharacterInInputFile ('\n');
+				break;
+			case '-':
+				d = getcFromInputFile ();
+				if (d == '-')
+					skipToCharacterInInputFile ('\n');
+				else
+					ungetcToInputFile (d);
+				break;
+			case '/':
+				d = getcFromInputFile ();
+				if (d == '*')
+					skipToCharacterInInputFile2 ('*', '/');
+				else if (d == '/')
+					skipToCharacterInInputFile ('\n');
+				else
+				{
+					/* A command terminator */
+					ungetcToInputFile (d);
+					ungetcToInputFile (c);
+					readToken (token);
+					return;
+				}
+				break;
+			case '\\':
+				d = getcFromInputFile ();
+				if (d != '\\'  && d != '"'  && d != '\''  &&  !isspace (d))
+					ungetcToInputFile (d);
+				break;
+			case 'g':
+			case 'G':
+				/* Not the start of "go" */
+				if (isIdentChar (getNthPrevCFromInputFile (1, ' ')))
+					break;
+				/* FALL THROUGH */
+			case '$':
+			case ';':
+			case '~':
+				ungetcToInputFile (c);
+				readToken (token);
+				if (isCmdTerm (token))
+					return;
+				break;
+			case EOF:
+				readToken (token);
+				return;
+			default:
+				break;
+		}
+	}
+}
+
+/* COPY ... FROM STDIN; is followed by the data lines up to a line
+ * of "\.". */
+static void parseCopy (tokenInfo *const token)
+{
+	bool fromStdin = false;
+	int c;
+
+	do
+	{
+		readToken (token);
+		if (isStatementOf (token, "stdin"))
+			fromStdin = true;
+	} while (! isCmdTerm (token) && ! isType (token, TOKEN_EOF));
+
+	if (! fromStdin || ! isType (token, TOKEN_SEMICOLON)
+		|| skipToCharacterInInputFile ('\n') == EOF)
+		return;
+
+	for (;;)
+	{
+		c = getcFromInputFile ();
+		if (c == '\\' && (c = getcFromInputFile ()) == '.')
+		{
+			c = getcFromInputFile ();
+			if (c == '\n' || c == '\r' || c == EOF)
+				break;
+		}
+		if (c == EOF || (c != '\n' && skipToCharacterInInputFile ('\n') == EOF))
+			break;
+	}
+}
+
 static void parseKeywords (tokenInfo *const token)
 {
 		switch (token->keyword)
@@ -3095,6 +3204,10 @@ static tokenType parseSqlFile (tokenInfo *const token)
 
 		if (isType (token, TOKEN_BLOCK_LABEL_BEGIN))
 			parseLabel (token);
+		else if (isStatementOf (token, "insert"))
+			skipInsert (token);
+		else if (isStatementOf (token, "copy"))
+			parseCopy (token);
 		else
 			parseKeywords (token);
 	} while (! isKeyword (token, KEYWORD_end) &&
@@ -253,11 +253,7 @@ static void readToken0 (tokenInfo *const token, struct sTclParserState *pstate)
 		if (!escaped)
 		{
 			if (bol)
-			{
-				do
-					c = getcFromInputFile ();
-				while (c != EOF && c != '\r' && c != '\n');
-			}
+				c = skipToCharactersInInputFile ("\r\n");
 			goto getNextChar;
 		}
 	case '"':
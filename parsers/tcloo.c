@@ -63,7 +63,7 @@ static void parseSuperclass (tokenInfo *token, int this_class)
 		{
 			if (e->extensionFields.inheritance)
 			{   /* superclass is used twice in a class. */
-				eFree ((void *)e->extensionFields.inheritance);
+				freeTagEntryMemory (e->extensionFields.inheritance);
 			}
 			e->extensionFields.inheritance = eStrdup(tokenString(token));
 		}
@@ -344,22 +344,13 @@ static int getNonWhiteSpaceChar (void)
 			if (c2=='/')
 			{
 				/* Line comment */
-				while (((c = getcFromInputFile()) != EOF) && (c != '\n'));
+				skipToCharacterInInputFile ('\n');
 				continue;
 			}
 			else if (c2=='*')
 			{
 				/* Block comment */
-				while ((c = getcFromInputFile()) != EOF)
-				{
-					if (c=='*')
-					{
-						c2 = getcFromInputFile();
-						if (c2 == '/')
-							break;
-						ungetcToInputFile(c2);
-					}
-				}
+				skipToCharacterInInputFile2 ('*', '/');
 				continue;
 			}
 			else
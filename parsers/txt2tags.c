@@ -189,6 +189,7 @@ extern parserDefinition* Txt2tagsParser (void)
 	def->extensions = extensions;
 	def->parser = findTxt2tagsTags;
 	def->useCork = CORK_QUEUE;
+	def->reentrant = true;
 	return def;
 }
 
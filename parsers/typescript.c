@@ -387,7 +387,8 @@ CTAGS_INLINE void parseOneChar(const int c, tokenInfo *const token, const char e
 
 CTAGS_INLINE void parseChar(const int c, tokenInfo *const token, void *state, parserResult *const result, const char *chars, const tokenType *types)
 {
-	const char *pos = strchr (chars, c);
+	/* strchr () finds the terminator of CHARS for '\0'. */
+	const char *pos = (c == EOF || c == '\0')? NULL: strchr (chars, c);
 
 	if (pos)
 	{
@@ -609,13 +610,22 @@ CTAGS_INLINE void parseBlock(const int c, tokenInfo *const token, tokenType cons
 		return;
 	}
 
+	// Each of the parsers below fails unless the next char is the first
+	// one of a comment or a string; most of the chars in a block are not.
+	int next = uwiPeekC ();
+
 	//skip comments:
-	tryParser ((Parser) parseComment, token, false);
+	if (next == '/' && tryParser ((Parser) parseComment, token, false))
+		next = uwiPeekC ();
 	//skip strings:
-	tryParser ((Parser) parseStringRegex, token, false);
-	tryParser ((Parser) parseStringSQuote, token, false);
-	tryParser ((Parser) parseStringDQuote, token, false);
-	tryParser ((Parser) parseStringTemplate, token, false);
+	if (next == '/' && tryParser ((Parser) parseStringRegex, token, false))
+		next = uwiPeekC ();
+	if (next == '\'' && tryParser ((Parser) parseStringSQuote, token, false))
+		next = uwiPeekC ();
+	if (next == '"' && tryParser ((Parser) parseStringDQuote, token, false))
+		next = uwiPeekC ();
+	if (next == '`')
+		tryParser ((Parser) parseStringTemplate, token, false);
 
 	result->status = PARSER_NEEDS_MORE_INPUT;
 }
@@ -1137,19 +1137,28 @@ static void skipToMatch (const char *const pair)
 		if (c == begin)
 		{
 			++matchLevel;
-			if (braceFormatting  &&  cppGetDirectiveNestLevel () != initialLevel)
+			if (braceMatching  &&  cppGetDirectiveNestLevel () != initialLevel)
 			{
-				skipToFormattedBraceMatch ();
-				break;
+				if (braceFormatting)
+				{
+					skipToFormattedBraceMatch ();
+					break;
+				}
+				/* The next pass reads from here differently. */
+				cppDisableRescanCheckpoints ();
 			}
 		}
 		else if (c == end)
 		{
 			--matchLevel;
-			if (braceFormatting  &&  cppGetDirectiveNestLevel () != initialLevel)
+			if (braceMatching  &&  cppGetDirectiveNestLevel () != initialLevel)
 			{
-				skipToFormattedBraceMatch ();
-				break;
+				if (braceFormatting)
+				{
+					skipToFormattedBraceMatch ();
+					break;
+				}
+				cppDisableRescanCheckpoints ();
 			}
 		}
 	}
@@ -2025,6 +2034,9 @@ static void checkStatementEnd (statementInfo *const st, int corkIndex)
 		DebugStatement ( if (debug (DEBUG_PARSE)) printf ("<ES>"); )
 		reinitStatement (st, false);
 		cppEndStatement ();
+		/* The state at the top level is the one at the start of the file. */
+		if (st->parent == NULL)
+			cppArmRescanCheckpoint (AnonymousID);
 	}
 	else
 	{
@@ -2235,7 +2247,9 @@ static rescanReason findCTags (const unsigned int passCount)
 
 	Assert (passCount < 3);
 
-	AnonymousID = 0;
+	/* The pass may start at the checkpoint of the failed pass. */
+	if (! getRescanCheckpoint (&AnonymousID))
+		AnonymousID = 0;
 
 	cppInit ((bool) (passCount > 1), false, false,
 		 true,
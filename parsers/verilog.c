@@ -727,13 +727,30 @@ static int skipWhite (int c)
 	return c;
 }
 
+/* Skip the characters of the current line up to one of STOPS in bulk.
+ * Nothing is skipped when a character is pushed back with vUngetc (). */
+static void skipCharsUpTo (const char *const stops)
+{
+	const unsigned char *line;
+
+	if (Ungetc != '\0')
+		return;
+
+	line = peekCharsInInputFile ();
+	if (line)
+		skipCharsInInputFile (strcspn ((const char *) line, stops));
+}
+
 static int skipPastMatch (const char *const pair)
 {
 	const int begin = pair [0], end = pair [1];
+	const char stops [] = { (char) begin, (char) end, '/', '"', '\0' };
 	int matchLevel = 1;
 	int c;
 	do
 	{
+		/* A port connection list of an instance in a netlist is long. */
+		skipCharsUpTo (stops);
 		c = _vGetc (true);
 		if (c == begin)
 			++matchLevel;
@@ -754,7 +771,10 @@ static int skipDimension (int c)
 static int skipToSemiColon (int c)
 {
 	while (c != ';' && c != EOF)
+	{
+		skipCharsUpTo (";/");
 		c = vGetc ();
+	}
 	return c;	// ';' or EOF
 }
 
@@ -783,7 +803,10 @@ static int skipExpression (int c)
 		else if (c == '"')
 			c = skipString (c);
 		else
+		{
+			skipCharsUpTo (",;)}]({[\"/");
 			c = skipWhite (vGetc ());
+		}
 	}
 	return c;
 }
@@ -804,6 +827,9 @@ static int skipToNewLine (int c)
 
 static int skipMacro (int c, tokenInfo *token)
 {
+	if (c != '`')
+		return c;
+
 	tokenInfo *localToken = newToken ();	// don't update token outside
 	while (c == '`')	// to support back-to-back compiler directives
 	{
@@ -994,6 +1020,11 @@ static void createTagFull (tokenInfo *const token, verilogKind kind, int role, t
 		return;
 	}
 
+	/* makeTagEntry () drops a reference tag if they are disabled; a
+	 * netlist makes one for each instance. */
+	if (role != ROLE_DEFINITION_INDEX && ! isXtagEnabled (XTAG_REFERENCE_TAGS))
+		return;
+
 	/* Create tag */
 	if (role == ROLE_DEFINITION_INDEX)
 		initTagEntry (&tag, vStringValue (token->name), kind);
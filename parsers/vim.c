@@ -790,5 +790,6 @@ extern parserDefinition *VimParser (void)
 	def->patterns   = patterns;
 	def->parser     = findVimTags;
 	def->useCork    = CORK_QUEUE;
+	def->reentrant  = true;
 	return def;
 }
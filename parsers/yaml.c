@@ -18,6 +18,7 @@
 #include "htable.h"
 #include "options.h"
 #include "parse.h"
+#include "ptrarray.h"
 #include "read.h"
 #include "subparser.h"
 #include "trace.h"
@@ -123,39 +124,81 @@ static void handlYamlToken (yaml_token_t *token)
 	}
 }
 
+/* The number of the blocks open at the token notified */
+static unsigned int YamlBlockDepth;
+
+extern void yamlSkipBlock (yamlSubparser *yaml)
+{
+	Assert (YamlBlockDepth > 0);
+	yaml->skipDepth = YamlBlockDepth;
+}
+
+static bool isYamlTokenSkipped (yamlSubparser *yaml, yaml_token_t *token)
+{
+	if (yaml->skipDepth == 0)
+		return false;
+
+	if (token->type == YAML_STREAM_END_TOKEN
+		|| (token->type == YAML_BLOCK_END_TOKEN
+			&& YamlBlockDepth == yaml->skipDepth))
+	{
+		yaml->skipDepth = 0;
+		return false;
+	}
+	return true;
+}
+
 static void findYamlTags (void)
 {
 	subparser *sub;
 	yaml_parser_t yaml;
 	yaml_token_t token;
 	bool done;
+	ptrArray *subparsers;
 
 	yamlInit (&yaml);
 
 	findRegexTags ();
 
+	/* The subparsers are the same while scanning the input; they are
+	 * listed once here instead of for each token. */
+	subparsers = ptrArrayNew (NULL);
 	foreachSubparser(sub, false)
 	{
 		enterSubparser (sub);
 		((yamlSubparser*)sub)->ypathTypeStack = NULL;
+		((yamlSubparser*)sub)->skipDepth = 0;
 		leaveSubparser ();
+		ptrArrayAdd (subparsers, sub);
 	}
 
 	sub = getSubparserRunningBaseparser();
 	if (sub)
 		chooseExclusiveSubparser (sub, NULL);
 
+	YamlBlockDepth = 0;
 	done = false;
 	while (!done)
 	{
 		if (!yaml_parser_scan (&yaml, &token))
 			break;
 
+		if (token.type == YAML_BLOCK_SEQUENCE_START_TOKEN
+			|| token.type == YAML_BLOCK_MAPPING_START_TOKEN)
+			YamlBlockDepth++;
+
 		handlYamlToken (&token);
-		foreachSubparser(sub, false)
+		for (unsigned int i = 0; i < ptrArrayCount (subparsers); i++)
 		{
-			enterSubparser (sub);
-			((yamlSubparser *)sub)->newTokenNotfify ((yamlSubparser *)sub, &token);
+			yamlSubparser *ysub = ptrArrayItem (subparsers, i);
+
+			/* A subparser not interested in a block gets no token
+			 * until the end of the block. */
+			if (isYamlTokenSkipped (ysub, &token))
+				continue;
+
+			enterSubparser ((subparser *)ysub);
+			ysub->newTokenNotfify (ysub, &token);
 			leaveSubparser ();
 		}
 
@@ -169,18 +212,22 @@ static void findYamlTags (void)
 			TRACE_PRINT_NEWLINE();
 		}
 
-		if (token.type == YAML_STREAM_END_TOKEN)
+		if (token.type == YAML_BLOCK_END_TOKEN && YamlBlockDepth > 0)
+			YamlBlockDepth--;
+		else if (token.type == YAML_STREAM_END_TOKEN)
 			done = true;
 
 		yaml_token_delete (&token);
 	}
 
-	foreachSubparser(sub, false)
+	for (unsigned int i = 0; i < ptrArrayCount (subparsers); i++)
 	{
+		sub = ptrArrayItem (subparsers, i);
 		enterSubparser (sub);
 		ypathPopAllTypes ((yamlSubparser*)sub);
 		leaveSubparser ();
 	}
+	ptrArrayDelete (subparsers);
 
 	yamlFini (&yaml);
 }
@@ -297,6 +344,41 @@ extern void ypathPopAllTypes (yamlSubparser *yaml)
 		ypathPopType (yaml);
 }
 
+/* No entry of TABLES can match in the block at the top of the stack if
+ * the keys of the blocks around it are not the ones at the end of the
+ * code of the entry. A key of the blocks around is fixed while the block
+ * is open. */
+static bool ypathMayMatchInBlock (struct ypathTypeStack *stack, intArray *code)
+{
+	size_t depth = 0;
+	size_t offset;
+
+	for (struct ypathTypeStack *s = stack; s; s = s->next)
+		depth++;
+
+	/* The stack in the block is longer than the code. */
+	if (intArrayCount (code) < depth)
+		return false;
+
+	offset = intArrayCount (code) - depth + 1;
+	for (stack = stack->next; stack; stack = stack->next)
+		if (stack->key != intArrayItem (code, offset++))
+			return false;
+	return true;
+}
+
+extern void ypathSkipBlockMaybe (yamlSubparser *yaml, tagYpathTable tables[], size_t count)
+{
+	if (!yaml->ypathTypeStack)
+		return;
+
+	for (size_t i = 0; i < count; i++)
+		if (ypathMayMatchInBlock (yaml->ypathTypeStack, tables[i].code))
+			return;
+
+	yamlSkipBlock (yaml);
+}
+
 extern void ypathFillKeywordOfTokenMaybe (yamlSubparser *yaml, yaml_token_t *token, langType lang)
 {
 	if (!yaml->ypathTypeStack)
@@ -29,11 +29,18 @@ struct sYamlSubparser {
 	subparser subparser;
 	void (* newTokenNotfify) (yamlSubparser *s, yaml_token_t *token);
 	struct ypathTypeStack *ypathTypeStack;
+	unsigned int skipDepth;		/* YAML base parser private */
 };
 #define YAML(S) ((yamlSubparser *)S)
 
 extern void attachYamlPosition (tagEntryInfo *tag, yaml_token_t *token, bool asEndPosition);
 
+/* Call it in newTokenNotfify for a YAML_BLOCK_SEQUENCE_START_TOKEN or
+ * a YAML_BLOCK_MAPPING_START_TOKEN. The tokens in the block are not
+ * notified to YAML; the next token notified is the YAML_BLOCK_END_TOKEN
+ * closing the block (or the YAML_STREAM_END_TOKEN). */
+extern void yamlSkipBlock (yamlSubparser *yaml);
+
 /*
  * Experimental Ypath code
  */
@@ -58,6 +65,9 @@ extern void ypathHandleToken (yamlSubparser *yaml, yaml_token_t *token, int stat
 extern void ypathPushType (yamlSubparser *yaml, yaml_token_t *token);
 extern void ypathPopType (yamlSubparser *yaml);
 extern void ypathPopAllTypes (yamlSubparser *yaml);
+/* Call it just after ypathPushType () for a block start token. The block
+ * is skipped with yamlSkipBlock () if no entry of TABLES can match in it. */
+extern void ypathSkipBlockMaybe (yamlSubparser *yaml, tagYpathTable tables[], size_t count);
 extern void ypathFillKeywordOfTokenMaybe (yamlSubparser *yaml, yaml_token_t *token, langType lang);
 
 extern void ypathPrintTypeStack(yamlSubparser *yaml);
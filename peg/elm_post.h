@@ -164,6 +164,7 @@ static vString *collapseWhitespace (const char *sig)
 static void ctxInit (struct parserCtx *auxil)
 {
 	BASE_INIT (auxil, K_MODULE);
+	ELM_INIT_MODULE_SCOPE;
 }
 
 static void ctxFini (struct parserCtx *auxil)
@@ -171,20 +172,35 @@ static void ctxFini (struct parserCtx *auxil)
 	BASE_FINI (auxil);
 }
 
+static struct parserPegStats elmPegStats;
+
 static void findElmTags (void)
 {
 	struct parserCtx auxil;
+	unsigned long parts = 0;
 
 	ctxInit (&auxil);
 	pelm_context_t *pctx = pelm_create (&auxil);
 
-	while (pelm_parse (pctx, NULL) && (! BASE_ERROR (&auxil)))
-		;
+	do
+		parts++;
+	while (pelm_parse (pctx, NULL) && (! BASE_ERROR (&auxil)));
 
+	PEG_ACCOUNT_FILE (elmPegStats, pctx, parts);
 	pelm_destroy (pctx);
 	ctxFini (&auxil);
 }
 
+static void initElmStats (langType language CTAGS_ATTR_UNUSED)
+{
+	pegInitStats (&elmPegStats);
+}
+
+static void printElmStats (langType language CTAGS_ATTR_UNUSED)
+{
+	pegPrintStats (&elmPegStats);
+}
+
 extern parserDefinition *ElmParser (void)
 {
 	static const char *const extensions [] = { "elm", NULL };
@@ -193,6 +209,8 @@ extern parserDefinition *ElmParser (void)
 	def->kindCount = ARRAY_SIZE (ElmKinds);
 	def->extensions = extensions;
 	def->parser = findElmTags;
+	def->initStats = initElmStats;
+	def->printStats = printElmStats;
 	def->fieldTable = ElmFields;
 	def->fieldCount = ARRAY_SIZE (ElmFields);
 	def->useCork = true;
@@ -96,19 +96,35 @@ static void ctxFini (struct parserCtx *auxil)
     BASE_FINI(auxil);
 }
 
+static struct parserPegStats kotlinPegStats;
+
 static void findKotlinTags (void)
 {
     struct parserCtx auxil;
+    unsigned long parts = 0;
 
     ctxInit (&auxil);
     pkotlin_context_t *pctx = pkotlin_create(&auxil);
 
+    do
+        parts++;
     while (pkotlin_parse(pctx, NULL) && (!BASE_ERROR(&auxil)) );
 
+    PEG_ACCOUNT_FILE(kotlinPegStats, pctx, parts);
     pkotlin_destroy(pctx);
     ctxFini (&auxil);
 }
 
+static void initKotlinStats (langType language CTAGS_ATTR_UNUSED)
+{
+    pegInitStats (&kotlinPegStats);
+}
+
+static void printKotlinStats (langType language CTAGS_ATTR_UNUSED)
+{
+    pegPrintStats (&kotlinPegStats);
+}
+
 extern parserDefinition* KotlinParser (void)
 {
     static const char *const extensions [] = { "kt", "kts", NULL };
@@ -117,6 +133,8 @@ extern parserDefinition* KotlinParser (void)
     def->kindCount = ARRAY_SIZE (KotlinKinds);
     def->extensions = extensions;
     def->parser = findKotlinTags;
+    def->initStats = initKotlinStats;
+    def->printStats = printKotlinStats;
     def->useCork = true;
     def->requestAutomaticFQTag = true;
     def->defaultScopeSeparator = ".";
@@ -33,11 +33,24 @@ struct parserBaseCtx {
 	intArray *kind_stack;
 	int scope_cork_index;
 	bool found_syntax_error;
+	vString *capture;
 #ifdef DEBUG
 	hashTable *debug_rules;
 #endif
 };
 
+/* The generated parsers keep the input from the position of the last
+ * commit in the buffer, and the memo table has an entry for each of
+ * the positions. They are discarded when a call of *_parse () returns;
+ * a grammar whose first rule matches a top level part of the input,
+ * not the whole input, bounds the memory by the largest part. */
+struct parserPegStats {
+	unsigned long files;
+	unsigned long parts;		/* the calls of *_parse () */
+	size_t maxBuffer;			/* in bytes */
+	size_t maxMemoPositions;
+};
+
 #define BASE_STRUCT parserBaseCtx
 #define BASE(P) ((struct BASE_STRUCT*)(P))
 #define BASE_ERROR(P) ((BASE(P))->found_syntax_error)
@@ -52,6 +65,20 @@ struct parserBaseCtx {
 #define BASE_INIT(P,KIND) (baseInit((BASE(P)),KIND))
 #define BASE_FINI(P) (baseFini(BASE(P)))
 
+/* CTX is the context of a generated parser; the macro is for the
+ * *_post.h files, which see the definition of the context. Call this
+ * before destroying CTX; the buffer and the table never shrink. */
+#define PEG_ACCOUNT_FILE(STATS,CTX,PARTS) \
+	pegAccountFile (&(STATS), (CTX)->buffer.max, (CTX)->lrtable.max, (PARTS))
+
+/* The capture from the offset S to E, for passing it to a function
+ * making a tag: the string is valid only until the next use of the
+ * macro in the parser. $n allocates a string for each capture; this
+ * copies the capture from the input buffer of CTX into a string reused.
+ * Use it only in an action. */
+#define PEG_CAPTURE(P,S,E) \
+	baseCapture(BASE(P), __pcc_ctx->buffer.buf + ((S) - __pcc_ctx->pos), (E) - (S))
+
 #ifdef DEBUG
 #define BASE_DEBUG_RULE(P, R) baseAddDebugRule(BASE(P), R)
 #else
@@ -98,6 +125,7 @@ static void baseInit(struct parserBaseCtx *auxil, int initial_kind)
 	basePushKind (auxil, initial_kind);
 	auxil->scope_cork_index = CORK_NIL;
 	auxil->found_syntax_error = false;
+	auxil->capture = vStringNew ();
 #ifdef DEBUG
 	auxil->debug_rules = hashTableNew (11,
 									   hashCstrhash, hashCstreq,
@@ -109,11 +137,43 @@ static void baseFini(struct parserBaseCtx *auxil)
 {
 	basePopKind (auxil, false);
 	intArrayDelete (auxil->kind_stack);
+	vStringDelete (auxil->capture);
 #ifdef DEBUG
 	hashTableDelete (auxil->debug_rules);
 #endif
 }
 
+static const char *baseCapture (struct parserBaseCtx *auxil, const char *s, size_t len)
+{
+	vStringNCopyS (auxil->capture, s, len);
+	return vStringValue (auxil->capture);
+}
+
+static void pegAccountFile (struct parserPegStats *stats,
+							size_t buffer, size_t memoPositions, unsigned long parts)
+{
+	stats->files++;
+	stats->parts += parts;
+	if (buffer > stats->maxBuffer)
+		stats->maxBuffer = buffer;
+	if (memoPositions > stats->maxMemoPositions)
+		stats->maxMemoPositions = memoPositions;
+}
+
+static void pegInitStats (struct parserPegStats *stats)
+{
+	memset (stats, 0, sizeof (*stats));
+}
+
+static void pegPrintStats (struct parserPegStats *stats)
+{
+	fprintf (stderr, "files: %lu\n", stats->files);
+	fprintf (stderr, "top level parts: %lu\n", stats->parts);
+	fprintf (stderr, "largest input buffer: %zu bytes\n", stats->maxBuffer);
+	fprintf (stderr, "largest memo table: %zu positions (%zu bytes)\n",
+			 stats->maxMemoPositions, stats->maxMemoPositions * sizeof (void *));
+}
+
 #ifdef DEBUG
 static void baseAddDebugRule (struct parserBaseCtx *auxil, char *rule)
 {
@@ -81,21 +81,37 @@ static void ctxFini (struct parserCtx *auxil)
 	BASE_FINI(auxil);
 }
 
+static struct parserPegStats thriftPegStats;
+
 static void findThriftTags (void)
 {
 	struct parserCtx auxil;
+	unsigned long parts = 0;
 
 	ctxInit (&auxil);
 	// 	BASE_DEBUG_RULE(&auxil, "Const");
 
 	pthrift_context_t *pctx = pthrift_create(&auxil);
 
+	do
+		parts++;
 	while ( pthrift_parse(pctx, NULL) && (!BASE_ERROR(&auxil)) );
 
+	PEG_ACCOUNT_FILE(thriftPegStats, pctx, parts);
 	pthrift_destroy(pctx);
 	ctxFini (&auxil);
 }
 
+static void initThriftStats (langType language CTAGS_ATTR_UNUSED)
+{
+	pegInitStats (&thriftPegStats);
+}
+
+static void printThriftStats (langType language CTAGS_ATTR_UNUSED)
+{
+	pegPrintStats (&thriftPegStats);
+}
+
 extern parserDefinition* ThriftParser (void)
 {
 	static const char *const extensions [] = { "thrift", NULL };
@@ -113,6 +129,8 @@ extern parserDefinition* ThriftParser (void)
 	def->dependencies = dependencies;
 	def->dependencyCount = ARRAY_SIZE (dependencies);
 	def->parser     = findThriftTags;
+	def->initStats  = initThriftStats;
+	def->printStats = printThriftStats;
 	def->useCork    = true;
 	def->enabled    = true;
 	def->defaultScopeSeparator = ".";
@@ -74,19 +74,35 @@ static void ctxFini (struct parserCtx *auxil)
 	BASE_FINI(auxil);
 }
 
+static struct parserPegStats varlinkPegStats;
+
 static void findVarlinkTags (void)
 {
 	struct parserCtx auxil;
+	unsigned long parts = 0;
 
 	ctxInit (&auxil);
 	pvarlink_context_t *pctx = pvarlink_create(&auxil);
 
+	do
+		parts++;
 	while (pvarlink_parse(pctx, NULL) && (!BASE_ERROR(&auxil)) );
 
+	PEG_ACCOUNT_FILE(varlinkPegStats, pctx, parts);
 	pvarlink_destroy(pctx);
 	ctxFini (&auxil);
 }
 
+static void initVarlinkStats (langType language CTAGS_ATTR_UNUSED)
+{
+	pegInitStats (&varlinkPegStats);
+}
+
+static void printVarlinkStats (langType language CTAGS_ATTR_UNUSED)
+{
+	pegPrintStats (&varlinkPegStats);
+}
+
 extern parserDefinition* VarlinkParser (void)
 {
 	static const char *const extensions [] = { "varlink", NULL };
@@ -95,6 +111,8 @@ extern parserDefinition* VarlinkParser (void)
 	def->kindCount  = ARRAY_SIZE (VarlinkKinds);
 	def->extensions = extensions;
 	def->parser     = findVarlinkTags;
+	def->initStats  = initVarlinkStats;
+	def->printStats = printVarlinkStats;
 	def->useCork    = true;
 	def->enabled    = true;
 	def->defaultScopeSeparator = ".";
@@ -29,6 +29,7 @@ UTIL_PUBLIC_HEADS = \
 	$(NULL)
 
 UTIL_PRIVATE_HEADS = \
+	main/arena_p.h		\
 	main/routines_p.h	\
 	\
 	$(NULL)
@@ -40,6 +41,7 @@ UTIL_HEADS = \
 	$(NULL)
 
 UTIL_SRCS = \
+	main/arena.c		\
 	main/fname.c		\
 	main/htable.c		\
 	main/ptrarray.c		\
@@ -90,6 +92,7 @@ MAIN_PUBLIC_HEADS =		\
 	main/strlist.h		\
 	main/subparser.h	\
 	main/tokeninfo.h	\
+	main/tokenscan.h	\
 	main/trace.h		\
 	main/types.h		\
 	main/unwindi.h  	\
@@ -102,19 +105,26 @@ LIB_PRIVATE_HEADS =		\
 	\
 	main/args_p.h		\
 	main/colprint_p.h	\
+	main/compress_p.h	\
+	main/dedup_p.h		\
 	main/dependency_p.h	\
 	main/entry_p.h		\
 	main/error_p.h		\
 	main/field_p.h		\
+	main/fileindex_p.h	\
 	main/flags_p.h		\
 	main/fmt_p.h		\
+	main/ignorefile_p.h	\
 	main/interactive_p.h	\
+	main/jobs_p.h		\
 	main/keyword_p.h	\
 	main/kind_p.h		\
+	main/langcache_p.h	\
 	main/lregex_p.h		\
 	main/lxpath_p.h		\
 	main/main_p.h		\
 	main/mbcs_p.h		\
+	main/nameindex_p.h	\
 	main/options_p.h	\
 	main/param_p.h		\
 	main/parse_p.h		\
@@ -123,11 +133,18 @@ LIB_PRIVATE_HEADS =		\
 	main/promise_p.h	\
 	main/ptag_p.h		\
 	main/read_p.h		\
+	main/sampler_p.h	\
 	main/script_p.h		\
+	main/server_p.h		\
+	main/shard_p.h		\
 	main/sort_p.h		\
 	main/stats_p.h		\
 	main/subparser_p.h	\
+	main/tagcache_p.h	\
+	main/traceevent_p.h	\
 	main/trashbox_p.h	\
+	main/trigramindex_p.h	\
+	main/watch_p.h		\
 	main/writer_p.h		\
 	main/xtag_p.h		\
 	\
@@ -148,20 +165,28 @@ LIB_SRCS =			\
 	\
 	main/args.c			\
 	main/colprint.c			\
+	main/compress.c			\
+	main/dedup.c			\
 	main/dependency.c		\
 	main/entry.c			\
 	main/entry_private.c		\
 	main/error.c			\
 	main/field.c			\
+	main/fileindex.c		\
 	main/flags.c			\
 	main/fmt.c			\
+	main/ignorefile.c		\
+	main/jobs.c			\
 	main/keyword.c			\
 	main/kind.c			\
+	main/langcache.c		\
 	main/lregex.c			\
 	main/lregex-default.c		\
+	main/lregex-prefilter.c		\
 	main/lxpath.c			\
 	main/main.c			\
 	main/mbcs.c			\
+	main/nameindex.c		\
 	main/nestlevel.c		\
 	main/numarray.c			\
 	main/objpool.c			\
@@ -173,19 +198,29 @@ LIB_SRCS =			\
 	main/ptag.c			\
 	main/rbtree.c			\
 	main/read.c			\
+	main/sampler.c		\
 	main/script.c			\
 	main/seccomp.c			\
 	main/selectors.c		\
+	main/server.c		\
+	main/shard.c			\
 	main/sort.c			\
 	main/stats.c			\
 	main/strlist.c			\
+	main/tagcache.c		\
 	main/trace.c			\
+	main/traceevent.c		\
 	main/tokeninfo.c		\
+	main/tokenscan.c		\
+	main/trigramindex.c		\
 	main/unwindi.c			\
+	main/watch.c			\
 	main/writer.c			\
 	main/writer-etags.c		\
+	main/writer-binary.c		\
 	main/writer-ctags.c		\
 	main/writer-json.c		\
+	main/writer-sink.c		\
 	main/writer-xref.c		\
 	main/xtag.c			\
 	\
@@ -211,6 +246,12 @@ MINI_GEANY_SRCS = \
 	\
 	$(NULL)
 
+MICROBENCH_HEADS =
+MICROBENCH_SRCS = \
+	extra-cmds/microbench.c \
+	\
+	$(NULL)
+
 OPTSCRIPT_SRCS = \
 	extra-cmds/optscript-repl.c \
 	\